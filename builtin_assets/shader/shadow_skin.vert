@@ -9,10 +9,11 @@ layout(push_constant) uniform PushConstants {
     mat4 model;
     uint shadowIndex;
     uint shadowType;
+    uint jointOffset;
 };
 
-layout(set = 1, binding = 0) uniform JointBlockObject {
-    mat4 joints[256];
+layout(set = 1, binding = 0) readonly buffer JointBlockObject {
+    mat4 joints[];
 } JointBlock;
 
 layout(location = 0) in vec3 inPosition;
@@ -25,10 +26,10 @@ layout(location = 5) in uvec4 inJointIDs;
 void main()
 {
     mat4 skinMat =
-          inWeights.x * JointBlock.joints[inJointIDs.x]
-        + inWeights.y * JointBlock.joints[inJointIDs.y]
-        + inWeights.z * JointBlock.joints[inJointIDs.z]
-        + inWeights.w * JointBlock.joints[inJointIDs.w];
+          inWeights.x * JointBlock.joints[jointOffset + inJointIDs.x]
+        + inWeights.y * JointBlock.joints[jointOffset + inJointIDs.y]
+        + inWeights.z * JointBlock.joints[jointOffset + inJointIDs.z]
+        + inWeights.w * JointBlock.joints[jointOffset + inJointIDs.w];
 
     vec4 skinnedPos = skinMat * vec4(inPosition, 1.0);
     mat4 lightViewProj = shadowType == 0
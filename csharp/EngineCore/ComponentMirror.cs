@@ -0,0 +1,89 @@
+using System;
+using System.Runtime.InteropServices;
+using System.Threading;
+
+namespace vkEngine.EngineCore
+{
+    [Flags]
+    public enum ComponentMirrorFlags : UInt32
+    {
+        None = 0,
+        Valid = 1u << 0,
+        HasRigidBody = 1u << 1,
+        BodyActive = 1u << 2,
+        HasCharacterController = 1u << 3,
+    }
+
+    // Must match vke_interop::ComponentMirrorView in include/interop/mirror.hpp.
+    [StructLayout(LayoutKind.Sequential)]
+    public unsafe struct NativeComponentMirrorView
+    {
+        public UInt64 generation;
+        public UInt32 capacity;
+        public UInt32 entityIndexMask;
+        public UInt32* entities;
+        public UInt32* flags;
+        public NVec3* worldPositions;
+        public NQuat* worldRotations;
+        public NVec3* linearVelocities;
+        public NVec3* angularVelocities;
+    }
+
+    // Read-only view of the per-frame component mirror owned by the engine.
+    // Spans are indexed with IndexOf(entity) and are only valid until the next frame;
+    // keep the Generation they were taken at and compare with IsCurrent before reusing them.
+    public static unsafe class ComponentMirror
+    {
+        private static NativeComponentMirrorView* view;
+
+        internal static void RegisterNativeFunctions(NativeFunctions* functions)
+        {
+            view = functions->GetComponentMirrorView();
+        }
+
+        public static UInt64 Generation => Volatile.Read(ref view->generation);
+        public static bool IsCurrent(UInt64 generation) => (generation & 1) == 0 && generation == Generation;
+
+        public static ReadOnlySpan<UInt32> Entities => new(view->entities, (int)view->capacity);
+        public static ReadOnlySpan<ComponentMirrorFlags> Flags => new(view->flags, (int)view->capacity);
+        public static ReadOnlySpan<NVec3> WorldPositions => new(view->worldPositions, (int)view->capacity);
+        public static ReadOnlySpan<NQuat> WorldRotations => new(view->worldRotations, (int)view->capacity);
+        public static ReadOnlySpan<NVec3> LinearVelocities => new(view->linearVelocities, (int)view->capacity);
+        public static ReadOnlySpan<NVec3> AngularVelocities => new(view->angularVelocities, (int)view->capacity);
+
+        public static int IndexOf(UInt32 entity)
+        {
+            UInt32 index = entity & view->entityIndexMask;
+            if (index >= view->capacity || view->entities[index] != entity)
+                return -1;
+            return (int)index;
+        }
+
+        public static bool TryGetWorldPosition(UInt32 entity, out NVec3 position)
+        {
+            int index = IndexOf(entity);
+            position = index < 0 ? NVec3.Zero : view->worldPositions[index];
+            return index >= 0;
+        }
+
+        public static bool TryGetWorldRotation(UInt32 entity, out NQuat rotation)
+        {
+            int index = IndexOf(entity);
+            rotation = index < 0 ? NQuat.Identity : view->worldRotations[index];
+            return index >= 0;
+        }
+
+        public static bool TryGetLinearVelocity(UInt32 entity, out NVec3 velocity)
+        {
+            int index = IndexOf(entity);
+            velocity = index < 0 ? NVec3.Zero : view->linearVelocities[index];
+            return index >= 0;
+        }
+
+        public static ComponentMirrorFlags GetFlags(UInt32 entity)
+        {
+            int index = IndexOf(entity);
+            return index < 0 ? ComponentMirrorFlags.None : (ComponentMirrorFlags)view->flags[index];
+        }
+    }
+}
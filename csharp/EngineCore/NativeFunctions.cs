@@ -113,6 +113,23 @@ namespace vkEngine.EngineCore
         public delegate* unmanaged[Cdecl]<NVec3*, UInt32, UInt32, CollidePointHit*, UInt32, UInt32> PhysicsCollidePoint;
         public delegate* unmanaged[Cdecl]<Int32, void*, NVec3*, NQuat*, NVec3*, UInt32, UInt32, CollideShapeHit*, UInt32, UInt32> PhysicsCollideShape;
         public delegate* unmanaged[Cdecl]<Int32, void*, NVec3*, NQuat*, NVec3*, NVec3*, float, UInt32, UInt32, ShapeCastHit*, UInt32, UInt32> PhysicsCastShape;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> GetTransformLocalPositions;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> SetTransformLocalPositions;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NQuat*, void> GetTransformLocalRotations;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NQuat*, void> SetTransformLocalRotations;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> GetTransformLocalScales;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> SetTransformLocalScales;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> GetTransformGlobalPositions;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NQuat*, void> GetTransformGlobalRotations;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> TranslateTransformsGlobal;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, NQuat*, void> GetBodyPositionsAndRotations;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> GetBodyLinearVelocities;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> SetBodyLinearVelocities;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> GetBodyAngularVelocities;
+        public delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> SetBodyAngularVelocities;
+        public delegate* unmanaged[Cdecl]<NativeComponentMirrorView*> GetComponentMirrorView;
+        public delegate* unmanaged[Cdecl]<byte*, UInt32, UInt32, float, UInt32, UInt32> RegisterScheduledScript;
+        public delegate* unmanaged[Cdecl]<UInt32, void> UnregisterScheduledScript;
     }
 
     public static class NativeFunctionRegistry
@@ -135,6 +152,8 @@ namespace vkEngine.EngineCore
             RigidBody.RegisterNativeFunctions(functions);
             Sensor.RegisterNativeFunctions(functions);
             Physics.RegisterNativeFunctions(functions);
+            ComponentMirror.RegisterNativeFunctions(functions);
+            SceneManager.RegisterNativeFunctions(functions);
         }
     }
 }
@@ -32,6 +32,11 @@ namespace vkEngine.EngineCore
         private readonly ContactCallbacks contactCallbacks;
 
         private static delegate* unmanaged[Cdecl]<UInt32, UInt32> getBodyID;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, NQuat*, void> getPositionsAndRotations;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> getLinearVelocities;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> setLinearVelocities;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> getAngularVelocities;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> setAngularVelocities;
         private static delegate* unmanaged[Cdecl]<UInt32, void> activate;
         private static delegate* unmanaged[Cdecl]<UInt32, void> deactivate;
         private static delegate* unmanaged[Cdecl]<UInt32, Int32> isActive;
@@ -124,6 +129,55 @@ namespace vkEngine.EngineCore
             getMotionType = functions->GetBodyMotionType;
             setMotionQuality = functions->SetBodyMotionQuality;
             getMotionQuality = functions->GetBodyMotionQuality;
+            getPositionsAndRotations = functions->GetBodyPositionsAndRotations;
+            getLinearVelocities = functions->GetBodyLinearVelocities;
+            setLinearVelocities = functions->SetBodyLinearVelocities;
+            getAngularVelocities = functions->GetBodyAngularVelocities;
+            setAngularVelocities = functions->SetBodyAngularVelocities;
+        }
+
+        // Batch accessors keyed by BodyID (not entity): values[i] belongs to bodyIDs[i].
+
+        public static void GetPositionsAndRotations(ReadOnlySpan<UInt32> bodyIDs, Span<NVec3> positions, Span<NQuat> rotations)
+        {
+            Transform.CheckBatchLength(bodyIDs.Length, positions.Length);
+            Transform.CheckBatchLength(bodyIDs.Length, rotations.Length);
+            fixed (UInt32* idPtr = bodyIDs)
+            fixed (NVec3* positionPtr = positions)
+            fixed (NQuat* rotationPtr = rotations)
+                getPositionsAndRotations(idPtr, (UInt32)bodyIDs.Length, positionPtr, rotationPtr);
+        }
+
+        public static void GetLinearVelocities(ReadOnlySpan<UInt32> bodyIDs, Span<NVec3> velocities)
+        {
+            Transform.CheckBatchLength(bodyIDs.Length, velocities.Length);
+            fixed (UInt32* idPtr = bodyIDs)
+            fixed (NVec3* valuePtr = velocities)
+                getLinearVelocities(idPtr, (UInt32)bodyIDs.Length, valuePtr);
+        }
+
+        public static void SetLinearVelocities(ReadOnlySpan<UInt32> bodyIDs, ReadOnlySpan<NVec3> velocities)
+        {
+            Transform.CheckBatchLength(bodyIDs.Length, velocities.Length);
+            fixed (UInt32* idPtr = bodyIDs)
+            fixed (NVec3* valuePtr = velocities)
+                setLinearVelocities(idPtr, (UInt32)bodyIDs.Length, valuePtr);
+        }
+
+        public static void GetAngularVelocities(ReadOnlySpan<UInt32> bodyIDs, Span<NVec3> velocities)
+        {
+            Transform.CheckBatchLength(bodyIDs.Length, velocities.Length);
+            fixed (UInt32* idPtr = bodyIDs)
+            fixed (NVec3* valuePtr = velocities)
+                getAngularVelocities(idPtr, (UInt32)bodyIDs.Length, valuePtr);
+        }
+
+        public static void SetAngularVelocities(ReadOnlySpan<UInt32> bodyIDs, ReadOnlySpan<NVec3> velocities)
+        {
+            Transform.CheckBatchLength(bodyIDs.Length, velocities.Length);
+            fixed (UInt32* idPtr = bodyIDs)
+            fixed (NVec3* valuePtr = velocities)
+                setAngularVelocities(idPtr, (UInt32)bodyIDs.Length, valuePtr);
         }
 
         public UInt32 Entity => entity;
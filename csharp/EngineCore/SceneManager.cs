@@ -1,7 +1,9 @@
 using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Reflection;
 using System.Runtime.InteropServices;
+using System.Text;
 using System.Text.Json;
 
 namespace vkEngine.EngineCore
@@ -11,7 +13,7 @@ namespace vkEngine.EngineCore
     {
         public delegate* unmanaged<byte**, UInt32, void> Load;
         public delegate* unmanaged<void> Start;
-        public delegate* unmanaged<void> Update;
+        public delegate* unmanaged<UInt32, UInt32*, float*, float*, UInt32, void> Dispatch;
         public delegate* unmanaged<void> FixedUpdate;
         public delegate* unmanaged<void> LateUpdate;
         public delegate* unmanaged<void> Unload;
@@ -28,13 +30,20 @@ namespace vkEngine.EngineCore
         Unload = 1 << 4
     }
 
-    public static class SceneManager
+    public static unsafe class SceneManager
     {
+        // Must match vke_common::ScriptPhase in include/script_scheduler.hpp.
+        private const UInt32 UpdatePhase = 0;
+        private const UInt32 FixedUpdatePhase = 1;
+
         private const string GameAssemblyName = "Game";
         private static readonly HashSet<EntityScript> allScripts = new();
         private static readonly Dictionary<UInt32, List<EntityScript>> startScripts = new();
-        private static readonly Dictionary<UInt32, List<EntityScript>> updateScripts = new();
-        private static readonly Dictionary<UInt32, List<EntityScript>> fixedUpdateScripts = new();
+        private static readonly List<EntityScript?> scheduledScripts = new();
+        private static readonly List<EntityScript?> dispatchSnapshot = new();
+        private static readonly Dictionary<Type, ScriptUpdateRateAttribute?> updateRateCache = new();
+        private static delegate* unmanaged[Cdecl]<byte*, UInt32, UInt32, float, UInt32, UInt32> registerScheduledScript;
+        private static delegate* unmanaged[Cdecl]<UInt32, void> unregisterScheduledScript;
         private static readonly Dictionary<UInt32, List<EntityScript>> lateUpdateScripts = new();
         private static readonly Dictionary<UInt32, List<EntityScript>> unloadScripts = new();
         private static readonly JsonSerializerOptions jsonOptions = new()
@@ -101,17 +110,42 @@ namespace vkEngine.EngineCore
             Dispatch(startScripts, script => script.Start());
         }
 
+        // Runs one native dispatch list (built by vke_common::ScriptScheduler) and reports the time spent per script.
         [UnmanagedCallersOnly]
-        public static void Update()
+        public static void Dispatch(UInt32 phase, UInt32* ids, float* deltaTimes, float* elapsedMs, UInt32 cnt)
         {
-            Dispatch(updateScripts, script => script.Update());
+            // resolve the whole list up front, a callback that adds or removes scripts can hand an id over to a new
+            // script and that one must not run in the old owner's place
+            dispatchSnapshot.Clear();
+            for (UInt32 i = 0; i < cnt; i++)
+                dispatchSnapshot.Add(ids[i] < scheduledScripts.Count ? scheduledScripts[(int)ids[i]] : null);
+
+            for (int i = 0; i < cnt; i++)
+            {
+                var script = dispatchSnapshot[i];
+                // removed by an earlier callback of this dispatch
+                if (script == null || script.ScheduleID != ids[i])
+                {
+                    elapsedMs[i] = 0f;
+                    continue;
+                }
+
+                script.ScheduledDeltaTime = deltaTimes[i];
+                long start = Stopwatch.GetTimestamp();
+                if (phase == UpdatePhase)
+                    script.Update();
+                else if (phase == FixedUpdatePhase)
+                    script.FixedUpdate();
+                elapsedMs[i] = (float)Stopwatch.GetElapsedTime(start).TotalMilliseconds;
+            }
+            dispatchSnapshot.Clear();
         }
 
+        // Update and FixedUpdate scripts are dispatched through Dispatch, this only delivers physics events before them.
         [UnmanagedCallersOnly]
         public static void FixedUpdate()
         {
             Physics.DispatchContactEvents();
-            Dispatch(fixedUpdateScripts, script => script.FixedUpdate());
         }
 
         [UnmanagedCallersOnly]
@@ -139,13 +173,19 @@ namespace vkEngine.EngineCore
             {
                 Load = &Load,
                 Start = &Start,
-                Update = &Update,
+                Dispatch = &Dispatch,
                 FixedUpdate = &FixedUpdate,
                 LateUpdate = &LateUpdate,
                 Unload = &Unload
             };
         }
 
+        internal static void RegisterNativeFunctions(NativeFunctions* functions)
+        {
+            registerScheduledScript = functions->RegisterScheduledScript;
+            unregisterScheduledScript = functions->UnregisterScheduledScript;
+        }
+
         internal static void Register(EntityScript script)
         {
             if (script == null || !allScripts.Add(script))
@@ -157,10 +197,8 @@ namespace vkEngine.EngineCore
 
             if (mask.HasFlag(ScriptLifecycleMask.Start))
                 Add(script, startScripts);
-            if (mask.HasFlag(ScriptLifecycleMask.Update))
-                Add(script, updateScripts);
-            if (mask.HasFlag(ScriptLifecycleMask.FixedUpdate))
-                Add(script, fixedUpdateScripts);
+            if (mask.HasFlag(ScriptLifecycleMask.Update) || mask.HasFlag(ScriptLifecycleMask.FixedUpdate))
+                Schedule(script, mask);
             if (mask.HasFlag(ScriptLifecycleMask.LateUpdate))
                 Add(script, lateUpdateScripts);
             if (mask.HasFlag(ScriptLifecycleMask.Unload))
@@ -172,12 +210,55 @@ namespace vkEngine.EngineCore
             if (script == null || !allScripts.Remove(script))
                 return;
             Remove(script, startScripts);
-            Remove(script, updateScripts);
-            Remove(script, fixedUpdateScripts);
+            Unschedule(script);
             Remove(script, lateUpdateScripts);
             Remove(script, unloadScripts);
         }
 
+        private static void Schedule(EntityScript script, ScriptLifecycleMask mask)
+        {
+            var type = script.GetType();
+            if (!updateRateCache.TryGetValue(type, out var rate))
+            {
+                rate = type.GetCustomAttribute<ScriptUpdateRateAttribute>(inherit: true);
+                updateRateCache[type] = rate;
+            }
+
+            UInt32 phaseMask = 0;
+            if (mask.HasFlag(ScriptLifecycleMask.Update))
+                phaseMask |= 1u << (int)UpdatePhase;
+            if (mask.HasFlag(ScriptLifecycleMask.FixedUpdate))
+                phaseMask |= 1u << (int)FixedUpdatePhase;
+
+            var name = Encoding.UTF8.GetBytes(type.FullName + "\0");
+            UInt32 id;
+            fixed (byte* namePtr = name)
+            {
+                id = registerScheduledScript(namePtr,
+                                             (UInt32)(rate?.Mode ?? ScriptUpdateMode.EveryFrame),
+                                             rate?.Interval ?? 1,
+                                             rate?.BudgetMs ?? 0f,
+                                             phaseMask);
+            }
+
+            script.ScheduleID = id;
+            while (scheduledScripts.Count <= id)
+                scheduledScripts.Add(null);
+            scheduledScripts[(int)id] = script;
+        }
+
+        private static void Unschedule(EntityScript script)
+        {
+            UInt32 id = script.ScheduleID;
+            if (id == UInt32.MaxValue)
+                return;
+
+            unregisterScheduledScript(id);
+            if (id < scheduledScripts.Count)
+                scheduledScripts[(int)id] = null;
+            script.ScheduleID = UInt32.MaxValue;
+        }
+
         private static void Add(EntityScript script, Dictionary<UInt32, List<EntityScript>> map)
         {
             if (!map.TryGetValue(script.Entity, out var scripts))
@@ -241,8 +322,7 @@ namespace vkEngine.EngineCore
         {
             allScripts.Clear();
             startScripts.Clear();
-            updateScripts.Clear();
-            fixedUpdateScripts.Clear();
+            scheduledScripts.Clear();
             lateUpdateScripts.Clear();
             unloadScripts.Clear();
         }
@@ -72,6 +72,11 @@ namespace vkEngine.EngineCore
 
         public UInt32 Entity { get; }
 
+        // time covered by the current Update/FixedUpdate call, larger than the frame delta when the scheduler skipped frames
+        public float ScheduledDeltaTime { get; internal set; }
+
+        internal UInt32 ScheduleID { get; set; } = UInt32.MaxValue;
+
         internal static unsafe void RegisterNativeFunctions(NativeFunctions* functions)
         {
             hasComponent = functions->HasComponent;
@@ -0,0 +1,30 @@
+using System;
+
+namespace vkEngine.EngineCore
+{
+    // Must match vke_common::ScriptUpdateMode in include/script_scheduler.hpp.
+    public enum ScriptUpdateMode : UInt32
+    {
+        EveryFrame = 0,
+        EveryNFrames = 1,
+        TimeSliced = 2
+    }
+
+    // Declares how often the scheduler runs Update/FixedUpdate for a script type.
+    // Interval counts frames for Update and fixed steps for FixedUpdate; scripts that skip
+    // frames read the accumulated time from EntityScript.ScheduledDeltaTime.
+    [AttributeUsage(AttributeTargets.Class, Inherited = true, AllowMultiple = false)]
+    public sealed class ScriptUpdateRateAttribute : Attribute
+    {
+        public ScriptUpdateRateAttribute(ScriptUpdateMode mode, UInt32 interval = 1)
+        {
+            Mode = mode;
+            Interval = interval;
+        }
+
+        public ScriptUpdateMode Mode { get; }
+        public UInt32 Interval { get; }
+        // 0 uses the engine default (scriptConfig.defaultBudgetMs)
+        public float BudgetMs { get; set; }
+    }
+}
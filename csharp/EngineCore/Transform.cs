@@ -15,6 +15,15 @@ namespace vkEngine.EngineCore
         private static delegate* unmanaged[Cdecl]<UInt32, float, NVec3*, void> rotateLocal;
         private static delegate* unmanaged[Cdecl]<UInt32, float, NVec3*, void> rotateGlobal;
         private static delegate* unmanaged[Cdecl]<UInt32, NVec3*, void> scale;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> getLocalPositions;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> setLocalPositions;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NQuat*, void> getLocalRotations;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NQuat*, void> setLocalRotations;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> getLocalScales;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> setLocalScales;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> getGlobalPositions;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NQuat*, void> getGlobalRotations;
+        private static delegate* unmanaged[Cdecl]<UInt32*, UInt32, NVec3*, void> translateGlobalBatch;
 
         public Transform(UInt32 entity)
         {
@@ -34,6 +43,15 @@ namespace vkEngine.EngineCore
             rotateLocal = functions->RotateTransformLocal;
             rotateGlobal = functions->RotateTransformGlobal;
             scale = functions->ScaleTransform;
+            getLocalPositions = functions->GetTransformLocalPositions;
+            setLocalPositions = functions->SetTransformLocalPositions;
+            getLocalRotations = functions->GetTransformLocalRotations;
+            setLocalRotations = functions->SetTransformLocalRotations;
+            getLocalScales = functions->GetTransformLocalScales;
+            setLocalScales = functions->SetTransformLocalScales;
+            getGlobalPositions = functions->GetTransformGlobalPositions;
+            getGlobalRotations = functions->GetTransformGlobalRotations;
+            translateGlobalBatch = functions->TranslateTransformsGlobal;
         }
 
         public uint Entity
@@ -115,5 +133,85 @@ namespace vkEngine.EngineCore
             NVec3 nativeScale = scaleFactor;
             scale(entity, &nativeScale);
         }
+
+        // Batch accessors: values[i] belongs to entities[i], one native call per span.
+
+        public static void GetLocalPositions(ReadOnlySpan<UInt32> entities, Span<NVec3> positions)
+        {
+            CheckBatchLength(entities.Length, positions.Length);
+            fixed (UInt32* entityPtr = entities)
+            fixed (NVec3* valuePtr = positions)
+                getLocalPositions(entityPtr, (UInt32)entities.Length, valuePtr);
+        }
+
+        public static void SetLocalPositions(ReadOnlySpan<UInt32> entities, ReadOnlySpan<NVec3> positions)
+        {
+            CheckBatchLength(entities.Length, positions.Length);
+            fixed (UInt32* entityPtr = entities)
+            fixed (NVec3* valuePtr = positions)
+                setLocalPositions(entityPtr, (UInt32)entities.Length, valuePtr);
+        }
+
+        public static void GetLocalRotations(ReadOnlySpan<UInt32> entities, Span<NQuat> rotations)
+        {
+            CheckBatchLength(entities.Length, rotations.Length);
+            fixed (UInt32* entityPtr = entities)
+            fixed (NQuat* valuePtr = rotations)
+                getLocalRotations(entityPtr, (UInt32)entities.Length, valuePtr);
+        }
+
+        public static void SetLocalRotations(ReadOnlySpan<UInt32> entities, ReadOnlySpan<NQuat> rotations)
+        {
+            CheckBatchLength(entities.Length, rotations.Length);
+            fixed (UInt32* entityPtr = entities)
+            fixed (NQuat* valuePtr = rotations)
+                setLocalRotations(entityPtr, (UInt32)entities.Length, valuePtr);
+        }
+
+        public static void GetLocalScales(ReadOnlySpan<UInt32> entities, Span<NVec3> scales)
+        {
+            CheckBatchLength(entities.Length, scales.Length);
+            fixed (UInt32* entityPtr = entities)
+            fixed (NVec3* valuePtr = scales)
+                getLocalScales(entityPtr, (UInt32)entities.Length, valuePtr);
+        }
+
+        public static void SetLocalScales(ReadOnlySpan<UInt32> entities, ReadOnlySpan<NVec3> scales)
+        {
+            CheckBatchLength(entities.Length, scales.Length);
+            fixed (UInt32* entityPtr = entities)
+            fixed (NVec3* valuePtr = scales)
+                setLocalScales(entityPtr, (UInt32)entities.Length, valuePtr);
+        }
+
+        public static void GetGlobalPositions(ReadOnlySpan<UInt32> entities, Span<NVec3> positions)
+        {
+            CheckBatchLength(entities.Length, positions.Length);
+            fixed (UInt32* entityPtr = entities)
+            fixed (NVec3* valuePtr = positions)
+                getGlobalPositions(entityPtr, (UInt32)entities.Length, valuePtr);
+        }
+
+        public static void GetGlobalRotations(ReadOnlySpan<UInt32> entities, Span<NQuat> rotations)
+        {
+            CheckBatchLength(entities.Length, rotations.Length);
+            fixed (UInt32* entityPtr = entities)
+            fixed (NQuat* valuePtr = rotations)
+                getGlobalRotations(entityPtr, (UInt32)entities.Length, valuePtr);
+        }
+
+        public static void TranslateGlobal(ReadOnlySpan<UInt32> entities, ReadOnlySpan<NVec3> deltas)
+        {
+            CheckBatchLength(entities.Length, deltas.Length);
+            fixed (UInt32* entityPtr = entities)
+            fixed (NVec3* valuePtr = deltas)
+                translateGlobalBatch(entityPtr, (UInt32)entities.Length, valuePtr);
+        }
+
+        internal static void CheckBatchLength(int idCount, int valueCount)
+        {
+            if (valueCount < idCount)
+                throw new ArgumentException($"Batch value span holds {valueCount} elements but {idCount} ids were given");
+        }
     }
 }
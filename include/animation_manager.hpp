@@ -0,0 +1,72 @@
+#ifndef ANIMATION_MANAGER_H
+#define ANIMATION_MANAGER_H
+
+#include <animation_system.hpp>
+#include <render/buffer.hpp>
+#include <render/descriptor.hpp>
+#include <render/renderinfo.hpp>
+#include <memory>
+#include <vector>
+
+namespace vke_common
+{
+    // Drives the AnimationSystem from the renderer's update step and owns the GPU side of the shared
+    // bone palette: one host-visible storage buffer per frame in flight, sub-allocated by joint count,
+    // and one descriptor set per frame on a layout shared by every skinned material. Shaders find an
+    // instance's matrices through a palette offset push constant.
+    class AnimationManager
+    {
+    public:
+        static AnimationManager *GetInstance()
+        {
+            VKE_FATAL_IF(instance == nullptr, "AnimationManager not initialized!")
+            return instance;
+        }
+
+        static AnimationManager *Init(const AnimationConfig &config);
+        static void Dispose();
+
+        // units get the palette descriptor set for the frame being rendered, and the pValues of their
+        // last push constant (a uint32_t) pointed at the instance's palette offset
+        static uint32_t Register(const AnimationInstanceDesc &desc, std::vector<vke_render::RenderUnit *> &&units)
+        {
+            return instance->registerInstance(desc, std::move(units));
+        }
+
+        static void Unregister(uint32_t id) { instance->unregisterInstance(id); }
+        static AnimationSystem &GetSystem() { return instance->system; }
+        static VkDescriptorSet GetDescriptorSet(uint32_t frame) { return instance->descriptorSets[frame]; }
+        static const vke_render::DescriptorSetInfo &GetDescriptorSetInfo() { return instance->descriptorSetInfo; }
+
+    private:
+        static AnimationManager *instance;
+        // renderer update callbacks are keyed by render unit id, this one stays clear of them
+        static constexpr vke_ds::id64_t RENDER_UPDATE_ID = ~vke_ds::id64_t(0);
+
+        struct Slot
+        {
+            std::vector<vke_render::RenderUnit *> units;
+            // heap allocated so the units' push constant pointers survive slots being resized
+            std::unique_ptr<uint32_t> paletteOffset;
+        };
+
+        AnimationManager(const AnimationConfig &config);
+        ~AnimationManager() {}
+        AnimationManager(const AnimationManager &) = delete;
+        AnimationManager &operator=(const AnimationManager &) = delete;
+
+        AnimationSystem system;
+        vke_render::DescriptorSetInfo descriptorSetInfo;
+        std::vector<std::unique_ptr<vke_render::HostCoherentBuffer>> paletteBuffers;
+        std::vector<VkDescriptorSet> descriptorSets;
+        std::vector<Slot> slots;
+
+        uint32_t registerInstance(const AnimationInstanceDesc &desc, std::vector<vke_render::RenderUnit *> &&units);
+        void unregisterInstance(uint32_t id);
+        void writeDescriptorSet(uint32_t frame);
+        void reservePalette(uint32_t frame);
+        void update(uint32_t currentFrame);
+    };
+}
+
+#endif
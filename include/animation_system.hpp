@@ -0,0 +1,240 @@
+#ifndef ANIMATION_SYSTEM_H
+#define ANIMATION_SYSTEM_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <job_system.hpp>
+#include <ds/id_allocator.hpp>
+#include <ds/range_allocator.hpp>
+#include <nlohmann/json.hpp>
+#include <ozz/animation/runtime/animation.h>
+#include <ozz/animation/runtime/sampling_job.h>
+#include <ozz/animation/runtime/skeleton.h>
+#include <ozz/base/containers/vector.h>
+#include <ozz/base/maths/simd_math.h>
+#include <ozz/base/maths/soa_transform.h>
+
+namespace vke_common
+{
+    // most skinning matrices an instance writes, further mesh joints are left unskinned
+    constexpr uint32_t ANIMATION_MAX_SKINNED_JOINTS = 256;
+    // palette ranges start on multiples of this many matrices (256 bytes), which satisfies
+    // minStorageBufferOffsetAlignment on every desktop GPU in case ranges are bound with dynamic offsets
+    constexpr uint32_t ANIMATION_PALETTE_ALIGNMENT = 4;
+
+    // An instance uses the first level whose distance and screen size thresholds it meets, or the last
+    // level if it meets none. Screen size is the bounding radius over the distance, scaled by the
+    // projection, so 1 roughly means the character fills half the screen height.
+    struct AnimationLODLevel
+    {
+        float maxDistance = FLT_MAX;
+        float minScreenSize = 0.0f;
+        uint32_t updateInterval = 1; // frames between evaluations, poses in between are interpolated
+        int32_t maxJointDepth = -1;  // joints deeper than this follow their ancestor rigidly, < 0 keeps all
+
+        void LoadJSON(const nlohmann::json &json)
+        {
+            maxDistance = json.value("maxDistance", maxDistance);
+            minScreenSize = json.value("minScreenSize", minScreenSize);
+            updateInterval = std::max(1u, json.value("updateInterval", updateInterval));
+            maxJointDepth = json.value("maxJointDepth", maxJointDepth);
+        }
+    };
+
+    struct AnimationConfig
+    {
+        uint32_t minInstancesPerTask = 8;
+        bool enableLOD = true;
+        std::vector<AnimationLODLevel> lodLevels = {
+            {15.0f, 0.0f, 1, -1},
+            {40.0f, 0.0f, 2, -1},
+            {80.0f, 0.0f, 4, 10},
+            {FLT_MAX, 0.0f, 8, 6}};
+        // evaluations of throttled instances per frame, 0 is unlimited; full rate instances never wait
+        uint32_t maxThrottledUpdatesPerFrame = 0;
+        // instances of the same clip whose sample times fall in the same quantum share one evaluation
+        bool sharePoses = false;
+        float poseShareQuantum = 1.0f / 120.0f;
+
+        void LoadJSON(const nlohmann::json &json)
+        {
+            if (json.is_null())
+                return;
+
+            minInstancesPerTask = json.value("minInstancesPerTask", minInstancesPerTask);
+            enableLOD = json.value("enableLOD", enableLOD);
+            if (json.contains("lodLevels"))
+            {
+                lodLevels.clear();
+                for (const nlohmann::json &level : json["lodLevels"])
+                    lodLevels.emplace_back().LoadJSON(level);
+            }
+            maxThrottledUpdatesPerFrame = json.value("maxThrottledUpdatesPerFrame", maxThrottledUpdatesPerFrame);
+            sharePoses = json.value("sharePoses", sharePoses);
+            poseShareQuantum = json.value("poseShareQuantum", poseShareQuantum);
+        }
+    };
+
+    struct AnimationInstanceDesc
+    {
+        const ozz::animation::Skeleton *skeleton = nullptr;
+        const ozz::animation::Animation *animation = nullptr;
+        // mesh joint -> skeleton joint, and the matching inverse bind matrices (may be shorter than joints)
+        const std::vector<int> *joints = nullptr;
+        const std::vector<ozz::math::Float4x4> *invBindMatrices = nullptr;
+        // column-major object to world matrix used to pick the LOD, nullptr always uses the first level
+        const float *worldMatrix = nullptr;
+    };
+
+    struct AnimationPlayback
+    {
+        float timeRatio = 0.0f;
+        float playbackSpeed = 1.0f;
+        bool playing = true;
+        bool loop = true;
+    };
+
+    struct AnimationStats
+    {
+        uint32_t evaluations = 0;  // sampling + local to model passes run
+        uint32_t interpolated = 0; // instances written from their two cached key poses
+        uint32_t shared = 0;       // instances that reused another instance's evaluation
+        uint32_t deferred = 0;     // throttled updates pushed to a later frame by the budget
+    };
+
+    // Samples every registered animation instance across the job system and writes skinning matrices
+    // into one shared bone palette. Sampling contexts and pose scratch buffers are per worker, so an
+    // instance only keeps its playback state and a palette range sized to its joint count, plus two
+    // key poses when its LOD updates it below the frame rate.
+    class AnimationSystem
+    {
+    public:
+        // runs on the job system that exists at construction, or serially on the calling thread without one
+        explicit AnimationSystem(const AnimationConfig &config = AnimationConfig{});
+
+        AnimationSystem(const AnimationSystem &) = delete;
+        AnimationSystem &operator=(const AnimationSystem &) = delete;
+
+        uint32_t AddInstance(const AnimationInstanceDesc &desc);
+        void RemoveInstance(uint32_t id);
+
+        AnimationPlayback &GetPlayback(uint32_t id) { return instances[id].playback; }
+        void SetTimeRatio(uint32_t id, float ratio);
+
+        // offset of the instance's skinning matrices in the palette, in matrices; fixed while the instance lives
+        uint32_t GetPaletteOffset(uint32_t id) const { return instances[id].paletteOffset; }
+        uint32_t GetPaletteJointCnt(uint32_t id) const { return instances[id].paletteJointCnt; }
+        // number of matrices the palette has to hold for the current instances
+        uint32_t GetPaletteSize() const { return paletteAllocator.GetEnd(); }
+        // matrices allocated to live instances, including alignment padding
+        uint32_t GetPaletteUsed() const { return paletteAllocator.GetUsed(); }
+        uint32_t GetInstanceCnt() const { return static_cast<uint32_t>(active.size()); }
+        uint32_t GetWorkerCnt() const { return static_cast<uint32_t>(scratches.size()); }
+        const AnimationStats &GetStats() const { return stats; }
+        uint32_t GetLOD(uint32_t id) const { return instances[id].lod; }
+
+        // projectionScale is the projection's vertical focal length, 1 / tan(fovy / 2)
+        void SetViewer(const float position[3], float projectionScale);
+
+        // advances playback by deltaTime and writes column-major float4x4 skinning matrices to palette
+        void Update(float deltaTime, float *palette);
+
+    private:
+        // joints below maxJointDepth keep their rest offset to the deepest kept ancestor
+        struct JointReduction
+        {
+            std::vector<int16_t> anchors; // the joint itself when kept
+            std::vector<uint8_t> keptSoaJoints;
+            ozz::vector<ozz::math::Float4x4> restOffsets;
+        };
+
+        struct SkeletonInfo
+        {
+            uint32_t refCnt = 0;
+            float boundingRadius = 0.0f; // farthest rest pose joint from the origin
+            std::vector<int32_t> depths;
+            std::unordered_map<int32_t, JointReduction> reductions;
+        };
+
+        struct Instance
+        {
+            AnimationInstanceDesc desc;
+            AnimationPlayback playback;
+            SkeletonInfo *skeletonInfo = nullptr;
+            bool alive = false;
+            uint32_t paletteOffset = 0;
+            uint32_t paletteJointCnt = 0;
+            uint32_t lod = 0;
+            uint32_t updateInterval = 1;
+            int32_t maxJointDepth = -1;
+            // frames since nextKey was evaluated, the palette gets lerp(prevKey, nextKey, framesSinceKey / interval)
+            uint32_t framesSinceKey = 0;
+            bool hasKeys = false;
+            ozz::vector<ozz::math::Float4x4> prevKey;
+            ozz::vector<ozz::math::Float4x4> nextKey;
+        };
+
+        struct Evaluation
+        {
+            uint32_t instance;
+            float timeRatio;
+            ozz::math::Float4x4 *output; // nullptr writes the palette slot directly
+        };
+
+        // copies a shared evaluation to an instance that would have evaluated the same pose
+        struct SharedCopy
+        {
+            uint32_t instance;
+            uint32_t pose;
+            ozz::math::Float4x4 *output; // nullptr writes the palette slot directly
+        };
+
+        struct WorkerScratch
+        {
+            ozz::animation::SamplingJob::Context context;
+            ozz::vector<ozz::math::SoaTransform> locals;
+            ozz::vector<ozz::math::Float4x4> models;
+            ozz::vector<ozz::math::Float4x4> skinning;
+        };
+
+        AnimationConfig config;
+        JobSystem *jobSystem;
+        // one per job system worker, indexed by worker index
+        std::vector<std::unique_ptr<WorkerScratch>> scratches;
+        std::vector<Instance> instances;
+        std::vector<uint32_t> active;
+        vke_ds::DynamicIDAllocator<uint32_t> idAllocator;
+        vke_ds::RangeAllocator<uint32_t> paletteAllocator;
+        int maxJointCnt;
+        int maxSoaJointCnt;
+        int maxTrackCnt;
+        std::unordered_map<const ozz::animation::Skeleton *, std::unique_ptr<SkeletonInfo>> skeletonInfos;
+        float viewerPosition[3];
+        float viewerProjectionScale;
+        bool hasViewer;
+        AnimationStats stats;
+        std::vector<Evaluation> evaluations;
+        std::vector<uint32_t> throttled;
+        std::vector<uint32_t> throttledDue;
+        std::vector<SharedCopy> sharedCopies;
+        std::vector<ozz::vector<ozz::math::Float4x4>> sharedPoses;
+
+        SkeletonInfo *acquireSkeletonInfo(const ozz::animation::Skeleton *skeleton);
+        void releaseSkeletonInfo(const ozz::animation::Skeleton *skeleton);
+        void selectLOD(Instance &instance);
+        float advancedRatio(const AnimationPlayback &playback, float duration, float seconds) const;
+        void addKeyEvaluations(uint32_t id, float deltaTime);
+        void shareEvaluations();
+        template <typename Fn>
+        void parallelFor(uint32_t cnt, Fn &&fn);
+        void evaluate(const Instance &instance, float timeRatio, WorkerScratch &scratch);
+        void localToModel(const Instance &instance, WorkerScratch &scratch);
+        void interpolate(const Instance &instance, float *palette) const;
+    };
+}
+
+#endif
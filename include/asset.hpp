@@ -47,6 +47,7 @@ namespace vke_common
     const AssetHandle BUILTIN_COMPUTE_SHADER_LIGHTCULL_ID = 2;
     const AssetHandle BUILTIN_COMPUTE_SHADER_IBL_LUT_ID = 3;
     const AssetHandle BUILTIN_COMPUTE_SHADER_ATMOSPHERE_LUT_ID = 4;
+    const AssetHandle BUILTIN_COMPUTE_SHADER_SKINNING_ID = 5;
 
     const AssetHandle BUILTIN_MATERIAL_DEFAULT_ID = 1;
     const AssetHandle BUILTIN_MATERIAL_SKYBOX_ID = 2;
@@ -436,6 +437,8 @@ namespace vke_common
         std::map<AssetHandle, SceneAsset> sceneCache;
         std::map<AssetHandle, FontAsset> fontCache;
         FT_Library ftLibrary;
+        // where baked static font atlases are kept between runs, empty to always bake
+        std::string fontAtlasCacheDir;
 
         static AssetManager *GetInstance()
         {
@@ -443,7 +446,7 @@ namespace vke_common
             return instance;
         }
 
-        static AssetManager *Init();
+        static AssetManager *Init(const std::string &fontAtlasCacheDir = "");
 
         static void Dispose()
         {
@@ -481,6 +484,9 @@ namespace vke_common
         static std::shared_ptr<vke_common::Animation> LoadAnimation(const AssetHandle hdl);
         static std::shared_ptr<vke_common::Font> LoadFont(const AssetHandle hdl);
 
+        // unpins the dynamic glyphs every loaded font looked up since the previous call, once per engine tick
+        static void EndFontFrame();
+
         ASSET_OP_FUNCS(TextureAsset, textureCache)
         ASSET_OP_FUNCS(MeshAsset, meshCache)
         ASSET_OP_FUNCS(VFShaderAsset, vfShaderCache)
@@ -0,0 +1,111 @@
+#ifndef ATLAS_DIRTY_SLOTS_H
+#define ATLAS_DIRTY_SLOTS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vke_common
+{
+    // a rectangle of atlas pixels
+    struct AtlasRegion
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+
+        bool operator==(const AtlasRegion &) const = default;
+    };
+
+    // Tracks which slots of a grid atlas changed since each frame in flight last uploaded its copy,
+    // and turns them into a few rectangles: runs of dirty slots along a slot row, merged with the
+    // identical run of the row above.
+    class AtlasDirtySlots
+    {
+    public:
+        AtlasDirtySlots(uint32_t frameCnt, uint32_t slotsPerRow, uint32_t slotRowCnt, uint32_t slotSize)
+            : slotsPerRow(slotsPerRow), slotRowCnt(slotRowCnt), slotSize(slotSize),
+              dirty(frameCnt, std::vector<uint8_t>(static_cast<size_t>(slotsPerRow) * slotRowCnt, 0)),
+              dirtyCnts(frameCnt, 0) {}
+
+        void MarkSlot(uint32_t slot)
+        {
+            for (size_t frame = 0; frame < dirty.size(); ++frame)
+            {
+                dirtyCnts[frame] += dirty[frame][slot] == 0 ? 1 : 0;
+                dirty[frame][slot] = 1;
+            }
+        }
+
+        void Clear()
+        {
+            for (size_t frame = 0; frame < dirty.size(); ++frame)
+            {
+                std::fill(dirty[frame].begin(), dirty[frame].end(), uint8_t(0));
+                dirtyCnts[frame] = 0;
+            }
+        }
+
+        bool IsDirty(uint32_t frame) const { return dirtyCnts[frame] > 0; }
+        uint32_t GetDirtySlotCnt(uint32_t frame) const { return dirtyCnts[frame]; }
+
+        // the pixel regions frame has to upload, after which its copy counts as clean
+        void TakeRegions(uint32_t frame, std::vector<AtlasRegion> &regions)
+        {
+            regions.clear();
+            if (dirtyCnts[frame] == 0)
+                return;
+
+            std::vector<uint8_t> &slots = dirty[frame];
+            // in slot units; runs of the previous row that may still grow downwards
+            std::vector<AtlasRegion> open, current;
+            for (uint32_t row = 0; row < slotRowCnt; ++row)
+            {
+                current.clear();
+                uint8_t *rowSlots = slots.data() + static_cast<size_t>(row) * slotsPerRow;
+                size_t openIndex = 0;
+                for (uint32_t column = 0; column < slotsPerRow;)
+                {
+                    if (rowSlots[column] == 0)
+                    {
+                        ++column;
+                        continue;
+                    }
+                    const uint32_t start = column;
+                    while (column < slotsPerRow && rowSlots[column] != 0)
+                        rowSlots[column++] = 0;
+
+                    // both rows list their runs left to right
+                    while (openIndex < open.size() && open[openIndex].x < start)
+                        regions.push_back(open[openIndex++]);
+                    if (openIndex < open.size() && open[openIndex].x == start && open[openIndex].width == column - start)
+                    {
+                        current.push_back(open[openIndex++]);
+                        ++current.back().height;
+                    }
+                    else
+                        current.push_back(AtlasRegion{start, row, column - start, 1});
+                }
+                regions.insert(regions.end(), open.begin() + static_cast<std::ptrdiff_t>(openIndex), open.end());
+                std::swap(open, current);
+            }
+            regions.insert(regions.end(), open.begin(), open.end());
+            dirtyCnts[frame] = 0;
+
+            for (AtlasRegion &region : regions)
+                region = AtlasRegion{region.x * slotSize, region.y * slotSize, region.width * slotSize, region.height * slotSize};
+        }
+
+    private:
+        uint32_t slotsPerRow;
+        uint32_t slotRowCnt;
+        uint32_t slotSize;
+        // one flag per slot and frame in flight
+        std::vector<std::vector<uint8_t>> dirty;
+        std::vector<uint32_t> dirtyCnts;
+    };
+}
+
+#endif
@@ -8,6 +8,7 @@
 #define VKE_FATAL(...)                          \
     {                                           \
         vke_common::Logger::Error(__VA_ARGS__); \
+        vke_common::Logger::Flush();            \
         VKE_EXIT(EXIT_FAILURE)                  \
     }
 
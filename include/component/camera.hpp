@@ -17,7 +17,7 @@ namespace vke_component
     class Camera // TODO only CameraInfo in renderer
     {
     public:
-        vke_ds::id32_t id;
+        vke_ds::id64_t id;
         float width;
         float height;
         vke_render::CameraInfo cameraInfo;
@@ -16,18 +16,20 @@ namespace vke_component
         std::unique_ptr<vke_render::RenderUnit> renderUnit;
         std::unique_ptr<vke_render::RenderUnit> shadowRenderUnit;
         bool castsShadow;
+        // the object is static, its shadow is cached until it moves
+        bool isStatic;
 
         RenderableObject(
             const vke_common::Transform &transform,
             std::shared_ptr<vke_render::Material> &mat,
             std::shared_ptr<const vke_render::Mesh> &mesh)
-            : material(mat), castsShadow(true), shadowRenderID(0)
+            : material(mat), castsShadow(true), isStatic(false), shadowRenderID(0)
         {
             init(transform, mesh);
         }
 
-        RenderableObject(const vke_common::Transform &transform, const nlohmann::json &json)
-            : castsShadow(json.contains("castsShadow") ? json["castsShadow"].get<bool>() : true), shadowRenderID(0)
+        RenderableObject(const vke_common::Transform &transform, const nlohmann::json &json, bool isStatic = false)
+            : castsShadow(json.contains("castsShadow") ? json["castsShadow"].get<bool>() : true), isStatic(isStatic), shadowRenderID(0)
         {
             material = vke_common::AssetManager::LoadMaterial(json["material"]);
             std::shared_ptr<const vke_render::Mesh> mesh = vke_common::AssetManager::LoadMesh(json["mesh"]);
@@ -53,7 +55,7 @@ namespace vke_component
             {
                 vke_render::ShadowPass *shadowPass = renderer->GetShadowPass();
                 if (shadowPass != nullptr)
-                    shadowRenderID = shadowPass->AddUnit(shadowRenderUnit.get());
+                    shadowRenderID = shadowPass->AddUnit(shadowRenderUnit.get(), false, isStatic);
             }
         }
 
@@ -73,6 +75,15 @@ namespace vke_component
             }
         }
 
+        void OnTransformed(const vke_common::Transform &transform)
+        {
+            if (!isStatic || shadowRenderID == 0)
+                return;
+            vke_render::ShadowPass *shadowPass = vke_render::Renderer::GetInstance()->GetShadowPass();
+            if (shadowPass != nullptr)
+                shadowPass->MarkStaticCastersDirty();
+        }
+
         nlohmann::json ToJSON()
         {
             nlohmann::json ret = {
@@ -43,17 +43,15 @@ namespace vke_component
         void LoadToEngine(uint32_t entity = 0)
         {
             settings.mUserData = static_cast<uint64_t>(entity);
+            bodyID = vke_physics::PhysicsManager::CreateAndAddBody(settings, JPH::EActivation::Activate);
             JPH::BodyInterface &interface = vke_physics::PhysicsManager::GetBodyInterface();
-            bodyID = interface.CreateAndAddBody(settings, JPH::EActivation::Activate);
             interface.SetFriction(bodyID, friction);
             interface.SetRestitution(bodyID, restitution);
         }
 
         void UnloadFromEngine()
         {
-            JPH::BodyInterface &interface = vke_physics::PhysicsManager::GetBodyInterface();
-            interface.RemoveBody(bodyID);
-            interface.DestroyBody(bodyID);
+            vke_physics::PhysicsManager::RemoveAndDestroyBody(bodyID);
         }
 
         nlohmann::json ToJSON()
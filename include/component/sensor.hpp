@@ -35,15 +35,12 @@ namespace vke_component
         void LoadToEngine(uint32_t entity = 0)
         {
             settings.mUserData = static_cast<uint64_t>(entity);
-            JPH::BodyInterface &interface = vke_physics::PhysicsManager::GetBodyInterface();
-            bodyID = interface.CreateAndAddBody(settings, JPH::EActivation::Activate);
+            bodyID = vke_physics::PhysicsManager::CreateAndAddBody(settings, JPH::EActivation::Activate);
         }
 
         void UnloadFromEngine()
         {
-            JPH::BodyInterface &interface = vke_physics::PhysicsManager::GetBodyInterface();
-            interface.RemoveBody(bodyID);
-            interface.DestroyBody(bodyID);
+            vke_physics::PhysicsManager::RemoveAndDestroyBody(bodyID);
         }
 
         nlohmann::json ToJSON()
@@ -1,21 +1,18 @@
 #ifndef SKELETON_ANIMATOR_H
 #define SKELETON_ANIMATOR_H
 
-#include <time.hpp>
 #include <component/transform.hpp>
 #include <animation.hpp>
+#include <animation_manager.hpp>
 #include <render/render.hpp>
-#include <ozz/animation/runtime/local_to_model_job.h>
-#include <ozz/animation/runtime/sampling_job.h>
-#include <ozz/base/maths/soa_transform.h>
-#include <ozz/base/maths/vec_float.h>
-#include <ozz/base/maths/simd_math.h>
-#include <ozz/base/containers/vector.h>
 
 namespace vke_component
 {
 
-    const uint32_t MAX_BONE_PER_SKELETON = 256;
+    const uint32_t MAX_BONE_PER_SKELETON = vke_common::ANIMATION_MAX_SKINNED_JOINTS;
+    // jointOffset follows the model matrix in default_skin.vert, and shadowIndex/shadowType in shadow_skin.vert
+    const uint32_t SKIN_JOINT_OFFSET_PUSH_CONSTANT = sizeof(glm::mat4);
+    const uint32_t SHADOW_SKIN_JOINT_OFFSET_PUSH_CONSTANT = sizeof(glm::mat4) + 2 * sizeof(uint32_t);
 
     class SkeletonAnimator
     {
@@ -33,13 +30,13 @@ namespace vke_component
             std::shared_ptr<const vke_render::Mesh> &mesh,
             std::shared_ptr<vke_common::Skeleton> &skeleton,
             std::shared_ptr<vke_common::Animation> &animation)
-            : material(mat), skeleton(skeleton), animation(animation), castsShadow(true), shadowRenderID(0)
+            : material(mat), skeleton(skeleton), animation(animation), castsShadow(true), shadowRenderID(0), loaded(false), computeSkinned(false)
         {
             init(transform, mesh);
         }
 
         SkeletonAnimator(const vke_common::Transform &transform, const nlohmann::json &json)
-            : castsShadow(json.contains("castsShadow") ? json["castsShadow"].get<bool>() : true), shadowRenderID(0)
+            : castsShadow(json.contains("castsShadow") ? json["castsShadow"].get<bool>() : true), shadowRenderID(0), loaded(false), computeSkinned(false)
         {
             material = vke_common::AssetManager::LoadMaterial(json["material"]);
             std::shared_ptr<const vke_render::Mesh> mesh = vke_common::AssetManager::LoadMesh(json["mesh"]);
@@ -53,20 +50,52 @@ namespace vke_component
         void LoadToEngine()
         {
             vke_render::Renderer *renderer = vke_render::Renderer::GetInstance();
-            renderID = renderer->GetGBufferPass()->AddUnit(material, renderUnit.get(), true);
+            // only the builtin skin shader has a static counterpart to draw compute skinned output with
+            vke_render::ComputeSkinningManager *skinningManager = renderer->GetComputeSkinningManager();
+            const bool useComputeSkinning = skinningManager != nullptr &&
+                                            material->shader == vke_common::AssetManager::LoadVertFragShader(vke_common::BUILTIN_VFSHADER_DEFAULT_SKIN_ID);
+            if (useComputeSkinning != computeSkinned)
+            {
+                computeSkinned = useComputeSkinning;
+                std::shared_ptr<const vke_render::Mesh> mesh = renderUnit->mesh;
+                createUnits(mesh);
+            }
+
+            const vke_render::Mesh &mesh = *(renderUnit->mesh);
+            vke_common::AnimationInstanceDesc desc;
+            desc.skeleton = &(skeleton->skeleton);
+            desc.animation = &(animation->animation);
+            desc.joints = &mesh.joints;
+            desc.invBindMatrices = &mesh.invBindMatrices;
+            desc.worldMatrix = &(*modelMatrix)[0][0];
+            if (computeSkinned)
+            {
+                animationID = vke_common::AnimationManager::Register(desc, {});
+                skinningID = skinningManager->AddInstance(renderUnit->mesh, vke_common::AnimationManager::GetSystem().GetPaletteOffset(animationID),
+                                                          {renderUnit.get(), shadowRenderUnit.get()});
+                renderMaterial = skinningManager->GetStaticMaterial(material);
+            }
+            else
+            {
+                animationID = vke_common::AnimationManager::Register(desc, {renderUnit.get(), shadowRenderUnit.get()});
+                renderMaterial = material;
+            }
+            vke_common::AnimationManager::GetSystem().GetPlayback(animationID) = playback;
+            loaded = true;
+
+            renderID = renderer->GetGBufferPass()->AddUnit(renderMaterial, renderUnit.get(), !computeSkinned);
             if (castsShadow)
             {
                 vke_render::ShadowPass *shadowPass = renderer->GetShadowPass();
                 if (shadowPass != nullptr)
-                    shadowRenderID = shadowPass->AddUnit(shadowRenderUnit.get(), true);
+                    shadowRenderID = shadowPass->AddUnit(shadowRenderUnit.get(), !computeSkinned);
             }
-            renderer->AddRenderUpdateCallback(renderID, std::bind(&SkeletonAnimator::update, this, std::placeholders::_1));
         }
 
         void UnloadFromEngine()
         {
             vke_render::Renderer *renderer = vke_render::Renderer::GetInstance();
-            renderer->GetGBufferPass()->RemoveUnit(material.get(), renderID);
+            renderer->GetGBufferPass()->RemoveUnit(renderMaterial.get(), renderID);
             if (castsShadow && shadowRenderID != 0)
             {
                 vke_render::ShadowPass *shadowPass = renderer->GetShadowPass();
@@ -74,7 +103,12 @@ namespace vke_component
                     shadowPass->RemoveUnit(shadowRenderID);
                 shadowRenderID = 0;
             }
-            renderer->RemoveRenderUpdateCallback(renderID);
+
+            if (computeSkinned)
+                renderer->GetComputeSkinningManager()->RemoveInstance(skinningID);
+            playback = vke_common::AnimationManager::GetSystem().GetPlayback(animationID);
+            vke_common::AnimationManager::Unregister(animationID);
+            loaded = false;
         }
 
         nlohmann::json ToJSON()
@@ -91,59 +125,29 @@ namespace vke_component
 
         void SetTimeRatio(float ratio)
         {
-            timeRatio = loop ? ratio - glm::floor(ratio) : glm::clamp(ratio, 0.0f, 1.0f);
+            if (loaded)
+                vke_common::AnimationManager::GetSystem().SetTimeRatio(animationID, ratio);
+            else
+                playback.timeRatio = playback.loop ? ratio - glm::floor(ratio) : glm::clamp(ratio, 0.0f, 1.0f);
         }
 
     private:
         vke_ds::id64_t renderID;
         vke_ds::id64_t shadowRenderID;
+        uint32_t animationID;
+        uint32_t skinningID;
+        bool loaded;
+        // drawn as static geometry from the ComputeSkinningManager's output with renderMaterial
+        bool computeSkinned;
+        std::shared_ptr<vke_render::Material> renderMaterial;
+        // playback state while the animator is not registered with the AnimationManager
+        vke_common::AnimationPlayback playback;
+        const glm::mat4 *modelMatrix;
 
         void init(const vke_common::Transform &transform, std::shared_ptr<const vke_render::Mesh> &mesh)
         {
-            timeRatio = 0.0f;
-            playbackSpeed = 1.0f;
-            playing = true;
-            loop = true;
-
-            int numSOAJoints = skeleton->skeleton.num_soa_joints();
-            locals.resize(numSOAJoints);
-            int numJoints = skeleton->skeleton.num_joints();
-            models.resize(numJoints);
-            context.Resize(numJoints);
-            skinningMatrices.resize(mesh->joints.size());
-
-            for (int i = 0; i < vke_render::MAX_FRAMES_IN_FLIGHT; ++i)
-                skeletonBuffers.emplace_back(sizeof(float) * 16 * MAX_BONE_PER_SKELETON, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-
-            VkDescriptorSetLayoutBinding layoutBinding{};
-            layoutBinding.binding = 0;
-            layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            layoutBinding.descriptorCount = 1;
-            layoutBinding.stageFlags = VK_SHADER_STAGE_ALL;
-
-            vke_render::DescriptorSetInfo descriptorSetInfo;
-            descriptorSetInfo.AddCnt(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1);
-
-            VkDescriptorSetLayoutCreateInfo layoutInfo{};
-            layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-            layoutInfo.bindingCount = 1;
-            layoutInfo.pBindings = &layoutBinding;
-            vkCreateDescriptorSetLayout(vke_render::globalLogicalDevice, &layoutInfo, nullptr, &(descriptorSetInfo.layout));
-
-            descriptorSets.resize(vke_render::MAX_FRAMES_IN_FLIGHT);
-            for (int i = 0; i < vke_render::MAX_FRAMES_IN_FLIGHT; ++i)
-                descriptorSets[i] = vke_render::DescriptorSetAllocator::AllocateDescriptorSet(descriptorSetInfo);
-
-            VkWriteDescriptorSet descriptorSetWrite{};
-            for (int i = 0; i < vke_render::MAX_FRAMES_IN_FLIGHT; ++i)
-            {
-                VkDescriptorBufferInfo bufferInfo = skeletonBuffers[i].GetDescriptorBufferInfo();
-                vke_render::ConstructDescriptorSetWrite(descriptorSetWrite, descriptorSets[i], 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &bufferInfo);
-                vkUpdateDescriptorSets(vke_render::globalLogicalDevice, 1, &descriptorSetWrite, 0, nullptr);
-            }
-
-            renderUnit = std::make_unique<vke_render::RenderUnit>(mesh, &transform.model, static_cast<uint32_t>(sizeof(glm::mat4)), descriptorSets[0]);
-            shadowRenderUnit = std::make_unique<vke_render::RenderUnit>(mesh, &transform.model, static_cast<uint32_t>(sizeof(glm::mat4)), descriptorSets[0]);
+            modelMatrix = &transform.model;
+            createUnits(mesh);
 
             const auto &names = skeleton->skeleton.joint_names();
             for (auto &n : names)
@@ -152,57 +156,30 @@ namespace vke_component
             }
         }
 
-        void update(uint32_t currentFrame)
+        void createUnits(std::shared_ptr<const vke_render::Mesh> &mesh)
         {
-            if (playing)
+            if (computeSkinned)
             {
-                float dt = vke_common::TimeManager::GetInstance()->deltaTime;
-                float newRatio = timeRatio + dt * playbackSpeed / animation->Duration();
-                SetTimeRatio(newRatio);
+                // the vertex buffer override is assigned by the ComputeSkinningManager
+                renderUnit = std::make_unique<vke_render::RenderUnit>(mesh, modelMatrix, static_cast<uint32_t>(sizeof(glm::mat4)));
+                shadowRenderUnit = std::make_unique<vke_render::RenderUnit>(mesh, modelMatrix, static_cast<uint32_t>(sizeof(glm::mat4)));
+                return;
             }
 
-            ozz::animation::SamplingJob sampling_job;
-            sampling_job.animation = &(animation->animation);
-            sampling_job.context = &context;
-            sampling_job.ratio = timeRatio;
-            sampling_job.output = make_span(locals);
-            if (!sampling_job.Run())
-                VKE_LOG_ERROR("SAMPLING FAIL")
-
-            ozz::animation::LocalToModelJob ltm_job;
-            ltm_job.skeleton = &(skeleton->skeleton);
-            ltm_job.input = make_span(locals);
-            ltm_job.output = make_span(models);
-            if (!ltm_job.Run())
-                VKE_LOG_ERROR("LTM FAIL")
-
-            const vke_render::Mesh &mesh = *(renderUnit->mesh);
-            for (int i = 0; i < skinningMatrices.size(); ++i)
-            {
-                int idx = mesh.joints[i];
-                skinningMatrices[i] = i < mesh.invBindMatrices.size()
-                                          ? models[idx] * mesh.invBindMatrices[i]
-                                          : models[idx];
-            }
-
-            float *bufferp = (float *)(skeletonBuffers[currentFrame].data);
-            for (int i = 0; i < skinningMatrices.size(); ++i)
-                for (int j = 0; j < 4; ++j)
-                    ozz::math::StorePtrU(skinningMatrices[i].cols[j], bufferp + (i << 4) + (j << 2));
-            renderUnit->perUnitDescriptorSet = descriptorSets[currentFrame];
-            shadowRenderUnit->perUnitDescriptorSet = descriptorSets[currentFrame];
+            // the descriptor set and the joint offset's value are assigned by the AnimationManager
+            renderUnit = std::make_unique<vke_render::RenderUnit>(
+                mesh,
+                std::vector<vke_render::PushConstantInfo>{
+                    vke_render::PushConstantInfo(sizeof(glm::mat4), modelMatrix),
+                    vke_render::PushConstantInfo(sizeof(uint32_t), nullptr, false, SKIN_JOINT_OFFSET_PUSH_CONSTANT)},
+                2);
+            shadowRenderUnit = std::make_unique<vke_render::RenderUnit>(
+                mesh,
+                std::vector<vke_render::PushConstantInfo>{
+                    vke_render::PushConstantInfo(sizeof(glm::mat4), modelMatrix),
+                    vke_render::PushConstantInfo(sizeof(uint32_t), nullptr, false, SHADOW_SKIN_JOINT_OFFSET_PUSH_CONSTANT)},
+                2);
         }
-
-        float timeRatio;
-        float playbackSpeed;
-        bool playing;
-        bool loop;
-        ozz::animation::SamplingJob::Context context;
-        ozz::vector<ozz::math::SoaTransform> locals;
-        ozz::vector<ozz::math::Float4x4> models;
-        ozz::vector<ozz::math::Float4x4> skinningMatrices;
-        std::vector<VkDescriptorSet> descriptorSets;
-        std::vector<vke_render::HostCoherentBuffer> skeletonBuffers;
     };
 }
 
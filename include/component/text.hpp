@@ -5,6 +5,7 @@
 #include <font.hpp>
 #include <nlohmann/json.hpp>
 #include <asset.hpp>
+#include <text_layout.hpp>
 #include <string>
 #include <string_view>
 
@@ -29,7 +30,7 @@ namespace vke_component
                               ? vke_common::AssetManager::LoadMaterial(json["material"].get<vke_common::AssetHandle>())
                               : nullptr,
                           glyphData),
-              text(json.value("text", std::string())),
+              text(json.value("text", std::string())), wrapWidth(json.value("wrapWidth", 0.0f)),
               font(vke_common::AssetManager::LoadFont(vke_common::BUILTIN_FONT_ARIAL_ID))
         {
             if (json.contains("color"))
@@ -41,6 +42,11 @@ namespace vke_component
             rebuild();
         }
 
+        ~UIText() override
+        {
+            vke_common::TextLayoutCache::GetInstance()->CancelDeferred(this);
+        }
+
         bool LoadToEngine()
         {
             return UIComponent::LoadToEngine();
@@ -48,10 +54,21 @@ namespace vke_component
 
         void SetText(std::string_view newText)
         {
+            if (newText == text)
+                return;
             text.assign(newText);
             rebuild();
         }
 
+        // in pixels, 0 keeps every line unbroken
+        void SetWrapWidth(float newWrapWidth)
+        {
+            if (newWrapWidth == wrapWidth)
+                return;
+            wrapWidth = newWrapWidth;
+            rebuild();
+        }
+
         void SetColor(const glm::vec4 &newColor)
         {
             color = newColor;
@@ -60,74 +77,54 @@ namespace vke_component
 
         const std::string &GetText() const { return text; }
         const glm::vec4 &GetColor() const { return color; }
+        float GetWrapWidth() const { return wrapWidth; }
         nlohmann::json ToJSON() const
         {
             return {
                 {"type", "uiText"},
                 {"text", text},
+                {"wrapWidth", wrapWidth},
                 {"color", {color.r, color.g, color.b, color.a}},
                 {"material", GetMaterial() == nullptr ? 0 : GetMaterial()->handle}};
         }
 
     private:
         std::string text;
+        float wrapWidth = 0.0f;
         glm::vec4 color{1.0f};
         std::shared_ptr<vke_common::Font> font;
+        // what the glyphs currently show, a later text with the same beginning resumes from it
+        vke_common::TextLayout layout;
 
         bool rebuild()
         {
-            std::vector<vke_render::GlyphInstanceGPU> glyphs;
-            glyphs.reserve(text.size());
-
-            int penX = 0;
-            int baselineY = font->ascender;
-            glm::vec2 minimum(std::numeric_limits<float>::max());
-            glm::vec2 maximum(std::numeric_limits<float>::lowest());
-            bool hasBounds = false;
-
-            for (uint32_t codepoint : vke_common::Font::DecodeUTF8(text))
-            {
-                if (codepoint == '\n')
+            vke_common::TextLayoutCache *cache = vke_common::TextLayoutCache::GetInstance();
+            const vke_common::TextLayoutFont layoutFont{font->handle, font->pixelSize, font->ascender,
+                                                        font->lineHeight, font->GetDynamicAtlasGeneration()};
+            const bool laidOut = cache->Layout(
+                layoutFont, text, wrapWidth, layout, [this](uint32_t codepoint)
                 {
-                    penX = 0;
-                    baselineY += font->lineHeight;
-                    continue;
-                }
-
-                vke_common::Glyph *glyph = font->GetOrCreateGlyph(codepoint);
-                if (glyph == nullptr)
-                    glyph = font->GetOrCreateGlyph('?');
-                if (glyph == nullptr)
-                    continue;
-
-                if (glyph->width > 0 && glyph->height > 0)
-                {
-                    const float minX = static_cast<float>(penX + glyph->bearingX);
-                    const float minY = static_cast<float>(baselineY - glyph->bearingY);
-                    const float maxX = minX + static_cast<float>(glyph->width);
-                    const float maxY = minY + static_cast<float>(glyph->height);
-
-                    vke_render::GlyphInstanceGPU instance{};
-                    instance.quadRect = glm::vec4(minX, minY, maxX, maxY);
-                    instance.uvRect = glm::vec4(
-                        static_cast<float>(glyph->atlasX), static_cast<float>(glyph->atlasY),
-                        static_cast<float>(glyph->atlasX + glyph->width),
-                        static_cast<float>(glyph->atlasY + glyph->height));
-                    instance.color = color;
-                    instance.atlasInfo.x = static_cast<uint32_t>(glyph->atlasType);
-                    glyphs.push_back(instance);
-
-                    minimum = glm::min(minimum, glm::vec2(minX, minY));
-                    maximum = glm::max(maximum, glm::vec2(maxX, maxY));
-                    hasBounds = true;
-                }
-                penX += glyph->advanceX;
+                    vke_common::Glyph *glyph = font->GetOrCreateGlyph(codepoint);
+                    return glyph == nullptr ? font->GetOrCreateGlyph('?') : glyph; });
+            if (!laidOut)
+            {
+                // this frame's layout budget is spent, the old text stays up until the retry
+                cache->Defer(this, [this]()
+                             { rebuild(); });
+                return true;
             }
 
-            const vke_common::AABB2D bounds = hasBounds
-                                                  ? vke_common::AABB2D(minimum, maximum)
-                                                  : vke_common::AABB2D(glm::vec2(0.0f), glm::vec2(0.0f));
-            return SetGeometry(std::move(glyphs), bounds);
+            std::vector<vke_render::GlyphInstanceGPU> glyphs(layout.glyphs.size());
+            for (size_t i = 0; i < glyphs.size(); ++i)
+            {
+                const vke_common::LaidOutGlyph &laidOut = layout.glyphs[i];
+                vke_render::GlyphInstanceGPU &instance = glyphs[i];
+                instance.quadRect = laidOut.quadRect;
+                instance.uvRect = laidOut.uvRect;
+                instance.color = color;
+                instance.atlasInfo = glm::uvec4(static_cast<uint32_t>(laidOut.atlasType), 0, 0, 0);
+            }
+            return SetGeometry(std::move(glyphs), vke_common::AABB2D(layout.minimum, layout.maximum));
         }
     };
 }
@@ -26,7 +26,7 @@ namespace vke_component
             : transform(&transform), material(std::move(material)), glyphData(glyphData) {}
         virtual ~UIComponent()
         {
-            glyphData->Release(glyphIDs);
+            glyphData->Release(glyphRange);
         }
 
         UIComponent(const UIComponent &) = delete;
@@ -86,8 +86,7 @@ namespace vke_component
         bool SetGeometry(std::vector<vke_render::GlyphInstanceGPU> newGlyphs,
                          const vke_common::AABB2D &newLocalBounds)
         {
-            if (!setGlyphs(std::move(newGlyphs)))
-                return false;
+            const bool glyphIDsChanged = setGlyphs(std::move(newGlyphs));
             if (!IsLoaded())
             {
                 localBounds = newLocalBounds;
@@ -95,8 +94,10 @@ namespace vke_component
             }
 
             vke_render::Layered2DRenderer *renderer = vke_render::Renderer::GetLayered2DRenderer();
-            if (!renderer->UpdateUnitGlyphIDs(id, glyphIDs))
+            if (glyphIDsChanged && !renderer->UpdateUnitGlyphIDs(id, glyphIDs))
                 return false;
+            if (newLocalBounds.min == localBounds.min && newLocalBounds.max == localBounds.max)
+                return true;
             localBounds = newLocalBounds;
             syncSpatialLayer();
             return true;
@@ -104,8 +105,7 @@ namespace vke_component
 
         void SetGlyphColor(const glm::vec4 &color)
         {
-            for (vke_render::GlyphID glyphID : glyphIDs)
-                glyphData->UpdateColor(glyphID, color);
+            glyphData->UpdateColor(glyphRange, color);
         }
 
         bool IsLoaded() const { return id != INVALID_ID; }
@@ -116,6 +116,7 @@ namespace vke_component
         std::vector<vke_render::GlyphID> glyphIDs;
 
     private:
+        vke_render::GlyphRange glyphRange;
         vke_ds::id32_t id = INVALID_ID;
         vke_common::AABB2D localBounds;
         vke_render::Layered2DRenderUnit *renderUnit = nullptr;
@@ -159,15 +160,22 @@ namespace vke_component
             renderer->SetLayerOrder(spatialManager->GetLayerOrder());
         }
 
+        // whether the glyphs got new IDs
         bool setGlyphs(std::vector<vke_render::GlyphInstanceGPU> newGlyphs)
         {
-            if (!glyphData->CanAllocate(newGlyphs.size(), glyphIDs.size()))
+            // same length, e.g. a ticking counter: the changed glyphs are rewritten in place
+            if (newGlyphs.size() == glyphRange.count)
+            {
+                glyphData->Update(glyphRange, newGlyphs);
                 return false;
+            }
 
-            glyphData->Release(glyphIDs);
-            std::vector<vke_render::GlyphID> newGlyphIDs;
-            glyphData->Allocate(newGlyphs, newGlyphIDs);
-            glyphIDs = std::move(newGlyphIDs);
+            // released first, so the new glyphs can reuse the old range
+            glyphData->Release(glyphRange);
+            glyphRange = glyphData->Allocate(newGlyphs);
+            glyphIDs.resize(glyphRange.count);
+            for (uint32_t i = 0; i < glyphRange.count; ++i)
+                glyphIDs[i] = glyphRange.offset + i;
             return true;
         }
     };
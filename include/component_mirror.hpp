@@ -0,0 +1,50 @@
+#ifndef COMPONENT_MIRROR_H
+#define COMPONENT_MIRROR_H
+
+#include <entt/entt.hpp>
+#include <interop/mirror.hpp>
+#include <vector>
+
+namespace vke_common
+{
+    // Structure-of-arrays copy of hot component data, shared read-only with managed code.
+    // Refreshed once per frame after physics, so scripts can read world transforms and
+    // body state through spans instead of one native call per value.
+    class ComponentMirror
+    {
+    public:
+        static ComponentMirror *GetInstance();
+        static ComponentMirror *Init();
+        static void Dispose();
+
+        static void Refresh(entt::registry &registry) { instance->refresh(registry); }
+        static void Clear() { instance->clear(); }
+        static const vke_interop::ComponentMirrorView *GetView() { return &instance->view; }
+
+    private:
+        static ComponentMirror *instance;
+
+        ComponentMirror() = default;
+        ComponentMirror(const ComponentMirror &) = delete;
+        ComponentMirror &operator=(const ComponentMirror &) = delete;
+
+        vke_interop::ComponentMirrorView view{};
+        std::vector<uint32_t> entities;
+        std::vector<uint32_t> flags;
+        std::vector<vke_interop::Vector3<float>> worldPositions;
+        std::vector<vke_interop::Quaternion<float>> worldRotations;
+        std::vector<vke_interop::Vector3<float>> linearVelocities;
+        std::vector<vke_interop::Vector3<float>> angularVelocities;
+
+        std::vector<uint32_t> bodyIndices;
+        std::vector<uint32_t> bodyIDs;
+
+        void refresh(entt::registry &registry);
+        void clear();
+        void reserve(uint32_t capacity);
+        void beginWrite();
+        void endWrite();
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef DIRTY_SPANS_H
+#define DIRTY_SPANS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace vke_ds
+{
+    // a half open range [begin, end) of elements
+    struct Span
+    {
+        uint32_t begin;
+        uint32_t end;
+
+        bool operator==(const Span &) const = default;
+    };
+
+    // Collects the element spans written since each frame in flight last uploaded its copy and hands
+    // them out sorted, with overlapping and adjacent spans merged into one.
+    class DirtySpans
+    {
+    public:
+        explicit DirtySpans(uint32_t frameCnt) : pending(frameCnt) {}
+
+        void Mark(uint32_t begin, uint32_t end)
+        {
+            if (begin >= end)
+                return;
+            for (std::vector<Span> &spans : pending)
+                add(spans, begin, end);
+        }
+
+        void MarkFrame(uint32_t frame, uint32_t begin, uint32_t end)
+        {
+            if (begin < end)
+                add(pending[frame], begin, end);
+        }
+
+        void Clear()
+        {
+            for (std::vector<Span> &spans : pending)
+                spans.clear();
+        }
+
+        bool IsDirty(uint32_t frame) const { return !pending[frame].empty(); }
+
+        // the spans frame has to upload, after which its copy counts as clean; spans separated by at
+        // most mergeGap clean elements are joined too, trading a few redundant elements for fewer copies
+        void Take(uint32_t frame, std::vector<Span> &spans, uint32_t mergeGap = 0)
+        {
+            spans.clear();
+            std::vector<Span> &marked = pending[frame];
+            std::sort(marked.begin(), marked.end(), [](const Span &a, const Span &b)
+                      { return a.begin < b.begin; });
+            for (const Span &span : marked)
+            {
+                if (!spans.empty() && span.begin <= spans.back().end + mergeGap)
+                    spans.back().end = std::max(spans.back().end, span.end);
+                else
+                    spans.push_back(span);
+            }
+            marked.clear();
+        }
+
+    private:
+        std::vector<std::vector<Span>> pending;
+
+        // consecutive writes usually continue the previous span, so those are folded in right away
+        static void add(std::vector<Span> &spans, uint32_t begin, uint32_t end)
+        {
+            if (!spans.empty() && begin <= spans.back().end && end >= spans.back().begin)
+            {
+                spans.back().begin = std::min(spans.back().begin, begin);
+                spans.back().end = std::max(spans.back().end, end);
+                return;
+            }
+            spans.push_back(Span{begin, end});
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef HANDLE_MAP_H
+#define HANDLE_MAP_H
+
+#include <ds/id_allocator.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vke_ds
+{
+    // Values owned by generational handles. The values sit packed in a dense array, iterated in no
+    // particular order; a sparse array indexed by the handle's slot points into it, so lookup, insert
+    // and erase are O(1) and stale handles find nothing. Erase moves the last value into the hole.
+    template <typename T>
+    class HandleMap
+    {
+    public:
+        explicit HandleMap(uint32_t maxCnt = UINT32_MAX) : allocator(maxCnt) {}
+
+        // an invalid handle once maxCnt values are live
+        Handle Insert(T value)
+        {
+            Handle handle = allocator.Alloc();
+            if (handle.generation == 0)
+                return handle;
+            if (handle.index >= slotToDense.size())
+                slotToDense.resize(handle.index + 1);
+            slotToDense[handle.index] = static_cast<uint32_t>(values.size());
+            values.push_back(std::move(value));
+            denseToHandle.push_back(handle);
+            return handle;
+        }
+
+        bool Erase(Handle handle)
+        {
+            if (!allocator.Free(handle))
+                return false;
+            const uint32_t dense = slotToDense[handle.index];
+            const uint32_t last = static_cast<uint32_t>(values.size() - 1);
+            if (dense != last)
+            {
+                values[dense] = std::move(values[last]);
+                denseToHandle[dense] = denseToHandle[last];
+                slotToDense[denseToHandle[dense].index] = dense;
+            }
+            values.pop_back();
+            denseToHandle.pop_back();
+            return true;
+        }
+
+        T *Find(Handle handle)
+        {
+            return allocator.IsValid(handle) ? &values[slotToDense[handle.index]] : nullptr;
+        }
+
+        const T *Find(Handle handle) const
+        {
+            return allocator.IsValid(handle) ? &values[slotToDense[handle.index]] : nullptr;
+        }
+
+        bool Contains(Handle handle) const { return allocator.IsValid(handle); }
+        uint32_t Size() const { return static_cast<uint32_t>(values.size()); }
+        bool Empty() const { return values.empty(); }
+
+        // the handle of the value at dense position i
+        Handle HandleAt(uint32_t i) const { return denseToHandle[i]; }
+        T &ValueAt(uint32_t i) { return values[i]; }
+        const T &ValueAt(uint32_t i) const { return values[i]; }
+
+        typename std::vector<T>::iterator begin() { return values.begin(); }
+        typename std::vector<T>::iterator end() { return values.end(); }
+        typename std::vector<T>::const_iterator begin() const { return values.begin(); }
+        typename std::vector<T>::const_iterator end() const { return values.end(); }
+
+        void Clear()
+        {
+            allocator.Clear();
+            slotToDense.clear();
+            values.clear();
+            denseToHandle.clear();
+        }
+
+    private:
+        GenerationalIDAllocator allocator;
+        std::vector<uint32_t> slotToDense;
+        std::vector<T> values;
+        std::vector<Handle> denseToHandle;
+    };
+
+    // A flat map keyed by handles someone else allocates, e.g. entities: one entry per slot index,
+    // holding the generation it was set for. A key whose generation does not match finds nothing.
+    // Memory follows the highest slot index used, which suits keys allocated densely from 0.
+    template <typename V>
+    class SparseHandleMap
+    {
+    public:
+        // replaces the entry of any other generation in the slot
+        void Set(Handle key, V value)
+        {
+            if (key.index >= entries.size())
+                entries.resize(key.index + 1);
+            Entry &entry = entries[key.index];
+            cnt += entry.used ? 0 : 1;
+            entry = Entry{key.generation, true, std::move(value)};
+        }
+
+        bool Erase(Handle key)
+        {
+            if (Find(key) == nullptr)
+                return false;
+            entries[key.index] = Entry{};
+            --cnt;
+            return true;
+        }
+
+        V *Find(Handle key)
+        {
+            if (key.index >= entries.size())
+                return nullptr;
+            Entry &entry = entries[key.index];
+            return entry.used && entry.generation == key.generation ? &entry.value : nullptr;
+        }
+
+        const V *Find(Handle key) const
+        {
+            return const_cast<SparseHandleMap *>(this)->Find(key);
+        }
+
+        bool Contains(Handle key) const { return Find(key) != nullptr; }
+        uint32_t Size() const { return cnt; }
+
+        void Clear()
+        {
+            entries.clear();
+            cnt = 0;
+        }
+
+    private:
+        struct Entry
+        {
+            uint32_t generation = 0;
+            bool used = false;
+            V value{};
+        };
+
+        std::vector<Entry> entries;
+        uint32_t cnt = 0;
+    };
+}
+
+#endif
\ No newline at end of file
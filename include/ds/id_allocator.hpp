@@ -1,6 +1,9 @@
 #ifndef IDALLOC_H
 #define IDALLOC_H
 
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
 #include <optional>
 #include <vector>
 
@@ -58,12 +61,171 @@ namespace vke_ds
 
         void Free(T id)
         {
+            // more frees than ids handed out, a double free; the id is already free
+            if (top >= ids.size())
+                return;
             ids[top++] = id;
         }
 
     private:
         std::vector<T> ids;
     };
+
+    // A slot index plus the generation the slot had when the handle was handed out. Freeing the slot
+    // bumps its generation, so a handle kept past its Free no longer matches and is rejected instead
+    // of aliasing whatever takes the slot next. Generations start at 1, the packed id of a valid
+    // handle is never INVALID_HANDLE_ID.
+    struct Handle
+    {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+
+        id64_t ToID() const { return (static_cast<id64_t>(generation) << 32) | index; }
+        static Handle FromID(id64_t id) { return Handle{static_cast<uint32_t>(id), static_cast<uint32_t>(id >> 32)}; }
+        bool operator==(const Handle &) const = default;
+    };
+
+    constexpr id64_t INVALID_HANDLE_ID = 0;
+
+    // Hands out Handles and reuses the slots of freed ones; a slot whose generation wraps around is
+    // retired for good. Stale and repeated frees are refused, so the free list never holds more
+    // entries than there are slots.
+    class GenerationalIDAllocator
+    {
+    public:
+        explicit GenerationalIDAllocator(uint32_t maxSlotCnt = UINT32_MAX) : maxSlotCnt(maxSlotCnt), liveCnt(0) {}
+
+        // an invalid handle once maxSlotCnt slots are live
+        Handle Alloc()
+        {
+            uint32_t index;
+            if (!freeList.empty())
+            {
+                index = freeList.back();
+                freeList.pop_back();
+            }
+            else if (slots.size() < maxSlotCnt)
+            {
+                index = static_cast<uint32_t>(slots.size());
+                slots.push_back(Slot{1, false});
+            }
+            else
+                return Handle{};
+
+            slots[index].live = true;
+            ++liveCnt;
+            return Handle{index, slots[index].generation};
+        }
+
+        bool Free(Handle handle)
+        {
+            if (!IsValid(handle))
+                return false;
+            Slot &slot = slots[handle.index];
+            slot.live = false;
+            --liveCnt;
+            // a wrapped generation could match a handle from long ago, such a slot is not reused
+            if (++slot.generation != 0)
+                freeList.push_back(handle.index);
+            return true;
+        }
+
+        bool IsValid(Handle handle) const
+        {
+            return handle.index < slots.size() && slots[handle.index].live && slots[handle.index].generation == handle.generation;
+        }
+
+        void AllocBatch(uint32_t cnt, std::vector<Handle> &out)
+        {
+            out.reserve(out.size() + cnt);
+            for (uint32_t i = 0; i < cnt; ++i)
+            {
+                Handle handle = Alloc();
+                if (handle.generation == 0)
+                    return;
+                out.push_back(handle);
+            }
+        }
+
+        // the number of handles freed
+        uint32_t FreeBatch(const Handle *handles, uint32_t cnt)
+        {
+            uint32_t freedCnt = 0;
+            for (uint32_t i = 0; i < cnt; ++i)
+                freedCnt += Free(handles[i]) ? 1 : 0;
+            return freedCnt;
+        }
+
+        uint32_t GetLiveCnt() const { return liveCnt; }
+        uint32_t GetSlotCnt() const { return static_cast<uint32_t>(slots.size()); }
+
+        void Clear()
+        {
+            slots.clear();
+            freeList.clear();
+            liveCnt = 0;
+        }
+
+    private:
+        struct Slot
+        {
+            uint32_t generation;
+            bool live;
+        };
+
+        uint32_t maxSlotCnt;
+        uint32_t liveCnt;
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeList;
+    };
+
+    // GenerationalIDAllocator behind a mutex, for handles allocated off the main thread. Workers take
+    // and return handles in batches to keep the lock out of per item work.
+    class SharedGenerationalIDAllocator
+    {
+    public:
+        explicit SharedGenerationalIDAllocator(uint32_t maxSlotCnt = UINT32_MAX) : allocator(maxSlotCnt) {}
+
+        Handle Alloc()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return allocator.Alloc();
+        }
+
+        bool Free(Handle handle)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return allocator.Free(handle);
+        }
+
+        bool IsValid(Handle handle) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return allocator.IsValid(handle);
+        }
+
+        void AllocBatch(uint32_t cnt, std::vector<Handle> &out)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            allocator.AllocBatch(cnt, out);
+        }
+
+        uint32_t FreeBatch(const Handle *handles, uint32_t cnt)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return allocator.FreeBatch(handles, cnt);
+        }
+
+        uint32_t GetLiveCnt() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return allocator.GetLiveCnt();
+        }
+
+    private:
+        mutable std::mutex mutex;
+        GenerationalIDAllocator allocator;
+    };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,198 @@
+#ifndef LRU_SLOT_CACHE_H
+#define LRU_SLOT_CACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace vke_ds
+{
+    // Maps keys to a fixed number of slots and hands out the least recently used slot when full.
+    // Slots are linked into an intrusive recency list and found through an open-addressing table,
+    // so lookup, touch and eviction are all O(1). Slots touched in the current frame are pinned and
+    // never handed out again until the frame is ended.
+    class LRUSlotCache
+    {
+    public:
+        static constexpr uint32_t INVALID_SLOT = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t INVALID_KEY = std::numeric_limits<uint32_t>::max();
+
+        struct Stats
+        {
+            uint64_t hitCnt = 0;
+            uint64_t missCnt = 0;
+            uint64_t evictionCnt = 0;
+        };
+
+        explicit LRUSlotCache(uint32_t capacity)
+            : slots(capacity), table(tableSizeFor(capacity), INVALID_SLOT),
+              tableMask(static_cast<uint32_t>(table.size()) - 1) { Clear(); }
+
+        void Clear()
+        {
+            for (Slot &slot : slots)
+                slot = Slot{};
+            std::fill(table.begin(), table.end(), INVALID_SLOT);
+            head = tail = INVALID_SLOT;
+            usedCnt = 0;
+            frame = 1;
+            stats = Stats{};
+        }
+
+        // the slot holding key, moved to the front and pinned for this frame, or INVALID_SLOT
+        uint32_t Lookup(uint32_t key)
+        {
+            const uint32_t slot = Find(key);
+            if (slot == INVALID_SLOT)
+            {
+                ++stats.missCnt;
+                return INVALID_SLOT;
+            }
+            ++stats.hitCnt;
+            touch(slot);
+            return slot;
+        }
+
+        uint32_t Find(uint32_t key) const
+        {
+            for (uint32_t i = hash(key);; i = (i + 1) & tableMask)
+            {
+                const uint32_t slot = table[i];
+                if (slot == INVALID_SLOT || slots[slot].key == key)
+                    return slot;
+            }
+        }
+
+        // the slot Assign would reuse: a never used one, else the least recently used one unless
+        // it is pinned, in which case every slot is and INVALID_SLOT is returned
+        uint32_t PeekVictim() const
+        {
+            if (usedCnt < slots.size())
+                return usedCnt;
+            return slots[tail].frame == frame ? INVALID_SLOT : tail;
+        }
+
+        // the key a slot currently holds, INVALID_KEY if it is unused
+        uint32_t GetKey(uint32_t slot) const { return slots[slot].key; }
+
+        // binds key to slot, which has to come from PeekVictim, dropping whatever it held before
+        void Assign(uint32_t slot, uint32_t key)
+        {
+            Slot &entry = slots[slot];
+            if (entry.key != INVALID_KEY)
+            {
+                eraseKey(entry.key);
+                unlink(slot);
+                ++stats.evictionCnt;
+            }
+            else
+                ++usedCnt;
+
+            entry.key = key;
+            uint32_t i = hash(key);
+            while (table[i] != INVALID_SLOT)
+                i = (i + 1) & tableMask;
+            table[i] = slot;
+            pushFront(slot);
+            entry.frame = frame;
+        }
+
+        // unpins every slot touched since the previous call
+        void EndFrame() { ++frame; }
+
+        uint32_t GetCapacity() const { return static_cast<uint32_t>(slots.size()); }
+        uint32_t GetUsedCnt() const { return usedCnt; }
+        const Stats &GetStats() const { return stats; }
+        void ResetStats() { stats = Stats{}; }
+
+    private:
+        struct Slot
+        {
+            uint32_t key = INVALID_KEY;
+            uint32_t prev = INVALID_SLOT;
+            uint32_t next = INVALID_SLOT;
+            uint64_t frame = 0;
+        };
+
+        std::vector<Slot> slots;
+        // slot indices, kept at most half full so probe runs stay short
+        std::vector<uint32_t> table;
+        uint32_t tableMask;
+        uint32_t head;
+        uint32_t tail;
+        uint32_t usedCnt;
+        uint64_t frame;
+        Stats stats;
+
+        static size_t tableSizeFor(uint32_t capacity)
+        {
+            size_t size = 16;
+            while (size < static_cast<size_t>(capacity) * 2)
+                size <<= 1;
+            return size;
+        }
+
+        uint32_t hash(uint32_t key) const
+        {
+            // Fibonacci hashing spreads the dense codepoint ranges of a script across the table
+            return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & tableMask;
+        }
+
+        void eraseKey(uint32_t key)
+        {
+            uint32_t i = hash(key);
+            while (slots[table[i]].key != key)
+                i = (i + 1) & tableMask;
+
+            // backward shift keeps every remaining probe run contiguous without tombstones
+            for (uint32_t j = (i + 1) & tableMask; table[j] != INVALID_SLOT; j = (j + 1) & tableMask)
+            {
+                const uint32_t home = hash(slots[table[j]].key);
+                if (((j - home) & tableMask) >= ((j - i) & tableMask))
+                {
+                    table[i] = table[j];
+                    i = j;
+                }
+            }
+            table[i] = INVALID_SLOT;
+        }
+
+        void touch(uint32_t slot)
+        {
+            slots[slot].frame = frame;
+            if (slot == head)
+                return;
+            unlink(slot);
+            pushFront(slot);
+        }
+
+        void unlink(uint32_t slot)
+        {
+            Slot &entry = slots[slot];
+            if (entry.prev != INVALID_SLOT)
+                slots[entry.prev].next = entry.next;
+            else
+                head = entry.next;
+            if (entry.next != INVALID_SLOT)
+                slots[entry.next].prev = entry.prev;
+            else
+                tail = entry.prev;
+            entry.prev = entry.next = INVALID_SLOT;
+        }
+
+        void pushFront(uint32_t slot)
+        {
+            Slot &entry = slots[slot];
+            entry.prev = INVALID_SLOT;
+            entry.next = head;
+            if (head != INVALID_SLOT)
+                slots[head].prev = slot;
+            head = slot;
+            if (tail == INVALID_SLOT)
+                tail = slot;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace vke_ds
+{
+    // Fixed capacity multi producer, single consumer queue of values (Vyukov's bounded queue).
+    // Producers claim a cell with one CAS and publish it through the cell's sequence, so a slow
+    // producer only holds back the consumer, never other producers. TryPush fails when the queue
+    // is full, the caller has to put the value somewhere else then.
+    template <typename T>
+    class MPSCQueue
+    {
+    public:
+        explicit MPSCQueue(uint32_t capacity)
+            : mask(std::bit_ceil(static_cast<uint64_t>(capacity)) - 1),
+              cells(std::make_unique<Cell[]>(static_cast<size_t>(mask + 1))), enqueuePos(0), dequeuePos(0)
+        {
+            for (uint64_t i = 0; i <= mask; ++i)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MPSCQueue(const MPSCQueue &) = delete;
+        MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+        // any thread
+        template <typename U>
+        bool TryPush(U &&value)
+        {
+            uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell &cell = cells[pos & mask];
+                const int64_t diff = static_cast<int64_t>(cell.sequence.load(std::memory_order_acquire) - pos);
+                if (diff == 0)
+                {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = std::forward<U>(value);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        // consumer only; false when empty or when the oldest claimed cell is not published yet
+        bool TryPop(T &value)
+        {
+            const uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+            Cell &cell = cells[pos & mask];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+                return false;
+            value = std::move(cell.value);
+            cell.sequence.store(pos + mask + 1, std::memory_order_release);
+            dequeuePos.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // a racy estimate, exact on the consumer thread when no producer is running
+        uint32_t GetSizeEstimate() const
+        {
+            const uint64_t enqueued = enqueuePos.load(std::memory_order_relaxed);
+            const uint64_t dequeued = dequeuePos.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? static_cast<uint32_t>(enqueued - dequeued) : 0;
+        }
+
+        uint32_t GetCapacity() const { return static_cast<uint32_t>(mask + 1); }
+
+    private:
+        struct Cell
+        {
+            std::atomic<uint64_t> sequence;
+            T value;
+        };
+
+        const uint64_t mask;
+        std::unique_ptr<Cell[]> cells;
+        alignas(64) std::atomic<uint64_t> enqueuePos;
+        alignas(64) std::atomic<uint64_t> dequeuePos;
+    };
+}
+
+#endif
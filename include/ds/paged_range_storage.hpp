@@ -0,0 +1,72 @@
+#ifndef PAGED_RANGE_STORAGE_H
+#define PAGED_RANGE_STORAGE_H
+
+#include <ds/range_allocator.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vke_ds
+{
+    // Element storage handed out in contiguous ranges. Ranges come from a RangeAllocator, so freed
+    // ranges are coalesced and reused and the live elements stay packed towards the front. Backing
+    // memory grows a page at a time and pages never move, so growing does not copy elements.
+    template <typename T, uint32_t PAGE_SIZE>
+    class PagedRangeStorage
+    {
+        static_assert(PAGE_SIZE > 0 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0, "page size has to be a power of two");
+
+    public:
+        PagedRangeStorage() = default;
+
+        PagedRangeStorage(const PagedRangeStorage &) = delete;
+        PagedRangeStorage &operator=(const PagedRangeStorage &) = delete;
+
+        // offset of count consecutive elements
+        uint32_t Alloc(uint32_t count)
+        {
+            const uint32_t offset = allocator.Alloc(count);
+            while (GetCapacity() < allocator.GetEnd())
+                pages.push_back(std::make_unique<T[]>(PAGE_SIZE));
+            return offset;
+        }
+
+        // count has to be the one passed to Alloc
+        void Free(uint32_t offset, uint32_t count) { allocator.Free(offset, count); }
+
+        void Clear()
+        {
+            allocator = RangeAllocator<uint32_t>();
+            pages.clear();
+        }
+
+        T &operator[](uint32_t index) { return pages[index / PAGE_SIZE][index & (PAGE_SIZE - 1)]; }
+        const T &operator[](uint32_t index) const { return pages[index / PAGE_SIZE][index & (PAGE_SIZE - 1)]; }
+
+        // copies [begin, end) to dst, which does not need to care about page boundaries
+        void CopyOut(uint32_t begin, uint32_t end, T *dst) const
+        {
+            while (begin < end)
+            {
+                const uint32_t pageEnd = std::min(end, (begin / PAGE_SIZE + 1) * PAGE_SIZE);
+                std::copy(&(*this)[begin], &(*this)[begin] + (pageEnd - begin), dst);
+                dst += pageEnd - begin;
+                begin = pageEnd;
+            }
+        }
+
+        // elements backed by pages
+        uint32_t GetCapacity() const { return static_cast<uint32_t>(pages.size()) * PAGE_SIZE; }
+        // one past the highest live element
+        uint32_t GetEnd() const { return allocator.GetEnd(); }
+        uint32_t GetUsed() const { return allocator.GetUsed(); }
+        size_t GetFreeRangeCnt() const { return allocator.GetFreeRangeCnt(); }
+
+    private:
+        RangeAllocator<uint32_t> allocator;
+        std::vector<std::unique_ptr<T[]>> pages;
+    };
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef RANGE_ALLOC_H
+#define RANGE_ALLOC_H
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+namespace vke_ds
+{
+    // Sub-allocates aligned ranges from a space that grows at its end. Freed ranges are coalesced
+    // with their neighbours and reused best-fit; a free range that reaches the end shrinks it.
+    template <typename T>
+    class RangeAllocator
+    {
+    public:
+        explicit RangeAllocator(T alignment = 1) : alignment(alignment), end(0), used(0) {}
+
+        T Alloc(T size)
+        {
+            size = alignUp(size);
+            used += size;
+            auto best = freeBySize.lower_bound(size);
+            if (best == freeBySize.end())
+            {
+                const T offset = end;
+                end += size;
+                return offset;
+            }
+
+            const T rangeSize = best->first;
+            const T offset = best->second;
+            freeBySize.erase(best);
+            freeByOffset.erase(offset);
+            if (rangeSize > size)
+                insertFree(offset + size, rangeSize - size);
+            return offset;
+        }
+
+        // size has to be the one passed to Alloc
+        void Free(T offset, T size)
+        {
+            size = alignUp(size);
+            used -= size;
+
+            auto next = freeByOffset.lower_bound(offset);
+            if (next != freeByOffset.end() && offset + size == next->first)
+            {
+                size += next->second;
+                eraseFree(next);
+            }
+            next = freeByOffset.lower_bound(offset);
+            if (next != freeByOffset.begin())
+            {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == offset)
+                {
+                    offset = prev->first;
+                    size += prev->second;
+                    eraseFree(prev);
+                }
+            }
+
+            if (offset + size == end)
+                end = offset;
+            else
+                insertFree(offset, size);
+        }
+
+        T GetAlignment() const { return alignment; }
+        // one past the highest allocated unit, the size a backing buffer needs
+        T GetEnd() const { return end; }
+        // units handed out, including alignment padding
+        T GetUsed() const { return used; }
+        size_t GetFreeRangeCnt() const { return freeByOffset.size(); }
+
+    private:
+        T alignment;
+        T end;
+        T used;
+        std::map<T, T> freeByOffset;
+        std::multimap<T, T> freeBySize;
+
+        T alignUp(T size) const
+        {
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        void insertFree(T offset, T size)
+        {
+            freeByOffset.emplace(offset, size);
+            freeBySize.emplace(size, offset);
+        }
+
+        void eraseFree(typename std::map<T, T>::iterator it)
+        {
+            auto range = freeBySize.equal_range(it->second);
+            for (auto sizeIt = range.first; sizeIt != range.second; ++sizeIt)
+                if (sizeIt->second == it->first)
+                {
+                    freeBySize.erase(sizeIt);
+                    break;
+                }
+            freeByOffset.erase(it);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+
+namespace vke_ds
+{
+    // Fixed capacity Chase-Lev deque of pointers. The owning thread pushes and pops at the bottom,
+    // any other thread steals from the top. Push fails when the deque is full, the caller has to
+    // put the element somewhere else then.
+    template <typename T>
+    class WorkStealingDeque
+    {
+    public:
+        explicit WorkStealingDeque(uint32_t capacity)
+            : mask(static_cast<int64_t>(std::bit_ceil(capacity)) - 1),
+              buffer(std::make_unique<std::atomic<T *>[]>(static_cast<size_t>(mask + 1))), top(0), bottom(0) {}
+
+        WorkStealingDeque(const WorkStealingDeque &) = delete;
+        WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+        // owner only
+        bool Push(T *element)
+        {
+            const int64_t b = bottom.load(std::memory_order_relaxed);
+            const int64_t t = top.load(std::memory_order_acquire);
+            if (b - t > mask)
+                return false;
+            buffer[b & mask].store(element, std::memory_order_relaxed);
+            // publishes the element, and whatever it points to, to thieves that see the new bottom
+            bottom.store(b + 1, std::memory_order_release);
+            return true;
+        }
+
+        // owner only, newest first
+        T *Pop()
+        {
+            const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+            if (t > b)
+            {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            T *element = buffer[b & mask].load(std::memory_order_relaxed);
+            // the last element, a thief may be taking it at the same time
+            if (t == b)
+            {
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    element = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return element;
+        }
+
+        // any thread, oldest first; nullptr when empty or when another thread won the race
+        T *Steal()
+        {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return nullptr;
+            T *element = buffer[t & mask].load(std::memory_order_relaxed);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return element;
+        }
+
+        // a racy estimate, only good for statistics and heuristics
+        uint32_t GetSizeEstimate() const
+        {
+            const int64_t size = bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+            return size > 0 ? static_cast<uint32_t>(size) : 0;
+        }
+
+        uint32_t GetCapacity() const { return static_cast<uint32_t>(mask + 1); }
+
+    private:
+        const int64_t mask;
+        std::unique_ptr<std::atomic<T *>[]> buffer;
+        alignas(64) std::atomic<int64_t> top;
+        alignas(64) std::atomic<int64_t> bottom;
+    };
+}
+
+#endif
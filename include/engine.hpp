@@ -9,8 +9,12 @@
 #include <input.hpp>
 #include <engine_state.hpp>
 #include <time.hpp>
+#include <job_system.hpp>
 #include <script.hpp>
-#include <spatial_2d.hpp>
+#include <spatial_2d.hpp>
+#include <text_layout.hpp>
+#include <component_mirror.hpp>
+#include <animation_manager.hpp>
 
 namespace vke_common
 {
@@ -18,12 +22,16 @@ namespace vke_common
     {
     private:
         static Engine *instance;
-        Engine() : fixedUpdateAccumulator(0.0f) {}
+        Engine() : renderFrames(true) {}
         ~Engine() {}
         Engine(const Engine &);
         Engine &operator=(const Engine);
 
-        float fixedUpdateAccumulator;
+        // false for logic only headless runs
+        bool renderFrames;
+
+        void refreshComponentMirror();
+        void updateRenderer();
 
     public:
         static Engine *GetInstance()
@@ -38,19 +46,38 @@ namespace vke_common
                             std::vector<vke_render::PassType> &passes,
                             std::vector<std::unique_ptr<vke_render::RenderPassBase>> &customPasses)
         {
+            const HeadlessConfig &headlessConfig = gameConfig.headlessConfig;
             instance = new Engine();
+            instance->renderFrames = !headlessConfig.enabled || headlessConfig.render;
+            Logger::Configure(gameConfig.logConfig);
             EventSystem::Init();
-            TimeManager::Init();
-            InputManager::Init(window);
-            EngineStateManager::Init();
-            vke_render::RenderEnvironment::Init(window, gameConfig.enableVulkanValidationLayers);
-            AssetManager::Init();
+            JobSystem::Init(gameConfig.jobThreadCnt);
+            TimeManager::Init(gameConfig.timeConfig, gameConfig.physicsConfig.stepTime,
+                              headlessConfig.enabled ? headlessConfig.fixedDeltaTime : 0.0f);
+            if (headlessConfig.enabled)
+            {
+                // window is ignored, there is nothing to poll input from or present to
+                InputManager::Init(nullptr);
+                EngineStateManager::Init();
+                vke_render::RenderEnvironment::InitHeadless(gameConfig.windowWidth, gameConfig.windowHeight,
+                                                            gameConfig.enableVulkanValidationLayers);
+            }
+            else
+            {
+                InputManager::Init(window);
+                EngineStateManager::Init();
+                vke_render::RenderEnvironment::Init(window, gameConfig.enableVulkanValidationLayers);
+            }
+            AssetManager::Init(gameConfig.fontAtlasCachePath);
             vke_physics::PhysicsManager::Init(gameConfig.physicsConfig);
             vke_render::DescriptorSetAllocator::Init();
             Spatial2DLayerManager::Init();
+            TextLayoutCache::Init();
             if (ctx == nullptr)
                 ctx = &(vke_render::RenderEnvironment::GetInstance()->rootRenderContext);
             vke_render::Renderer::Init(ctx, passes, customPasses, gameConfig.renderConfig);
+            AnimationManager::Init(gameConfig.animationConfig);
+            ComponentMirror::Init();
             ScriptManager::Init();
             SceneManager::Init();
             return instance;
@@ -70,7 +97,10 @@ namespace vke_common
         {
             SceneManager::Dispose();
             ScriptManager::Dispose();
+            ComponentMirror::Dispose();
+            AnimationManager::Dispose();
             vke_render::Renderer::Dispose();
+            TextLayoutCache::Dispose();
             Spatial2DLayerManager::Dispose();
             vke_render::DescriptorSetAllocator::Dispose();
             vke_physics::PhysicsManager::Dispose();
@@ -79,6 +109,7 @@ namespace vke_common
             EngineStateManager::Dispose();
             InputManager::Dispose();
             TimeManager::Dispose();
+            JobSystem::Dispose();
             EventSystem::Dispose();
             delete instance;
         }
@@ -93,6 +124,9 @@ namespace vke_common
         void FixedUpdate();
 
         void MainLoop();
+
+        // headless only, updates until the engine terminates or frameCnt frames ran, 0 for no limit
+        void RunHeadless(uint32_t frameCnt);
     };
 };
 
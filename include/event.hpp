@@ -1,11 +1,15 @@
 #ifndef EVENT_H
 #define EVENT_H
 
-#include <iostream>
+#include <array>
+#include <atomic>
 #include <functional>
-#include <map>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 #include <common.hpp>
 #include <ds/id_allocator.hpp>
+#include <ds/mpsc_queue.hpp>
 
 namespace vke_common
 {
@@ -13,63 +17,305 @@ namespace vke_common
     {
         EVENT_WINDOW_RESIZE,
         EVENT_MOUSE_CLICK,
+        GLOBAL_EVENT_TYPE_CNT,
     };
 
     using EventType = int;
     using EventCallback = std::function<void(void *, void *)>;
 
+    // Listeners of one event kept in a contiguous array, so invoking them is a linear walk. Handles
+    // stay valid while other listeners come and go: a handle names a slot that points at the
+    // listener's place in the array, and carries the slot's generation so a stale handle does not
+    // remove whoever reused the slot. Listeners added or removed while invoking take effect once
+    // the walk is done. Not thread safe.
+    template <typename Fn>
+    class ListenerList
+    {
+    public:
+        ListenerList() : invokeDepth(0) {}
+
+        vke_ds::id32_t Add(Fn &&fn)
+        {
+            uint32_t slot;
+            if (freeSlots.empty())
+            {
+                slot = static_cast<uint32_t>(slotDenseIndices.size());
+                VKE_FATAL_IF(slot > HANDLE_SLOT_MASK, "Too many event listeners")
+                slotDenseIndices.push_back(PENDING);
+                slotGenerations.push_back(0);
+            }
+            else
+            {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            const vke_ds::id32_t handle = slot | (slotGenerations[slot] << HANDLE_SLOT_BITS);
+            if (invokeDepth > 0)
+            {
+                slotDenseIndices[slot] = PENDING;
+                pendingAdds.emplace_back(slot, std::move(fn));
+            }
+            else
+                append(slot, std::move(fn));
+            return handle;
+        }
+
+        // false for a handle that was already removed
+        bool Remove(vke_ds::id32_t handle)
+        {
+            const uint32_t slot = handle & HANDLE_SLOT_MASK;
+            if (slot >= slotDenseIndices.size() || slotGenerations[slot] != handle >> HANDLE_SLOT_BITS ||
+                slotDenseIndices[slot] == FREE)
+                return false;
+
+            const uint32_t denseIndex = slotDenseIndices[slot];
+            // a removal waiting for the walk to end
+            if (denseIndex != PENDING && !alive[denseIndex])
+                return false;
+            if (denseIndex == PENDING)
+            {
+                for (auto it = pendingAdds.begin(); it != pendingAdds.end(); ++it)
+                    if (it->first == slot)
+                    {
+                        pendingAdds.erase(it);
+                        break;
+                    }
+                freeSlot(slot);
+            }
+            else if (invokeDepth > 0)
+            {
+                // skipped by the running walk and destroyed when it ends, the listener may be removing itself
+                alive[denseIndex] = 0;
+                pendingRemoves.push_back(slot);
+            }
+            else
+                erase(slot);
+            return true;
+        }
+
+        template <typename... Args>
+        void Invoke(Args &&...args)
+        {
+            ++invokeDepth;
+            // the size is fixed during the walk, additions are pending
+            const size_t cnt = callbacks.size();
+            for (size_t i = 0; i < cnt; ++i)
+                if (alive[i])
+                    callbacks[i](args...);
+            if (--invokeDepth == 0)
+                applyPending();
+        }
+
+        uint32_t GetCount() const
+        {
+            return static_cast<uint32_t>(callbacks.size() - pendingRemoves.size() + pendingAdds.size());
+        }
+
+    private:
+        static constexpr uint32_t HANDLE_SLOT_BITS = 24;
+        static constexpr uint32_t HANDLE_SLOT_MASK = (1u << HANDLE_SLOT_BITS) - 1;
+        static constexpr uint32_t GENERATION_MASK = (1u << (32 - HANDLE_SLOT_BITS)) - 1;
+        static constexpr uint32_t FREE = ~0u;
+        static constexpr uint32_t PENDING = ~0u - 1;
+
+        std::vector<Fn> callbacks;
+        std::vector<uint8_t> alive;
+        std::vector<uint32_t> denseSlots;
+        std::vector<uint32_t> slotDenseIndices;
+        std::vector<uint32_t> slotGenerations;
+        std::vector<uint32_t> freeSlots;
+        std::vector<std::pair<uint32_t, Fn>> pendingAdds;
+        std::vector<uint32_t> pendingRemoves;
+        uint32_t invokeDepth;
+
+        void append(uint32_t slot, Fn &&fn)
+        {
+            slotDenseIndices[slot] = static_cast<uint32_t>(callbacks.size());
+            callbacks.push_back(std::move(fn));
+            alive.push_back(1);
+            denseSlots.push_back(slot);
+        }
+
+        void erase(uint32_t slot)
+        {
+            // swap with the last listener, so the order of listeners is not kept
+            const uint32_t denseIndex = slotDenseIndices[slot];
+            const uint32_t lastIndex = static_cast<uint32_t>(callbacks.size() - 1);
+            if (denseIndex != lastIndex)
+            {
+                callbacks[denseIndex] = std::move(callbacks[lastIndex]);
+                alive[denseIndex] = alive[lastIndex];
+                denseSlots[denseIndex] = denseSlots[lastIndex];
+                slotDenseIndices[denseSlots[denseIndex]] = denseIndex;
+            }
+            callbacks.pop_back();
+            alive.pop_back();
+            denseSlots.pop_back();
+            freeSlot(slot);
+        }
+
+        void freeSlot(uint32_t slot)
+        {
+            slotDenseIndices[slot] = FREE;
+            slotGenerations[slot] = (slotGenerations[slot] + 1) & GENERATION_MASK;
+            freeSlots.push_back(slot);
+        }
+
+        void applyPending()
+        {
+            for (uint32_t slot : pendingRemoves)
+                erase(slot);
+            pendingRemoves.clear();
+            for (auto &[slot, fn] : pendingAdds)
+                append(slot, std::move(fn));
+            pendingAdds.clear();
+        }
+    };
+
     template <typename MT>
     class EventHub
     {
     private:
         using innerCallback_t = std::function<void(MT *)>;
-        using callbackTable_t = std::map<vke_ds::id32_t, innerCallback_t>;
 
     public:
         using callback_t = std::function<void(void *, MT *)>;
 
-        EventHub() : idAllocator(0) {}
+        EventHub() {}
         ~EventHub() {}
         EventHub(const EventHub<MT> &) = delete;
         EventHub &operator=(const EventHub<MT> &) = delete;
-        EventHub(const EventHub<MT> &&ano) : idAllocator(ano.idAllocator), callbackTable(std::forward<callbackTable_t>(ano.callbackTable)) {}
-        EventHub &operator=(EventHub<MT> &&ano)
-        {
-            idAllocator = ano.idAllocator;
-            callbackTable = std::forward<callbackTable_t>(ano.callbackTable);
-            return *this;
-        }
+        EventHub(EventHub<MT> &&ano) = default;
+        EventHub &operator=(EventHub<MT> &&ano) = default;
 
         vke_ds::id32_t AddEventListener(void *listener, callback_t &callback)
         {
-            // TODO check type
-            vke_ds::id32_t ret = idAllocator.Alloc();
-            callbackTable[ret] = std::bind(callback, listener, std::placeholders::_1);
-            return ret;
+            return listeners.Add([callback, listener](MT *info)
+                                 { callback(listener, info); });
         }
 
         vke_ds::id32_t AddEventListener(void *listener, callback_t &&callback)
         {
-            // TODO check type
-            vke_ds::id32_t ret = idAllocator.Alloc();
-            callbackTable[ret] = std::bind(std::move(callback), listener, std::placeholders::_1);
-            return ret;
+            return listeners.Add([callback = std::move(callback), listener](MT *info)
+                                 { callback(listener, info); });
         }
 
         void RemoveEventListener(vke_ds::id32_t id)
         {
-            callbackTable.erase(id);
+            listeners.Remove(id);
         }
 
         void DispatchEvent(MT *info)
         {
-            for (auto &kv : callbackTable)
-                kv.second(info);
+            listeners.Invoke(info);
+        }
+
+    private:
+        ListenerList<innerCallback_t> listeners;
+    };
+
+    class EventChannelBase
+    {
+    public:
+        virtual ~EventChannelBase() {}
+        virtual uint32_t DispatchQueued() = 0;
+    };
+
+    // Events of one type. Any thread may Post, the events wait in a lock-free queue until the main
+    // thread dispatches them at a sync point. Listeners are added, removed and called on the main
+    // thread, which may also Dispatch at once. Events from one producer arrive in order unless the
+    // queue was full, then the ones that did not fit arrive after the queued ones.
+    template <typename E>
+    class EventChannel : public EventChannelBase
+    {
+    public:
+        using callback_t = std::function<void(const E &)>;
+
+        static constexpr uint32_t DEFAULT_QUEUE_CAPACITY = 4096;
+
+        explicit EventChannel(uint32_t queueCapacity = DEFAULT_QUEUE_CAPACITY)
+            : queue(queueCapacity), listenerCnt(0), hasOverflow(false), overflowCnt(0) {}
+
+        EventChannel(const EventChannel &) = delete;
+        EventChannel &operator=(const EventChannel &) = delete;
+
+        vke_ds::id32_t AddListener(callback_t &&callback)
+        {
+            const vke_ds::id32_t handle = listeners.Add(std::move(callback));
+            listenerCnt.store(listeners.GetCount(), std::memory_order_relaxed);
+            return handle;
+        }
+
+        void RemoveListener(vke_ds::id32_t handle)
+        {
+            listeners.Remove(handle);
+            listenerCnt.store(listeners.GetCount(), std::memory_order_relaxed);
+        }
+
+        // any thread; lets producers skip building events nobody listens to
+        bool HasListeners() const
+        {
+            return listenerCnt.load(std::memory_order_relaxed) > 0;
+        }
+
+        // any thread
+        template <typename U>
+        void Post(U &&event)
+        {
+            if (queue.TryPush(std::forward<U>(event)))
+                return;
+            std::lock_guard<std::mutex> lock(overflowMutex);
+            overflow.push_back(std::forward<U>(event));
+            hasOverflow.store(true, std::memory_order_release);
+            overflowCnt.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Dispatch(const E &event)
+        {
+            listeners.Invoke(event);
+        }
+
+        // events posted while dispatching, e.g. by a listener, wait for the next call
+        uint32_t DispatchQueued() override
+        {
+            uint32_t dispatchedCnt = 0;
+            const uint32_t queuedCnt = queue.GetSizeEstimate();
+            while (dispatchedCnt < queuedCnt && queue.TryPop(scratch))
+            {
+                listeners.Invoke(static_cast<const E &>(scratch));
+                ++dispatchedCnt;
+            }
+            if (hasOverflow.load(std::memory_order_acquire))
+            {
+                {
+                    std::lock_guard<std::mutex> lock(overflowMutex);
+                    overflowScratch.swap(overflow);
+                    hasOverflow.store(false, std::memory_order_relaxed);
+                }
+                for (const E &event : overflowScratch)
+                    listeners.Invoke(event);
+                dispatchedCnt += static_cast<uint32_t>(overflowScratch.size());
+                overflowScratch.clear();
+            }
+            return dispatchedCnt;
+        }
+
+        // events that did not fit in the queue since the channel was created
+        uint64_t GetOverflowCount() const
+        {
+            return overflowCnt.load(std::memory_order_relaxed);
         }
 
     private:
-        callbackTable_t callbackTable;
-        vke_ds::NaiveIDAllocator<vke_ds::id32_t> idAllocator;
+        ListenerList<callback_t> listeners;
+        vke_ds::MPSCQueue<E> queue;
+        E scratch;
+        std::atomic<uint32_t> listenerCnt;
+        std::mutex overflowMutex;
+        std::vector<E> overflow;
+        std::vector<E> overflowScratch;
+        std::atomic<bool> hasOverflow;
+        std::atomic<uint64_t> overflowCnt;
     };
 
     class EventSystem
@@ -83,6 +329,8 @@ namespace vke_common
 
         using eventHubType = EventHub<void>;
 
+        static constexpr uint32_t MAX_CHANNEL_CNT = 64;
+
     public:
         static EventSystem *GetInstance()
         {
@@ -93,24 +341,24 @@ namespace vke_common
         static EventSystem *Init()
         {
             instance = new EventSystem;
-            instance->eventHubs[EVENT_WINDOW_RESIZE] = std::move(eventHubType());
             return instance;
         }
 
         static void Dispose()
         {
+            for (std::atomic<EventChannelBase *> &channel : instance->channels)
+                delete channel.load(std::memory_order_relaxed);
             delete instance;
+            instance = nullptr;
         }
 
         static vke_ds::id32_t AddEventListener(GlobalEventType type, void *listener, EventCallback &callback)
         {
-            // TODO check type
             return instance->eventHubs[type].AddEventListener(listener, callback);
         }
 
         static vke_ds::id32_t AddEventListener(GlobalEventType type, void *listener, EventCallback &&callback)
         {
-            // TODO check type
             return instance->eventHubs[type].AddEventListener(listener, std::move(callback));
         }
 
@@ -124,9 +372,81 @@ namespace vke_common
             instance->eventHubs[type].DispatchEvent(info);
         }
 
+        // the channel of events of type E, created on first use from any thread
+        template <typename E>
+        static EventChannel<E> &GetChannel()
+        {
+            static const uint32_t channelIndex = nextChannelIndex.fetch_add(1, std::memory_order_relaxed);
+            VKE_FATAL_IF(channelIndex >= MAX_CHANNEL_CNT, "Too many event channels")
+            EventSystem *system = GetInstance();
+            EventChannelBase *channel = system->channels[channelIndex].load(std::memory_order_acquire);
+            if (channel == nullptr)
+                channel = system->createChannel(channelIndex, []() -> EventChannelBase *
+                                                { return new EventChannel<E>(); });
+            return *static_cast<EventChannel<E> *>(channel);
+        }
+
+        template <typename E>
+        static vke_ds::id32_t AddListener(typename EventChannel<E>::callback_t &&callback)
+        {
+            return GetChannel<E>().AddListener(std::move(callback));
+        }
+
+        template <typename E>
+        static void RemoveListener(vke_ds::id32_t handle)
+        {
+            GetChannel<E>().RemoveListener(handle);
+        }
+
+        template <typename E>
+        static bool HasListeners()
+        {
+            return instance != nullptr && GetChannel<E>().HasListeners();
+        }
+
+        // any thread, delivered at the next sync point
+        template <typename E>
+        static void Post(E &&event)
+        {
+            GetChannel<std::decay_t<E>>().Post(std::forward<E>(event));
+        }
+
+        // main thread, delivered at once
+        template <typename E>
+        static void Dispatch(const E &event)
+        {
+            GetChannel<E>().Dispatch(event);
+        }
+
+        // main thread, the sync points in Engine::Update
+        static uint32_t DispatchQueued()
+        {
+            uint32_t dispatchedCnt = 0;
+            for (uint32_t i = 0; i < MAX_CHANNEL_CNT; ++i)
+                if (EventChannelBase *channel = instance->channels[i].load(std::memory_order_acquire))
+                    dispatchedCnt += channel->DispatchQueued();
+            return dispatchedCnt;
+        }
+
     private:
-        std::map<GlobalEventType, eventHubType> eventHubs;
+        static inline std::atomic<uint32_t> nextChannelIndex = 0;
+
+        std::array<eventHubType, GLOBAL_EVENT_TYPE_CNT> eventHubs;
+        std::array<std::atomic<EventChannelBase *>, MAX_CHANNEL_CNT> channels{};
+        std::mutex channelMutex;
+
+        EventChannelBase *createChannel(uint32_t channelIndex, EventChannelBase *(*create)())
+        {
+            std::lock_guard<std::mutex> lock(channelMutex);
+            EventChannelBase *channel = channels[channelIndex].load(std::memory_order_relaxed);
+            if (channel == nullptr)
+            {
+                channel = create();
+                channels[channelIndex].store(channel, std::memory_order_release);
+            }
+            return channel;
+        }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,92 @@
+#ifndef FONT_ATLAS_BAKER_H
+#define FONT_ATLAS_BAKER_H
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vke_common
+{
+    class JobSystem;
+
+    enum class GlyphAtlasType : uint32_t
+    {
+        STATIC_ATLAS = 0,
+        DYNAMIC_ATLAS = 1
+    };
+
+    struct Glyph
+    {
+        uint32_t codepoint = 0;
+        uint32_t glyphIndex = 0;
+        int width = 0;
+        int height = 0;
+        int bearingX = 0;
+        int bearingY = 0;
+        int advanceX = 0;
+        int atlasX = 0;
+        int atlasY = 0;
+        GlyphAtlasType atlasType = GlyphAtlasType::STATIC_ATLAS;
+        uint32_t slotIndex = 0;
+    };
+
+    // Both atlases are ATLAS_SIZE squared R8 images split into ATLAS_SLOT_SIZE squared slots, one glyph each.
+    constexpr uint32_t FONT_ATLAS_SIZE = 2048;
+    constexpr uint32_t FONT_ATLAS_SLOT_SIZE = 64;
+    constexpr uint32_t FONT_ATLAS_SLOT_COUNT = 1024;
+    constexpr int FONT_SDF_SPREAD = 8;
+
+    constexpr uint32_t FONT_ATLAS_CACHE_MAGIC = 0x41464B56; // "VKFA"
+    constexpr uint32_t FONT_ATLAS_CACHE_VERSION = 1;
+
+    struct RasterizedGlyph
+    {
+        Glyph glyph;
+        std::vector<uint8_t> bitmap;
+    };
+
+    // Renders one codepoint as an SDF bitmap with its metrics, not yet placed in an atlas.
+    bool RasterizeSDFGlyph(FT_Face face, uint32_t codepoint, RasterizedGlyph &out);
+    // Centers the glyph in a slot and fills in its atlas position.
+    void PlaceGlyph(Glyph &glyph, GlyphAtlasType atlasType, uint32_t slotIndex);
+    void ClearAtlasSlot(std::vector<uint8_t> &atlas, uint32_t slotIndex);
+    void BlitGlyph(const RasterizedGlyph &glyph, std::vector<uint8_t> &atlas);
+
+    // Builds the static atlas of a font face, reading it back from a cache file when one matches.
+    //
+    // Codepoints are baked in order into consecutive slots, skipping those the face cannot render,
+    // until the atlas is full. FreeType faces are not thread safe, so every job system worker that
+    // helps opens its own library and face on the font file. The cache file is keyed by a hash of the font file, the pixel
+    // size, the codepoint list and the FreeType version, so a warm load skips FreeType entirely.
+    class StaticAtlasBaker
+    {
+    public:
+        // face is the already sized face of fontPath and bakes on the calling thread
+        StaticAtlasBaker(FT_Face face, const std::string &fontPath, uint32_t pixelSize);
+
+        // an empty cacheDir disables the cache; jobSystem may be null to bake on the calling thread only,
+        // which it also does on a thread jobSystem does not own
+        void Bake(const std::vector<uint32_t> &codepoints, const std::string &cacheDir, JobSystem *jobSystem,
+                  std::vector<Glyph> &glyphs, std::vector<uint8_t> &pixels);
+
+        // the steps of Bake, public for the benchmark
+        void BakeUncached(const std::vector<uint32_t> &codepoints, JobSystem *jobSystem,
+                          std::vector<Glyph> &glyphs, std::vector<uint8_t> &pixels);
+        uint64_t ComputeCacheKey(const std::vector<uint32_t> &codepoints) const;
+        std::string GetCachePath(const std::string &cacheDir, uint64_t cacheKey) const;
+        bool LoadCache(const std::string &cachePath, uint64_t cacheKey,
+                       std::vector<Glyph> &glyphs, std::vector<uint8_t> &pixels) const;
+        bool SaveCache(const std::string &cachePath, uint64_t cacheKey,
+                       const std::vector<Glyph> &glyphs, const std::vector<uint8_t> &pixels) const;
+
+    private:
+        FT_Face face;
+        std::string fontPath;
+        uint32_t pixelSize;
+    };
+}
+
+#endif
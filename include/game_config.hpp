@@ -2,11 +2,16 @@
 #define GAME_CONFIG_H
 
 #include <common.hpp>
+#include <animation_system.hpp>
 #include <cstdint>
+#include <headless_config.hpp>
+#include <log_config.hpp>
 #include <nlohmann/json.hpp>
 #include <physics/physics_config.hpp>
 #include <render/render_config.hpp>
 #include <reflect.hpp>
+#include <script_scheduler.hpp>
+#include <time_config.hpp>
 
 namespace vke_common
 {
@@ -25,12 +30,20 @@ namespace vke_common
         REFLECT_FIELD(std::string, assetLUTPath);
         REFLECT_FIELD(std::string, defaultScenePath);
         REFLECT_FIELD(std::string, gameScriptPath);
+        REFLECT_FIELD(std::string, fontAtlasCachePath);
+        // worker threads of the engine job system besides the main thread, < 0 uses hardware concurrency - 1
+        REFLECT_FIELD(int32_t, jobThreadCnt);
         vke_physics::PhysicsConfig physicsConfig;
         vke_render::RenderConfig renderConfig;
+        ScriptSchedulerConfig scriptConfig;
+        AnimationConfig animationConfig;
+        HeadlessConfig headlessConfig;
+        LogConfig logConfig;
+        TimeConfig timeConfig;
         nlohmann::json sourceJSON;
 
         GameConfig() : windowWidth(800), windowHeight(600), enableVulkanValidationLayers(false),
-                       assetLUTPath(), defaultScenePath(), gameScriptPath(), physicsConfig(), renderConfig() {}
+                       assetLUTPath(), defaultScenePath(), gameScriptPath(), fontAtlasCachePath("cache/fonts"), jobThreadCnt(-1), physicsConfig(), renderConfig(), scriptConfig(), animationConfig(), headlessConfig(), logConfig(), timeConfig() {}
         GameConfig(const nlohmann::json &json) : GameConfig()
         {
             sourceJSON = json;
@@ -39,6 +52,16 @@ namespace vke_common
                 physicsConfig.LoadJSON(json["physicsConfig"]);
             if (json.contains("renderConfig"))
                 renderConfig.LoadJSON(json["renderConfig"]);
+            if (json.contains("scriptConfig"))
+                scriptConfig.LoadJSON(json["scriptConfig"]);
+            if (json.contains("animationConfig"))
+                animationConfig.LoadJSON(json["animationConfig"]);
+            if (json.contains("headlessConfig"))
+                headlessConfig.LoadJSON(json["headlessConfig"]);
+            if (json.contains("logConfig"))
+                logConfig.LoadJSON(json["logConfig"]);
+            if (json.contains("timeConfig"))
+                timeConfig.LoadJSON(json["timeConfig"]);
         }
 
         static GameConfig *GetInstance()
@@ -20,6 +20,9 @@ namespace vke_common
         GameObject(const nlohmann::json &json)
             : id(json["id"]), layer(json["layer"]), isStatic(json["static"]), name(json["name"]) {}
 
+        GameObject(vke_ds::id32_t id, int layer, bool isStatic, std::string name)
+            : id(id), layer(layer), isStatic(isStatic), name(std::move(name)) {}
+
         ~GameObject() {}
 
         nlohmann::json ToJSON()
@@ -0,0 +1,35 @@
+#ifndef HEADLESS_CONFIG_H
+#define HEADLESS_CONFIG_H
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace vke_common
+{
+    // Runs the engine without a window: no GLFW, no surface or swapchain, input only from whatever
+    // calls the InputManager callbacks. Meant for automated soak and benchmark runs.
+    struct HeadlessConfig
+    {
+        bool enabled = false;
+        // renders into offscreen images of windowWidth x windowHeight; false runs logic only, the
+        // device still exists for assets but no frame is recorded or submitted
+        bool render = true;
+        // seconds the clock advances per frame, <= 0 follows the wall clock
+        float fixedDeltaTime = 1.0f / 60.0f;
+        // frames to run before exiting, 0 runs until the engine is terminated
+        uint32_t frameCnt = 0;
+
+        void LoadJSON(const nlohmann::json &json)
+        {
+            if (json.is_null())
+                return;
+
+            enabled = json.value("enabled", enabled);
+            render = json.value("render", render);
+            fixedDeltaTime = json.value("fixedDeltaTime", fixedDeltaTime);
+            frameCnt = json.value("frameCnt", frameCnt);
+        }
+    };
+}
+
+#endif
@@ -75,6 +75,8 @@ namespace vke_common
         glm::vec2 mouseDelta;
         glm::vec2 scrollDelta;
         bool hasMousePosition;
+        // kept for headless runs, where there is no window to ask
+        int cursorMode;
 
         static InputManager &RequireInstance();
 
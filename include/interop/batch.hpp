@@ -0,0 +1,44 @@
+#ifndef INTEROP_BATCH_H
+#define INTEROP_BATCH_H
+
+#include <cstdint>
+#include <interop/interop.hpp>
+#include <interop/math.hpp>
+
+namespace vke_interop
+{
+    // Structure-of-arrays variants of the per-entity transform/body accessors.
+    // Every call takes a contiguous array of entity (or body) ids plus one contiguous array per property,
+    // so a script touching thousands of objects pays one managed->native transition per property.
+    using GetTransformLocalPositionsFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, Vector3<float> *);
+    using SetTransformLocalPositionsFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, const Vector3<float> *);
+    using GetTransformLocalRotationsFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, Quaternion<float> *);
+    using SetTransformLocalRotationsFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, const Quaternion<float> *);
+    using GetTransformLocalScalesFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, Vector3<float> *);
+    using SetTransformLocalScalesFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, const Vector3<float> *);
+    using GetTransformGlobalPositionsFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, Vector3<float> *);
+    using GetTransformGlobalRotationsFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, Quaternion<float> *);
+    using TranslateTransformsGlobalFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, const Vector3<float> *);
+    using GetBodyPositionsAndRotationsFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, Vector3<float> *, Quaternion<float> *);
+    using GetBodyLinearVelocitiesFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, Vector3<float> *);
+    using SetBodyLinearVelocitiesFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, const Vector3<float> *);
+    using GetBodyAngularVelocitiesFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, Vector3<float> *);
+    using SetBodyAngularVelocitiesFn = void(VKE_INTEROP_CDECL *)(const uint32_t *, uint32_t, const Vector3<float> *);
+
+    void VKE_INTEROP_CDECL GetTransformLocalPositions(const uint32_t *entities, uint32_t count, Vector3<float> *positions);
+    void VKE_INTEROP_CDECL SetTransformLocalPositions(const uint32_t *entities, uint32_t count, const Vector3<float> *positions);
+    void VKE_INTEROP_CDECL GetTransformLocalRotations(const uint32_t *entities, uint32_t count, Quaternion<float> *rotations);
+    void VKE_INTEROP_CDECL SetTransformLocalRotations(const uint32_t *entities, uint32_t count, const Quaternion<float> *rotations);
+    void VKE_INTEROP_CDECL GetTransformLocalScales(const uint32_t *entities, uint32_t count, Vector3<float> *scales);
+    void VKE_INTEROP_CDECL SetTransformLocalScales(const uint32_t *entities, uint32_t count, const Vector3<float> *scales);
+    void VKE_INTEROP_CDECL GetTransformGlobalPositions(const uint32_t *entities, uint32_t count, Vector3<float> *positions);
+    void VKE_INTEROP_CDECL GetTransformGlobalRotations(const uint32_t *entities, uint32_t count, Quaternion<float> *rotations);
+    void VKE_INTEROP_CDECL TranslateTransformsGlobal(const uint32_t *entities, uint32_t count, const Vector3<float> *deltas);
+    void VKE_INTEROP_CDECL GetBodyPositionsAndRotations(const uint32_t *bodyIDs, uint32_t count, Vector3<float> *positions, Quaternion<float> *rotations);
+    void VKE_INTEROP_CDECL GetBodyLinearVelocities(const uint32_t *bodyIDs, uint32_t count, Vector3<float> *linearVelocities);
+    void VKE_INTEROP_CDECL SetBodyLinearVelocities(const uint32_t *bodyIDs, uint32_t count, const Vector3<float> *linearVelocities);
+    void VKE_INTEROP_CDECL GetBodyAngularVelocities(const uint32_t *bodyIDs, uint32_t count, Vector3<float> *angularVelocities);
+    void VKE_INTEROP_CDECL SetBodyAngularVelocities(const uint32_t *bodyIDs, uint32_t count, const Vector3<float> *angularVelocities);
+}
+
+#endif
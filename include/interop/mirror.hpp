@@ -0,0 +1,45 @@
+#ifndef INTEROP_MIRROR_H
+#define INTEROP_MIRROR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <interop/interop.hpp>
+#include <interop/math.hpp>
+
+namespace vke_interop
+{
+    enum ComponentMirrorFlag : uint32_t
+    {
+        COMPONENT_MIRROR_VALID = 1u << 0,
+        COMPONENT_MIRROR_HAS_RIGIDBODY = 1u << 1,
+        COMPONENT_MIRROR_BODY_ACTIVE = 1u << 2,
+        COMPONENT_MIRROR_HAS_CHARACTER_CONTROLLER = 1u << 3,
+    };
+
+    // Shared with C# (NativeComponentMirrorView in csharp/EngineCore/ComponentMirror.cs), keep the layouts in sync.
+    // Arrays are indexed by entity index (entity & entityIndexMask) and hold capacity elements.
+    // generation is odd while a refresh is writing and is bumped twice per refresh, so a reader that
+    // sees the same even value before and after copying got a consistent frame.
+    struct ComponentMirrorView
+    {
+        uint64_t generation;
+        uint32_t capacity;
+        uint32_t entityIndexMask;
+        const uint32_t *entities;
+        const uint32_t *flags;
+        const Vector3<float> *worldPositions;
+        const Quaternion<float> *worldRotations;
+        const Vector3<float> *linearVelocities;
+        const Vector3<float> *angularVelocities;
+    };
+
+    static_assert(sizeof(Vector3<float>) == 12, "Vector3<float> must match NVec3");
+    static_assert(sizeof(Quaternion<float>) == 16, "Quaternion<float> must match NQuat");
+    static_assert(offsetof(ComponentMirrorView, entities) == 16, "ComponentMirrorView header must stay 16 bytes");
+
+    using GetComponentMirrorViewFn = const ComponentMirrorView *(VKE_INTEROP_CDECL *)();
+
+    const ComponentMirrorView *VKE_INTEROP_CDECL GetComponentMirrorView();
+}
+
+#endif
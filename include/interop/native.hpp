@@ -4,8 +4,11 @@
 #include <cstdint>
 #include <interop/interop.hpp>
 #include <interop/math.hpp>
+#include <interop/batch.hpp>
 #include <interop/light.hpp>
+#include <interop/mirror.hpp>
 #include <interop/physics.hpp>
+#include <interop/script.hpp>
 #include <interop/text.hpp>
 
 namespace vke_interop
@@ -151,7 +154,26 @@ namespace vke_interop
         PhysicsCollidePointFn PhysicsCollidePoint;
         PhysicsCollideShapeFn PhysicsCollideShape;
         PhysicsCastShapeFn PhysicsCastShape;
+        GetTransformLocalPositionsFn GetTransformLocalPositions;
+        SetTransformLocalPositionsFn SetTransformLocalPositions;
+        GetTransformLocalRotationsFn GetTransformLocalRotations;
+        SetTransformLocalRotationsFn SetTransformLocalRotations;
+        GetTransformLocalScalesFn GetTransformLocalScales;
+        SetTransformLocalScalesFn SetTransformLocalScales;
+        GetTransformGlobalPositionsFn GetTransformGlobalPositions;
+        GetTransformGlobalRotationsFn GetTransformGlobalRotations;
+        TranslateTransformsGlobalFn TranslateTransformsGlobal;
+        GetBodyPositionsAndRotationsFn GetBodyPositionsAndRotations;
+        GetBodyLinearVelocitiesFn GetBodyLinearVelocities;
+        SetBodyLinearVelocitiesFn SetBodyLinearVelocities;
+        GetBodyAngularVelocitiesFn GetBodyAngularVelocities;
+        SetBodyAngularVelocitiesFn SetBodyAngularVelocities;
+        GetComponentMirrorViewFn GetComponentMirrorView;
+        RegisterScheduledScriptFn RegisterScheduledScript;
+        UnregisterScheduledScriptFn UnregisterScheduledScript;
     };
+
+    const NativeFunctions &GetNativeFunctions();
 }
 
 #endif
@@ -0,0 +1,16 @@
+#ifndef INTEROP_SCRIPT_H
+#define INTEROP_SCRIPT_H
+
+#include <cstdint>
+#include <interop/interop.hpp>
+
+namespace vke_interop
+{
+    using RegisterScheduledScriptFn = uint32_t(VKE_INTEROP_CDECL *)(const char *, uint32_t, uint32_t, float, uint32_t);
+    using UnregisterScheduledScriptFn = void(VKE_INTEROP_CDECL *)(uint32_t);
+
+    uint32_t VKE_INTEROP_CDECL RegisterScheduledScript(const char *name, uint32_t mode, uint32_t interval, float budgetMs, uint32_t phaseMask);
+    void VKE_INTEROP_CDECL UnregisterScheduledScript(uint32_t id);
+}
+
+#endif
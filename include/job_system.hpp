@@ -0,0 +1,145 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <ds/work_stealing_deque.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vke_common
+{
+    struct QueuedJob;
+
+    enum class JobAffinity
+    {
+        ANY,
+        // only run by RunMainThreadJobs, or by a Wait on the main thread
+        MAIN_THREAD
+    };
+
+    // Counts the outstanding jobs that were queued with it. Jobs queued with RunAfter on a counter
+    // start once it drops to zero. A counter must stay alive until Wait on it returned, and must
+    // not get new jobs while jobs are still gated on it.
+    class JobCounter
+    {
+    public:
+        JobCounter() : value(0), releasing(0) {}
+        JobCounter(const JobCounter &) = delete;
+        JobCounter &operator=(const JobCounter &) = delete;
+
+        bool IsDone() const
+        {
+            return value.load(std::memory_order_seq_cst) == 0 && releasing.load(std::memory_order_seq_cst) == 0;
+        }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<uint32_t> value;
+        // finishing jobs still touching the counter, so it is not done before its waiters are queued
+        std::atomic<uint32_t> releasing;
+        std::mutex waitersMutex;
+        std::vector<QueuedJob *> waiters;
+    };
+
+    // Work stealing job system shared by the engine. Every worker thread owns a deque it pushes to
+    // and pops from, idle workers steal from the others. The thread that creates the system is
+    // worker 0 and the main thread: it runs jobs while it waits, and it is the only thread that
+    // runs MAIN_THREAD jobs.
+    class JobSystem
+    {
+    public:
+        static constexpr uint32_t INVALID_WORKER = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t DEQUE_CAPACITY = 4096;
+
+        struct Stats
+        {
+            uint64_t executedCnt = 0;
+            uint64_t stolenCnt = 0;
+        };
+
+        // threadCnt extra threads, 0 runs everything on the main thread
+        explicit JobSystem(uint32_t threadCnt);
+        ~JobSystem();
+        JobSystem(const JobSystem &) = delete;
+        JobSystem &operator=(const JobSystem &) = delete;
+
+        static JobSystem *GetInstance();
+        // < 0 uses hardware concurrency - 1
+        static JobSystem *Init(int32_t threadCnt = -1);
+        static void Dispose();
+        static uint32_t DefaultThreadCnt();
+
+        uint32_t GetWorkerCnt() const { return static_cast<uint32_t>(workers.size()); }
+        // 0 on the main thread, INVALID_WORKER on threads the system does not own
+        uint32_t GetWorkerIndex() const;
+        bool IsMainThread() const { return GetWorkerIndex() == 0; }
+
+        void Run(std::function<void()> fn, JobCounter *counter = nullptr, JobAffinity affinity = JobAffinity::ANY);
+        // queues fn once dependency drops to zero, at once if it already is
+        void RunAfter(JobCounter &dependency, std::function<void()> fn, JobCounter *counter = nullptr,
+                      JobAffinity affinity = JobAffinity::ANY);
+        void RunOnMainThread(std::function<void()> fn, JobCounter *counter = nullptr)
+        {
+            Run(std::move(fn), counter, JobAffinity::MAIN_THREAD);
+        }
+        // main thread only, runs the MAIN_THREAD jobs queued so far
+        void RunMainThreadJobs();
+
+        // runs other jobs until counter is done
+        void Wait(JobCounter &counter);
+
+        // runs fn(begin, end, worker) over [0, count) in chunks of grain elements and returns when all
+        // of them finished; the calling thread takes part, so it has to be one of the system's own
+        void ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t, uint32_t)> &fn);
+
+        Stats GetStats() const;
+
+    private:
+        struct alignas(64) Worker
+        {
+            vke_ds::WorkStealingDeque<QueuedJob> deque;
+            std::atomic<uint64_t> executedCnt;
+            std::atomic<uint64_t> stolenCnt;
+
+            Worker() : deque(DEQUE_CAPACITY), executedCnt(0), stolenCnt(0) {}
+        };
+
+        static JobSystem *instance;
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+
+        // jobs from threads without a deque, or that did not fit into one
+        std::mutex injectedMutex;
+        std::vector<QueuedJob *> injected;
+        std::atomic<uint32_t> injectedCnt;
+
+        std::mutex mainThreadMutex;
+        std::vector<QueuedJob *> mainThreadJobs;
+        std::atomic<uint32_t> mainThreadJobCnt;
+
+        // queued jobs nobody has taken yet, workers sleep while it is zero; briefly negative when a
+        // job is taken before its push is counted
+        std::atomic<int32_t> queuedCnt;
+        std::atomic<uint32_t> sleeperCnt;
+        std::mutex sleepMutex;
+        std::condition_variable wakeCondition;
+        std::atomic<bool> stop;
+
+        void enqueue(QueuedJob *job);
+        QueuedJob *findJob(uint32_t workerIndex);
+        QueuedJob *takeInjected();
+        void execute(QueuedJob *job, uint32_t workerIndex);
+        void finish(JobCounter *counter);
+        void workerLoop(uint32_t workerIndex);
+    };
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef LOG_CONFIG_H
+#define LOG_CONFIG_H
+
+#include <cstdint>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace vke_common
+{
+    struct LogConfig
+    {
+        // trace, debug, info, warn, error, critical or off; levels compiled out by VKE_LOG_ACTIVE_LEVEL stay out
+        std::string level = "info";
+        bool console = true;
+        // empty disables the sink
+        std::string filePath;
+        std::string rotatingFilePath;
+        uint32_t rotatingMaxSize = 5 * 1024 * 1024;
+        uint32_t rotatingMaxFiles = 3;
+        // how often the background thread writes out what was logged, errors are written at once
+        uint32_t flushIntervalMs = 10;
+
+        void LoadJSON(const nlohmann::json &json)
+        {
+            if (json.is_null())
+                return;
+
+            level = json.value("level", level);
+            console = json.value("console", console);
+            filePath = json.value("filePath", filePath);
+            rotatingFilePath = json.value("rotatingFilePath", rotatingFilePath);
+            rotatingMaxSize = json.value("rotatingMaxSize", rotatingMaxSize);
+            rotatingMaxFiles = json.value("rotatingMaxFiles", rotatingMaxFiles);
+            flushIntervalMs = json.value("flushIntervalMs", flushIntervalMs);
+        }
+    };
+}
+
+#endif
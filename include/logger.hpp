@@ -1,109 +1,318 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-// #include <spdlog/spdlog.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
-#include <stdexcept>
+#include <log_config.hpp>
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+// the same numbers as spdlog::level
+#define VKE_LOG_LEVEL_TRACE 0
+#define VKE_LOG_LEVEL_DEBUG 1
+#define VKE_LOG_LEVEL_INFO 2
+#define VKE_LOG_LEVEL_WARN 3
+#define VKE_LOG_LEVEL_ERROR 4
+#define VKE_LOG_LEVEL_OFF 6
+
+// calls below this level are compiled out together with their arguments
+#ifndef VKE_LOG_ACTIVE_LEVEL
+#ifdef VKE_DEBUG
+#define VKE_LOG_ACTIVE_LEVEL VKE_LOG_LEVEL_DEBUG
+#else
+#define VKE_LOG_ACTIVE_LEVEL VKE_LOG_LEVEL_INFO
+#endif
+#endif
 
 namespace vke_common
 {
+    // numbers, enums and pointers other than C strings are copied into the record and formatted by
+    // the writer thread; anything that may refer to memory the caller owns is formatted right away
+    template <typename T>
+    inline constexpr bool IsDeferredLogArg = std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+                                             (std::is_pointer_v<T> && !std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>);
+
+    // Log calls write a record into a fixed ring of slots and return, a background thread formats
+    // the records and writes them to the sinks. Records that do not fit into the ring are dropped
+    // and counted below warn; warnings and errors wait for room. Errors wake the writer at once.
     class Logger
     {
-    private:
-        static Logger *instance;
-        Logger() {}
-        ~Logger() {}
-        Logger(const Logger &);
-        Logger &operator=(const Logger);
-
     public:
+        static constexpr uint32_t SLOT_SIZE = 128;
+        static constexpr uint32_t SLOT_CNT = 16384;
+        // a record spans at most this many slots, longer messages are cut
+        static constexpr uint32_t MAX_RECORD_SLOTS = 64;
+
         static Logger *GetInstance()
         {
-            if (instance == nullptr)
+            Logger *logger = instance.load(std::memory_order_acquire);
+            return logger != nullptr ? logger : createInstance();
+        }
+
+        // replaces the sinks and the runtime level
+        static void Configure(const LogConfig &config);
+        static void SetLevel(spdlog::level::level_enum level);
+        static spdlog::level::level_enum GetLevel();
+        // returns once everything logged before the call is written out
+        static void Flush();
+        // stops the writer thread, later calls write synchronously
+        static void Shutdown();
+        static uint64_t GetDroppedCount();
+
+        template <typename... Args>
+        static void Log(spdlog::level::level_enum level, spdlog::format_string_t<Args...> fmt, Args &&...args)
+        {
+            Logger *logger = GetInstance();
+            if (level < logger->level.load(std::memory_order_relaxed))
+                return;
+            if constexpr ((IsDeferredLogArg<std::decay_t<Args>> && ...) &&
+                          sizeof(std::tuple<std::decay_t<Args>...>) <= FIRST_PAYLOAD_SIZE &&
+                          alignof(std::tuple<std::decay_t<Args>...>) <= alignof(RecordHeader))
+                logger->pushDeferred<std::decay_t<Args>...>(level, fmt.get(), std::forward<Args>(args)...);
+            else
             {
-                instance = new Logger();
-                instance->init();
+                spdlog::memory_buf_t &text = formatBuffer();
+                text.clear();
+                fmt::format_to(fmt::appender(text), fmt, std::forward<Args>(args)...);
+                logger->pushText(level, text.data(), text.size());
             }
-            return instance;
         }
 
         template <typename... Args>
         static void Trace(spdlog::format_string_t<Args...> fmt, Args &&...args)
         {
-            GetInstance()->logger->trace(fmt, std::forward<Args>(args)...);
+            Log(spdlog::level::trace, fmt, std::forward<Args>(args)...);
         }
 
         template <typename... Args>
         static void Debug(spdlog::format_string_t<Args...> fmt, Args &&...args)
         {
-            GetInstance()->logger->debug(fmt, std::forward<Args>(args)...);
+            Log(spdlog::level::debug, fmt, std::forward<Args>(args)...);
         }
 
         template <typename... Args>
         static void Info(spdlog::format_string_t<Args...> fmt, Args &&...args)
         {
-            GetInstance()->logger->info(fmt, std::forward<Args>(args)...);
+            Log(spdlog::level::info, fmt, std::forward<Args>(args)...);
         }
 
         template <typename... Args>
         static void Warn(spdlog::format_string_t<Args...> fmt, Args &&...args)
         {
-            GetInstance()->logger->warn(fmt, std::forward<Args>(args)...);
+            Log(spdlog::level::warn, fmt, std::forward<Args>(args)...);
         }
 
         template <typename... Args>
         static void Error(spdlog::format_string_t<Args...> fmt, Args &&...args)
         {
-            GetInstance()->logger->error(fmt, std::forward<Args>(args)...);
+            Log(spdlog::level::err, fmt, std::forward<Args>(args)...);
         }
 
         template <typename T>
         static void Trace(const T &msg)
         {
-            GetInstance()->logger->trace(msg);
+            Log(spdlog::level::trace, "{}", msg);
         }
 
         template <typename T>
         static void Debug(const T &msg)
         {
-            GetInstance()->logger->debug(msg);
+            Log(spdlog::level::debug, "{}", msg);
         }
 
         template <typename T>
         static void Info(const T &msg)
         {
-            GetInstance()->logger->info(msg);
+            Log(spdlog::level::info, "{}", msg);
         }
 
         template <typename T>
         static void Warn(const T &msg)
         {
-            GetInstance()->logger->warn(msg);
+            Log(spdlog::level::warn, "{}", msg);
         }
 
         template <typename T>
         static void Error(const T &msg)
         {
-            GetInstance()->logger->error(msg);
+            Log(spdlog::level::err, "{}", msg);
         }
 
     private:
-        std::shared_ptr<spdlog::logger> logger;
+        using FormatFn = void (*)(const void *payload, fmt::string_view fmt, spdlog::memory_buf_t &out);
 
-        void init()
+        struct RecordHeader
         {
-            logger = spdlog::stdout_color_mt("vkEngine");
-#ifdef VKE_DEBUG
-            // logger->set_level(spdlog::level::debug);
-#endif
+            spdlog::log_clock::time_point time;
+            // formats the arguments stored in the payload, nullptr when the payload is the message
+            FormatFn format;
+            const char *fmtData;
+            uint32_t fmtSize;
+            uint32_t textSize;
+            uint16_t slotCnt;
+            uint8_t level;
+        };
+
+        struct alignas(64) Slot
+        {
+            std::atomic<uint64_t> sequence;
+            alignas(8) unsigned char bytes[SLOT_SIZE - sizeof(std::atomic<uint64_t>)];
+        };
+
+        static constexpr uint32_t SLOT_PAYLOAD_SIZE = sizeof(Slot::bytes);
+        static constexpr uint32_t FIRST_PAYLOAD_SIZE = SLOT_PAYLOAD_SIZE - sizeof(RecordHeader);
+        static constexpr uint64_t SLOT_MASK = SLOT_CNT - 1;
+        static_assert(sizeof(Slot) == SLOT_SIZE && (SLOT_CNT & SLOT_MASK) == 0);
+
+        template <typename... Ts>
+        struct DeferredArgs
+        {
+            std::tuple<Ts...> args;
+
+            static void Format(const void *payload, fmt::string_view fmt, spdlog::memory_buf_t &out)
+            {
+                std::apply([fmt, &out](const auto &...args)
+                           { fmt::vformat_to(fmt::appender(out), fmt, fmt::make_format_args(args...)); },
+                           static_cast<const DeferredArgs *>(payload)->args);
+            }
+        };
+
+        static std::atomic<Logger *> instance;
+
+        std::unique_ptr<Slot[]> slots;
+        alignas(64) std::atomic<uint64_t> enqueuePos;
+        alignas(64) std::atomic<uint64_t> dequeuePos;
+        std::atomic<uint64_t> droppedCnt;
+        std::atomic<int> level;
+        std::atomic<uint32_t> flushIntervalMs;
+        std::atomic<bool> running;
+        std::atomic<bool> wakePending;
+
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable flushedCondition;
+        bool stop;
+
+        // guards the sinks, taken by the writer thread and by synchronous writes
+        std::mutex sinkMutex;
+        std::shared_ptr<spdlog::logger> sinkLogger;
+        std::thread writer;
+
+        Logger();
+        ~Logger() {}
+        Logger(const Logger &);
+        Logger &operator=(const Logger);
+
+        static Logger *createInstance();
+
+        static spdlog::memory_buf_t &formatBuffer()
+        {
+            thread_local spdlog::memory_buf_t buffer;
+            return buffer;
+        }
+
+        template <typename... Ts, typename... Args>
+        void pushDeferred(spdlog::level::level_enum recordLevel, fmt::string_view fmt, Args &&...args)
+        {
+            uint64_t pos;
+            if (!claim(recordLevel, 1, pos))
+            {
+                if (!running.load(std::memory_order_acquire))
+                    writeSynchronously(recordLevel, fmt::vformat(fmt, fmt::make_format_args(args...)));
+                return;
+            }
+            Slot &slot = slots[pos & SLOT_MASK];
+            const RecordHeader header{spdlog::log_clock::now(), &DeferredArgs<Ts...>::Format, fmt.data(),
+                                      static_cast<uint32_t>(fmt.size()), 0, 1, static_cast<uint8_t>(recordLevel)};
+            std::memcpy(slot.bytes, &header, sizeof(header));
+            new (slot.bytes + sizeof(RecordHeader)) DeferredArgs<Ts...>{std::tuple<Ts...>(std::forward<Args>(args)...)};
+            publish(recordLevel, pos, 1);
         }
+
+        void pushText(spdlog::level::level_enum recordLevel, const char *text, size_t size);
+        // reserves slotCnt consecutive slots, false when the record is dropped or the writer stopped
+        bool claim(spdlog::level::level_enum recordLevel, uint32_t slotCnt, uint64_t &pos);
+        void publish(spdlog::level::level_enum recordLevel, uint64_t pos, uint32_t slotCnt);
+        void requestWake();
+        bool writeOne(spdlog::memory_buf_t &text);
+        void writeSynchronously(spdlog::level::level_enum recordLevel, fmt::string_view text);
+        void writerLoop();
     };
 
+    // Lets a call site through at most once per interval; VKE_LOG_EVERY_MS uses one per call site.
+    class LogRateLimiter
+    {
+    public:
+        explicit LogRateLimiter(uint32_t intervalMs)
+            : intervalNs(static_cast<int64_t>(intervalMs) * 1000000), nextNs(0), suppressedCnt(0) {}
+
+        // on true, suppressed is how many calls were turned away since the last one let through
+        bool Allow(uint32_t &suppressed)
+        {
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now().time_since_epoch())
+                                    .count();
+            int64_t next = nextNs.load(std::memory_order_relaxed);
+            if (now < next || !nextNs.compare_exchange_strong(next, now + intervalNs, std::memory_order_relaxed))
+            {
+                suppressedCnt.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            suppressed = suppressedCnt.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+        const int64_t intervalNs;
+        std::atomic<int64_t> nextNs;
+        std::atomic<uint32_t> suppressedCnt;
+    };
+
+#if VKE_LOG_ACTIVE_LEVEL <= VKE_LOG_LEVEL_TRACE
 #define VKE_LOG_TRACE(...) vke_common::Logger::Trace(__VA_ARGS__);
+#else
+#define VKE_LOG_TRACE(...) (void)0;
+#endif
+#if VKE_LOG_ACTIVE_LEVEL <= VKE_LOG_LEVEL_DEBUG
 #define VKE_LOG_DEBUG(...) vke_common::Logger::Debug(__VA_ARGS__);
+#else
+#define VKE_LOG_DEBUG(...) (void)0;
+#endif
+#if VKE_LOG_ACTIVE_LEVEL <= VKE_LOG_LEVEL_INFO
 #define VKE_LOG_INFO(...) vke_common::Logger::Info(__VA_ARGS__);
+#else
+#define VKE_LOG_INFO(...) (void)0;
+#endif
+#if VKE_LOG_ACTIVE_LEVEL <= VKE_LOG_LEVEL_WARN
 #define VKE_LOG_WARN(...) vke_common::Logger::Warn(__VA_ARGS__);
+#else
+#define VKE_LOG_WARN(...) (void)0;
+#endif
+#if VKE_LOG_ACTIVE_LEVEL <= VKE_LOG_LEVEL_ERROR
 #define VKE_LOG_ERROR(...) vke_common::Logger::Error(__VA_ARGS__);
+#else
+#define VKE_LOG_ERROR(...) (void)0;
+#endif
+
+// LEVEL is TRACE, DEBUG, INFO, WARN or ERROR; logs at most once per intervalMs from this call site
+// and then says how many calls it left out
+#define VKE_LOG_EVERY_MS(LEVEL, intervalMs, ...)                                                 \
+    {                                                                                            \
+        static vke_common::LogRateLimiter vkeLogLimiter(intervalMs);                             \
+        uint32_t vkeLogSuppressedCnt = 0;                                                        \
+        if (vkeLogLimiter.Allow(vkeLogSuppressedCnt))                                            \
+        {                                                                                        \
+            VKE_LOG_##LEVEL(__VA_ARGS__)                                                         \
+            if (vkeLogSuppressedCnt > 0)                                                         \
+                VKE_LOG_##LEVEL("({} more like the above suppressed)", vkeLogSuppressedCnt) \
+        }                                                                                        \
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace vke_common
+{
+    // Read-only memory mapping of a whole file.
+    class MappedFile
+    {
+    public:
+        MappedFile() : data(nullptr), size(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool Open(const std::string &pth);
+        void Close();
+
+        bool IsOpen() const { return data != nullptr; }
+        std::span<const uint8_t> GetBytes() const { return std::span<const uint8_t>(data, size); }
+
+    private:
+        const uint8_t *data;
+        size_t size;
+        void *fileHandle;
+        void *mappingHandle;
+    };
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef BROADPHASE_MAINTENANCE_H
+#define BROADPHASE_MAINTENANCE_H
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Core/JobSystem.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <physics/physics_config.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace vke_physics
+{
+    struct BroadPhaseLayerMetrics
+    {
+        uint32_t bodyCount = 0;
+        uint32_t addedSinceOptimize = 0;
+        uint32_t removedSinceOptimize = 0;
+        uint32_t churnSinceUpdate = 0;
+        uint64_t totalAdded = 0;
+        uint64_t totalRemoved = 0;
+        // cost of the last probe query batch against this layer only
+        float probeQueryUs = 0.0f;
+        // probe cost measured right after the last full optimization
+        float baselineProbeQueryUs = 0.0f;
+        uint32_t probeHits = 0;
+    };
+
+    struct BroadPhaseMetrics
+    {
+        std::array<BroadPhaseLayerMetrics, MaxBroadPhaseLayers> layers{};
+        uint32_t layerCount = 0;
+        uint64_t frameIndex = 0;
+        uint32_t fullOptimizeCount = 0;
+        uint32_t forcedOptimizeCount = 0;
+        uint32_t incrementalUpdateCount = 0;
+        uint32_t deferredFrames = 0;
+        float lastFullOptimizeMs = 0.0f;
+        float lastIncrementalUpdateMs = 0.0f;
+        float fullOptimizeMsPerBody = 0.0f;
+    };
+
+    // Tracks add/remove churn per broad phase layer and keeps the Jolt quad trees healthy
+    // without the full, blocking OptimizeBroadPhase on every spawn wave.
+    // Incremental maintenance is Jolt's own dirty tree rebuild (UpdatePrepare/UpdateFinalize), which only
+    // runs inside PhysicsSystem::Update; frames that did not step physics get a zero-length update instead.
+    // A full optimization is scheduled once churn or probe degradation crosses the configured thresholds,
+    // and only when its estimated cost fits the per-frame budget (or after maxDeferredFrames).
+    class BroadPhaseMaintenance
+    {
+    public:
+        BroadPhaseMaintenance() : config(nullptr) {}
+
+        void Init(const PhysicsConfig &physicsConfig)
+        {
+            config = &physicsConfig;
+            metrics = BroadPhaseMetrics();
+            metrics.layerCount = physicsConfig.broadPhaseLayerCount;
+            stepsSinceUpdate = 0;
+        }
+
+        void NotifyBodyAdded(JPH::BroadPhaseLayer layer)
+        {
+            BroadPhaseLayerMetrics *layerMetrics = getLayer(layer);
+            if (layerMetrics == nullptr)
+                return;
+            ++layerMetrics->bodyCount;
+            ++layerMetrics->addedSinceOptimize;
+            ++layerMetrics->churnSinceUpdate;
+            ++layerMetrics->totalAdded;
+        }
+
+        void NotifyBodyRemoved(JPH::BroadPhaseLayer layer)
+        {
+            BroadPhaseLayerMetrics *layerMetrics = getLayer(layer);
+            if (layerMetrics == nullptr)
+                return;
+            if (layerMetrics->bodyCount > 0)
+                --layerMetrics->bodyCount;
+            ++layerMetrics->removedSinceOptimize;
+            ++layerMetrics->churnSinceUpdate;
+            ++layerMetrics->totalRemoved;
+        }
+
+        void NotifyPhysicsStep()
+        {
+            ++stepsSinceUpdate;
+        }
+
+        void Update(JPH::PhysicsSystem &physicsSystem, JPH::TempAllocator *tempAllocator, JPH::JobSystem *jobSystem);
+        void Optimize(JPH::PhysicsSystem &physicsSystem);
+        void Probe(JPH::PhysicsSystem &physicsSystem);
+
+        const BroadPhaseMetrics &GetMetrics() const { return metrics; }
+
+    private:
+        const PhysicsConfig *config;
+        BroadPhaseMetrics metrics;
+        uint32_t stepsSinceUpdate;
+
+        BroadPhaseLayerMetrics *getLayer(JPH::BroadPhaseLayer layer)
+        {
+            const uint32_t index = layer.GetValue();
+            if (index >= MaxBroadPhaseLayers)
+                return nullptr;
+            metrics.layerCount = std::max(metrics.layerCount, index + 1);
+            return &metrics.layers[index];
+        }
+
+        bool needsFullOptimize() const;
+    };
+}
+
+#endif
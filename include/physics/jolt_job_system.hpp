@@ -0,0 +1,38 @@
+#ifndef JOLT_JOB_SYSTEM_H
+#define JOLT_JOB_SYSTEM_H
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+#include <job_system.hpp>
+
+namespace vke_physics
+{
+    // Runs Jolt's jobs on the engine's job system instead of a thread pool of its own, so physics
+    // and engine jobs share one set of workers rather than oversubscribing the cores.
+    class JoltJobSystem final : public JPH::JobSystemWithBarrier
+    {
+    public:
+        JoltJobSystem(vke_common::JobSystem &jobSystem, JPH::uint maxJobs, JPH::uint maxBarriers);
+        ~JoltJobSystem() override;
+
+        int GetMaxConcurrency() const override { return static_cast<int>(jobSystem.GetWorkerCnt()); }
+        JobHandle CreateJob(const char *inName, JPH::ColorArg inColor, const JobFunction &inJobFunction,
+                            JPH::uint32 inNumDependencies = 0) override;
+
+    protected:
+        void QueueJob(Job *inJob) override;
+        void QueueJobs(Job **inJobs, JPH::uint inNumJobs) override;
+        void FreeJob(Job *inJob) override;
+
+    private:
+        using AvailableJobs = JPH::FixedSizeFreeList<Job>;
+
+        vke_common::JobSystem &jobSystem;
+        AvailableJobs jobs;
+        // engine jobs that still hold a reference to a Jolt job
+        vke_common::JobCounter queued;
+    };
+}
+
+#endif
@@ -19,6 +19,8 @@
 #include <event.hpp>
 #include <logger.hpp>
 #include <physics/physics_config.hpp>
+#include <physics/broadphase_maintenance.hpp>
+#include <physics/jolt_job_system.hpp>
 #include <vector>
 #include <functional>
 #include <mutex>
@@ -276,6 +278,31 @@ namespace vke_physics
             instance->updates.RemoveEventListener(id);
         }
 
+        static JPH::BodyID CreateAndAddBody(const JPH::BodyCreationSettings &settings, JPH::EActivation activation)
+        {
+            return instance->createAndAddBody(settings, activation);
+        }
+
+        static void RemoveAndDestroyBody(JPH::BodyID bodyID)
+        {
+            instance->removeAndDestroyBody(bodyID);
+        }
+
+        static void MaintainBroadPhase()
+        {
+            instance->broadPhaseMaintenance.Update(instance->physicsSystem, instance->tempAllocator.get(), instance->jobSystem.get());
+        }
+
+        static void OptimizeBroadPhase()
+        {
+            instance->broadPhaseMaintenance.Optimize(instance->physicsSystem);
+        }
+
+        static const BroadPhaseMetrics &GetBroadPhaseMetrics()
+        {
+            return instance->broadPhaseMaintenance.GetMetrics();
+        }
+
         static JPH::BodyInterface &GetBodyInterface()
         {
             return instance->physicsSystem.GetBodyInterface();
@@ -370,6 +397,8 @@ namespace vke_physics
         void init();
         void dispose();
         void fixedUpdate();
+        JPH::BodyID createAndAddBody(const JPH::BodyCreationSettings &settings, JPH::EActivation activation);
+        void removeAndDestroyBody(JPH::BodyID bodyID);
         bool raycast(JPH::RVec3Arg origin, JPH::Vec3Arg direction, float maxDistance, RaycastHit &outHit, uint32_t broadPhaseLayerMask, uint32_t objectLayerMask);
         uint32_t raycastAll(JPH::RVec3Arg origin, JPH::Vec3Arg direction, float maxDistance, RaycastHit *outHits, uint32_t maxHits, uint32_t broadPhaseLayerMask, uint32_t objectLayerMask);
         uint32_t collidePoint(JPH::RVec3Arg point, CollidePointHit *outHits, uint32_t maxHits, uint32_t broadPhaseLayerMask, uint32_t objectLayerMask);
@@ -382,13 +411,14 @@ namespace vke_physics
 
         PhysicsConfig config;
         std::unique_ptr<JPH::TempAllocatorImpl> tempAllocator;
-        std::unique_ptr<JPH::JobSystemThreadPool> jobSystem;
+        std::unique_ptr<JPH::JobSystem> jobSystem;
         BPLayerInterfaceImpl broadPhaseLayerInterface;
         ObjectVsBroadPhaseLayerFilterImpl objectVsBroadphaseLayerFilter;
         ObjectLayerPairFilterImpl objectVsObjectLayerFilter;
         BodyActivationListener bodyActivationListener;
         ContactListener contactListener;
         JPH::PhysicsSystem physicsSystem;
+        BroadPhaseMaintenance broadPhaseMaintenance;
         vke_common::EventHub<void> updates;
         std::mutex contactEventsTailMutex;
         std::vector<ContactEvent> contactEvents;
@@ -29,6 +29,33 @@ namespace vke_physics
         static constexpr uint32_t NUM_LAYERS(2);
     };
 
+    struct BroadPhaseMaintenanceConfig
+    {
+        bool enabled = true;
+        float frameBudgetMs = 1.0f;
+        uint32_t churnThreshold = 256;
+        float churnRatio = 0.25f;
+        float probeDegradeRatio = 2.0f;
+        uint32_t probeInterval = 30;
+        uint32_t probeRayCount = 16;
+        uint32_t maxDeferredFrames = 300;
+
+        void LoadJSON(const nlohmann::json &json)
+        {
+            if (json.is_null())
+                return;
+
+            enabled = json.value("enabled", enabled);
+            frameBudgetMs = json.value("frameBudgetMs", frameBudgetMs);
+            churnThreshold = json.value("churnThreshold", churnThreshold);
+            churnRatio = json.value("churnRatio", churnRatio);
+            probeDegradeRatio = json.value("probeDegradeRatio", probeDegradeRatio);
+            probeInterval = json.value("probeInterval", probeInterval);
+            probeRayCount = json.value("probeRayCount", probeRayCount);
+            maxDeferredFrames = json.value("maxDeferredFrames", maxDeferredFrames);
+        }
+    };
+
     struct PhysicsConfig
     {
         uint32_t maxBodies = 65536 * 4;
@@ -39,6 +66,7 @@ namespace vke_physics
         uint32_t tempAllocatorSize = 10 * 1024 * 1024;
         float stepTime = 1.0f / 60.0f;
         JPH::Vec3 gravity = JPH::Vec3(0, -9.8f, 0);
+        BroadPhaseMaintenanceConfig broadPhaseMaintenance{};
 
         uint32_t objectLayerCount = 2;
         uint32_t broadPhaseLayerCount = 2;
@@ -0,0 +1,93 @@
+#ifndef COMPUTE_SKINNING_H
+#define COMPUTE_SKINNING_H
+
+#include <render/renderinfo.hpp>
+#include <render/frame_graph.hpp>
+#include <ds/range_allocator.hpp>
+#include <deque>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace vke_render
+{
+    // Skins every registered instance once per frame in a compute task and writes plain Vertex data
+    // into one storage buffer per frame in flight, sub-allocated by vertex count. The gbuffer and
+    // shadow passes then draw the output as static geometry instead of skinning in their vertex shaders.
+    class ComputeSkinningManager
+    {
+    public:
+        ComputeSkinningManager();
+        ~ComputeSkinningManager();
+        ComputeSkinningManager(const ComputeSkinningManager &) = delete;
+        ComputeSkinningManager &operator=(const ComputeSkinningManager &) = delete;
+
+        void ConstructFrameGraph(FrameGraph &frameGraph,
+                                 std::map<std::string, vke_ds::id32_t> &blackboard,
+                                 ResourceNodeIDMap &currentResourceNodeID);
+
+        // one bone palette set per frame in flight, rewritten in place when the palette grows
+        void SetPaletteDescriptorSets(const std::vector<VkDescriptorSet> &descriptorSets) { paletteDescriptorSets = descriptorSets; }
+
+        // units are drawn from the instance's output range from the next Update on
+        uint32_t AddInstance(std::shared_ptr<const Mesh> mesh, uint32_t jointOffset, std::vector<RenderUnit *> &&units);
+        void RemoveInstance(uint32_t id);
+
+        // the non-skinning variant of a builtin skin material, shared by every instance using it
+        std::shared_ptr<Material> &GetStaticMaterial(const std::shared_ptr<Material> &skinMaterial);
+
+        void Update(uint32_t currentFrame);
+
+        uint32_t GetInstanceCnt() const { return instanceCnt; }
+        uint32_t GetOutputVertexCnt() const { return vertexAllocator.GetEnd(); }
+
+    private:
+        struct Instance
+        {
+            std::shared_ptr<const Mesh> mesh;
+            uint32_t jointOffset;
+            uint32_t vertexOffset;
+            uint32_t vertexCnt;
+            std::vector<RenderUnit *> units;
+        };
+
+        struct MeshSource
+        {
+            uint32_t refCnt;
+            VkDescriptorSet descriptorSet;
+        };
+
+        struct PushConstant
+        {
+            uint32_t vertexCnt;
+            uint32_t jointOffset;
+            uint32_t dstVertexOffset;
+        };
+
+        std::unique_ptr<ComputePipeline> pipeline;
+        FrameGraph *frameGraph;
+        vke_ds::id32_t bufferResourceID;
+        std::vector<std::unique_ptr<DeviceBuffer>> outputBuffers;
+        std::vector<VkDescriptorSet> outputDescriptorSets;
+        std::vector<VkDescriptorSet> paletteDescriptorSets;
+        vke_ds::RangeAllocator<uint32_t> vertexAllocator;
+        std::vector<Instance> instances;
+        std::vector<uint32_t> freeInstanceIDs;
+        uint32_t instanceCnt;
+        std::unordered_map<const Mesh *, MeshSource> meshSources;
+        // mesh source sets of released meshes, stamped with the frame they were released in; the pool
+        // cannot free single sets, so they are reused once no frame in flight can still bind them
+        std::deque<std::pair<uint64_t, VkDescriptorSet>> retiredSourceSets;
+        std::vector<VkDescriptorSet> freeSourceSets;
+        uint64_t frameCnt;
+        std::map<Material *, std::pair<std::shared_ptr<Material>, std::shared_ptr<Material>>> staticMaterials;
+
+        VkDescriptorSet acquireMeshSource(const Mesh *mesh);
+        void releaseMeshSource(const Mesh *mesh);
+        void reserveOutput(uint32_t frame);
+        void skin(TaskNode &node, FrameGraph &frameGraph, VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t imageIndex);
+    };
+}
+
+#endif
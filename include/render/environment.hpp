@@ -60,8 +60,8 @@ namespace vke_render
     {
     private:
         static RenderEnvironment *instance;
-        RenderEnvironment(bool enableValidationLayers)
-            : windowResized(false), enableValidationLayers(enableValidationLayers) {}
+        RenderEnvironment(bool enableValidationLayers, bool headless)
+            : windowResized(false), enableValidationLayers(enableValidationLayers), headless(headless) {}
         ~RenderEnvironment() {}
         RenderEnvironment(const RenderEnvironment &);
         RenderEnvironment &operator=(const RenderEnvironment);
@@ -86,7 +86,7 @@ namespace vke_render
 
         static RenderEnvironment *Init(GLFWwindow *window, bool enableValidationLayers)
         {
-            instance = new RenderEnvironment(enableValidationLayers);
+            instance = new RenderEnvironment(enableValidationLayers, false);
             instance->window = window;
             instance->createInstance();
             instance->createSurface();
@@ -106,14 +106,49 @@ namespace vke_render
                 VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
                 instance->depthImages, instance->depthImageViews,
                 instance->swapChainImages, instance->swapChainImageViews,
-                &(instance->resizeEventHub), AcquireNextImage, Present);
+                &(instance->resizeEventHub), AcquireNextImage, Present);
             return instance;
         }
 
+        // No window, surface or swapchain: frames are rendered into offscreen color images, one per
+        // frame in flight, which are left in TRANSFER_SRC layout for read back.
+        static RenderEnvironment *InitHeadless(uint32_t width, uint32_t height, bool enableValidationLayers)
+        {
+            instance = new RenderEnvironment(enableValidationLayers, true);
+            instance->window = nullptr;
+            instance->surface = VK_NULL_HANDLE;
+            instance->createInstance();
+            instance->pickPhysicalDevice();
+            instance->createLogicalDevice();
+            instance->createVulkanMemoryAllocator();
+            instance->createCommandPool();
+            instance->createOffscreenTargets(width, height);
+            instance->createSyncObjects();
+            instance->createImageViews();
+            instance->createCPUCommandQueue();
+
+            instance->rootRenderContext = RenderContext(
+                instance->swapChainExtent.width, instance->swapChainExtent.height,
+                instance->swapChainImageFormat, instance->depthFormat,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                instance->depthImages, instance->depthImageViews,
+                instance->swapChainImages, instance->swapChainImageViews,
+                &(instance->resizeEventHub), AcquireOffscreenImage, PresentOffscreen);
+            return instance;
+        }
+
+        static bool IsHeadless()
+        {
+            return instance->headless;
+        }
+
         static void Dispose()
         {
             ((CPUCommandQueue *)(instance->commandQueues[CPU_QUEUE].get()))->Stop();
-            instance->cleanupSwapChain();
+            if (instance->headless)
+                instance->cleanupOffscreenTargets();
+            else
+                instance->cleanupSwapChain();
 
             for (VkSemaphore semaphore : instance->renderFinishedSemaphores)
                 vkDestroySemaphore(globalLogicalDevice, semaphore, nullptr);
@@ -131,9 +166,11 @@ namespace vke_render
             vkDestroyCommandPool(globalLogicalDevice, instance->commandPool, nullptr);
             vmaDestroyAllocator(instance->vmaAllocator);
             vkDestroyDevice(globalLogicalDevice, nullptr);
-            vkDestroySurfaceKHR(instance->vkinstance, instance->surface, nullptr);
+            if (!instance->headless)
+                vkDestroySurfaceKHR(instance->vkinstance, instance->surface, nullptr);
             vkDestroyInstance(instance->vkinstance, nullptr);
-            glfwTerminate();
+            if (!instance->headless)
+                glfwTerminate();
         }
 
         static uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
@@ -218,7 +255,7 @@ namespace vke_render
         static void CreateImage(uint32_t width, uint32_t height, VkFormat format,
                                 VkImageTiling tiling, VkImageUsageFlags usage, uint32_t mipLevelCnt,
                                 VkMemoryPropertyFlags properties, VkImage *image,
-                                VmaAllocation *vmaAllocation, VmaAllocationInfo *vmaAllocationInfo)
+                                VmaAllocation *vmaAllocation, VmaAllocationInfo *vmaAllocationInfo, uint32_t arrayLayers = 1)
         {
             VkImageCreateInfo imageInfo{};
             imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -227,7 +264,7 @@ namespace vke_render
             imageInfo.extent.height = height;
             imageInfo.extent.depth = 1;
             imageInfo.mipLevels = mipLevelCnt;
-            imageInfo.arrayLayers = 1;
+            imageInfo.arrayLayers = arrayLayers;
             imageInfo.format = format;
             imageInfo.tiling = tiling;
             imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -524,6 +561,22 @@ namespace vke_render
                 VKE_VK_CHECK(result, "failed to present swap chain image!")
         }
 
+        // the frame's target image is free again once its previous submission completed
+        static uint32_t AcquireOffscreenImage(uint32_t currentFrame)
+        {
+            vkWaitForFences(globalLogicalDevice, 1, &instance->inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+            vkResetFences(globalLogicalDevice, 1, &instance->inFlightFences[currentFrame]);
+            return currentFrame;
+        }
+
+        // nothing is shown, the fence just marks the end of the frame's work on the graphics queue
+        static void PresentOffscreen(uint32_t currentFrame, uint32_t imageIndex)
+        {
+            VkSubmitInfo2 submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+            GetGraphicsQueue()->Submit(1, &submitInfo, instance->inFlightFences[currentFrame]);
+        }
+
         uint32_t imageCnt;
         vke_common::EventHub<RenderContext> resizeEventHub;
         GLFWwindow *window;
@@ -550,11 +603,14 @@ namespace vke_render
         VkImage depthImages[MAX_FRAMES_IN_FLIGHT];
         VmaAllocation depthImageVmaAllocations[MAX_FRAMES_IN_FLIGHT];
         VkImageView depthImageViews[MAX_FRAMES_IN_FLIGHT];
+        // headless only, the offscreen color images stand in for the swapchain's
+        std::vector<VmaAllocation> offscreenImageVmaAllocations;
         RenderContext rootRenderContext;
 
-    private:
-        bool windowResized;
-        bool enableValidationLayers;
+    private:
+        bool windowResized;
+        bool enableValidationLayers;
+        bool headless;
 
         void createInstance();
         void createSurface();
@@ -566,7 +622,10 @@ namespace vke_render
         void createCommandPool();
         void createSyncObjects();
         void createSwapChain();
+        void createDepthImages(VkExtent2D extent);
+        void createOffscreenTargets(uint32_t width, uint32_t height);
         void cleanupSwapChain();
+        void cleanupOffscreenTargets();
         void recreateSwapChain();
         void createImageViews();
         void createCPUCommandQueue();
@@ -2,7 +2,9 @@
 #define GLYPH_MANAGER_H
 
 #include <render/buffer.hpp>
-#include <array>
+#include <ds/dirty_spans.hpp>
+#include <ds/paged_range_storage.hpp>
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <vector>
@@ -20,115 +22,100 @@ namespace vke_render
         glm::uvec4 atlasInfo;
     };
 
-    constexpr uint32_t GLYPHS_PER_BUFFER = 512;
-    constexpr uint32_t MAX_GLYPH_BUFFER_CNT = 16;
-    constexpr uint32_t MAX_GLYPH_CNT = GLYPHS_PER_BUFFER * MAX_GLYPH_BUFFER_CNT;
-    constexpr VkDeviceSize GLYPH_BUFFER_SIZE = sizeof(GlyphInstanceGPU) * GLYPHS_PER_BUFFER;
-    constexpr VkDeviceSize GLYPH_DATA_SIZE = sizeof(GlyphInstanceGPU) * MAX_GLYPH_CNT;
+    constexpr uint32_t GLYPHS_PER_PAGE = 4096;
+    // clean glyphs between two dirty spans that are uploaded anyway to save a copy region
+    constexpr uint32_t GLYPH_UPLOAD_MERGE_GAP = 16;
 
-    inline uint32_t GetGlyphBufferIndex(GlyphID glyphID) { return glyphID >> 9; }
-    inline uint32_t GetGlyphSlotIndex(GlyphID glyphID) { return glyphID & (GLYPHS_PER_BUFFER - 1); }
-    inline VkDeviceSize GetGlyphBufferOffset(uint32_t bufferIndex) { return GLYPH_BUFFER_SIZE * bufferIndex; }
+    // the glyphs of one text, IDs offset to offset + count - 1
+    struct GlyphRange
+    {
+        GlyphID offset = INVALID_GLYPH_ID;
+        uint32_t count = 0;
+    };
 
     struct CPUGlyphData
     {
-        HostCoherentBuffer cpuGlyphs;
-        std::array<uint32_t, MAX_GLYPH_BUFFER_CNT> updateCnts{};
-        std::vector<GlyphID> freeGlyphs;
+        vke_ds::PagedRangeStorage<GlyphInstanceGPU, GLYPHS_PER_PAGE> glyphs;
+        vke_ds::DirtySpans dirtySpans;
 
-        CPUGlyphData()
-            : cpuGlyphs(GLYPH_DATA_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
-        {
-            freeGlyphs.reserve(MAX_GLYPH_CNT);
-            for (uint32_t bufferIndex = MAX_GLYPH_BUFFER_CNT; bufferIndex-- > 0;)
-                for (uint32_t slot = GLYPHS_PER_BUFFER; slot-- > 0;)
-                    freeGlyphs.push_back((bufferIndex << 9) | slot);
-        }
+        CPUGlyphData() : dirtySpans(MAX_FRAMES_IN_FLIGHT) {}
 
-        void Allocate(const std::vector<GlyphInstanceGPU> &glyphs, std::vector<GlyphID> &glyphIDs)
-        {
-            glyphIDs.clear();
-            glyphIDs.reserve(glyphs.size());
-            for (const GlyphInstanceGPU &glyph : glyphs)
-            {
-                GlyphID glyphID = freeGlyphs.back();
-                freeGlyphs.pop_back();
-                const uint32_t bufferIndex = GetGlyphBufferIndex(glyphID);
-                glyphAt(glyphID) = glyph;
-                markDirty(bufferIndex);
-                glyphIDs.push_back(glyphID);
-            }
-        }
-        bool CanAllocate(size_t glyphCount, size_t reclaimCount) const
+        GlyphRange Allocate(const std::vector<GlyphInstanceGPU> &newGlyphs)
         {
-            return glyphCount <= freeGlyphs.size() + reclaimCount;
+            GlyphRange range;
+            if (newGlyphs.empty())
+                return range;
+            range.count = static_cast<uint32_t>(newGlyphs.size());
+            range.offset = glyphs.Alloc(range.count);
+            for (uint32_t i = 0; i < range.count; ++i)
+                glyphs[range.offset + i] = newGlyphs[i];
+            dirtySpans.Mark(range.offset, range.offset + range.count);
+            return range;
         }
         void Update(GlyphID glyphID, const GlyphInstanceGPU &glyph)
         {
-            const uint32_t bufferIndex = GetGlyphBufferIndex(glyphID);
-            glyphAt(glyphID) = glyph;
-            markDirty(bufferIndex);
+            glyphs[glyphID] = glyph;
+            dirtySpans.Mark(glyphID, glyphID + 1);
         }
-        void UpdateColor(GlyphID glyphID, const glm::vec4 &color)
+        // rewrites range with as many new glyphs, marking only the span that actually differs
+        void Update(const GlyphRange &range, const std::vector<GlyphInstanceGPU> &newGlyphs)
         {
-            const uint32_t bufferIndex = GetGlyphBufferIndex(glyphID);
-            glyphAt(glyphID).color = color;
-            markDirty(bufferIndex);
+            uint32_t first = 0, last = range.count;
+            while (first < last && std::memcmp(&glyphs[range.offset + first], &newGlyphs[first], sizeof(GlyphInstanceGPU)) == 0)
+                ++first;
+            while (last > first && std::memcmp(&glyphs[range.offset + last - 1], &newGlyphs[last - 1], sizeof(GlyphInstanceGPU)) == 0)
+                --last;
+            for (uint32_t i = first; i < last; ++i)
+                glyphs[range.offset + i] = newGlyphs[i];
+            dirtySpans.Mark(range.offset + first, range.offset + last);
         }
-        void Release(const std::vector<GlyphID> &glyphIDs)
+        void UpdateColor(const GlyphRange &range, const glm::vec4 &color)
         {
-            for (GlyphID glyphID : glyphIDs)
-                freeGlyphs.push_back(glyphID);
+            for (uint32_t i = 0; i < range.count; ++i)
+                glyphs[range.offset + i].color = color;
+            dirtySpans.Mark(range.offset, range.offset + range.count);
         }
-        void Clear()
+        void Release(GlyphRange &range)
         {
-            updateCnts.fill(MAX_FRAMES_IN_FLIGHT);
-            freeGlyphs.clear();
-            freeGlyphs.reserve(MAX_GLYPH_CNT);
-            for (uint32_t bufferIndex = MAX_GLYPH_BUFFER_CNT; bufferIndex-- > 0;)
-                for (uint32_t slot = GLYPHS_PER_BUFFER; slot-- > 0;)
-                    freeGlyphs.push_back((bufferIndex << 9) | slot);
+            if (range.count > 0)
+                glyphs.Free(range.offset, range.count);
+            range = GlyphRange();
         }
-
-    private:
-        GlyphInstanceGPU &glyphAt(GlyphID glyphID)
+        // every live glyph has to be uploaded again, e.g. after switching scenes
+        void MarkAllDirty()
         {
-            return reinterpret_cast<GlyphInstanceGPU *>(cpuGlyphs.data)[glyphID];
+            dirtySpans.Clear();
+            dirtySpans.Mark(0, glyphs.GetEnd());
         }
-
-        void markDirty(uint32_t bufferIndex)
+        void Clear()
         {
-            updateCnts[bufferIndex] = MAX_FRAMES_IN_FLIGHT;
+            glyphs.Clear();
+            dirtySpans.Clear();
         }
     };
 
+    // Keeps a device copy of the glyph instances per frame in flight. Sync grows it along with the
+    // CPU storage and stages the spans written since that frame's copy was last updated; RecordUpload
+    // then copies all of them in a single transfer ahead of the text draws.
     class GlyphManager
     {
     public:
-        GlyphManager() : cpuGlyphData(std::make_shared<CPUGlyphData>())
-        {
-            for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame)
-                deviceBuffers[frame] = std::make_unique<DeviceBuffer>(GLYPH_DATA_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-        }
+        GlyphManager();
+        GlyphManager(const GlyphManager &) = delete;
+        GlyphManager &operator=(const GlyphManager &) = delete;
+
+        void Sync(uint32_t currentFrame);
+        void RecordUpload(VkCommandBuffer commandBuffer, uint32_t currentFrame);
+        // for frames that end without a Sync: the spans marked since are folded into one span over the
+        // live glyphs, so they stay bounded and a later Sync still uploads everything that changed
+        void SkipSync() { cpuGlyphData->MarkAllDirty(); }
 
-        void Sync(uint32_t currentFrame)
-        {
-            for (uint32_t bufferIndex = 0; bufferIndex < MAX_GLYPH_BUFFER_CNT; ++bufferIndex)
-            {
-                if (cpuGlyphData->updateCnts[bufferIndex] == 0)
-                    continue;
-                --cpuGlyphData->updateCnts[bufferIndex];
-                const VkDeviceSize offset = GetGlyphBufferOffset(bufferIndex);
-                RenderEnvironment::CopyBuffer(cpuGlyphData->cpuGlyphs.buffer, deviceBuffers[currentFrame]->buffer,
-                                              GLYPH_BUFFER_SIZE, offset, offset);
-            }
-        }
         const std::shared_ptr<CPUGlyphData> &GetCPUGlyphData() const { return cpuGlyphData; }
 
         void LoadSceneGlyphData(std::shared_ptr<CPUGlyphData> glyphData)
         {
             cpuGlyphData = glyphData == nullptr ? std::make_shared<CPUGlyphData>() : std::move(glyphData);
-            cpuGlyphData->updateCnts.fill(MAX_FRAMES_IN_FLIGHT);
+            cpuGlyphData->MarkAllDirty();
         }
 
         std::shared_ptr<CPUGlyphData> ToSceneGlyphData() const
@@ -139,21 +126,38 @@ namespace vke_render
         void ClearGlyphs()
         {
             cpuGlyphData = std::make_shared<CPUGlyphData>();
-            cpuGlyphData->updateCnts.fill(MAX_FRAMES_IN_FLIGHT);
         }
 
+        // changes whenever the frame's device buffer is replaced, its descriptors have to be rewritten then
+        uint32_t GetBufferVersion(uint32_t currentFrame) const { return frames[currentFrame].version; }
+
         VkDescriptorBufferInfo GetDescriptorBufferInfo(uint32_t currentFrame) const
         {
             VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = deviceBuffers[currentFrame]->buffer;
+            bufferInfo.buffer = frames[currentFrame].deviceBuffer->buffer;
             bufferInfo.offset = 0;
-            bufferInfo.range = GLYPH_DATA_SIZE;
+            bufferInfo.range = static_cast<VkDeviceSize>(frames[currentFrame].capacity) * sizeof(GlyphInstanceGPU);
             return bufferInfo;
         }
 
     private:
+        struct FrameGlyphBuffers
+        {
+            std::unique_ptr<DeviceBuffer> deviceBuffer;
+            uint32_t capacity = 0;
+            uint32_t version = 0;
+            // dirty spans packed back to back
+            std::unique_ptr<HostCoherentBuffer> stagingBuffer;
+            uint32_t stagingCapacity = 0;
+            std::vector<VkBufferCopy> copies;
+        };
+
         std::shared_ptr<CPUGlyphData> cpuGlyphData;
-        std::unique_ptr<DeviceBuffer> deviceBuffers[MAX_FRAMES_IN_FLIGHT];
+        FrameGlyphBuffers frames[MAX_FRAMES_IN_FLIGHT];
+        std::vector<vke_ds::Span> spans;
+
+        void growDeviceBuffer(FrameGlyphBuffers &frame, uint32_t glyphCnt);
+        void growStagingBuffer(FrameGlyphBuffers &frame, uint32_t glyphCnt);
     };
 }
 
@@ -154,11 +154,15 @@ namespace vke_render
 
         GlyphManager *glyphManager;
         VkDescriptorSet rendererDescriptorSets[MAX_FRAMES_IN_FLIGHT]{};
+        // the glyph buffer each descriptor set points at, see GlyphManager::GetBufferVersion
+        uint32_t glyphBufferVersions[MAX_FRAMES_IN_FLIGHT]{};
         std::shared_ptr<ShaderModuleSet> textShader;
         std::shared_ptr<Material> defaultMaterial;
         std::shared_ptr<vke_common::Font> font;
         std::unique_ptr<HostCoherentBuffer> dynamicAtlasStagingBuffers[MAX_FRAMES_IN_FLIGHT];
         std::unique_ptr<Texture2D> dynamicAtlasTextures[MAX_FRAMES_IN_FLIGHT];
+        std::vector<vke_common::AtlasRegion> dynamicAtlasRegions;
+        std::vector<VkBufferImageCopy> dynamicAtlasCopies;
         GlyphIDVertexBufferPool glyphIDPool;
         std::map<vke_ds::id32_t, UnitState> units;
         std::map<vke_ds::id32_t, std::unique_ptr<Layered2DRenderLayer>> layers;
@@ -168,6 +172,7 @@ namespace vke_render
                                  std::map<std::string, vke_ds::id32_t> &blackboard,
                                  ResourceNodeIDMap &currentResourceNodeID);
         void createDescriptorSets();
+        void writeGlyphBufferDescriptor(uint32_t frame);
         void syncDynamicAtlas(VkCommandBuffer commandBuffer, uint32_t currentFrame);
     };
 }
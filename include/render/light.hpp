@@ -2,6 +2,7 @@
 #define LIGHT_H
 
 #include <render/buffer.hpp>
+#include <ds/handle_map.hpp>
 #include <entt/entity/entity.hpp>
 #include <glm/glm.hpp>
 #include <nlohmann/json.hpp>
@@ -9,7 +10,6 @@
 #include <type_traits>
 #include <memory>
 #include <cstring>
-#include <unordered_map>
 #include <vector>
 
 namespace vke_render
@@ -105,11 +105,17 @@ namespace vke_render
     constexpr uint32_t LIGHT_MAP_ST[] = {0, MAX_DIRECTIONAL_LIGHT_CNT, MAX_DIRECTIONAL_LIGHT_CNT + MAX_POINT_LIGHT_CNT,
                                          MAX_DIRECTIONAL_LIGHT_CNT + MAX_POINT_LIGHT_CNT + MAX_SPOT_LIGHT_CNT};
 
+    // entities are slot index plus version, the light maps are keyed by them as they are
+    inline vke_ds::Handle ToLightKey(entt::entity entity)
+    {
+        return vke_ds::Handle{static_cast<uint32_t>(entt::to_entity(entity)), static_cast<uint32_t>(entt::to_version(entity))};
+    }
+
     struct CPULightData
     {
         std::unique_ptr<HostCoherentBuffer> cpuLightBuffers[(int)LightType::LIGHT_TYPE_CNT];
         uint32_t lightCnts[(int)LightType::LIGHT_TYPE_CNT];
-        std::unordered_map<entt::entity, vke_ds::id32_t> entityToLight[(int)LightType::LIGHT_TYPE_CNT];
+        vke_ds::SparseHandleMap<vke_ds::id32_t> entityToLight[(int)LightType::LIGHT_TYPE_CNT];
         std::vector<entt::entity> ownerMaps[(int)LightType::LIGHT_TYPE_CNT];
 
         CPULightData()
@@ -132,7 +138,7 @@ namespace vke_render
             for (int i = 0; i < (int)LightType::LIGHT_TYPE_CNT; ++i)
             {
                 lightCnts[i] = 0;
-                entityToLight[i].clear();
+                entityToLight[i].Clear();
                 ownerMaps[i].clear();
             }
         }
@@ -141,7 +147,7 @@ namespace vke_render
         bool HasLight(entt::entity entity) const
         {
             const int typecode = (int)T::type;
-            return entityToLight[typecode].find(entity) != entityToLight[typecode].end();
+            return entityToLight[typecode].Contains(ToLightKey(entity));
         }
     };
 
@@ -180,7 +186,7 @@ namespace vke_render
             const int typecode = (int)T::type;
             uint32_t &cnt = cpuLightData->lightCnts[typecode];
             VKE_FATAL_IF(cnt >= MAX_LIGHT_CNTS[typecode], "NO MORE LIGHT OF TYPE {}", typecode)
-            cpuLightData->entityToLight[typecode][entity] = static_cast<vke_ds::id32_t>(cnt);
+            cpuLightData->entityToLight[typecode].Set(ToLightKey(entity), static_cast<vke_ds::id32_t>(cnt));
             cpuLightData->ownerMaps[typecode].push_back(entity);
             std::construct_at(GetLightBuffer<T>() + cnt, light);
             ++cnt;
@@ -196,7 +202,7 @@ namespace vke_render
         const T &GetLightWithoutCheckByEntity(entt::entity entity) const
         {
             const int typecode = (int)T::type;
-            const vke_ds::id32_t id = cpuLightData->entityToLight[typecode].at(entity);
+            const vke_ds::id32_t id = *cpuLightData->entityToLight[typecode].Find(ToLightKey(entity));
             return GetLightBuffer<T>()[id];
         }
     };
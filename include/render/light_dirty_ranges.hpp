@@ -0,0 +1,69 @@
+#ifndef LIGHT_DIRTY_RANGES_H
+#define LIGHT_DIRTY_RANGES_H
+
+#include <ds/dirty_spans.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace vke_render
+{
+    // clean lights between two dirty spans that are written anyway to save a memcpy
+    constexpr uint32_t LIGHT_UPLOAD_MERGE_GAP = 4;
+
+    // The lights of one type each frame in flight still has to write into its copy of the light
+    // buffer, as spans over the dense array. Removal moves the last light into the hole, so the hole
+    // is what changes; the shrunk tail is never read by the shaders and needs no write.
+    class LightDirtyRanges
+    {
+    public:
+        explicit LightDirtyRanges(uint32_t frameCnt) : spans(frameCnt) {}
+
+        void OnAdd(uint32_t id)
+        {
+            spans.Mark(id, id + 1);
+        }
+
+        // id was removed from cnt lights, cnt counted before the removal
+        void OnRemove(uint32_t id, uint32_t cnt)
+        {
+            if (id + 1 < cnt)
+                spans.Mark(id, id + 1);
+        }
+
+        void OnChange(uint32_t id)
+        {
+            spans.Mark(id, id + 1);
+        }
+
+        void OnChangeAll(uint32_t cnt)
+        {
+            spans.Mark(0, cnt);
+        }
+
+        // the lights were replaced wholesale, e.g. by a scene load
+        void Reset(uint32_t cnt)
+        {
+            spans.Clear();
+            spans.Mark(0, cnt);
+        }
+
+        bool IsDirty(uint32_t frame) const { return spans.IsDirty(frame); }
+
+        // the spans frame has to write, clipped to the cnt live lights; frame counts as clean afterwards
+        void Take(uint32_t frame, uint32_t cnt, std::vector<vke_ds::Span> &out)
+        {
+            spans.Take(frame, out, LIGHT_UPLOAD_MERGE_GAP);
+            auto last = std::remove_if(out.begin(), out.end(), [cnt](vke_ds::Span &span)
+                                       {
+                                           span.end = std::min(span.end, cnt);
+                                           return span.end <= span.begin; });
+            out.erase(last, out.end());
+        }
+
+    private:
+        vke_ds::DirtySpans spans;
+    };
+}
+
+#endif
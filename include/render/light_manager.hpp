@@ -2,6 +2,7 @@
 #define LIGHT_MANAGER_H
 
 #include <render/light.hpp>
+#include <render/light_dirty_ranges.hpp>
 #include <render/descriptor.hpp>
 #include <render/pipeline.hpp>
 #include <render/frame_graph.hpp>
@@ -36,6 +37,13 @@ namespace vke_render
                                  ResourceNodeIDMap &currentResourceNodeID);
 
         void Update(uint32_t currentFrame, bool cameraUpdated);
+        // for frames that end without an Update: every type's pending spans are folded into one span over
+        // its live lights, so they stay bounded and the next Update still uploads everything that changed
+        void SkipUpdate()
+        {
+            for (int i = 0; i < (int)LightType::LIGHT_TYPE_CNT; ++i)
+                dirtyRanges[i].Reset(cpuLightData->lightCnts[i]);
+        }
 
         void SetGlobalDescriptorSets(VkDescriptorSet *descriptorSet)
         {
@@ -60,13 +68,14 @@ namespace vke_render
             cpuLightData->ownerMaps[typecode].push_back(entity);
             std::construct_at(reinterpret_cast<T *>(cpuLightData->cpuLightBuffers[typecode]->data) + id, std::forward<Args>(args)...);
 
-            cpuLightData->entityToLight[typecode][entity] = id;
+            cpuLightData->entityToLight[typecode].Set(ToLightKey(entity), id);
             if constexpr (std::same_as<T, SpotLight>)
             {
                 SpotLight &light = GetLightWithoutCheckByID(id);
                 if (light.CastShadow())
                     shadowManager->ActivateSpotShadow(entity, light);
             }
+            dirtyRanges[typecode].OnAdd(id);
             dirtyFlags[typecode] = true;
         }
 
@@ -80,7 +89,7 @@ namespace vke_render
         T &GetLightWithoutCheckByEntity(entt::entity entity)
         {
             const int typecode = (int)T::type;
-            vke_ds::id32_t id = cpuLightData->entityToLight[typecode].find(entity)->second;
+            vke_ds::id32_t id = *cpuLightData->entityToLight[typecode].Find(ToLightKey(entity));
             return reinterpret_cast<T *>(cpuLightData->cpuLightBuffers[typecode]->data)[id];
         }
 
@@ -88,7 +97,7 @@ namespace vke_render
         const T &GetLightWithoutCheckByEntity(entt::entity entity) const
         {
             const int typecode = (int)T::type;
-            vke_ds::id32_t id = cpuLightData->entityToLight[typecode].find(entity)->second;
+            vke_ds::id32_t id = *cpuLightData->entityToLight[typecode].Find(ToLightKey(entity));
             return reinterpret_cast<const T *>(cpuLightData->cpuLightBuffers[typecode]->data)[id];
         }
 
@@ -111,10 +120,10 @@ namespace vke_render
         {
             const int typecode = (int)T::type;
             auto &lightMap = cpuLightData->entityToLight[typecode];
-            auto it = lightMap.find(entity);
-            if (it == lightMap.end())
+            const vke_ds::id32_t *found = lightMap.Find(ToLightKey(entity));
+            if (found == nullptr)
                 return;
-            vke_ds::id32_t id = it->second;
+            vke_ds::id32_t id = *found;
 
             if constexpr (std::same_as<T, SpotLight>)
             {
@@ -125,6 +134,7 @@ namespace vke_render
             uint32_t &cnt = cpuLightData->lightCnts[typecode];
             VKE_FATAL_IF(id >= cnt, "LIGHT NOT EXIST")
 
+            dirtyRanges[typecode].OnRemove(id, cnt);
             const uint32_t last = cnt - 1;
             if (id != last)
             {
@@ -134,12 +144,24 @@ namespace vke_render
 
                 entt::entity swappedOwner = cpuLightData->ownerMaps[typecode][last];
                 cpuLightData->ownerMaps[typecode][id] = swappedOwner;
-                lightMap[swappedOwner] = id;
+                lightMap.Set(ToLightKey(swappedOwner), id);
             }
 
             cpuLightData->ownerMaps[typecode].pop_back();
             --cnt;
-            lightMap.erase(it);
+            lightMap.Erase(ToLightKey(entity));
+            dirtyFlags[typecode] = true;
+        }
+
+        // the light of entity was changed in place
+        template <AllowedLightType T>
+        void MarkDirty(entt::entity entity)
+        {
+            const int typecode = (int)T::type;
+            const vke_ds::id32_t *id = cpuLightData->entityToLight[typecode].Find(ToLightKey(entity));
+            if (id == nullptr)
+                return;
+            dirtyRanges[typecode].OnChange(*id);
             dirtyFlags[typecode] = true;
         }
 
@@ -147,6 +169,7 @@ namespace vke_render
         void MarkDirty()
         {
             const int typecode = (int)T::type;
+            dirtyRanges[typecode].OnChangeAll(cpuLightData->lightCnts[typecode]);
             dirtyFlags[typecode] = true;
         }
 
@@ -157,12 +180,17 @@ namespace vke_render
         void DeactivateSpotShadow(entt::entity entity);
 
     private:
+        // something of the type changed since the last Update, the directional shadow follows the sun
         bool dirtyFlags[(int)LightType::LIGHT_TYPE_CNT];
-        uint32_t lightUpdateCnts[(int)LightType::LIGHT_TYPE_CNT];
+        std::vector<LightDirtyRanges> dirtyRanges;
+        std::vector<vke_ds::Span> uploadSpans;
+        // frames whose copy of the directional shadow info is older than the sun
+        uint32_t directionalShadowSyncCnt;
         VkDescriptorSet *globalDescriptorSets;
         std::shared_ptr<CPULightData> cpuLightData;
 
-        std::unique_ptr<DeviceBuffer> lightBuffers[(int)LightType::LIGHT_TYPE_CNT][MAX_FRAMES_IN_FLIGHT];
+        // persistently mapped, Update writes a frame's copy once its fence has been waited on
+        std::unique_ptr<HostCoherentBuffer> lightBuffers[(int)LightType::LIGHT_TYPE_CNT][MAX_FRAMES_IN_FLIGHT];
         std::unique_ptr<DeviceBuffer> clusterBuffers[2][MAX_FRAMES_IN_FLIGHT];
         std::unique_ptr<ComputePipeline> lightCullingTask;
         std::unique_ptr<ShadowManager> shadowManager;
@@ -10,6 +10,9 @@
 
 namespace vke_render
 {
+    // storage so skinning.comp can read skinned meshes' vertices directly
+    const VkBufferUsageFlags MESH_VERTEX_BUFFER_USAGE = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
     struct Vertex
     {
         glm::vec3 pos;
@@ -69,7 +72,7 @@ namespace vke_render
 
         Mesh(const vke_common::AssetHandle hdl, const CPUBuffer<> &vbuffer, const CPUBuffer<> &ibuffer, std::vector<MeshInfo> &&infos)
             : handle(hdl),
-              vertexBuffer(std::make_unique<DeviceBuffer>(vbuffer.size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)),
+              vertexBuffer(std::make_unique<DeviceBuffer>(vbuffer.size, MESH_VERTEX_BUFFER_USAGE)),
               indexBuffer(std::make_unique<DeviceBuffer>(ibuffer.size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT)),
               infos(std::move(infos))
         {
@@ -80,7 +83,7 @@ namespace vke_render
         template <typename VT, AllowedIndexType IT>
         Mesh(const vke_common::AssetHandle hdl, const std::span<const VT> vertices, const std::span<const IT> indices, std::vector<MeshInfo> &&infos)
             : handle(hdl),
-              vertexBuffer(std::make_unique<DeviceBuffer>(vertices.size_bytes(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)),
+              vertexBuffer(std::make_unique<DeviceBuffer>(vertices.size_bytes(), MESH_VERTEX_BUFFER_USAGE)),
               indexBuffer(std::make_unique<DeviceBuffer>(indices.size_bytes(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT)),
               infos(std::move(infos))
         {
@@ -91,7 +94,7 @@ namespace vke_render
         template <typename VT, AllowedIndexType IT>
         Mesh(const vke_common::AssetHandle hdl, const std::span<const VT> vertices, const std::span<const IT> indices)
             : handle(hdl),
-              vertexBuffer(std::make_unique<DeviceBuffer>(vertices.size_bytes(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)),
+              vertexBuffer(std::make_unique<DeviceBuffer>(vertices.size_bytes(), MESH_VERTEX_BUFFER_USAGE)),
               indexBuffer(std::make_unique<DeviceBuffer>(indices.size_bytes(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
         {
             vertexBuffer->ToBuffer(0, vertices.data(), vertices.size_bytes());
@@ -109,7 +112,7 @@ namespace vke_render
             binary.read((char *)&vsize, sizeof(uint64_t));
             CPUBuffer<> vertices(vsize);
             binary.read((char *)(vertices.data), vsize);
-            vertexBuffer = std::make_unique<DeviceBuffer>(vsize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+            vertexBuffer = std::make_unique<DeviceBuffer>(vsize, MESH_VERTEX_BUFFER_USAGE);
             vertexBuffer->ToBuffer(0, vertices.data, vsize);
             uint64_t isize;
             binary.read((char *)&isize, sizeof(uint64_t));
@@ -139,10 +142,10 @@ namespace vke_render
 
         ~Mesh() {}
 
-        void Render(VkCommandBuffer &commandBuffer) const
+        // vertices replaces the mesh's vertex buffer, e.g. with compute skinned output in the same vertex order
+        void Render(VkCommandBuffer &commandBuffer, VkBuffer vertices = VK_NULL_HANDLE, VkDeviceSize verticesOffset = 0) const
         {
-            VkDeviceSize offset = 0;
-            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &(vertexBuffer->buffer), &offset);
+            bindVertexBuffer(commandBuffer, vertices, verticesOffset);
 
             VkIndexType prevIndexType = VK_INDEX_TYPE_MAX_ENUM;
             for (auto &info : infos)
@@ -160,13 +163,11 @@ namespace vke_render
             }
         }
 
-        void RenderPrimitive(VkCommandBuffer &commandBuffer, uint32_t idx, VkIndexType &prevIndexType) const
+        void RenderPrimitive(VkCommandBuffer &commandBuffer, uint32_t idx, VkIndexType &prevIndexType,
+                             VkBuffer vertices = VK_NULL_HANDLE, VkDeviceSize verticesOffset = 0) const
         {
             if (idx == 0)
-            {
-                VkDeviceSize offset = 0;
-                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &(vertexBuffer->buffer), &offset);
-            }
+                bindVertexBuffer(commandBuffer, vertices, verticesOffset);
             auto &info = infos[idx];
             VkIndexType indexType = getIndexType(info);
             if (indexType != prevIndexType)
@@ -217,6 +218,16 @@ namespace vke_render
         }
 
     private:
+        void bindVertexBuffer(VkCommandBuffer &commandBuffer, VkBuffer vertices, VkDeviceSize verticesOffset) const
+        {
+            if (vertices == VK_NULL_HANDLE)
+            {
+                vertices = vertexBuffer->buffer;
+                verticesOffset = 0;
+            }
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertices, &verticesOffset);
+        }
+
         VkIndexType getIndexType(const MeshInfo &info) const
         {
             if (info.getIndexUnitSize() == 2)
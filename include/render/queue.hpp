@@ -2,6 +2,10 @@
 #define QUEUE_H
 
 #include <render/render_common.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <optional>
 #include <vector>
 #include <set>
@@ -80,95 +84,140 @@ namespace vke_render
         }
     };
 
+    // How the CPU queue waits on and signals timeline semaphores. The engine uses the Vulkan one,
+    // tests use MockSemaphoreBackend to run the queue without a device.
+    class SemaphoreBackend
+    {
+    public:
+        virtual ~SemaphoreBackend() {}
+        // blocks until any semaphores[i] reached values[i], false when timeoutNs passed first
+        virtual bool WaitAny(uint32_t semaphoreCnt, const VkSemaphore *semaphores, const uint64_t *values, uint64_t timeoutNs) = 0;
+        virtual uint64_t GetValue(VkSemaphore semaphore) = 0;
+        virtual void Signal(VkSemaphore semaphore, uint64_t value) = 0;
+        virtual VkSemaphore CreateTimelineSemaphore(uint64_t initialValue) = 0;
+        virtual void DestroySemaphore(VkSemaphore semaphore) = 0;
+    };
+
+    class VulkanSemaphoreBackend : public SemaphoreBackend
+    {
+    public:
+        explicit VulkanSemaphoreBackend(VkDevice device) : device(device) {}
+
+        virtual bool WaitAny(uint32_t semaphoreCnt, const VkSemaphore *semaphores, const uint64_t *values, uint64_t timeoutNs) override;
+        virtual uint64_t GetValue(VkSemaphore semaphore) override;
+        virtual void Signal(VkSemaphore semaphore, uint64_t value) override;
+        virtual VkSemaphore CreateTimelineSemaphore(uint64_t initialValue) override;
+        virtual void DestroySemaphore(VkSemaphore semaphore) override;
+
+    private:
+        VkDevice device;
+    };
+
+    // Timeline semaphores in memory, the handles are only keys. Counts waits so tests can tell
+    // blocking from polling.
+    class MockSemaphoreBackend : public SemaphoreBackend
+    {
+    public:
+        MockSemaphoreBackend() : nextHandle(1), waitCnt(0) {}
+
+        virtual bool WaitAny(uint32_t semaphoreCnt, const VkSemaphore *semaphores, const uint64_t *values, uint64_t timeoutNs) override;
+        virtual uint64_t GetValue(VkSemaphore semaphore) override;
+        virtual void Signal(VkSemaphore semaphore, uint64_t value) override;
+        virtual VkSemaphore CreateTimelineSemaphore(uint64_t initialValue) override;
+        virtual void DestroySemaphore(VkSemaphore semaphore) override;
+
+        uint64_t GetWaitCount() const { return waitCnt.load(std::memory_order_relaxed); }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::map<VkSemaphore, uint64_t> values;
+        uintptr_t nextHandle;
+        std::atomic<uint64_t> waitCnt;
+
+        bool anyReached(uint32_t semaphoreCnt, const VkSemaphore *semaphores, const uint64_t *values);
+    };
+
+    // Runs CPU tasks of the frame graph. A submit's command buffer is a std::function<void()> *,
+    // its fence a std::atomic<bool> * set once every submit of the call finished. One thread blocks
+    // on the semaphores the pending submits wait for, together with a wake-up semaphore that Submit
+    // signals, and hands submits whose waits are all met to a pool of callback threads. Submits
+    // that became ready together run in parallel, dependent ones are ordered by their semaphores.
     class CPUCommandQueue : public CommandQueue
     {
     public:
-        const uint64_t CPU_QUEUE_WAIT_TIMEOUT = 50000; // ns
-        CPUCommandQueue() : running(false), idle(true) {}
-        CPUCommandQueue(VkDevice device) : running(false), idle(true), device(device) {}
+        static constexpr uint32_t DEFAULT_CALLBACK_THREAD_CNT = 2;
+
+        explicit CPUCommandQueue(VkDevice device, uint32_t callbackThreadCnt = DEFAULT_CALLBACK_THREAD_CNT)
+            : CPUCommandQueue(std::make_unique<VulkanSemaphoreBackend>(device), callbackThreadCnt) {}
+        CPUCommandQueue(std::unique_ptr<SemaphoreBackend> &&backend, uint32_t callbackThreadCnt)
+            : backend(std::move(backend)), callbackThreadCnt(std::max(callbackThreadCnt, 1u)), running(false),
+              inFlightCnt(0), wakeSemaphore(VK_NULL_HANDLE), wakeValue(0) {}
+        ~CPUCommandQueue() { Stop(); }
 
         virtual void Submit(uint32_t submitCount, const VkSubmitInfo2 *pSubmits, VkFence fence) override;
 
-        void Start()
-        {
-            bool r = false;
-            if (running.compare_exchange_strong(r, true))
-                worker = std::thread(&CPUCommandQueue::process, this);
-        }
+        void Start();
 
-        void Stop()
-        {
-            bool r = true;
-            if (running.compare_exchange_strong(r, false))
-            {
-                queueCV.notify_one();
-                if (worker.joinable())
-                    worker.join();
-            }
-        }
+        // submits still waiting are dropped
+        void Stop();
 
         void WaitIdle()
         {
-            idle.wait(false);
+            for (uint32_t cnt = inFlightCnt.load(); cnt != 0; cnt = inFlightCnt.load())
+                inFlightCnt.wait(cnt);
         }
 
+        SemaphoreBackend *GetBackend() { return backend.get(); }
+
     private:
-        struct SubmitInfo
+        struct Submission
         {
-            std::vector<VkSemaphoreSubmitInfo> signalSemaphoreInfos;
             std::function<void()> *callback;
-
-            SubmitInfo() {}
-            SubmitInfo(uint32_t semaphoreCnt, std::function<void()> *callback)
-                : signalSemaphoreInfos(semaphoreCnt), callback(callback) {}
-
-            SubmitInfo &operator=(SubmitInfo &&ano)
-            {
-                if (this != &ano)
-                {
-                    signalSemaphoreInfos = std::move(ano.signalSemaphoreInfos);
-                    callback = ano.callback;
-                    ano.callback = nullptr;
-                }
-                return *this;
-            }
-
-            SubmitInfo(SubmitInfo &&ano)
-                : signalSemaphoreInfos(std::move(ano.signalSemaphoreInfos)),
-                  callback(ano.callback)
-            {
-                ano.callback = nullptr;
-            }
+            std::vector<VkSemaphoreSubmitInfo> signalSemaphoreInfos;
+            std::atomic<bool> *fence;
+            // the submits of one Submit call left to finish, shared by them
+            std::shared_ptr<std::atomic<uint32_t>> fenceCnt;
+            uint32_t remainingWaitCnt;
         };
 
-        struct WaitInfo
+        // sorted by semaphore, then value, so every semaphore's smallest pending value comes first
+        struct PendingWait
         {
+            VkSemaphore semaphore;
             uint64_t value;
-            std::shared_ptr<uint32_t> counter;
-            std::function<void()> callback;
+            Submission *submission;
 
-            WaitInfo() {}
-            WaitInfo(uint64_t value) : value(value) {}
-            WaitInfo(uint64_t value, std::shared_ptr<uint32_t> &counter, std::function<void()> callback = nullptr)
-                : value(value), counter(counter), callback(callback) {}
-
-            bool operator<(const WaitInfo &ano) const
+            bool operator<(const PendingWait &ano) const
             {
-                return value < ano.value;
+                return semaphore != ano.semaphore ? semaphore < ano.semaphore : value < ano.value;
             }
         };
 
-        VkDevice device;
+        std::unique_ptr<SemaphoreBackend> backend;
+        uint32_t callbackThreadCnt;
         std::atomic<bool> running;
-        std::atomic<bool> idle;
-        std::mutex queueMutex;
-        std::condition_variable queueCV;
-        std::thread worker;
+        std::atomic<uint32_t> inFlightCnt;
 
-        std::map<VkSemaphore, std::multiset<WaitInfo>> waitInfoMap;
-        std::vector<SubmitInfo> submitInfos;
-
-        void process();
+        std::mutex queueMutex;
+        VkSemaphore wakeSemaphore;
+        uint64_t wakeValue;
+        std::vector<PendingWait> waitList;
+        // every submission ever allocated, reused through freeSubmissions
+        std::vector<std::unique_ptr<Submission>> submissions;
+        std::vector<Submission *> freeSubmissions;
+        std::thread waiter;
+
+        std::mutex readyMutex;
+        std::condition_variable readyCondition;
+        std::deque<Submission *> readySubmissions;
+        std::vector<std::thread> callbackThreads;
+
+        Submission *allocateSubmission();
+        void makeReady(std::vector<Submission *> &submissions);
+        void waitLoop();
+        void callbackLoop();
+        void run(Submission *submission);
     };
 }
 
@@ -14,7 +14,9 @@
 #include <render/hdr_color.hpp>
 #include <render/layered_2d.hpp>
 #include <render/light_manager.hpp>
+#include <render/compute_skinning.hpp>
 #include <render/camera.hpp>
+#include <ds/handle_map.hpp>
 #include <event.hpp>
 
 namespace vke_render
@@ -27,7 +29,7 @@ namespace vke_render
     private:
         static Renderer *instance;
         Renderer()
-            : cameraIDAllocator(1), currentCamera(1), cameraInfoUpdateCnt(0) {};
+            : currentCamera(vke_ds::INVALID_HANDLE_ID), cameraInfoUpdateCnt(0) {};
         ~Renderer() {}
 
     public:
@@ -35,7 +37,7 @@ namespace vke_render
         uint32_t currentFrame;
         uint32_t passcnt;
 
-        vke_ds::id32_t currentCamera;
+        vke_ds::id64_t currentCamera;
         std::unique_ptr<LightManager> lightManager;
         vke_common::EventHub<glm::vec2> resizeEventHub;
 
@@ -77,6 +79,12 @@ namespace vke_render
                 renderConfig.atmosphere);
             instance->skyboxManager->ConstructFrameGraph(*(instance->frameGraph), instance->blackboard, instance->currentResourceNodeID);
             instance->lightManager->ConstructFrameGraph(*(instance->frameGraph), instance->blackboard, instance->currentResourceNodeID);
+            if (renderConfig.computeSkinning)
+            {
+                // before the passes, which wait on its output when it is on the blackboard
+                instance->computeSkinningManager = std::make_unique<ComputeSkinningManager>();
+                instance->computeSkinningManager->ConstructFrameGraph(*(instance->frameGraph), instance->blackboard, instance->currentResourceNodeID);
+            }
 
             int customPassID = 0;
             for (int i = 0; i < passes.size(); i++)
@@ -224,31 +232,33 @@ namespace vke_render
             delete instance;
         }
 
-        static vke_ds::id32_t RegisterCamera(std::function<void()> callback)
+        // the first camera registered while none is current becomes current
+        static vke_ds::id64_t RegisterCamera(std::function<void()> callback)
         {
-            vke_ds::id32_t ret = instance->cameraIDAllocator.Alloc();
-            instance->cameras[ret] = callback;
-            if (ret == instance->currentCamera)
-                callback();
+            vke_ds::id64_t ret = instance->cameras.Insert(std::move(callback)).ToID();
+            if (!instance->cameras.Contains(vke_ds::Handle::FromID(instance->currentCamera)))
+                SetCurrentCamera(ret);
             return ret;
         }
 
-        static void RemoveCamera(vke_ds::id32_t id)
+        // removing the current camera hands over to any camera left
+        static void RemoveCamera(vke_ds::id64_t id)
         {
-            instance->cameras.erase(id);
-            if (instance->cameras.size() > 0)
-                SetCurrentCamera(0);
+            if (!instance->cameras.Erase(vke_ds::Handle::FromID(id)))
+                return;
+            if (id == instance->currentCamera && !instance->cameras.Empty())
+                SetCurrentCamera(instance->cameras.HandleAt(0).ToID());
         }
 
-        static void SetCurrentCamera(vke_ds::id32_t id)
+        static void SetCurrentCamera(vke_ds::id64_t id)
         {
             if (id != instance->currentCamera)
             {
-                auto it = instance->cameras.find(id);
-                if (it != instance->cameras.end())
+                std::function<void()> *callback = instance->cameras.Find(vke_ds::Handle::FromID(id));
+                if (callback != nullptr)
                 {
                     instance->currentCamera = id;
-                    it->second();
+                    (*callback)();
                 }
             }
         }
@@ -259,6 +269,11 @@ namespace vke_render
             instance->cameraInfoUpdateCnt = 2;
         }
 
+        static const CameraInfo &GetCameraInfo()
+        {
+            return instance->hostCameraInfo;
+        }
+
         static void AddRenderUpdateCallback(vke_ds::id64_t id, std::function<void(uint32_t)> callback)
         {
             instance->renderUpdateCallbacks[id] = callback;
@@ -303,6 +318,12 @@ namespace vke_render
             return &instance->glyphManager;
         }
 
+        // nullptr unless RenderConfig::computeSkinning is set
+        static ComputeSkinningManager *GetComputeSkinningManager()
+        {
+            return instance->computeSkinningManager.get();
+        }
+
         static void OnWindowResize(void *listener, RenderContext *ctx)
         {
             instance->recreate(ctx);
@@ -314,6 +335,8 @@ namespace vke_render
         }
 
         void Update();
+        // logic only headless runs: the per-frame update callbacks still run, nothing is recorded or submitted
+        void UpdateWithoutRendering();
 
     private:
         vke_ds::id32_t colorAttachmentResourceID;
@@ -325,6 +348,7 @@ namespace vke_render
         std::unique_ptr<FrameGraph> frameGraph;
         std::unique_ptr<SkyboxManager> skyboxManager;
         std::unique_ptr<HDRColorManager> hdrColorManager;
+        std::unique_ptr<ComputeSkinningManager> computeSkinningManager;
         GlyphManager glyphManager;
         std::map<std::string, vke_ds::id32_t> blackboard;
         ResourceNodeIDMap currentResourceNodeID;
@@ -332,8 +356,7 @@ namespace vke_render
         uint32_t cameraInfoUpdateCnt;
         CameraInfo hostCameraInfo;
         std::vector<vke_render::HostCoherentBuffer> camInfoBuffers;
-        vke_ds::NaiveIDAllocator<vke_ds::id32_t> cameraIDAllocator;
-        std::unordered_map<vke_ds::id32_t, std::function<void()>> cameras;
+        vke_ds::HandleMap<std::function<void()>> cameras;
 
         std::unordered_map<vke_ds::id64_t, std::function<void(uint32_t)>> renderUpdateCallbacks;
 
@@ -160,6 +160,10 @@ namespace vke_render
     struct SpotShadowConfig
     {
         uint32_t mapSize = 1024;
+        // slots redrawn per frame on top of the ones never drawn, see SpotShadowSchedule
+        uint32_t refreshBudget = 4;
+        // frames between two redraws of a slot that only dynamic casters changed
+        uint32_t dynamicRefreshInterval = 2;
     };
 
     struct RenderConfig
@@ -169,6 +173,8 @@ namespace vke_render
         SSAOConfig ssao;
         DirectionalShadowConfig directionalShadow;
         AtmosphereParameter atmosphere;
+        // skin in a compute task and draw the output as static geometry, instead of in the vertex shaders
+        bool computeSkinning = false;
         nlohmann::json sourceJSON = nlohmann::json::object();
 
         RenderConfig() = default;
@@ -188,6 +194,7 @@ namespace vke_render
             ssao.LoadJSON(json.value("ssao", nlohmann::json::object()));
             directionalShadow.LoadJSON(json.value("directionalShadow", nlohmann::json::object()));
             atmosphere.LoadJSON(json.value("atmosphere", nlohmann::json::object()));
+            computeSkinning = json.value("computeSkinning", computeSkinning);
         }
     };
 }
@@ -15,17 +15,23 @@ namespace vke_render
         uint32_t perPrimitiveStart;
         VkDescriptorSet perUnitDescriptorSet;
         const glm::mat4 *modelMatrix;
+        // set by the ComputeSkinningManager, drawn instead of the mesh's own vertex buffer
+        VkBuffer vertexBufferOverride;
+        VkDeviceSize vertexBufferOverrideOffset;
 
-        RenderUnit() : perPrimitiveStart(0), perUnitDescriptorSet(nullptr), modelMatrix(nullptr) {}
+        RenderUnit() : perPrimitiveStart(0), perUnitDescriptorSet(nullptr), modelMatrix(nullptr),
+                       vertexBufferOverride(VK_NULL_HANDLE), vertexBufferOverrideOffset(0) {}
 
         RenderUnit(std::shared_ptr<const Mesh> &msh, const void *pValues, uint32_t constantSize, VkDescriptorSet descriptorSet = nullptr, bool constantIsFloat = true)
             : mesh(msh), pushConstantInfos(1, PushConstantInfo(constantSize, pValues, constantIsFloat)),
               perPrimitiveStart(1), perUnitDescriptorSet(descriptorSet),
-              modelMatrix(constantSize == sizeof(glm::mat4) ? static_cast<const glm::mat4 *>(pValues) : nullptr) {}
+              modelMatrix(constantSize == sizeof(glm::mat4) ? static_cast<const glm::mat4 *>(pValues) : nullptr),
+              vertexBufferOverride(VK_NULL_HANDLE), vertexBufferOverrideOffset(0) {}
 
         RenderUnit(std::shared_ptr<const Mesh> &msh, std::vector<PushConstantInfo> &&cInfos, uint32_t perPrimitiveStart, VkDescriptorSet descriptorSet = nullptr)
             : mesh(msh), pushConstantInfos(std::move(cInfos)), perPrimitiveStart(std::min(perPrimitiveStart, (uint32_t)pushConstantInfos.size())),
-              perUnitDescriptorSet(descriptorSet), modelMatrix(nullptr)
+              perUnitDescriptorSet(descriptorSet), modelMatrix(nullptr),
+              vertexBufferOverride(VK_NULL_HANDLE), vertexBufferOverrideOffset(0)
         {
             if (!pushConstantInfos.empty() && pushConstantInfos[0].offset == 0 && pushConstantInfos[0].size == sizeof(glm::mat4))
                 modelMatrix = static_cast<const glm::mat4 *>(pushConstantInfos[0].pValues);
@@ -59,7 +65,7 @@ namespace vke_render
                     auto &info = pushConstantInfos[i];
                     vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_ALL, info.offset, info.size, info.pValues);
                 }
-                mesh->Render(commandBuffer);
+                mesh->Render(commandBuffer, vertexBufferOverride, vertexBufferOverrideOffset);
                 return;
             }
 
@@ -73,7 +79,7 @@ namespace vke_render
                     vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_ALL, info.offset, info.size,
                                        ((char *)info.pValues) + i * info.size);
                 }
-                mesh->RenderPrimitive(commandBuffer, i, prevIndexType);
+                mesh->RenderPrimitive(commandBuffer, i, prevIndexType, vertexBufferOverride, vertexBufferOverrideOffset);
             }
         }
     };
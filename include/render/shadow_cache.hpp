@@ -0,0 +1,189 @@
+#ifndef SHADOW_CACHE_H
+#define SHADOW_CACHE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace vke_render
+{
+    // the light view projection a shadow view is drawn with, column major; for a cascade it follows the
+    // light direction, the snapped center and the stable radius
+    using ShadowViewKey = std::array<float, 16>;
+
+    enum class ShadowCacheAction
+    {
+        // copy the cached static depth into the view, then draw the dynamic casters on top
+        REUSE,
+        // draw the static casters into the cache first, then reuse it
+        REDRAW,
+        // the key keeps changing, a cache would not be reused: draw every caster straight into the view
+        BYPASS
+    };
+
+    struct ShadowCacheStats
+    {
+        uint64_t reuseCnt = 0;
+        uint64_t redrawCnt = 0;
+        uint64_t bypassCnt = 0;
+    };
+
+    // Which shadow views, cascades or spot slots, hold valid static-only depth. A view's cache is
+    // dropped when its key changes or a static caster is added, removed or moved. A view whose key
+    // changed twice in a row, e.g. a cascade following a moving camera, skips the cache until its key
+    // holds still for one draw.
+    class ShadowCache
+    {
+    public:
+        explicit ShadowCache(uint32_t viewCnt) : views(viewCnt) {}
+
+        // the key the view is drawn with from now on
+        void SetKey(uint32_t view, const ShadowViewKey &key)
+        {
+            View &v = views[view];
+            if (v.hasKey && v.key == key)
+                return;
+            v.key = key;
+            v.hasKey = true;
+            v.valid = false;
+            if (!v.keyChanged)
+                ++v.changeStreak;
+            v.keyChanged = true;
+        }
+
+        void Invalidate(uint32_t view)
+        {
+            views[view].valid = false;
+        }
+
+        void InvalidateAll()
+        {
+            for (View &v : views)
+                v.valid = false;
+        }
+
+        // what drawing the view takes this time; after REDRAW the cache counts as valid
+        ShadowCacheAction BeginDraw(uint32_t view)
+        {
+            View &v = views[view];
+            if (!v.keyChanged)
+                v.changeStreak = 0;
+            v.keyChanged = false;
+
+            if (v.valid)
+            {
+                ++stats.reuseCnt;
+                return ShadowCacheAction::REUSE;
+            }
+            if (v.changeStreak >= 2)
+            {
+                ++stats.bypassCnt;
+                return ShadowCacheAction::BYPASS;
+            }
+            v.valid = true;
+            ++stats.redrawCnt;
+            return ShadowCacheAction::REDRAW;
+        }
+
+        bool IsValid(uint32_t view) const { return views[view].valid; }
+        const ShadowCacheStats &GetStats() const { return stats; }
+
+    private:
+        struct View
+        {
+            ShadowViewKey key{};
+            bool hasKey = false;
+            bool valid = false;
+            // whether SetKey changed the key since the last BeginDraw
+            bool keyChanged = false;
+            // draws in a row that came with a new key
+            uint32_t changeStreak = 0;
+        };
+
+        std::vector<View> views;
+        ShadowCacheStats stats;
+    };
+
+    // Picks the spot shadow slots redrawn in a frame; the others keep their map and the view projection
+    // it was drawn with. A slot that was never drawn is always picked. Within a per frame budget,
+    // slots whose light moved or whose static casters changed come first, then, while dynamic casters
+    // exist, slots last drawn refreshInterval or more frames ago, oldest first.
+    class SpotShadowSchedule
+    {
+    public:
+        explicit SpotShadowSchedule(uint32_t slotCnt) : slots(slotCnt) {}
+
+        void Activate(uint32_t slot)
+        {
+            slots[slot] = Slot{true, true, false, 0};
+        }
+
+        void Deactivate(uint32_t slot)
+        {
+            slots[slot] = Slot{};
+        }
+
+        void MarkStale(uint32_t slot)
+        {
+            if (slots[slot].active)
+                slots[slot].stale = true;
+        }
+
+        void MarkAllStale()
+        {
+            for (Slot &slot : slots)
+                slot.stale = slot.active;
+        }
+
+        bool IsActive(uint32_t slot) const { return slots[slot].active; }
+
+        // the picked slots in ascending order; they count as drawn in frame
+        void Pick(uint64_t frame, uint32_t budget, uint32_t refreshInterval, bool hasDynamicCasters, std::vector<uint32_t> &picked)
+        {
+            picked.clear();
+            candidates.clear();
+            for (uint32_t i = 0; i < slots.size(); ++i)
+            {
+                const Slot &slot = slots[i];
+                if (!slot.active)
+                    continue;
+                if (slot.undrawn)
+                    picked.push_back(i);
+                else if (slot.stale || (hasDynamicCasters && frame - slot.lastDrawFrame >= refreshInterval))
+                    candidates.push_back(i);
+            }
+
+            std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b)
+                      {
+                          if (slots[a].stale != slots[b].stale)
+                              return slots[a].stale;
+                          return slots[a].lastDrawFrame < slots[b].lastDrawFrame; });
+            const size_t takeCnt = std::min<size_t>(candidates.size(), budget);
+            picked.insert(picked.end(), candidates.begin(), candidates.begin() + takeCnt);
+            std::sort(picked.begin(), picked.end());
+
+            for (uint32_t i : picked)
+            {
+                Slot &slot = slots[i];
+                slot.undrawn = false;
+                slot.stale = false;
+                slot.lastDrawFrame = frame;
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            bool active = false;
+            bool undrawn = false;
+            bool stale = false;
+            uint64_t lastDrawFrame = 0;
+        };
+
+        std::vector<Slot> slots;
+        std::vector<uint32_t> candidates;
+    };
+}
+
+#endif
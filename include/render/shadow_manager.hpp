@@ -6,6 +6,7 @@
 #include <render/frame_graph.hpp>
 #include <render/camera.hpp>
 #include <render/render_config.hpp>
+#include <render/shadow_cache.hpp>
 #include <asset.hpp>
 #include <array>
 #include <entt/entity/entity.hpp>
@@ -52,7 +53,13 @@ namespace vke_render
         ShadowManager &operator=(const ShadowManager &) = delete;
 
         void UpdateDirectionalShadowInfo();
+        // the view projection the slot is drawn with the next time the schedule picks it
         void CalcSpotShadowVPMatrix(SpotLight &light);
+        // keys the cascade caches and picks the spot slots drawn this frame, before the infos are synced
+        void PrepareShadowViews();
+        // a static caster was added, removed or moved
+        void OnStaticCastersChanged();
+        void SetDynamicCasterCnt(uint32_t cnt) { dynamicCasterCnt = cnt; }
         void SyncDirectionalShadowToGPU(uint32_t currentFrame);
         void SyncSpotShadowToGPU(uint32_t currentFrame);
         void SetCPULightData(std::shared_ptr<CPULightData> data);
@@ -60,9 +67,17 @@ namespace vke_render
         void DeactivateSpotShadow(entt::entity lightEntity, SpotLight &light);
 
         VkImage *GetDirectionalShadowMapImages() { return directionalShadowMapImages; }
-        VkImage *GetSpotShadowMapImages() { return spotShadowMapImages; }
+        // one map shared by the frames in flight, slots that are not redrawn keep their depth
+        VkImage *GetSpotShadowMapImage() { return &spotShadowMapImage; }
         VkImageView GetDirectionalShadowCascadeView(uint32_t currentFrame, uint32_t cascade) const { return directionalShadowCascadeImageViews[currentFrame][cascade]; }
-        VkImageView GetSpotShadowMapLayerView(uint32_t currentFrame, uint32_t slot) const { return spotShadowMapLayerViews[currentFrame][slot]; }
+        VkImageView GetSpotShadowMapLayerView(uint32_t slot) const { return spotShadowMapLayerViews[slot]; }
+        VkImage GetDirectionalCacheImage() const { return directionalCacheImage; }
+        VkImageView GetDirectionalCacheView(uint32_t cascade) const { return directionalCacheLayerViews[cascade]; }
+        VkImage GetSpotCacheImage() const { return spotCacheImage; }
+        VkImageView GetSpotCacheView(uint32_t slot) const { return spotCacheLayerViews[slot]; }
+        ShadowCache &GetDirectionalCache() { return directionalCache; }
+        ShadowCache &GetSpotCache() { return spotCache; }
+        const std::vector<uint32_t> &GetSpotSlotsToDraw() const { return spotSlotsToDraw; }
         VkDescriptorSet GetShadowPassDescriptorSet(uint32_t currentFrame) const { return shadowPassDescriptorSets[currentFrame]; }
         VkDescriptorSet GetDeferredLightingDescriptorSet(uint32_t currentFrame) const { return deferredLightingDescriptorSets[currentFrame]; }
         const DirectionalShadowInfoCPU &GetDirectionalShadowInfo() const { return directionalShadowInfo; }
@@ -83,20 +98,38 @@ namespace vke_render
         VkImage directionalShadowMapImages[MAX_FRAMES_IN_FLIGHT];
         VkImageView directionalShadowMapImageViews[MAX_FRAMES_IN_FLIGHT];
         VkImageView directionalShadowCascadeImageViews[MAX_FRAMES_IN_FLIGHT][MAX_DIRECTIONAL_SHADOW_CASCADE_CNT];
-        VkImage spotShadowMapImages[MAX_FRAMES_IN_FLIGHT];
-        VkImageView spotShadowMapImageViews[MAX_FRAMES_IN_FLIGHT];
-        VkImageView spotShadowMapLayerViews[MAX_FRAMES_IN_FLIGHT][MAX_SPOT_LIGHT_SHADOW_CNT];
+        VkImage spotShadowMapImage;
+        VmaAllocation spotShadowMapAllocation;
+        VkImageView spotShadowMapImageView;
+        VkImageView spotShadowMapLayerViews[MAX_SPOT_LIGHT_SHADOW_CNT];
+        // static-only depth, see ShadowCache; only the shadow pass touches them
+        VkImage directionalCacheImage;
+        VmaAllocation directionalCacheAllocation;
+        VkImageView directionalCacheLayerViews[MAX_DIRECTIONAL_SHADOW_CASCADE_CNT];
+        VkImage spotCacheImage;
+        VmaAllocation spotCacheAllocation;
+        VkImageView spotCacheLayerViews[MAX_SPOT_LIGHT_SHADOW_CNT];
         VkSampler shadowMapSampler;
         DirectionalShadowInfoCPU directionalShadowInfo;
+        // what the slot's map was drawn with, only these reach the GPU
         SpotShadowInfoCPU spotShadowInfos[MAX_SPOT_LIGHT_SHADOW_CNT];
+        // what the slot is drawn with the next time it is picked
+        SpotShadowInfoCPU pendingSpotShadowInfos[MAX_SPOT_LIGHT_SHADOW_CNT];
         entt::entity spotShadowLightEntities[MAX_SPOT_LIGHT_SHADOW_CNT];
         uint32_t spotShadowUpdateCnts[MAX_SPOT_LIGHT_SHADOW_CNT];
+        ShadowCache directionalCache;
+        ShadowCache spotCache;
+        SpotShadowSchedule spotSchedule;
+        std::vector<uint32_t> spotSlotsToDraw;
+        uint32_t dynamicCasterCnt;
+        uint64_t frameCnt;
 
         void createDescriptorSets();
         void createDirectionalImages();
         void createSpotShadowImages();
         void createDirectionalImageViews(uint32_t currentFrame);
-        void createSpotShadowImageViews(uint32_t currentFrame);
+        void createSpotShadowImageViews();
+        void createCacheImages();
         void createSampler();
         void updateDeferredLightingDescriptorSet(uint32_t currentFrame);
         void onTransientResourcesReady(uint32_t currentFrame);
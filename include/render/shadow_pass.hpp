@@ -22,8 +22,10 @@ namespace vke_render
                   std::map<std::string, vke_ds::id32_t> &blackboard,
                   ResourceNodeIDMap &currentResourceNodeID) override;
 
-        vke_ds::id64_t AddUnit(RenderUnit *unit, bool isSkin = false);
+        // static units are drawn into the shadow caches and must not move without MarkStaticCastersDirty
+        vke_ds::id64_t AddUnit(RenderUnit *unit, bool isSkin = false, bool isStatic = false);
         void RemoveUnit(vke_ds::id64_t id);
+        void MarkStaticCastersDirty() { shadowManager->OnStaticCastersChanged(); }
 
         void Render(TaskNode &node, FrameGraph &frameGraph, VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t imageIndex) override;
         void OnWindowResize(FrameGraph &frameGraph, RenderContext *ctx) override;
@@ -33,6 +35,7 @@ namespace vke_render
         std::shared_ptr<Material> shadowMaterial;
         std::shared_ptr<Material> shadowSkinMaterial;
         std::map<Material *, std::unique_ptr<RenderInfo>> renderInfoMap;
+        std::unique_ptr<RenderInfo> staticRenderInfo;
         std::map<vke_ds::id64_t, Material *> unitMaterialMap;
         vke_ds::id32_t shadowTaskNodeID;
         vke_ds::NaiveIDAllocator<vke_ds::id64_t> unitAllocator;
@@ -42,6 +45,11 @@ namespace vke_render
                                  ResourceNodeIDMap &currentResourceNodeID);
         void createGraphicsPipeline(RenderInfo &renderInfo, bool isSkin);
         void registerMaterial(std::shared_ptr<Material> &material, bool isSkin);
+        void drawCasters(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t shadowIndex, uint32_t shadowType,
+                         bool drawStatic, bool drawDynamic);
+        void drawShadowView(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t shadowType, uint32_t view,
+                            ShadowCache &cache, VkImage mapImage, VkImageView mapView, VkImage cacheImage, VkImageView cacheView,
+                            uint32_t mapSize);
     };
 }
 
@@ -0,0 +1,55 @@
+#ifndef SKINNING_GRAPH_H
+#define SKINNING_GRAPH_H
+
+#include <render/frame_graph.hpp>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace vke_render
+{
+    // blackboard key of the skinned vertex buffer, present only when compute skinning is enabled
+    inline const std::string SKINNED_VERTEX_BUFFER = "skinnedVertexBuffer";
+
+    // Registers the per-frame skinned vertex buffer and the compute task that writes it. Templated on
+    // the graph so the wiring can be checked against a recording graph without a device.
+    template <typename Graph, typename Callback>
+    vke_ds::id32_t ConstructSkinningFrameGraph(Graph &frameGraph,
+                                               std::map<std::string, vke_ds::id32_t> &blackboard,
+                                               ResourceNodeIDMap &currentResourceNodeID,
+                                               VkBuffer *buffers, Callback &&callback)
+    {
+        vke_ds::id32_t bufferResourceID = frameGraph.AddPermanentBufferResource(std::string(SKINNED_VERTEX_BUFFER), true,
+                                                                                buffers, 0, VK_WHOLE_SIZE,
+                                                                                VK_PIPELINE_STAGE_NONE);
+        blackboard[SKINNED_VERTEX_BUFFER] = bufferResourceID;
+
+        vke_ds::id32_t outResourceNodeID = frameGraph.AllocResourceNode("outSkinnedVertex", bufferResourceID);
+        vke_ds::id32_t skinningTaskNodeID = frameGraph.AllocTaskNode("compute skinning", COMPUTE_TASK, std::forward<Callback>(callback));
+        frameGraph.AddTaskNodeResourceRef(skinningTaskNodeID, 0, outResourceNodeID,
+                                          VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                          VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                          VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_STORE);
+
+        currentResourceNodeID[bufferResourceID] = outResourceNodeID;
+        return skinningTaskNodeID;
+    }
+
+    // Makes a pass that draws skinned units wait for the skinning dispatch; a no-op without compute skinning.
+    template <typename Graph>
+    void ReadSkinnedVertices(Graph &frameGraph, vke_ds::id32_t taskNodeID,
+                             std::map<std::string, vke_ds::id32_t> &blackboard,
+                             ResourceNodeIDMap &currentResourceNodeID)
+    {
+        auto it = blackboard.find(SKINNED_VERTEX_BUFFER);
+        if (it == blackboard.end())
+            return;
+
+        frameGraph.AddTaskNodeResourceRef(taskNodeID, currentResourceNodeID[it->second], 0,
+                                          VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT,
+                                          VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
+                                          VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+    }
+}
+
+#endif
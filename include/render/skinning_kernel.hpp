@@ -0,0 +1,71 @@
+#ifndef SKINNING_KERNEL_H
+#define SKINNING_KERNEL_H
+
+#include <cmath>
+#include <cstdint>
+
+namespace vke_render
+{
+    // Same layouts as SkinVertex and Vertex, spelled out in floats so the reference kernel stays
+    // usable without glm; compute_skinning.cpp checks that the sizes agree.
+    struct SkinningVertexIn
+    {
+        float pos[3];
+        float normal[3];
+        float tangent[4];
+        float texCoord[2];
+        float weights[4];
+        uint32_t jointIDs[4];
+    };
+
+    struct SkinningVertexOut
+    {
+        float pos[3];
+        float normal[3];
+        float tangent[4];
+        float texCoord[2];
+    };
+
+    // CPU reference of skinning.comp: blends the vertex's four palette matrices (column-major, starting
+    // at jointOffset) by weight, transforms the position and renormalizes normal and tangent.
+    inline void SkinVertexReference(const float *palette, uint32_t jointOffset, const SkinningVertexIn &in, SkinningVertexOut &out)
+    {
+        float skin[16] = {};
+        for (int i = 0; i < 4; ++i)
+        {
+            const float *joint = palette + (static_cast<size_t>(jointOffset + in.jointIDs[i]) << 4);
+            for (int j = 0; j < 16; ++j)
+                skin[j] += in.weights[i] * joint[j];
+        }
+
+        auto transform = [&skin](const float *v, float w, float *dst)
+        {
+            for (int r = 0; r < 3; ++r)
+                dst[r] = skin[r] * v[0] + skin[4 + r] * v[1] + skin[8 + r] * v[2] + skin[12 + r] * w;
+        };
+        auto normalize = [](float *v)
+        {
+            const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+            if (length > 0.0f)
+                for (int r = 0; r < 3; ++r)
+                    v[r] /= length;
+        };
+
+        transform(in.pos, 1.0f, out.pos);
+        transform(in.normal, 0.0f, out.normal);
+        normalize(out.normal);
+        transform(in.tangent, 0.0f, out.tangent);
+        normalize(out.tangent);
+        out.tangent[3] = in.tangent[3];
+        out.texCoord[0] = in.texCoord[0];
+        out.texCoord[1] = in.texCoord[1];
+    }
+
+    inline void SkinVerticesReference(const float *palette, uint32_t jointOffset, const SkinningVertexIn *in, SkinningVertexOut *out, uint32_t vertexCnt)
+    {
+        for (uint32_t i = 0; i < vertexCnt; ++i)
+            SkinVertexReference(palette, jointOffset, in[i], out[i]);
+    }
+}
+
+#endif
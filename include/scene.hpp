@@ -17,6 +17,7 @@
 #include <component/character_controller.hpp>
 #include <component/text.hpp>
 #include <scene_transform_system.hpp>
+#include <scene_binary.hpp>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -67,9 +68,21 @@ namespace vke_common
             initialized = true;
         }
 
+        Scene(const std::string &pth, const SceneBinaryReader &reader)
+            : path(pth),
+              registry(), idToEntity(), lighting(), glyphs(std::make_shared<vke_render::CPUGlyphData>()),
+              loadedToEngine(false), transformSystem(registry, idToEntity),
+              idAllocator(reader.GetMaxID()),
+              physicsUpdateListenerID(0), initialized(false)
+        {
+            initFromBinary(reader);
+            initialized = true;
+        }
+
         ~Scene() {}
 
         nlohmann::json ToJSON();
+        SceneBinaryWriter ToBinary();
 
         void LoadToEngine()
         {
@@ -193,8 +206,11 @@ namespace vke_common
         bool initialized;
 
         void init(const nlohmann::json &json);
+        void initFromBinary(const SceneBinaryReader &reader);
         void loadComponent(const vke_ds::id32_t id, const entt::entity entity,
                            const nlohmann::json &component);
+        void loadComponent(ComponentType type, const entt::entity entity, const nlohmann::json &component);
+        void reserveComponents(ComponentType type, size_t cnt);
         void componentToJSON(const vke_ds::id32_t id, nlohmann::json &json, const vke_render::SceneLightData &lightData);
         void unloadEntityFromEngine(entt::entity entity);
 
@@ -240,20 +256,39 @@ namespace vke_common
             instance->loadCurrentSceneToEngine();
         }
 
-        static std::unique_ptr<Scene> LoadScene(const std::string &pth) // load scene data only, not load to engine
+        // load scene data only, not load to engine; returns nullptr for a scene binary that fails validation
+        static std::unique_ptr<Scene> LoadScene(const std::string &pth)
         {
+            if (SceneBinaryReader::IsSceneBinary(pth))
+            {
+                SceneBinaryReader reader;
+                if (!reader.Open(pth))
+                {
+                    VKE_LOG_ERROR("Failed to load scene {}", pth)
+                    return nullptr;
+                }
+                return std::make_unique<Scene>(pth, reader);
+            }
             nlohmann::json json(vke_common::AssetManager::LoadJSON(pth));
             return std::make_unique<Scene>(pth, json);
         }
 
+        // paths ending in .vksb are saved in the binary scene format, anything else as JSON
         static void SaveScene(const std::string &pth)
         {
-            if (instance->currentScene != nullptr)
+            if (instance->currentScene == nullptr)
+                return;
+
+            if (pth.ends_with(".vksb"))
             {
-                std::ofstream ofs(pth);
-                ofs << instance->currentScene->ToJSON().dump(4);
-                ofs.close();
+                if (!instance->currentScene->ToBinary().WriteFile(pth))
+                    VKE_LOG_ERROR("Failed to save scene {}", pth)
+                return;
             }
+
+            std::ofstream ofs(pth);
+            ofs << instance->currentScene->ToJSON().dump(4);
+            ofs.close();
         }
 
     private:
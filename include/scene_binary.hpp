@@ -0,0 +1,222 @@
+#ifndef SCENE_BINARY_H
+#define SCENE_BINARY_H
+
+#include <component.hpp>
+#include <mapped_file.hpp>
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vke_common
+{
+    // Binary scene container (.vksb).
+    //
+    // Layout: SceneBinaryHeader followed by 8-byte aligned sections. Every object lives in one entity
+    // table row (id, layer, name, parent, children range, transform). Every component type has its own
+    // contiguous section of records, and the records for a type carry their payloads (MessagePack
+    // encoded component JSON) right after the record array. Script state keeps className and data as
+    // strings in the shared string table, which is also what the C# side consumes.
+    // Offsets inside a section are relative to the start of that section.
+
+    constexpr uint32_t SCENE_BINARY_MAGIC = 0x42534B56; // "VKSB"
+    constexpr uint32_t SCENE_BINARY_VERSION = 1;
+    constexpr uint32_t SCENE_BINARY_COMPONENT_TYPE_CNT = static_cast<uint32_t>(ComponentType::UIText) + 1;
+
+    enum SceneBinarySectionType : uint32_t
+    {
+        SCENE_SECTION_STRINGS = 0,
+        SCENE_SECTION_LAYERS,
+        SCENE_SECTION_OBJECTS,
+        SCENE_SECTION_CHILDREN,
+        SCENE_SECTION_OBJECT_EXTRAS,
+        // followed by one section per ComponentType (the Transform slot stays empty, transforms live in the entity table)
+        SCENE_SECTION_FIRST_COMPONENT,
+        SCENE_SECTION_CNT = SCENE_SECTION_FIRST_COMPONENT + SCENE_BINARY_COMPONENT_TYPE_CNT
+    };
+
+    inline constexpr uint32_t GetComponentSection(ComponentType type)
+    {
+        return SCENE_SECTION_FIRST_COMPONENT + static_cast<uint32_t>(type);
+    }
+
+    struct SceneBinarySection
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t count;
+        uint32_t reserved;
+    };
+
+    struct SceneBinaryHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t maxID;
+        uint32_t sectionCnt;
+        SceneBinarySection sections[SCENE_SECTION_CNT];
+    };
+
+    struct SceneBinaryStringRef
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct SceneBinaryBlobRef
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct SceneBinaryObject
+    {
+        uint32_t id;
+        int32_t layer;
+        uint32_t parent;
+        uint32_t isStatic;
+        SceneBinaryStringRef name;
+        uint32_t firstChild;
+        uint32_t childCnt;
+        // stored as double so JSON <-> binary conversion keeps the authored values
+        double position[3];
+        double scale[3];
+        double rotation[4];
+        uint32_t componentCnt;
+        uint32_t reserved;
+    };
+
+    // MessagePack payload of keys on the object that the engine does not interpret, keeps conversion lossless
+    struct SceneBinaryObjectExtra
+    {
+        uint32_t objectIndex;
+        SceneBinaryBlobRef data;
+    };
+
+    struct SceneBinaryComponent
+    {
+        uint32_t objectIndex;
+        uint32_t order; // position in the object's component list
+        SceneBinaryBlobRef data;
+    };
+
+    struct SceneBinaryScript
+    {
+        uint32_t objectIndex;
+        uint32_t order;
+        SceneBinaryStringRef className;
+        SceneBinaryStringRef data; // JSON text of the serialized script data
+    };
+
+    static_assert(sizeof(SceneBinaryObject) % 8 == 0, "SceneBinaryObject must keep 8 byte alignment");
+
+    ComponentType ComponentTypeFromName(std::string_view name, bool &valid);
+    const char *ComponentTypeName(ComponentType type);
+
+    class SceneBinaryWriter
+    {
+    public:
+        SceneBinaryWriter();
+
+        void SetMaxID(uint32_t id) { maxID = id; }
+        void AddLayer(std::string_view layer);
+        // returns the object index used by AddComponent/AddScript
+        uint32_t AddObject(uint32_t id, int32_t layer, bool isStatic, std::string_view name, uint32_t parent,
+                           std::span<const uint32_t> children,
+                           const double (&position)[3], const double (&scale)[3], const double (&rotation)[4]);
+        void AddObjectExtra(uint32_t objectIndex, const nlohmann::json &extra);
+        void AddComponent(uint32_t objectIndex, ComponentType type, const nlohmann::json &component);
+        void AddScript(uint32_t objectIndex, std::string_view className, const nlohmann::json &data);
+
+        std::vector<uint8_t> Finish() const;
+        bool WriteFile(const std::string &pth) const;
+
+        // lossless JSON scene -> binary
+        static SceneBinaryWriter FromJSON(const nlohmann::json &json);
+
+    private:
+        uint32_t maxID;
+        std::vector<char> strings;
+        std::vector<SceneBinaryStringRef> layers;
+        std::vector<SceneBinaryObject> objects;
+        std::vector<uint32_t> children;
+        std::vector<SceneBinaryObjectExtra> extras;
+        std::vector<uint8_t> extraPayload;
+        std::vector<SceneBinaryComponent> components[SCENE_BINARY_COMPONENT_TYPE_CNT];
+        std::vector<uint8_t> componentPayloads[SCENE_BINARY_COMPONENT_TYPE_CNT];
+        std::vector<SceneBinaryScript> scripts;
+
+        SceneBinaryStringRef addString(std::string_view value);
+        static SceneBinaryBlobRef appendMsgPack(std::vector<uint8_t> &payload, const nlohmann::json &json);
+    };
+
+    class SceneBinaryReader
+    {
+    public:
+        SceneBinaryReader() : header(nullptr) {}
+
+        static bool IsSceneBinary(const std::string &pth);
+
+        // maps the file, the reader keeps the mapping alive; fails unless every record, string and payload
+        // reference, object index and parent/child id points into the file. Every payload and script data
+        // string is decoded once here, the accessors below return the decoded values
+        bool Open(const std::string &pth);
+        // reads from memory owned by the caller
+        bool Open(std::span<const uint8_t> bytes);
+
+        uint32_t GetMaxID() const { return header->maxID; }
+        std::span<const SceneBinaryStringRef> GetLayers() const { return getSection<SceneBinaryStringRef>(SCENE_SECTION_LAYERS); }
+        std::span<const SceneBinaryObject> GetObjects() const { return getSection<SceneBinaryObject>(SCENE_SECTION_OBJECTS); }
+        std::span<const uint32_t> GetChildren(const SceneBinaryObject &object) const
+        {
+            return getSection<uint32_t>(SCENE_SECTION_CHILDREN).subspan(object.firstChild, object.childCnt);
+        }
+        std::span<const SceneBinaryObjectExtra> GetObjectExtras() const { return getSection<SceneBinaryObjectExtra>(SCENE_SECTION_OBJECT_EXTRAS); }
+        std::span<const SceneBinaryComponent> GetComponents(ComponentType type) const
+        {
+            return getSection<SceneBinaryComponent>(GetComponentSection(type));
+        }
+        std::span<const SceneBinaryScript> GetScripts() const
+        {
+            return getSection<SceneBinaryScript>(GetComponentSection(ComponentType::Script));
+        }
+
+        std::string_view GetString(SceneBinaryStringRef ref) const
+        {
+            return std::string_view(reinterpret_cast<const char *>(sectionData(SCENE_SECTION_STRINGS)) + ref.offset, ref.length);
+        }
+        // indices are record indices of GetObjectExtras, GetComponents(type) and GetScripts
+        const nlohmann::json &GetObjectExtra(size_t index) const { return extraJSONs[index]; }
+        const nlohmann::json &GetComponentJSON(ComponentType type, size_t index) const
+        {
+            return componentJSONs[static_cast<uint32_t>(type)][index];
+        }
+        const nlohmann::json &GetScriptData(size_t index) const { return scriptDataJSONs[index]; }
+
+        // lossless binary -> JSON scene
+        nlohmann::json ToJSON() const;
+
+    private:
+        MappedFile file;
+        std::span<const uint8_t> bytes;
+        const SceneBinaryHeader *header;
+        std::vector<nlohmann::json> extraJSONs;
+        std::vector<nlohmann::json> componentJSONs[SCENE_BINARY_COMPONENT_TYPE_CNT];
+        std::vector<nlohmann::json> scriptDataJSONs;
+
+        bool validate();
+        bool validateReferences();
+        void clearDecoded();
+        const uint8_t *sectionData(uint32_t section) const { return bytes.data() + header->sections[section].offset; }
+
+        template <typename T>
+        std::span<const T> getSection(uint32_t section) const
+        {
+            return std::span<const T>(reinterpret_cast<const T *>(sectionData(section)), header->sections[section].count);
+        }
+    };
+}
+
+#endif
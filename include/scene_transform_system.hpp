@@ -3,6 +3,7 @@
 
 #include <component/transform.hpp>
 #include <ds/id_allocator.hpp>
+#include <scene_binary.hpp>
 #include <entt/entity/registry.hpp>
 #include <unordered_map>
 #include <unordered_set>
@@ -18,6 +19,7 @@ namespace vke_common
             : registry(registry), idToEntity(idToEntity) {}
 
         void InitializeHierarchy(const nlohmann::json &jsonObjs);
+        void InitializeHierarchy(const SceneBinaryReader &reader);
         void PrepareForRemove(entt::entity entity, std::vector<entt::entity> &entities);
         void RemoveChild(entt::entity entity, entt::entity childEntity);
         void SetParent(entt::entity entity, entt::entity parentEntity);
@@ -36,6 +38,7 @@ namespace vke_common
         entt::registry &registry;
         std::unordered_map<vke_ds::id32_t, entt::entity> &idToEntity;
 
+        void updateHierarchy();
         void dfs(entt::entity entity, Transform &transform, std::unordered_set<entt::entity> &visited);
         void updateTransform(entt::entity entity, Transform &transform, bool first);
     };
@@ -6,6 +6,7 @@
 #include <dotnet/hostfxr.h>
 
 #include <interop/native.hpp>
+#include <script_scheduler.hpp>
 
 #include <cstdint>
 #include <string>
@@ -30,7 +31,7 @@ namespace vke_common
     {
         void (*load)(const char **, uint32_t);
         void (*start)();
-        void (*update)();
+        void (*dispatch)(uint32_t, const uint32_t *, const float *, float *, uint32_t);
         void (*fixedUpdate)();
         void (*lateUpdate)();
         void (*unload)();
@@ -38,7 +39,7 @@ namespace vke_common
         CSharpSceneManagerFunctions()
             : load(nullptr),
               start(nullptr),
-              update(nullptr),
+              dispatch(nullptr),
               fixedUpdate(nullptr),
               lateUpdate(nullptr),
               unload(nullptr) {}
@@ -56,6 +57,26 @@ namespace vke_common
               sceneManagerFunctions() {}
     };
 
+    // Runs a dispatch list through SceneManager.Dispatch on the C# side.
+    class CSharpScriptDispatchBackend : public ScriptDispatchBackend
+    {
+    public:
+        CSharpScriptDispatchBackend() : functions(nullptr) {}
+
+        void Bind(const CSharpSceneManagerFunctions *sceneManagerFunctions)
+        {
+            functions = sceneManagerFunctions;
+        }
+
+        void Dispatch(ScriptPhase phase, const uint32_t *scripts, const float *deltaTimes, float *elapsedMs, uint32_t cnt) override
+        {
+            functions->dispatch(phase, scripts, deltaTimes, elapsedMs, cnt);
+        }
+
+    private:
+        const CSharpSceneManagerFunctions *functions;
+    };
+
     class ScriptManager
     {
     private:
@@ -94,24 +115,34 @@ namespace vke_common
             instance->csharpExports.sceneManagerFunctions.start();
         }
 
-        static void Update()
+        static void Update(float deltaTime)
         {
-            instance->csharpExports.sceneManagerFunctions.update();
+            instance->scheduler.Dispatch(SCRIPT_PHASE_UPDATE, deltaTime, instance->dispatchBackend);
         }
 
-        static void FixedUpdate()
+        static void FixedUpdate(float stepTime)
         {
+            // contact events are delivered before the scheduled FixedUpdate scripts run
             instance->csharpExports.sceneManagerFunctions.fixedUpdate();
+            instance->scheduler.Dispatch(SCRIPT_PHASE_FIXED_UPDATE, stepTime, instance->dispatchBackend);
         }
 
         static void Unload()
         {
             instance->csharpExports.sceneManagerFunctions.unload();
+            instance->scheduler.Clear();
+        }
+
+        static ScriptScheduler &GetScheduler()
+        {
+            return instance->scheduler;
         }
 
     private:
         DelegateFunctionPointers functionPointers;
         CSharpExports csharpExports;
+        ScriptScheduler scheduler;
+        CSharpScriptDispatchBackend dispatchBackend;
 
         void init();
 
@@ -0,0 +1,142 @@
+#ifndef SCRIPT_SCHEDULER_H
+#define SCRIPT_SCHEDULER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ds/id_allocator.hpp>
+#include <nlohmann/json.hpp>
+
+namespace vke_common
+{
+    enum ScriptPhase : uint32_t
+    {
+        SCRIPT_PHASE_UPDATE = 0,
+        SCRIPT_PHASE_FIXED_UPDATE = 1,
+        SCRIPT_PHASE_CNT
+    };
+
+    enum ScriptPhaseMask : uint32_t
+    {
+        SCRIPT_PHASE_MASK_UPDATE = 1u << SCRIPT_PHASE_UPDATE,
+        SCRIPT_PHASE_MASK_FIXED_UPDATE = 1u << SCRIPT_PHASE_FIXED_UPDATE,
+    };
+
+    // Must match ScriptUpdateMode in csharp/EngineCore/ScriptScheduling.cs.
+    enum ScriptUpdateMode : uint32_t
+    {
+        SCRIPT_UPDATE_EVERY_FRAME = 0,
+        // runs every interval frames (fixed steps for FixedUpdate), staggered by script id
+        SCRIPT_UPDATE_EVERY_N_FRAMES = 1,
+        // shares a per-frame time slice with the other time-sliced scripts, round robin
+        SCRIPT_UPDATE_TIME_SLICED = 2,
+    };
+
+    struct ScriptSchedulerConfig
+    {
+        float defaultBudgetMs = 1.0f;
+        float timeSliceBudgetMs = 2.0f;
+        float timingSmoothing = 0.1f;
+        uint32_t reportInterval = 300;
+
+        void LoadJSON(const nlohmann::json &json)
+        {
+            if (json.is_null())
+                return;
+
+            defaultBudgetMs = json.value("defaultBudgetMs", defaultBudgetMs);
+            timeSliceBudgetMs = json.value("timeSliceBudgetMs", timeSliceBudgetMs);
+            timingSmoothing = json.value("timingSmoothing", timingSmoothing);
+            reportInterval = json.value("reportInterval", reportInterval);
+        }
+    };
+
+    struct ScriptSchedule
+    {
+        ScriptUpdateMode mode = SCRIPT_UPDATE_EVERY_FRAME;
+        uint32_t interval = 1;
+        float budgetMs = 0.0f; // <= 0 uses ScriptSchedulerConfig::defaultBudgetMs
+        uint32_t phaseMask = SCRIPT_PHASE_MASK_UPDATE;
+    };
+
+    struct ScriptTimingStats
+    {
+        float lastMs = 0.0f;
+        float averageMs = 0.0f;
+        float maxMs = 0.0f;
+        uint64_t dispatchCnt = 0;
+        uint64_t overBudgetCnt = 0;
+        uint32_t overBudgetSinceReport = 0;
+        float worstSinceReport = 0.0f;
+    };
+
+    // Executes one phase of a dispatch list. elapsedMs receives the measured cost of every entry.
+    class ScriptDispatchBackend
+    {
+    public:
+        virtual ~ScriptDispatchBackend() = default;
+        virtual void Dispatch(ScriptPhase phase, const uint32_t *scripts, const float *deltaTimes, float *elapsedMs, uint32_t cnt) = 0;
+    };
+
+    class ScriptScheduler
+    {
+    public:
+        ScriptScheduler() : ScriptScheduler(ScriptSchedulerConfig{}) {}
+        explicit ScriptScheduler(const ScriptSchedulerConfig &config) : config(config) {}
+
+        uint32_t Register(const std::string &name, const ScriptSchedule &schedule);
+        void Unregister(uint32_t id);
+        void Clear();
+
+        // BuildDispatchList + backend dispatch + RecordTimings, reports over-budget scripts every reportInterval updates
+        void Dispatch(ScriptPhase phase, float deltaTime, ScriptDispatchBackend &backend);
+
+        const std::vector<uint32_t> &BuildDispatchList(ScriptPhase phase, float deltaTime);
+        void RecordTimings(ScriptPhase phase, const float *elapsedMs);
+        // returns the ids that went over budget since the previous report and resets their report counters
+        const std::vector<uint32_t> &ReportOverBudget();
+
+        const std::vector<uint32_t> &GetDispatchList(ScriptPhase phase) const { return phases[phase].dispatchList; }
+        const std::vector<float> &GetDispatchDeltaTimes(ScriptPhase phase) const { return phases[phase].dispatchDeltaTimes; }
+        const ScriptTimingStats *GetStats(uint32_t id, ScriptPhase phase) const;
+        const ScriptSchedulerConfig &GetConfig() const { return config; }
+        uint64_t GetFrameIndex(ScriptPhase phase) const { return phases[phase].frameIndex; }
+        uint32_t GetScriptCnt() const { return scriptCnt; }
+
+    private:
+        struct ScriptEntry
+        {
+            std::string name;
+            ScriptSchedule schedule;
+            bool alive = false;
+            // bumped every time the id is registered, an id reused while its old owner is being dispatched gets a new one
+            uint32_t generation = 0;
+            float pendingDeltaTime[SCRIPT_PHASE_CNT]{};
+            ScriptTimingStats stats[SCRIPT_PHASE_CNT]{};
+        };
+
+        struct PhaseState
+        {
+            uint64_t frameIndex = 0;
+            std::vector<uint32_t> periodic;
+            std::vector<uint32_t> sliced;
+            size_t sliceCursor = 0;
+            std::vector<uint32_t> dispatchList;
+            std::vector<float> dispatchDeltaTimes;
+            std::vector<uint32_t> dispatchGenerations;
+            std::vector<float> elapsedMs;
+        };
+
+        ScriptSchedulerConfig config;
+        std::vector<ScriptEntry> scripts;
+        vke_ds::DynamicIDAllocator<uint32_t> idAllocator;
+        uint32_t scriptCnt = 0;
+        PhaseState phases[SCRIPT_PHASE_CNT];
+        std::vector<uint32_t> overBudgetScripts;
+
+        float getBudget(const ScriptEntry &entry) const;
+        void dispatchToList(PhaseState &state, ScriptEntry &entry, uint32_t id, ScriptPhase phase);
+    };
+}
+
+#endif
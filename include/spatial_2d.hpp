@@ -3,6 +3,10 @@
 
 #include <ds/id_allocator.hpp>
 #include <glm/vec2.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <map>
 #include <optional>
@@ -23,6 +27,116 @@ namespace vke_common
         bool Overlaps(const AABB2D &other) const;
     };
 
+    // Hierarchical hash grid: a rect goes to the finest level whose cells are at least as large as
+    // its bigger side, so it touches at most 2x2 cells there however large it is. Queries visit the
+    // cells they cover on every level, or a level's occupied cells when that is fewer.
+    class Spatial2DIndex
+    {
+    public:
+        static constexpr float DEFAULT_CELL_SIZE = 64.0f;
+        static constexpr uint32_t LEVEL_CNT = 16;
+
+        explicit Spatial2DIndex(float cellSize = DEFAULT_CELL_SIZE) : cellSize(cellSize) {}
+
+        void Insert(vke_ds::id32_t id, const AABB2D &bounds);
+        void Remove(vke_ds::id32_t id);
+        bool Empty() const { return entries.empty(); }
+        size_t Size() const { return entries.size(); }
+
+        // calls visitor(id, bounds) once per rect overlapping bounds until it returns false
+        template <typename Visitor>
+        bool ForEachOverlap(const AABB2D &bounds, Visitor &&visitor) const
+        {
+            for (uint32_t level = 0; level < LEVEL_CNT; ++level)
+            {
+                const Level &cells = levels[level];
+                if (cells.empty())
+                    continue;
+
+                const float size = levelCellSize(level);
+                const CellRange range = cellRange(bounds, size);
+                auto visitCell = [&](int32_t x, int32_t y, const std::vector<vke_ds::id32_t> &ids)
+                {
+                    for (vke_ds::id32_t id : ids)
+                    {
+                        const AABB2D &other = entries.at(id).bounds;
+                        if (!other.Overlaps(bounds))
+                            continue;
+                        // a rect spanning several visited cells is reported from the cell holding the
+                        // min corner of the overlap only
+                        if (cellCoord(std::max(bounds.min.x, other.min.x), size) != x ||
+                            cellCoord(std::max(bounds.min.y, other.min.y), size) != y)
+                            continue;
+                        if (!visitor(id, other))
+                            return false;
+                    }
+                    return true;
+                };
+
+                if (range.CellCnt() > cells.size())
+                {
+                    for (const auto &cell : cells)
+                    {
+                        const int32_t x = cellX(cell.first), y = cellY(cell.first);
+                        if (range.Contains(x, y) && !visitCell(x, y, cell.second))
+                            return false;
+                    }
+                    continue;
+                }
+
+                for (int32_t y = range.minY; y <= range.maxY; ++y)
+                    for (int32_t x = range.minX; x <= range.maxX; ++x)
+                    {
+                        auto it = cells.find(cellKey(x, y));
+                        if (it != cells.end() && !visitCell(x, y, it->second))
+                            return false;
+                    }
+            }
+            return true;
+        }
+
+        void Query(const glm::vec2 &point, std::vector<vke_ds::id32_t> &result) const;
+        void Query(const AABB2D &bounds, std::vector<vke_ds::id32_t> &result) const;
+
+    private:
+        struct Entry
+        {
+            AABB2D bounds;
+            uint32_t level;
+        };
+
+        struct CellRange
+        {
+            int32_t minX, minY, maxX, maxY;
+
+            uint64_t CellCnt() const { return uint64_t(int64_t(maxX) - minX + 1) * uint64_t(int64_t(maxY) - minY + 1); }
+            bool Contains(int32_t x, int32_t y) const { return x >= minX && x <= maxX && y >= minY && y <= maxY; }
+        };
+
+        using Level = std::unordered_map<uint64_t, std::vector<vke_ds::id32_t>>;
+
+        float cellSize;
+        std::unordered_map<vke_ds::id32_t, Entry> entries;
+        std::array<Level, LEVEL_CNT> levels;
+
+        float levelCellSize(uint32_t level) const { return cellSize * static_cast<float>(1u << level); }
+        uint32_t selectLevel(const AABB2D &bounds) const;
+
+        static int32_t cellCoord(float v, float size)
+        {
+            // clamped so rects at extreme coordinates still map to valid cells
+            const float cell = std::floor(v / size);
+            return static_cast<int32_t>(std::clamp(cell, -1073741824.0f, 1073741824.0f));
+        }
+        static CellRange cellRange(const AABB2D &bounds, float size)
+        {
+            return {cellCoord(bounds.min.x, size), cellCoord(bounds.min.y, size), cellCoord(bounds.max.x, size), cellCoord(bounds.max.y, size)};
+        }
+        static uint64_t cellKey(int32_t x, int32_t y) { return (uint64_t(uint32_t(x)) << 32) | uint32_t(y); }
+        static int32_t cellX(uint64_t key) { return static_cast<int32_t>(uint32_t(key >> 32)); }
+        static int32_t cellY(uint64_t key) { return static_cast<int32_t>(uint32_t(key)); }
+    };
+
     struct Spatial2DUnit
     {
         static constexpr vke_ds::id32_t INVALID_LAYER = std::numeric_limits<vke_ds::id32_t>::max();
@@ -40,14 +154,10 @@ namespace vke_common
 
         const vke_ds::id32_t id;
 
-        bool CanInsert(const Spatial2DUnit &unit) const;
         void Insert(Spatial2DUnit &unit);
         void Remove(vke_ds::id32_t unitID);
         bool Empty() const { return units.empty(); }
 
-        std::vector<vke_ds::id32_t> Query(const glm::vec2 &point) const;
-        std::vector<vke_ds::id32_t> Query(const AABB2D &bounds) const;
-
         const std::unordered_map<vke_ds::id32_t, Spatial2DUnit *> &GetUnits() const { return units; }
 
     private:
@@ -71,9 +181,12 @@ namespace vke_common
 
         std::vector<vke_ds::id32_t> Query(const glm::vec2 &point) const;
         std::vector<vke_ds::id32_t> Query(const AABB2D &bounds) const;
-        const std::vector<vke_ds::id32_t> &GetLayerOrder() const { return layerOrder; }
+        // back to front
+        const std::vector<vke_ds::id32_t> &GetLayerOrder() const;
 
     private:
+        using LayerOrder = std::map<uint64_t, vke_ds::id32_t>;
+
         static Spatial2DLayerManager *instance;
 
         Spatial2DLayerManager() = default;
@@ -84,10 +197,18 @@ namespace vke_common
         vke_ds::NaiveIDAllocator<vke_ds::id32_t> layerAllocator;
         std::map<vke_ds::id32_t, Spatial2DUnit> units;
         std::map<vke_ds::id32_t, Spatial2DLayer> layers;
-        std::vector<vke_ds::id32_t> layerOrder;
+        // layers by gap-spaced order key, so adding or dropping a layer leaves the other keys alone
+        LayerOrder layerOrder;
+        std::unordered_map<vke_ds::id32_t, uint64_t> layerKeys;
+        mutable std::vector<vke_ds::id32_t> layerOrderCache;
+        mutable bool layerOrderDirty = false;
+        // every placed unit, to find the few a new unit overlaps without scanning each layer
+        Spatial2DIndex index;
 
         vke_ds::id32_t insertUnit(Spatial2DUnit &unit);
         void removeFromLayer(Spatial2DUnit &unit);
+        uint64_t allocLayerKey(LayerOrder::iterator next);
+        LayerOrder::iterator spreadLayerKeys(LayerOrder::iterator next);
     };
 }
 
@@ -0,0 +1,353 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <font_atlas_baker.hpp>
+#include <ds/lru_slot_cache.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <glm/common.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vke_common
+{
+    // decodes the codepoint starting at byte i and moves i past it; malformed input gives U+FFFD
+    inline uint32_t DecodeUTF8Codepoint(std::string_view text, size_t &i)
+    {
+        const uint8_t first = static_cast<uint8_t>(text[i]);
+        uint32_t codepoint = 0;
+        size_t length = 0;
+        if (first < 0x80)
+        {
+            ++i;
+            return first;
+        }
+        else if ((first & 0xE0) == 0xC0)
+        {
+            codepoint = first & 0x1F;
+            length = 2;
+        }
+        else if ((first & 0xF0) == 0xE0)
+        {
+            codepoint = first & 0x0F;
+            length = 3;
+        }
+        else if ((first & 0xF8) == 0xF0)
+        {
+            codepoint = first & 0x07;
+            length = 4;
+        }
+        else
+        {
+            ++i;
+            return 0xFFFD;
+        }
+
+        // a sequence cut off by the end of the text ends it
+        if (i + length > text.size())
+        {
+            i = text.size();
+            return 0xFFFD;
+        }
+
+        for (size_t j = 1; j < length; ++j)
+        {
+            const uint8_t next = static_cast<uint8_t>(text[i + j]);
+            if ((next & 0xC0) != 0x80)
+            {
+                ++i;
+                return 0xFFFD;
+            }
+            codepoint = (codepoint << 6) | (next & 0x3F);
+        }
+
+        const uint32_t minimum = length == 2 ? 0x80 : (length == 3 ? 0x800 : 0x10000);
+        if (codepoint < minimum || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+        {
+            ++i;
+            return 0xFFFD;
+        }
+        i += length;
+        return codepoint;
+    }
+
+    // FNV-1a
+    inline uint64_t HashText(std::string_view text)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : text)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // the font state a layout depends on
+    struct TextLayoutFont
+    {
+        uint64_t handle = 0;
+        uint32_t pixelSize = 0;
+        int ascender = 0;
+        int lineHeight = 0;
+        // changes whenever a dynamic atlas glyph is evicted, see Font::GetDynamicAtlasGeneration
+        uint64_t glyphGeneration = 0;
+    };
+
+    struct TextLayoutKey
+    {
+        uint64_t font = 0;
+        uint32_t pixelSize = 0;
+        uint64_t textHash = 0;
+        // 0 for no wrapping
+        float wrapWidth = 0.0f;
+
+        bool operator==(const TextLayoutKey &) const = default;
+    };
+
+    struct LaidOutGlyph
+    {
+        glm::vec4 quadRect;
+        glm::vec4 uvRect;
+        uint32_t codepoint;
+        GlyphAtlasType atlasType;
+    };
+
+    struct TextLayout
+    {
+        // pen state after a codepoint
+        struct Checkpoint
+        {
+            uint32_t byteEnd;
+            uint32_t glyphCnt;
+            int penX;
+            int baselineY;
+            glm::vec2 minimum;
+            glm::vec2 maximum;
+        };
+
+        TextLayoutKey key;
+        std::string text;
+        std::vector<LaidOutGlyph> glyphs;
+        // one per codepoint, so a text starting with the same bytes can resume after the last shared one
+        std::vector<Checkpoint> checkpoints;
+        glm::vec2 minimum{0.0f};
+        glm::vec2 maximum{0.0f};
+        // dynamic atlas glyphs move when they are evicted, layouts using them only hold for this generation
+        uint64_t glyphGeneration = 0;
+        bool usesDynamicGlyphs = false;
+
+        bool IsValid(uint64_t currentGeneration) const { return !usesDynamicGlyphs || glyphGeneration == currentGeneration; }
+    };
+
+    // The checkpoint of layout a layout of text can resume from, or -1. layout has to be made with
+    // the same font and wrap width and still be valid.
+    inline int FindResumeCheckpoint(const TextLayout &layout, const TextLayoutKey &key, std::string_view text,
+                                    uint64_t glyphGeneration)
+    {
+        if (layout.key.font != key.font || layout.key.pixelSize != key.pixelSize ||
+            layout.key.wrapWidth != key.wrapWidth || !layout.IsValid(glyphGeneration))
+            return -1;
+        size_t sharedCnt = std::mismatch(text.begin(), text.end(), layout.text.begin(), layout.text.end()).first - text.begin();
+        // layout may end in a sequence cut off by its end, which text could complete
+        if (sharedCnt == layout.text.size() && sharedCnt < text.size() && sharedCnt > 0)
+            --sharedCnt;
+        const auto after = std::upper_bound(layout.checkpoints.begin(), layout.checkpoints.end(), sharedCnt,
+                                            [](size_t byteCnt, const TextLayout::Checkpoint &checkpoint)
+                                            { return byteCnt < checkpoint.byteEnd; });
+        return static_cast<int>(after - layout.checkpoints.begin()) - 1;
+    }
+
+    // Lays text out on one baseline per line, starting at the font's ascender. With a wrap width, a
+    // glyph that would cross it starts a new line. getGlyph maps a codepoint to a const Glyph * or
+    // nullptr. With resumeFrom, what layout holds up to that checkpoint is kept instead of laid out again.
+    template <typename GetGlyph>
+    void LayoutText(const TextLayoutFont &font, std::string_view text, float wrapWidth, GetGlyph &&getGlyph,
+                    TextLayout &layout, int resumeFrom = -1)
+    {
+        int penX = 0;
+        int baselineY = font.ascender;
+        glm::vec2 minimum(std::numeric_limits<float>::max());
+        glm::vec2 maximum(std::numeric_limits<float>::lowest());
+        size_t i = 0;
+        layout.usesDynamicGlyphs = false;
+        if (resumeFrom >= 0)
+        {
+            const TextLayout::Checkpoint checkpoint = layout.checkpoints[resumeFrom];
+            layout.glyphs.resize(checkpoint.glyphCnt);
+            layout.checkpoints.resize(resumeFrom + 1);
+            // the kept dynamic glyphs are looked up anyway, so they stay pinned like freshly laid out ones
+            for (const LaidOutGlyph &glyph : layout.glyphs)
+                if (glyph.atlasType == GlyphAtlasType::DYNAMIC_ATLAS)
+                {
+                    getGlyph(glyph.codepoint);
+                    layout.usesDynamicGlyphs = true;
+                }
+            penX = checkpoint.penX;
+            baselineY = checkpoint.baselineY;
+            minimum = checkpoint.minimum;
+            maximum = checkpoint.maximum;
+            i = checkpoint.byteEnd;
+        }
+        else
+        {
+            layout.glyphs.clear();
+            layout.checkpoints.clear();
+        }
+        layout.key = TextLayoutKey{font.handle, font.pixelSize, HashText(text), wrapWidth};
+        layout.text.assign(text);
+        layout.glyphGeneration = font.glyphGeneration;
+
+        while (i < text.size())
+        {
+            const uint32_t codepoint = DecodeUTF8Codepoint(text, i);
+            if (codepoint == '\n')
+            {
+                penX = 0;
+                baselineY += font.lineHeight;
+            }
+            else if (const Glyph *glyph = getGlyph(codepoint); glyph != nullptr)
+            {
+                if (wrapWidth > 0.0f && penX > 0 && static_cast<float>(penX + glyph->advanceX) > wrapWidth)
+                {
+                    penX = 0;
+                    baselineY += font.lineHeight;
+                }
+                if (glyph->width > 0 && glyph->height > 0)
+                {
+                    const float minX = static_cast<float>(penX + glyph->bearingX);
+                    const float minY = static_cast<float>(baselineY - glyph->bearingY);
+                    const float maxX = minX + static_cast<float>(glyph->width);
+                    const float maxY = minY + static_cast<float>(glyph->height);
+
+                    LaidOutGlyph laidOut;
+                    laidOut.quadRect = glm::vec4(minX, minY, maxX, maxY);
+                    laidOut.uvRect = glm::vec4(
+                        static_cast<float>(glyph->atlasX), static_cast<float>(glyph->atlasY),
+                        static_cast<float>(glyph->atlasX + glyph->width),
+                        static_cast<float>(glyph->atlasY + glyph->height));
+                    laidOut.codepoint = glyph->codepoint;
+                    laidOut.atlasType = glyph->atlasType;
+                    layout.glyphs.push_back(laidOut);
+                    layout.usesDynamicGlyphs = layout.usesDynamicGlyphs || glyph->atlasType == GlyphAtlasType::DYNAMIC_ATLAS;
+
+                    minimum = glm::min(minimum, glm::vec2(minX, minY));
+                    maximum = glm::max(maximum, glm::vec2(maxX, maxY));
+                }
+                penX += glyph->advanceX;
+            }
+            layout.checkpoints.push_back(TextLayout::Checkpoint{
+                static_cast<uint32_t>(i), static_cast<uint32_t>(layout.glyphs.size()), penX, baselineY, minimum, maximum});
+        }
+
+        layout.minimum = layout.glyphs.empty() ? glm::vec2(0.0f) : minimum;
+        layout.maximum = layout.glyphs.empty() ? glm::vec2(0.0f) : maximum;
+    }
+
+    // Shares layouts between texts showing the same string in the same font and wrap width, keyed by
+    // a hash of all four. A text whose previous string shares a prefix with the new one is laid out
+    // from the end of that prefix only, in place. The bytes laid out per frame are budgeted: past the
+    // budget, Layout leaves the layout alone and the caller defers its update to a later frame.
+    class TextLayoutCache
+    {
+    public:
+        static constexpr uint32_t DEFAULT_CAPACITY = 4096;
+        static constexpr uint32_t DEFAULT_FRAME_BUDGET = 64 * 1024;
+
+        struct Stats
+        {
+            uint64_t hitCnt = 0;
+            uint64_t missCnt = 0;
+            // misses that resumed from the text's previous layout
+            uint64_t resumedCnt = 0;
+            uint64_t deferredCnt = 0;
+            uint64_t laidOutByteCnt = 0;
+        };
+
+        explicit TextLayoutCache(uint32_t capacity = DEFAULT_CAPACITY, uint32_t frameBudget = DEFAULT_FRAME_BUDGET);
+        TextLayoutCache(const TextLayoutCache &) = delete;
+        TextLayoutCache &operator=(const TextLayoutCache &) = delete;
+
+        static TextLayoutCache *GetInstance();
+        static TextLayoutCache *Init(uint32_t capacity = DEFAULT_CAPACITY, uint32_t frameBudget = DEFAULT_FRAME_BUDGET);
+        static void Dispose();
+
+        // layout holds the text's current layout and receives the new one; false when the frame's
+        // budget is spent, layout is unchanged then
+        template <typename GetGlyph>
+        bool Layout(const TextLayoutFont &font, std::string_view text, float wrapWidth, TextLayout &layout, GetGlyph &&getGlyph)
+        {
+            const TextLayoutKey key{font.handle, font.pixelSize, HashText(text), wrapWidth};
+            if (const TextLayout *cached = find(key, text, font.glyphGeneration); cached != nullptr)
+            {
+                // keeps its dynamic glyphs from being evicted while they are on screen this frame
+                if (cached->usesDynamicGlyphs)
+                    for (const LaidOutGlyph &glyph : cached->glyphs)
+                        if (glyph.atlasType == GlyphAtlasType::DYNAMIC_ATLAS)
+                            getGlyph(glyph.codepoint);
+                layout = *cached;
+                ++stats.hitCnt;
+                return true;
+            }
+
+            ++stats.missCnt;
+            const int resumeFrom = FindResumeCheckpoint(layout, key, text, font.glyphGeneration);
+            const uint32_t byteCnt = static_cast<uint32_t>(text.size()) - (resumeFrom < 0 ? 0 : layout.checkpoints[resumeFrom].byteEnd);
+            // the first layout of a frame always goes ahead, however long
+            if (byteCnt > budgetLeft && budgetLeft < frameBudget)
+            {
+                ++stats.deferredCnt;
+                return false;
+            }
+            budgetLeft -= std::min(byteCnt, budgetLeft);
+            stats.laidOutByteCnt += byteCnt;
+
+            LayoutText(font, text, wrapWidth, getGlyph, layout, resumeFrom);
+            // resumed texts are the ever changing ones, counters and timers, which nothing else shows
+            if (resumeFrom < 0)
+                insert(layout);
+            else
+                ++stats.resumedCnt;
+            return true;
+        }
+
+        // retry runs at the start of a later frame, unless owner cancels it first; deferring again replaces it
+        void Defer(const void *owner, std::function<void()> retry);
+        void CancelDeferred(const void *owner);
+        // restores the frame's budget, unpins the layouts used in the previous frame and retries deferred updates
+        void BeginFrame();
+        void Clear();
+
+        uint32_t GetCapacity() const { return slots.GetCapacity(); }
+        uint32_t GetUsedCnt() const { return slots.GetUsedCnt(); }
+        uint32_t GetFrameBudget() const { return frameBudget; }
+        uint32_t GetBudgetLeft() const { return budgetLeft; }
+        size_t GetDeferredCnt() const { return deferred.size(); }
+        const Stats &GetStats() const { return stats; }
+        void ResetStats() { stats = Stats{}; }
+
+    private:
+        static TextLayoutCache *instance;
+
+        vke_ds::LRUSlotCache slots;
+        // indexed by slot
+        std::vector<TextLayout> layouts;
+        uint32_t frameBudget;
+        uint32_t budgetLeft;
+        Stats stats;
+        std::vector<const void *> deferredOrder;
+        std::unordered_map<const void *, std::function<void()>> deferred;
+
+        static uint32_t slotKey(const TextLayoutKey &key);
+        const TextLayout *find(const TextLayoutKey &key, std::string_view text, uint64_t glyphGeneration);
+        void insert(const TextLayout &layout);
+    };
+}
+
+#endif
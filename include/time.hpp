@@ -2,17 +2,175 @@
 #define TIME_H
 
 #include <common.hpp>
+#include <time_config.hpp>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 
 namespace vke_common
 {
+    // nanoseconds, enough for centuries of uptime; time is kept in ticks and converted on the way out
+    using ticks_t = uint64_t;
+    constexpr ticks_t TICKS_PER_SECOND = 1000000000;
+
+    inline double TicksToSeconds(ticks_t ticks)
+    {
+        return static_cast<double>(ticks) / TICKS_PER_SECOND;
+    }
+
+    inline ticks_t SecondsToTicks(double seconds)
+    {
+        return seconds > 0.0 ? static_cast<ticks_t>(std::llround(seconds * TICKS_PER_SECOND)) : 0;
+    }
+
+    // Where the time comes from, monotonic. Tests inject ManualTimeSource to make runs exact.
+    class TimeSource
+    {
+    public:
+        virtual ~TimeSource() {}
+        virtual ticks_t Now() = 0;
+        virtual void Sleep(ticks_t ticks) = 0;
+    };
+
+    class SteadyTimeSource : public TimeSource
+    {
+    public:
+        ticks_t Now() override;
+        void Sleep(ticks_t ticks) override;
+    };
+
+    // Time moves only when told to: Sleep advances it by exactly the time asked for plus
+    // oversleepTicks, and every Now advances it by nowStepTicks, so a spinning caller gets somewhere.
+    class ManualTimeSource : public TimeSource
+    {
+    public:
+        ticks_t now;
+        ticks_t nowStepTicks;
+        ticks_t oversleepTicks;
+
+        ManualTimeSource(ticks_t now = 0, ticks_t nowStepTicks = 0, ticks_t oversleepTicks = 0)
+            : now(now), nowStepTicks(nowStepTicks), oversleepTicks(oversleepTicks) {}
+
+        ticks_t Now() override
+        {
+            const ticks_t ret = now;
+            now += nowStepTicks;
+            return ret;
+        }
+
+        void Sleep(ticks_t ticks) override
+        {
+            now += ticks + oversleepTicks;
+        }
+
+        void Advance(ticks_t ticks)
+        {
+            now += ticks;
+        }
+    };
+
+    struct FixedStepStats
+    {
+        uint64_t stepCnt = 0;
+        // frames that owed more steps than maxStepsPerFrame
+        uint64_t clampedFrameCnt = 0;
+        ticks_t droppedTicks = 0;
+        uint32_t maxStepsInFrame = 0;
+    };
+
+    // Accumulates frame time in ticks and hands it out in steps of stepTicks, so the number of steps
+    // depends only on the frame times and never on rounding. The remainder gives the interpolation
+    // alpha between the last two steps.
+    class FixedStepper
+    {
+    public:
+        FixedStepper(ticks_t stepTicks, uint32_t maxStepsPerFrame)
+            : stepTicks(std::max<ticks_t>(stepTicks, 1)), maxStepsPerFrame(std::max(maxStepsPerFrame, 1u)), accumulator(0) {}
+
+        // the steps to run for a frame that took deltaTicks
+        uint32_t Advance(ticks_t deltaTicks)
+        {
+            accumulator += deltaTicks;
+            ticks_t stepCnt = accumulator / stepTicks;
+            if (stepCnt > maxStepsPerFrame)
+            {
+                // keep the remainder, the alpha stays continuous
+                const ticks_t dropped = (stepCnt - maxStepsPerFrame) * stepTicks;
+                accumulator -= dropped;
+                stats.droppedTicks += dropped;
+                ++stats.clampedFrameCnt;
+                stepCnt = maxStepsPerFrame;
+            }
+            accumulator -= stepCnt * stepTicks;
+            stats.stepCnt += stepCnt;
+            stats.maxStepsInFrame = std::max(stats.maxStepsInFrame, static_cast<uint32_t>(stepCnt));
+            return static_cast<uint32_t>(stepCnt);
+        }
+
+        // how far the current time is past the last step, in steps, [0, 1)
+        double GetAlpha() const
+        {
+            return static_cast<double>(accumulator) / static_cast<double>(stepTicks);
+        }
+
+        ticks_t GetStepTicks() const { return stepTicks; }
+        const FixedStepStats &GetStats() const { return stats; }
+
+    private:
+        ticks_t stepTicks;
+        uint32_t maxStepsPerFrame;
+        ticks_t accumulator;
+        FixedStepStats stats;
+    };
+
+    struct FramePacerStats
+    {
+        uint64_t pacedFrameCnt = 0;
+        // frames that ended past their deadline
+        uint64_t missedFrameCnt = 0;
+        ticks_t sleptTicks = 0;
+        ticks_t spunTicks = 0;
+    };
+
+    // Holds frames to a period. Deadlines advance by exactly one period, so short and long frames
+    // even out instead of drifting; a frame later than a whole period starts a new cadence.
+    class FramePacer
+    {
+    public:
+        FramePacer(TimeSource *source, ticks_t periodTicks, ticks_t spinTicks)
+            : source(source), periodTicks(periodTicks), spinTicks(spinTicks), deadline(0), started(false) {}
+
+        // waits for the end of the current frame and returns when the next one should start
+        ticks_t Pace();
+
+        bool IsEnabled() const { return periodTicks > 0; }
+        const FramePacerStats &GetStats() const { return stats; }
+
+    private:
+        TimeSource *source;
+        ticks_t periodTicks;
+        ticks_t spinTicks;
+        ticks_t deadline;
+        bool started;
+        FramePacerStats stats;
+    };
+
     class TimeManager
     {
     private:
         static TimeManager *instance;
-        TimeManager()
-            : frameStartTime(static_cast<float>(glfwGetTime())),
-              prevFrameStartTime(frameStartTime),
-              deltaTime(0.0f)
+        TimeManager(const TimeConfig &config, float fixedStepTime, float fixedDeltaTime, std::unique_ptr<TimeSource> &&timeSource)
+            : source(timeSource ? std::move(timeSource) : std::make_unique<SteadyTimeSource>()),
+              startTicks(source->Now()),
+              frameTicks(0),
+              prevFrameTicks(0),
+              deltaTicks(0),
+              fixedDeltaTicks(SecondsToTicks(fixedDeltaTime)),
+              frameCnt(0),
+              fixedStepper(SecondsToTicks(fixedStepTime), config.maxFixedStepsPerFrame),
+              framePacer(source.get(), config.targetFrameRate > 0.0f ? SecondsToTicks(1.0 / config.targetFrameRate) : 0,
+                         static_cast<ticks_t>(config.spinMicroseconds) * 1000),
+              fixedStepsThisFrame(0)
         {
         }
         ~TimeManager() {}
@@ -20,19 +178,30 @@ namespace vke_common
         TimeManager &operator=(const TimeManager);
 
     public:
-        float frameStartTime;
-        float prevFrameStartTime;
-        float deltaTime;
+        std::unique_ptr<TimeSource> source;
+        ticks_t startTicks;
+        // since Init
+        ticks_t frameTicks;
+        ticks_t prevFrameTicks;
+        ticks_t deltaTicks;
+        // > 0 advances the clock by exactly this much per frame instead of reading the time source
+        ticks_t fixedDeltaTicks;
+        uint64_t frameCnt;
+        FixedStepper fixedStepper;
+        FramePacer framePacer;
+        uint32_t fixedStepsThisFrame;
 
         static TimeManager *GetInstance()
         {
             return instance;
         }
 
-        static TimeManager *Init()
+        // fixedStepTime is the length of a FixedUpdate step; source defaults to the steady clock
+        static TimeManager *Init(const TimeConfig &config, float fixedStepTime, float fixedDeltaTime = 0.0f,
+                                 std::unique_ptr<TimeSource> &&source = nullptr)
         {
             if (instance == nullptr)
-                instance = new TimeManager();
+                instance = new TimeManager(config, fixedStepTime, fixedDeltaTime, std::move(source));
             return instance;
         }
 
@@ -44,28 +213,85 @@ namespace vke_common
             instance = nullptr;
         }
 
-        static void Update()
+        // starts a frame, after waiting for the frame pacer if it is on
+        static void Update();
+
+        // the FixedUpdate steps the frame owes, clamped to maxFixedStepsPerFrame; frames that do not
+        // call it, e.g. while paused, do not accumulate steps
+        static uint32_t AdvanceFixedSteps();
+
+        static bool IsFixedClock()
+        {
+            return instance->fixedDeltaTicks > 0;
+        }
+
+        static uint64_t GetFrameCount()
+        {
+            return instance->frameCnt;
+        }
+
+        static ticks_t GetTicks()
+        {
+            return instance->frameTicks;
+        }
+
+        static ticks_t GetDeltaTicks()
         {
-            instance->prevFrameStartTime = instance->frameStartTime;
-            instance->frameStartTime = static_cast<float>(glfwGetTime());
-            instance->deltaTime = instance->frameStartTime - instance->prevFrameStartTime;
+            return instance->deltaTicks;
         }
 
+        static double GetTimeSeconds()
+        {
+            return TicksToSeconds(instance->frameTicks);
+        }
+
+        static double GetDeltaTimeSeconds()
+        {
+            return TicksToSeconds(instance->deltaTicks);
+        }
+
+        // float accessors lose precision after hours of uptime, keep them to per frame use
         static float GetTime()
         {
-            return instance->frameStartTime;
+            return static_cast<float>(GetTimeSeconds());
         }
 
         static float GetDeltaTime()
         {
-            return instance->deltaTime;
+            return static_cast<float>(GetDeltaTimeSeconds());
         }
 
         static float GetPreviousFrameTime()
         {
-            return instance->prevFrameStartTime;
+            return static_cast<float>(TicksToSeconds(instance->prevFrameTicks));
+        }
+
+        static float GetFixedStepTime()
+        {
+            return static_cast<float>(TicksToSeconds(instance->fixedStepper.GetStepTicks()));
+        }
+
+        static uint32_t GetFixedStepCount()
+        {
+            return instance->fixedStepsThisFrame;
+        }
+
+        // where the frame falls between the last two fixed steps, for interpolating their results
+        static float GetFixedStepAlpha()
+        {
+            return static_cast<float>(instance->fixedStepper.GetAlpha());
+        }
+
+        static const FixedStepStats &GetFixedStepStats()
+        {
+            return instance->fixedStepper.GetStats();
+        }
+
+        static const FramePacerStats &GetFramePacerStats()
+        {
+            return instance->framePacer.GetStats();
         }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,32 @@
+#ifndef TIME_CONFIG_H
+#define TIME_CONFIG_H
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace vke_common
+{
+    struct TimeConfig
+    {
+        // frames per second the frame pacer holds the main loop to, 0 leaves pacing to the swapchain
+        float targetFrameRate = 0.0f;
+        // the pacer sleeps until this much of the frame is left and spins through the rest, since
+        // the OS wakes sleepers late by up to its timer granularity
+        uint32_t spinMicroseconds = 2000;
+        // fixed steps run in one frame at most; time beyond them is dropped, so a hitch does not make
+        // the next frame longer still
+        uint32_t maxFixedStepsPerFrame = 8;
+
+        void LoadJSON(const nlohmann::json &json)
+        {
+            if (json.is_null())
+                return;
+
+            targetFrameRate = json.value("targetFrameRate", targetFrameRate);
+            spinMicroseconds = json.value("spinMicroseconds", spinMicroseconds);
+            maxFixedStepsPerFrame = json.value("maxFixedStepsPerFrame", maxFixedStepsPerFrame);
+        }
+    };
+}
+
+#endif
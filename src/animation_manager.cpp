@@ -0,0 +1,123 @@
+#include <animation_manager.hpp>
+#include <render/render.hpp>
+#include <time.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace vke_common
+{
+    AnimationManager *AnimationManager::instance = nullptr;
+
+    static constexpr VkDeviceSize PALETTE_MATRIX_BYTES = sizeof(float) * 16;
+
+    AnimationManager *AnimationManager::Init(const AnimationConfig &config)
+    {
+        instance = new AnimationManager(config);
+        vke_render::ComputeSkinningManager *skinningManager = vke_render::Renderer::GetComputeSkinningManager();
+        if (skinningManager != nullptr)
+            skinningManager->SetPaletteDescriptorSets(instance->descriptorSets);
+        vke_render::Renderer::AddRenderUpdateCallback(RENDER_UPDATE_ID, [](uint32_t currentFrame)
+                                                      { instance->update(currentFrame); });
+        return instance;
+    }
+
+    void AnimationManager::Dispose()
+    {
+        vke_render::Renderer::RemoveRenderUpdateCallback(RENDER_UPDATE_ID);
+        delete instance;
+        instance = nullptr;
+    }
+
+    AnimationManager::AnimationManager(const AnimationConfig &config)
+        : system(config), paletteBuffers(vke_render::MAX_FRAMES_IN_FLIGHT), descriptorSets(vke_render::MAX_FRAMES_IN_FLIGHT)
+    {
+        VkDescriptorSetLayoutBinding layoutBinding{};
+        layoutBinding.binding = 0;
+        layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        layoutBinding.descriptorCount = 1;
+        layoutBinding.stageFlags = VK_SHADER_STAGE_ALL;
+        descriptorSetInfo.AddCnt(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1);
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &layoutBinding;
+        VKE_VK_CHECK(vkCreateDescriptorSetLayout(vke_render::globalLogicalDevice, &layoutInfo, nullptr, &(descriptorSetInfo.layout)),
+                     "failed to create bone palette descriptor set layout!")
+
+        for (uint32_t frame = 0; frame < vke_render::MAX_FRAMES_IN_FLIGHT; ++frame)
+        {
+            descriptorSets[frame] = vke_render::DescriptorSetAllocator::AllocateDescriptorSet(descriptorSetInfo);
+            reservePalette(frame);
+        }
+    }
+
+    void AnimationManager::writeDescriptorSet(uint32_t frame)
+    {
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = paletteBuffers[frame]->buffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet descriptorSetWrite{};
+        vke_render::ConstructDescriptorSetWrite(descriptorSetWrite, descriptorSets[frame], 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &bufferInfo);
+        vkUpdateDescriptorSets(vke_render::globalLogicalDevice, 1, &descriptorSetWrite, 0, nullptr);
+    }
+
+    void AnimationManager::reservePalette(uint32_t frame)
+    {
+        const VkDeviceSize size = std::max<VkDeviceSize>(system.GetPaletteSize(), ANIMATION_MAX_SKINNED_JOINTS) * PALETTE_MATRIX_BYTES;
+        std::unique_ptr<vke_render::HostCoherentBuffer> &buffer = paletteBuffers[frame];
+        if (buffer != nullptr && buffer->bufferSize >= size)
+            return;
+
+        // the frame's previous submission has completed, so its palette can be replaced right away;
+        // offsets are kept by the allocator, so only the frame's one descriptor set needs rewriting
+        buffer = std::make_unique<vke_render::HostCoherentBuffer>(std::bit_ceil(size), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        writeDescriptorSet(frame);
+    }
+
+    uint32_t AnimationManager::registerInstance(const AnimationInstanceDesc &desc, std::vector<vke_render::RenderUnit *> &&units)
+    {
+        const uint32_t id = system.AddInstance(desc);
+        if (id >= slots.size())
+            slots.resize(id + 1);
+
+        Slot &slot = slots[id];
+        if (slot.paletteOffset == nullptr)
+            slot.paletteOffset = std::make_unique<uint32_t>();
+        *slot.paletteOffset = system.GetPaletteOffset(id);
+        slot.units = std::move(units);
+        for (vke_render::RenderUnit *unit : slot.units)
+        {
+            unit->perUnitDescriptorSet = descriptorSets[0];
+            unit->pushConstantInfos.back().pValues = slot.paletteOffset.get();
+        }
+        return id;
+    }
+
+    void AnimationManager::unregisterInstance(uint32_t id)
+    {
+        // the range goes back to the palette allocator for the next instance that fits
+        system.RemoveInstance(id);
+        slots[id].units.clear();
+    }
+
+    void AnimationManager::update(uint32_t currentFrame)
+    {
+        if (system.GetInstanceCnt() == 0)
+            return;
+
+        // |projection[1][1]| is 1 / tan(fovy / 2) (negated for Vulkan's y flip), zero until a camera has been set
+        const vke_render::CameraInfo &camera = vke_render::Renderer::GetCameraInfo();
+        if (camera.projection[1][1] != 0.0f)
+            system.SetViewer(&camera.viewPos.x, std::abs(camera.projection[1][1]));
+
+        reservePalette(currentFrame);
+        system.Update(TimeManager::GetDeltaTime(), static_cast<float *>(paletteBuffers[currentFrame]->data));
+        for (Slot &slot : slots)
+            for (vke_render::RenderUnit *unit : slot.units)
+                unit->perUnitDescriptorSet = descriptorSets[currentFrame];
+    }
+}
@@ -0,0 +1,478 @@
+#include <animation_system.hpp>
+#include <logger.hpp>
+#include <ozz/animation/runtime/local_to_model_job.h>
+#include <ozz/base/maths/soa_float4x4.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace vke_common
+{
+    static void StoreMatrices(const ozz::math::Float4x4 *matrices, size_t cnt, float *dst)
+    {
+        for (size_t i = 0; i < cnt; ++i)
+            for (int j = 0; j < 4; ++j)
+                ozz::math::StorePtrU(matrices[i].cols[j], dst + (i << 4) + (j << 2));
+    }
+
+    static size_t SkinnedJointCnt(const AnimationInstanceDesc &desc)
+    {
+        return std::min<size_t>(desc.joints->size(), ANIMATION_MAX_SKINNED_JOINTS);
+    }
+
+    AnimationSystem::AnimationSystem(const AnimationConfig &config)
+        : config(config),
+          jobSystem(JobSystem::GetInstance()),
+          paletteAllocator(ANIMATION_PALETTE_ALIGNMENT), maxJointCnt(0), maxSoaJointCnt(0), maxTrackCnt(0), viewerPosition{0.0f, 0.0f, 0.0f}, viewerProjectionScale(1.0f), hasViewer(false)
+    {
+        const uint32_t workerCnt = jobSystem != nullptr ? jobSystem->GetWorkerCnt() : 1;
+        for (uint32_t i = 0; i < workerCnt; ++i)
+            scratches.push_back(std::make_unique<WorkerScratch>());
+    }
+
+    AnimationSystem::SkeletonInfo *AnimationSystem::acquireSkeletonInfo(const ozz::animation::Skeleton *skeleton)
+    {
+        std::unique_ptr<SkeletonInfo> &info = skeletonInfos[skeleton];
+        if (info != nullptr)
+        {
+            ++info->refCnt;
+            return info.get();
+        }
+
+        info = std::make_unique<SkeletonInfo>();
+        info->refCnt = 1;
+        const int jointCnt = skeleton->num_joints();
+        const ozz::span<const int16_t> parents = skeleton->joint_parents();
+
+        ozz::vector<ozz::math::Float4x4> restModels(jointCnt);
+        ozz::animation::LocalToModelJob ltmJob;
+        ltmJob.skeleton = skeleton;
+        ltmJob.input = skeleton->joint_rest_poses();
+        ltmJob.output = make_span(restModels);
+        if (!ltmJob.Run())
+            VKE_LOG_ERROR("Rest pose LocalToModelJob failed for a skeleton of {} joints ({} soa joints), bounds and joint reductions use an unset pose",
+                          jointCnt, skeleton->num_soa_joints())
+
+        int32_t maxDepth = 0;
+        info->depths.resize(jointCnt);
+        for (int j = 0; j < jointCnt; ++j)
+        {
+            info->depths[j] = parents[j] == ozz::animation::Skeleton::kNoParent ? 0 : info->depths[parents[j]] + 1;
+            maxDepth = std::max(maxDepth, info->depths[j]);
+            info->boundingRadius = std::max(info->boundingRadius, ozz::math::GetX(ozz::math::Length3(restModels[j].cols[3])));
+        }
+
+        // only depths that actually drop joints get a reduction, the rest use the plain local to model job
+        for (const AnimationLODLevel &level : config.lodLevels)
+        {
+            const int32_t depth = level.maxJointDepth;
+            if (depth < 0 || depth >= maxDepth || info->reductions.count(depth) != 0)
+                continue;
+
+            JointReduction &reduction = info->reductions[depth];
+            reduction.anchors.resize(jointCnt);
+            reduction.keptSoaJoints.assign(skeleton->num_soa_joints(), 0);
+            reduction.restOffsets.resize(jointCnt, ozz::math::Float4x4::identity());
+            for (int j = 0; j < jointCnt; ++j)
+            {
+                // parents come before their children, so the parent's anchor is already known
+                if (info->depths[j] <= depth)
+                {
+                    reduction.anchors[j] = static_cast<int16_t>(j);
+                    reduction.keptSoaJoints[j / 4] = 1;
+                    continue;
+                }
+                const int16_t anchor = reduction.anchors[parents[j]];
+                reduction.anchors[j] = anchor;
+                reduction.restOffsets[j] = ozz::math::Invert(restModels[anchor]) * restModels[j];
+            }
+        }
+        return info.get();
+    }
+
+    void AnimationSystem::releaseSkeletonInfo(const ozz::animation::Skeleton *skeleton)
+    {
+        // dropped with the last instance, a later skeleton may be allocated at the same address
+        auto it = skeletonInfos.find(skeleton);
+        if (--it->second->refCnt == 0)
+            skeletonInfos.erase(it);
+    }
+
+    uint32_t AnimationSystem::AddInstance(const AnimationInstanceDesc &desc)
+    {
+        const uint32_t id = idAllocator.Alloc();
+        if (desc.joints->size() > ANIMATION_MAX_SKINNED_JOINTS)
+            VKE_LOG_WARN("Animation instance {} skins a mesh with {} joints (skeleton of {}), its palette range only holds the first {}",
+                         id, desc.joints->size(), desc.skeleton->num_joints(), ANIMATION_MAX_SKINNED_JOINTS)
+        if (id >= instances.size())
+            instances.resize(id + 1);
+        Instance &instance = instances[id];
+        instance = Instance{};
+        instance.desc = desc;
+        instance.skeletonInfo = acquireSkeletonInfo(desc.skeleton);
+        instance.alive = true;
+        instance.paletteJointCnt = static_cast<uint32_t>(std::max<size_t>(SkinnedJointCnt(desc), 1));
+        instance.paletteOffset = paletteAllocator.Alloc(instance.paletteJointCnt);
+        active.push_back(id);
+
+        // scratch buffers only grow here, never while workers are running
+        maxJointCnt = std::max(maxJointCnt, desc.skeleton->num_joints());
+        maxSoaJointCnt = std::max(maxSoaJointCnt, std::max(desc.skeleton->num_soa_joints(), desc.animation->num_soa_tracks()));
+        maxTrackCnt = std::max(maxTrackCnt, desc.animation->num_tracks());
+        for (auto &scratch : scratches)
+        {
+            if (scratch->locals.size() < static_cast<size_t>(maxSoaJointCnt))
+                scratch->locals.resize(maxSoaJointCnt);
+            if (scratch->models.size() < static_cast<size_t>(maxJointCnt))
+                scratch->models.resize(maxJointCnt);
+            if (scratch->skinning.size() < ANIMATION_MAX_SKINNED_JOINTS)
+                scratch->skinning.resize(ANIMATION_MAX_SKINNED_JOINTS);
+            if (scratch->context.max_tracks() < maxTrackCnt)
+                scratch->context.Resize(maxTrackCnt);
+        }
+        return id;
+    }
+
+    void AnimationSystem::RemoveInstance(uint32_t id)
+    {
+        if (id >= instances.size() || !instances[id].alive)
+            return;
+        Instance &instance = instances[id];
+        instance.alive = false;
+        releaseSkeletonInfo(instance.desc.skeleton);
+        paletteAllocator.Free(instance.paletteOffset, instance.paletteJointCnt);
+        instance.skeletonInfo = nullptr;
+        instance.prevKey = ozz::vector<ozz::math::Float4x4>();
+        instance.nextKey = ozz::vector<ozz::math::Float4x4>();
+        active.erase(std::find(active.begin(), active.end(), id));
+        idAllocator.Free(id);
+    }
+
+    void AnimationSystem::SetTimeRatio(uint32_t id, float ratio)
+    {
+        AnimationPlayback &playback = instances[id].playback;
+        playback.timeRatio = playback.loop ? ratio - std::floor(ratio) : std::clamp(ratio, 0.0f, 1.0f);
+    }
+
+    void AnimationSystem::SetViewer(const float position[3], float projectionScale)
+    {
+        std::copy(position, position + 3, viewerPosition);
+        viewerProjectionScale = projectionScale;
+        hasViewer = true;
+    }
+
+    void AnimationSystem::selectLOD(Instance &instance)
+    {
+        instance.lod = 0;
+        if (config.enableLOD && !config.lodLevels.empty() && hasViewer && instance.desc.worldMatrix != nullptr)
+        {
+            const float *m = instance.desc.worldMatrix;
+            const float dx = m[12] - viewerPosition[0];
+            const float dy = m[13] - viewerPosition[1];
+            const float dz = m[14] - viewerPosition[2];
+            const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+            const float scale = std::sqrt(std::max({m[0] * m[0] + m[1] * m[1] + m[2] * m[2],
+                                                    m[4] * m[4] + m[5] * m[5] + m[6] * m[6],
+                                                    m[8] * m[8] + m[9] * m[9] + m[10] * m[10]}));
+            const float radius = instance.skeletonInfo->boundingRadius * scale;
+            const float screenSize = distance > 0.0f ? radius * viewerProjectionScale / distance : FLT_MAX;
+
+            const uint32_t levelCnt = static_cast<uint32_t>(config.lodLevels.size());
+            instance.lod = levelCnt - 1;
+            for (uint32_t i = 0; i < levelCnt; ++i)
+                if (distance <= config.lodLevels[i].maxDistance && screenSize >= config.lodLevels[i].minScreenSize)
+                {
+                    instance.lod = i;
+                    break;
+                }
+        }
+
+        if (config.enableLOD && !config.lodLevels.empty())
+        {
+            const AnimationLODLevel &level = config.lodLevels[instance.lod];
+            instance.updateInterval = std::max(1u, level.updateInterval);
+            instance.maxJointDepth = level.maxJointDepth;
+        }
+        else
+        {
+            instance.updateInterval = 1;
+            instance.maxJointDepth = -1;
+        }
+    }
+
+    float AnimationSystem::advancedRatio(const AnimationPlayback &playback, float duration, float seconds) const
+    {
+        if (!playback.playing)
+            return playback.timeRatio;
+        const float ratio = playback.timeRatio + seconds * playback.playbackSpeed / duration;
+        return playback.loop ? ratio - std::floor(ratio) : std::clamp(ratio, 0.0f, 1.0f);
+    }
+
+    void AnimationSystem::addKeyEvaluations(uint32_t id, float deltaTime)
+    {
+        Instance &instance = instances[id];
+        const size_t jointCnt = SkinnedJointCnt(instance.desc);
+        if (!instance.hasKeys)
+        {
+            instance.prevKey.resize(jointCnt);
+            instance.nextKey.resize(jointCnt);
+            evaluations.push_back({id, instance.playback.timeRatio, instance.prevKey.data()});
+            instance.hasKeys = true;
+        }
+        else
+            std::swap(instance.prevKey, instance.nextKey);
+
+        // the next key is where playback will be once the interval has passed at the current frame time
+        instance.framesSinceKey = 0;
+        const float seconds = deltaTime * instance.updateInterval;
+        evaluations.push_back({id, advancedRatio(instance.playback, instance.desc.animation->duration(), seconds), instance.nextKey.data()});
+    }
+
+    void AnimationSystem::shareEvaluations()
+    {
+        struct ShareKey
+        {
+            const void *skeleton;
+            const void *animation;
+            const void *joints;
+            const void *invBindMatrices;
+            int32_t maxJointDepth;
+            int64_t tick;
+
+            bool operator==(const ShareKey &other) const
+            {
+                return skeleton == other.skeleton && animation == other.animation && joints == other.joints &&
+                       invBindMatrices == other.invBindMatrices && maxJointDepth == other.maxJointDepth && tick == other.tick;
+            }
+        };
+        struct ShareKeyHash
+        {
+            size_t operator()(const ShareKey &key) const
+            {
+                size_t hash = std::hash<const void *>()(key.skeleton);
+                for (size_t value : {std::hash<const void *>()(key.animation), std::hash<const void *>()(key.joints),
+                                     std::hash<const void *>()(key.invBindMatrices), std::hash<int32_t>()(key.maxJointDepth),
+                                     std::hash<int64_t>()(key.tick)})
+                    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                return hash;
+            }
+        };
+
+        std::unordered_map<ShareKey, uint32_t, ShareKeyHash> poses;
+        std::vector<Evaluation> leaders;
+        for (const Evaluation &evaluation : evaluations)
+        {
+            const Instance &instance = instances[evaluation.instance];
+            const AnimationInstanceDesc &desc = instance.desc;
+            const float quantum = std::max(config.poseShareQuantum, 1e-6f);
+            const ShareKey key{desc.skeleton, desc.animation, desc.joints, desc.invBindMatrices, instance.maxJointDepth,
+                               static_cast<int64_t>(std::floor(evaluation.timeRatio * desc.animation->duration() / quantum))};
+            const auto [it, inserted] = poses.try_emplace(key, static_cast<uint32_t>(leaders.size()));
+            if (inserted)
+            {
+                if (sharedPoses.size() <= it->second)
+                    sharedPoses.emplace_back();
+                sharedPoses[it->second].resize(SkinnedJointCnt(desc));
+                leaders.push_back({evaluation.instance, evaluation.timeRatio, sharedPoses[it->second].data()});
+            }
+            sharedCopies.push_back({evaluation.instance, it->second, evaluation.output});
+        }
+        stats.shared = static_cast<uint32_t>(evaluations.size() - leaders.size());
+        evaluations.swap(leaders);
+    }
+
+    template <typename Fn>
+    void AnimationSystem::parallelFor(uint32_t cnt, Fn &&fn)
+    {
+        if (cnt == 0)
+            return;
+
+        if (jobSystem == nullptr)
+        {
+            for (uint32_t i = 0; i < cnt; ++i)
+                fn(i, 0u);
+            return;
+        }
+
+        // a few tasks per worker keeps the load balanced when skeletons differ in size
+        const uint32_t workerCnt = GetWorkerCnt();
+        const uint32_t taskSize = std::max(config.minInstancesPerTask, (cnt + workerCnt * 4 - 1) / (workerCnt * 4));
+        jobSystem->ParallelFor(cnt, taskSize, [&](uint32_t begin, uint32_t end, uint32_t worker)
+                               {
+            // a thread the job system does not own runs every task itself
+            const uint32_t scratchIndex = worker == JobSystem::INVALID_WORKER ? 0 : worker;
+            for (uint32_t i = begin; i < end; ++i)
+                fn(i, scratchIndex); });
+    }
+
+    void AnimationSystem::localToModel(const Instance &instance, WorkerScratch &scratch)
+    {
+        const ozz::animation::Skeleton *skeleton = instance.desc.skeleton;
+        const auto reduction = instance.maxJointDepth < 0 ? instance.skeletonInfo->reductions.end()
+                                                          : instance.skeletonInfo->reductions.find(instance.maxJointDepth);
+        if (reduction == instance.skeletonInfo->reductions.end())
+        {
+            ozz::animation::LocalToModelJob ltmJob;
+            ltmJob.skeleton = skeleton;
+            ltmJob.input = ozz::span<const ozz::math::SoaTransform>(scratch.locals.data(), skeleton->num_soa_joints());
+            ltmJob.output = ozz::span<ozz::math::Float4x4>(scratch.models.data(), skeleton->num_joints());
+            if (!ltmJob.Run())
+                VKE_LOG_ERROR("LocalToModelJob failed for a skeleton of {} joints ({} soa joints), worker scratch holds {} soa locals and {} model matrices",
+                              skeleton->num_joints(), skeleton->num_soa_joints(), scratch.locals.size(), scratch.models.size())
+            return;
+        }
+
+        // same walk as LocalToModelJob, except dropped joints reuse their anchor's matrix with the rest offset
+        // and soa groups without a kept joint skip the local matrix build entirely
+        const JointReduction &joints = reduction->second;
+        const ozz::span<const int16_t> parents = skeleton->joint_parents();
+        const int jointCnt = skeleton->num_joints();
+        ozz::math::Float4x4 *models = scratch.models.data();
+        ozz::math::Float4x4 locals[4];
+        for (int soa = 0; soa < skeleton->num_soa_joints(); ++soa)
+        {
+            if (joints.keptSoaJoints[soa])
+            {
+                const ozz::math::SoaTransform &transform = scratch.locals[soa];
+                const ozz::math::SoaFloat4x4 soaMatrices = ozz::math::SoaFloat4x4::FromAffine(transform.translation, transform.rotation, transform.scale);
+                ozz::math::Transpose16x16(&soaMatrices.cols[0].x, locals->cols);
+            }
+
+            const int end = std::min(jointCnt, (soa + 1) * 4);
+            for (int j = soa * 4; j < end; ++j)
+            {
+                const int anchor = joints.anchors[j];
+                if (anchor != j)
+                    models[j] = models[anchor] * joints.restOffsets[j];
+                else if (parents[j] == ozz::animation::Skeleton::kNoParent)
+                    models[j] = locals[j & 3];
+                else
+                    models[j] = models[parents[j]] * locals[j & 3];
+            }
+        }
+    }
+
+    void AnimationSystem::evaluate(const Instance &instance, float timeRatio, WorkerScratch &scratch)
+    {
+        const AnimationInstanceDesc &desc = instance.desc;
+
+        // the context is shared by every instance a worker evaluates, it resets itself when the animation changes
+        ozz::animation::SamplingJob samplingJob;
+        samplingJob.animation = desc.animation;
+        samplingJob.context = &scratch.context;
+        samplingJob.ratio = timeRatio;
+        samplingJob.output = ozz::span<ozz::math::SoaTransform>(scratch.locals.data(), desc.animation->num_soa_tracks());
+        if (!samplingJob.Run())
+            VKE_LOG_ERROR("SamplingJob failed at ratio {} for an animation of {} soa tracks, worker scratch holds {} soa transforms and a context for {} tracks",
+                          timeRatio, desc.animation->num_soa_tracks(), scratch.locals.size(), scratch.context.max_tracks())
+
+        localToModel(instance, scratch);
+
+        const std::vector<int> &joints = *desc.joints;
+        const std::vector<ozz::math::Float4x4> &invBindMatrices = *desc.invBindMatrices;
+        const size_t jointCnt = SkinnedJointCnt(desc);
+        for (size_t i = 0; i < jointCnt; ++i)
+        {
+            const ozz::math::Float4x4 &model = scratch.models[joints[i]];
+            scratch.skinning[i] = i < invBindMatrices.size() ? model * invBindMatrices[i] : model;
+        }
+    }
+
+    void AnimationSystem::interpolate(const Instance &instance, float *palette) const
+    {
+        // a linear blend of the two key palettes, close enough to a pose blend over a few frames
+        const ozz::math::SimdFloat4 alpha = ozz::math::simd_float4::Load1(
+            std::min(1.0f, static_cast<float>(instance.framesSinceKey) / instance.updateInterval));
+        for (size_t i = 0; i < instance.nextKey.size(); ++i)
+            for (int j = 0; j < 4; ++j)
+                ozz::math::StorePtrU(ozz::math::Lerp(instance.prevKey[i].cols[j], instance.nextKey[i].cols[j], alpha),
+                                     palette + (i << 4) + (j << 2));
+    }
+
+    void AnimationSystem::Update(float deltaTime, float *palette)
+    {
+        stats = AnimationStats{};
+        evaluations.clear();
+        throttled.clear();
+        throttledDue.clear();
+        sharedCopies.clear();
+
+        for (uint32_t id : active)
+        {
+            Instance &instance = instances[id];
+            if (instance.playback.playing)
+                SetTimeRatio(id, instance.playback.timeRatio + deltaTime * instance.playback.playbackSpeed / instance.desc.animation->duration());
+
+            // throttled instances only change LOD on a key frame, so an interpolation always runs to its end
+            if (instance.hasKeys && ++instance.framesSinceKey < instance.updateInterval)
+            {
+                throttled.push_back(id);
+                continue;
+            }
+            selectLOD(instance);
+            if (instance.updateInterval == 1)
+            {
+                instance.hasKeys = false;
+                evaluations.push_back({id, instance.playback.timeRatio, nullptr});
+                continue;
+            }
+            throttled.push_back(id);
+            throttledDue.push_back(id);
+        }
+
+        // over budget, instances without keys go first (they have nothing to show yet), then the most overdue
+        uint32_t dueCnt = static_cast<uint32_t>(throttledDue.size());
+        if (config.maxThrottledUpdatesPerFrame > 0 && dueCnt > config.maxThrottledUpdatesPerFrame)
+        {
+            auto priority = [this](uint32_t id)
+            {
+                const Instance &instance = instances[id];
+                return instance.hasKeys ? static_cast<int64_t>(instance.framesSinceKey) - instance.updateInterval : INT64_MAX;
+            };
+            std::nth_element(throttledDue.begin(), throttledDue.begin() + config.maxThrottledUpdatesPerFrame, throttledDue.end(),
+                             [&](uint32_t a, uint32_t b)
+                             { return priority(a) > priority(b); });
+            dueCnt = config.maxThrottledUpdatesPerFrame;
+            for (uint32_t i = dueCnt; i < throttledDue.size(); ++i)
+                if (!instances[throttledDue[i]].hasKeys)
+                    throttledDue[dueCnt++] = throttledDue[i];
+            stats.deferred = static_cast<uint32_t>(throttledDue.size()) - dueCnt;
+        }
+        for (uint32_t i = 0; i < dueCnt; ++i)
+            addKeyEvaluations(throttledDue[i], deltaTime);
+
+        stats.evaluations = static_cast<uint32_t>(evaluations.size());
+        if (config.sharePoses)
+        {
+            shareEvaluations();
+            stats.evaluations = static_cast<uint32_t>(evaluations.size());
+        }
+
+        parallelFor(static_cast<uint32_t>(evaluations.size()), [&](uint32_t i, uint32_t worker)
+                    {
+            const Evaluation &evaluation = evaluations[i];
+            const Instance &instance = instances[evaluation.instance];
+            WorkerScratch &scratch = *scratches[worker];
+            evaluate(instance, evaluation.timeRatio, scratch);
+            const size_t jointCnt = SkinnedJointCnt(instance.desc);
+            if (evaluation.output != nullptr)
+                std::copy(scratch.skinning.begin(), scratch.skinning.begin() + jointCnt, evaluation.output);
+            else
+                StoreMatrices(scratch.skinning.data(), jointCnt, palette + (static_cast<size_t>(GetPaletteOffset(evaluation.instance)) << 4)); });
+
+        parallelFor(static_cast<uint32_t>(sharedCopies.size()), [&](uint32_t i, uint32_t)
+                    {
+            const SharedCopy &copy = sharedCopies[i];
+            const ozz::vector<ozz::math::Float4x4> &pose = sharedPoses[copy.pose];
+            if (copy.output != nullptr)
+                std::copy(pose.begin(), pose.end(), copy.output);
+            else
+                StoreMatrices(pose.data(), pose.size(), palette + (static_cast<size_t>(GetPaletteOffset(copy.instance)) << 4)); });
+
+        stats.interpolated = static_cast<uint32_t>(throttled.size());
+        parallelFor(stats.interpolated, [&](uint32_t i, uint32_t)
+                    {
+            const uint32_t id = throttled[i];
+            interpolate(instances[id], palette + (static_cast<size_t>(GetPaletteOffset(id)) << 4)); });
+    }
+}
@@ -9,10 +9,11 @@ namespace vke_common
 {
     AssetManager *AssetManager::instance = nullptr;
 
-    AssetManager *AssetManager::Init()
+    AssetManager *AssetManager::Init(const std::string &fontAtlasCacheDir)
     {
         instance = new AssetManager();
         instance->ftLibrary = nullptr;
+        instance->fontAtlasCacheDir = fontAtlasCacheDir;
         for (int i = 0; i < ASSET_CNT_FLAG; i++)
             instance->ids[i] = CUSTOM_ASSET_ID_ST;
         instance->ids[ASSET_SCENE] = 1;
@@ -21,6 +22,13 @@ namespace vke_common
         return instance;
     }
 
+    void AssetManager::EndFontFrame()
+    {
+        for (auto &kv : instance->fontCache)
+            if (kv.second.val != nullptr)
+                kv.second.val->EndFrame();
+    }
+
     AssetHandle AssetManager::AllocateAssetID(AssetType type)
     {
         return instance->ids[type]++;
@@ -97,38 +97,70 @@ namespace vke_common
     void Scene::loadComponent(const vke_ds::id32_t id, const entt::entity entity,
                               const nlohmann::json &component)
     {
-        Transform &transform = registry.get<Transform>(entity);
+        bool valid = false;
+        ComponentType type = ComponentTypeFromName(component["type"].get<std::string>(), valid);
+        if (valid)
+            loadComponent(type, entity, component);
+    }
 
-        std::string type = component["type"];
-        if (type == "camera")
-        {
-            registry.emplace<vke_component::Camera>(entity, transform, component);
-        }
-        else if (type == "renderableObject")
+    void Scene::reserveComponents(ComponentType type, size_t cnt)
+    {
+        switch (type)
         {
-            registry.emplace<vke_component::RenderableObject>(entity, transform, component);
+        case ComponentType::Camera:
+            registry.storage<vke_component::Camera>().reserve(cnt);
+            break;
+        case ComponentType::RenderableObject:
+            registry.storage<vke_component::RenderableObject>().reserve(cnt);
+            break;
+        case ComponentType::SkeletonAnimator:
+            registry.storage<vke_component::SkeletonAnimator>().reserve(cnt);
+            break;
+        case ComponentType::RigidBody:
+            registry.storage<vke_component::RigidBody>().reserve(cnt);
+            break;
+        case ComponentType::Sensor:
+            registry.storage<vke_component::Sensor>().reserve(cnt);
+            break;
+        case ComponentType::CharacterController:
+            registry.storage<vke_component::CharacterController>().reserve(cnt);
+            break;
+        case ComponentType::UIText:
+            registry.storage<vke_component::UIText>().reserve(cnt);
+            break;
+        default:
+            break;
         }
-        else if (type == "uiText")
+    }
+
+    void Scene::loadComponent(ComponentType type, const entt::entity entity, const nlohmann::json &component)
+    {
+        Transform &transform = registry.get<Transform>(entity);
+
+        switch (type)
         {
+        case ComponentType::Camera:
+            registry.emplace<vke_component::Camera>(entity, transform, component);
+            break;
+        case ComponentType::RenderableObject:
+            registry.emplace<vke_component::RenderableObject>(entity, transform, component, registry.get<GameObject>(entity).isStatic);
+            break;
+        case ComponentType::UIText:
             registry.emplace<vke_component::UIText>(entity, transform, component, glyphs.get());
-        }
-        else if (type == "animator")
-        {
+            break;
+        case ComponentType::SkeletonAnimator:
             registry.emplace<vke_component::SkeletonAnimator>(entity, transform, component);
-        }
-        else if (type == "rigidbody")
-        {
+            break;
+        case ComponentType::RigidBody:
             registry.emplace<vke_component::RigidBody>(entity, transform, component);
-        }
-        else if (type == "sensor")
-        {
+            break;
+        case ComponentType::Sensor:
             registry.emplace<vke_component::Sensor>(entity, transform, component);
-        }
-        else if (type == "characterController")
-        {
+            break;
+        case ComponentType::CharacterController:
             registry.emplace<vke_component::CharacterController>(entity, transform, component);
-        }
-        else if (type == "directionalLight")
+            break;
+        case ComponentType::DirectionalLight:
         {
             auto &color = component["color"];
             float intensity = component["intensity"];
@@ -137,8 +169,9 @@ namespace vke_common
                 vke_render::DirectionalLight(
                     glm::vec4(glm::normalize(TransformForward(transform)), 0.0f),
                     glm::vec4(color[0], color[1], color[2], intensity)));
+            break;
         }
-        else if (type == "pointLight")
+        case ComponentType::PointLight:
         {
             auto &color = component["color"];
             float radius = component["radius"];
@@ -148,8 +181,9 @@ namespace vke_common
                 vke_render::PointLight(
                     glm::vec4(transform.GetGlobalPosition(), radius),
                     glm::vec4(color[0], color[1], color[2], intensity)));
+            break;
         }
-        else if (type == "spotLight")
+        case ComponentType::SpotLight:
         {
             auto &color = component["color"];
             float radius = component["radius"];
@@ -164,11 +198,16 @@ namespace vke_common
                     glm::vec4(glm::normalize(TransformForward(transform)), 0.0f),
                     glm::vec4(color[0], color[1], color[2], intensity),
                     glm::vec4(glm::cos(innerCone), glm::cos(outerCone), castShadow ? 1.0f : 0.0f, 0.0f)));
+            break;
         }
-        else if (type == "script")
+        case ComponentType::Script:
         {
             vke_component::ScriptState scriptState(component);
             csharpScriptStates[entity].emplace(scriptState.className, std::move(scriptState));
+            break;
+        }
+        default:
+            break;
         }
     }
 
@@ -0,0 +1,169 @@
+#include <component_mirror.hpp>
+#include <component/transform.hpp>
+#include <component/rigidbody.hpp>
+#include <component/character_controller.hpp>
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/Body/BodyLockMulti.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+namespace vke_common
+{
+    ComponentMirror *ComponentMirror::instance = nullptr;
+
+    static const uint32_t EMPTY_ENTITY = static_cast<uint32_t>(static_cast<entt::entity>(entt::null));
+
+    static inline uint32_t GetEntityIndex(entt::entity entity)
+    {
+        return static_cast<uint32_t>(entt::to_entity(entity));
+    }
+
+    static inline vke_interop::Vector3<float> ToInterop(const glm::vec3 &value)
+    {
+        return vke_interop::Vector3<float>{value.x, value.y, value.z};
+    }
+
+    static inline vke_interop::Vector3<float> ToInterop(const JPH::Vec3 &value)
+    {
+        return vke_interop::Vector3<float>{value.GetX(), value.GetY(), value.GetZ()};
+    }
+
+    ComponentMirror *ComponentMirror::GetInstance()
+    {
+        return instance;
+    }
+
+    ComponentMirror *ComponentMirror::Init()
+    {
+        if (instance == nullptr)
+        {
+            instance = new ComponentMirror();
+            instance->view.entityIndexMask = static_cast<uint32_t>(entt::entt_traits<entt::entity>::entity_mask);
+        }
+        return instance;
+    }
+
+    void ComponentMirror::Dispose()
+    {
+        delete instance;
+        instance = nullptr;
+    }
+
+    void ComponentMirror::beginWrite()
+    {
+        std::atomic_ref<uint64_t>(view.generation).fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    void ComponentMirror::endWrite()
+    {
+        std::atomic_ref<uint64_t>(view.generation).fetch_add(1, std::memory_order_release);
+    }
+
+    void ComponentMirror::reserve(uint32_t capacity)
+    {
+        if (capacity <= entities.size())
+            return;
+
+        // grow geometrically so the arrays (and the pointers handed to managed code) stay put across most frames
+        capacity = std::max<uint32_t>(std::bit_ceil(capacity), 64);
+        entities.resize(capacity, EMPTY_ENTITY);
+        flags.resize(capacity, 0);
+        worldPositions.resize(capacity);
+        worldRotations.resize(capacity);
+        linearVelocities.resize(capacity);
+        angularVelocities.resize(capacity);
+
+        view.capacity = capacity;
+        view.entities = entities.data();
+        view.flags = flags.data();
+        view.worldPositions = worldPositions.data();
+        view.worldRotations = worldRotations.data();
+        view.linearVelocities = linearVelocities.data();
+        view.angularVelocities = angularVelocities.data();
+    }
+
+    void ComponentMirror::clear()
+    {
+        beginWrite();
+        std::fill(entities.begin(), entities.end(), EMPTY_ENTITY);
+        std::fill(flags.begin(), flags.end(), 0);
+        endWrite();
+    }
+
+    void ComponentMirror::refresh(entt::registry &registry)
+    {
+        auto &transforms = registry.storage<Transform>();
+
+        uint32_t requiredCapacity = 0;
+        for (entt::entity entity : transforms)
+            requiredCapacity = std::max(requiredCapacity, GetEntityIndex(entity) + 1);
+
+        beginWrite();
+        reserve(requiredCapacity);
+        std::fill(entities.begin(), entities.end(), EMPTY_ENTITY);
+        std::fill(flags.begin(), flags.end(), 0);
+
+        const vke_interop::Vector3<float> zero{0.0f, 0.0f, 0.0f};
+        for (entt::entity entity : transforms)
+        {
+            const uint32_t index = GetEntityIndex(entity);
+            const Transform &transform = transforms.get(entity);
+            const glm::quat rotation = transform.GetGlobalRotation();
+            entities[index] = static_cast<uint32_t>(entity);
+            flags[index] = vke_interop::COMPONENT_MIRROR_VALID;
+            worldPositions[index] = ToInterop(transform.GetGlobalPosition());
+            worldRotations[index] = vke_interop::Quaternion<float>{rotation.x, rotation.y, rotation.z, rotation.w};
+            linearVelocities[index] = zero;
+            angularVelocities[index] = zero;
+        }
+
+        bodyIndices.clear();
+        bodyIDs.clear();
+        auto rigidBodyView = registry.view<Transform, vke_component::RigidBody>();
+        for (entt::entity entity : rigidBodyView)
+        {
+            const vke_component::RigidBody &rigidBody = rigidBodyView.get<vke_component::RigidBody>(entity);
+            if (rigidBody.bodyID.IsInvalid())
+                continue;
+            bodyIndices.push_back(GetEntityIndex(entity));
+            bodyIDs.push_back(rigidBody.bodyID.GetIndexAndSequenceNumber());
+        }
+
+        if (!bodyIDs.empty())
+        {
+            // one lock pass for every body in the scene instead of a BodyLockRead per body
+            JPH::BodyLockMultiRead lock(vke_physics::PhysicsManager::GetPhysicsSystem().GetBodyLockInterface(),
+                                        reinterpret_cast<const JPH::BodyID *>(bodyIDs.data()), static_cast<int>(bodyIDs.size()));
+            for (size_t i = 0; i < bodyIDs.size(); ++i)
+            {
+                const JPH::Body *body = lock.GetBody(static_cast<int>(i));
+                if (body == nullptr)
+                    continue;
+                const uint32_t index = bodyIndices[i];
+                flags[index] |= vke_interop::COMPONENT_MIRROR_HAS_RIGIDBODY;
+                if (body->IsActive())
+                    flags[index] |= vke_interop::COMPONENT_MIRROR_BODY_ACTIVE;
+                linearVelocities[index] = ToInterop(body->GetLinearVelocity());
+                angularVelocities[index] = ToInterop(body->GetAngularVelocity());
+            }
+        }
+
+        auto controllerView = registry.view<Transform, vke_component::CharacterController>();
+        for (entt::entity entity : controllerView)
+        {
+            const uint32_t index = GetEntityIndex(entity);
+            flags[index] |= vke_interop::COMPONENT_MIRROR_HAS_CHARACTER_CONTROLLER;
+            linearVelocities[index] = ToInterop(controllerView.get<vke_component::CharacterController>(entity).GetLinearVelocity());
+        }
+        endWrite();
+    }
+}
+
+namespace vke_interop
+{
+    const ComponentMirrorView *VKE_INTEROP_CDECL GetComponentMirrorView()
+    {
+        return vke_common::ComponentMirror::GetView();
+    }
+}
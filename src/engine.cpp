@@ -16,35 +16,71 @@ namespace vke_common
         }
 
         vke_common::TimeManager::Update();
+        vke_common::JobSystem::GetInstance()->RunMainThreadJobs();
+        // events posted by jobs and other threads since the last frame
+        vke_common::EventSystem::DispatchQueued();
+        // last frame's glyphs have been uploaded by its render, or never will be when rendering is off
+        vke_common::AssetManager::EndFontFrame();
+        vke_common::TextLayoutCache::GetInstance()->BeginFrame();
 
         if (state == EngineState::Paused)
         {
-            vke_render::Renderer::GetInstance()->Update();
+            updateRenderer();
             vke_common::InputManager::EndFrame();
             return true;
         }
 
-        vke_common::ScriptManager::GetInstance()->Update();
-        fixedUpdateAccumulator += vke_common::TimeManager::GetDeltaTime();
-        const float fixedStepTime = vke_physics::PhysicsManager::GetConfig().stepTime;
-        while (fixedUpdateAccumulator >= fixedStepTime)
-        {
+        vke_common::ScriptManager::Update(vke_common::TimeManager::GetDeltaTime());
+        const uint32_t fixedStepCnt = vke_common::TimeManager::AdvanceFixedSteps();
+        for (uint32_t i = 0; i < fixedStepCnt; ++i)
             FixedUpdate();
-            fixedUpdateAccumulator -= fixedStepTime;
-        }
-        vke_render::Renderer::GetInstance()->Update();
+        // contacts and whatever else the physics steps posted
+        vke_common::EventSystem::DispatchQueued();
+        vke_physics::PhysicsManager::MaintainBroadPhase();
+        refreshComponentMirror();
+        updateRenderer();
         vke_common::InputManager::EndFrame();
         return true;
     }
 
     void Engine::FixedUpdate()
     {
-        vke_common::ScriptManager::FixedUpdate();
+        vke_common::ScriptManager::FixedUpdate(vke_physics::PhysicsManager::GetConfig().stepTime);
         vke_physics::PhysicsManager::FixedUpdate();
     }
 
+    void Engine::refreshComponentMirror()
+    {
+        Scene *scene = SceneManager::GetInstance()->currentScene.get();
+        if (scene != nullptr)
+            ComponentMirror::Refresh(scene->registry);
+        else
+            ComponentMirror::Clear();
+    }
+
+    void Engine::updateRenderer()
+    {
+        if (renderFrames)
+            vke_render::Renderer::GetInstance()->Update();
+        else
+            vke_render::Renderer::GetInstance()->UpdateWithoutRendering();
+    }
+
+    void Engine::RunHeadless(uint32_t frameCnt)
+    {
+        for (uint32_t frame = 0; frameCnt == 0 || frame < frameCnt; ++frame)
+            if (!Update())
+                break;
+        vkDeviceWaitIdle(vke_render::globalLogicalDevice);
+    }
+
     void Engine::MainLoop()
     {
+        if (vke_render::RenderEnvironment::IsHeadless())
+        {
+            RunHeadless(0);
+            return;
+        }
         while (!glfwWindowShouldClose(vke_render::RenderEnvironment::GetInstance()->window))
         {
             glfwPollEvents();
@@ -0,0 +1,370 @@
+#include <font_atlas_baker.hpp>
+#include <logger.hpp>
+#include <mapped_file.hpp>
+#include <job_system.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+
+namespace vke_common
+{
+    struct FontAtlasCacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t glyphCnt;
+        uint32_t reserved;
+    };
+
+    // followed by the glyph bitmaps, width * height bytes each, in record order
+    struct FontAtlasCacheGlyph
+    {
+        uint32_t codepoint;
+        uint32_t glyphIndex;
+        int32_t width;
+        int32_t height;
+        int32_t bearingX;
+        int32_t bearingY;
+        int32_t advanceX;
+        uint32_t slotIndex;
+    };
+
+    static uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+    {
+        // FNV-1a
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        return hash;
+    }
+
+    template <typename T>
+    static uint64_t HashValue(uint64_t hash, const T &value)
+    {
+        return HashBytes(hash, &value, sizeof(T));
+    }
+
+    bool RasterizeSDFGlyph(FT_Face face, uint32_t codepoint, RasterizedGlyph &out)
+    {
+        const uint32_t glyphIndex = FT_Get_Char_Index(face, codepoint);
+        if (glyphIndex == 0 && codepoint != 0)
+            return false;
+
+        FT_Error error = FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT);
+        if (error != FT_Err_Ok)
+            return false;
+
+        out.glyph.codepoint = codepoint;
+        out.glyph.glyphIndex = glyphIndex;
+        out.glyph.advanceX = static_cast<int>(face->glyph->advance.x >> 6);
+        if (face->glyph->format == FT_GLYPH_FORMAT_OUTLINE && face->glyph->outline.n_contours == 0)
+            return true;
+
+        // Bitmap-to-SDF is more robust for complex and intersecting outlines.
+        error = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+        if (error == FT_Err_Ok)
+            error = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF);
+        if (error != FT_Err_Ok)
+            return false;
+
+        FT_GlyphSlot ftGlyph = face->glyph;
+        const FT_Bitmap &bitmap = ftGlyph->bitmap;
+        if (bitmap.width > FONT_ATLAS_SLOT_SIZE || bitmap.rows > FONT_ATLAS_SLOT_SIZE)
+        {
+            VKE_LOG_WARN("SDF glyph U+{:04X} is {}x{} and does not fit a {}x{} atlas slot",
+                         codepoint, bitmap.width, bitmap.rows, FONT_ATLAS_SLOT_SIZE, FONT_ATLAS_SLOT_SIZE)
+            return false;
+        }
+
+        out.glyph.width = static_cast<int>(bitmap.width);
+        out.glyph.height = static_cast<int>(bitmap.rows);
+        out.glyph.bearingX = ftGlyph->bitmap_left;
+        out.glyph.bearingY = ftGlyph->bitmap_top;
+        if (bitmap.width == 0 || bitmap.rows == 0)
+            return true;
+
+        out.bitmap.resize(static_cast<size_t>(bitmap.width) * bitmap.rows);
+        const int pitch = bitmap.pitch;
+        for (uint32_t row = 0; row < bitmap.rows; ++row)
+        {
+            const uint32_t sourceRow = pitch >= 0 ? row : bitmap.rows - 1 - row;
+            const uint8_t *source = bitmap.buffer + static_cast<ptrdiff_t>(sourceRow) * std::abs(pitch);
+            std::copy_n(source, bitmap.width, out.bitmap.data() + static_cast<size_t>(row) * bitmap.width);
+        }
+        return true;
+    }
+
+    void PlaceGlyph(Glyph &glyph, GlyphAtlasType atlasType, uint32_t slotIndex)
+    {
+        const uint32_t slotsPerRow = FONT_ATLAS_SIZE / FONT_ATLAS_SLOT_SIZE;
+        const uint32_t slotX = (slotIndex % slotsPerRow) * FONT_ATLAS_SLOT_SIZE;
+        const uint32_t slotY = (slotIndex / slotsPerRow) * FONT_ATLAS_SLOT_SIZE;
+        glyph.atlasX = static_cast<int>(slotX) + (static_cast<int>(FONT_ATLAS_SLOT_SIZE) - glyph.width) / 2;
+        glyph.atlasY = static_cast<int>(slotY) + (static_cast<int>(FONT_ATLAS_SLOT_SIZE) - glyph.height) / 2;
+        glyph.atlasType = atlasType;
+        glyph.slotIndex = slotIndex;
+    }
+
+    void ClearAtlasSlot(std::vector<uint8_t> &atlas, uint32_t slotIndex)
+    {
+        const uint32_t slotsPerRow = FONT_ATLAS_SIZE / FONT_ATLAS_SLOT_SIZE;
+        const uint32_t slotX = (slotIndex % slotsPerRow) * FONT_ATLAS_SLOT_SIZE;
+        const uint32_t slotY = (slotIndex / slotsPerRow) * FONT_ATLAS_SLOT_SIZE;
+        for (uint32_t row = 0; row < FONT_ATLAS_SLOT_SIZE; ++row)
+        {
+            std::fill_n(atlas.data() + static_cast<size_t>(slotY + row) * FONT_ATLAS_SIZE + slotX,
+                        FONT_ATLAS_SLOT_SIZE, uint8_t(0));
+        }
+    }
+
+    void BlitGlyph(const RasterizedGlyph &glyph, std::vector<uint8_t> &atlas)
+    {
+        for (int row = 0; row < glyph.glyph.height; ++row)
+        {
+            std::copy_n(glyph.bitmap.data() + static_cast<size_t>(row) * glyph.glyph.width,
+                        glyph.glyph.width,
+                        atlas.data() + static_cast<size_t>(glyph.glyph.atlasY + row) * FONT_ATLAS_SIZE + glyph.glyph.atlasX);
+        }
+    }
+
+    StaticAtlasBaker::StaticAtlasBaker(FT_Face face, const std::string &fontPath, uint32_t pixelSize)
+        : face(face), fontPath(fontPath), pixelSize(pixelSize) {}
+
+    void StaticAtlasBaker::Bake(const std::vector<uint32_t> &codepoints, const std::string &cacheDir, JobSystem *jobSystem,
+                                std::vector<Glyph> &glyphs, std::vector<uint8_t> &pixels)
+    {
+        std::string cachePath;
+        uint64_t cacheKey = 0;
+        if (!cacheDir.empty())
+        {
+            cacheKey = ComputeCacheKey(codepoints);
+            cachePath = GetCachePath(cacheDir, cacheKey);
+            if (LoadCache(cachePath, cacheKey, glyphs, pixels))
+                return;
+        }
+
+        BakeUncached(codepoints, jobSystem, glyphs, pixels);
+        if (!cachePath.empty() && !SaveCache(cachePath, cacheKey, glyphs, pixels))
+            VKE_LOG_WARN("Failed to write font atlas cache {}", cachePath)
+    }
+
+    // A face per job system worker, indexed by worker index. The baking worker keeps the main face,
+    // the others get a library and face of their own, closed again when the bake is done.
+    class WorkerFaces
+    {
+    public:
+        WorkerFaces(FT_Face face, const std::string &fontPath, uint32_t pixelSize, uint32_t workerCnt, uint32_t ownerIndex)
+            : faces(workerCnt, nullptr), ownerIndex(ownerIndex)
+        {
+            // opened the same way the asset loader opens the main face
+            faces[ownerIndex] = face;
+            for (uint32_t i = 0; i < workerCnt && ready; ++i)
+            {
+                if (i == ownerIndex)
+                    continue;
+                FT_Library library = nullptr;
+                FT_Face workerFace = nullptr;
+                ready = FT_Init_FreeType(&library) == FT_Err_Ok;
+                if (!ready)
+                    break;
+                libraries.push_back(library);
+                ready = FT_New_Face(library, fontPath.c_str(), face->face_index, &workerFace) == FT_Err_Ok;
+                if (!ready)
+                    break;
+                faces[i] = workerFace;
+                if (workerFace->charmap == nullptr)
+                    FT_Select_Charmap(workerFace, FT_ENCODING_UNICODE);
+                ready = FT_Set_Pixel_Sizes(workerFace, 0, pixelSize) == FT_Err_Ok;
+            }
+        }
+
+        ~WorkerFaces()
+        {
+            for (size_t i = 0; i < faces.size(); ++i)
+                if (i != ownerIndex && faces[i] != nullptr)
+                    FT_Done_Face(faces[i]);
+            for (FT_Library library : libraries)
+                FT_Done_FreeType(library);
+        }
+
+        bool IsReady() const { return ready; }
+        FT_Face Get(uint32_t workerIndex) const { return faces[workerIndex]; }
+
+    private:
+        std::vector<FT_Library> libraries;
+        std::vector<FT_Face> faces;
+        uint32_t ownerIndex;
+        bool ready = true;
+    };
+
+    void StaticAtlasBaker::BakeUncached(const std::vector<uint32_t> &codepoints, JobSystem *jobSystem,
+                                        std::vector<Glyph> &glyphs, std::vector<uint8_t> &pixels)
+    {
+        glyphs.clear();
+        pixels.assign(static_cast<size_t>(FONT_ATLAS_SIZE) * FONT_ATLAS_SIZE, 0);
+
+        std::unique_ptr<WorkerFaces> workerFaces;
+        const uint32_t workerIndex = jobSystem != nullptr ? jobSystem->GetWorkerIndex() : JobSystem::INVALID_WORKER;
+        if (workerIndex != JobSystem::INVALID_WORKER && jobSystem->GetWorkerCnt() > 1 && codepoints.size() > 1)
+        {
+            workerFaces = std::make_unique<WorkerFaces>(face, fontPath, pixelSize, jobSystem->GetWorkerCnt(), workerIndex);
+            if (!workerFaces->IsReady())
+            {
+                VKE_LOG_WARN("Failed to open per-thread faces of {}, baking its atlas serially", fontPath)
+                workerFaces.reset();
+            }
+        }
+
+        std::vector<RasterizedGlyph> batch;
+        std::vector<uint8_t> baked;
+        size_t next = 0;
+        uint32_t slot = 0;
+        // a batch never holds more codepoints than free slots, so skipped ones are made up by the next batch
+        while (slot < FONT_ATLAS_SLOT_COUNT && next < codepoints.size())
+        {
+            const uint32_t batchSize = static_cast<uint32_t>(std::min<size_t>(FONT_ATLAS_SLOT_COUNT - slot, codepoints.size() - next));
+            batch.assign(batchSize, RasterizedGlyph{});
+            baked.assign(batchSize, 0);
+            if (workerFaces != nullptr)
+                jobSystem->ParallelFor(batchSize, 1, [&](uint32_t begin, uint32_t end, uint32_t worker)
+                                       {
+                    for (uint32_t task = begin; task < end; ++task)
+                        baked[task] = RasterizeSDFGlyph(workerFaces->Get(worker), codepoints[next + task], batch[task]); });
+            else
+                for (uint32_t task = 0; task < batchSize; ++task)
+                    baked[task] = RasterizeSDFGlyph(face, codepoints[next + task], batch[task]);
+
+            for (uint32_t task = 0; task < batchSize; ++task)
+            {
+                if (!baked[task])
+                    continue;
+                PlaceGlyph(batch[task].glyph, GlyphAtlasType::STATIC_ATLAS, slot++);
+                BlitGlyph(batch[task], pixels);
+                glyphs.push_back(batch[task].glyph);
+            }
+            next += batchSize;
+        }
+    }
+
+    uint64_t StaticAtlasBaker::ComputeCacheKey(const std::vector<uint32_t> &codepoints) const
+    {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        hash = HashValue(hash, FONT_ATLAS_CACHE_VERSION);
+        MappedFile file;
+        if (file.Open(fontPath))
+            hash = HashBytes(hash, file.GetBytes().data(), file.GetBytes().size());
+
+        // anything that changes the baked pixels has to change the key
+        const uint32_t parameters[] = {pixelSize, FONT_ATLAS_SIZE, FONT_ATLAS_SLOT_SIZE, static_cast<uint32_t>(FONT_SDF_SPREAD),
+                                       static_cast<uint32_t>(face->face_index), FREETYPE_MAJOR, FREETYPE_MINOR, FREETYPE_PATCH};
+        hash = HashBytes(hash, parameters, sizeof(parameters));
+        return HashBytes(hash, codepoints.data(), codepoints.size() * sizeof(uint32_t));
+    }
+
+    std::string StaticAtlasBaker::GetCachePath(const std::string &cacheDir, uint64_t cacheKey) const
+    {
+        char key[17];
+        std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(cacheKey));
+        const std::string stem = std::filesystem::path(fontPath).stem().string();
+        return (std::filesystem::path(cacheDir) / (stem + "_" + std::to_string(pixelSize) + "_" + key + ".vkfa")).string();
+    }
+
+    bool StaticAtlasBaker::LoadCache(const std::string &cachePath, uint64_t cacheKey,
+                                     std::vector<Glyph> &glyphs, std::vector<uint8_t> &pixels) const
+    {
+        MappedFile file;
+        if (!file.Open(cachePath))
+            return false;
+        const std::span<const uint8_t> bytes = file.GetBytes();
+        if (bytes.size() < sizeof(FontAtlasCacheHeader))
+            return false;
+
+        FontAtlasCacheHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (header.magic != FONT_ATLAS_CACHE_MAGIC || header.version != FONT_ATLAS_CACHE_VERSION ||
+            header.key != cacheKey || header.glyphCnt > FONT_ATLAS_SLOT_COUNT)
+            return false;
+
+        size_t offset = sizeof(header);
+        const size_t bitmapOffset = offset + static_cast<size_t>(header.glyphCnt) * sizeof(FontAtlasCacheGlyph);
+        if (bytes.size() < bitmapOffset)
+            return false;
+
+        std::vector<Glyph> cachedGlyphs(header.glyphCnt);
+        std::vector<uint8_t> cachedPixels(static_cast<size_t>(FONT_ATLAS_SIZE) * FONT_ATLAS_SIZE, 0);
+        size_t bitmapEnd = bitmapOffset;
+        for (Glyph &glyph : cachedGlyphs)
+        {
+            FontAtlasCacheGlyph record;
+            std::memcpy(&record, bytes.data() + offset, sizeof(record));
+            offset += sizeof(record);
+            if (record.width < 0 || record.height < 0 || record.width > static_cast<int32_t>(FONT_ATLAS_SLOT_SIZE) ||
+                record.height > static_cast<int32_t>(FONT_ATLAS_SLOT_SIZE) || record.slotIndex >= FONT_ATLAS_SLOT_COUNT)
+                return false;
+
+            glyph.codepoint = record.codepoint;
+            glyph.glyphIndex = record.glyphIndex;
+            glyph.width = record.width;
+            glyph.height = record.height;
+            glyph.bearingX = record.bearingX;
+            glyph.bearingY = record.bearingY;
+            glyph.advanceX = record.advanceX;
+            PlaceGlyph(glyph, GlyphAtlasType::STATIC_ATLAS, record.slotIndex);
+
+            const size_t bitmapSize = static_cast<size_t>(glyph.width) * glyph.height;
+            if (bytes.size() - bitmapEnd < bitmapSize)
+                return false;
+            for (int row = 0; row < glyph.height; ++row)
+                std::memcpy(cachedPixels.data() + static_cast<size_t>(glyph.atlasY + row) * FONT_ATLAS_SIZE + glyph.atlasX,
+                            bytes.data() + bitmapEnd + static_cast<size_t>(row) * glyph.width, glyph.width);
+            bitmapEnd += bitmapSize;
+        }
+
+        glyphs = std::move(cachedGlyphs);
+        pixels = std::move(cachedPixels);
+        return true;
+    }
+
+    bool StaticAtlasBaker::SaveCache(const std::string &cachePath, uint64_t cacheKey,
+                                     const std::vector<Glyph> &glyphs, const std::vector<uint8_t> &pixels) const
+    {
+        std::vector<uint8_t> bytes(sizeof(FontAtlasCacheHeader) + glyphs.size() * sizeof(FontAtlasCacheGlyph));
+        const FontAtlasCacheHeader header{FONT_ATLAS_CACHE_MAGIC, FONT_ATLAS_CACHE_VERSION, cacheKey,
+                                          static_cast<uint32_t>(glyphs.size()), 0};
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        size_t offset = sizeof(header);
+        for (const Glyph &glyph : glyphs)
+        {
+            const FontAtlasCacheGlyph record{glyph.codepoint, glyph.glyphIndex, glyph.width, glyph.height,
+                                             glyph.bearingX, glyph.bearingY, glyph.advanceX, glyph.slotIndex};
+            std::memcpy(bytes.data() + offset, &record, sizeof(record));
+            offset += sizeof(record);
+            for (int row = 0; row < glyph.height; ++row)
+            {
+                const uint8_t *source = pixels.data() + static_cast<size_t>(glyph.atlasY + row) * FONT_ATLAS_SIZE + glyph.atlasX;
+                bytes.insert(bytes.end(), source, source + glyph.width);
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+        // written aside and renamed, so a concurrent or interrupted load never sees half a file
+        const std::string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream ofs(tempPath, std::ios::binary | std::ios::trunc);
+            if (!ofs.is_open())
+                return false;
+            ofs.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!ofs.good())
+                return false;
+        }
+        std::filesystem::rename(tempPath, cachePath, error);
+        return !error;
+    }
+}
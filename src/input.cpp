@@ -15,7 +15,8 @@ namespace vke_common
           mousePosition(0.0f, 0.0f),
           mouseDelta(0.0f, 0.0f),
           scrollDelta(0.0f, 0.0f),
-          hasMousePosition(false)
+          hasMousePosition(false),
+          cursorMode(GLFW_CURSOR_NORMAL)
     {
     }
 
@@ -31,6 +32,9 @@ namespace vke_common
         instance->mousePosition = glm::vec2(0.0f, 0.0f);
         instance->hasMousePosition = false;
 
+        // headless runs have no window, input only arrives through the callbacks called directly
+        if (window == nullptr)
+            return instance;
         glfwSetKeyCallback(window, &InputManager::KeyCallback);
         glfwSetCursorPosCallback(window, &InputManager::CursorPosCallback);
         glfwSetMouseButtonCallback(window, &InputManager::MouseButtonCallback);
@@ -184,12 +188,16 @@ namespace vke_common
 
     void InputManager::SetCursorMode(int mode)
     {
-        glfwSetInputMode(RequireInstance().window, GLFW_CURSOR, mode);
+        InputManager &input = RequireInstance();
+        input.cursorMode = mode;
+        if (input.window != nullptr)
+            glfwSetInputMode(input.window, GLFW_CURSOR, mode);
     }
 
     int InputManager::GetCursorMode()
     {
-        return glfwGetInputMode(RequireInstance().window, GLFW_CURSOR);
+        InputManager &input = RequireInstance();
+        return input.window != nullptr ? glfwGetInputMode(input.window, GLFW_CURSOR) : input.cursorMode;
     }
 
     InputManager &InputManager::RequireInstance()
@@ -0,0 +1,220 @@
+#include <interop/batch.hpp>
+#include <physics/physics.hpp>
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/Body/BodyLockMulti.h>
+#include <scene.hpp>
+#include <vector>
+
+namespace vke_interop
+{
+    static_assert(sizeof(JPH::BodyID) == sizeof(uint32_t), "BodyID must stay a plain 32 bit index for batch interop");
+
+    static vke_common::Scene *GetCurrentScene()
+    {
+        return vke_common::SceneManager::GetInstance()->currentScene.get();
+    }
+
+    static inline entt::entity GetEntity(uint32_t entity)
+    {
+        return static_cast<entt::entity>(entity);
+    }
+
+    static inline const JPH::BodyID *ToBodyIDs(const uint32_t *bodyIDs)
+    {
+        return reinterpret_cast<const JPH::BodyID *>(bodyIDs);
+    }
+
+    static inline glm::vec3 ToGlm(const Vector3<float> &value)
+    {
+        return glm::vec3(value.x, value.y, value.z);
+    }
+
+    static inline glm::quat ToGlm(const Quaternion<float> &value)
+    {
+        return glm::normalize(glm::quat(value.w, value.x, value.y, value.z));
+    }
+
+    static inline Vector3<float> ToInterop(const glm::vec3 &value)
+    {
+        return Vector3<float>{value.x, value.y, value.z};
+    }
+
+    static inline Quaternion<float> ToInterop(const glm::quat &value)
+    {
+        return Quaternion<float>{value.x, value.y, value.z, value.w};
+    }
+
+    static inline Vector3<float> ToInterop(const JPH::Vec3 &value)
+    {
+        return Vector3<float>{value.GetX(), value.GetY(), value.GetZ()};
+    }
+
+    static inline JPH::Vec3 ToJoltVec3(const Vector3<float> &value)
+    {
+        return JPH::Vec3(value.x, value.y, value.z);
+    }
+
+    template <typename Fn>
+    static void ForEachTransform(const uint32_t *entities, uint32_t count, Fn &&fn)
+    {
+        vke_common::Scene *scene = GetCurrentScene();
+        if (scene == nullptr || entities == nullptr || count == 0)
+            return;
+
+        // resolve the component pool once instead of once per entity
+        auto &transforms = scene->registry.storage<vke_common::Transform>();
+        for (uint32_t i = 0; i < count; ++i)
+            fn(i, transforms.get(GetEntity(entities[i])));
+    }
+
+    template <typename Fn>
+    static void ForEachTransformEntity(const uint32_t *entities, uint32_t count, Fn &&fn)
+    {
+        vke_common::Scene *scene = GetCurrentScene();
+        if (scene == nullptr || entities == nullptr || count == 0)
+            return;
+
+        for (uint32_t i = 0; i < count; ++i)
+            fn(i, scene->transformSystem, GetEntity(entities[i]));
+    }
+
+    template <typename Fn>
+    static void ForEachBodyRead(const uint32_t *bodyIDs, uint32_t count, Fn &&fn)
+    {
+        if (bodyIDs == nullptr || count == 0)
+            return;
+
+        // one lock pass for the whole batch instead of a BodyLockRead per body
+        JPH::BodyLockMultiRead lock(vke_physics::PhysicsManager::GetPhysicsSystem().GetBodyLockInterface(), ToBodyIDs(bodyIDs), static_cast<int>(count));
+        for (uint32_t i = 0; i < count; ++i)
+            fn(i, lock.GetBody(static_cast<int>(i)));
+    }
+
+    template <typename Fn>
+    static void ForEachBodyWrite(const uint32_t *bodyIDs, uint32_t count, Fn &&fn)
+    {
+        if (bodyIDs == nullptr || count == 0)
+            return;
+
+        static thread_local std::vector<JPH::BodyID> bodiesToActivate;
+        bodiesToActivate.clear();
+        {
+            JPH::BodyLockMultiWrite lock(vke_physics::PhysicsManager::GetPhysicsSystem().GetBodyLockInterface(), ToBodyIDs(bodyIDs), static_cast<int>(count));
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                JPH::Body *body = lock.GetBody(static_cast<int>(i));
+                if (body != nullptr && fn(i, *body) && !body->IsActive())
+                    bodiesToActivate.push_back(body->GetID());
+            }
+        }
+
+        // activation takes the body locks again, so it has to happen after the multi lock is released
+        if (!bodiesToActivate.empty())
+            vke_physics::PhysicsManager::GetBodyInterface().ActivateBodies(bodiesToActivate.data(), static_cast<int>(bodiesToActivate.size()));
+    }
+
+    void VKE_INTEROP_CDECL GetTransformLocalPositions(const uint32_t *entities, uint32_t count, Vector3<float> *positions)
+    {
+        ForEachTransform(entities, count, [positions](uint32_t i, const vke_common::Transform &transform)
+                         { positions[i] = ToInterop(transform.localPosition); });
+    }
+
+    void VKE_INTEROP_CDECL SetTransformLocalPositions(const uint32_t *entities, uint32_t count, const Vector3<float> *positions)
+    {
+        ForEachTransformEntity(entities, count, [positions](uint32_t i, vke_common::SceneTransformSystem &system, entt::entity entity)
+                               { system.SetLocalPosition(entity, ToGlm(positions[i])); });
+    }
+
+    void VKE_INTEROP_CDECL GetTransformLocalRotations(const uint32_t *entities, uint32_t count, Quaternion<float> *rotations)
+    {
+        ForEachTransform(entities, count, [rotations](uint32_t i, const vke_common::Transform &transform)
+                         { rotations[i] = ToInterop(transform.localRotation); });
+    }
+
+    void VKE_INTEROP_CDECL SetTransformLocalRotations(const uint32_t *entities, uint32_t count, const Quaternion<float> *rotations)
+    {
+        ForEachTransformEntity(entities, count, [rotations](uint32_t i, vke_common::SceneTransformSystem &system, entt::entity entity)
+                               { system.SetLocalRotation(entity, ToGlm(rotations[i])); });
+    }
+
+    void VKE_INTEROP_CDECL GetTransformLocalScales(const uint32_t *entities, uint32_t count, Vector3<float> *scales)
+    {
+        ForEachTransform(entities, count, [scales](uint32_t i, const vke_common::Transform &transform)
+                         { scales[i] = ToInterop(transform.localScale); });
+    }
+
+    void VKE_INTEROP_CDECL SetTransformLocalScales(const uint32_t *entities, uint32_t count, const Vector3<float> *scales)
+    {
+        ForEachTransformEntity(entities, count, [scales](uint32_t i, vke_common::SceneTransformSystem &system, entt::entity entity)
+                               { system.SetLocalScale(entity, ToGlm(scales[i])); });
+    }
+
+    void VKE_INTEROP_CDECL GetTransformGlobalPositions(const uint32_t *entities, uint32_t count, Vector3<float> *positions)
+    {
+        ForEachTransform(entities, count, [positions](uint32_t i, const vke_common::Transform &transform)
+                         { positions[i] = ToInterop(transform.GetGlobalPosition()); });
+    }
+
+    void VKE_INTEROP_CDECL GetTransformGlobalRotations(const uint32_t *entities, uint32_t count, Quaternion<float> *rotations)
+    {
+        ForEachTransform(entities, count, [rotations](uint32_t i, const vke_common::Transform &transform)
+                         { rotations[i] = ToInterop(transform.GetGlobalRotation()); });
+    }
+
+    void VKE_INTEROP_CDECL TranslateTransformsGlobal(const uint32_t *entities, uint32_t count, const Vector3<float> *deltas)
+    {
+        ForEachTransformEntity(entities, count, [deltas](uint32_t i, vke_common::SceneTransformSystem &system, entt::entity entity)
+                               { system.TranslateGlobal(entity, ToGlm(deltas[i])); });
+    }
+
+    void VKE_INTEROP_CDECL GetBodyPositionsAndRotations(const uint32_t *bodyIDs, uint32_t count, Vector3<float> *positions, Quaternion<float> *rotations)
+    {
+        ForEachBodyRead(bodyIDs, count, [positions, rotations](uint32_t i, const JPH::Body *body)
+                        {
+                            if (body == nullptr)
+                            {
+                                positions[i] = Vector3<float>{0.0f, 0.0f, 0.0f};
+                                rotations[i] = Quaternion<float>{0.0f, 0.0f, 0.0f, 1.0f};
+                                return;
+                            }
+                            const JPH::RVec3 position = body->GetPosition();
+                            const JPH::Quat rotation = body->GetRotation();
+                            positions[i] = Vector3<float>{static_cast<float>(position.GetX()), static_cast<float>(position.GetY()), static_cast<float>(position.GetZ())};
+                            rotations[i] = Quaternion<float>{rotation.GetX(), rotation.GetY(), rotation.GetZ(), rotation.GetW()}; });
+    }
+
+    void VKE_INTEROP_CDECL GetBodyLinearVelocities(const uint32_t *bodyIDs, uint32_t count, Vector3<float> *linearVelocities)
+    {
+        ForEachBodyRead(bodyIDs, count, [linearVelocities](uint32_t i, const JPH::Body *body)
+                        { linearVelocities[i] = body == nullptr ? Vector3<float>{0.0f, 0.0f, 0.0f} : ToInterop(body->GetLinearVelocity()); });
+    }
+
+    void VKE_INTEROP_CDECL SetBodyLinearVelocities(const uint32_t *bodyIDs, uint32_t count, const Vector3<float> *linearVelocities)
+    {
+        // mirrors BodyInterface::SetLinearVelocity: static bodies are skipped, moving sleepers are woken up
+        ForEachBodyWrite(bodyIDs, count, [linearVelocities](uint32_t i, JPH::Body &body)
+                         {
+                             if (body.IsStatic())
+                                 return false;
+                             const JPH::Vec3 velocity = ToJoltVec3(linearVelocities[i]);
+                             body.SetLinearVelocityClamped(velocity);
+                             return !velocity.IsNearZero(); });
+    }
+
+    void VKE_INTEROP_CDECL GetBodyAngularVelocities(const uint32_t *bodyIDs, uint32_t count, Vector3<float> *angularVelocities)
+    {
+        ForEachBodyRead(bodyIDs, count, [angularVelocities](uint32_t i, const JPH::Body *body)
+                        { angularVelocities[i] = body == nullptr ? Vector3<float>{0.0f, 0.0f, 0.0f} : ToInterop(body->GetAngularVelocity()); });
+    }
+
+    void VKE_INTEROP_CDECL SetBodyAngularVelocities(const uint32_t *bodyIDs, uint32_t count, const Vector3<float> *angularVelocities)
+    {
+        ForEachBodyWrite(bodyIDs, count, [angularVelocities](uint32_t i, JPH::Body &body)
+                         {
+                             if (body.IsStatic())
+                                 return false;
+                             const JPH::Vec3 velocity = ToJoltVec3(angularVelocities[i]);
+                             body.SetAngularVelocityClamped(velocity);
+                             return !velocity.IsNearZero(); });
+    }
+}
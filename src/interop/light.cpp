@@ -18,15 +18,15 @@ namespace vke_interop
     }
 
     template <vke_render::AllowedLightType T>
-    static void MarkLightDirty()
+    static void MarkLightDirty(uint32_t entity)
     {
-        vke_render::Renderer::GetInstance()->lightManager->MarkDirty<T>();
+        vke_render::Renderer::GetInstance()->lightManager->MarkDirty<T>(ToEntity(entity));
     }
 
     static void UpdateSpotLight(uint32_t entity, vke_render::SpotLight &light)
     {
         auto *lightManager = vke_render::Renderer::GetInstance()->lightManager.get();
-        lightManager->MarkDirty<vke_render::SpotLight>();
+        lightManager->MarkDirty<vke_render::SpotLight>(ToEntity(entity));
         if (light.CastShadow())
             lightManager->UpdateSpotShadow(ToEntity(entity));
     }
@@ -53,7 +53,7 @@ namespace vke_interop
         auto &light = GetLightWithoutCheckByEntity<T>(entity);
         glm::vec3 rgb = ToGlm(*color);
         light.colorWithIntensity = glm::vec4(rgb, light.colorWithIntensity.w);
-        MarkLightDirty<T>();
+        MarkLightDirty<T>(entity);
     }
 
     template <vke_render::AllowedLightType T>
@@ -66,7 +66,7 @@ namespace vke_interop
     static void SetLightIntensity(uint32_t entity, float intensity)
     {
         GetLightWithoutCheckByEntity<T>(entity).colorWithIntensity.w = intensity;
-        MarkLightDirty<T>();
+        MarkLightDirty<T>(entity);
     }
 
     void VKE_INTEROP_CDECL GetDirectionalLightColor(uint32_t entity, Vector3<float> *color)
@@ -117,7 +117,7 @@ namespace vke_interop
     void VKE_INTEROP_CDECL SetPointLightRadius(uint32_t entity, float radius)
     {
         GetLightWithoutCheckByEntity<vke_render::PointLight>(entity).positionWithRadius.w = radius;
-        MarkLightDirty<vke_render::PointLight>();
+        MarkLightDirty<vke_render::PointLight>(entity);
     }
 
     void VKE_INTEROP_CDECL GetSpotLightColor(uint32_t entity, Vector3<float> *color)
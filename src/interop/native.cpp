@@ -238,120 +238,146 @@ namespace vke_interop
     }
 }
 
+namespace vke_interop
+{
+    const NativeFunctions &GetNativeFunctions()
+    {
+        static const NativeFunctions nativeFunctions{
+            &GetTransformLocalPosition,
+            &SetTransformLocalPosition,
+            &GetTransformLocalRotation,
+            &SetTransformLocalRotation,
+            &GetTransformLocalScale,
+            &SetTransformLocalScale,
+            &TranslateTransformLocal,
+            &TranslateTransformGlobal,
+            &RotateTransformLocal,
+            &RotateTransformGlobal,
+            &ScaleTransform,
+            &IsKeyDown,
+            &IsKeyPressed,
+            &IsKeyReleased,
+            &IsMouseButtonDown,
+            &IsMouseButtonPressed,
+            &IsMouseButtonReleased,
+            &GetMousePosition,
+            &GetMouseDelta,
+            &GetMouseScrollDelta,
+            &SetCursorMode,
+            &GetCursorMode,
+            &GetTime,
+            &GetDeltaTime,
+            &GetPreviousFrameTime,
+            &SetEngineState,
+            &HasComponent,
+            &GetUITextLength,
+            &GetUITextText,
+            &SetUITextText,
+            &GetUITextColor,
+            &SetUITextColor,
+            &GetDirectionalLightColor,
+            &SetDirectionalLightColor,
+            &GetDirectionalLightIntensity,
+            &SetDirectionalLightIntensity,
+            &GetPointLightColor,
+            &SetPointLightColor,
+            &GetPointLightIntensity,
+            &SetPointLightIntensity,
+            &GetPointLightRadius,
+            &SetPointLightRadius,
+            &GetSpotLightColor,
+            &SetSpotLightColor,
+            &GetSpotLightIntensity,
+            &SetSpotLightIntensity,
+            &GetSpotLightRadius,
+            &SetSpotLightRadius,
+            &GetSpotLightInnerCone,
+            &SetSpotLightInnerCone,
+            &GetSpotLightOuterCone,
+            &SetSpotLightOuterCone,
+            &SetCharacterControllerVelocity,
+            &GetCharacterControllerVelocity,
+            &IsCharacterControllerGrounded,
+            &GetRigidBodyBodyID,
+            &GetSensorBodyID,
+            &ActivateBody,
+            &DeactivateBody,
+            &IsBodyActive,
+            &SetBodyObjectLayer,
+            &GetBodyObjectLayer,
+            &SetBodyRestitution,
+            &GetBodyRestitution,
+            &SetBodyFriction,
+            &GetBodyFriction,
+            &SetBodyGravityFactor,
+            &GetBodyGravityFactor,
+            &GetBodyCenterOfMassPosition,
+            &MoveKinematicBody,
+            &SetBodyLinearAndAngularVelocity,
+            &GetBodyLinearAndAngularVelocity,
+            &SetBodyLinearVelocity,
+            &GetBodyLinearVelocity,
+            &AddBodyLinearVelocity,
+            &AddBodyLinearAndAngularVelocity,
+            &SetBodyAngularVelocity,
+            &GetBodyAngularVelocity,
+            &GetBodyPointVelocity,
+            &AddBodyForce,
+            &AddBodyForceAtPoint,
+            &AddBodyTorque,
+            &AddBodyForceAndTorque,
+            &AddBodyImpulse,
+            &AddBodyImpulseAtPoint,
+            &AddBodyAngularImpulse,
+            &ApplyBodyBuoyancyImpulse,
+            &SetBodyMotionType,
+            &GetBodyMotionType,
+            &SetBodyMotionQuality,
+            &GetBodyMotionQuality,
+            &GetPhysicsObjectLayerCount,
+            &GetPhysicsBroadPhaseLayerCount,
+            &AddPhysicsObjectLayer,
+            &AddPhysicsBroadPhaseLayer,
+            &SetPhysicsObjectLayerBroadPhaseLayer,
+            &GetPhysicsObjectLayerBroadPhaseLayer,
+            &SetPhysicsObjectLayerCollision,
+            &GetPhysicsObjectLayerCollision,
+            &SetPhysicsObjectVsBroadPhaseLayerCollision,
+            &GetPhysicsObjectVsBroadPhaseLayerCollision,
+            &GetPhysicsContactEventCount,
+            &GetPhysicsContactEvents,
+            &PhysicsRaycast,
+            &PhysicsRaycastAll,
+            &PhysicsCollidePoint,
+            &PhysicsCollideShape,
+            &PhysicsCastShape,
+            &GetTransformLocalPositions,
+            &SetTransformLocalPositions,
+            &GetTransformLocalRotations,
+            &SetTransformLocalRotations,
+            &GetTransformLocalScales,
+            &SetTransformLocalScales,
+            &GetTransformGlobalPositions,
+            &GetTransformGlobalRotations,
+            &TranslateTransformsGlobal,
+            &GetBodyPositionsAndRotations,
+            &GetBodyLinearVelocities,
+            &SetBodyLinearVelocities,
+            &GetBodyAngularVelocities,
+            &SetBodyAngularVelocities,
+            &GetComponentMirrorView,
+            &RegisterScheduledScript,
+            &UnregisterScheduledScript};
+        return nativeFunctions;
+    }
+}
+
 namespace vke_common
 {
 
     void ScriptManager::registerNativeFunctions()
     {
-        vke_interop::NativeFunctions nativeFunctions{
-            &vke_interop::GetTransformLocalPosition,
-            &vke_interop::SetTransformLocalPosition,
-            &vke_interop::GetTransformLocalRotation,
-            &vke_interop::SetTransformLocalRotation,
-            &vke_interop::GetTransformLocalScale,
-            &vke_interop::SetTransformLocalScale,
-            &vke_interop::TranslateTransformLocal,
-            &vke_interop::TranslateTransformGlobal,
-            &vke_interop::RotateTransformLocal,
-            &vke_interop::RotateTransformGlobal,
-            &vke_interop::ScaleTransform,
-            &vke_interop::IsKeyDown,
-            &vke_interop::IsKeyPressed,
-            &vke_interop::IsKeyReleased,
-            &vke_interop::IsMouseButtonDown,
-            &vke_interop::IsMouseButtonPressed,
-            &vke_interop::IsMouseButtonReleased,
-            &vke_interop::GetMousePosition,
-            &vke_interop::GetMouseDelta,
-            &vke_interop::GetMouseScrollDelta,
-            &vke_interop::SetCursorMode,
-            &vke_interop::GetCursorMode,
-            &vke_interop::GetTime,
-            &vke_interop::GetDeltaTime,
-            &vke_interop::GetPreviousFrameTime,
-            &vke_interop::SetEngineState,
-            &vke_interop::HasComponent,
-            &vke_interop::GetUITextLength,
-            &vke_interop::GetUITextText,
-            &vke_interop::SetUITextText,
-            &vke_interop::GetUITextColor,
-            &vke_interop::SetUITextColor,
-            &vke_interop::GetDirectionalLightColor,
-            &vke_interop::SetDirectionalLightColor,
-            &vke_interop::GetDirectionalLightIntensity,
-            &vke_interop::SetDirectionalLightIntensity,
-            &vke_interop::GetPointLightColor,
-            &vke_interop::SetPointLightColor,
-            &vke_interop::GetPointLightIntensity,
-            &vke_interop::SetPointLightIntensity,
-            &vke_interop::GetPointLightRadius,
-            &vke_interop::SetPointLightRadius,
-            &vke_interop::GetSpotLightColor,
-            &vke_interop::SetSpotLightColor,
-            &vke_interop::GetSpotLightIntensity,
-            &vke_interop::SetSpotLightIntensity,
-            &vke_interop::GetSpotLightRadius,
-            &vke_interop::SetSpotLightRadius,
-            &vke_interop::GetSpotLightInnerCone,
-            &vke_interop::SetSpotLightInnerCone,
-            &vke_interop::GetSpotLightOuterCone,
-            &vke_interop::SetSpotLightOuterCone,
-            &vke_interop::SetCharacterControllerVelocity,
-            &vke_interop::GetCharacterControllerVelocity,
-            &vke_interop::IsCharacterControllerGrounded,
-            &vke_interop::GetRigidBodyBodyID,
-            &vke_interop::GetSensorBodyID,
-            &vke_interop::ActivateBody,
-            &vke_interop::DeactivateBody,
-            &vke_interop::IsBodyActive,
-            &vke_interop::SetBodyObjectLayer,
-            &vke_interop::GetBodyObjectLayer,
-            &vke_interop::SetBodyRestitution,
-            &vke_interop::GetBodyRestitution,
-            &vke_interop::SetBodyFriction,
-            &vke_interop::GetBodyFriction,
-            &vke_interop::SetBodyGravityFactor,
-            &vke_interop::GetBodyGravityFactor,
-            &vke_interop::GetBodyCenterOfMassPosition,
-            &vke_interop::MoveKinematicBody,
-            &vke_interop::SetBodyLinearAndAngularVelocity,
-            &vke_interop::GetBodyLinearAndAngularVelocity,
-            &vke_interop::SetBodyLinearVelocity,
-            &vke_interop::GetBodyLinearVelocity,
-            &vke_interop::AddBodyLinearVelocity,
-            &vke_interop::AddBodyLinearAndAngularVelocity,
-            &vke_interop::SetBodyAngularVelocity,
-            &vke_interop::GetBodyAngularVelocity,
-            &vke_interop::GetBodyPointVelocity,
-            &vke_interop::AddBodyForce,
-            &vke_interop::AddBodyForceAtPoint,
-            &vke_interop::AddBodyTorque,
-            &vke_interop::AddBodyForceAndTorque,
-            &vke_interop::AddBodyImpulse,
-            &vke_interop::AddBodyImpulseAtPoint,
-            &vke_interop::AddBodyAngularImpulse,
-            &vke_interop::ApplyBodyBuoyancyImpulse,
-            &vke_interop::SetBodyMotionType,
-            &vke_interop::GetBodyMotionType,
-            &vke_interop::SetBodyMotionQuality,
-            &vke_interop::GetBodyMotionQuality,
-            &vke_interop::GetPhysicsObjectLayerCount,
-            &vke_interop::GetPhysicsBroadPhaseLayerCount,
-            &vke_interop::AddPhysicsObjectLayer,
-            &vke_interop::AddPhysicsBroadPhaseLayer,
-            &vke_interop::SetPhysicsObjectLayerBroadPhaseLayer,
-            &vke_interop::GetPhysicsObjectLayerBroadPhaseLayer,
-            &vke_interop::SetPhysicsObjectLayerCollision,
-            &vke_interop::GetPhysicsObjectLayerCollision,
-            &vke_interop::SetPhysicsObjectVsBroadPhaseLayerCollision,
-            &vke_interop::GetPhysicsObjectVsBroadPhaseLayerCollision,
-            &vke_interop::GetPhysicsContactEventCount,
-            &vke_interop::GetPhysicsContactEvents,
-            &vke_interop::PhysicsRaycast,
-            &vke_interop::PhysicsRaycastAll,
-            &vke_interop::PhysicsCollidePoint,
-            &vke_interop::PhysicsCollideShape,
-            &vke_interop::PhysicsCastShape};
+        vke_interop::NativeFunctions nativeFunctions = vke_interop::GetNativeFunctions();
         csharpExports.registerNativeFunctions(&nativeFunctions);
     }
 }
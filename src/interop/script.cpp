@@ -0,0 +1,20 @@
+#include <interop/script.hpp>
+#include <script.hpp>
+
+namespace vke_interop
+{
+    uint32_t VKE_INTEROP_CDECL RegisterScheduledScript(const char *name, uint32_t mode, uint32_t interval, float budgetMs, uint32_t phaseMask)
+    {
+        vke_common::ScriptSchedule schedule;
+        schedule.mode = static_cast<vke_common::ScriptUpdateMode>(mode);
+        schedule.interval = interval;
+        schedule.budgetMs = budgetMs;
+        schedule.phaseMask = phaseMask;
+        return vke_common::ScriptManager::GetScheduler().Register(name == nullptr ? "" : name, schedule);
+    }
+
+    void VKE_INTEROP_CDECL UnregisterScheduledScript(uint32_t id)
+    {
+        vke_common::ScriptManager::GetScheduler().Unregister(id);
+    }
+}
@@ -0,0 +1,296 @@
+#include <job_system.hpp>
+#include <algorithm>
+
+namespace vke_common
+{
+    struct QueuedJob
+    {
+        std::function<void()> fn;
+        JobCounter *counter;
+        JobAffinity affinity;
+    };
+
+    static thread_local const JobSystem *currentSystem = nullptr;
+    static thread_local uint32_t currentWorker = JobSystem::INVALID_WORKER;
+
+    JobSystem *JobSystem::instance = nullptr;
+
+    JobSystem::JobSystem(uint32_t threadCnt)
+        : injectedCnt(0), mainThreadJobCnt(0), queuedCnt(0), sleeperCnt(0), stop(false)
+    {
+        workers.reserve(threadCnt + 1);
+        for (uint32_t i = 0; i <= threadCnt; ++i)
+            workers.push_back(std::make_unique<Worker>());
+        currentSystem = this;
+        currentWorker = 0;
+        threads.reserve(threadCnt);
+        for (uint32_t i = 0; i < threadCnt; ++i)
+            threads.emplace_back(&JobSystem::workerLoop, this, i + 1);
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stop.store(true);
+        }
+        wakeCondition.notify_all();
+        for (std::thread &thread : threads)
+            thread.join();
+
+        // jobs nobody ran are dropped
+        for (std::unique_ptr<Worker> &worker : workers)
+            while (QueuedJob *job = worker->deque.Steal())
+                delete job;
+        for (QueuedJob *job : injected)
+            delete job;
+        for (QueuedJob *job : mainThreadJobs)
+            delete job;
+        if (currentSystem == this)
+        {
+            currentSystem = nullptr;
+            currentWorker = INVALID_WORKER;
+        }
+    }
+
+    JobSystem *JobSystem::GetInstance()
+    {
+        return instance;
+    }
+
+    JobSystem *JobSystem::Init(int32_t threadCnt)
+    {
+        if (instance == nullptr)
+            instance = new JobSystem(threadCnt < 0 ? DefaultThreadCnt() : static_cast<uint32_t>(threadCnt));
+        return instance;
+    }
+
+    void JobSystem::Dispose()
+    {
+        delete instance;
+        instance = nullptr;
+    }
+
+    uint32_t JobSystem::DefaultThreadCnt()
+    {
+        const uint32_t hardwareCnt = std::thread::hardware_concurrency();
+        return hardwareCnt > 1 ? hardwareCnt - 1 : 0;
+    }
+
+    uint32_t JobSystem::GetWorkerIndex() const
+    {
+        return currentSystem == this ? currentWorker : INVALID_WORKER;
+    }
+
+    void JobSystem::Run(std::function<void()> fn, JobCounter *counter, JobAffinity affinity)
+    {
+        if (counter != nullptr)
+            counter->value.fetch_add(1, std::memory_order_seq_cst);
+        enqueue(new QueuedJob{std::move(fn), counter, affinity});
+    }
+
+    void JobSystem::RunAfter(JobCounter &dependency, std::function<void()> fn, JobCounter *counter, JobAffinity affinity)
+    {
+        if (counter != nullptr)
+            counter->value.fetch_add(1, std::memory_order_seq_cst);
+        QueuedJob *job = new QueuedJob{std::move(fn), counter, affinity};
+        {
+            // finish drops the value to zero before it takes the waiters under this lock
+            std::lock_guard<std::mutex> lock(dependency.waitersMutex);
+            if (dependency.value.load(std::memory_order_seq_cst) != 0)
+            {
+                dependency.waiters.push_back(job);
+                return;
+            }
+        }
+        enqueue(job);
+    }
+
+    void JobSystem::RunMainThreadJobs()
+    {
+        if (!IsMainThread() || mainThreadJobCnt.load(std::memory_order_acquire) == 0)
+            return;
+        // jobs queued by these jobs run on the next call; a job may Wait, which calls this again
+        std::vector<QueuedJob *> running;
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+            running.swap(mainThreadJobs);
+            mainThreadJobCnt.store(0, std::memory_order_release);
+        }
+        for (QueuedJob *job : running)
+            execute(job, 0);
+    }
+
+    void JobSystem::Wait(JobCounter &counter)
+    {
+        const uint32_t workerIndex = GetWorkerIndex();
+        while (!counter.IsDone())
+        {
+            // other threads cannot run jobs, they might need a worker index
+            if (workerIndex != INVALID_WORKER)
+            {
+                if (workerIndex == 0)
+                    RunMainThreadJobs();
+                if (QueuedJob *job = findJob(workerIndex); job != nullptr)
+                {
+                    execute(job, workerIndex);
+                    continue;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void JobSystem::ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t, uint32_t)> &fn)
+    {
+        if (count == 0)
+            return;
+        grain = std::max(grain, 1u);
+        const uint32_t chunkCnt = count / grain + (count % grain != 0 ? 1 : 0);
+        const uint32_t workerIndex = GetWorkerIndex();
+        const uint32_t helperCnt = workerIndex == INVALID_WORKER ? 0 : std::min(GetWorkerCnt(), chunkCnt) - 1;
+        if (helperCnt == 0)
+        {
+            for (uint32_t begin = 0; begin < count; begin += std::min(grain, count - begin))
+                fn(begin, begin + std::min(grain, count - begin), workerIndex);
+            return;
+        }
+
+        // helpers claim chunks until none are left, a helper that starts late finds nothing to do
+        std::atomic<uint32_t> nextChunk(0);
+        auto runChunks = [this, &nextChunk, &fn, count, grain, chunkCnt]()
+        {
+            const uint32_t self = GetWorkerIndex();
+            for (uint32_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunkCnt;
+                 chunk = nextChunk.fetch_add(1, std::memory_order_relaxed))
+            {
+                const uint32_t begin = chunk * grain;
+                fn(begin, begin + std::min(grain, count - begin), self);
+            }
+        };
+        // nextChunk and fn live on this stack, so every helper has to finish before returning
+        JobCounter helpers;
+        for (uint32_t i = 0; i < helperCnt; ++i)
+            Run(runChunks, &helpers);
+        runChunks();
+        Wait(helpers);
+    }
+
+    JobSystem::Stats JobSystem::GetStats() const
+    {
+        Stats stats;
+        for (const std::unique_ptr<Worker> &worker : workers)
+        {
+            stats.executedCnt += worker->executedCnt.load(std::memory_order_relaxed);
+            stats.stolenCnt += worker->stolenCnt.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    void JobSystem::enqueue(QueuedJob *job)
+    {
+        if (job->affinity == JobAffinity::MAIN_THREAD)
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+            mainThreadJobs.push_back(job);
+            mainThreadJobCnt.store(static_cast<uint32_t>(mainThreadJobs.size()), std::memory_order_release);
+            return;
+        }
+
+        const uint32_t workerIndex = GetWorkerIndex();
+        if (workerIndex == INVALID_WORKER || !workers[workerIndex]->deque.Push(job))
+        {
+            std::lock_guard<std::mutex> lock(injectedMutex);
+            injected.push_back(job);
+            injectedCnt.fetch_add(1, std::memory_order_release);
+        }
+
+        // pairs with the check in workerLoop: either the sleeper sees the job or this sees the sleeper
+        queuedCnt.fetch_add(1, std::memory_order_seq_cst);
+        if (sleeperCnt.load(std::memory_order_seq_cst) > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+            }
+            wakeCondition.notify_one();
+        }
+    }
+
+    QueuedJob *JobSystem::findJob(uint32_t workerIndex)
+    {
+        QueuedJob *job = workers[workerIndex]->deque.Pop();
+        if (job == nullptr && injectedCnt.load(std::memory_order_acquire) > 0)
+            job = takeInjected();
+
+        const uint32_t workerCnt = GetWorkerCnt();
+        for (uint32_t i = 1; job == nullptr && i < workerCnt; ++i)
+        {
+            job = workers[(workerIndex + i) % workerCnt]->deque.Steal();
+            if (job != nullptr)
+                workers[workerIndex]->stolenCnt.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (job != nullptr)
+            queuedCnt.fetch_sub(1, std::memory_order_seq_cst);
+        return job;
+    }
+
+    QueuedJob *JobSystem::takeInjected()
+    {
+        std::lock_guard<std::mutex> lock(injectedMutex);
+        if (injected.empty())
+            return nullptr;
+        QueuedJob *job = injected.back();
+        injected.pop_back();
+        injectedCnt.fetch_sub(1, std::memory_order_release);
+        return job;
+    }
+
+    void JobSystem::execute(QueuedJob *job, uint32_t workerIndex)
+    {
+        job->fn();
+        JobCounter *counter = job->counter;
+        delete job;
+        workers[workerIndex]->executedCnt.fetch_add(1, std::memory_order_relaxed);
+        if (counter != nullptr)
+            finish(counter);
+    }
+
+    void JobSystem::finish(JobCounter *counter)
+    {
+        counter->releasing.fetch_add(1, std::memory_order_seq_cst);
+        if (counter->value.fetch_sub(1, std::memory_order_seq_cst) == 1)
+        {
+            std::vector<QueuedJob *> released;
+            {
+                std::lock_guard<std::mutex> lock(counter->waitersMutex);
+                released.swap(counter->waiters);
+            }
+            for (QueuedJob *job : released)
+                enqueue(job);
+        }
+        // the counter may be gone right after this
+        counter->releasing.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void JobSystem::workerLoop(uint32_t workerIndex)
+    {
+        currentSystem = this;
+        currentWorker = workerIndex;
+        while (true)
+        {
+            if (QueuedJob *job = findJob(workerIndex); job != nullptr)
+            {
+                execute(job, workerIndex);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeperCnt.fetch_add(1, std::memory_order_seq_cst);
+            wakeCondition.wait(lock, [this]
+                               { return stop.load() || queuedCnt.load(std::memory_order_seq_cst) > 0; });
+            sleeperCnt.fetch_sub(1, std::memory_order_seq_cst);
+            if (stop.load())
+                return;
+        }
+    }
+}
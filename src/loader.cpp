@@ -1,5 +1,6 @@
 #include <asset.hpp>
 #include <logger.hpp>
+#include <job_system.hpp>
 #include <stb/stb_image.h>
 #include <vector>
 #include <fstream>
@@ -262,7 +263,8 @@ namespace vke_common
         ret->ascender = static_cast<int>(ret->face->size->metrics.ascender >> 6);
         ret->descender = static_cast<int>(ret->face->size->metrics.descender >> 6);
         ret->lineHeight = static_cast<int>(ret->face->size->metrics.height >> 6);
-        ret->BuildStaticAtlas(asset.characters, asset.characterCount, asset.firstCodepoint);
+        ret->BuildStaticAtlas(asset.characters, asset.characterCount, asset.firstCodepoint, asset.path,
+                              AssetManager::GetInstance()->fontAtlasCacheDir, JobSystem::GetInstance());
         return ret;
     }
 
@@ -1,6 +1,274 @@
 #include <logger.hpp>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
 
 namespace vke_common
 {
-    Logger *Logger::instance = nullptr;
+    std::atomic<Logger *> Logger::instance = nullptr;
+
+    static std::shared_ptr<spdlog::logger> CreateSinkLogger(const LogConfig &config)
+    {
+        // only used under sinkMutex, so the single threaded sinks do
+        std::vector<spdlog::sink_ptr> sinks;
+        if (config.console)
+            sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_st>());
+        if (!config.filePath.empty())
+            sinks.push_back(std::make_shared<spdlog::sinks::basic_file_sink_st>(config.filePath));
+        if (!config.rotatingFilePath.empty())
+            sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_st>(config.rotatingFilePath, config.rotatingMaxSize,
+                                                                                  config.rotatingMaxFiles));
+        auto logger = std::make_shared<spdlog::logger>("vkEngine", sinks.begin(), sinks.end());
+        // filtering happens before a record is queued
+        logger->set_level(spdlog::level::trace);
+        logger->flush_on(spdlog::level::err);
+        return logger;
+    }
+
+    Logger::Logger()
+        : slots(std::make_unique<Slot[]>(SLOT_CNT)), enqueuePos(0), dequeuePos(0), droppedCnt(0),
+          level(spdlog::level::info), flushIntervalMs(LogConfig().flushIntervalMs), running(true), wakePending(false),
+          stop(false), sinkLogger(CreateSinkLogger(LogConfig()))
+    {
+        for (uint32_t i = 0; i < SLOT_CNT; ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        writer = std::thread(&Logger::writerLoop, this);
+    }
+
+    Logger *Logger::createInstance()
+    {
+        static std::mutex createMutex;
+        std::lock_guard<std::mutex> lock(createMutex);
+        Logger *logger = instance.load(std::memory_order_acquire);
+        if (logger == nullptr)
+        {
+            logger = new Logger();
+            instance.store(logger, std::memory_order_release);
+            // write out what is still queued when the program ends, VKE_FATAL flushes on its own
+            std::atexit(&Logger::Shutdown);
+        }
+        return logger;
+    }
+
+    void Logger::Configure(const LogConfig &config)
+    {
+        Logger *logger = GetInstance();
+        Flush();
+        {
+            std::lock_guard<std::mutex> lock(logger->sinkMutex);
+            logger->sinkLogger = CreateSinkLogger(config);
+        }
+        logger->flushIntervalMs.store(std::max(config.flushIntervalMs, 1u), std::memory_order_relaxed);
+        SetLevel(spdlog::level::from_str(config.level));
+    }
+
+    void Logger::SetLevel(spdlog::level::level_enum newLevel)
+    {
+        GetInstance()->level.store(newLevel, std::memory_order_relaxed);
+    }
+
+    spdlog::level::level_enum Logger::GetLevel()
+    {
+        return static_cast<spdlog::level::level_enum>(GetInstance()->level.load(std::memory_order_relaxed));
+    }
+
+    uint64_t Logger::GetDroppedCount()
+    {
+        return GetInstance()->droppedCnt.load(std::memory_order_relaxed);
+    }
+
+    void Logger::Flush()
+    {
+        Logger *logger = GetInstance();
+        const uint64_t target = logger->enqueuePos.load(std::memory_order_acquire);
+        logger->requestWake();
+        std::unique_lock<std::mutex> lock(logger->wakeMutex);
+        logger->flushedCondition.wait(lock, [logger, target]
+                                      { return logger->dequeuePos.load(std::memory_order_acquire) >= target ||
+                                               !logger->running.load(std::memory_order_acquire); });
+    }
+
+    void Logger::Shutdown()
+    {
+        Logger *logger = instance.load(std::memory_order_acquire);
+        if (logger == nullptr || !logger->writer.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(logger->wakeMutex);
+            logger->stop = true;
+        }
+        logger->wakeCondition.notify_one();
+        logger->writer.join();
+    }
+
+    void Logger::pushText(spdlog::level::level_enum recordLevel, const char *text, size_t size)
+    {
+        size = std::min<size_t>(size, FIRST_PAYLOAD_SIZE + size_t(MAX_RECORD_SLOTS - 1) * SLOT_PAYLOAD_SIZE);
+        const uint32_t slotCnt = size <= FIRST_PAYLOAD_SIZE
+                                     ? 1
+                                     : 1 + static_cast<uint32_t>((size - FIRST_PAYLOAD_SIZE + SLOT_PAYLOAD_SIZE - 1) / SLOT_PAYLOAD_SIZE);
+        uint64_t pos;
+        if (!claim(recordLevel, slotCnt, pos))
+        {
+            if (!running.load(std::memory_order_acquire))
+                writeSynchronously(recordLevel, fmt::string_view(text, size));
+            return;
+        }
+
+        Slot &first = slots[pos & SLOT_MASK];
+        const RecordHeader header{spdlog::log_clock::now(), nullptr, nullptr, 0, static_cast<uint32_t>(size),
+                                  static_cast<uint16_t>(slotCnt), static_cast<uint8_t>(recordLevel)};
+        std::memcpy(first.bytes, &header, sizeof(header));
+        size_t copied = std::min<size_t>(size, FIRST_PAYLOAD_SIZE);
+        std::memcpy(first.bytes + sizeof(RecordHeader), text, copied);
+        for (uint32_t i = 1; i < slotCnt; ++i)
+        {
+            const size_t chunk = std::min<size_t>(size - copied, SLOT_PAYLOAD_SIZE);
+            std::memcpy(slots[(pos + i) & SLOT_MASK].bytes, text + copied, chunk);
+            copied += chunk;
+        }
+        publish(recordLevel, pos, slotCnt);
+    }
+
+    bool Logger::claim(spdlog::level::level_enum recordLevel, uint32_t slotCnt, uint64_t &pos)
+    {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+        while (running.load(std::memory_order_acquire))
+        {
+            // the writer frees slots in order, so when the last one is free the others are as well
+            const uint64_t last = pos + slotCnt - 1;
+            const int64_t diff = static_cast<int64_t>(slots[last & SLOT_MASK].sequence.load(std::memory_order_acquire) - last);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + slotCnt, std::memory_order_relaxed))
+                    return true;
+            }
+            else if (diff < 0)
+            {
+                if (recordLevel < spdlog::level::warn)
+                {
+                    droppedCnt.fetch_add(1, std::memory_order_relaxed);
+                    requestWake();
+                    return false;
+                }
+                requestWake();
+                std::this_thread::yield();
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+            else
+                pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    void Logger::publish(spdlog::level::level_enum recordLevel, uint64_t pos, uint32_t slotCnt)
+    {
+        // the first slot goes last, the writer only looks at it
+        for (uint32_t i = 1; i < slotCnt; ++i)
+            slots[(pos + i) & SLOT_MASK].sequence.store(pos + i + 1, std::memory_order_release);
+        slots[pos & SLOT_MASK].sequence.store(pos + 1, std::memory_order_release);
+
+        if (recordLevel >= spdlog::level::err ||
+            pos + slotCnt - dequeuePos.load(std::memory_order_relaxed) > SLOT_CNT / 2)
+            requestWake();
+    }
+
+    void Logger::requestWake()
+    {
+        if (wakePending.exchange(true, std::memory_order_acq_rel))
+            return;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wakeCondition.notify_one();
+    }
+
+    bool Logger::writeOne(spdlog::memory_buf_t &text)
+    {
+        const uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Slot &first = slots[pos & SLOT_MASK];
+        if (first.sequence.load(std::memory_order_acquire) != pos + 1)
+            return false;
+
+        RecordHeader header;
+        std::memcpy(&header, first.bytes, sizeof(header));
+        text.clear();
+        if (header.format != nullptr)
+            header.format(first.bytes + sizeof(RecordHeader), fmt::string_view(header.fmtData, header.fmtSize), text);
+        else
+        {
+            size_t copied = std::min<size_t>(header.textSize, FIRST_PAYLOAD_SIZE);
+            text.append(reinterpret_cast<const char *>(first.bytes + sizeof(RecordHeader)),
+                        reinterpret_cast<const char *>(first.bytes + sizeof(RecordHeader)) + copied);
+            for (uint32_t i = 1; i < header.slotCnt; ++i)
+            {
+                const char *bytes = reinterpret_cast<const char *>(slots[(pos + i) & SLOT_MASK].bytes);
+                const size_t chunk = std::min<size_t>(header.textSize - copied, SLOT_PAYLOAD_SIZE);
+                text.append(bytes, bytes + chunk);
+                copied += chunk;
+            }
+        }
+        sinkLogger->log(header.time, spdlog::source_loc{}, static_cast<spdlog::level::level_enum>(header.level),
+                        spdlog::string_view_t(text.data(), text.size()));
+
+        for (uint32_t i = 0; i < header.slotCnt; ++i)
+            slots[(pos + i) & SLOT_MASK].sequence.store(pos + i + SLOT_CNT, std::memory_order_release);
+        dequeuePos.store(pos + header.slotCnt, std::memory_order_release);
+        return true;
+    }
+
+    void Logger::writeSynchronously(spdlog::level::level_enum recordLevel, fmt::string_view text)
+    {
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        sinkLogger->log(recordLevel, spdlog::string_view_t(text.data(), text.size()));
+    }
+
+    void Logger::writerLoop()
+    {
+        spdlog::memory_buf_t text;
+        uint64_t reportedDroppedCnt = 0;
+        bool stopping = false;
+        while (true)
+        {
+            {
+                std::lock_guard<std::mutex> lock(sinkMutex);
+                bool wrote = false;
+                while (writeOne(text))
+                    wrote = true;
+                // records claimed before running was cleared are still being written by their callers
+                while (stopping && dequeuePos.load(std::memory_order_relaxed) != enqueuePos.load(std::memory_order_acquire))
+                    if (!writeOne(text))
+                        std::this_thread::yield();
+                if (const uint64_t dropped = droppedCnt.load(std::memory_order_relaxed); dropped != reportedDroppedCnt)
+                {
+                    sinkLogger->warn("{} log records dropped, the log queue was full", dropped - reportedDroppedCnt);
+                    reportedDroppedCnt = dropped;
+                    wrote = true;
+                }
+                if (wrote)
+                    sinkLogger->flush();
+            }
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+            }
+            flushedCondition.notify_all();
+            if (stopping)
+                break;
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait_for(lock, std::chrono::milliseconds(flushIntervalMs.load(std::memory_order_relaxed)), [this]
+                                   { return stop || wakePending.load(std::memory_order_acquire); });
+            wakePending.store(false, std::memory_order_release);
+            if (stop)
+            {
+                // later calls write synchronously
+                running.store(false, std::memory_order_release);
+                stopping = true;
+            }
+        }
+        flushedCondition.notify_all();
+    }
 }
@@ -28,19 +28,25 @@ int main(int argc, char **argv)
         vke_render::LAYERED_2D_RENDERER};
     std::vector<std::unique_ptr<vke_render::RenderPassBase>> customPasses;
 
-    GLFWwindow *window = initWindow(gameConfig->windowWidth, gameConfig->windowHeight);
+    const bool headless = gameConfig->headlessConfig.enabled;
+    GLFWwindow *window = headless ? nullptr : initWindow(gameConfig->windowWidth, gameConfig->windowHeight);
     vke_common::Engine *engine = vke_common::Engine::Init(window, *gameConfig, nullptr, passes, customPasses);
 
     vke_common::AssetManager::LoadAssetLUT(gameConfig->assetLUTPath);
     auto scene = vke_common::SceneManager::LoadScene(gameConfig->defaultScenePath);
     vke_common::SceneManager::SetCurrentScene(std::move(scene));
 
-    glfwSetFramebufferSizeCallback(window, vke_common::Engine::OnWindowResize);
-    while (!glfwWindowShouldClose(window))
+    if (headless)
+        engine->RunHeadless(gameConfig->headlessConfig.frameCnt);
+    else
     {
-        glfwPollEvents();
-        if (!engine->Update())
-            glfwSetWindowShouldClose(vke_render::RenderEnvironment::GetInstance()->window, GLFW_TRUE);
+        glfwSetFramebufferSizeCallback(window, vke_common::Engine::OnWindowResize);
+        while (!glfwWindowShouldClose(window))
+        {
+            glfwPollEvents();
+            if (!engine->Update())
+                glfwSetWindowShouldClose(vke_render::RenderEnvironment::GetInstance()->window, GLFW_TRUE);
+        }
     }
     vke_common::Engine::WaitIdle();
     vke_common::Engine::Dispose();
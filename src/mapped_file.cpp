@@ -0,0 +1,98 @@
+#include <mapped_file.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vke_common
+{
+#ifdef _WIN32
+    bool MappedFile::Open(const std::string &pth)
+    {
+        Close();
+        HANDLE file = CreateFileA(pth.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        data = static_cast<const uint8_t *>(view);
+        size = static_cast<size_t>(fileSize.QuadPart);
+        fileHandle = file;
+        mappingHandle = mapping;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (data != nullptr)
+            UnmapViewOfFile(data);
+        if (mappingHandle != nullptr)
+            CloseHandle(mappingHandle);
+        if (fileHandle != nullptr)
+            CloseHandle(fileHandle);
+        data = nullptr;
+        size = 0;
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+    }
+#else
+    bool MappedFile::Open(const std::string &pth)
+    {
+        Close();
+        int fd = open(pth.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED)
+            return false;
+
+        data = static_cast<const uint8_t *>(view);
+        size = static_cast<size_t>(st.st_size);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (data != nullptr)
+            munmap(const_cast<uint8_t *>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+#endif
+}
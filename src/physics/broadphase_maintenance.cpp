@@ -0,0 +1,156 @@
+#include <physics/broadphase_maintenance.hpp>
+#include <physics/physics.hpp>
+#include <Jolt/Geometry/AABox.h>
+#include <Jolt/Geometry/RayAABox.h>
+#include <Jolt/Physics/Collision/BroadPhase/BroadPhaseQuery.h>
+#include <Jolt/Physics/Collision/RayCast.h>
+#include <chrono>
+#include <cmath>
+
+namespace vke_physics
+{
+    class CountingRayCastBodyCollector : public JPH::RayCastBodyCollector
+    {
+    public:
+        uint32_t hitCount = 0;
+
+        virtual void AddHit(const JPH::BroadPhaseCastResult &) override
+        {
+            ++hitCount;
+        }
+    };
+
+    static float ElapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool BroadPhaseMaintenance::needsFullOptimize() const
+    {
+        const BroadPhaseMaintenanceConfig &cfg = config->broadPhaseMaintenance;
+        for (uint32_t i = 0; i < metrics.layerCount; ++i)
+        {
+            const BroadPhaseLayerMetrics &layer = metrics.layers[i];
+            const uint32_t churn = layer.addedSinceOptimize + layer.removedSinceOptimize;
+            if (churn == 0)
+                continue;
+
+            const uint32_t threshold = std::max(cfg.churnThreshold, static_cast<uint32_t>(cfg.churnRatio * layer.bodyCount));
+            if (churn >= threshold)
+                return true;
+
+            if (layer.baselineProbeQueryUs > 0.0f && layer.probeQueryUs > layer.baselineProbeQueryUs * cfg.probeDegradeRatio)
+                return true;
+        }
+        return false;
+    }
+
+    void BroadPhaseMaintenance::Update(JPH::PhysicsSystem &physicsSystem, JPH::TempAllocator *tempAllocator, JPH::JobSystem *jobSystem)
+    {
+        ++metrics.frameIndex;
+        const BroadPhaseMaintenanceConfig &cfg = config->broadPhaseMaintenance;
+        if (!cfg.enabled)
+            return;
+
+        if (cfg.probeInterval > 0 && metrics.frameIndex % cfg.probeInterval == 0)
+            Probe(physicsSystem);
+
+        if (needsFullOptimize())
+        {
+            const float estimatedMs = metrics.fullOptimizeMsPerBody * physicsSystem.GetNumBodies();
+            if (estimatedMs <= cfg.frameBudgetMs || metrics.deferredFrames >= cfg.maxDeferredFrames)
+            {
+                if (estimatedMs > cfg.frameBudgetMs)
+                {
+                    ++metrics.forcedOptimizeCount;
+                    VKE_LOG_WARN("Broad phase optimization forced after {} deferred frames (estimated {:.3f} ms)", metrics.deferredFrames, estimatedMs)
+                }
+                Optimize(physicsSystem);
+                return;
+            }
+            ++metrics.deferredFrames;
+        }
+
+        bool dirty = false;
+        for (uint32_t i = 0; i < metrics.layerCount; ++i)
+            dirty |= metrics.layers[i].churnSinceUpdate > 0;
+
+        // a physics step already rebuilt the dirty trees this frame
+        if (dirty && stepsSinceUpdate == 0)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            physicsSystem.Update(0.0f, 1, tempAllocator, jobSystem);
+            metrics.lastIncrementalUpdateMs = ElapsedMs(start);
+            ++metrics.incrementalUpdateCount;
+        }
+
+        if (dirty)
+            for (uint32_t i = 0; i < metrics.layerCount; ++i)
+                metrics.layers[i].churnSinceUpdate = 0;
+        stepsSinceUpdate = 0;
+    }
+
+    void BroadPhaseMaintenance::Optimize(JPH::PhysicsSystem &physicsSystem)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        physicsSystem.OptimizeBroadPhase();
+        metrics.lastFullOptimizeMs = ElapsedMs(start);
+
+        const uint32_t bodyCount = physicsSystem.GetNumBodies();
+        if (bodyCount > 0)
+            metrics.fullOptimizeMsPerBody = metrics.lastFullOptimizeMs / bodyCount;
+        ++metrics.fullOptimizeCount;
+        metrics.deferredFrames = 0;
+        stepsSinceUpdate = 0;
+
+        for (uint32_t i = 0; i < metrics.layerCount; ++i)
+        {
+            BroadPhaseLayerMetrics &layer = metrics.layers[i];
+            layer.addedSinceOptimize = 0;
+            layer.removedSinceOptimize = 0;
+            layer.churnSinceUpdate = 0;
+        }
+
+        if (config->broadPhaseMaintenance.probeInterval > 0)
+        {
+            Probe(physicsSystem);
+            for (uint32_t i = 0; i < metrics.layerCount; ++i)
+                metrics.layers[i].baselineProbeQueryUs = metrics.layers[i].probeQueryUs;
+        }
+    }
+
+    void BroadPhaseMaintenance::Probe(JPH::PhysicsSystem &physicsSystem)
+    {
+        const JPH::AABox bounds = physicsSystem.GetBounds();
+        if (!bounds.IsValid())
+            return;
+
+        const JPH::Vec3 extent = bounds.GetExtent() * 2.0f;
+        const uint32_t rayCount = std::max(config->broadPhaseMaintenance.probeRayCount, 1u);
+        const JPH::BroadPhaseQuery &query = physicsSystem.GetBroadPhaseQuery();
+        const JPH::ObjectLayerFilter objectLayerFilter;
+
+        for (uint32_t i = 0; i < metrics.layerCount; ++i)
+        {
+            const MaskBroadPhaseLayerFilter broadPhaseLayerFilter(1u << i);
+            CountingRayCastBodyCollector collector;
+            const auto start = std::chrono::steady_clock::now();
+            for (uint32_t r = 0; r < rayCount; ++r)
+            {
+                // deterministic stratified rays crossing the whole broad phase along x
+                const float u = (r + 0.5f) / rayCount;
+                const float v = std::fmod(u * 0.618034f * rayCount, 1.0f);
+                const JPH::Vec3 origin = bounds.mMin + JPH::Vec3(0.0f, extent.GetY() * u, extent.GetZ() * v);
+                const JPH::Vec3 direction(extent.GetX(), extent.GetY() * (0.5f - u), extent.GetZ() * (0.5f - v));
+                query.CastRay(JPH::RayCast(origin, direction), collector, broadPhaseLayerFilter, objectLayerFilter);
+            }
+            BroadPhaseLayerMetrics &layer = metrics.layers[i];
+            layer.probeQueryUs = ElapsedMs(start) * 1000.0f;
+            layer.probeHits = collector.hitCount;
+        }
+
+#ifdef JPH_TRACK_BROADPHASE_STATS
+        physicsSystem.ReportBroadphaseStats();
+#endif
+    }
+}
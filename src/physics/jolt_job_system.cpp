@@ -0,0 +1,60 @@
+#include <physics/jolt_job_system.hpp>
+#include <chrono>
+#include <thread>
+
+namespace vke_physics
+{
+    JoltJobSystem::JoltJobSystem(vke_common::JobSystem &jobSystem, JPH::uint maxJobs, JPH::uint maxBarriers)
+        : JPH::JobSystemWithBarrier(maxBarriers), jobSystem(jobSystem)
+    {
+        jobs.Init(maxJobs, maxJobs);
+    }
+
+    JoltJobSystem::~JoltJobSystem()
+    {
+        jobSystem.Wait(queued);
+    }
+
+    JPH::JobHandle JoltJobSystem::CreateJob(const char *inName, JPH::ColorArg inColor, const JobFunction &inJobFunction,
+                                            JPH::uint32 inNumDependencies)
+    {
+        JPH::uint32 index;
+        while ((index = jobs.ConstructObject(inName, inColor, this, inJobFunction, inNumDependencies)) == AvailableJobs::cInvalidObjectIndex)
+        {
+            JPH_ASSERT(false, "No jobs available!");
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        Job *job = &jobs.Get(index);
+
+        // the handle keeps the job alive, it may be done before CreateJob returns
+        JobHandle handle(job);
+        if (inNumDependencies == 0)
+            QueueJob(job);
+        return handle;
+    }
+
+    void JoltJobSystem::QueueJob(Job *inJob)
+    {
+        // without worker threads the barrier runs the job when it is waited on, as in JobSystemThreadPool
+        if (jobSystem.GetWorkerCnt() <= 1)
+            return;
+        inJob->AddRef();
+        // the barrier's waiting thread may have run the job already, Execute does nothing then
+        jobSystem.Run([inJob]()
+                      {
+                          inJob->Execute();
+                          inJob->Release(); },
+                      &queued);
+    }
+
+    void JoltJobSystem::QueueJobs(Job **inJobs, JPH::uint inNumJobs)
+    {
+        for (JPH::uint i = 0; i < inNumJobs; ++i)
+            QueueJob(inJobs[i]);
+    }
+
+    void JoltJobSystem::FreeJob(Job *inJob)
+    {
+        jobs.DestructObject(inJob);
+    }
+}
@@ -89,16 +89,19 @@ namespace vke_physics
         JPH::Factory::sInstance = new JPH::Factory();
         JPH::RegisterTypes();
         tempAllocator = std::make_unique<JPH::TempAllocatorImpl>(config.tempAllocatorSize);
-        jobSystem = std::make_unique<JPH::JobSystemThreadPool>(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, JPH::thread::hardware_concurrency() - 1);
+        // shares the engine's workers when there are any, e.g. not in standalone physics tests
+        if (vke_common::JobSystem *engineJobSystem = vke_common::JobSystem::GetInstance(); engineJobSystem != nullptr)
+            jobSystem = std::make_unique<JoltJobSystem>(*engineJobSystem, JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers);
+        else
+            jobSystem = std::make_unique<JPH::JobSystemThreadPool>(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, JPH::thread::hardware_concurrency() - 1);
 
         physicsSystem.Init(config.maxBodies, config.numBodyMutexes, config.maxBodyPairs, config.maxContactConstraints, broadPhaseLayerInterface, objectVsBroadphaseLayerFilter, objectVsObjectLayerFilter);
         physicsSystem.SetGravity(config.gravity);
         physicsSystem.SetBodyActivationListener(&bodyActivationListener);
         physicsSystem.SetContactListener(&contactListener);
 
-        JPH::BodyInterface &bodyInterface = physicsSystem.GetBodyInterface();
-
-        physicsSystem.OptimizeBroadPhase();
+        broadPhaseMaintenance.Init(config);
+        broadPhaseMaintenance.Optimize(physicsSystem);
     }
 
     void PhysicsManager::dispose()
@@ -111,9 +114,27 @@ namespace vke_physics
     void PhysicsManager::fixedUpdate()
     {
         physicsSystem.Update(config.stepTime, config.collisionSteps, tempAllocator.get(), jobSystem.get());
+        broadPhaseMaintenance.NotifyPhysicsStep();
         updates.DispatchEvent(nullptr);
     }
 
+    JPH::BodyID PhysicsManager::createAndAddBody(const JPH::BodyCreationSettings &settings, JPH::EActivation activation)
+    {
+        const JPH::BodyID bodyID = physicsSystem.GetBodyInterface().CreateAndAddBody(settings, activation);
+        if (!bodyID.IsInvalid())
+            broadPhaseMaintenance.NotifyBodyAdded(broadPhaseLayerInterface.GetBroadPhaseLayer(settings.mObjectLayer));
+        return bodyID;
+    }
+
+    void PhysicsManager::removeAndDestroyBody(JPH::BodyID bodyID)
+    {
+        JPH::BodyInterface &bodyInterface = physicsSystem.GetBodyInterface();
+        const JPH::ObjectLayer layer = bodyInterface.GetObjectLayer(bodyID);
+        bodyInterface.RemoveBody(bodyID);
+        bodyInterface.DestroyBody(bodyID);
+        broadPhaseMaintenance.NotifyBodyRemoved(broadPhaseLayerInterface.GetBroadPhaseLayer(layer));
+    }
+
     void PhysicsManager::recordContactEvent(ContactEventType type, const JPH::Body &body1, const JPH::Body &body2, const JPH::ContactManifold &manifold, const JPH::ContactSettings &settings)
     {
         ContactEvent event{};
@@ -147,6 +168,9 @@ namespace vke_physics
             ++contactEventsTailIndex;
         }
         activeContacts[key] = event;
+        // called from the physics job threads, listeners get it at the next sync point
+        if (vke_common::EventSystem::HasListeners<ContactEvent>())
+            vke_common::EventSystem::Post(event);
     }
 
     void PhysicsManager::recordContactRemoved(const JPH::SubShapeIDPair &subShapePair)
@@ -164,6 +188,8 @@ namespace vke_physics
             ++contactEventsTailIndex;
         }
         activeContacts.erase(it);
+        if (vke_common::EventSystem::HasListeners<ContactEvent>())
+            vke_common::EventSystem::Post(event);
     }
 
     uint32_t PhysicsManager::getContactEventCount()
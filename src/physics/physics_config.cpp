@@ -33,6 +33,7 @@ namespace vke_physics
         tempAllocatorSize = 10 * 1024 * 1024;
         stepTime = 1.0f / 60.0f;
         gravity = JPH::Vec3(0, -9.8f, 0);
+        broadPhaseMaintenance = BroadPhaseMaintenanceConfig();
 
         objectLayerCount = 2;
         broadPhaseLayerCount = 2;
@@ -135,6 +136,8 @@ namespace vke_physics
         collisionSteps = json.value("collisionSteps", collisionSteps);
         tempAllocatorSize = json.value("tempAllocatorSize", tempAllocatorSize);
         stepTime = json.value("stepTime", stepTime);
+        if (json.contains("broadPhaseMaintenance"))
+            broadPhaseMaintenance.LoadJSON(json["broadPhaseMaintenance"]);
 
         if (json.contains("gravity"))
         {
@@ -0,0 +1,193 @@
+#include <render/compute_skinning.hpp>
+#include <render/skinning_graph.hpp>
+#include <render/skinning_kernel.hpp>
+#include <asset.hpp>
+#include <algorithm>
+#include <bit>
+
+namespace vke_render
+{
+    static_assert(sizeof(SkinningVertexIn) == sizeof(SkinVertex), "skinning.comp reads SkinVertex as 20 words");
+    static_assert(sizeof(SkinningVertexOut) == sizeof(Vertex), "skinning.comp writes Vertex as 12 words");
+
+    static constexpr uint32_t SKINNING_GROUP_SIZE = 64;
+    static constexpr uint32_t MIN_OUTPUT_VERTEX_CNT = 1 << 14;
+
+    ComputeSkinningManager::ComputeSkinningManager()
+        : frameGraph(nullptr), bufferResourceID(0),
+          outputBuffers(MAX_FRAMES_IN_FLIGHT), outputDescriptorSets(MAX_FRAMES_IN_FLIGHT), instanceCnt(0), frameCnt(0)
+    {
+        pipeline = std::make_unique<ComputePipeline>(vke_common::AssetManager::LoadComputeShader(vke_common::BUILTIN_COMPUTE_SHADER_SKINNING_ID));
+        for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame)
+        {
+            outputDescriptorSets[frame] = pipeline->shader->CreateDescriptorSet(2);
+            reserveOutput(frame);
+        }
+    }
+
+    ComputeSkinningManager::~ComputeSkinningManager() {}
+
+    void ComputeSkinningManager::ConstructFrameGraph(FrameGraph &frameGraph,
+                                                     std::map<std::string, vke_ds::id32_t> &blackboard,
+                                                     ResourceNodeIDMap &currentResourceNodeID)
+    {
+        VkBuffer buffers[MAX_FRAMES_IN_FLIGHT];
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+            buffers[i] = outputBuffers[i]->buffer;
+
+        this->frameGraph = &frameGraph;
+        ConstructSkinningFrameGraph(frameGraph, blackboard, currentResourceNodeID, buffers,
+                                    std::bind(&ComputeSkinningManager::skin, this,
+                                              std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
+        bufferResourceID = blackboard[SKINNED_VERTEX_BUFFER];
+    }
+
+    void ComputeSkinningManager::reserveOutput(uint32_t frame)
+    {
+        const VkDeviceSize size = std::max(vertexAllocator.GetEnd(), MIN_OUTPUT_VERTEX_CNT) * sizeof(Vertex);
+        std::unique_ptr<DeviceBuffer> &buffer = outputBuffers[frame];
+        if (buffer != nullptr && buffer->bufferSize >= size)
+            return;
+
+        // every instance is skinned again this frame, so nothing has to be carried over
+        buffer = std::make_unique<DeviceBuffer>(std::bit_ceil(size), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = buffer->buffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range = VK_WHOLE_SIZE;
+        VkWriteDescriptorSet descriptorSetWrite{};
+        ConstructDescriptorSetWrite(descriptorSetWrite, outputDescriptorSets[frame], 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &bufferInfo);
+        vkUpdateDescriptorSets(globalLogicalDevice, 1, &descriptorSetWrite, 0, nullptr);
+
+        if (frameGraph != nullptr)
+            static_cast<BufferResource *>(frameGraph->resources[bufferResourceID].get())->buffers[frame] = buffer->buffer;
+    }
+
+    VkDescriptorSet ComputeSkinningManager::acquireMeshSource(const Mesh *mesh)
+    {
+        auto it = meshSources.find(mesh);
+        if (it != meshSources.end())
+        {
+            ++it->second.refCnt;
+            return it->second.descriptorSet;
+        }
+
+        VkDescriptorSet descriptorSet;
+        if (freeSourceSets.empty())
+            descriptorSet = pipeline->shader->CreateDescriptorSet(0);
+        else
+        {
+            descriptorSet = freeSourceSets.back();
+            freeSourceSets.pop_back();
+        }
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = mesh->vertexBuffer->buffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range = VK_WHOLE_SIZE;
+        VkWriteDescriptorSet descriptorSetWrite{};
+        ConstructDescriptorSetWrite(descriptorSetWrite, descriptorSet, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &bufferInfo);
+        vkUpdateDescriptorSets(globalLogicalDevice, 1, &descriptorSetWrite, 0, nullptr);
+
+        meshSources[mesh] = MeshSource{1, descriptorSet};
+        return descriptorSet;
+    }
+
+    void ComputeSkinningManager::releaseMeshSource(const Mesh *mesh)
+    {
+        auto it = meshSources.find(mesh);
+        if (it != meshSources.end() && --it->second.refCnt == 0)
+        {
+            retiredSourceSets.emplace_back(frameCnt, it->second.descriptorSet);
+            meshSources.erase(it);
+        }
+    }
+
+    uint32_t ComputeSkinningManager::AddInstance(std::shared_ptr<const Mesh> mesh, uint32_t jointOffset, std::vector<RenderUnit *> &&units)
+    {
+        uint32_t id;
+        if (freeInstanceIDs.empty())
+        {
+            id = instances.size();
+            instances.emplace_back();
+        }
+        else
+        {
+            id = freeInstanceIDs.back();
+            freeInstanceIDs.pop_back();
+        }
+
+        Instance &instance = instances[id];
+        acquireMeshSource(mesh.get());
+        instance.vertexCnt = mesh->vertexBuffer->bufferSize / sizeof(SkinVertex);
+        instance.vertexOffset = vertexAllocator.Alloc(instance.vertexCnt);
+        instance.jointOffset = jointOffset;
+        instance.mesh = std::move(mesh);
+        instance.units = std::move(units);
+        ++instanceCnt;
+        return id;
+    }
+
+    void ComputeSkinningManager::RemoveInstance(uint32_t id)
+    {
+        Instance &instance = instances[id];
+        vertexAllocator.Free(instance.vertexOffset, instance.vertexCnt);
+        releaseMeshSource(instance.mesh.get());
+        instance.mesh = nullptr;
+        instance.units.clear();
+        freeInstanceIDs.push_back(id);
+        --instanceCnt;
+    }
+
+    std::shared_ptr<Material> &ComputeSkinningManager::GetStaticMaterial(const std::shared_ptr<Material> &skinMaterial)
+    {
+        auto it = staticMaterials.find(skinMaterial.get());
+        if (it != staticMaterials.end())
+            return it->second.second;
+
+        // the textures and constants stay shared, only the vertex stage changes
+        std::shared_ptr<Material> staticMaterial = std::make_shared<Material>(*skinMaterial);
+        staticMaterial->shader = vke_common::AssetManager::LoadVertFragShader(vke_common::BUILTIN_VFSHADER_DEFAULT_ID);
+        auto &entry = staticMaterials[skinMaterial.get()];
+        entry = std::make_pair(skinMaterial, std::move(staticMaterial));
+        return entry.second;
+    }
+
+    void ComputeSkinningManager::Update(uint32_t currentFrame)
+    {
+        // a set retired MAX_FRAMES_IN_FLIGHT frames ago was last bound by a submission that has completed
+        ++frameCnt;
+        while (!retiredSourceSets.empty() && frameCnt - retiredSourceSets.front().first >= MAX_FRAMES_IN_FLIGHT)
+        {
+            freeSourceSets.push_back(retiredSourceSets.front().second);
+            retiredSourceSets.pop_front();
+        }
+
+        // the frame's previous submission has completed, so its output buffer can be replaced
+        reserveOutput(currentFrame);
+        VkBuffer buffer = outputBuffers[currentFrame]->buffer;
+        for (Instance &instance : instances)
+            for (RenderUnit *unit : instance.units)
+            {
+                unit->vertexBufferOverride = buffer;
+                unit->vertexBufferOverrideOffset = static_cast<VkDeviceSize>(instance.vertexOffset) * sizeof(Vertex);
+            }
+    }
+
+    void ComputeSkinningManager::skin(TaskNode &node, FrameGraph &frameGraph, VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t imageIndex)
+    {
+        if (instanceCnt == 0 || paletteDescriptorSets.empty())
+            return;
+
+        std::vector<VkDescriptorSet> descriptorSets = {nullptr, paletteDescriptorSets[currentFrame], outputDescriptorSets[currentFrame]};
+        for (Instance &instance : instances)
+        {
+            if (instance.mesh == nullptr)
+                continue;
+            descriptorSets[0] = meshSources[instance.mesh.get()].descriptorSet;
+            PushConstant constant{instance.vertexCnt, instance.jointOffset, instance.vertexOffset};
+            pipeline->Dispatch(commandBuffer, descriptorSets, &constant,
+                               glm::ivec3((instance.vertexCnt + SKINNING_GROUP_SIZE - 1) / SKINNING_GROUP_SIZE, 1, 1));
+        }
+    }
+}
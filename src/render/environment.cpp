@@ -63,9 +63,11 @@ namespace vke_render
         createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
         createInfo.pApplicationInfo = &appInfo;
 
+        // headless runs have no surface, so they need none of glfw's extensions and no glfwInit
         uint32_t glfwExtensionCount = 0;
-        const char **glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        const char **glfwExtensions = nullptr;
+        if (!headless)
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
         VKE_LOG_INFO("{} glfw extensions supported", glfwExtensionCount)
 
         createInfo.enabledExtensionCount = glfwExtensionCount;
@@ -140,7 +142,7 @@ namespace vke_render
                      (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT))
                 queueFamilyIndices.transferOnlyFamily = i;
 
-            if (!queueFamilyIndices.presentFamily.has_value() && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            if (!queueFamilyIndices.presentFamily.has_value() && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !headless)
             {
                 VkBool32 presentSupport = false;
                 vkGetPhysicalDeviceSurfaceSupportKHR(pdevice, i, instance->surface, &presentSupport);
@@ -149,6 +151,9 @@ namespace vke_render
             }
             i++;
         }
+        // nothing is presented, the graphics queue stands in so the queue setup stays the same
+        if (headless)
+            queueFamilyIndices.presentFamily = queueFamilyIndices.graphicsAndComputeFamily;
         queueFamilyIndices.getUniqueQueueFamilies();
     }
 
@@ -158,7 +163,12 @@ namespace vke_render
          VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME,
          VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
 
-    static bool checkDeviceExtensionSupport(VkPhysicalDevice pdevice)
+    const std::vector<const char *> headlessDeviceExtensions =
+        {VK_KHR_SHADER_ATOMIC_INT64_EXTENSION_NAME,
+         VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME,
+         VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
+
+    static bool checkDeviceExtensionSupport(VkPhysicalDevice pdevice, const std::vector<const char *> &deviceExtensions)
     {
         uint32_t extensionCount;
         vkEnumerateDeviceExtensionProperties(pdevice, nullptr, &extensionCount, nullptr);
@@ -178,10 +188,10 @@ namespace vke_render
 
     bool RenderEnvironment::isDeviceSuitable(VkPhysicalDevice pdevice)
     {
-        bool extensionsSupported = checkDeviceExtensionSupport(pdevice);
+        bool extensionsSupported = checkDeviceExtensionSupport(pdevice, headless ? headlessDeviceExtensions : deviceExtensions);
 
-        bool swapChainAdequate = false;
-        if (extensionsSupported)
+        bool swapChainAdequate = headless;
+        if (extensionsSupported && !headless)
         {
             SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(pdevice);
             swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -381,8 +391,9 @@ namespace vke_render
         createInfo.pEnabledFeatures = nullptr;
         createInfo.pNext = &deviceFeatures2;
 
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        const std::vector<const char *> &enabledExtensions = headless ? headlessDeviceExtensions : deviceExtensions;
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
         createInfo.enabledLayerCount = 0;
 
         VKE_VK_CHECK(vkCreateDevice(physicalDevice, &createInfo, nullptr, &globalLogicalDevice), "Failed to create logical device!")
@@ -580,7 +591,11 @@ namespace vke_render
 
         swapChainImageFormat = surfaceFormat.format;
         swapChainExtent = extent;
+        createDepthImages(extent);
+    }
 
+    void RenderEnvironment::createDepthImages(VkExtent2D extent)
+    {
         depthFormat = findDepthFormat();
 
         for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
@@ -596,6 +611,22 @@ namespace vke_render
         EndSingleTimeCommands(GetGraphicsQueue(), commandPool, tmpCmdBuffer);
     }
 
+    void RenderEnvironment::createOffscreenTargets(uint32_t width, uint32_t height)
+    {
+        // one color image per frame in flight, so the image index is the frame index
+        imageCnt = MAX_FRAMES_IN_FLIGHT;
+        swapChainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+        swapChainExtent = {width, height};
+        swapChainImages.resize(imageCnt);
+        offscreenImageVmaAllocations.resize(imageCnt);
+        for (uint32_t i = 0; i < imageCnt; ++i)
+            CreateImage(width, height, swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL,
+                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, 1,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &swapChainImages[i], &offscreenImageVmaAllocations[i], nullptr);
+        VKE_LOG_INFO("HEADLESS {}x{} IMAGE COUNT {}", width, height, imageCnt);
+        createDepthImages(swapChainExtent);
+    }
+
     void RenderEnvironment::createSyncObjects()
     {
         imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
@@ -642,6 +673,20 @@ namespace vke_render
         vkDestroySwapchainKHR(globalLogicalDevice, swapChain, nullptr);
     }
 
+    void RenderEnvironment::cleanupOffscreenTargets()
+    {
+        for (uint32_t i = 0; i < imageCnt; ++i)
+        {
+            vkDestroyImageView(globalLogicalDevice, swapChainImageViews[i], nullptr);
+            vmaDestroyImage(vmaAllocator, swapChainImages[i], offscreenImageVmaAllocations[i]);
+        }
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            vkDestroyImageView(globalLogicalDevice, depthImageViews[i], nullptr);
+            vmaDestroyImage(vmaAllocator, depthImages[i], depthImageVmaAllocations[i]);
+        }
+    }
+
     void RenderEnvironment::recreateSwapChain()
     {
         vkDeviceWaitIdle(globalLogicalDevice);
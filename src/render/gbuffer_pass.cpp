@@ -1,4 +1,5 @@
 #include <render/gbuffer_pass.hpp>
+#include <render/skinning_graph.hpp>
 
 namespace vke_render
 {
@@ -31,6 +32,7 @@ namespace vke_render
                                           VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
 
         currentResourceNodeID[depthAttachmentResourceID] = gbufferOutDepthResourceNodeID;
+        ReadSkinnedVertices(frameGraph, gbufferTaskNodeID, blackboard, currentResourceNodeID);
     }
 
     static const std::vector<uint32_t> noskinVertexAttributeSizes = {sizeof(vke_render::Vertex::pos), sizeof(vke_render::Vertex::normal),
@@ -0,0 +1,103 @@
+#include <render/glyph_manager.hpp>
+#include <algorithm>
+#include <bit>
+
+namespace vke_render
+{
+    GlyphManager::GlyphManager() : cpuGlyphData(std::make_shared<CPUGlyphData>())
+    {
+        for (FrameGlyphBuffers &frame : frames)
+        {
+            growDeviceBuffer(frame, GLYPHS_PER_PAGE);
+            growStagingBuffer(frame, GLYPHS_PER_PAGE);
+        }
+    }
+
+    void GlyphManager::Sync(uint32_t currentFrame)
+    {
+        FrameGlyphBuffers &frame = frames[currentFrame];
+        CPUGlyphData &glyphData = *cpuGlyphData;
+        frame.copies.clear();
+
+        // a new buffer starts out empty, so everything live has to go into it
+        const uint32_t glyphEnd = glyphData.glyphs.GetEnd();
+        if (glyphEnd > frame.capacity)
+        {
+            growDeviceBuffer(frame, glyphEnd);
+            glyphData.dirtySpans.MarkFrame(currentFrame, 0, glyphEnd);
+        }
+        if (!glyphData.dirtySpans.IsDirty(currentFrame))
+            return;
+
+        glyphData.dirtySpans.Take(currentFrame, spans, GLYPH_UPLOAD_MERGE_GAP);
+        uint32_t stagedCnt = 0;
+        for (vke_ds::Span &span : spans)
+        {
+            // released glyphs past the end need no upload
+            span.end = std::min(span.end, glyphEnd);
+            stagedCnt += span.end > span.begin ? span.end - span.begin : 0;
+        }
+        if (stagedCnt == 0)
+            return;
+        growStagingBuffer(frame, stagedCnt);
+
+        GlyphInstanceGPU *staged = static_cast<GlyphInstanceGPU *>(frame.stagingBuffer->data);
+        VkDeviceSize stagingOffset = 0;
+        for (const vke_ds::Span &span : spans)
+        {
+            if (span.end <= span.begin)
+                continue;
+            glyphData.glyphs.CopyOut(span.begin, span.end, staged);
+            staged += span.end - span.begin;
+
+            VkBufferCopy copy{};
+            copy.srcOffset = stagingOffset;
+            copy.dstOffset = static_cast<VkDeviceSize>(span.begin) * sizeof(GlyphInstanceGPU);
+            copy.size = static_cast<VkDeviceSize>(span.end - span.begin) * sizeof(GlyphInstanceGPU);
+            frame.copies.push_back(copy);
+            stagingOffset += copy.size;
+        }
+    }
+
+    void GlyphManager::RecordUpload(VkCommandBuffer commandBuffer, uint32_t currentFrame)
+    {
+        FrameGlyphBuffers &frame = frames[currentFrame];
+        if (frame.copies.empty())
+            return;
+
+        vkCmdCopyBuffer(commandBuffer, frame.stagingBuffer->buffer, frame.deviceBuffer->buffer,
+                        static_cast<uint32_t>(frame.copies.size()), frame.copies.data());
+        frame.copies.clear();
+
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = frame.deviceBuffer->buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+
+    // the frame's previous submission has completed by the time Sync runs, so its buffers can be replaced
+    void GlyphManager::growDeviceBuffer(FrameGlyphBuffers &frame, uint32_t glyphCnt)
+    {
+        const uint32_t pageCnt = std::bit_ceil((glyphCnt + GLYPHS_PER_PAGE - 1) / GLYPHS_PER_PAGE);
+        frame.capacity = pageCnt * GLYPHS_PER_PAGE;
+        frame.deviceBuffer = std::make_unique<DeviceBuffer>(
+            static_cast<VkDeviceSize>(frame.capacity) * sizeof(GlyphInstanceGPU), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        ++frame.version;
+    }
+
+    void GlyphManager::growStagingBuffer(FrameGlyphBuffers &frame, uint32_t glyphCnt)
+    {
+        if (glyphCnt <= frame.stagingCapacity)
+            return;
+        frame.stagingCapacity = std::bit_ceil(glyphCnt);
+        frame.stagingBuffer = std::make_unique<HostCoherentBuffer>(
+            static_cast<VkDeviceSize>(frame.stagingCapacity) * sizeof(GlyphInstanceGPU), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    }
+}
@@ -379,7 +379,6 @@ namespace vke_render
         for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame)
         {
             rendererDescriptorSets[frame] = textShader->CreateDescriptorSet(0);
-            VkDescriptorBufferInfo glyphBufferInfo = glyphManager->GetDescriptorBufferInfo(frame);
 
             VkDescriptorImageInfo staticAtlasInfo{
                 font->atlasTexture->textureSampler, font->atlasTexture->textureImageView,
@@ -387,20 +386,33 @@ namespace vke_render
             VkDescriptorImageInfo dynamicAtlasInfo{
                 dynamicAtlasTextures[frame]->textureSampler, dynamicAtlasTextures[frame]->textureImageView,
                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
-            VkWriteDescriptorSet writes[3];
+            VkWriteDescriptorSet writes[2];
             ConstructDescriptorSetWrite(writes[0], rendererDescriptorSets[frame], 0,
                                         VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &staticAtlasInfo);
             ConstructDescriptorSetWrite(writes[1], rendererDescriptorSets[frame], 1,
                                         VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &dynamicAtlasInfo);
-            ConstructDescriptorSetWrite(writes[2], rendererDescriptorSets[frame], 2,
-                                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &glyphBufferInfo);
-            vkUpdateDescriptorSets(globalLogicalDevice, 3, writes, 0, nullptr);
+            vkUpdateDescriptorSets(globalLogicalDevice, 2, writes, 0, nullptr);
+            writeGlyphBufferDescriptor(frame);
         }
     }
 
+    void Layered2DRenderer::writeGlyphBufferDescriptor(uint32_t frame)
+    {
+        VkDescriptorBufferInfo glyphBufferInfo = glyphManager->GetDescriptorBufferInfo(frame);
+        VkWriteDescriptorSet write;
+        ConstructDescriptorSetWrite(write, rendererDescriptorSets[frame], 2,
+                                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &glyphBufferInfo);
+        vkUpdateDescriptorSets(globalLogicalDevice, 1, &write, 0, nullptr);
+        glyphBufferVersions[frame] = glyphManager->GetBufferVersion(frame);
+    }
+
     void Layered2DRenderer::Render(TaskNode &, FrameGraph &, VkCommandBuffer commandBuffer,
                                    uint32_t currentFrame, uint32_t imageIndex)
     {
+        // the glyph buffer grew in Sync, this frame's set is not in use by the GPU any more
+        if (glyphBufferVersions[currentFrame] != glyphManager->GetBufferVersion(currentFrame))
+            writeGlyphBufferDescriptor(currentFrame);
+        glyphManager->RecordUpload(commandBuffer, currentFrame);
         syncDynamicAtlas(commandBuffer, currentFrame);
         if (layers.empty())
             return;
@@ -445,10 +457,32 @@ namespace vke_render
 
     void Layered2DRenderer::syncDynamicAtlas(VkCommandBuffer commandBuffer, uint32_t currentFrame)
     {
-        if (font->GetDynamicAtlasUpdateCnt() == 0)
+        if (!font->HasDynamicAtlasUpdate(currentFrame))
             return;
+
+        // only the slots written since this frame's texture was last updated, at their atlas offsets
+        font->TakeDynamicAtlasUpdate(currentFrame, dynamicAtlasRegions);
         const auto &pixels = font->GetDynamicAtlasPixels();
-        dynamicAtlasStagingBuffers[currentFrame]->ToBuffer(0, pixels.data(), pixels.size());
+        HostCoherentBuffer &stagingBuffer = *dynamicAtlasStagingBuffers[currentFrame];
+        dynamicAtlasCopies.clear();
+        for (const vke_common::AtlasRegion &region : dynamicAtlasRegions)
+        {
+            const size_t offset = static_cast<size_t>(region.y) * vke_common::Font::ATLAS_SIZE + region.x;
+            for (uint32_t row = 0; row < region.height; ++row)
+            {
+                const size_t rowOffset = offset + static_cast<size_t>(row) * vke_common::Font::ATLAS_SIZE;
+                stagingBuffer.ToBuffer(rowOffset, pixels.data() + rowOffset, region.width);
+            }
+
+            VkBufferImageCopy copy{};
+            copy.bufferOffset = offset;
+            copy.bufferRowLength = vke_common::Font::ATLAS_SIZE;
+            copy.bufferImageHeight = 0;
+            copy.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+            copy.imageOffset = {static_cast<int32_t>(region.x), static_cast<int32_t>(region.y), 0};
+            copy.imageExtent = {region.width, region.height, 1};
+            dynamicAtlasCopies.push_back(copy);
+        }
 
         VkImageMemoryBarrier barrier{};
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -462,15 +496,14 @@ namespace vke_render
         barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
         vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
                              0, 0, nullptr, 0, nullptr, 1, &barrier);
-        RenderEnvironment::CopyBufferToImage(commandBuffer, dynamicAtlasStagingBuffers[currentFrame]->buffer,
-                                             dynamicAtlasTextures[currentFrame]->textureImage,
-                                             vke_common::Font::ATLAS_SIZE, vke_common::Font::ATLAS_SIZE);
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.buffer, dynamicAtlasTextures[currentFrame]->textureImage,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(dynamicAtlasCopies.size()), dynamicAtlasCopies.data());
         barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
         barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
         barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
                              0, 0, nullptr, 0, nullptr, 1, &barrier);
-        font->ConsumeDynamicAtlasUpdate();
     }
 }
@@ -7,24 +7,22 @@ namespace vke_render
     {
         init();
         shadowManager = std::make_unique<ShadowManager>(ctx, frameGraph, cpuLightData, cameraInfo, config);
-        lightUpdateCnts[(int)LightType::DIRECTIONAL_LIGHT] = MAX_FRAMES_IN_FLIGHT;
+        directionalShadowSyncCnt = MAX_FRAMES_IN_FLIGHT;
     }
 
     void LightManager::init()
     {
         cpuLightData = std::make_shared<CPULightData>();
+        dirtyRanges.assign((int)LightType::LIGHT_TYPE_CNT, LightDirtyRanges(MAX_FRAMES_IN_FLIGHT));
         for (int i = 0; i < (int)LightType::LIGHT_TYPE_CNT; ++i)
-        {
-            lightUpdateCnts[i] = 0;
             dirtyFlags[i] = false;
-        }
 
         auto lightCullingShader = vke_common::AssetManager::LoadComputeShader(vke_common::BUILTIN_COMPUTE_SHADER_LIGHTCULL_ID);
         lightCullingTask = std::make_unique<ComputePipeline>(lightCullingShader);
 
         for (int i = 0; i < (int)LightType::LIGHT_TYPE_CNT; ++i)
             for (int j = 0; j < MAX_FRAMES_IN_FLIGHT; ++j)
-                lightBuffers[i][j] = std::make_unique<DeviceBuffer>(LIGHT_SIZES[i] * MAX_LIGHT_CNTS[i], VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+                lightBuffers[i][j] = std::make_unique<HostCoherentBuffer>(LIGHT_SIZES[i] * MAX_LIGHT_CNTS[i], VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
 
         for (int i = 0; i < 2; ++i)
             for (int j = 0; j < MAX_FRAMES_IN_FLIGHT; ++j)
@@ -132,27 +130,28 @@ namespace vke_render
     {
         bool directionalDirty = dirtyFlags[(int)LightType::DIRECTIONAL_LIGHT];
         for (int i = 0; i < (int)LightType::LIGHT_TYPE_CNT; ++i)
-        {
-            if (dirtyFlags[i])
-            {
-                lightUpdateCnts[i] = MAX_FRAMES_IN_FLIGHT;
-                dirtyFlags[i] = false;
-            }
-        }
+            dirtyFlags[i] = false;
 
         if (cameraUpdated || directionalDirty)
             shadowManager->UpdateDirectionalShadowInfo();
+        if (directionalDirty)
+            directionalShadowSyncCnt = MAX_FRAMES_IN_FLIGHT;
 
-        bool directionalSync = lightUpdateCnts[(int)LightType::DIRECTIONAL_LIGHT] > 0;
+        // the frame graph has waited on this frame's fences, the GPU is done reading its copy
         for (int i = 0; i < (int)LightType::LIGHT_TYPE_CNT; ++i)
         {
-            if (lightUpdateCnts[i] > 0)
-            {
-                --lightUpdateCnts[i];
-                RenderEnvironment::CopyBuffer(cpuLightData->cpuLightBuffers[i]->buffer, lightBuffers[i][currentFrame]->buffer,
-                                              cpuLightData->cpuLightBuffers[i]->bufferSize);
-            }
+            if (!dirtyRanges[i].IsDirty(currentFrame))
+                continue;
+            dirtyRanges[i].Take(currentFrame, cpuLightData->lightCnts[i], uploadSpans);
+            const char *src = static_cast<const char *>(cpuLightData->cpuLightBuffers[i]->data);
+            for (const vke_ds::Span &span : uploadSpans)
+                lightBuffers[i][currentFrame]->ToBuffer(span.begin * LIGHT_SIZES[i], src + span.begin * LIGHT_SIZES[i],
+                                                        (span.end - span.begin) * LIGHT_SIZES[i]);
         }
+        shadowManager->PrepareShadowViews();
+        bool directionalSync = directionalShadowSyncCnt > 0;
+        if (directionalSync)
+            --directionalShadowSyncCnt;
         if (cameraUpdated || directionalSync)
             shadowManager->SyncDirectionalShadowToGPU(currentFrame);
         shadowManager->SyncSpotShadowToGPU(currentFrame);
@@ -171,7 +170,7 @@ namespace vke_render
         cpuLightData = lighting == nullptr ? std::make_shared<CPULightData>() : std::move(lighting);
         for (int i = 0; i < (int)LightType::LIGHT_TYPE_CNT; ++i)
         {
-            lightUpdateCnts[i] = MAX_FRAMES_IN_FLIGHT;
+            dirtyRanges[i].Reset(cpuLightData->lightCnts[i]);
             dirtyFlags[i] = true;
         }
 
@@ -188,7 +187,7 @@ namespace vke_render
         cpuLightData = std::make_shared<CPULightData>();
         for (int i = 0; i < (int)LightType::LIGHT_TYPE_CNT; ++i)
         {
-            lightUpdateCnts[i] = MAX_FRAMES_IN_FLIGHT;
+            dirtyRanges[i].Reset(cpuLightData->lightCnts[i]);
             dirtyFlags[i] = true;
         }
 
@@ -206,7 +205,7 @@ namespace vke_render
         SpotLight &light = GetLightWithoutCheckByEntity<SpotLight>(entity);
         uint32_t slot = shadowManager->ActivateSpotShadow(entity, light);
         if (slot != 0)
-            dirtyFlags[(int)LightType::SPOT_LIGHT] = true;
+            MarkDirty<SpotLight>(entity);
         return slot;
     }
 
@@ -214,6 +213,6 @@ namespace vke_render
     {
         SpotLight &light = GetLightWithoutCheckByEntity<SpotLight>(entity);
         shadowManager->DeactivateSpotShadow(entity, light);
-        dirtyFlags[(int)LightType::SPOT_LIGHT] = true;
+        MarkDirty<SpotLight>(entity);
     }
 }
@@ -1,127 +1,309 @@
 #include <render/queue.hpp>
 #include <logger.hpp>
+#include <chrono>
 
 namespace vke_render
 {
+    bool VulkanSemaphoreBackend::WaitAny(uint32_t semaphoreCnt, const VkSemaphore *semaphores, const uint64_t *values, uint64_t timeoutNs)
+    {
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.flags = VK_SEMAPHORE_WAIT_ANY_BIT;
+        waitInfo.semaphoreCount = semaphoreCnt;
+        waitInfo.pSemaphores = semaphores;
+        waitInfo.pValues = values;
+        const VkResult result = vkWaitSemaphores(device, &waitInfo, timeoutNs);
+        VKE_FATAL_IF(result != VK_SUCCESS && result != VK_TIMEOUT, "vkWaitSemaphores FAIL")
+        return result == VK_SUCCESS;
+    }
 
-    void CPUCommandQueue::Submit(uint32_t submitCount, const VkSubmitInfo2 *pSubmits, VkFence fence)
+    uint64_t VulkanSemaphoreBackend::GetValue(VkSemaphore semaphore)
+    {
+        uint64_t value = 0;
+        VKE_VK_CHECK(vkGetSemaphoreCounterValue(device, semaphore, &value), "vkGetSemaphoreCounterValue FAIL")
+        return value;
+    }
+
+    void VulkanSemaphoreBackend::Signal(VkSemaphore semaphore, uint64_t value)
+    {
+        VkSemaphoreSignalInfo signalInfo{};
+        signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+        signalInfo.semaphore = semaphore;
+        signalInfo.value = value;
+        VKE_VK_CHECK(vkSignalSemaphore(device, &signalInfo), "vkSignalSemaphore FAIL")
+    }
+
+    VkSemaphore VulkanSemaphoreBackend::CreateTimelineSemaphore(uint64_t initialValue)
+    {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = initialValue;
+        VkSemaphoreCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        createInfo.pNext = &typeInfo;
+        VkSemaphore semaphore;
+        VKE_VK_CHECK(vkCreateSemaphore(device, &createInfo, nullptr, &semaphore), "Failed to create timeline semaphore")
+        return semaphore;
+    }
+
+    void VulkanSemaphoreBackend::DestroySemaphore(VkSemaphore semaphore)
+    {
+        vkDestroySemaphore(device, semaphore, nullptr);
+    }
+
+    bool MockSemaphoreBackend::anyReached(uint32_t semaphoreCnt, const VkSemaphore *semaphores, const uint64_t *waitValues)
     {
-        std::shared_ptr<uint32_t> submitCnt = std::make_shared<uint32_t>(submitCount);
+        for (uint32_t i = 0; i < semaphoreCnt; ++i)
+            if (values[semaphores[i]] >= waitValues[i])
+                return true;
+        return false;
+    }
 
-        std::lock_guard lock(queueMutex);
-        for (int i = 0; i < submitCount; i++)
+    bool MockSemaphoreBackend::WaitAny(uint32_t semaphoreCnt, const VkSemaphore *semaphores, const uint64_t *waitValues, uint64_t timeoutNs)
+    {
+        waitCnt.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(mutex);
+        auto reached = [&]()
+        { return anyReached(semaphoreCnt, semaphores, waitValues); };
+        if (timeoutNs == UINT64_MAX)
         {
-            const VkSubmitInfo2 &submitInfo = pSubmits[i];
+            changed.wait(lock, reached);
+            return true;
+        }
+        return changed.wait_for(lock, std::chrono::nanoseconds(timeoutNs), reached);
+    }
 
-            std::shared_ptr<SubmitInfo> localSubmitInfo = std::make_shared<SubmitInfo>(submitInfo.signalSemaphoreInfoCount,
-                                                                                       (std::function<void()> *)(submitInfo.pCommandBufferInfos[0].commandBuffer));
+    uint64_t MockSemaphoreBackend::GetValue(VkSemaphore semaphore)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return values[semaphore];
+    }
 
-            for (int j = 0; j < submitInfo.signalSemaphoreInfoCount; j++)
-                localSubmitInfo->signalSemaphoreInfos[j] = submitInfo.pSignalSemaphoreInfos[j];
+    void MockSemaphoreBackend::Signal(VkSemaphore semaphore, uint64_t value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint64_t &current = values[semaphore];
+            // timeline semaphores only move forward, Vulkan requires it of signals
+            VKE_FATAL_IF(value <= current, "Timeline semaphore signaled with {} at {}", value, current)
+            current = value;
+        }
+        changed.notify_all();
+    }
 
-            auto callback = [this, localSubmitInfo, fence, submitCnt]()
-            {
-                (*(localSubmitInfo->callback))();
+    VkSemaphore MockSemaphoreBackend::CreateTimelineSemaphore(uint64_t initialValue)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        VkSemaphore semaphore = reinterpret_cast<VkSemaphore>(nextHandle++);
+        values[semaphore] = initialValue;
+        return semaphore;
+    }
 
-                for (auto &signalSemInfo : localSubmitInfo->signalSemaphoreInfos)
+    void MockSemaphoreBackend::DestroySemaphore(VkSemaphore semaphore)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        values.erase(semaphore);
+    }
+
+    void CPUCommandQueue::Start()
+    {
+        bool r = false;
+        if (!running.compare_exchange_strong(r, true))
+            return;
+        wakeValue = 0;
+        wakeSemaphore = backend->CreateTimelineSemaphore(0);
+        waiter = std::thread(&CPUCommandQueue::waitLoop, this);
+        for (uint32_t i = 0; i < callbackThreadCnt; ++i)
+            callbackThreads.emplace_back(&CPUCommandQueue::callbackLoop, this);
+    }
+
+    void CPUCommandQueue::Stop()
+    {
+        bool r = true;
+        if (!running.compare_exchange_strong(r, false))
+            return;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            backend->Signal(wakeSemaphore, ++wakeValue);
+        }
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+        }
+        readyCondition.notify_all();
+        waiter.join();
+        for (std::thread &thread : callbackThreads)
+            thread.join();
+        callbackThreads.clear();
+
+        backend->DestroySemaphore(wakeSemaphore);
+        wakeSemaphore = VK_NULL_HANDLE;
+        waitList.clear();
+        readySubmissions.clear();
+        freeSubmissions.clear();
+        for (std::unique_ptr<Submission> &submission : submissions)
+            freeSubmissions.push_back(submission.get());
+        inFlightCnt.store(0);
+        inFlightCnt.notify_all();
+    }
+
+    CPUCommandQueue::Submission *CPUCommandQueue::allocateSubmission()
+    {
+        if (freeSubmissions.empty())
+        {
+            submissions.push_back(std::make_unique<Submission>());
+            return submissions.back().get();
+        }
+        Submission *submission = freeSubmissions.back();
+        freeSubmissions.pop_back();
+        return submission;
+    }
+
+    void CPUCommandQueue::Submit(uint32_t submitCount, const VkSubmitInfo2 *pSubmits, VkFence fence)
+    {
+        std::shared_ptr<std::atomic<uint32_t>> fenceCnt;
+        if (fence != VK_NULL_HANDLE)
+            fenceCnt = std::make_shared<std::atomic<uint32_t>>(submitCount);
+        std::vector<Submission *> ready;
+        inFlightCnt.fetch_add(submitCount);
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            for (uint32_t i = 0; i < submitCount; ++i)
+            {
+                const VkSubmitInfo2 &submitInfo = pSubmits[i];
+                Submission *submission = allocateSubmission();
+                submission->callback = (std::function<void()> *)(submitInfo.pCommandBufferInfos[0].commandBuffer);
+                submission->signalSemaphoreInfos.assign(submitInfo.pSignalSemaphoreInfos,
+                                                        submitInfo.pSignalSemaphoreInfos + submitInfo.signalSemaphoreInfoCount);
+                submission->fence = (std::atomic<bool> *)fence;
+                submission->fenceCnt = fenceCnt;
+                submission->remainingWaitCnt = submitInfo.waitSemaphoreInfoCount;
+                if (submitInfo.waitSemaphoreInfoCount == 0)
                 {
-                    VkSemaphoreSignalInfo signalInfo = {};
-                    signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
-                    signalInfo.semaphore = signalSemInfo.semaphore;
-                    signalInfo.value = signalSemInfo.value;
-                    VKE_LOG_DEBUG("submitCnt {} CPU SIGNAL {} {}", (*submitCnt), (void *)(signalSemInfo.semaphore), signalSemInfo.value)
-                    vkSignalSemaphore(device, &signalInfo);
+                    ready.push_back(submission);
+                    continue;
                 }
-
-                if (fence != nullptr && --(*submitCnt) == 0)
+                for (uint32_t j = 0; j < submitInfo.waitSemaphoreInfoCount; ++j)
                 {
-                    VKE_LOG_DEBUG("SET CPU FENCE OK {}", (void *)fence)
-                    ((std::atomic<bool> *)fence)->store(true);
-                    ((std::atomic<bool> *)fence)->notify_one();
+                    const VkSemaphoreSubmitInfo &waitInfo = submitInfo.pWaitSemaphoreInfos[j];
+                    const PendingWait wait{waitInfo.semaphore, waitInfo.value, submission};
+                    waitList.insert(std::upper_bound(waitList.begin(), waitList.end(), wait), wait);
                 }
-            };
-            std::shared_ptr<uint32_t> counter = std::make_unique<uint32_t>(submitInfo.waitSemaphoreInfoCount);
-            for (int j = 0; j < submitInfo.waitSemaphoreInfoCount; j++)
-            {
-                const VkSemaphoreSubmitInfo &waitInfo = submitInfo.pWaitSemaphoreInfos[j];
-                waitInfoMap.try_emplace(waitInfo.semaphore).first->second.emplace(waitInfo.value, counter, callback);
-                // 多个等待同一组callback
             }
+            // the waiter may be blocked on a list without the new waits; under the lock, so that
+            // concurrent submits signal increasing values
+            if (ready.size() < submitCount)
+                backend->Signal(wakeSemaphore, ++wakeValue);
         }
-        idle.store(false);
-        idle.notify_one();
-        queueCV.notify_one();
+        if (!ready.empty())
+            makeReady(ready);
     }
 
-    void CPUCommandQueue::process()
+    void CPUCommandQueue::makeReady(std::vector<Submission *> &ready)
     {
-        VkSemaphoreWaitInfo semWaitInfo{};
-        semWaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
-        semWaitInfo.flags = VK_SEMAPHORE_WAIT_ANY_BIT;
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            readySubmissions.insert(readySubmissions.end(), ready.begin(), ready.end());
+        }
+        if (ready.size() == 1)
+            readyCondition.notify_one();
+        else
+            readyCondition.notify_all();
+        ready.clear();
+    }
 
-        std::vector<VkSemaphore> sems;
-        std::vector<uint64_t> vals;
-        std::vector<std::function<void()>> callbacks;
+    void CPUCommandQueue::waitLoop()
+    {
+        std::vector<VkSemaphore> semaphores;
+        std::vector<uint64_t> values;
+        std::vector<Submission *> ready;
+        uint64_t seenWakeValue = 0;
 
-        std::unique_lock lock(queueMutex);
         while (running.load())
         {
-            bool empty = true;
-            for (auto &[semaphore, infoQueue] : waitInfoMap)
             {
-                if (infoQueue.size() > 0)
-                {
-                    empty = false;
-                    break;
-                }
+                // the wake-up semaphore, then the smallest pending value of every semaphore; waiting
+                // for more of one semaphore would not wake the thread any sooner
+                std::lock_guard<std::mutex> lock(queueMutex);
+                semaphores.assign(1, wakeSemaphore);
+                values.assign(1, seenWakeValue + 1);
+                for (size_t i = 0; i < waitList.size(); ++i)
+                    if (i == 0 || waitList[i].semaphore != waitList[i - 1].semaphore)
+                    {
+                        semaphores.push_back(waitList[i].semaphore);
+                        values.push_back(waitList[i].value);
+                    }
             }
+            backend->WaitAny(static_cast<uint32_t>(semaphores.size()), semaphores.data(), values.data(), UINT64_MAX);
+            seenWakeValue = backend->GetValue(wakeSemaphore);
 
-            if (empty)
-            {
-                idle.store(true);
-                idle.notify_one();
-                queueCV.wait(lock);
-                continue;
-            }
-            for (auto &[semaphore, infoQueue] : waitInfoMap)
             {
-                for (auto &waitInfo : infoQueue)
+                std::lock_guard<std::mutex> lock(queueMutex);
+                // one pass: read each semaphore once, drop the waits it satisfies, keep the rest in order
+                size_t kept = 0;
+                uint64_t current = 0;
+                for (size_t i = 0; i < waitList.size(); ++i)
                 {
-                    sems.push_back(semaphore);
-                    vals.push_back(waitInfo.value);
+                    const PendingWait &wait = waitList[i];
+                    if (i == 0 || wait.semaphore != waitList[i - 1].semaphore)
+                        current = backend->GetValue(wait.semaphore);
+                    if (wait.value <= current)
+                    {
+                        if (--wait.submission->remainingWaitCnt == 0)
+                            ready.push_back(wait.submission);
+                    }
+                    else
+                        waitList[kept++] = wait;
                 }
+                waitList.resize(kept);
             }
-            semWaitInfo.semaphoreCount = sems.size();
-            semWaitInfo.pSemaphores = sems.data();
-            semWaitInfo.pValues = vals.data();
-            lock.unlock();
+            if (!ready.empty())
+                makeReady(ready);
+        }
+    }
 
-            if (vkWaitSemaphores(device, &semWaitInfo, CPU_QUEUE_WAIT_TIMEOUT) == VK_SUCCESS)
+    void CPUCommandQueue::callbackLoop()
+    {
+        while (true)
+        {
+            Submission *submission;
             {
-                lock.lock();
-                for (auto &[semaphore, infoQueue] : waitInfoMap)
-                {
-                    uint64_t currentVal;
-                    if (vkGetSemaphoreCounterValue(device, semaphore, &currentVal) == VK_SUCCESS)
-                    {
-                        auto ub = infoQueue.upper_bound(currentVal);
-                        for (auto it = infoQueue.begin(); it != ub; ++it)
-                            if (--(*(it->counter)) == 0)
-                                callbacks.push_back(it->callback);
+                std::unique_lock<std::mutex> lock(readyMutex);
+                readyCondition.wait(lock, [this]()
+                                    { return !readySubmissions.empty() || !running.load(); });
+                if (!running.load())
+                    return;
+                submission = readySubmissions.front();
+                readySubmissions.pop_front();
+            }
+            run(submission);
+        }
+    }
 
-                        infoQueue.erase(infoQueue.begin(), ub);
-                    }
-                }
-                lock.unlock();
+    void CPUCommandQueue::run(Submission *submission)
+    {
+        (*(submission->callback))();
 
-                for (auto &callback : callbacks)
-                    callback();
-            }
+        for (const VkSemaphoreSubmitInfo &signalInfo : submission->signalSemaphoreInfos)
+        {
+            VKE_LOG_DEBUG("CPU SIGNAL {} {}", (void *)(signalInfo.semaphore), signalInfo.value)
+            backend->Signal(signalInfo.semaphore, signalInfo.value);
+        }
 
-            callbacks.clear();
-            sems.clear();
-            vals.clear();
-            lock.lock();
+        if (submission->fence != nullptr && submission->fenceCnt->fetch_sub(1) == 1)
+        {
+            VKE_LOG_DEBUG("SET CPU FENCE OK {}", (void *)(submission->fence))
+            submission->fence->store(true);
+            submission->fence->notify_all();
+        }
+
+        submission->fenceCnt.reset();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            freeSubmissions.push_back(submission);
         }
+        if (inFlightCnt.fetch_sub(1) == 1)
+            inFlightCnt.notify_all();
     }
-}
\ No newline at end of file
+}
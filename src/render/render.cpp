@@ -67,7 +67,7 @@ namespace vke_render
     {
         instance->frameGraph = std::make_unique<FrameGraph>(MAX_FRAMES_IN_FLIGHT);
         colorAttachmentResourceID = frameGraph->AddPermanentImageResource("colorAttachment", true, context->colorImages.data(), VK_IMAGE_ASPECT_COLOR_BIT, true,
-                                                                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+                                                                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_LAYOUT_UNDEFINED, context->outColorLayout);
         depthAttachmentResourceID = frameGraph->AddPermanentImageResource("depthAttachment", true, context->depthImages, VK_IMAGE_ASPECT_DEPTH_BIT, false,
                                                                           VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, std::nullopt, std::nullopt);
 
@@ -116,6 +116,8 @@ namespace vke_render
 
         lightManager->Update(currentFrame, cameraUpdated);
         glyphManager.Sync(currentFrame);
+        if (computeSkinningManager != nullptr)
+            computeSkinningManager->Update(currentFrame);
 
         frameGraph->PrepareForExecute(currentFrame);
 
@@ -131,4 +133,13 @@ namespace vke_render
         render();
         currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
     }
+
+    void Renderer::UpdateWithoutRendering()
+    {
+        for (auto &kv : renderUpdateCallbacks)
+            kv.second(currentFrame);
+        glyphManager.SkipSync();
+        lightManager->SkipUpdate();
+        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    }
 }
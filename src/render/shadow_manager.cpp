@@ -2,6 +2,7 @@
 #include <render/light.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 
 #ifdef near
@@ -73,10 +74,21 @@ namespace vke_render
         return std::ceil(radius * 16.0f) / 16.0f;
     }
 
+    static ShadowViewKey ToShadowViewKey(const glm::mat4 &viewProj)
+    {
+        ShadowViewKey key;
+        std::memcpy(key.data(), &viewProj[0][0], sizeof(key));
+        return key;
+    }
+
     ShadowManager::ShadowManager(RenderContext *ctx, FrameGraph &frameGraph, std::shared_ptr<CPULightData> cpuLightData, const CameraInfo *cameraInfo,
                                  const DirectionalShadowConfig &directionalConfig)
         : context(ctx), cpuLightData(cpuLightData), cameraInfo(cameraInfo), directionalConfig(directionalConfig),
-          shadowMapSampler(VK_NULL_HANDLE)
+          spotShadowMapImage(VK_NULL_HANDLE), spotShadowMapAllocation(nullptr), spotShadowMapImageView(VK_NULL_HANDLE),
+          directionalCacheImage(VK_NULL_HANDLE), directionalCacheAllocation(nullptr),
+          spotCacheImage(VK_NULL_HANDLE), spotCacheAllocation(nullptr), shadowMapSampler(VK_NULL_HANDLE),
+          directionalCache(MAX_DIRECTIONAL_SHADOW_CASCADE_CNT), spotCache(MAX_SPOT_LIGHT_SHADOW_CNT),
+          spotSchedule(MAX_SPOT_LIGHT_SHADOW_CNT), dynamicCasterCnt(0), frameCnt(0)
     {
         for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
         {
@@ -86,22 +98,24 @@ namespace vke_render
             deferredLightingDescriptorSets[i] = VK_NULL_HANDLE;
             directionalShadowMapImages[i] = VK_NULL_HANDLE;
             directionalShadowMapImageViews[i] = VK_NULL_HANDLE;
-            spotShadowMapImages[i] = VK_NULL_HANDLE;
-            spotShadowMapImageViews[i] = VK_NULL_HANDLE;
             for (uint32_t cascade = 0; cascade < MAX_DIRECTIONAL_SHADOW_CASCADE_CNT; ++cascade)
                 directionalShadowCascadeImageViews[i][cascade] = VK_NULL_HANDLE;
-            for (uint32_t slot = 0; slot < MAX_SPOT_LIGHT_SHADOW_CNT; ++slot)
-                spotShadowMapLayerViews[i][slot] = VK_NULL_HANDLE;
         }
 
+        for (uint32_t cascade = 0; cascade < MAX_DIRECTIONAL_SHADOW_CASCADE_CNT; ++cascade)
+            directionalCacheLayerViews[cascade] = VK_NULL_HANDLE;
         for (uint32_t slot = 0; slot < MAX_SPOT_LIGHT_SHADOW_CNT; ++slot)
         {
+            spotShadowMapLayerViews[slot] = VK_NULL_HANDLE;
+            spotCacheLayerViews[slot] = VK_NULL_HANDLE;
             spotShadowLightEntities[slot] = entt::null;
             spotShadowUpdateCnts[slot] = 0;
         }
 
         createDirectionalImages();
         createSpotShadowImages();
+        createSpotShadowImageViews();
+        createCacheImages();
         createSampler();
         createDescriptorSets();
         UpdateDirectionalShadowInfo();
@@ -127,16 +141,20 @@ namespace vke_render
             }
 
             vkDestroyImage(globalLogicalDevice, directionalShadowMapImages[i], nullptr);
+        }
 
-            if (spotShadowMapImageViews[i] != VK_NULL_HANDLE)
-                vkDestroyImageView(globalLogicalDevice, spotShadowMapImageViews[i], nullptr);
-            for (uint32_t slot = 0; slot < MAX_SPOT_LIGHT_SHADOW_CNT; ++slot)
-            {
-                if (spotShadowMapLayerViews[i][slot] != VK_NULL_HANDLE)
-                    vkDestroyImageView(globalLogicalDevice, spotShadowMapLayerViews[i][slot], nullptr);
-            }
-            vkDestroyImage(globalLogicalDevice, spotShadowMapImages[i], nullptr);
+        VmaAllocator allocator = RenderEnvironment::GetInstance()->vmaAllocator;
+        vkDestroyImageView(globalLogicalDevice, spotShadowMapImageView, nullptr);
+        for (uint32_t slot = 0; slot < MAX_SPOT_LIGHT_SHADOW_CNT; ++slot)
+        {
+            vkDestroyImageView(globalLogicalDevice, spotShadowMapLayerViews[slot], nullptr);
+            vkDestroyImageView(globalLogicalDevice, spotCacheLayerViews[slot], nullptr);
         }
+        for (uint32_t cascade = 0; cascade < MAX_DIRECTIONAL_SHADOW_CASCADE_CNT; ++cascade)
+            vkDestroyImageView(globalLogicalDevice, directionalCacheLayerViews[cascade], nullptr);
+        vmaDestroyImage(allocator, spotShadowMapImage, spotShadowMapAllocation);
+        vmaDestroyImage(allocator, directionalCacheImage, directionalCacheAllocation);
+        vmaDestroyImage(allocator, spotCacheImage, spotCacheAllocation);
 
         vkDestroySampler(globalLogicalDevice, shadowMapSampler, nullptr);
     }
@@ -203,13 +221,15 @@ namespace vke_render
         {
             spotShadowLightEntities[slot] = entt::null;
             spotShadowInfos[slot] = SpotShadowInfoCPU();
+            pendingSpotShadowInfos[slot] = SpotShadowInfoCPU();
             spotShadowUpdateCnts[slot] = MAX_FRAMES_IN_FLIGHT;
+            spotSchedule.Deactivate(slot);
         }
     }
 
     void ShadowManager::createDirectionalImages()
     {
-        VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
         for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
             RenderEnvironment::CreateImageWithoutMemory(directionalConfig.mapSize, directionalConfig.mapSize,
                                                         context->depthFormat, VK_IMAGE_TILING_OPTIMAL,
@@ -218,12 +238,48 @@ namespace vke_render
 
     void ShadowManager::createSpotShadowImages()
     {
-        VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
-            RenderEnvironment::CreateImageWithoutMemory(spotConfig.mapSize, spotConfig.mapSize,
-                                                        context->depthFormat, VK_IMAGE_TILING_OPTIMAL,
-                                                        usageFlags, 1, &spotShadowMapImages[i],
-                                                        MAX_SPOT_LIGHT_SHADOW_CNT);
+        VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        RenderEnvironment::CreateImage(spotConfig.mapSize, spotConfig.mapSize, context->depthFormat, VK_IMAGE_TILING_OPTIMAL,
+                                       usageFlags, 1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &spotShadowMapImage,
+                                       &spotShadowMapAllocation, nullptr, MAX_SPOT_LIGHT_SHADOW_CNT);
+
+        // the frame graph takes the map over in the layout the last reader leaves it in
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = spotShadowMapImage;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, MAX_SPOT_LIGHT_SHADOW_CNT};
+
+        RenderEnvironment *environment = RenderEnvironment::GetInstance();
+        VkCommandBuffer commandBuffer = RenderEnvironment::BeginSingleTimeCommands(environment->commandPool);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+        RenderEnvironment::EndSingleTimeCommands(RenderEnvironment::GetGraphicsQueue(), environment->commandPool, commandBuffer);
+    }
+
+    void ShadowManager::createCacheImages()
+    {
+        VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        RenderEnvironment::CreateImage(directionalConfig.mapSize, directionalConfig.mapSize, context->depthFormat, VK_IMAGE_TILING_OPTIMAL,
+                                       usageFlags, 1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &directionalCacheImage,
+                                       &directionalCacheAllocation, nullptr, directionalConfig.cascadeCnt);
+        RenderEnvironment::CreateImage(spotConfig.mapSize, spotConfig.mapSize, context->depthFormat, VK_IMAGE_TILING_OPTIMAL,
+                                       usageFlags, 1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &spotCacheImage,
+                                       &spotCacheAllocation, nullptr, MAX_SPOT_LIGHT_SHADOW_CNT);
+
+        for (uint32_t cascade = 0; cascade < directionalConfig.cascadeCnt; ++cascade)
+            directionalCacheLayerViews[cascade] = RenderEnvironment::CreateImageView(directionalCacheImage, context->depthFormat,
+                                                                                     VK_IMAGE_ASPECT_DEPTH_BIT, 1, cascade, 1,
+                                                                                     VK_IMAGE_VIEW_TYPE_2D);
+        for (uint32_t slot = 0; slot < MAX_SPOT_LIGHT_SHADOW_CNT; ++slot)
+            spotCacheLayerViews[slot] = RenderEnvironment::CreateImageView(spotCacheImage, context->depthFormat,
+                                                                           VK_IMAGE_ASPECT_DEPTH_BIT, 1, slot, 1,
+                                                                           VK_IMAGE_VIEW_TYPE_2D);
     }
 
     void ShadowManager::createDirectionalImageViews(uint32_t currentFrame)
@@ -245,22 +301,16 @@ namespace vke_render
         }
     }
 
-    void ShadowManager::createSpotShadowImageViews(uint32_t currentFrame)
+    void ShadowManager::createSpotShadowImageViews()
     {
-        if (spotShadowMapImageViews[currentFrame] != VK_NULL_HANDLE)
-            vkDestroyImageView(globalLogicalDevice, spotShadowMapImageViews[currentFrame], nullptr);
-        spotShadowMapImageViews[currentFrame] = RenderEnvironment::CreateImageView(
-            spotShadowMapImages[currentFrame], context->depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
+        spotShadowMapImageView = RenderEnvironment::CreateImageView(
+            spotShadowMapImage, context->depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
             1, 0, MAX_SPOT_LIGHT_SHADOW_CNT, VK_IMAGE_VIEW_TYPE_2D_ARRAY);
 
         for (uint32_t slot = 0; slot < MAX_SPOT_LIGHT_SHADOW_CNT; ++slot)
-        {
-            if (spotShadowMapLayerViews[currentFrame][slot] != VK_NULL_HANDLE)
-                vkDestroyImageView(globalLogicalDevice, spotShadowMapLayerViews[currentFrame][slot], nullptr);
-            spotShadowMapLayerViews[currentFrame][slot] = RenderEnvironment::CreateImageView(
-                spotShadowMapImages[currentFrame], context->depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
+            spotShadowMapLayerViews[slot] = RenderEnvironment::CreateImageView(
+                spotShadowMapImage, context->depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
                 1, slot, 1, VK_IMAGE_VIEW_TYPE_2D);
-        }
     }
 
     void ShadowManager::createSampler()
@@ -286,7 +336,7 @@ namespace vke_render
     {
         VkDescriptorImageInfo imageInfos[2] = {
             {shadowMapSampler, directionalShadowMapImageViews[currentFrame], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
-            {shadowMapSampler, spotShadowMapImageViews[currentFrame], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL}};
+            {shadowMapSampler, spotShadowMapImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL}};
         VkWriteDescriptorSet descriptorWrites[2];
         ConstructDescriptorSetWrite(descriptorWrites[0], deferredLightingDescriptorSets[currentFrame], 1,
                                     VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &imageInfos[0]);
@@ -397,6 +447,7 @@ namespace vke_render
 
         spotShadowLightEntities[slot] = lightEntity;
         light.SetShadowSlot(true, slot);
+        spotSchedule.Activate(slot);
         CalcSpotShadowVPMatrix(light);
         return slot + 1;
     }
@@ -409,7 +460,9 @@ namespace vke_render
         light.SetShadowSlot(false, 0);
         spotShadowLightEntities[slot] = entt::null;
         spotShadowInfos[slot] = SpotShadowInfoCPU();
+        pendingSpotShadowInfos[slot] = SpotShadowInfoCPU();
         spotShadowUpdateCnts[slot] = MAX_FRAMES_IN_FLIGHT;
+        spotSchedule.Deactivate(slot);
     }
 
     void ShadowManager::CalcSpotShadowVPMatrix(SpotLight &light)
@@ -432,14 +485,41 @@ namespace vke_render
         lightProj[1][1] *= -1.0f;
 
         uint32_t slot = light.GetShadowSlot();
-        spotShadowInfos[slot].lightViewProj = lightProj * lightView;
-        spotShadowUpdateCnts[slot] = MAX_FRAMES_IN_FLIGHT;
+        pendingSpotShadowInfos[slot].lightViewProj = lightProj * lightView;
+        if (pendingSpotShadowInfos[slot].lightViewProj != spotShadowInfos[slot].lightViewProj)
+            spotSchedule.MarkStale(slot);
+    }
+
+    void ShadowManager::PrepareShadowViews()
+    {
+        ++frameCnt;
+        if (directionalShadowInfo.lightIndex.x != INVALID_SHADOW_LIGHT_INDEX)
+            for (uint32_t cascade = 0; cascade < directionalConfig.cascadeCnt; ++cascade)
+                directionalCache.SetKey(cascade, ToShadowViewKey(directionalShadowInfo.lightViewProj[cascade]));
+
+        // a slot's map and the view projection it is sampled with change together, in the frame it is redrawn
+        spotSchedule.Pick(frameCnt, spotConfig.refreshBudget, spotConfig.dynamicRefreshInterval, dynamicCasterCnt > 0, spotSlotsToDraw);
+        for (uint32_t slot : spotSlotsToDraw)
+        {
+            if (spotShadowInfos[slot].lightViewProj != pendingSpotShadowInfos[slot].lightViewProj)
+            {
+                spotShadowInfos[slot] = pendingSpotShadowInfos[slot];
+                spotShadowUpdateCnts[slot] = MAX_FRAMES_IN_FLIGHT;
+            }
+            spotCache.SetKey(slot, ToShadowViewKey(spotShadowInfos[slot].lightViewProj));
+        }
+    }
+
+    void ShadowManager::OnStaticCastersChanged()
+    {
+        directionalCache.InvalidateAll();
+        spotCache.InvalidateAll();
+        spotSchedule.MarkAllStale();
     }
 
     void ShadowManager::onTransientResourcesReady(uint32_t currentFrame)
     {
         createDirectionalImageViews(currentFrame);
-        createSpotShadowImageViews(currentFrame);
         updateDeferredLightingDescriptorSet(currentFrame);
     }
 }
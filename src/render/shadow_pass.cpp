@@ -1,4 +1,5 @@
 #include <render/shadow_pass.hpp>
+#include <render/skinning_graph.hpp>
 
 namespace vke_render
 {
@@ -24,6 +25,48 @@ namespace vke_render
         uint32_t shadowType;
     };
 
+    static void TransitionDepthLayer(VkCommandBuffer commandBuffer, VkImage image, uint32_t layer,
+                                     VkImageLayout oldLayout, VkImageLayout newLayout,
+                                     VkPipelineStageFlags srcStage, VkAccessFlags srcAccessMask,
+                                     VkPipelineStageFlags dstStage, VkAccessFlags dstAccessMask)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccessMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, layer, 1};
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    static void BeginDepthRendering(VkCommandBuffer commandBuffer, VkImageView view, uint32_t size, VkAttachmentLoadOp loadOp)
+    {
+        VkRenderingAttachmentInfo depthAttachmentInfo{};
+        depthAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        depthAttachmentInfo.pNext = nullptr;
+        depthAttachmentInfo.imageView = view;
+        depthAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depthAttachmentInfo.loadOp = loadOp;
+        depthAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        depthAttachmentInfo.clearValue.depthStencil = {1.0f, 0};
+        depthAttachmentInfo.resolveMode = VK_RESOLVE_MODE_NONE;
+
+        VkRenderingInfo renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+        renderingInfo.pNext = nullptr;
+        renderingInfo.renderArea = {{0, 0}, {size, size}};
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = 0;
+        renderingInfo.pColorAttachments = nullptr;
+        renderingInfo.pDepthAttachment = &depthAttachmentInfo;
+
+        vkCmdBeginRendering(commandBuffer, &renderingInfo);
+    }
+
     void ShadowPass::Init(int subpassID,
                           FrameGraph &frameGraph,
                           std::map<std::string, vke_ds::id32_t> &blackboard,
@@ -39,22 +82,39 @@ namespace vke_render
         shadowSkinMaterial->textureBindingInfos = std::make_shared<std::vector<TextureBindingInfo>>();
         registerMaterial(shadowMaterial, false);
         registerMaterial(shadowSkinMaterial, true);
+        staticRenderInfo = std::make_unique<RenderInfo>(shadowMaterial);
+        createGraphicsPipeline(*staticRenderInfo, false);
 
         constructFrameGraph(frameGraph, blackboard, currentResourceNodeID);
     }
 
-    vke_ds::id64_t ShadowPass::AddUnit(RenderUnit *unit, bool isSkin)
+    vke_ds::id64_t ShadowPass::AddUnit(RenderUnit *unit, bool isSkin, bool isStatic)
     {
+        vke_ds::id64_t id = unitAllocator.Alloc();
+        if (isStatic && !isSkin)
+        {
+            staticRenderInfo->units[id] = unit;
+            shadowManager->OnStaticCastersChanged();
+            return id;
+        }
+
         std::shared_ptr<Material> &material = isSkin ? shadowSkinMaterial : shadowMaterial;
         registerMaterial(material, isSkin);
-        vke_ds::id64_t id = unitAllocator.Alloc();
         renderInfoMap[material.get()]->units[id] = unit;
         unitMaterialMap[id] = material.get();
+        shadowManager->SetDynamicCasterCnt(static_cast<uint32_t>(unitMaterialMap.size()));
         return id;
     }
 
     void ShadowPass::RemoveUnit(vke_ds::id64_t id)
     {
+        if (staticRenderInfo->GetUnit(id) != nullptr)
+        {
+            staticRenderInfo->RemoveUnit(id);
+            shadowManager->OnStaticCastersChanged();
+            return;
+        }
+
         auto materialIt = unitMaterialMap.find(id);
         if (materialIt == unitMaterialMap.end())
             return;
@@ -63,6 +123,7 @@ namespace vke_render
         if (renderInfoIt != renderInfoMap.end())
             renderInfoIt->second->RemoveUnit(id);
         unitMaterialMap.erase(materialIt);
+        shadowManager->SetDynamicCasterCnt(static_cast<uint32_t>(unitMaterialMap.size()));
     }
 
     void ShadowPass::constructFrameGraph(FrameGraph &frameGraph,
@@ -87,17 +148,20 @@ namespace vke_render
 
         currentResourceNodeID[shadowMapResourceID] = shadowMapOutResourceNodeID;
 
-        vke_ds::id32_t spotShadowMapResourceID = frameGraph.AddTransientImageResource(
-            "spotShadowMap", shadowManager->GetSpotShadowMapImages(), VK_IMAGE_ASPECT_DEPTH_BIT,
-            1, MAX_SPOT_LIGHT_SHADOW_CNT);
+        // permanent, the slots the schedule skips keep their depth; every reader leaves it shader read only
+        vke_ds::id32_t spotShadowMapResourceID = frameGraph.AddPermanentImageResource(
+            "spotShadowMap", false, shadowManager->GetSpotShadowMapImage(), VK_IMAGE_ASPECT_DEPTH_BIT,
+            1, MAX_SPOT_LIGHT_SHADOW_CNT, false, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
         vke_ds::id32_t spotShadowMapResourceNodeID = frameGraph.AllocResourceNode("spotShadowMapOut", spotShadowMapResourceID);
         blackboard["spotShadowMap"] = spotShadowMapResourceID;
         frameGraph.AddTaskNodeResourceRef(shadowTaskNodeID, 0, spotShadowMapResourceNodeID,
                                           VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
                                           VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-                                          VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE,
+                                          VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE,
                                           VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
         currentResourceNodeID[spotShadowMapResourceID] = spotShadowMapResourceNodeID;
+        ReadSkinnedVertices(frameGraph, shadowTaskNodeID, blackboard, currentResourceNodeID);
     }
 
     void ShadowPass::createGraphicsPipeline(RenderInfo &renderInfo, bool isSkin)
@@ -145,6 +209,71 @@ namespace vke_render
         renderInfoMap[matp] = std::move(info);
     }
 
+    void ShadowPass::drawCasters(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t shadowIndex, uint32_t shadowType,
+                                 bool drawStatic, bool drawDynamic)
+    {
+        auto draw = [&](RenderInfo &renderInfo)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderInfo.renderPipeline->pipeline);
+            vkCmdPushConstants(commandBuffer, renderInfo.renderPipeline->pipelineLayout, VK_SHADER_STAGE_ALL,
+                               offsetof(ShadowPushConstants, shadowIndex), sizeof(uint32_t), &shadowIndex);
+            vkCmdPushConstants(commandBuffer, renderInfo.renderPipeline->pipelineLayout, VK_SHADER_STAGE_ALL,
+                               offsetof(ShadowPushConstants, shadowType), sizeof(uint32_t), &shadowType);
+            renderInfo.Render(commandBuffer, shadowManager->GetShadowPassDescriptorSet(currentFrame));
+        };
+
+        if (drawStatic)
+            draw(*staticRenderInfo);
+        if (drawDynamic)
+            for (auto &kv : renderInfoMap)
+                draw(*kv.second);
+    }
+
+    void ShadowPass::drawShadowView(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t shadowType, uint32_t view,
+                                    ShadowCache &cache, VkImage mapImage, VkImageView mapView, VkImage cacheImage, VkImageView cacheView,
+                                    uint32_t mapSize)
+    {
+        const ShadowCacheAction action = staticRenderInfo->units.empty() ? ShadowCacheAction::BYPASS : cache.BeginDraw(view);
+        if (action == ShadowCacheAction::BYPASS)
+        {
+            BeginDepthRendering(commandBuffer, mapView, mapSize, VK_ATTACHMENT_LOAD_OP_CLEAR);
+            drawCasters(commandBuffer, currentFrame, view, shadowType, true, true);
+            vkCmdEndRendering(commandBuffer);
+            return;
+        }
+
+        const VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        const VkAccessFlags depthAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        if (action == ShadowCacheAction::REDRAW)
+        {
+            // the cache rests in TRANSFER_SRC between frames, earlier copies out of it must finish first
+            TransitionDepthLayer(commandBuffer, cacheImage, view, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, 0, depthStages, depthAccess);
+            BeginDepthRendering(commandBuffer, cacheView, mapSize, VK_ATTACHMENT_LOAD_OP_CLEAR);
+            drawCasters(commandBuffer, currentFrame, view, shadowType, true, false);
+            vkCmdEndRendering(commandBuffer);
+            TransitionDepthLayer(commandBuffer, cacheImage, view, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                 VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+        }
+
+        // the copy overwrites the whole layer, its old depth can be discarded
+        TransitionDepthLayer(commandBuffer, mapImage, view, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             depthStages, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+        VkImageCopy region{};
+        region.srcSubresource = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, view, 1};
+        region.dstSubresource = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, view, 1};
+        region.extent = {mapSize, mapSize, 1};
+        vkCmdCopyImage(commandBuffer, cacheImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       mapImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        TransitionDepthLayer(commandBuffer, mapImage, view, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, depthStages, depthAccess);
+
+        BeginDepthRendering(commandBuffer, mapView, mapSize, VK_ATTACHMENT_LOAD_OP_LOAD);
+        drawCasters(commandBuffer, currentFrame, view, shadowType, false, true);
+        vkCmdEndRendering(commandBuffer);
+    }
+
     void ShadowPass::Render(TaskNode &node, FrameGraph &frameGraph, VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t imageIndex)
     {
         const DirectionalShadowConfig &directionalConfig = shadowManager->GetDirectionalConfig();
@@ -164,44 +293,14 @@ namespace vke_render
         scissor.extent = {directionalConfig.mapSize, directionalConfig.mapSize};
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
+        // the cascades are transient, each frame starts them from the cache
         if (directionalShadowInfo.lightIndex.x != INVALID_SHADOW_LIGHT_INDEX)
             for (uint32_t cascade = 0; cascade < directionalConfig.cascadeCnt; ++cascade)
-            {
-                VkRenderingAttachmentInfo depthAttachmentInfo{};
-                depthAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-                depthAttachmentInfo.pNext = nullptr;
-                depthAttachmentInfo.imageView = shadowManager->GetDirectionalShadowCascadeView(currentFrame, cascade);
-                depthAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-                depthAttachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-                depthAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-                depthAttachmentInfo.clearValue.depthStencil = {1.0f, 0};
-                depthAttachmentInfo.resolveMode = VK_RESOLVE_MODE_NONE;
-
-                VkRenderingInfo renderingInfo{};
-                renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-                renderingInfo.pNext = nullptr;
-                renderingInfo.renderArea = {{0, 0}, {directionalConfig.mapSize, directionalConfig.mapSize}};
-                renderingInfo.layerCount = 1;
-                renderingInfo.colorAttachmentCount = 0;
-                renderingInfo.pColorAttachments = nullptr;
-                renderingInfo.pDepthAttachment = &depthAttachmentInfo;
-
-                vkCmdBeginRendering(commandBuffer, &renderingInfo);
-
-                for (auto &kv : renderInfoMap)
-                {
-                    std::unique_ptr<RenderInfo> &renderInfo = kv.second;
-                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderInfo->renderPipeline->pipeline);
-                    uint32_t shadowType = 0;
-                    vkCmdPushConstants(commandBuffer, renderInfo->renderPipeline->pipelineLayout, VK_SHADER_STAGE_ALL,
-                                       offsetof(ShadowPushConstants, shadowIndex), sizeof(uint32_t), &cascade);
-                    vkCmdPushConstants(commandBuffer, renderInfo->renderPipeline->pipelineLayout, VK_SHADER_STAGE_ALL,
-                                       offsetof(ShadowPushConstants, shadowType), sizeof(uint32_t), &shadowType);
-                    renderInfo->Render(commandBuffer, shadowManager->GetShadowPassDescriptorSet(currentFrame));
-                }
-
-                vkCmdEndRendering(commandBuffer);
-            }
+                drawShadowView(commandBuffer, currentFrame, 0, cascade, shadowManager->GetDirectionalCache(),
+                               shadowManager->GetDirectionalShadowMapImages()[currentFrame],
+                               shadowManager->GetDirectionalShadowCascadeView(currentFrame, cascade),
+                               shadowManager->GetDirectionalCacheImage(), shadowManager->GetDirectionalCacheView(cascade),
+                               directionalConfig.mapSize);
 
         const SpotShadowConfig &spotConfig = shadowManager->GetSpotConfig();
         viewport.width = static_cast<float>(spotConfig.mapSize);
@@ -210,46 +309,11 @@ namespace vke_render
         scissor.extent = {spotConfig.mapSize, spotConfig.mapSize};
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-        for (uint32_t slot = 0; slot < MAX_SPOT_LIGHT_SHADOW_CNT; ++slot)
-        {
-            if (!shadowManager->IsSpotShadowSlotActive(slot))
-                continue;
-
-            VkRenderingAttachmentInfo depthAttachmentInfo{};
-            depthAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-            depthAttachmentInfo.pNext = nullptr;
-            depthAttachmentInfo.imageView = shadowManager->GetSpotShadowMapLayerView(currentFrame, slot);
-            depthAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            depthAttachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            depthAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-            depthAttachmentInfo.clearValue.depthStencil = {1.0f, 0};
-            depthAttachmentInfo.resolveMode = VK_RESOLVE_MODE_NONE;
-
-            VkRenderingInfo renderingInfo{};
-            renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-            renderingInfo.pNext = nullptr;
-            renderingInfo.renderArea = {{0, 0}, {spotConfig.mapSize, spotConfig.mapSize}};
-            renderingInfo.layerCount = 1;
-            renderingInfo.colorAttachmentCount = 0;
-            renderingInfo.pColorAttachments = nullptr;
-            renderingInfo.pDepthAttachment = &depthAttachmentInfo;
-
-            vkCmdBeginRendering(commandBuffer, &renderingInfo);
-
-            for (auto &kv : renderInfoMap)
-            {
-                std::unique_ptr<RenderInfo> &renderInfo = kv.second;
-                uint32_t shadowType = 1;
-                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderInfo->renderPipeline->pipeline);
-                vkCmdPushConstants(commandBuffer, renderInfo->renderPipeline->pipelineLayout, VK_SHADER_STAGE_ALL,
-                                   offsetof(ShadowPushConstants, shadowIndex), sizeof(uint32_t), &slot);
-                vkCmdPushConstants(commandBuffer, renderInfo->renderPipeline->pipelineLayout, VK_SHADER_STAGE_ALL,
-                                   offsetof(ShadowPushConstants, shadowType), sizeof(uint32_t), &shadowType);
-                renderInfo->Render(commandBuffer, shadowManager->GetShadowPassDescriptorSet(currentFrame));
-            }
-
-            vkCmdEndRendering(commandBuffer);
-        }
+        for (uint32_t slot : shadowManager->GetSpotSlotsToDraw())
+            drawShadowView(commandBuffer, currentFrame, 1, slot, shadowManager->GetSpotCache(),
+                           *shadowManager->GetSpotShadowMapImage(), shadowManager->GetSpotShadowMapLayerView(slot),
+                           shadowManager->GetSpotCacheImage(), shadowManager->GetSpotCacheView(slot),
+                           spotConfig.mapSize);
     }
 
     void ShadowPass::OnWindowResize(FrameGraph &frameGraph, RenderContext *ctx)
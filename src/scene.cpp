@@ -40,6 +40,55 @@ namespace vke_common
         return ret;
     }
 
+    SceneBinaryWriter Scene::ToBinary()
+    {
+        SceneBinaryWriter writer;
+        writer.SetMaxID(idAllocator.id);
+        for (auto &layer : layers)
+            writer.AddLayer(layer);
+        vke_render::SceneLightData lightData = loadedToEngine
+                                                   ? vke_render::SceneLightData(vke_render::Renderer::GetInstance()->lightManager->ToSceneLightData())
+                                                   : lighting;
+
+        std::vector<vke_ds::id32_t> children;
+        nlohmann::json componentsJSON = nlohmann::json::array();
+        for (auto &[id, entity] : idToEntity)
+        {
+            auto [obj, transform] = registry.get<GameObject, Transform>(entity);
+            if (obj.layer == 1)
+                continue;
+
+            children.clear();
+            for (entt::entity child : transform.children)
+                children.push_back(GetEntityID(child));
+
+            const glm::vec3 &pos = transform.localPosition;
+            const glm::vec3 &scl = transform.localScale;
+            const glm::quat &rot = transform.localRotation;
+            const double position[3] = {pos.x, pos.y, pos.z};
+            const double scale[3] = {scl.x, scl.y, scl.z};
+            const double rotation[4] = {rot.x, rot.y, rot.z, rot.w};
+            const uint32_t objectIndex = writer.AddObject(id, obj.layer, obj.isStatic, obj.name, GetEntityID(transform.parent),
+                                                          children, position, scale, rotation);
+
+            componentsJSON.clear();
+            componentToJSON(id, componentsJSON, lightData);
+            for (auto &component : componentsJSON)
+            {
+                bool valid = false;
+                ComponentType type = ComponentTypeFromName(component["type"].get<std::string>(), valid);
+                if (!valid)
+                    continue;
+                if (type == ComponentType::Script)
+                    writer.AddScript(objectIndex, component["className"].get<std::string>(), component["data"]);
+                else
+                    writer.AddComponent(objectIndex, type, component);
+            }
+        }
+
+        return writer;
+    }
+
     void Scene::init(const nlohmann::json &json)
     {
         auto &lrs = json["layers"];
@@ -68,4 +117,53 @@ namespace vke_common
                 loadComponent(id, entity, component);
         }
     }
+
+    void Scene::initFromBinary(const SceneBinaryReader &reader)
+    {
+        for (const SceneBinaryStringRef &layer : reader.GetLayers())
+            layers.emplace_back(reader.GetString(layer));
+
+        const std::span<const SceneBinaryObject> objects = reader.GetObjects();
+        std::vector<entt::entity> entities(objects.size());
+        registry.create(entities.begin(), entities.end());
+        registry.storage<GameObject>().reserve(objects.size());
+        registry.storage<Transform>().reserve(objects.size());
+        idToEntity.reserve(objects.size());
+
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            const SceneBinaryObject &object = objects[i];
+            const entt::entity entity = entities[i];
+            idToEntity[object.id] = entity;
+            registry.emplace<GameObject>(entity, object.id, object.layer, object.isStatic != 0, std::string(reader.GetString(object.name)));
+            registry.emplace<Transform>(entity,
+                                        glm::vec3(object.position[0], object.position[1], object.position[2]),
+                                        glm::vec3(object.scale[0], object.scale[1], object.scale[2]),
+                                        glm::normalize(glm::quat(object.rotation[3], object.rotation[0], object.rotation[1], object.rotation[2])));
+        }
+
+        transformSystem.InitializeHierarchy(reader);
+
+        // one pass per component section, so every storage grows once
+        for (uint32_t i = 1; i < SCENE_BINARY_COMPONENT_TYPE_CNT; ++i)
+        {
+            const ComponentType type = static_cast<ComponentType>(i);
+            if (type == ComponentType::Script)
+                continue;
+
+            const std::span<const SceneBinaryComponent> components = reader.GetComponents(type);
+            reserveComponents(type, components.size());
+            for (size_t j = 0; j < components.size(); ++j)
+                loadComponent(type, entities[components[j].objectIndex], reader.GetComponentJSON(type, j));
+        }
+
+        const std::span<const SceneBinaryScript> scripts = reader.GetScripts();
+        for (size_t j = 0; j < scripts.size(); ++j)
+        {
+            const SceneBinaryScript &script = scripts[j];
+            vke_component::ScriptState scriptState(std::string(reader.GetString(script.className)));
+            scriptState.serializedData = reader.GetScriptData(j);
+            csharpScriptStates[entities[script.objectIndex]].emplace(scriptState.className, std::move(scriptState));
+        }
+    }
 }
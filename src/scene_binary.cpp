@@ -0,0 +1,582 @@
+#include <scene_binary.hpp>
+#include <logger.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace vke_common
+{
+    static constexpr const char *COMPONENT_TYPE_NAMES[SCENE_BINARY_COMPONENT_TYPE_CNT] = {
+        "transform",
+        "camera",
+        "renderableObject",
+        "animator",
+        "rigidbody",
+        "sensor",
+        "characterController",
+        "directionalLight",
+        "pointLight",
+        "spotLight",
+        "script",
+        "uiText",
+    };
+
+    // object keys stored in the entity table, everything else goes to the object extra blob
+    static constexpr const char *OBJECT_TABLE_KEYS[] = {"id", "static", "name", "layer", "parent", "transform", "children", "components"};
+    static constexpr const char *UNKNOWN_COMPONENTS_KEY = "components";
+
+    ComponentType ComponentTypeFromName(std::string_view name, bool &valid)
+    {
+        for (uint32_t i = 1; i < SCENE_BINARY_COMPONENT_TYPE_CNT; ++i)
+        {
+            if (name == COMPONENT_TYPE_NAMES[i])
+            {
+                valid = true;
+                return static_cast<ComponentType>(i);
+            }
+        }
+        valid = false;
+        return ComponentType::Transform;
+    }
+
+    const char *ComponentTypeName(ComponentType type)
+    {
+        return COMPONENT_TYPE_NAMES[static_cast<uint32_t>(type)];
+    }
+
+    static inline size_t AlignUp(size_t value)
+    {
+        return (value + 7) & ~size_t(7);
+    }
+
+    SceneBinaryWriter::SceneBinaryWriter() : maxID(0) {}
+
+    SceneBinaryStringRef SceneBinaryWriter::addString(std::string_view value)
+    {
+        SceneBinaryStringRef ref{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+        strings.insert(strings.end(), value.begin(), value.end());
+        return ref;
+    }
+
+    SceneBinaryBlobRef SceneBinaryWriter::appendMsgPack(std::vector<uint8_t> &payload, const nlohmann::json &json)
+    {
+        const uint32_t offset = static_cast<uint32_t>(payload.size());
+        nlohmann::json::to_msgpack(json, payload);
+        return SceneBinaryBlobRef{offset, static_cast<uint32_t>(payload.size()) - offset};
+    }
+
+    void SceneBinaryWriter::AddLayer(std::string_view layer)
+    {
+        layers.push_back(addString(layer));
+    }
+
+    uint32_t SceneBinaryWriter::AddObject(uint32_t id, int32_t layer, bool isStatic, std::string_view name, uint32_t parent,
+                                          std::span<const uint32_t> objectChildren,
+                                          const double (&position)[3], const double (&scale)[3], const double (&rotation)[4])
+    {
+        SceneBinaryObject object{};
+        object.id = id;
+        object.layer = layer;
+        object.parent = parent;
+        object.isStatic = isStatic ? 1 : 0;
+        object.name = addString(name);
+        object.firstChild = static_cast<uint32_t>(children.size());
+        object.childCnt = static_cast<uint32_t>(objectChildren.size());
+        std::copy(std::begin(position), std::end(position), object.position);
+        std::copy(std::begin(scale), std::end(scale), object.scale);
+        std::copy(std::begin(rotation), std::end(rotation), object.rotation);
+        children.insert(children.end(), objectChildren.begin(), objectChildren.end());
+        objects.push_back(object);
+        return static_cast<uint32_t>(objects.size() - 1);
+    }
+
+    void SceneBinaryWriter::AddObjectExtra(uint32_t objectIndex, const nlohmann::json &extra)
+    {
+        extras.push_back(SceneBinaryObjectExtra{objectIndex, appendMsgPack(extraPayload, extra)});
+    }
+
+    void SceneBinaryWriter::AddComponent(uint32_t objectIndex, ComponentType type, const nlohmann::json &component)
+    {
+        const uint32_t typeIndex = static_cast<uint32_t>(type);
+        nlohmann::json data = component;
+        // the section already encodes the type
+        data.erase("type");
+        components[typeIndex].push_back(SceneBinaryComponent{objectIndex, objects[objectIndex].componentCnt++,
+                                                             appendMsgPack(componentPayloads[typeIndex], data)});
+    }
+
+    void SceneBinaryWriter::AddScript(uint32_t objectIndex, std::string_view className, const nlohmann::json &data)
+    {
+        SceneBinaryScript script{};
+        script.objectIndex = objectIndex;
+        script.order = objects[objectIndex].componentCnt++;
+        script.className = addString(className);
+        script.data = addString(data.dump());
+        scripts.push_back(script);
+    }
+
+    std::vector<uint8_t> SceneBinaryWriter::Finish() const
+    {
+        SceneBinaryHeader header{};
+        header.magic = SCENE_BINARY_MAGIC;
+        header.version = SCENE_BINARY_VERSION;
+        header.maxID = maxID;
+        header.sectionCnt = SCENE_SECTION_CNT;
+
+        std::vector<uint8_t> bytes(AlignUp(sizeof(SceneBinaryHeader)), 0);
+        auto beginSection = [&](uint32_t section, uint32_t count)
+        {
+            bytes.resize(AlignUp(bytes.size()), 0);
+            header.sections[section].offset = bytes.size();
+            header.sections[section].count = count;
+        };
+        auto endSection = [&](uint32_t section)
+        {
+            header.sections[section].size = bytes.size() - header.sections[section].offset;
+        };
+        auto append = [&](const void *data, size_t size)
+        {
+            const uint8_t *src = static_cast<const uint8_t *>(data);
+            bytes.insert(bytes.end(), src, src + size);
+        };
+        // records first, then their payload; blob offsets are rebased to the section start
+        auto appendRecords = [&]<typename T>(uint32_t section, const std::vector<T> &records, const std::vector<uint8_t> &payload)
+        {
+            beginSection(section, static_cast<uint32_t>(records.size()));
+            const uint32_t payloadOffset = static_cast<uint32_t>(AlignUp(records.size() * sizeof(T)));
+            for (T record : records)
+            {
+                record.data.offset += payloadOffset;
+                append(&record, sizeof(T));
+            }
+            bytes.resize(header.sections[section].offset + payloadOffset, 0);
+            append(payload.data(), payload.size());
+            endSection(section);
+        };
+
+        beginSection(SCENE_SECTION_STRINGS, static_cast<uint32_t>(strings.size()));
+        append(strings.data(), strings.size());
+        endSection(SCENE_SECTION_STRINGS);
+
+        beginSection(SCENE_SECTION_LAYERS, static_cast<uint32_t>(layers.size()));
+        append(layers.data(), layers.size() * sizeof(SceneBinaryStringRef));
+        endSection(SCENE_SECTION_LAYERS);
+
+        beginSection(SCENE_SECTION_OBJECTS, static_cast<uint32_t>(objects.size()));
+        append(objects.data(), objects.size() * sizeof(SceneBinaryObject));
+        endSection(SCENE_SECTION_OBJECTS);
+
+        beginSection(SCENE_SECTION_CHILDREN, static_cast<uint32_t>(children.size()));
+        append(children.data(), children.size() * sizeof(uint32_t));
+        endSection(SCENE_SECTION_CHILDREN);
+
+        appendRecords(SCENE_SECTION_OBJECT_EXTRAS, extras, extraPayload);
+
+        for (uint32_t i = 0; i < SCENE_BINARY_COMPONENT_TYPE_CNT; ++i)
+        {
+            const uint32_t section = SCENE_SECTION_FIRST_COMPONENT + i;
+            if (static_cast<ComponentType>(i) == ComponentType::Script)
+            {
+                beginSection(section, static_cast<uint32_t>(scripts.size()));
+                append(scripts.data(), scripts.size() * sizeof(SceneBinaryScript));
+                endSection(section);
+            }
+            else
+            {
+                appendRecords(section, components[i], componentPayloads[i]);
+            }
+        }
+
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        return bytes;
+    }
+
+    bool SceneBinaryWriter::WriteFile(const std::string &pth) const
+    {
+        const std::vector<uint8_t> bytes = Finish();
+        std::ofstream ofs(pth, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open())
+            return false;
+        ofs.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return ofs.good();
+    }
+
+    template <size_t N>
+    static void ReadDoubles(const nlohmann::json &json, double (&values)[N])
+    {
+        for (size_t i = 0; i < N; ++i)
+            values[i] = json[i].get<double>();
+    }
+
+    SceneBinaryWriter SceneBinaryWriter::FromJSON(const nlohmann::json &json)
+    {
+        SceneBinaryWriter writer;
+        writer.SetMaxID(json["maxid"].get<uint32_t>());
+        for (auto &layer : json["layers"])
+            writer.AddLayer(layer.get<std::string>());
+
+        std::vector<uint32_t> objectChildren;
+        for (auto &jsonObj : json["objects"])
+        {
+            objectChildren.clear();
+            for (auto &child : jsonObj["children"])
+                objectChildren.push_back(child.get<uint32_t>());
+
+            auto &transform = jsonObj["transform"];
+            double position[3], scale[3], rotation[4];
+            ReadDoubles(transform["pos"], position);
+            ReadDoubles(transform["scl"], scale);
+            ReadDoubles(transform["rot"], rotation);
+
+            const uint32_t objectIndex = writer.AddObject(jsonObj["id"].get<uint32_t>(), jsonObj["layer"].get<int32_t>(),
+                                                          jsonObj["static"].get<bool>(), jsonObj["name"].get<std::string>(),
+                                                          jsonObj.value("parent", 0u), objectChildren, position, scale, rotation);
+
+            nlohmann::json extra = nlohmann::json::object();
+            for (auto &[key, value] : jsonObj.items())
+                if (std::find(std::begin(OBJECT_TABLE_KEYS), std::end(OBJECT_TABLE_KEYS), key) == std::end(OBJECT_TABLE_KEYS))
+                    extra[key] = value;
+
+            auto &jsonComponents = jsonObj["components"];
+            for (auto &component : jsonComponents)
+            {
+                bool valid = false;
+                const ComponentType type = ComponentTypeFromName(component.value("type", std::string()), valid);
+                const bool plainScript = type == ComponentType::Script && component.size() == 3 &&
+                                         component.contains("className") && component.contains("data");
+                if (valid && type != ComponentType::Script)
+                {
+                    writer.AddComponent(objectIndex, type, component);
+                }
+                else if (valid && plainScript)
+                {
+                    writer.AddScript(objectIndex, component["className"].get<std::string>(), component["data"]);
+                }
+                else
+                {
+                    // components the engine does not know keep their slot in the object's component list
+                    extra[UNKNOWN_COMPONENTS_KEY].push_back({{"order", writer.objects[objectIndex].componentCnt++}, {"component", component}});
+                }
+            }
+
+            if (!extra.empty())
+                writer.AddObjectExtra(objectIndex, extra);
+        }
+        return writer;
+    }
+
+    bool SceneBinaryReader::IsSceneBinary(const std::string &pth)
+    {
+        std::ifstream ifs(pth, std::ios::binary);
+        uint32_t magic = 0;
+        ifs.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+        return ifs.good() && magic == SCENE_BINARY_MAGIC;
+    }
+
+    bool SceneBinaryReader::Open(const std::string &pth)
+    {
+        if (!file.Open(pth))
+        {
+            VKE_LOG_ERROR("Failed to map scene binary {}", pth)
+            return false;
+        }
+        bytes = file.GetBytes();
+        if (!validate())
+        {
+            VKE_LOG_ERROR("Invalid scene binary {}", pth)
+            file.Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool SceneBinaryReader::Open(std::span<const uint8_t> data)
+    {
+        file.Close();
+        bytes = data;
+        return validate();
+    }
+
+    void SceneBinaryReader::clearDecoded()
+    {
+        extraJSONs.clear();
+        for (std::vector<nlohmann::json> &decoded : componentJSONs)
+            decoded.clear();
+        scriptDataJSONs.clear();
+    }
+
+    bool SceneBinaryReader::validate()
+    {
+        header = nullptr;
+        clearDecoded();
+        if (bytes.size() < sizeof(SceneBinaryHeader))
+            return false;
+
+        const SceneBinaryHeader *candidate = reinterpret_cast<const SceneBinaryHeader *>(bytes.data());
+        if (candidate->magic != SCENE_BINARY_MAGIC || candidate->version != SCENE_BINARY_VERSION ||
+            candidate->sectionCnt != SCENE_SECTION_CNT)
+            return false;
+
+        auto recordSize = [](uint32_t section) -> size_t
+        {
+            switch (section)
+            {
+            case SCENE_SECTION_STRINGS:
+                return 1;
+            case SCENE_SECTION_LAYERS:
+                return sizeof(SceneBinaryStringRef);
+            case SCENE_SECTION_OBJECTS:
+                return sizeof(SceneBinaryObject);
+            case SCENE_SECTION_CHILDREN:
+                return sizeof(uint32_t);
+            case SCENE_SECTION_OBJECT_EXTRAS:
+                return sizeof(SceneBinaryObjectExtra);
+            case GetComponentSection(ComponentType::Script):
+                return sizeof(SceneBinaryScript);
+            default:
+                return sizeof(SceneBinaryComponent);
+            }
+        };
+
+        for (uint32_t i = 0; i < SCENE_SECTION_CNT; ++i)
+        {
+            const SceneBinarySection &section = candidate->sections[i];
+            if (section.offset > bytes.size() || section.size > bytes.size() - section.offset ||
+                section.offset % 8 != 0 || static_cast<uint64_t>(section.count) * recordSize(i) > section.size)
+            {
+                VKE_LOG_ERROR("Scene binary section {} (offset {}, size {}, count {}) does not fit a {} byte file",
+                              i, section.offset, section.size, section.count, bytes.size())
+                return false;
+            }
+        }
+
+        header = candidate;
+        if (!validateReferences())
+        {
+            header = nullptr;
+            clearDecoded();
+            return false;
+        }
+        return true;
+    }
+
+    bool SceneBinaryReader::validateReferences()
+    {
+        const uint64_t stringsSize = header->sections[SCENE_SECTION_STRINGS].count;
+        auto validString = [&](SceneBinaryStringRef ref)
+        {
+            return static_cast<uint64_t>(ref.offset) + ref.length <= stringsSize;
+        };
+        // the payload is decoded here and only here, a payload that does not decode leaves a discarded value
+        auto decodeBlob = [&](uint32_t section, SceneBinaryBlobRef ref, std::vector<nlohmann::json> &decoded)
+        {
+            if (static_cast<uint64_t>(ref.offset) + ref.size > header->sections[section].size)
+                return false;
+            const uint8_t *data = sectionData(section) + ref.offset;
+            decoded.push_back(nlohmann::json::from_msgpack(data, data + ref.size, true, false));
+            return !decoded.back().is_discarded();
+        };
+
+        for (const SceneBinaryStringRef &layer : GetLayers())
+            if (!validString(layer))
+            {
+                VKE_LOG_ERROR("Scene binary layer name ({}, {}) is outside the {} byte string table", layer.offset, layer.length, stringsSize)
+                return false;
+            }
+
+        const std::span<const SceneBinaryObject> objects = GetObjects();
+        const uint32_t childTableCnt = header->sections[SCENE_SECTION_CHILDREN].count;
+        std::vector<uint32_t> ids;
+        ids.reserve(objects.size());
+        for (const SceneBinaryObject &object : objects)
+        {
+            if (object.id >= header->maxID || !validString(object.name) ||
+                static_cast<uint64_t>(object.firstChild) + object.childCnt > childTableCnt)
+            {
+                VKE_LOG_ERROR("Scene binary object {} has an id past maxid {}, a name outside the string table or children [{}, +{}) outside the {} entry child table",
+                              object.id, header->maxID, object.firstChild, object.childCnt, childTableCnt)
+                return false;
+            }
+            ids.push_back(object.id);
+        }
+
+        std::sort(ids.begin(), ids.end());
+        auto duplicate = std::adjacent_find(ids.begin(), ids.end());
+        if (duplicate != ids.end())
+        {
+            VKE_LOG_ERROR("Scene binary object id {} is used twice", *duplicate)
+            return false;
+        }
+        auto hasObject = [&](uint32_t id)
+        {
+            return std::binary_search(ids.begin(), ids.end(), id);
+        };
+        for (const SceneBinaryObject &object : objects)
+        {
+            if (object.parent != 0 && !hasObject(object.parent))
+            {
+                VKE_LOG_ERROR("Scene binary object {} has missing parent {}", object.id, object.parent)
+                return false;
+            }
+            for (uint32_t child : GetChildren(object))
+                if (!hasObject(child))
+                {
+                    VKE_LOG_ERROR("Scene binary object {} has missing child {}", object.id, child)
+                    return false;
+                }
+        }
+
+        const std::span<const SceneBinaryObjectExtra> extras = GetObjectExtras();
+        extraJSONs.reserve(extras.size());
+        for (const SceneBinaryObjectExtra &extra : extras)
+            if (extra.objectIndex >= objects.size() || !decodeBlob(SCENE_SECTION_OBJECT_EXTRAS, extra.data, extraJSONs))
+            {
+                VKE_LOG_ERROR("Scene binary object extra of object index {} (of {}) has an invalid payload ({}, {})",
+                              extra.objectIndex, objects.size(), extra.data.offset, extra.data.size)
+                return false;
+            }
+
+        // ToJSON merges the extra into the object and reads the order and component of every unknown component
+        for (size_t i = 0; i < extras.size(); ++i)
+        {
+            const nlohmann::json &extraJSON = extraJSONs[i];
+            auto unknownIt = extraJSON.find(UNKNOWN_COMPONENTS_KEY);
+            bool valid = extraJSON.is_object() && (unknownIt == extraJSON.end() || unknownIt->is_array());
+            if (valid && unknownIt != extraJSON.end())
+                valid = std::all_of(unknownIt->begin(), unknownIt->end(), [](const nlohmann::json &entry)
+                                    {
+                                        if (!entry.is_object() || !entry.contains("component"))
+                                            return false;
+                                        auto orderIt = entry.find("order");
+                                        return orderIt != entry.end() && orderIt->is_number_unsigned() &&
+                                               orderIt->get<uint64_t>() <= UINT32_MAX;
+                                    });
+            if (!valid)
+            {
+                VKE_LOG_ERROR("Scene binary object extra of object index {} is not an object or has an unknown component without an order or component",
+                              extras[i].objectIndex)
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i < SCENE_BINARY_COMPONENT_TYPE_CNT; ++i)
+        {
+            const ComponentType type = static_cast<ComponentType>(i);
+            if (type == ComponentType::Script)
+                continue;
+            const std::span<const SceneBinaryComponent> components = GetComponents(type);
+            componentJSONs[i].reserve(components.size());
+            for (const SceneBinaryComponent &component : components)
+                if (component.objectIndex >= objects.size() || !decodeBlob(GetComponentSection(type), component.data, componentJSONs[i]) ||
+                    !componentJSONs[i].back().is_object())
+                {
+                    VKE_LOG_ERROR("Scene binary {} component of object index {} (of {}) has a payload ({}, {}) that is not an object",
+                                  ComponentTypeName(type), component.objectIndex, objects.size(), component.data.offset, component.data.size)
+                    return false;
+                }
+        }
+
+        const std::span<const SceneBinaryScript> scripts = GetScripts();
+        scriptDataJSONs.reserve(scripts.size());
+        for (const SceneBinaryScript &script : scripts)
+        {
+            const bool validRefs = script.objectIndex < objects.size() && validString(script.className) && validString(script.data);
+            if (validRefs)
+                scriptDataJSONs.push_back(nlohmann::json::parse(GetString(script.data), nullptr, false));
+            if (!validRefs || scriptDataJSONs.back().is_discarded())
+            {
+                VKE_LOG_ERROR("Scene binary script of object index {} (of {}) has a class name or data outside the string table or data that is not JSON",
+                              script.objectIndex, objects.size())
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    nlohmann::json SceneBinaryReader::ToJSON() const
+    {
+        nlohmann::json ret;
+        ret["maxid"] = GetMaxID();
+        nlohmann::json layersJSON = nlohmann::json::array();
+        for (const SceneBinaryStringRef &layer : GetLayers())
+            layersJSON.push_back(std::string(GetString(layer)));
+        ret["layers"] = std::move(layersJSON);
+
+        const std::span<const SceneBinaryObject> objects = GetObjects();
+        std::vector<nlohmann::json> objectJSONs(objects.size());
+        std::vector<std::vector<std::pair<uint32_t, nlohmann::json>>> componentJSONs(objects.size());
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            const SceneBinaryObject &object = objects[i];
+            nlohmann::json &objJSON = objectJSONs[i];
+            objJSON["id"] = object.id;
+            objJSON["static"] = object.isStatic != 0;
+            objJSON["name"] = std::string(GetString(object.name));
+            objJSON["layer"] = object.layer;
+            objJSON["parent"] = object.parent;
+            objJSON["transform"] = {{"pos", object.position}, {"scl", object.scale}, {"rot", object.rotation}};
+            nlohmann::json childrenJSON = nlohmann::json::array();
+            for (uint32_t child : GetChildren(object))
+                childrenJSON.push_back(child);
+            objJSON["children"] = std::move(childrenJSON);
+        }
+
+        const std::span<const SceneBinaryObjectExtra> extras = GetObjectExtras();
+        for (size_t i = 0; i < extras.size(); ++i)
+        {
+            const SceneBinaryObjectExtra &extra = extras[i];
+            nlohmann::json extraJSON = GetObjectExtra(i);
+            auto unknownIt = extraJSON.find(UNKNOWN_COMPONENTS_KEY);
+            if (unknownIt != extraJSON.end())
+            {
+                for (auto &entry : *unknownIt)
+                    componentJSONs[extra.objectIndex].emplace_back(entry["order"].get<uint32_t>(), entry["component"]);
+                extraJSON.erase(unknownIt);
+            }
+            for (auto &[key, value] : extraJSON.items())
+                objectJSONs[extra.objectIndex][key] = value;
+        }
+
+        for (uint32_t i = 1; i < SCENE_BINARY_COMPONENT_TYPE_CNT; ++i)
+        {
+            const ComponentType type = static_cast<ComponentType>(i);
+            if (type == ComponentType::Script)
+                continue;
+            const std::span<const SceneBinaryComponent> components = GetComponents(type);
+            for (size_t j = 0; j < components.size(); ++j)
+            {
+                const SceneBinaryComponent &component = components[j];
+                nlohmann::json componentJSON = GetComponentJSON(type, j);
+                componentJSON["type"] = ComponentTypeName(type);
+                componentJSONs[component.objectIndex].emplace_back(component.order, std::move(componentJSON));
+            }
+        }
+
+        const std::span<const SceneBinaryScript> scripts = GetScripts();
+        for (size_t i = 0; i < scripts.size(); ++i)
+        {
+            const SceneBinaryScript &script = scripts[i];
+            nlohmann::json scriptJSON = {{"type", ComponentTypeName(ComponentType::Script)},
+                                         {"className", std::string(GetString(script.className))},
+                                         {"data", GetScriptData(i)}};
+            componentJSONs[script.objectIndex].emplace_back(script.order, std::move(scriptJSON));
+        }
+
+        nlohmann::json objectsJSON = nlohmann::json::array();
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            auto &components = componentJSONs[i];
+            std::sort(components.begin(), components.end(), [](const auto &a, const auto &b)
+                      { return a.first < b.first; });
+            nlohmann::json componentsJSON = nlohmann::json::array();
+            for (auto &[order, componentJSON] : components)
+                componentsJSON.push_back(std::move(componentJSON));
+            objectJSONs[i]["components"] = std::move(componentsJSON);
+            objectsJSON.push_back(std::move(objectJSONs[i]));
+        }
+        ret["objects"] = std::move(objectsJSON);
+        return ret;
+    }
+}
@@ -1,5 +1,6 @@
 #include <scene_transform_system.hpp>
 #include <component/camera.hpp>
+#include <component/renderable_object.hpp>
 #include <component/rigidbody.hpp>
 #include <component/sensor.hpp>
 #include <component/character_controller.hpp>
@@ -44,6 +45,26 @@ namespace vke_common
                 transform.children.insert(idToEntity[jsonChild.get<vke_ds::id32_t>()]);
         }
 
+        updateHierarchy();
+    }
+
+    // SceneBinaryReader::Open has checked every parent and child id names an object of the scene
+    void SceneTransformSystem::InitializeHierarchy(const SceneBinaryReader &reader)
+    {
+        for (const SceneBinaryObject &object : reader.GetObjects())
+        {
+            Transform &transform = registry.get<Transform>(idToEntity[object.id]);
+            transform.parent = object.parent ? idToEntity.at(object.parent) : entt::null;
+
+            for (vke_ds::id32_t child : reader.GetChildren(object))
+                transform.children.insert(idToEntity[child]);
+        }
+
+        updateHierarchy();
+    }
+
+    void SceneTransformSystem::updateHierarchy()
+    {
         std::unordered_set<entt::entity> visited;
         for (auto &[id, entity] : idToEntity)
         {
@@ -187,6 +208,9 @@ namespace vke_common
         if (registry.all_of<vke_component::Camera>(entity))
             registry.get<vke_component::Camera>(entity).OnTransformed(transform);
 
+        if (registry.all_of<vke_component::RenderableObject>(entity))
+            registry.get<vke_component::RenderableObject>(entity).OnTransformed(transform);
+
         if (registry.all_of<vke_component::RigidBody>(entity))
             registry.get<vke_component::RigidBody>(entity).OnTransformed(transform);
 
@@ -205,14 +229,14 @@ namespace vke_common
         {
             auto &light = lightManager->GetLightWithoutCheckByEntity<vke_render::DirectionalLight>(entity);
             light.direction = glm::vec4(glm::normalize(TransformForward(transform)), 0.0f);
-            lightManager->MarkDirty<vke_render::DirectionalLight>();
+            lightManager->MarkDirty<vke_render::DirectionalLight>(entity);
         }
 
         if (lightManager->HasLight<vke_render::PointLight>(entity))
         {
             auto &light = lightManager->GetLightWithoutCheckByEntity<vke_render::PointLight>(entity);
             light.positionWithRadius = glm::vec4(transform.GetGlobalPosition(), light.positionWithRadius.w);
-            lightManager->MarkDirty<vke_render::PointLight>();
+            lightManager->MarkDirty<vke_render::PointLight>(entity);
         }
 
         if (lightManager->HasLight<vke_render::SpotLight>(entity))
@@ -220,7 +244,7 @@ namespace vke_common
             auto &light = lightManager->GetLightWithoutCheckByEntity<vke_render::SpotLight>(entity);
             light.positionWithRadius = glm::vec4(transform.GetGlobalPosition(), light.positionWithRadius.w);
             light.direction = glm::vec4(glm::normalize(TransformForward(transform)), 0.0f);
-            lightManager->MarkDirty<vke_render::SpotLight>();
+            lightManager->MarkDirty<vke_render::SpotLight>(entity);
             if (light.CastShadow())
                 lightManager->UpdateSpotShadow(entity);
         }
@@ -84,6 +84,7 @@ namespace vke_common
 
     void ScriptManager::init()
     {
+        scheduler = ScriptScheduler(GameConfig::GetInstance()->scriptConfig);
         VKE_FATAL_IF(!loadHostFXR(), "Failed to load hostfxr")
         getDotnetLoadAssembly(ENGINE_CORE_CSHARP_CONFIG_PATH, functionPointers);
         functionPointers.loadAssembly(ENGINE_CORE_CSHARP_ASSEMBLY_PATH, nullptr, nullptr);
@@ -93,6 +94,7 @@ namespace vke_common
             functionPointers.loadAssembly(std::wstring(gameAssemblyPath.begin(), gameAssemblyPath.end()).c_str(), nullptr, nullptr);
 
         getCSharpExports();
+        dispatchBackend.Bind(&csharpExports.sceneManagerFunctions);
         int rc = csharpExports.init();
         VKE_FATAL_IF(rc != 0, "C# Init failed: {}", rc)
         registerNativeFunctions();
@@ -0,0 +1,198 @@
+#include <script_scheduler.hpp>
+#include <logger.hpp>
+#include <algorithm>
+
+namespace vke_common
+{
+    uint32_t ScriptScheduler::Register(const std::string &name, const ScriptSchedule &schedule)
+    {
+        const uint32_t id = idAllocator.Alloc();
+        if (id >= scripts.size())
+            scripts.resize(id + 1);
+
+        ScriptEntry &entry = scripts[id];
+        const uint32_t generation = entry.generation + 1;
+        entry = ScriptEntry{};
+        entry.name = name;
+        entry.schedule = schedule;
+        entry.schedule.interval = std::max(schedule.interval, 1u);
+        entry.alive = true;
+        entry.generation = generation;
+        ++scriptCnt;
+
+        for (uint32_t phase = 0; phase < SCRIPT_PHASE_CNT; ++phase)
+        {
+            if ((entry.schedule.phaseMask & (1u << phase)) == 0)
+                continue;
+            PhaseState &state = phases[phase];
+            if (entry.schedule.mode == SCRIPT_UPDATE_TIME_SLICED)
+                state.sliced.push_back(id);
+            else
+                state.periodic.push_back(id);
+        }
+        return id;
+    }
+
+    void ScriptScheduler::Unregister(uint32_t id)
+    {
+        if (id >= scripts.size() || !scripts[id].alive)
+            return;
+
+        for (PhaseState &state : phases)
+        {
+            auto periodicIt = std::find(state.periodic.begin(), state.periodic.end(), id);
+            if (periodicIt != state.periodic.end())
+                state.periodic.erase(periodicIt);
+
+            auto slicedIt = std::find(state.sliced.begin(), state.sliced.end(), id);
+            if (slicedIt != state.sliced.end())
+            {
+                // keep the round robin position stable for the scripts behind the removed one
+                const size_t index = slicedIt - state.sliced.begin();
+                state.sliced.erase(slicedIt);
+                if (index < state.sliceCursor)
+                    --state.sliceCursor;
+                if (state.sliceCursor >= state.sliced.size())
+                    state.sliceCursor = 0;
+            }
+        }
+
+        scripts[id].alive = false;
+        scripts[id].name.clear();
+        idAllocator.Free(id);
+        --scriptCnt;
+    }
+
+    void ScriptScheduler::Clear()
+    {
+        for (uint32_t id = 0; id < scripts.size(); ++id)
+            Unregister(id);
+        overBudgetScripts.clear();
+    }
+
+    float ScriptScheduler::getBudget(const ScriptEntry &entry) const
+    {
+        return entry.schedule.budgetMs > 0.0f ? entry.schedule.budgetMs : config.defaultBudgetMs;
+    }
+
+    void ScriptScheduler::dispatchToList(PhaseState &state, ScriptEntry &entry, uint32_t id, ScriptPhase phase)
+    {
+        state.dispatchList.push_back(id);
+        state.dispatchDeltaTimes.push_back(entry.pendingDeltaTime[phase]);
+        state.dispatchGenerations.push_back(entry.generation);
+        entry.pendingDeltaTime[phase] = 0.0f;
+    }
+
+    const std::vector<uint32_t> &ScriptScheduler::BuildDispatchList(ScriptPhase phase, float deltaTime)
+    {
+        PhaseState &state = phases[phase];
+        state.dispatchList.clear();
+        state.dispatchDeltaTimes.clear();
+        state.dispatchGenerations.clear();
+        const uint64_t frameIndex = state.frameIndex++;
+
+        for (uint32_t id : state.periodic)
+        {
+            ScriptEntry &entry = scripts[id];
+            entry.pendingDeltaTime[phase] += deltaTime;
+            // the id offset spreads scripts sharing an interval over different frames
+            if (entry.schedule.mode == SCRIPT_UPDATE_EVERY_FRAME || (frameIndex + id) % entry.schedule.interval == 0)
+                dispatchToList(state, entry, id, phase);
+        }
+
+        for (uint32_t id : state.sliced)
+            scripts[id].pendingDeltaTime[phase] += deltaTime;
+
+        // pack time-sliced scripts by their average cost, always making progress by at least one script
+        float spentMs = 0.0f;
+        for (size_t i = 0; i < state.sliced.size(); ++i)
+        {
+            const uint32_t id = state.sliced[state.sliceCursor];
+            ScriptEntry &entry = scripts[id];
+            const float costMs = entry.stats[phase].averageMs;
+            if (i > 0 && spentMs + costMs > config.timeSliceBudgetMs)
+                break;
+            spentMs += costMs;
+            dispatchToList(state, entry, id, phase);
+            state.sliceCursor = (state.sliceCursor + 1) % state.sliced.size();
+        }
+
+        return state.dispatchList;
+    }
+
+    void ScriptScheduler::RecordTimings(ScriptPhase phase, const float *elapsedMs)
+    {
+        const PhaseState &state = phases[phase];
+        for (size_t i = 0; i < state.dispatchList.size(); ++i)
+        {
+            ScriptEntry &entry = scripts[state.dispatchList[i]];
+            // scripts can unregister themselves while being dispatched, and the id can go to a script registered after
+            if (!entry.alive || entry.generation != state.dispatchGenerations[i])
+                continue;
+
+            const float ms = elapsedMs[i];
+            ScriptTimingStats &stats = entry.stats[phase];
+            stats.lastMs = ms;
+            stats.averageMs = stats.dispatchCnt == 0 ? ms : stats.averageMs + (ms - stats.averageMs) * config.timingSmoothing;
+            stats.maxMs = std::max(stats.maxMs, ms);
+            ++stats.dispatchCnt;
+            if (ms > getBudget(entry))
+            {
+                ++stats.overBudgetCnt;
+                ++stats.overBudgetSinceReport;
+                stats.worstSinceReport = std::max(stats.worstSinceReport, ms);
+            }
+        }
+    }
+
+    const std::vector<uint32_t> &ScriptScheduler::ReportOverBudget()
+    {
+        overBudgetScripts.clear();
+        for (uint32_t id = 0; id < scripts.size(); ++id)
+        {
+            ScriptEntry &entry = scripts[id];
+            if (!entry.alive)
+                continue;
+
+            bool overBudget = false;
+            for (uint32_t phase = 0; phase < SCRIPT_PHASE_CNT; ++phase)
+            {
+                ScriptTimingStats &stats = entry.stats[phase];
+                if (stats.overBudgetSinceReport == 0)
+                    continue;
+                VKE_LOG_WARN("Script {} ({}) exceeded its {:.3f} ms {} budget {} times (worst {:.3f} ms, avg {:.3f} ms)",
+                             entry.name, id, getBudget(entry), phase == SCRIPT_PHASE_UPDATE ? "Update" : "FixedUpdate",
+                             stats.overBudgetSinceReport, stats.worstSinceReport, stats.averageMs)
+                stats.overBudgetSinceReport = 0;
+                stats.worstSinceReport = 0.0f;
+                overBudget = true;
+            }
+            if (overBudget)
+                overBudgetScripts.push_back(id);
+        }
+        return overBudgetScripts;
+    }
+
+    void ScriptScheduler::Dispatch(ScriptPhase phase, float deltaTime, ScriptDispatchBackend &backend)
+    {
+        PhaseState &state = phases[phase];
+        BuildDispatchList(phase, deltaTime);
+        if (!state.dispatchList.empty())
+        {
+            state.elapsedMs.assign(state.dispatchList.size(), 0.0f);
+            backend.Dispatch(phase, state.dispatchList.data(), state.dispatchDeltaTimes.data(),
+                             state.elapsedMs.data(), static_cast<uint32_t>(state.dispatchList.size()));
+            RecordTimings(phase, state.elapsedMs.data());
+        }
+
+        if (phase == SCRIPT_PHASE_UPDATE && config.reportInterval > 0 && state.frameIndex % config.reportInterval == 0)
+            ReportOverBudget();
+    }
+
+    const ScriptTimingStats *ScriptScheduler::GetStats(uint32_t id, ScriptPhase phase) const
+    {
+        if (id >= scripts.size() || !scripts[id].alive)
+            return nullptr;
+        return &scripts[id].stats[phase];
+    }
+}
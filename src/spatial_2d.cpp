@@ -1,10 +1,14 @@
 #include <spatial_2d.hpp>
 #include <algorithm>
+#include <unordered_set>
 
 namespace vke_common
 {
     Spatial2DLayerManager *Spatial2DLayerManager::instance = nullptr;
 
+    // keys handed out past the first and last layer; 0 and UINT64_MAX are never used
+    static constexpr uint64_t LAYER_KEY_GAP = uint64_t(1) << 32;
+
     Spatial2DLayerManager *Spatial2DLayerManager::GetInstance()
     {
         return instance;
@@ -34,44 +38,69 @@ namespace vke_common
                min.y <= other.max.y && max.y >= other.min.y;
     }
 
-    bool Spatial2DLayer::CanInsert(const Spatial2DUnit &unit) const
+    uint32_t Spatial2DIndex::selectLevel(const AABB2D &bounds) const
     {
-        for (const auto &entry : units)
-        {
-            const Spatial2DUnit &other = *entry.second;
-            if (other.zIndex != unit.zIndex && other.bounds.Overlaps(unit.bounds))
-                return false;
-        }
-        return true;
+        const float extent = std::max(bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y);
+        uint32_t level = 0;
+        while (level + 1 < LEVEL_CNT && levelCellSize(level) < extent)
+            ++level;
+        return level;
     }
 
-    void Spatial2DLayer::Insert(Spatial2DUnit &unit)
+    void Spatial2DIndex::Insert(vke_ds::id32_t id, const AABB2D &bounds)
     {
-        units[unit.id] = &unit;
-        unit.layer = id;
+        const uint32_t level = selectLevel(bounds);
+        entries[id] = Entry{bounds, level};
+
+        const CellRange range = cellRange(bounds, levelCellSize(level));
+        for (int32_t y = range.minY; y <= range.maxY; ++y)
+            for (int32_t x = range.minX; x <= range.maxX; ++x)
+                levels[level][cellKey(x, y)].push_back(id);
     }
 
-    void Spatial2DLayer::Remove(vke_ds::id32_t unitID)
+    void Spatial2DIndex::Remove(vke_ds::id32_t id)
     {
-        units.erase(unitID);
+        auto it = entries.find(id);
+        if (it == entries.end())
+            return;
+
+        Level &cells = levels[it->second.level];
+        const CellRange range = cellRange(it->second.bounds, levelCellSize(it->second.level));
+        for (int32_t y = range.minY; y <= range.maxY; ++y)
+            for (int32_t x = range.minX; x <= range.maxX; ++x)
+            {
+                auto cellIt = cells.find(cellKey(x, y));
+                std::vector<vke_ds::id32_t> &ids = cellIt->second;
+                *std::find(ids.begin(), ids.end(), id) = ids.back();
+                ids.pop_back();
+                if (ids.empty())
+                    cells.erase(cellIt);
+            }
+        entries.erase(it);
     }
 
-    std::vector<vke_ds::id32_t> Spatial2DLayer::Query(const glm::vec2 &point) const
+    void Spatial2DIndex::Query(const glm::vec2 &point, std::vector<vke_ds::id32_t> &result) const
     {
-        std::vector<vke_ds::id32_t> result;
-        for (const auto &entry : units)
-            if (entry.second->bounds.Contains(point))
-                result.push_back(entry.first);
-        return result;
+        Query(AABB2D(point, point), result);
     }
 
-    std::vector<vke_ds::id32_t> Spatial2DLayer::Query(const AABB2D &bounds) const
+    void Spatial2DIndex::Query(const AABB2D &bounds, std::vector<vke_ds::id32_t> &result) const
     {
-        std::vector<vke_ds::id32_t> result;
-        for (const auto &entry : units)
-            if (entry.second->bounds.Overlaps(bounds))
-                result.push_back(entry.first);
-        return result;
+        ForEachOverlap(bounds, [&result](vke_ds::id32_t id, const AABB2D &)
+                       {
+                           result.push_back(id);
+                           return true; });
+    }
+
+    void Spatial2DLayer::Insert(Spatial2DUnit &unit)
+    {
+        units[unit.id] = &unit;
+        unit.layer = id;
+    }
+
+    void Spatial2DLayer::Remove(vke_ds::id32_t unitID)
+    {
+        units.erase(unitID);
     }
 
     vke_ds::id32_t Spatial2DLayerManager::CreateUnit(const AABB2D &bounds, float zIndex)
@@ -125,78 +154,148 @@ namespace vke_common
 
     std::vector<vke_ds::id32_t> Spatial2DLayerManager::Query(const glm::vec2 &point) const
     {
-        std::vector<vke_ds::id32_t> result;
-        for (auto it = layerOrder.rbegin(); it != layerOrder.rend(); ++it)
-        {
-            std::vector<vke_ds::id32_t> hits = layers.at(*it).Query(point);
-            result.insert(result.end(), hits.begin(), hits.end());
-        }
-        return result;
+        return Query(AABB2D(point, point));
     }
 
     std::vector<vke_ds::id32_t> Spatial2DLayerManager::Query(const AABB2D &bounds) const
     {
+        // topmost layer first, like walking layerOrder backwards
         std::vector<vke_ds::id32_t> result;
-        for (auto it = layerOrder.rbegin(); it != layerOrder.rend(); ++it)
+        index.Query(bounds, result);
+        std::sort(result.begin(), result.end(), [this](vke_ds::id32_t a, vke_ds::id32_t b)
+                  { return layerKeys.at(units.at(a).layer) > layerKeys.at(units.at(b).layer); });
+        return result;
+    }
+
+    const std::vector<vke_ds::id32_t> &Spatial2DLayerManager::GetLayerOrder() const
+    {
+        if (layerOrderDirty)
         {
-            std::vector<vke_ds::id32_t> hits = layers.at(*it).Query(bounds);
-            result.insert(result.end(), hits.begin(), hits.end());
+            layerOrderCache.clear();
+            for (const auto &[key, layerID] : layerOrder)
+                layerOrderCache.push_back(layerID);
+            layerOrderDirty = false;
         }
-        return result;
+        return layerOrderCache;
     }
 
     vke_ds::id32_t Spatial2DLayerManager::insertUnit(Spatial2DUnit &unit)
     {
-        size_t firstLayer = 0;
-        size_t lastLayer = layerOrder.size();
+        // only layers holding an overlapping unit constrain the placement: below ones with a lower
+        // z, above ones with a higher z, and none with a different z can take the unit
+        std::unordered_set<vke_ds::id32_t> belowLayers, aboveLayers;
+        index.ForEachOverlap(unit.bounds, [this, &unit, &belowLayers, &aboveLayers](vke_ds::id32_t otherID, const AABB2D &)
+                             {
+                                 const Spatial2DUnit &other = units.at(otherID);
+                                 if (other.zIndex < unit.zIndex)
+                                     belowLayers.insert(other.layer);
+                                 else if (other.zIndex > unit.zIndex)
+                                     aboveLayers.insert(other.layer);
+                                 return true; });
 
-        for (size_t i = 0; i < layerOrder.size(); ++i)
-        {
-            const Spatial2DLayer &layer = layers.at(layerOrder[i]);
-            for (const auto &entry : layer.GetUnits())
-            {
-                const Spatial2DUnit &other = *entry.second;
-                if (!other.bounds.Overlaps(unit.bounds))
-                    continue;
-                if (other.zIndex < unit.zIndex)
-                    firstLayer = std::max(firstLayer, i + 1);
-                else if (other.zIndex > unit.zIndex)
-                    lastLayer = std::min(lastLayer, i);
-            }
-        }
+        uint64_t firstKey = 0;
+        uint64_t lastKey = std::numeric_limits<uint64_t>::max();
+        for (vke_ds::id32_t layerID : belowLayers)
+            firstKey = std::max(firstKey, layerKeys.at(layerID) + 1);
+        for (vke_ds::id32_t layerID : aboveLayers)
+            lastKey = std::min(lastKey, layerKeys.at(layerID));
 
-        if (firstLayer > lastLayer)
-            firstLayer = lastLayer;
+        if (firstKey > lastKey)
+            firstKey = lastKey;
 
-        for (size_t i = firstLayer; i < layerOrder.size() && i <= lastLayer; ++i)
+        // every layer skipped here is one of the blocked ones, so this stops after at most as many steps
+        index.Insert(unit.id, unit.bounds);
+        const LayerOrder::iterator first = layerOrder.lower_bound(firstKey);
+        for (auto it = first; it != layerOrder.end() && it->first <= lastKey; ++it)
         {
-            Spatial2DLayer &layer = layers.at(layerOrder[i]);
-            if (layer.CanInsert(unit))
+            const vke_ds::id32_t layerID = it->second;
+            if (belowLayers.count(layerID) == 0 && aboveLayers.count(layerID) == 0)
             {
-                layer.Insert(unit);
-                return layer.id;
+                layers.at(layerID).Insert(unit);
+                return layerID;
             }
         }
 
         const vke_ds::id32_t layerID = layerAllocator.Alloc();
         auto [it, inserted] = layers.emplace(layerID, Spatial2DLayer(layerID));
         it->second.Insert(unit);
-        layerOrder.insert(layerOrder.begin() + static_cast<std::ptrdiff_t>(firstLayer), layerID);
+        const uint64_t key = allocLayerKey(first);
+        layerOrder.emplace(key, layerID);
+        layerKeys[layerID] = key;
+        layerOrderDirty = true;
         return layerID;
     }
 
+    uint64_t Spatial2DLayerManager::allocLayerKey(LayerOrder::iterator next)
+    {
+        // halfway between the neighbours, or a fixed gap past the first or last layer
+        const uint64_t low = next == layerOrder.begin() ? 0 : std::prev(next)->first;
+        const uint64_t high = next == layerOrder.end() ? std::numeric_limits<uint64_t>::max() : next->first;
+        uint64_t step = (high - low) / 2;
+        if (next == layerOrder.begin() || next == layerOrder.end())
+            step = std::min(step, LAYER_KEY_GAP);
+        if (step == 0)
+            return allocLayerKey(spreadLayerKeys(next));
+        return next == layerOrder.begin() && next != layerOrder.end() ? high - step : low + step;
+    }
+
+    Spatial2DLayerManager::LayerOrder::iterator Spatial2DLayerManager::spreadLayerKeys(LayerOrder::iterator next)
+    {
+        // grow a window around next until its key range leaves each layer in it a gap at least as
+        // large as the window, then respace only the window's layers, with a free slot at next
+        LayerOrder::iterator first = next, last = next;
+        uint64_t cnt = 0, low = 0, high = 0;
+        for (uint64_t grow = 1;; grow *= 2)
+        {
+            for (uint64_t i = 0; i < grow && first != layerOrder.begin(); ++i, ++cnt)
+                --first;
+            for (uint64_t i = 0; i < grow && last != layerOrder.end(); ++i, ++cnt)
+                ++last;
+            low = first == layerOrder.begin() ? 0 : std::prev(first)->first;
+            high = last == layerOrder.end() ? std::numeric_limits<uint64_t>::max() : last->first;
+            if ((high - low) / (cnt + 2) >= std::max<uint64_t>(cnt, 2) ||
+                (first == layerOrder.begin() && last == layerOrder.end()))
+                break;
+        }
+
+        std::vector<vke_ds::id32_t> window;
+        size_t nextIndex = 0;
+        for (auto it = first; it != last; ++it)
+        {
+            if (it == next)
+                nextIndex = window.size();
+            window.push_back(it->second);
+        }
+        layerOrder.erase(first, last);
+
+        const uint64_t spacing = (high - low) / (cnt + 2);
+        LayerOrder::iterator respaced = last;
+        for (size_t i = 0; i < window.size(); ++i)
+        {
+            const uint64_t key = low + spacing * (i + (i >= nextIndex && next != last ? 2 : 1));
+            auto it = layerOrder.emplace_hint(last, key, window[i]);
+            layerKeys[window[i]] = key;
+            if (i == nextIndex && next != last)
+                respaced = it;
+        }
+        return respaced;
+    }
+
     void Spatial2DLayerManager::removeFromLayer(Spatial2DUnit &unit)
     {
         if (unit.layer == Spatial2DUnit::INVALID_LAYER)
             return;
 
+        index.Remove(unit.id);
         auto layerIt = layers.find(unit.layer);
         if (layerIt != layers.end())
         {
             layerIt->second.Remove(unit.id);
             if (layerIt->second.Empty())
             {
-                layerOrder.erase(std::remove(layerOrder.begin(), layerOrder.end(), unit.layer), layerOrder.end());
+                layerOrder.erase(layerKeys.at(unit.layer));
+                layerKeys.erase(unit.layer);
+                layerOrderDirty = true;
                 layers.erase(layerIt);
             }
         }
@@ -0,0 +1,103 @@
+#include <text_layout.hpp>
+#include <bit>
+
+namespace vke_common
+{
+    TextLayoutCache *TextLayoutCache::instance = nullptr;
+
+    TextLayoutCache::TextLayoutCache(uint32_t capacity, uint32_t frameBudget)
+        : slots(capacity), layouts(capacity), frameBudget(frameBudget), budgetLeft(frameBudget) {}
+
+    TextLayoutCache *TextLayoutCache::GetInstance()
+    {
+        return instance;
+    }
+
+    TextLayoutCache *TextLayoutCache::Init(uint32_t capacity, uint32_t frameBudget)
+    {
+        if (instance == nullptr)
+            instance = new TextLayoutCache(capacity, frameBudget);
+        return instance;
+    }
+
+    void TextLayoutCache::Dispose()
+    {
+        delete instance;
+        instance = nullptr;
+    }
+
+    void TextLayoutCache::Defer(const void *owner, std::function<void()> retry)
+    {
+        auto [it, inserted] = deferred.insert_or_assign(owner, std::move(retry));
+        if (inserted)
+            deferredOrder.push_back(owner);
+    }
+
+    void TextLayoutCache::CancelDeferred(const void *owner)
+    {
+        deferred.erase(owner);
+    }
+
+    void TextLayoutCache::BeginFrame()
+    {
+        slots.EndFrame();
+        budgetLeft = frameBudget;
+
+        // oldest first; whatever is deferred again goes to the back for the next frame
+        std::vector<const void *> order;
+        order.swap(deferredOrder);
+        for (const void *owner : order)
+        {
+            auto it = deferred.find(owner);
+            if (it == deferred.end())
+                continue;
+            std::function<void()> retry = std::move(it->second);
+            deferred.erase(it);
+            retry();
+        }
+    }
+
+    void TextLayoutCache::Clear()
+    {
+        slots.Clear();
+        for (TextLayout &layout : layouts)
+            layout = TextLayout();
+    }
+
+    uint32_t TextLayoutCache::slotKey(const TextLayoutKey &key)
+    {
+        uint64_t hash = key.textHash ^ (key.font * 0x9E3779B97F4A7C15ull);
+        hash ^= (static_cast<uint64_t>(key.pixelSize) << 32) ^ std::bit_cast<uint32_t>(key.wrapWidth);
+        hash *= 0xFF51AFD7ED558CCDull;
+        const uint32_t folded = static_cast<uint32_t>(hash ^ (hash >> 32));
+        return folded == vke_ds::LRUSlotCache::INVALID_KEY ? 0 : folded;
+    }
+
+    const TextLayout *TextLayoutCache::find(const TextLayoutKey &key, std::string_view text, uint64_t glyphGeneration)
+    {
+        const uint32_t slot = slots.Lookup(slotKey(key));
+        if (slot == vke_ds::LRUSlotCache::INVALID_SLOT)
+            return nullptr;
+        // another text hashing to the same slot key, or glyphs that moved since
+        const TextLayout &layout = layouts[slot];
+        if (layout.key != key || layout.text != text || !layout.IsValid(glyphGeneration))
+            return nullptr;
+        return &layout;
+    }
+
+    void TextLayoutCache::insert(const TextLayout &layout)
+    {
+        const uint32_t key = slotKey(layout.key);
+        uint32_t slot = slots.Find(key);
+        if (slot == vke_ds::LRUSlotCache::INVALID_SLOT)
+        {
+            // every cached layout is in use this frame, this one is simply not kept
+            slot = slots.PeekVictim();
+            if (slot == vke_ds::LRUSlotCache::INVALID_SLOT)
+                return;
+            slots.Assign(slot, key);
+        }
+        // reuses the storage of the layout it replaces
+        layouts[slot] = layout;
+    }
+}
@@ -1,6 +1,84 @@
 #include <time.hpp>
+#include <chrono>
+#include <thread>
 
 namespace vke_common
 {
     TimeManager *TimeManager::instance;
-}
\ No newline at end of file
+
+    ticks_t SteadyTimeSource::Now()
+    {
+        return static_cast<ticks_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::steady_clock::now().time_since_epoch())
+                                        .count());
+    }
+
+    void SteadyTimeSource::Sleep(ticks_t ticks)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(ticks));
+    }
+
+    ticks_t FramePacer::Pace()
+    {
+        ticks_t now = source->Now();
+        if (!started)
+        {
+            started = true;
+            deadline = now + periodTicks;
+            return now;
+        }
+
+        ++stats.pacedFrameCnt;
+        if (now > deadline)
+        {
+            ++stats.missedFrameCnt;
+            // more than a period late: start a new cadence rather than rush the next frames to catch up
+            deadline = now - deadline >= periodTicks ? now + periodTicks : deadline + periodTicks;
+            return now;
+        }
+
+        while (now < deadline && deadline - now > spinTicks)
+        {
+            const ticks_t sleepStart = now;
+            source->Sleep(deadline - now - spinTicks);
+            now = source->Now();
+            stats.sleptTicks += now - sleepStart;
+        }
+        const ticks_t spinStart = now;
+        while (now < deadline)
+            now = source->Now();
+        stats.spunTicks += now - spinStart;
+        deadline += periodTicks;
+        return now;
+    }
+
+    void TimeManager::Update()
+    {
+        instance->prevFrameTicks = instance->frameTicks;
+        instance->fixedStepsThisFrame = 0;
+        ++instance->frameCnt;
+        if (instance->fixedDeltaTicks > 0)
+        {
+            // the pacer turns a fixed clock run into real time playback
+            if (instance->framePacer.IsEnabled())
+                instance->framePacer.Pace();
+            instance->frameTicks = instance->frameCnt * instance->fixedDeltaTicks;
+            instance->deltaTicks = instance->fixedDeltaTicks;
+            return;
+        }
+        const ticks_t now = instance->framePacer.IsEnabled() ? instance->framePacer.Pace() : instance->source->Now();
+        instance->frameTicks = now - instance->startTicks;
+        instance->deltaTicks = instance->frameTicks - instance->prevFrameTicks;
+    }
+
+    uint32_t TimeManager::AdvanceFixedSteps()
+    {
+        const uint64_t clampedFrameCnt = instance->fixedStepper.GetStats().clampedFrameCnt;
+        instance->fixedStepsThisFrame = instance->fixedStepper.Advance(instance->deltaTicks);
+        if (instance->fixedStepper.GetStats().clampedFrameCnt != clampedFrameCnt)
+            VKE_LOG_EVERY_MS(WARN, 1000, "Frame took {:.1f} ms, dropped fixed steps beyond {} ({:.1f} ms dropped so far)",
+                             GetDeltaTimeSeconds() * 1000.0, instance->fixedStepsThisFrame,
+                             TicksToSeconds(instance->fixedStepper.GetStats().droppedTicks) * 1000.0)
+        return instance->fixedStepsThisFrame;
+    }
+}
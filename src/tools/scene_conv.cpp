@@ -0,0 +1,78 @@
+#include <logger.hpp>
+#include <scene_binary.hpp>
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <string>
+
+// scene_conv <input> <output> [--verify]
+// Converts a JSON scene to the binary scene format or back, picked by the input file contents.
+// --verify reads the output back and checks that it converts to the same JSON as the input.
+
+nlohmann::json loadJSON(const std::string &pth)
+{
+    nlohmann::json ret;
+    std::ifstream ifs(pth, std::ios::in);
+    ifs >> ret;
+    ifs.close();
+    return ret;
+}
+
+bool toJSON(const std::string &ipth, const std::string &opth, bool verify)
+{
+    vke_common::SceneBinaryReader reader;
+    if (!reader.Open(ipth))
+        return false;
+
+    nlohmann::json json = reader.ToJSON();
+    std::ofstream ofs(opth, std::ios::out);
+    ofs << json.dump(4);
+    ofs.close();
+
+    if (verify && vke_common::SceneBinaryWriter::FromJSON(loadJSON(opth)).Finish() != vke_common::SceneBinaryWriter::FromJSON(json).Finish())
+    {
+        VKE_LOG_ERROR("Verification failed: {} does not convert back to {}", opth, ipth)
+        return false;
+    }
+    return true;
+}
+
+bool toBinary(const std::string &ipth, const std::string &opth, bool verify)
+{
+    nlohmann::json json = loadJSON(ipth);
+    if (!vke_common::SceneBinaryWriter::FromJSON(json).WriteFile(opth))
+    {
+        VKE_LOG_ERROR("Failed to write {}", opth)
+        return false;
+    }
+
+    if (verify)
+    {
+        vke_common::SceneBinaryReader reader;
+        if (!reader.Open(opth) || reader.ToJSON() != json)
+        {
+            VKE_LOG_ERROR("Verification failed: {} does not convert back to {}", opth, ipth)
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3 && argc != 4)
+    {
+        VKE_LOG_ERROR("Usage: scene_conv <input> <output> [--verify]")
+        return -1;
+    }
+
+    std::string ipth(argv[1]);
+    std::string opth(argv[2]);
+    bool verify = argc == 4 && std::string(argv[3]) == "--verify";
+    bool binaryInput = vke_common::SceneBinaryReader::IsSceneBinary(ipth);
+
+    VKE_LOG_INFO("{} {} -> {}", binaryInput ? "binary to JSON" : "JSON to binary", ipth, opth)
+    bool ok = binaryInput ? toJSON(ipth, opth, verify) : toBinary(ipth, opth, verify);
+    if (ok && verify)
+        VKE_LOG_INFO("Verified {}", opth)
+    return ok ? 0 : -1;
+}
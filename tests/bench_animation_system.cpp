@@ -0,0 +1,295 @@
+#include <animation_system.hpp>
+#include <ozz/animation/offline/animation_builder.h>
+#include <ozz/animation/offline/raw_animation.h>
+#include <ozz/animation/offline/raw_skeleton.h>
+#include <ozz/animation/offline/skeleton_builder.h>
+#include <ozz/animation/runtime/local_to_model_job.h>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+
+// Headless comparison of the old per-animator render callbacks (one serial sampling + local-to-model
+// pass per instance, each with its own context and buffer) against the batched AnimationSystem.
+// Uses a generated 65 joint rig (root + 4 chains of 16) so no asset files are needed.
+// The second part runs a crowd spread out in front of the viewer with LOD off, on, and on with
+// pose sharing.
+
+static constexpr uint32_t INSTANCE_CNT = 1000;
+static constexpr uint32_t FRAME_CNT = 200;
+static constexpr uint32_t CHAIN_CNT = 4;
+static constexpr uint32_t CHAIN_LENGTH = 16;
+static constexpr float DELTA_TIME = 1.0f / 60.0f;
+static constexpr uint32_t CROWD_ROW_CNT = 80;
+static constexpr uint32_t CROWD_COLUMN_CNT = 50;
+static constexpr float CROWD_SPACING = 2.0f;
+
+using Clock = std::chrono::steady_clock;
+
+struct Rig
+{
+    ozz::unique_ptr<ozz::animation::Skeleton> skeleton;
+    ozz::unique_ptr<ozz::animation::Animation> animation;
+    std::vector<int> joints;
+    std::vector<ozz::math::Float4x4> invBindMatrices;
+};
+
+static Rig BuildRig()
+{
+    ozz::animation::offline::RawSkeleton rawSkeleton;
+    rawSkeleton.roots.resize(1);
+    ozz::animation::offline::RawSkeleton::Joint &root = rawSkeleton.roots[0];
+    root.name = "root";
+    root.transform = ozz::math::Transform::identity();
+    root.children.resize(CHAIN_CNT);
+    for (uint32_t c = 0; c < CHAIN_CNT; ++c)
+    {
+        ozz::animation::offline::RawSkeleton::Joint *joint = &root.children[c];
+        for (uint32_t j = 0; j < CHAIN_LENGTH; ++j)
+        {
+            joint->name = "chain" + std::to_string(c) + "_" + std::to_string(j);
+            joint->transform = ozz::math::Transform::identity();
+            joint->transform.translation = ozz::math::Float3(j == 0 ? 0.2f * c : 0.0f, 0.1f, 0.0f);
+            if (j + 1 < CHAIN_LENGTH)
+            {
+                joint->children.resize(1);
+                joint = &joint->children[0];
+            }
+        }
+    }
+
+    Rig rig;
+    rig.skeleton = ozz::animation::offline::SkeletonBuilder()(rawSkeleton);
+
+    const int jointCnt = rig.skeleton->num_joints();
+    ozz::animation::offline::RawAnimation rawAnimation;
+    rawAnimation.duration = 2.0f;
+    rawAnimation.tracks.resize(jointCnt);
+    for (int i = 0; i < jointCnt; ++i)
+    {
+        ozz::animation::offline::RawAnimation::JointTrack &track = rawAnimation.tracks[i];
+        for (uint32_t k = 0; k <= 8; ++k)
+        {
+            const float time = rawAnimation.duration * k / 8.0f;
+            const float angle = 0.3f * std::sin(k * 0.785f + i * 0.1f);
+            track.rotations.push_back({time, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3(0.0f, 0.0f, 1.0f), angle)});
+            track.translations.push_back({time, ozz::math::Float3(0.0f, 0.1f, 0.0f)});
+        }
+        track.scales.push_back({0.0f, ozz::math::Float3::one()});
+    }
+    rig.animation = ozz::animation::offline::AnimationBuilder()(rawAnimation);
+
+    for (int i = 0; i < jointCnt; ++i)
+    {
+        rig.joints.push_back(i);
+        rig.invBindMatrices.push_back(ozz::math::Float4x4::identity());
+    }
+    return rig;
+}
+
+// the pre-AnimationSystem SkeletonAnimator::update, minus the Vulkan buffer
+struct CallbackAnimator
+{
+    const Rig *rig;
+    float timeRatio;
+    ozz::animation::SamplingJob::Context context;
+    ozz::vector<ozz::math::SoaTransform> locals;
+    ozz::vector<ozz::math::Float4x4> models;
+    ozz::vector<ozz::math::Float4x4> skinningMatrices;
+    std::vector<float> buffer;
+
+    CallbackAnimator(const Rig *rig, float timeRatio)
+        : rig(rig), timeRatio(timeRatio), locals(rig->skeleton->num_soa_joints()), models(rig->skeleton->num_joints()),
+          skinningMatrices(rig->joints.size()), buffer(16 * rig->joints.size())
+    {
+        context.Resize(rig->skeleton->num_joints());
+    }
+
+    void update(uint32_t currentFrame)
+    {
+        const float ratio = timeRatio + DELTA_TIME / rig->animation->duration();
+        timeRatio = ratio - std::floor(ratio);
+
+        ozz::animation::SamplingJob samplingJob;
+        samplingJob.animation = rig->animation.get();
+        samplingJob.context = &context;
+        samplingJob.ratio = timeRatio;
+        samplingJob.output = make_span(locals);
+        samplingJob.Run();
+
+        ozz::animation::LocalToModelJob ltmJob;
+        ltmJob.skeleton = rig->skeleton.get();
+        ltmJob.input = make_span(locals);
+        ltmJob.output = make_span(models);
+        ltmJob.Run();
+
+        for (size_t i = 0; i < skinningMatrices.size(); ++i)
+            skinningMatrices[i] = models[rig->joints[i]] * rig->invBindMatrices[i];
+        for (size_t i = 0; i < skinningMatrices.size(); ++i)
+            for (int j = 0; j < 4; ++j)
+                ozz::math::StorePtrU(skinningMatrices[i].cols[j], buffer.data() + (i << 4) + (j << 2));
+    }
+};
+
+static float StartRatio(uint32_t i)
+{
+    return static_cast<float>(i % 97) / 97.0f;
+}
+
+static double MeasureCallbacks(const Rig &rig, std::vector<std::unique_ptr<CallbackAnimator>> &animators)
+{
+    std::unordered_map<uint64_t, std::function<void(uint32_t)>> callbacks;
+    for (uint32_t i = 0; i < INSTANCE_CNT; ++i)
+    {
+        animators.push_back(std::make_unique<CallbackAnimator>(&rig, StartRatio(i)));
+        callbacks[i] = std::bind(&CallbackAnimator::update, animators.back().get(), std::placeholders::_1);
+    }
+
+    const auto start = Clock::now();
+    for (uint32_t frame = 0; frame < FRAME_CNT; ++frame)
+        for (auto &kv : callbacks)
+            kv.second(frame % 2);
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / FRAME_CNT;
+}
+
+static double MeasureSystem(const Rig &rig, int32_t jobThreadCnt, std::vector<float> &palette, std::vector<uint32_t> &offsets, uint32_t &workerCnt)
+{
+    vke_common::JobSystem::Init(jobThreadCnt);
+    vke_common::AnimationSystem system;
+    vke_common::AnimationInstanceDesc desc;
+    desc.skeleton = rig.skeleton.get();
+    desc.animation = rig.animation.get();
+    desc.joints = &rig.joints;
+    desc.invBindMatrices = &rig.invBindMatrices;
+    offsets.clear();
+    for (uint32_t i = 0; i < INSTANCE_CNT; ++i)
+    {
+        const uint32_t id = system.AddInstance(desc);
+        system.GetPlayback(id).timeRatio = StartRatio(i);
+        offsets.push_back(system.GetPaletteOffset(id));
+    }
+
+    palette.assign(static_cast<size_t>(system.GetPaletteSize()) * 16, 0.0f);
+    workerCnt = system.GetWorkerCnt();
+    const auto start = Clock::now();
+    for (uint32_t frame = 0; frame < FRAME_CNT; ++frame)
+        system.Update(DELTA_TIME, palette.data());
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / FRAME_CNT;
+    vke_common::JobSystem::Dispose();
+    return ms;
+}
+
+struct CrowdResult
+{
+    double ms;
+    vke_common::AnimationStats stats;
+    std::vector<uint32_t> lods;
+    std::vector<uint32_t> offsets;
+};
+
+// rows recede from the viewer at the origin, so the crowd covers every LOD level of the default config
+static CrowdResult MeasureCrowd(const Rig &rig, bool enableLOD, bool sharePoses, std::vector<float> &palette)
+{
+    vke_common::AnimationConfig config;
+    config.enableLOD = enableLOD;
+    config.sharePoses = sharePoses;
+    vke_common::AnimationSystem system(config);
+    const float viewer[3] = {0.0f, 0.0f, 0.0f};
+    system.SetViewer(viewer, 1.0f / std::tan(0.5f * 0.785f));
+
+    std::vector<std::array<float, 16>> worldMatrices(CROWD_ROW_CNT * CROWD_COLUMN_CNT);
+    vke_common::AnimationInstanceDesc desc;
+    desc.skeleton = rig.skeleton.get();
+    desc.animation = rig.animation.get();
+    desc.joints = &rig.joints;
+    desc.invBindMatrices = &rig.invBindMatrices;
+    for (uint32_t i = 0; i < worldMatrices.size(); ++i)
+    {
+        std::array<float, 16> &m = worldMatrices[i];
+        m = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+        m[12] = (static_cast<float>(i % CROWD_COLUMN_CNT) - CROWD_COLUMN_CNT * 0.5f) * CROWD_SPACING;
+        m[14] = -static_cast<float>(i / CROWD_COLUMN_CNT + 1) * CROWD_SPACING;
+        desc.worldMatrix = m.data();
+        // a crowd usually plays few clip phases, which is what pose sharing picks up
+        system.GetPlayback(system.AddInstance(desc)).timeRatio = static_cast<float>(i % 8) / 8.0f;
+    }
+
+    palette.assign(static_cast<size_t>(system.GetPaletteSize()) * 16, 0.0f);
+    CrowdResult result{};
+    const auto start = Clock::now();
+    for (uint32_t frame = 0; frame < FRAME_CNT; ++frame)
+    {
+        system.Update(DELTA_TIME, palette.data());
+        result.stats.evaluations += system.GetStats().evaluations;
+        result.stats.interpolated += system.GetStats().interpolated;
+        result.stats.shared += system.GetStats().shared;
+        result.stats.deferred += system.GetStats().deferred;
+    }
+    result.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / FRAME_CNT;
+    for (uint32_t i = 0; i < worldMatrices.size(); ++i)
+    {
+        result.lods.push_back(system.GetLOD(i));
+        result.offsets.push_back(system.GetPaletteOffset(i));
+    }
+    return result;
+}
+
+static void PrintCrowd(const char *name, const CrowdResult &result)
+{
+    std::cout << name << ": " << result.ms << " ms/frame, per frame " << result.stats.evaluations / FRAME_CNT << " evaluated, "
+              << result.stats.interpolated / FRAME_CNT << " interpolated, " << result.stats.shared / FRAME_CNT << " shared\n";
+}
+
+int main()
+{
+    const Rig rig = BuildRig();
+    std::cout << INSTANCE_CNT << " instances, " << rig.skeleton->num_joints() << " joints, " << FRAME_CNT << " frames\n";
+
+    std::vector<std::unique_ptr<CallbackAnimator>> animators;
+    const double callbackMs = MeasureCallbacks(rig, animators);
+    std::cout << "per-animator callbacks: " << callbackMs << " ms/frame\n";
+
+    std::vector<float> palette;
+    std::vector<uint32_t> offsets;
+    uint32_t workerCnt = 0;
+    const double serialMs = MeasureSystem(rig, 0, palette, offsets, workerCnt);
+    std::cout << "animation system, 1 worker: " << serialMs << " ms/frame\n";
+    const double parallelMs = MeasureSystem(rig, -1, palette, offsets, workerCnt);
+    std::cout << "animation system, " << workerCnt << " workers: " << parallelMs << " ms/frame, speedup "
+              << callbackMs / parallelMs << "x\n";
+
+    // both paths advance the same instances by the same amount, so the palettes have to agree
+    float maxError = 0.0f;
+    for (uint32_t i = 0; i < INSTANCE_CNT; ++i)
+    {
+        const float *expected = animators[i]->buffer.data();
+        const float *actual = palette.data() + static_cast<size_t>(offsets[i]) * 16;
+        for (size_t j = 0; j < rig.joints.size() * 16; ++j)
+            maxError = std::max(maxError, std::abs(expected[j] - actual[j]));
+    }
+    std::cout << "max palette difference " << maxError << "\n";
+
+    std::cout << CROWD_ROW_CNT * CROWD_COLUMN_CNT << " instance crowd, rows " << CROWD_SPACING << " to "
+              << CROWD_ROW_CNT * CROWD_SPACING << " from the viewer\n";
+    std::vector<float> fullPalette, lodPalette, sharedPalette;
+    vke_common::JobSystem::Init();
+    const CrowdResult full = MeasureCrowd(rig, false, false, fullPalette);
+    PrintCrowd("LOD off", full);
+    const CrowdResult lod = MeasureCrowd(rig, true, false, lodPalette);
+    PrintCrowd("LOD on", lod);
+    const CrowdResult shared = MeasureCrowd(rig, true, true, sharedPalette);
+    PrintCrowd("LOD on, shared poses", shared);
+    vke_common::JobSystem::Dispose();
+    std::cout << "LOD speedup " << full.ms / lod.ms << "x, with sharing " << full.ms / shared.ms << "x\n";
+
+    // instances close enough for the full rate level must not be changed by LOD
+    float nearError = 0.0f;
+    for (size_t i = 0; i < lod.lods.size(); ++i)
+        if (lod.lods[i] == 0)
+            for (size_t j = lod.offsets[i] * 16; j < (lod.offsets[i] + rig.joints.size()) * 16; ++j)
+                nearError = std::max(nearError, std::abs(fullPalette[j] - lodPalette[j]));
+    std::cout << "max full rate LOD difference " << nearError << "\n";
+    return maxError < 1e-4f && nearError < 1e-4f ? 0 : 1;
+}
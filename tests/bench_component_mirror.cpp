@@ -0,0 +1,62 @@
+#include <component_mirror.hpp>
+#include <component/rigidbody.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+// Measures the per-frame cost of ComponentMirror::Refresh on a standalone registry
+// (no scene or render device involved): transforms only, and transforms with rigid bodies.
+
+static constexpr uint32_t ENTITY_CNT = 100000;
+static constexpr uint32_t BODY_CNT = 10000;
+static constexpr uint32_t ITERATION_CNT = 100;
+
+static void MeasureRefresh(const char *name, entt::registry &registry)
+{
+    vke_common::ComponentMirror::Refresh(registry);
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ITERATION_CNT; ++i)
+        vke_common::ComponentMirror::Refresh(registry);
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / ITERATION_CNT;
+    const vke_interop::ComponentMirrorView *view = vke_common::ComponentMirror::GetView();
+    std::cout << name << ": " << us << " us/refresh, " << us * 1000.0 / registry.storage<vke_common::Transform>().size()
+              << " ns/entity, capacity " << view->capacity << ", generation " << view->generation << "\n";
+}
+
+int main()
+{
+    vke_physics::PhysicsManager::Init();
+    vke_common::ComponentMirror::Init();
+
+    entt::registry registry;
+    for (uint32_t i = 0; i < ENTITY_CNT; ++i)
+    {
+        entt::entity entity = registry.create();
+        registry.emplace<vke_common::Transform>(entity, glm::vec3(i % 100 * 2.0f, 10.0f, i / 100 * 2.0f),
+                                                glm::vec3(1.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    }
+    MeasureRefresh("transforms", registry);
+
+    std::shared_ptr<vke_physics::PhyscisShape> sphere = std::make_shared<vke_physics::PhyscisShape>(
+        nlohmann::json{{"type", vke_physics::PHYSICS_SHAPE_SPHERE}, {"radius", 0.5f}});
+    auto transformView = registry.view<vke_common::Transform>();
+    uint32_t bodyCnt = 0;
+    for (entt::entity entity : transformView)
+    {
+        if (bodyCnt++ == BODY_CNT)
+            break;
+        vke_component::RigidBody &rigidBody = registry.emplace<vke_component::RigidBody>(
+            entity, transformView.get<vke_common::Transform>(entity), JPH::EMotionType::Dynamic,
+            vke_physics::DefaultObjectLayers::MOVING, 0.5f, 0.0f, sphere);
+        rigidBody.LoadToEngine(static_cast<uint32_t>(entity));
+    }
+    MeasureRefresh("transforms + rigidbodies", registry);
+
+    for (auto [entity, rigidBody] : registry.view<vke_component::RigidBody>().each())
+        rigidBody.UnloadFromEngine();
+    registry.clear();
+    sphere = nullptr;
+    vke_common::ComponentMirror::Dispose();
+    vke_physics::PhysicsManager::Dispose();
+    return 0;
+}
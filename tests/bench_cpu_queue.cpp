@@ -0,0 +1,336 @@
+#include "test_check.hpp"
+#include <render/queue.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The CPU command queue on the mock semaphore backend, against the polling design it replaced
+// (every pending wait passed to one vkWaitSemaphores with a 50 us timeout, callbacks run one at a
+// time on the polling thread): semaphore waits while idle, latency from a GPU signal to the
+// callback, and frames of dependent CPU tasks. Also checks dependency order, fences, submits
+// without waits and WaitIdle.
+
+static constexpr uint32_t LATENCY_ROUND_CNT = 2000;
+static constexpr uint32_t FRAME_CNT = 500;
+static constexpr uint32_t TASK_WORK_US = 20;
+
+using Clock = std::chrono::steady_clock;
+using vke_render::CPUCommandQueue;
+using vke_render::MockSemaphoreBackend;
+
+// the old CPUCommandQueue, reduced to what is measured here
+class PollingQueue
+{
+public:
+    explicit PollingQueue(MockSemaphoreBackend *backend) : backend(backend), running(true), worker(&PollingQueue::process, this) {}
+
+    ~PollingQueue()
+    {
+        running.store(false);
+        worker.join();
+    }
+
+    void Submit(const VkSubmitInfo2 &submitInfo, VkFence fence)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Pending pending{submitInfo.waitSemaphoreInfoCount, (std::function<void()> *)submitInfo.pCommandBufferInfos[0].commandBuffer,
+                        std::vector<VkSemaphoreSubmitInfo>(submitInfo.pSignalSemaphoreInfos,
+                                                           submitInfo.pSignalSemaphoreInfos + submitInfo.signalSemaphoreInfoCount),
+                        (std::atomic<bool> *)fence};
+        submits.push_back(std::make_shared<Pending>(std::move(pending)));
+        for (uint32_t i = 0; i < submitInfo.waitSemaphoreInfoCount; ++i)
+            waits.push_back({submitInfo.pWaitSemaphoreInfos[i].semaphore, submitInfo.pWaitSemaphoreInfos[i].value, submits.back()});
+    }
+
+private:
+    struct Pending
+    {
+        uint32_t remainingWaitCnt;
+        std::function<void()> *callback;
+        std::vector<VkSemaphoreSubmitInfo> signals;
+        std::atomic<bool> *fence;
+    };
+
+    struct Wait
+    {
+        VkSemaphore semaphore;
+        uint64_t value;
+        std::shared_ptr<Pending> pending;
+    };
+
+    MockSemaphoreBackend *backend;
+    std::atomic<bool> running;
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Pending>> submits;
+    std::vector<Wait> waits;
+    std::thread worker;
+
+    void process()
+    {
+        std::vector<VkSemaphore> semaphores;
+        std::vector<uint64_t> values;
+        std::vector<std::shared_ptr<Pending>> ready;
+        while (running.load())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                semaphores.clear();
+                values.clear();
+                for (const Wait &wait : waits)
+                {
+                    semaphores.push_back(wait.semaphore);
+                    values.push_back(wait.value);
+                }
+            }
+            if (semaphores.empty())
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            if (!backend->WaitAny(static_cast<uint32_t>(semaphores.size()), semaphores.data(), values.data(), 50000))
+                continue;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto it = waits.begin(); it != waits.end();)
+                    if (backend->GetValue(it->semaphore) >= it->value)
+                    {
+                        if (--it->pending->remainingWaitCnt == 0)
+                            ready.push_back(it->pending);
+                        it = waits.erase(it);
+                    }
+                    else
+                        ++it;
+            }
+            for (std::shared_ptr<Pending> &pending : ready)
+            {
+                (*pending->callback)();
+                for (const VkSemaphoreSubmitInfo &signal : pending->signals)
+                    backend->Signal(signal.semaphore, signal.value);
+                if (pending->fence != nullptr)
+                {
+                    pending->fence->store(true);
+                    pending->fence->notify_all();
+                }
+            }
+            ready.clear();
+        }
+    }
+};
+
+static VkSemaphoreSubmitInfo SemaphoreInfo(VkSemaphore semaphore, uint64_t value)
+{
+    return VkSemaphoreSubmitInfo{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, nullptr, semaphore, value, 0, 0};
+}
+
+// one submit of callback waiting for waits and signalling signals
+struct TestSubmit
+{
+    std::vector<VkSemaphoreSubmitInfo> waits;
+    std::vector<VkSemaphoreSubmitInfo> signals;
+    VkCommandBufferSubmitInfo commandBufferInfo;
+    VkSubmitInfo2 info;
+
+    TestSubmit(std::function<void()> *callback, std::vector<VkSemaphoreSubmitInfo> waits, std::vector<VkSemaphoreSubmitInfo> signals)
+        : waits(std::move(waits)), signals(std::move(signals))
+    {
+        commandBufferInfo = VkCommandBufferSubmitInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO, nullptr, (VkCommandBuffer)callback, 0};
+        info = VkSubmitInfo2{VK_STRUCTURE_TYPE_SUBMIT_INFO_2, nullptr, 0,
+                             static_cast<uint32_t>(this->waits.size()), this->waits.data(), 1, &commandBufferInfo,
+                             static_cast<uint32_t>(this->signals.size()), this->signals.data()};
+    }
+};
+
+static void Work(uint32_t us)
+{
+    const auto end = Clock::now() + std::chrono::microseconds(us);
+    while (Clock::now() < end)
+        ;
+}
+
+static void Report(const char *name, std::vector<double> &us)
+{
+    std::sort(us.begin(), us.end());
+    std::cout << name << ": p50 " << us[us.size() / 2] << " us, p99 " << us[us.size() * 99 / 100] << " us\n";
+}
+
+static void TestOrderAndFences()
+{
+    auto backendOwner = std::make_unique<MockSemaphoreBackend>();
+    MockSemaphoreBackend *backend = backendOwner.get();
+    CPUCommandQueue queue(std::move(backendOwner), 4);
+    queue.Start();
+    VkSemaphore gpu = backend->CreateTimelineSemaphore(0);
+    VkSemaphore a = backend->CreateTimelineSemaphore(0);
+    VkSemaphore b = backend->CreateTimelineSemaphore(0);
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+    auto record = [&](int task)
+    {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(task);
+    };
+    std::function<void()> first = [&]()
+    { record(1); };
+    std::function<void()> second = [&]()
+    { record(2); };
+    std::function<void()> third = [&]()
+    { record(3); };
+    std::function<void()> free = [&]()
+    { record(0); };
+
+    // third waits for second and the GPU, second for first, first for the GPU; submitted backwards
+    std::atomic<bool> fence(false);
+    TestSubmit thirdSubmit(&third, {SemaphoreInfo(b, 1), SemaphoreInfo(gpu, 2)}, {});
+    TestSubmit secondSubmit(&second, {SemaphoreInfo(a, 1)}, {SemaphoreInfo(b, 1)});
+    TestSubmit firstSubmit(&first, {SemaphoreInfo(gpu, 1)}, {SemaphoreInfo(a, 1)});
+    const VkSubmitInfo2 batch[] = {thirdSubmit.info, secondSubmit.info, firstSubmit.info};
+    queue.Submit(3, batch, (VkFence)&fence);
+    TestSubmit freeSubmit(&free, {}, {});
+    queue.Submit(1, &freeSubmit.info, VK_NULL_HANDLE);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        Check("a submit without waits runs at once, the others wait for the GPU", order == std::vector<int>{0} && !fence.load());
+    }
+    backend->Signal(gpu, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    Check("the fence stays unset until every submit of the call finished", !fence.load());
+    backend->Signal(gpu, 2);
+    fence.wait(false);
+    queue.WaitIdle();
+    Check("dependent submits run in semaphore order and set the fence", order == std::vector<int>({0, 1, 2, 3}));
+    queue.Stop();
+}
+
+static void MeasureIdle()
+{
+    MockSemaphoreBackend pollingBackend;
+    VkSemaphore never = pollingBackend.CreateTimelineSemaphore(0);
+    std::function<void()> nothing = []() {};
+    TestSubmit pending(&nothing, {SemaphoreInfo(never, 1)}, {});
+    {
+        PollingQueue polling(&pollingBackend);
+        polling.Submit(pending.info, VK_NULL_HANDLE);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    auto backendOwner = std::make_unique<MockSemaphoreBackend>();
+    MockSemaphoreBackend *backend = backendOwner.get();
+    CPUCommandQueue queue(std::move(backendOwner), 2);
+    queue.Start();
+    VkSemaphore blocked = backend->CreateTimelineSemaphore(0);
+    TestSubmit blockedSubmit(&nothing, {SemaphoreInfo(blocked, 1)}, {});
+    queue.Submit(1, &blockedSubmit.info, VK_NULL_HANDLE);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const uint64_t waits = backend->GetWaitCount();
+    std::cout << "idle 100 ms with a pending wait: " << waits << " semaphore waits, polling " << pollingBackend.GetWaitCount() << "\n";
+    Check("the idle queue blocks instead of polling", waits <= 2);
+    queue.Stop();
+}
+
+// a GPU thread signals, the time until the callback starts
+template <typename SubmitFn>
+static std::vector<double> MeasureLatency(MockSemaphoreBackend *backend, SubmitFn &&submit)
+{
+    VkSemaphore gpu = backend->CreateTimelineSemaphore(0);
+    std::vector<double> us;
+    Clock::time_point signalTime;
+    std::atomic<bool> fence(true);
+    std::function<void()> callback = [&]()
+    { us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - signalTime).count()); };
+    for (uint64_t round = 1; round <= LATENCY_ROUND_CNT; ++round)
+    {
+        TestSubmit submitInfo(&callback, {SemaphoreInfo(gpu, round)}, {});
+        fence.store(false);
+        submit(submitInfo.info, (VkFence)&fence);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        signalTime = Clock::now();
+        backend->Signal(gpu, round);
+        fence.wait(false);
+    }
+    return us;
+}
+
+// per frame: a task after the GPU, four after it, a last one after those four with the fence
+template <typename SubmitFn>
+static double MeasureFrames(MockSemaphoreBackend *backend, SubmitFn &&submit)
+{
+    VkSemaphore gpu = backend->CreateTimelineSemaphore(0);
+    VkSemaphore head = backend->CreateTimelineSemaphore(0);
+    std::vector<VkSemaphore> middle;
+    for (int i = 0; i < 4; ++i)
+        middle.push_back(backend->CreateTimelineSemaphore(0));
+    std::function<void()> task = []()
+    { Work(TASK_WORK_US); };
+
+    const auto start = Clock::now();
+    for (uint64_t frame = 1; frame <= FRAME_CNT; ++frame)
+    {
+        std::atomic<bool> fence(false);
+        std::vector<TestSubmit> submits;
+        submits.reserve(6);
+        submits.emplace_back(&task, std::vector<VkSemaphoreSubmitInfo>{SemaphoreInfo(gpu, frame)},
+                             std::vector<VkSemaphoreSubmitInfo>{SemaphoreInfo(head, frame)});
+        std::vector<VkSemaphoreSubmitInfo> lastWaits;
+        for (VkSemaphore semaphore : middle)
+        {
+            submits.emplace_back(&task, std::vector<VkSemaphoreSubmitInfo>{SemaphoreInfo(head, frame)},
+                                 std::vector<VkSemaphoreSubmitInfo>{SemaphoreInfo(semaphore, frame)});
+            lastWaits.push_back(SemaphoreInfo(semaphore, frame));
+        }
+        submits.emplace_back(&task, lastWaits, std::vector<VkSemaphoreSubmitInfo>{});
+        for (size_t i = 0; i + 1 < submits.size(); ++i)
+            submit(submits[i].info, VK_NULL_HANDLE);
+        submit(submits.back().info, (VkFence)&fence);
+        backend->Signal(gpu, frame);
+        fence.wait(false);
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / FRAME_CNT;
+}
+
+int main()
+{
+    TestOrderAndFences();
+    MeasureIdle();
+
+    {
+        MockSemaphoreBackend pollingBackend;
+        PollingQueue polling(&pollingBackend);
+        std::vector<double> pollingUs = MeasureLatency(&pollingBackend, [&](const VkSubmitInfo2 &info, VkFence fence)
+                                                       { polling.Submit(info, fence); });
+        auto backendOwner = std::make_unique<MockSemaphoreBackend>();
+        MockSemaphoreBackend *backend = backendOwner.get();
+        CPUCommandQueue queue(std::move(backendOwner), 2);
+        queue.Start();
+        std::vector<double> queueUs = MeasureLatency(backend, [&](const VkSubmitInfo2 &info, VkFence fence)
+                                                     { queue.Submit(1, &info, fence); });
+        Report("signal to callback, polling", pollingUs);
+        Report("signal to callback, blocking", queueUs);
+        Check("every latency round ran its callback", pollingUs.size() == LATENCY_ROUND_CNT && queueUs.size() == LATENCY_ROUND_CNT);
+        queue.Stop();
+    }
+
+    {
+        MockSemaphoreBackend pollingBackend;
+        PollingQueue polling(&pollingBackend);
+        const double pollingMs = MeasureFrames(&pollingBackend, [&](const VkSubmitInfo2 &info, VkFence fence)
+                                               { polling.Submit(info, fence); });
+        auto backendOwner = std::make_unique<MockSemaphoreBackend>();
+        MockSemaphoreBackend *backend = backendOwner.get();
+        CPUCommandQueue queue(std::move(backendOwner), 4);
+        queue.Start();
+        const double queueMs = MeasureFrames(backend, [&](const VkSubmitInfo2 &info, VkFence fence)
+                                             { queue.Submit(1, &info, fence); });
+        std::cout << "frame of 6 dependent " << TASK_WORK_US << " us tasks: polling " << pollingMs << " ms, pooled "
+                  << queueMs << " ms\n";
+        queue.Stop();
+    }
+
+    return CheckResult();
+}
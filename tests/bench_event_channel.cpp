@@ -0,0 +1,165 @@
+#include "test_check.hpp"
+#include <event.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Producer throughput of the lock-free event queue against a mutex guarded vector, with 1 to 8
+// threads posting a frame's worth of events each frame and the main thread dispatching them at
+// the end of the frame, like Engine::Update does. Also the cost of calling listeners out of the
+// contiguous listener array against the std::map the event hub used to keep them in. Producer
+// scaling needs as many cores as threads.
+
+static constexpr uint32_t FRAME_CNT = 200;
+static constexpr uint32_t EVENTS_PER_FRAME = 8192;
+static constexpr uint32_t MAX_PRODUCER_CNT = 8;
+static constexpr uint32_t LISTENER_CNT = 64;
+static constexpr uint32_t DISPATCH_CNT = 20000;
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchEvent
+{
+    uint32_t producer = 0;
+    uint32_t value = 0;
+    float payload[6] = {};
+};
+
+// what EventHub did before: post under a lock, swap the vector out to dispatch
+class LockedQueue
+{
+public:
+    void Post(const BenchEvent &event)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(event);
+    }
+
+    template <typename Fn>
+    uint32_t DispatchQueued(Fn &&fn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            scratch.swap(events);
+        }
+        for (const BenchEvent &event : scratch)
+            fn(event);
+        const uint32_t cnt = static_cast<uint32_t>(scratch.size());
+        scratch.clear();
+        return cnt;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<BenchEvent> events;
+    std::vector<BenchEvent> scratch;
+};
+
+// each frame producerCnt threads post EVENTS_PER_FRAME events between them, then the calling
+// thread dispatches; returns events posted per second of posting
+template <typename PostFn, typename DispatchFn>
+static double MeasureProducers(uint32_t producerCnt, PostFn &&post, DispatchFn &&dispatch, uint64_t &received)
+{
+    const uint32_t eventsPerProducer = EVENTS_PER_FRAME / producerCnt;
+    std::atomic<uint32_t> frame(0);
+    std::atomic<uint32_t> doneCnt(0);
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < producerCnt; ++p)
+        producers.emplace_back([&, p]()
+                               {
+                                   BenchEvent event;
+                                   event.producer = p;
+                                   for (uint32_t f = 1; f <= FRAME_CNT; ++f)
+                                   {
+                                       while (frame.load(std::memory_order_acquire) < f)
+                                           std::this_thread::yield();
+                                       for (uint32_t i = 0; i < eventsPerProducer; ++i)
+                                       {
+                                           event.value = i;
+                                           post(event);
+                                       }
+                                       doneCnt.fetch_add(1, std::memory_order_acq_rel);
+                                   } });
+
+    double postingSeconds = 0.0;
+    for (uint32_t f = 1; f <= FRAME_CNT; ++f)
+    {
+        const auto start = Clock::now();
+        frame.store(f, std::memory_order_release);
+        while (doneCnt.load(std::memory_order_acquire) < f * producerCnt)
+            std::this_thread::yield();
+        postingSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        received += dispatch();
+    }
+    for (std::thread &producer : producers)
+        producer.join();
+    return double(FRAME_CNT) * eventsPerProducer * producerCnt / postingSeconds;
+}
+
+int main()
+{
+    for (uint32_t producerCnt = 1; producerCnt <= MAX_PRODUCER_CNT; producerCnt *= 2)
+    {
+        uint64_t sum = 0;
+        auto consume = [&sum](const BenchEvent &event)
+        { sum += event.value; };
+
+        vke_common::EventChannel<BenchEvent> channel(EVENTS_PER_FRAME);
+        channel.AddListener(consume);
+        uint64_t channelReceived = 0;
+        const double channelRate = MeasureProducers(
+            producerCnt, [&](const BenchEvent &event)
+            { channel.Post(event); },
+            [&]()
+            { return channel.DispatchQueued(); },
+            channelReceived);
+
+        LockedQueue locked;
+        uint64_t lockedReceived = 0;
+        const double lockedRate = MeasureProducers(
+            producerCnt, [&](const BenchEvent &event)
+            { locked.Post(event); },
+            [&]()
+            { return locked.DispatchQueued(consume); },
+            lockedReceived);
+
+        std::cout << producerCnt << " producers: lock-free " << channelRate / 1e6 << " M events/s ("
+                  << channel.GetOverflowCount() << " overflowed), mutex " << lockedRate / 1e6 << " M events/s\n";
+        const uint64_t eventsPerProducer = EVENTS_PER_FRAME / producerCnt;
+        const uint64_t expected = FRAME_CNT * producerCnt * eventsPerProducer;
+        Check(std::to_string(producerCnt) + " producers: every event is dispatched once",
+              channelReceived == expected && lockedReceived == expected &&
+                  sum == 2 * FRAME_CNT * producerCnt * (eventsPerProducer * (eventsPerProducer - 1) / 2));
+    }
+
+    // listener call cost, the old map against the contiguous array
+    uint64_t mapSum = 0, listSum = 0;
+    std::map<vke_ds::id32_t, std::function<void(uint32_t)>> listenerMap;
+    vke_common::ListenerList<std::function<void(uint32_t)>> listenerList;
+    for (uint32_t i = 0; i < LISTENER_CNT; ++i)
+    {
+        listenerMap[i] = [&mapSum, i](uint32_t value)
+        { mapSum += value ^ i; };
+        listenerList.Add([&listSum, i](uint32_t value)
+                         { listSum += value ^ i; });
+    }
+    auto start = Clock::now();
+    for (uint32_t d = 0; d < DISPATCH_CNT; ++d)
+        for (auto &kv : listenerMap)
+            kv.second(d);
+    const double mapNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / DISPATCH_CNT;
+    start = Clock::now();
+    for (uint32_t d = 0; d < DISPATCH_CNT; ++d)
+        listenerList.Invoke(d);
+    const double listNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / DISPATCH_CNT;
+    std::cout << "dispatch to " << LISTENER_CNT << " listeners: map " << mapNs << " ns, array " << listNs << " ns\n";
+    Check("both call every listener", mapSum == listSum);
+
+    return CheckResult();
+}
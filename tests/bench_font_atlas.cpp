@@ -0,0 +1,146 @@
+#include "test_check.hpp"
+#include <font_atlas_baker.hpp>
+#include <job_system.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cold and warm static atlas loads of the bundled Arial: baking on the calling thread the way
+// Font::BuildStaticAtlas did, baking on the job system with a face per worker, and reading the
+// atlas back from the cache file. All three have to produce identical glyphs and pixels, also when
+// the bake itself runs as a job on a worker other than the main thread.
+// Run from the repository root.
+
+static constexpr const char *FONT_PATH = "./builtin_assets/fonts/arial.ttf";
+static constexpr const char *CACHE_DIR = "./out/bench_font_atlas_cache";
+static constexpr uint32_t PIXEL_SIZE = 48;
+static constexpr uint32_t REPEAT_CNT = 3;
+
+using Clock = std::chrono::steady_clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static bool SameGlyphs(const std::vector<vke_common::Glyph> &a, const std::vector<vke_common::Glyph> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        const vke_common::Glyph &x = a[i];
+        const vke_common::Glyph &y = b[i];
+        if (x.codepoint != y.codepoint || x.glyphIndex != y.glyphIndex || x.width != y.width || x.height != y.height ||
+            x.bearingX != y.bearingX || x.bearingY != y.bearingY || x.advanceX != y.advanceX ||
+            x.atlasX != y.atlasX || x.atlasY != y.atlasY || x.slotIndex != y.slotIndex)
+            return false;
+    }
+    return true;
+}
+
+static void Run(FT_Face face, const std::string &name, const std::vector<uint32_t> &codepoints, vke_common::JobSystem &jobSystem)
+{
+    vke_common::StaticAtlasBaker baker(face, FONT_PATH, PIXEL_SIZE);
+    std::vector<vke_common::Glyph> serialGlyphs, parallelGlyphs, jobGlyphs, cachedGlyphs;
+    std::vector<uint8_t> serialPixels, parallelPixels, jobPixels, cachedPixels;
+
+    double serialMs = 0.0, parallelMs = 0.0, saveMs = 0.0, warmMs = 0.0;
+    for (uint32_t i = 0; i < REPEAT_CNT; ++i)
+    {
+        auto start = Clock::now();
+        baker.BakeUncached(codepoints, nullptr, serialGlyphs, serialPixels);
+        serialMs += ElapsedMs(start);
+
+        start = Clock::now();
+        baker.BakeUncached(codepoints, &jobSystem, parallelGlyphs, parallelPixels);
+        parallelMs += ElapsedMs(start);
+    }
+
+    // the main thread does not Wait, which would run the job itself, so another worker owns the bake
+    // and the main face
+    vke_common::JobCounter counter;
+    std::atomic<uint32_t> bakeWorker(vke_common::JobSystem::INVALID_WORKER);
+    jobSystem.Run([&]()
+                  {
+                      bakeWorker = jobSystem.GetWorkerIndex();
+                      baker.BakeUncached(codepoints, &jobSystem, jobGlyphs, jobPixels); },
+                  &counter);
+    while (!counter.IsDone())
+        std::this_thread::yield();
+
+    std::filesystem::remove_all(CACHE_DIR);
+    const uint64_t key = baker.ComputeCacheKey(codepoints);
+    const std::string cachePath = baker.GetCachePath(CACHE_DIR, key);
+    auto start = Clock::now();
+    const bool saved = baker.SaveCache(cachePath, key, parallelGlyphs, parallelPixels);
+    saveMs = ElapsedMs(start);
+
+    bool loaded = true;
+    for (uint32_t i = 0; i < REPEAT_CNT; ++i)
+    {
+        // what Bake does on a warm load, key included
+        start = Clock::now();
+        const uint64_t warmKey = baker.ComputeCacheKey(codepoints);
+        loaded = baker.LoadCache(baker.GetCachePath(CACHE_DIR, warmKey), warmKey, cachedGlyphs, cachedPixels) && loaded;
+        warmMs += ElapsedMs(start);
+    }
+
+    std::vector<uint32_t> otherCodepoints(codepoints.begin(), codepoints.end() - 1);
+    std::vector<vke_common::Glyph> unusedGlyphs;
+    std::vector<uint8_t> unusedPixels;
+    const bool keyed = !baker.LoadCache(cachePath, baker.ComputeCacheKey(otherCodepoints), unusedGlyphs, unusedPixels);
+
+    std::cout << name << ": " << codepoints.size() << " codepoints, " << serialGlyphs.size() << " glyphs, cache file "
+              << (saved ? std::filesystem::file_size(cachePath) : 0) / 1024 << " KiB\n"
+              << "  cold, calling thread: " << serialMs / REPEAT_CNT << " ms\n"
+              << "  cold, " << jobSystem.GetWorkerCnt() << " workers: " << parallelMs / REPEAT_CNT << " ms\n"
+              << "  cache write: " << saveMs << " ms\n"
+              << "  warm: " << warmMs / REPEAT_CNT << " ms, " << serialMs / warmMs << "x faster than the serial bake\n";
+    Check(name + " parallel bake matches the serial one", SameGlyphs(serialGlyphs, parallelGlyphs) && serialPixels == parallelPixels);
+    Check(name + " bake run as a job on worker " + std::to_string(bakeWorker.load()) + " matches the serial one",
+          SameGlyphs(serialGlyphs, jobGlyphs) && serialPixels == jobPixels);
+    Check(name + " cache round trip matches the bake", saved && loaded && SameGlyphs(serialGlyphs, cachedGlyphs) && serialPixels == cachedPixels);
+    Check(name + " cache is not used for another codepoint set", keyed);
+}
+
+int main()
+{
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+    if (FT_Init_FreeType(&library) != FT_Err_Ok || FT_New_Face(library, FONT_PATH, 0, &face) != FT_Err_Ok)
+    {
+        std::cout << "cannot open " << FONT_PATH << "\n";
+        return 1;
+    }
+    if (face->charmap == nullptr)
+        FT_Select_Charmap(face, FT_ENCODING_UNICODE);
+    FT_Set_Pixel_Sizes(face, 0, PIXEL_SIZE);
+
+    // at least a few extra threads, so the per-thread faces are exercised on small machines too
+    vke_common::JobSystem jobSystem(std::max(vke_common::JobSystem::DefaultThreadCnt(), 3u));
+
+    // the builtin asset's printable ASCII
+    std::vector<uint32_t> ascii;
+    for (uint32_t codepoint = 32; codepoint < 127; ++codepoint)
+        ascii.push_back(codepoint);
+    Run(face, "ascii", ascii, jobSystem);
+
+    // every codepoint the face maps, Latin, Greek, Cyrillic, Hebrew and Arabic, up to a full atlas
+    std::vector<uint32_t> all;
+    FT_UInt glyphIndex = 0;
+    for (FT_ULong codepoint = FT_Get_First_Char(face, &glyphIndex); glyphIndex != 0;
+         codepoint = FT_Get_Next_Char(face, codepoint, &glyphIndex))
+        all.push_back(static_cast<uint32_t>(codepoint));
+    Run(face, "full face", all, jobSystem);
+
+    std::filesystem::remove_all(CACHE_DIR);
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    return CheckResult();
+}
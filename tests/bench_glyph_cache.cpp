@@ -0,0 +1,313 @@
+#include "test_check.hpp"
+#include <atlas_dirty_slots.hpp>
+#include <ds/lru_slot_cache.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Replays generated text streams against the dynamic glyph atlas bookkeeping Font used before
+// (an unordered_map of glyphs with a use counter, evicting through std::min_element) and against
+// LRUSlotCache. Rasterization is left out, both sides only decide which slot a glyph lands in, so
+// the slot sequences must match exactly; the timings show the bookkeeping cost alone.
+// Each stream also reports the bytes sent to the per-frame atlas textures, for the whole-atlas
+// copies made before dirty slot tracking and for the coalesced dirty regions.
+
+static constexpr uint32_t SLOT_CNT = 1024;
+static constexpr uint32_t FRAME_CNT = 2000;
+static constexpr uint32_t ATLAS_SIZE = 2048;
+static constexpr uint32_t SLOT_SIZE = 64;
+static constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+
+using Clock = std::chrono::steady_clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// the previous Font::GetOrCreateGlyph bookkeeping
+class MinElementCache
+{
+public:
+    // the slot the codepoint ends up in
+    uint32_t Get(uint32_t codepoint)
+    {
+        auto it = glyphs.find(codepoint);
+        if (it != glyphs.end())
+        {
+            it->second.lastUsed = ++useCounter;
+            ++hitCnt;
+            return it->second.slotIndex;
+        }
+
+        ++missCnt;
+        uint32_t slot = 0;
+        if (slotCount < SLOT_CNT)
+            slot = slotCount++;
+        else
+        {
+            auto lru = std::min_element(glyphs.begin(), glyphs.end(),
+                                        [](const auto &a, const auto &b)
+                                        { return a.second.lastUsed < b.second.lastUsed; });
+            slot = lru->second.slotIndex;
+            glyphs.erase(lru);
+            ++evictionCnt;
+        }
+        glyphs.emplace(codepoint, Entry{slot, ++useCounter});
+        return slot;
+    }
+
+    uint64_t hitCnt = 0;
+    uint64_t missCnt = 0;
+    uint64_t evictionCnt = 0;
+
+private:
+    struct Entry
+    {
+        uint32_t slotIndex;
+        uint64_t lastUsed;
+    };
+
+    std::unordered_map<uint32_t, Entry> glyphs;
+    uint32_t slotCount = 0;
+    uint64_t useCounter = 0;
+};
+
+// the same calls Font::GetOrCreateGlyph now makes
+static uint32_t GetSlot(vke_ds::LRUSlotCache &cache, uint32_t codepoint)
+{
+    uint32_t slot = cache.Lookup(codepoint);
+    if (slot != vke_ds::LRUSlotCache::INVALID_SLOT)
+        return slot;
+    slot = cache.PeekVictim();
+    if (slot != vke_ds::LRUSlotCache::INVALID_SLOT)
+        cache.Assign(slot, codepoint);
+    return slot;
+}
+
+// Zipf distributed ranks, the usual shape of character frequencies in running text
+class ZipfSampler
+{
+public:
+    ZipfSampler(uint32_t n, double s)
+    {
+        cdf.resize(n);
+        double sum = 0.0;
+        for (uint32_t i = 0; i < n; ++i)
+            cdf[i] = sum += 1.0 / std::pow(static_cast<double>(i + 1), s);
+        for (double &value : cdf)
+            value /= sum;
+    }
+
+    uint32_t operator()(std::mt19937 &rng)
+    {
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return static_cast<uint32_t>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+    }
+
+private:
+    std::vector<double> cdf;
+};
+
+// one vector of codepoints per frame
+using Stream = std::vector<std::vector<uint32_t>>;
+
+// a chat log: every frame redraws the last lines, new lines mix ASCII with CJK drawn from a
+// 7000 character frequency list, and a few users write in a second script
+static Stream ChatStream(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    ZipfSampler cjk(7000, 1.0);
+    ZipfSampler hangul(2000, 1.1);
+    std::vector<std::vector<uint32_t>> lines;
+    Stream stream(FRAME_CNT);
+    for (uint32_t frame = 0; frame < FRAME_CNT; ++frame)
+    {
+        if (frame % 3 == 0)
+        {
+            std::vector<uint32_t> line;
+            const bool korean = rng() % 5 == 0;
+            const uint32_t length = 10 + rng() % 40;
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                if (rng() % 4 == 0)
+                    line.push_back(0x20 + rng() % 95);
+                else
+                    line.push_back(korean ? 0xAC00 + hangul(rng) : 0x4E00 + cjk(rng));
+            }
+            lines.push_back(std::move(line));
+        }
+        const size_t first = lines.size() > 20 ? lines.size() - 20 : 0;
+        for (size_t i = first; i < lines.size(); ++i)
+            stream[frame].insert(stream[frame].end(), lines[i].begin(), lines[i].end());
+    }
+    return stream;
+}
+
+// scrolling through a long CJK document, one page of 600 characters visible at a time
+static Stream DocumentStream(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    ZipfSampler cjk(12000, 0.9);
+    std::vector<uint32_t> document(200000);
+    for (uint32_t &codepoint : document)
+        codepoint = 0x4E00 + cjk(rng);
+
+    Stream stream(FRAME_CNT);
+    size_t offset = 0;
+    for (uint32_t frame = 0; frame < FRAME_CNT; ++frame)
+    {
+        offset = (offset + 40 + rng() % 80) % (document.size() - 600);
+        stream[frame].assign(document.begin() + offset, document.begin() + offset + 600);
+    }
+    return stream;
+}
+
+static void Replay(const std::string &name, const Stream &stream)
+{
+    size_t lookupCnt = 0;
+    for (const auto &frame : stream)
+        lookupCnt += frame.size();
+
+    std::vector<uint32_t> oldSlots, newSlots;
+    oldSlots.reserve(lookupCnt);
+    newSlots.reserve(lookupCnt);
+
+    MinElementCache oldCache;
+    auto start = Clock::now();
+    for (const auto &frame : stream)
+        for (uint32_t codepoint : frame)
+            oldSlots.push_back(oldCache.Get(codepoint));
+    const double oldMs = ElapsedMs(start);
+
+    vke_ds::LRUSlotCache newCache(SLOT_CNT);
+    start = Clock::now();
+    for (const auto &frame : stream)
+    {
+        for (uint32_t codepoint : frame)
+            newSlots.push_back(GetSlot(newCache, codepoint));
+        newCache.EndFrame();
+    }
+    const double newMs = ElapsedMs(start);
+
+    const vke_ds::LRUSlotCache::Stats &stats = newCache.GetStats();
+    std::cout << name << ": " << lookupCnt << " lookups, " << stats.hitCnt << " hits, " << stats.missCnt
+              << " misses, " << stats.evictionCnt << " evictions\n"
+              << "  min_element: " << oldMs << " ms (" << oldMs * 1e6 / lookupCnt << " ns/lookup)\n"
+              << "  lru list   : " << newMs << " ms (" << newMs * 1e6 / lookupCnt << " ns/lookup), speedup "
+              << oldMs / newMs << "x\n";
+    Check(name + " slot sequence matches the min_element cache", oldSlots == newSlots);
+    Check(name + " counters match", stats.hitCnt == oldCache.hitCnt && stats.missCnt == oldCache.missCnt &&
+                                        stats.evictionCnt == oldCache.evictionCnt);
+}
+
+static void ReportUploads(const std::string &name, const Stream &stream)
+{
+    vke_ds::LRUSlotCache cache(SLOT_CNT);
+    vke_common::AtlasDirtySlots dirtySlots(FRAMES_IN_FLIGHT, ATLAS_SIZE / SLOT_SIZE, ATLAS_SIZE / SLOT_SIZE, SLOT_SIZE);
+    std::vector<vke_common::AtlasRegion> regions;
+    uint64_t fullBytes = 0, regionBytes = 0, regionCnt = 0;
+    uint32_t fullUpdateCnt = 0, uploadFrameCnt = 0;
+    for (uint32_t frame = 0; frame < stream.size(); ++frame)
+    {
+        for (uint32_t codepoint : stream[frame])
+        {
+            if (cache.Lookup(codepoint) != vke_ds::LRUSlotCache::INVALID_SLOT)
+                continue;
+            const uint32_t slot = cache.PeekVictim();
+            cache.Assign(slot, codepoint);
+            dirtySlots.MarkSlot(slot);
+            // before, any new glyph made the next frames in flight copy the whole atlas
+            fullUpdateCnt = FRAMES_IN_FLIGHT;
+        }
+        cache.EndFrame();
+
+        if (fullUpdateCnt > 0)
+        {
+            fullBytes += static_cast<uint64_t>(ATLAS_SIZE) * ATLAS_SIZE;
+            --fullUpdateCnt;
+        }
+        const uint32_t frameInFlight = frame % FRAMES_IN_FLIGHT;
+        if (!dirtySlots.IsDirty(frameInFlight))
+            continue;
+        dirtySlots.TakeRegions(frameInFlight, regions);
+        ++uploadFrameCnt;
+        regionCnt += regions.size();
+        for (const vke_common::AtlasRegion &region : regions)
+            regionBytes += static_cast<uint64_t>(region.width) * region.height;
+    }
+
+    std::cout << name << " uploads over " << stream.size() << " frames:\n"
+              << "  whole atlas  : " << fullBytes / (1024.0 * 1024.0) << " MiB\n"
+              << "  dirty regions: " << regionBytes / (1024.0 * 1024.0) << " MiB in " << uploadFrameCnt
+              << " uploads, " << static_cast<double>(regionCnt) / std::max(uploadFrameCnt, 1u) << " regions each, "
+              << static_cast<double>(fullBytes) / std::max<uint64_t>(regionBytes, 1) << "x fewer bytes\n";
+}
+
+// random churn on a small cache against a map, exercising probe runs and backward shift deletion
+static void TestAgainstMap()
+{
+    constexpr uint32_t capacity = 37;
+    std::mt19937 rng(7);
+    vke_ds::LRUSlotCache cache(capacity);
+    std::unordered_map<uint32_t, uint32_t> reference;
+    std::vector<uint32_t> keys(capacity, vke_ds::LRUSlotCache::INVALID_KEY);
+    bool same = true;
+    for (uint32_t i = 0; i < 200000 && same; ++i)
+    {
+        // clustered keys collide in the table far more often than codepoints do
+        const uint32_t key = (rng() % 64) * 1024 + rng() % 3;
+        auto it = reference.find(key);
+        const uint32_t slot = GetSlot(cache, key);
+        if (it != reference.end())
+            same = slot == it->second;
+        else
+        {
+            if (keys[slot] != vke_ds::LRUSlotCache::INVALID_KEY)
+                reference.erase(keys[slot]);
+            keys[slot] = key;
+            reference[key] = slot;
+        }
+        if (i % 5 == 0)
+            cache.EndFrame();
+        for (uint32_t s = 0; s < capacity && same && i % 1000 == 0; ++s)
+            same = keys[s] == vke_ds::LRUSlotCache::INVALID_KEY ? cache.GetKey(s) == keys[s]
+                                                                  : cache.Find(keys[s]) == s;
+    }
+    Check("lookups agree with a reference map under churn", same && cache.GetUsedCnt() == reference.size());
+}
+
+static void TestPinning()
+{
+    vke_ds::LRUSlotCache cache(4);
+    for (uint32_t key = 0; key < 4; ++key)
+        GetSlot(cache, key);
+    Check("a full frame pins every slot", GetSlot(cache, 4) == vke_ds::LRUSlotCache::INVALID_SLOT);
+
+    cache.EndFrame();
+    GetSlot(cache, 0);
+    GetSlot(cache, 1);
+    const uint32_t slot = GetSlot(cache, 5);
+    Check("the next frame evicts the least recently used unpinned glyph", slot == 2 && cache.Find(2) == vke_ds::LRUSlotCache::INVALID_SLOT);
+    GetSlot(cache, 3);
+    Check("once every slot is used again nothing can be evicted", GetSlot(cache, 6) == vke_ds::LRUSlotCache::INVALID_SLOT);
+    Check("a refused glyph counts as a miss only", cache.GetStats().evictionCnt == 1 && cache.GetStats().missCnt == 7);
+}
+
+int main()
+{
+    TestAgainstMap();
+    TestPinning();
+    const Stream chat = ChatStream(1);
+    const Stream document = DocumentStream(2);
+    Replay("chat log", chat);
+    Replay("document scroll", document);
+    ReportUploads("chat log", chat);
+    ReportUploads("document scroll", document);
+    return CheckResult();
+}
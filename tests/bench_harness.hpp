@@ -0,0 +1,340 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Scenario runner for bench_suite. Every scenario builds its scene in an untimed Setup, runs some
+// warmup iterations and then the timed ones. Each iteration returns a value derived from its output,
+// folded into a checksum, so a baseline also catches runs that stopped computing the same thing.
+// Results are written as JSON and can be compared against an earlier run's JSON.
+
+namespace vke_bench
+{
+    static constexpr uint32_t RESULT_VERSION = 1;
+
+    struct BenchOptions
+    {
+        uint64_t seed = 0x5eed;
+        // multiplies every scenario's element counts
+        float scale = 1.0f;
+        uint32_t warmupCnt = 3;
+        uint32_t iterationCnt = 20;
+        // only scenarios whose name contains it
+        std::string filter;
+        std::string outPath;
+        std::string baselinePath;
+        // median slowdown against the baseline that counts as a regression
+        double threshold = 0.10;
+        bool list = false;
+
+        bool ParseArgs(int argc, char **argv)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                const std::string arg(argv[i]);
+                if (arg == "--list")
+                {
+                    list = true;
+                    continue;
+                }
+                if (i + 1 >= argc)
+                    return false;
+                const std::string value(argv[++i]);
+                if (arg == "--seed")
+                    seed = std::stoull(value);
+                else if (arg == "--scale")
+                    scale = std::stof(value);
+                else if (arg == "--warmup")
+                    warmupCnt = static_cast<uint32_t>(std::stoul(value));
+                else if (arg == "--iterations")
+                    iterationCnt = std::max(1u, static_cast<uint32_t>(std::stoul(value)));
+                else if (arg == "--filter")
+                    filter = value;
+                else if (arg == "--out")
+                    outPath = value;
+                else if (arg == "--baseline")
+                    baselinePath = value;
+                else if (arg == "--threshold")
+                    threshold = std::stod(value);
+                else
+                    return false;
+            }
+            return scale > 0.0f;
+        }
+
+        uint32_t Scaled(uint32_t count) const
+        {
+            return std::max(1u, static_cast<uint32_t>(std::lround(count * static_cast<double>(scale))));
+        }
+    };
+
+    // splitmix64, the standard library's distributions are not required to give the same values
+    // everywhere, and scenes have to be identical on every machine a baseline is compared on
+    class BenchRandom
+    {
+    public:
+        explicit BenchRandom(uint64_t seed) : state(seed) {}
+
+        uint64_t Next()
+        {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        float Uniform(float lo, float hi)
+        {
+            return lo + (hi - lo) * static_cast<float>(Next() >> 40) * (1.0f / 16777216.0f);
+        }
+
+        uint32_t Below(uint32_t bound)
+        {
+            return static_cast<uint32_t>((Next() >> 32) * bound >> 32);
+        }
+
+    private:
+        uint64_t state;
+    };
+
+    inline uint64_t MixChecksum(uint64_t checksum, uint64_t value)
+    {
+        return (checksum ^ value) * 0x100000001b3ull;
+    }
+
+    // std::hash differs between standard libraries
+    inline uint64_t HashName(const std::string &name)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : name)
+            hash = MixChecksum(hash, static_cast<uint8_t>(c));
+        return hash;
+    }
+
+    // floats are rounded before hashing so the checksum does not depend on the last bits
+    inline uint64_t QuantizeForChecksum(double value, double step = 1e-3)
+    {
+        return static_cast<uint64_t>(static_cast<int64_t>(std::llround(value / step)));
+    }
+
+    class BenchScenario
+    {
+    public:
+        virtual ~BenchScenario() = default;
+
+        virtual std::string GetName() const = 0;
+        // element counts and settings, a baseline is only compared when they are equal
+        virtual nlohmann::json GetParams() const = 0;
+        // untimed; false skips the scenario, e.g. when an asset it needs is missing
+        virtual bool Setup(BenchRandom &random) = 0;
+        // one timed iteration
+        virtual uint64_t Run() = 0;
+        virtual void Teardown() {}
+    };
+
+    struct BenchStats
+    {
+        double minMs = 0.0;
+        double maxMs = 0.0;
+        double meanMs = 0.0;
+        double medianMs = 0.0;
+        double p90Ms = 0.0;
+        double stddevMs = 0.0;
+
+        static BenchStats FromSamples(std::vector<double> samples)
+        {
+            BenchStats stats;
+            if (samples.empty())
+                return stats;
+            std::sort(samples.begin(), samples.end());
+            const size_t cnt = samples.size();
+            auto percentile = [&samples, cnt](double p)
+            {
+                const double rank = p * static_cast<double>(cnt - 1);
+                const size_t lo = static_cast<size_t>(rank);
+                const size_t hi = std::min(lo + 1, cnt - 1);
+                return samples[lo] + (samples[hi] - samples[lo]) * (rank - static_cast<double>(lo));
+            };
+            stats.minMs = samples.front();
+            stats.maxMs = samples.back();
+            for (double sample : samples)
+                stats.meanMs += sample;
+            stats.meanMs /= static_cast<double>(cnt);
+            for (double sample : samples)
+                stats.stddevMs += (sample - stats.meanMs) * (sample - stats.meanMs);
+            stats.stddevMs = cnt > 1 ? std::sqrt(stats.stddevMs / static_cast<double>(cnt - 1)) : 0.0;
+            stats.medianMs = percentile(0.5);
+            stats.p90Ms = percentile(0.9);
+            return stats;
+        }
+    };
+
+    struct BenchResult
+    {
+        std::string name;
+        nlohmann::json params;
+        bool skipped = false;
+        uint64_t checksum = 0;
+        std::vector<double> samplesMs;
+        BenchStats stats;
+
+        nlohmann::json ToJSON() const
+        {
+            char checksumHex[17];
+            std::snprintf(checksumHex, sizeof(checksumHex), "%016llx", static_cast<unsigned long long>(checksum));
+            return {{"name", name},
+                    {"params", params},
+                    {"skipped", skipped},
+                    {"checksum", checksumHex},
+                    {"samplesMs", samplesMs},
+                    {"minMs", stats.minMs},
+                    {"maxMs", stats.maxMs},
+                    {"meanMs", stats.meanMs},
+                    {"medianMs", stats.medianMs},
+                    {"p90Ms", stats.p90Ms},
+                    {"stddevMs", stats.stddevMs}};
+        }
+    };
+
+    class BenchRunner
+    {
+    public:
+        explicit BenchRunner(const BenchOptions &options) : options(options) {}
+
+        void Add(std::unique_ptr<BenchScenario> scenario)
+        {
+            scenarios.push_back(std::move(scenario));
+        }
+
+        void RunAll()
+        {
+            using Clock = std::chrono::steady_clock;
+            for (std::unique_ptr<BenchScenario> &scenario : scenarios)
+            {
+                BenchResult result;
+                result.name = scenario->GetName();
+                result.params = scenario->GetParams();
+                if (options.list)
+                {
+                    std::cout << result.name << " " << result.params.dump() << "\n";
+                    continue;
+                }
+                if (!options.filter.empty() && result.name.find(options.filter) == std::string::npos)
+                    continue;
+
+                // seeded per scenario, so filtering or adding scenarios does not change the others' scenes
+                BenchRandom random(options.seed ^ HashName(result.name));
+                if (!scenario->Setup(random))
+                {
+                    std::cout << result.name << ": skipped\n";
+                    result.skipped = true;
+                    results.push_back(std::move(result));
+                    continue;
+                }
+                for (uint32_t i = 0; i < options.warmupCnt; ++i)
+                    result.checksum = MixChecksum(result.checksum, scenario->Run());
+                result.samplesMs.reserve(options.iterationCnt);
+                for (uint32_t i = 0; i < options.iterationCnt; ++i)
+                {
+                    const auto start = Clock::now();
+                    const uint64_t value = scenario->Run();
+                    result.samplesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                    result.checksum = MixChecksum(result.checksum, value);
+                }
+                scenario->Teardown();
+
+                result.stats = BenchStats::FromSamples(result.samplesMs);
+                std::cout << result.name << ": median " << result.stats.medianMs << " ms, min " << result.stats.minMs
+                          << " ms, p90 " << result.stats.p90Ms << " ms, stddev " << result.stats.stddevMs << " ms\n";
+                results.push_back(std::move(result));
+            }
+        }
+
+        nlohmann::json ToJSON() const
+        {
+            nlohmann::json jsonResults = nlohmann::json::array();
+            for (const BenchResult &result : results)
+                jsonResults.push_back(result.ToJSON());
+            return {{"version", RESULT_VERSION},
+                    {"seed", options.seed},
+                    {"scale", options.scale},
+                    {"warmupCnt", options.warmupCnt},
+                    {"iterationCnt", options.iterationCnt},
+                    {"results", std::move(jsonResults)}};
+        }
+
+        bool WriteJSON(const std::string &path) const
+        {
+            std::ofstream ofs(path);
+            if (!ofs)
+                return false;
+            ofs << ToJSON().dump(4) << "\n";
+            return static_cast<bool>(ofs);
+        }
+
+        // prints one line per scenario and returns how many regressed or changed their output
+        uint32_t CompareBaseline(const nlohmann::json &baseline) const
+        {
+            if (baseline.value("version", 0u) != RESULT_VERSION)
+            {
+                std::cout << "baseline has another result version, not compared\n";
+                return 0;
+            }
+            // checksums fold every iteration, so they are only comparable for the same run lengths
+            const bool sameRun = baseline.value("seed", uint64_t(0)) == options.seed &&
+                                 baseline.value("warmupCnt", 0u) == options.warmupCnt &&
+                                 baseline.value("iterationCnt", 0u) == options.iterationCnt;
+            const nlohmann::json baseResults = baseline.value("results", nlohmann::json::array());
+            uint32_t failureCnt = 0;
+            for (const BenchResult &result : results)
+            {
+                if (result.skipped)
+                    continue;
+                const nlohmann::json *base = nullptr;
+                for (const nlohmann::json &entry : baseResults)
+                    if (entry.value("name", std::string()) == result.name)
+                        base = &entry;
+                if (base == nullptr || base->value("skipped", false))
+                {
+                    std::cout << result.name << ": not in baseline\n";
+                    continue;
+                }
+                if (base->value("params", nlohmann::json()) != result.params)
+                {
+                    std::cout << result.name << ": baseline ran other params, not compared\n";
+                    continue;
+                }
+
+                const double baseMedianMs = base->value("medianMs", 0.0);
+                const double ratio = baseMedianMs > 0.0 ? result.stats.medianMs / baseMedianMs : 1.0;
+                const bool regressed = ratio > 1.0 + options.threshold;
+                const bool changed = sameRun && base->value("checksum", std::string()) != result.ToJSON()["checksum"];
+                std::cout << result.name << ": " << baseMedianMs << " -> " << result.stats.medianMs << " ms ("
+                          << (ratio - 1.0) * 100.0 << "%)"
+                          << (regressed ? " REGRESSED" : (ratio < 1.0 - options.threshold ? " improved" : ""))
+                          << (changed ? " OUTPUT CHANGED" : "") << "\n";
+                failureCnt += regressed || changed ? 1 : 0;
+            }
+            return failureCnt;
+        }
+
+        const std::vector<BenchResult> &GetResults() const { return results; }
+
+    private:
+        BenchOptions options;
+        std::vector<std::unique_ptr<BenchScenario>> scenarios;
+        std::vector<BenchResult> results;
+    };
+}
+
+#endif
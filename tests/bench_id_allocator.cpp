@@ -0,0 +1,227 @@
+#include "test_check.hpp"
+#include <ds/handle_map.hpp>
+#include <ds/id_allocator.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// The generational allocator against NaiveIDAllocator and DynamicIDAllocator under alloc and free
+// churn, and the registries built on them: HandleMap against the unordered_map Renderer kept its
+// cameras in, and SparseHandleMap against the unordered_map LightManager mapped entities to lights
+// with. Also batch allocation from several threads against taking the lock for every handle.
+
+static constexpr uint32_t LIVE_CNT = 4096;
+static constexpr uint32_t CHURN_CNT = 2000000;
+static constexpr uint32_t LOOKUP_CNT = 4000000;
+static constexpr uint32_t ITERATE_CNT = 2000;
+static constexpr uint32_t THREAD_CNT = 4;
+static constexpr uint32_t THREAD_HANDLE_CNT = 500000;
+static constexpr uint32_t BATCH_SIZE = 64;
+
+using Clock = std::chrono::steady_clock;
+using vke_ds::Handle;
+
+static double NsPer(Clock::time_point st, uint64_t cnt)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - st).count() / cnt;
+}
+
+static void Report(const std::string &what, double ns)
+{
+    std::cout << what << ": " << ns << " ns\n";
+}
+
+// which live element each churn step frees, the same sequence for every allocator
+static std::vector<uint32_t> ChurnPicks()
+{
+    std::mt19937 rng(17);
+    std::vector<uint32_t> picks(CHURN_CNT);
+    for (uint32_t &pick : picks)
+        pick = rng() % LIVE_CNT;
+    return picks;
+}
+
+static void BenchChurn()
+{
+    const std::vector<uint32_t> picks = ChurnPicks();
+    uint64_t checksum[3] = {};
+
+    {
+        vke_ds::NaiveIDAllocator<vke_ds::id64_t> allocator;
+        std::vector<vke_ds::id64_t> live(LIVE_CNT);
+        for (vke_ds::id64_t &id : live)
+            id = allocator.Alloc();
+        auto st = Clock::now();
+        for (uint32_t pick : picks)
+        {
+            live[pick] = allocator.Alloc();
+            checksum[0] += live[pick] & 1;
+        }
+        Report("naive alloc (never reuses, ids grow to " + std::to_string(allocator.id) + ")", NsPer(st, CHURN_CNT));
+    }
+    {
+        vke_ds::DynamicIDAllocator<uint32_t> allocator;
+        std::vector<uint32_t> live(LIVE_CNT);
+        for (uint32_t &id : live)
+            id = allocator.Alloc();
+        auto st = Clock::now();
+        for (uint32_t pick : picks)
+        {
+            allocator.Free(live[pick]);
+            live[pick] = allocator.Alloc();
+            checksum[1] += live[pick] & 1;
+        }
+        Report("dynamic free + alloc (no stale detection)", NsPer(st, CHURN_CNT));
+    }
+    {
+        vke_ds::GenerationalIDAllocator allocator;
+        std::vector<Handle> live(LIVE_CNT);
+        for (Handle &handle : live)
+            handle = allocator.Alloc();
+        auto st = Clock::now();
+        for (uint32_t pick : picks)
+        {
+            allocator.Free(live[pick]);
+            live[pick] = allocator.Alloc();
+            checksum[2] += live[pick].index & 1;
+        }
+        Report("generational free + alloc", NsPer(st, CHURN_CNT));
+        Check("generational slots stay at the live count", allocator.GetSlotCnt() == LIVE_CNT);
+    }
+    std::cout << "checksums " << checksum[0] << " " << checksum[1] << " " << checksum[2] << "\n";
+}
+
+static void BenchRegistry()
+{
+    std::mt19937 rng(23);
+    vke_ds::HandleMap<uint64_t> handleMap;
+    std::unordered_map<vke_ds::id64_t, uint64_t> hashMap;
+    vke_ds::NaiveIDAllocator<vke_ds::id64_t> naive;
+    std::vector<Handle> handles;
+    std::vector<vke_ds::id64_t> ids;
+    for (uint32_t i = 0; i < LIVE_CNT; ++i)
+    {
+        handles.push_back(handleMap.Insert(i));
+        ids.push_back(naive.Alloc());
+        hashMap[ids.back()] = i;
+    }
+    // some churn first, so neither side is looked up in insertion order
+    for (uint32_t i = 0; i < LIVE_CNT; ++i)
+    {
+        const uint32_t pick = rng() % LIVE_CNT;
+        const uint64_t value = *handleMap.Find(handles[pick]);
+        handleMap.Erase(handles[pick]);
+        handles[pick] = handleMap.Insert(value);
+        hashMap.erase(ids[pick]);
+        ids[pick] = naive.Alloc();
+        hashMap[ids[pick]] = value;
+    }
+
+    std::vector<uint32_t> picks(LOOKUP_CNT);
+    for (uint32_t &pick : picks)
+        pick = rng() % LIVE_CNT;
+
+    uint64_t hashSum = 0, handleSum = 0;
+    auto st = Clock::now();
+    for (uint32_t pick : picks)
+        hashSum += hashMap.find(ids[pick])->second;
+    Report("unordered_map lookup", NsPer(st, LOOKUP_CNT));
+    st = Clock::now();
+    for (uint32_t pick : picks)
+        handleSum += *handleMap.Find(handles[pick]);
+    Report("HandleMap lookup", NsPer(st, LOOKUP_CNT));
+    Check("both registries find the same values", hashSum == handleSum);
+
+    hashSum = handleSum = 0;
+    st = Clock::now();
+    for (uint32_t i = 0; i < ITERATE_CNT; ++i)
+        for (auto &kv : hashMap)
+            hashSum += kv.second;
+    Report("unordered_map iterate per element", NsPer(st, uint64_t(ITERATE_CNT) * LIVE_CNT));
+    st = Clock::now();
+    for (uint32_t i = 0; i < ITERATE_CNT; ++i)
+        for (uint64_t value : handleMap)
+            handleSum += value;
+    Report("HandleMap iterate per element", NsPer(st, uint64_t(ITERATE_CNT) * LIVE_CNT));
+    Check("both registries iterate the same values", hashSum == handleSum);
+}
+
+// entity keys the way entt hands them out: dense indices, versions bumped on reuse
+static void BenchEntityLookup()
+{
+    std::mt19937 rng(29);
+    vke_ds::GenerationalIDAllocator entities;
+    std::vector<Handle> keys;
+    for (uint32_t i = 0; i < LIVE_CNT * 4; ++i)
+        keys.push_back(entities.Alloc());
+    // one entity in four has a light
+    vke_ds::SparseHandleMap<uint32_t> sparseMap;
+    std::unordered_map<uint32_t, uint32_t> hashMap;
+    std::vector<Handle> lit;
+    for (uint32_t i = 0; i < keys.size(); i += 4)
+    {
+        const uint32_t light = static_cast<uint32_t>(lit.size());
+        sparseMap.Set(keys[i], light);
+        hashMap[static_cast<uint32_t>(keys[i].ToID())] = light;
+        lit.push_back(keys[i]);
+    }
+
+    std::vector<uint32_t> picks(LOOKUP_CNT);
+    for (uint32_t &pick : picks)
+        pick = rng() % lit.size();
+
+    uint64_t hashSum = 0, sparseSum = 0;
+    auto st = Clock::now();
+    for (uint32_t pick : picks)
+        hashSum += hashMap.find(static_cast<uint32_t>(lit[pick].ToID()))->second;
+    Report("entity to light, unordered_map", NsPer(st, LOOKUP_CNT));
+    st = Clock::now();
+    for (uint32_t pick : picks)
+        sparseSum += *sparseMap.Find(lit[pick]);
+    Report("entity to light, SparseHandleMap", NsPer(st, LOOKUP_CNT));
+    Check("both entity maps find the same lights", hashSum == sparseSum);
+}
+
+static void BenchSharedBatches()
+{
+    auto run = [](uint32_t batchSize)
+    {
+        vke_ds::SharedGenerationalIDAllocator shared;
+        std::vector<std::thread> threads;
+        auto st = Clock::now();
+        for (uint32_t t = 0; t < THREAD_CNT; ++t)
+            threads.emplace_back([&shared, batchSize]()
+                                 {
+                                     std::vector<Handle> batch;
+                                     for (uint32_t done = 0; done < THREAD_HANDLE_CNT; done += batchSize)
+                                     {
+                                         batch.clear();
+                                         if (batchSize == 1)
+                                             batch.push_back(shared.Alloc());
+                                         else
+                                             shared.AllocBatch(batchSize, batch);
+                                         shared.FreeBatch(batch.data(), static_cast<uint32_t>(batch.size()));
+                                     } });
+        for (std::thread &thread : threads)
+            thread.join();
+        return NsPer(st, uint64_t(THREAD_CNT) * THREAD_HANDLE_CNT);
+    };
+
+    Report(std::to_string(THREAD_CNT) + " threads, lock per handle", run(1));
+    Report(std::to_string(THREAD_CNT) + " threads, batches of " + std::to_string(BATCH_SIZE), run(BATCH_SIZE));
+}
+
+int main()
+{
+    BenchChurn();
+    BenchRegistry();
+    BenchEntityLookup();
+    BenchSharedBatches();
+    return CheckResult();
+}
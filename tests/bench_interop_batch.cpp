@@ -0,0 +1,78 @@
+#include <interop/native.hpp>
+#include <physics/physics.hpp>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// Native-side comparison of the scalar and batch interop paths (no CLR involved).
+// Both paths are called through the same NativeFunctions table that is handed to C#.
+
+static constexpr uint32_t BODY_CNT = 10000;
+static constexpr uint32_t ITERATION_CNT = 50;
+
+template <typename Fn>
+static double MeasureNsPerBody(Fn &&fn)
+{
+    fn();
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ITERATION_CNT; ++i)
+        fn();
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (static_cast<double>(ITERATION_CNT) * BODY_CNT);
+}
+
+static void Report(const char *name, double scalarNs, double batchNs)
+{
+    std::cout << name << ": scalar " << scalarNs << " ns/body, batch " << batchNs << " ns/body, speedup "
+              << scalarNs / batchNs << "x\n";
+}
+
+int main()
+{
+    vke_physics::PhysicsManager::Init();
+    const vke_interop::NativeFunctions &fns = vke_interop::GetNativeFunctions();
+
+    JPH::RefConst<JPH::Shape> sphere = new JPH::SphereShape(0.5f);
+    std::vector<uint32_t> bodyIDs(BODY_CNT);
+    for (uint32_t i = 0; i < BODY_CNT; ++i)
+    {
+        JPH::BodyCreationSettings settings(sphere, JPH::RVec3(i % 100 * 2.0f, 10.0f, i / 100 * 2.0f), JPH::Quat::sIdentity(),
+                                           JPH::EMotionType::Dynamic, vke_physics::DefaultObjectLayers::MOVING);
+        bodyIDs[i] = vke_physics::PhysicsManager::CreateAndAddBody(settings, JPH::EActivation::Activate).GetIndexAndSequenceNumber();
+    }
+
+    std::vector<vke_interop::Vector3<float>> velocities(BODY_CNT, vke_interop::Vector3<float>{1.0f, 0.0f, 0.0f});
+    std::vector<vke_interop::Vector3<float>> positions(BODY_CNT);
+    std::vector<vke_interop::Quaternion<float>> rotations(BODY_CNT);
+
+    Report("GetLinearVelocity",
+           MeasureNsPerBody([&]()
+                            { for (uint32_t i = 0; i < BODY_CNT; ++i) fns.GetBodyLinearVelocity(bodyIDs[i], &velocities[i]); }),
+           MeasureNsPerBody([&]()
+                            { fns.GetBodyLinearVelocities(bodyIDs.data(), BODY_CNT, velocities.data()); }));
+
+    Report("SetLinearVelocity",
+           MeasureNsPerBody([&]()
+                            { for (uint32_t i = 0; i < BODY_CNT; ++i) fns.SetBodyLinearVelocity(bodyIDs[i], &velocities[i]); }),
+           MeasureNsPerBody([&]()
+                            { fns.SetBodyLinearVelocities(bodyIDs.data(), BODY_CNT, velocities.data()); }));
+
+    Report("GetAngularVelocity",
+           MeasureNsPerBody([&]()
+                            { for (uint32_t i = 0; i < BODY_CNT; ++i) fns.GetBodyAngularVelocity(bodyIDs[i], &velocities[i]); }),
+           MeasureNsPerBody([&]()
+                            { fns.GetBodyAngularVelocities(bodyIDs.data(), BODY_CNT, velocities.data()); }));
+
+    Report("GetCenterOfMassPosition/PositionsAndRotations",
+           MeasureNsPerBody([&]()
+                            { for (uint32_t i = 0; i < BODY_CNT; ++i) fns.GetBodyCenterOfMassPosition(bodyIDs[i], &positions[i]); }),
+           MeasureNsPerBody([&]()
+                            { fns.GetBodyPositionsAndRotations(bodyIDs.data(), BODY_CNT, positions.data(), rotations.data()); }));
+
+    for (uint32_t bodyID : bodyIDs)
+        vke_physics::PhysicsManager::RemoveAndDestroyBody(JPH::BodyID(bodyID));
+    sphere = nullptr;
+    vke_physics::PhysicsManager::Dispose();
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "test_check.hpp"
+#include <job_system.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Scaling of the job system with the worker count, on three workloads: an even data parallel loop,
+// a loop whose elements cost wildly different amounts, and a flood of tiny jobs spawned from jobs. Results are
+// checked against a serial run. Speedups need as many cores as workers.
+
+static constexpr uint32_t ELEMENT_CNT = 1 << 20;
+static constexpr uint32_t GRAIN = 1024;
+static constexpr uint32_t REPEAT_CNT = 5;
+static constexpr uint32_t TINY_JOB_DEPTH = 8;
+static constexpr uint32_t TINY_JOB_FANOUT = 5;
+
+using Clock = std::chrono::steady_clock;
+using vke_common::JobCounter;
+using vke_common::JobSystem;
+
+static float Kernel(float x, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; ++i)
+        x = std::sin(x) * 0.5f + std::cos(x * 0.25f);
+    return x;
+}
+
+// an element's cost, every 64th element is 64 times as expensive
+static uint32_t Iterations(uint32_t element, bool uneven)
+{
+    return uneven && element % 64 == 0 ? 256 : 4;
+}
+
+template <typename Fn>
+static double BestMs(Fn &&fn)
+{
+    double best = 1e30;
+    for (uint32_t repeat = 0; repeat < REPEAT_CNT; ++repeat)
+    {
+        const auto start = Clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+int main()
+{
+    std::vector<float> input(ELEMENT_CNT), expectedEven(ELEMENT_CNT), expectedUneven(ELEMENT_CNT), output(ELEMENT_CNT);
+    for (uint32_t i = 0; i < ELEMENT_CNT; ++i)
+        input[i] = static_cast<float>(i % 1000) * 0.001f;
+    const double serialEvenMs = BestMs([&]()
+                                       { for (uint32_t i = 0; i < ELEMENT_CNT; ++i)
+                                             expectedEven[i] = Kernel(input[i], Iterations(i, false)); });
+    const double serialUnevenMs = BestMs([&]()
+                                         { for (uint32_t i = 0; i < ELEMENT_CNT; ++i)
+                                               expectedUneven[i] = Kernel(input[i], Iterations(i, true)); });
+    std::cout << "serial: even loop " << serialEvenMs << " ms, uneven loop " << serialUnevenMs << " ms\n";
+
+    uint64_t tinyJobCnt = 0;
+    for (uint32_t depth = 1, level = 1; depth <= TINY_JOB_DEPTH; ++depth)
+        tinyJobCnt += level *= TINY_JOB_FANOUT;
+
+    const uint32_t maxThreadCnt = std::max(3u, JobSystem::DefaultThreadCnt());
+    for (uint32_t threadCnt = 0; threadCnt <= maxThreadCnt; ++threadCnt)
+    {
+        JobSystem jobSystem(threadCnt);
+        auto loop = [&](bool uneven)
+        {
+            jobSystem.ParallelFor(ELEMENT_CNT, GRAIN, [&](uint32_t begin, uint32_t end, uint32_t)
+                                  { for (uint32_t i = begin; i < end; ++i)
+                                        output[i] = Kernel(input[i], Iterations(i, uneven)); });
+        };
+
+        const double evenMs = BestMs([&]()
+                                     { loop(false); });
+        const bool evenMatches = output == expectedEven;
+        const double unevenMs = BestMs([&]()
+                                       { loop(true); });
+        const bool unevenMatches = output == expectedUneven;
+
+        // every job spawns the next level, all of it on one counter
+        std::atomic<uint64_t> ranCnt(0);
+        const double tinyMs = BestMs([&]()
+                                     {
+                                         ranCnt.store(0);
+                                         JobCounter counter;
+                                         std::function<void(uint32_t)> spawn = [&](uint32_t depth)
+                                         {
+                                             ranCnt.fetch_add(1, std::memory_order_relaxed);
+                                             if (depth < TINY_JOB_DEPTH)
+                                                 for (uint32_t i = 0; i < TINY_JOB_FANOUT; ++i)
+                                                     jobSystem.Run([&spawn, depth]()
+                                                                   { spawn(depth + 1); },
+                                                                   &counter);
+                                         };
+                                         for (uint32_t i = 0; i < TINY_JOB_FANOUT; ++i)
+                                             jobSystem.Run([&spawn]()
+                                                           { spawn(1); },
+                                                           &counter);
+                                         jobSystem.Wait(counter); });
+
+        const JobSystem::Stats stats = jobSystem.GetStats();
+        std::cout << threadCnt + 1 << " workers:\n"
+                  << "  even loop    job system " << evenMs << " ms (" << serialEvenMs / evenMs << "x)\n"
+                  << "  uneven loop  job system " << unevenMs << " ms (" << serialUnevenMs / unevenMs << "x)\n"
+                  << "  tiny jobs    " << tinyJobCnt << " in " << tinyMs << " ms, " << tinyJobCnt / tinyMs / 1000.0
+                  << " M jobs/s, " << stats.stolenCnt << " of " << stats.executedCnt << " jobs stolen\n";
+        Check(std::to_string(threadCnt + 1) + " workers compute the serial results",
+              evenMatches && unevenMatches && ranCnt.load() == tinyJobCnt);
+    }
+
+    return CheckResult();
+}
@@ -0,0 +1,158 @@
+#include "test_check.hpp"
+#include <logger.hpp>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Per call latency of the queued logger against the synchronous spdlog logger it replaced, both
+// writing to a file: frames of log calls with numeric arguments and with strings, then a flood
+// from several threads that overruns the queue. Also checks that every record arrives, that long
+// messages survive spanning slots, that compiled out calls do not evaluate their arguments and
+// that VKE_LOG_EVERY_MS lets one call through per interval. Latencies include the clock reads.
+
+static constexpr uint32_t FRAME_CNT = 100;
+static constexpr uint32_t CALLS_PER_FRAME = 1000;
+static constexpr uint32_t FLOOD_THREAD_CNT = 4;
+static constexpr uint32_t FLOOD_CALLS_PER_THREAD = 50000;
+static constexpr const char *SYNC_PATH = "bench_logger_sync.log";
+static constexpr const char *ASYNC_PATH = "bench_logger_async.log";
+
+using Clock = std::chrono::steady_clock;
+
+static std::vector<std::string> ReadLines(const char *path)
+{
+    std::ifstream ifs(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(ifs, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+static size_t CountDropReports(const std::vector<std::string> &lines, size_t from)
+{
+    return std::count_if(lines.begin() + from, lines.end(), [](const std::string &line)
+                         { return line.ends_with("log records dropped, the log queue was full"); });
+}
+
+static void Report(const char *name, std::vector<double> &ns)
+{
+    std::sort(ns.begin(), ns.end());
+    auto at = [&ns](double p)
+    { return ns[static_cast<size_t>(p * static_cast<double>(ns.size() - 1))]; };
+    std::cout << name << ": p50 " << at(0.5) << " ns, p99 " << at(0.99) << " ns, p99.9 " << at(0.999)
+              << " ns, max " << ns.back() << " ns\n";
+}
+
+// a frame's worth of calls at a time, with a pause like the rest of a frame in between
+template <typename LogFn>
+static std::vector<double> MeasureFrames(LogFn &&log)
+{
+    std::vector<double> ns;
+    ns.reserve(FRAME_CNT * CALLS_PER_FRAME);
+    for (uint32_t frame = 0; frame < FRAME_CNT; ++frame)
+    {
+        for (uint32_t i = 0; i < CALLS_PER_FRAME; ++i)
+        {
+            const auto start = Clock::now();
+            log(frame, i);
+            ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return ns;
+}
+
+static int EvaluatedArgument(int &evaluatedCnt)
+{
+    return ++evaluatedCnt;
+}
+
+int main()
+{
+    std::remove(SYNC_PATH);
+    std::remove(ASYNC_PATH);
+    const std::string name = "gbuffer pass";
+
+    auto syncLogger = spdlog::basic_logger_mt("sync", SYNC_PATH);
+    std::vector<double> syncNumbers = MeasureFrames([&](uint32_t frame, uint32_t i)
+                                                    { syncLogger->info("frame {} task {} fence {} value {:.3f}", frame, i, (void *)syncLogger.get(), i * 0.5); });
+    std::vector<double> syncStrings = MeasureFrames([&](uint32_t frame, uint32_t i)
+                                                    { syncLogger->info("frame {} task <{}> submitted", frame, name); });
+    syncLogger->flush();
+
+    vke_common::LogConfig config;
+    config.console = false;
+    config.filePath = ASYNC_PATH;
+    vke_common::Logger::Configure(config);
+    std::vector<double> asyncNumbers = MeasureFrames([&](uint32_t frame, uint32_t i)
+                                                     { VKE_LOG_INFO("frame {} task {} fence {} value {:.3f}", frame, i, (void *)syncLogger.get(), i * 0.5) });
+    std::vector<double> asyncStrings = MeasureFrames([&](uint32_t frame, uint32_t i)
+                                                     { VKE_LOG_INFO("frame {} task <{}> submitted", frame, name) });
+    vke_common::Logger::Flush();
+
+    Report("synchronous, numeric arguments", syncNumbers);
+    Report("queued, numeric arguments     ", asyncNumbers);
+    Report("synchronous, string argument  ", syncStrings);
+    Report("queued, string argument       ", asyncStrings);
+
+    // a writer slower than a frame of calls, e.g. under a sanitizer, drops some
+    const std::vector<std::string> syncLines = ReadLines(SYNC_PATH);
+    std::vector<std::string> asyncLines = ReadLines(ASYNC_PATH);
+    const uint64_t frameDropped = vke_common::Logger::GetDroppedCount();
+    const size_t dropReportCnt = CountDropReports(asyncLines, 0);
+    Check("every queued record is written or counted as dropped",
+          asyncLines.size() - dropReportCnt + frameDropped == 2 * FRAME_CNT * CALLS_PER_FRAME &&
+              syncLines.size() == 2 * FRAME_CNT * CALLS_PER_FRAME);
+    if (frameDropped == 0)
+    {
+        // the timestamps differ, what follows the level does not
+        bool sameText = true;
+        for (size_t i = 0; sameText && i < asyncLines.size(); ++i)
+            sameText = asyncLines[i].substr(asyncLines[i].find("] [info] ")) == syncLines[i].substr(syncLines[i].find("] [info] "));
+        Check("queued records read the same as synchronous ones", sameText);
+    }
+    else
+        std::cout << frameDropped << " records dropped while measuring frames, the writer did not keep up\n";
+
+    const size_t base = asyncLines.size();
+    const std::string longText(3000, 'x');
+    VKE_LOG_WARN("long {} end", longText)
+    int evaluatedCnt = 0;
+    VKE_LOG_TRACE("compiled out {}", EvaluatedArgument(evaluatedCnt))
+    for (int i = 0; i < 1000; ++i)
+        VKE_LOG_EVERY_MS(INFO, 60000, "rate limited {}", i)
+    vke_common::Logger::Flush();
+    asyncLines = ReadLines(ASYNC_PATH);
+    Check("a message longer than a slot arrives whole",
+          asyncLines.size() > base && asyncLines[base].ends_with("long " + longText + " end"));
+    Check("calls below VKE_LOG_ACTIVE_LEVEL do not evaluate their arguments", evaluatedCnt == 0);
+    Check("one rate limited call per interval", asyncLines.size() == base + 2 && asyncLines.back().ends_with("rate limited 0"));
+
+    // more than the queue holds, as fast as possible
+    std::vector<std::thread> threads;
+    const uint64_t droppedBefore = vke_common::Logger::GetDroppedCount();
+    const auto floodStart = Clock::now();
+    for (uint32_t t = 0; t < FLOOD_THREAD_CNT; ++t)
+        threads.emplace_back([t]()
+                             { for (uint32_t i = 0; i < FLOOD_CALLS_PER_THREAD; ++i)
+                                   VKE_LOG_INFO("thread {} call {}", t, i) });
+    for (std::thread &thread : threads)
+        thread.join();
+    const double floodNs = std::chrono::duration<double, std::nano>(Clock::now() - floodStart).count();
+    vke_common::Logger::Flush();
+    const uint64_t dropped = vke_common::Logger::GetDroppedCount() - droppedBefore;
+    const std::vector<std::string> floodLines = ReadLines(ASYNC_PATH);
+    std::cout << "flood: " << FLOOD_THREAD_CNT * FLOOD_CALLS_PER_THREAD << " calls from " << FLOOD_THREAD_CNT << " threads, "
+              << floodNs / (FLOOD_THREAD_CNT * FLOOD_CALLS_PER_THREAD) << " ns per call, " << dropped << " dropped\n";
+    Check("flood records are written or counted as dropped",
+          floodLines.size() - asyncLines.size() - CountDropReports(floodLines, asyncLines.size()) + dropped ==
+              FLOOD_THREAD_CNT * FLOOD_CALLS_PER_THREAD);
+
+    return CheckResult();
+}
@@ -0,0 +1,164 @@
+#include <scene_binary.hpp>
+#include <gameobject.hpp>
+#include <component/transform.hpp>
+#include <component/script.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+// Compares loading and saving a 100k object scene as JSON and as a binary scene.
+// Loading creates GameObject/Transform on a standalone registry and decodes every component payload,
+// which is the work Scene does before any component touches the render or physics device.
+
+static constexpr uint32_t OBJECT_CNT = 100000;
+static constexpr const char *JSON_PATH = "bench_scene.json";
+static constexpr const char *BINARY_PATH = "bench_scene.vksb";
+
+using Clock = std::chrono::steady_clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static nlohmann::json MakeScene()
+{
+    nlohmann::json objects = nlohmann::json::array();
+    for (uint32_t i = 0; i < OBJECT_CNT; ++i)
+    {
+        // groups of 10: one root with 9 children
+        const uint32_t id = i + 1;
+        const bool root = i % 10 == 0;
+        nlohmann::json children = nlohmann::json::array();
+        if (root)
+            for (uint32_t c = 1; c < 10 && i + c < OBJECT_CNT; ++c)
+                children.push_back(id + c);
+
+        nlohmann::json components = nlohmann::json::array();
+        if (i % 4 == 0)
+            components.push_back({{"type", "pointLight"}, {"color", {1.0f, 0.9f, 0.8f}}, {"radius", 5.0f}, {"intensity", 2.0f}});
+        components.push_back({{"type", "script"}, {"className", "Rotator"}, {"data", {{"speed", i * 0.01f}, {"axis", {0.0f, 1.0f, 0.0f}}}}});
+
+        objects.push_back({{"id", id},
+                           {"static", false},
+                           {"name", "object" + std::to_string(id)},
+                           {"layer", 0},
+                           {"parent", root ? 0 : id - i % 10},
+                           {"transform", {{"pos", {i % 100 * 2.0f, 0.0f, i / 100 * 2.0f}}, {"scl", {1.0f, 1.0f, 1.0f}}, {"rot", {0.0f, 0.0f, 0.0f, 1.0f}}}},
+                           {"children", std::move(children)},
+                           {"components", std::move(components)}});
+    }
+    return {{"maxid", OBJECT_CNT}, {"layers", {"default", "editor"}}, {"objects", std::move(objects)}};
+}
+
+static void LoadJSON(entt::registry &registry, std::unordered_map<vke_ds::id32_t, entt::entity> &idToEntity, size_t &componentCnt)
+{
+    std::ifstream ifs(JSON_PATH);
+    nlohmann::json json = nlohmann::json::parse(ifs);
+    auto &jsonObjs = json["objects"];
+    for (auto &jsonObj : jsonObjs)
+    {
+        entt::entity entity = registry.create();
+        idToEntity[jsonObj["id"].get<vke_ds::id32_t>()] = entity;
+        registry.emplace<vke_common::GameObject>(entity, jsonObj);
+        registry.emplace<vke_common::Transform>(entity, jsonObj["transform"]);
+    }
+    for (auto &jsonObj : jsonObjs)
+    {
+        vke_common::Transform &transform = registry.get<vke_common::Transform>(idToEntity[jsonObj["id"].get<vke_ds::id32_t>()]);
+        vke_ds::id32_t parentId = jsonObj["parent"].get<vke_ds::id32_t>();
+        transform.parent = parentId ? idToEntity.at(parentId) : entt::null;
+        for (auto &child : jsonObj["children"])
+            transform.children.insert(idToEntity[child.get<vke_ds::id32_t>()]);
+        for (auto &component : jsonObj["components"])
+            if (component["type"] == "script")
+                registry.emplace<vke_component::ScriptState>(idToEntity[jsonObj["id"].get<vke_ds::id32_t>()], component);
+            else
+                ++componentCnt;
+    }
+}
+
+static void LoadBinary(entt::registry &registry, std::unordered_map<vke_ds::id32_t, entt::entity> &idToEntity, size_t &componentCnt)
+{
+    vke_common::SceneBinaryReader reader;
+    if (!reader.Open(std::string(BINARY_PATH)))
+        return;
+
+    const std::span<const vke_common::SceneBinaryObject> objects = reader.GetObjects();
+    std::vector<entt::entity> entities(objects.size());
+    registry.create(entities.begin(), entities.end());
+    registry.storage<vke_common::GameObject>().reserve(objects.size());
+    registry.storage<vke_common::Transform>().reserve(objects.size());
+    idToEntity.reserve(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        const vke_common::SceneBinaryObject &object = objects[i];
+        idToEntity[object.id] = entities[i];
+        registry.emplace<vke_common::GameObject>(entities[i], object.id, object.layer, object.isStatic != 0, std::string(reader.GetString(object.name)));
+        registry.emplace<vke_common::Transform>(entities[i],
+                                                glm::vec3(object.position[0], object.position[1], object.position[2]),
+                                                glm::vec3(object.scale[0], object.scale[1], object.scale[2]),
+                                                glm::normalize(glm::quat(object.rotation[3], object.rotation[0], object.rotation[1], object.rotation[2])));
+    }
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        vke_common::Transform &transform = registry.get<vke_common::Transform>(entities[i]);
+        transform.parent = objects[i].parent ? idToEntity.at(objects[i].parent) : entt::null;
+        for (vke_ds::id32_t child : reader.GetChildren(objects[i]))
+            transform.children.insert(idToEntity[child]);
+    }
+    const size_t lightCnt = reader.GetComponents(vke_common::ComponentType::PointLight).size();
+    for (size_t i = 0; i < lightCnt; ++i)
+    {
+        const nlohmann::json &json = reader.GetComponentJSON(vke_common::ComponentType::PointLight, i);
+        componentCnt += json.contains("radius") ? 1 : 0;
+    }
+    const std::span<const vke_common::SceneBinaryScript> scripts = reader.GetScripts();
+    registry.storage<vke_component::ScriptState>().reserve(scripts.size());
+    for (size_t i = 0; i < scripts.size(); ++i)
+    {
+        const vke_common::SceneBinaryScript &script = scripts[i];
+        vke_component::ScriptState &state = registry.emplace<vke_component::ScriptState>(entities[script.objectIndex], std::string(reader.GetString(script.className)));
+        state.serializedData = reader.GetScriptData(i);
+    }
+}
+
+template <typename Fn>
+static void MeasureLoad(const char *name, Fn &&load)
+{
+    entt::registry registry;
+    std::unordered_map<vke_ds::id32_t, entt::entity> idToEntity;
+    size_t componentCnt = 0;
+    const auto start = Clock::now();
+    load(registry, idToEntity, componentCnt);
+    std::cout << name << " load: " << ElapsedMs(start) << " ms (" << registry.storage<vke_common::Transform>().size()
+              << " objects, " << componentCnt << " lights, " << registry.storage<vke_component::ScriptState>().size() << " scripts)\n";
+}
+
+int main()
+{
+    const nlohmann::json scene = MakeScene();
+
+    auto start = Clock::now();
+    {
+        std::ofstream ofs(JSON_PATH);
+        ofs << scene.dump(4);
+    }
+    std::cout << "json save: " << ElapsedMs(start) << " ms\n";
+
+    start = Clock::now();
+    vke_common::SceneBinaryWriter writer = vke_common::SceneBinaryWriter::FromJSON(scene);
+    const double buildMs = ElapsedMs(start);
+    start = Clock::now();
+    writer.WriteFile(BINARY_PATH);
+    std::cout << "binary save: " << ElapsedMs(start) << " ms (+" << buildMs << " ms building from JSON)\n";
+
+    MeasureLoad("json", LoadJSON);
+    MeasureLoad("binary", LoadBinary);
+
+    vke_common::SceneBinaryReader reader;
+    const bool lossless = reader.Open(std::string(BINARY_PATH)) && reader.ToJSON() == scene;
+    std::cout << "round trip " << (lossless ? "lossless" : "MISMATCH") << "\n";
+    return lossless ? 0 : 1;
+}
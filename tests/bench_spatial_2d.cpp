@@ -0,0 +1,340 @@
+#include "test_check.hpp"
+#include <spatial_2d.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compares Spatial2DLayerManager against the linear scans it used before the spatial index: first
+// randomized create / reinsert / remove / query sequences that must give identical layer
+// assignments, layer order and query results, then timings for 50k rectangles.
+
+static constexpr uint32_t BENCH_UNIT_CNT = 50000;
+static constexpr uint32_t BENCH_QUERY_CNT = 10000;
+static constexpr float BENCH_EXTENT = 8192.0f;
+
+using Clock = std::chrono::steady_clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// the previous Spatial2DLayer / Spatial2DLayerManager, every test a scan over all units
+class LinearLayerManager
+{
+public:
+    vke_ds::id32_t CreateUnit(const vke_common::AABB2D &bounds, float zIndex)
+    {
+        const vke_ds::id32_t id = unitAllocator.Alloc();
+        auto [it, inserted] = units.emplace(id, vke_common::Spatial2DUnit{id, bounds, zIndex, vke_common::Spatial2DUnit::INVALID_LAYER});
+        insertUnit(it->second);
+        return id;
+    }
+
+    void ReinsertUnit(vke_ds::id32_t unitID, const vke_common::AABB2D &bounds, float zIndex)
+    {
+        vke_common::Spatial2DUnit &unit = units.at(unitID);
+        removeFromLayer(unit);
+        unit.bounds = bounds;
+        unit.zIndex = zIndex;
+        insertUnit(unit);
+    }
+
+    void RemoveUnit(vke_ds::id32_t unitID)
+    {
+        auto it = units.find(unitID);
+        removeFromLayer(it->second);
+        units.erase(it);
+    }
+
+    const vke_common::Spatial2DUnit &GetUnit(vke_ds::id32_t unitID) const { return units.at(unitID); }
+    const std::vector<vke_ds::id32_t> &GetLayerOrder() const { return layerOrder; }
+
+    std::vector<vke_ds::id32_t> Query(const vke_common::AABB2D &bounds) const
+    {
+        std::vector<vke_ds::id32_t> result;
+        for (auto it = layerOrder.rbegin(); it != layerOrder.rend(); ++it)
+            for (const auto &entry : layers.at(*it))
+                if (entry.second->bounds.Overlaps(bounds))
+                    result.push_back(entry.first);
+        return result;
+    }
+
+private:
+    using Layer = std::unordered_map<vke_ds::id32_t, vke_common::Spatial2DUnit *>;
+
+    vke_ds::NaiveIDAllocator<vke_ds::id32_t> unitAllocator;
+    vke_ds::NaiveIDAllocator<vke_ds::id32_t> layerAllocator;
+    std::map<vke_ds::id32_t, vke_common::Spatial2DUnit> units;
+    std::map<vke_ds::id32_t, Layer> layers;
+    std::vector<vke_ds::id32_t> layerOrder;
+
+    static bool canInsert(const Layer &layer, const vke_common::Spatial2DUnit &unit)
+    {
+        for (const auto &entry : layer)
+            if (entry.second->zIndex != unit.zIndex && entry.second->bounds.Overlaps(unit.bounds))
+                return false;
+        return true;
+    }
+
+    void insertUnit(vke_common::Spatial2DUnit &unit)
+    {
+        size_t firstLayer = 0;
+        size_t lastLayer = layerOrder.size();
+        for (size_t i = 0; i < layerOrder.size(); ++i)
+            for (const auto &entry : layers.at(layerOrder[i]))
+            {
+                const vke_common::Spatial2DUnit &other = *entry.second;
+                if (!other.bounds.Overlaps(unit.bounds))
+                    continue;
+                if (other.zIndex < unit.zIndex)
+                    firstLayer = std::max(firstLayer, i + 1);
+                else if (other.zIndex > unit.zIndex)
+                    lastLayer = std::min(lastLayer, i);
+            }
+
+        if (firstLayer > lastLayer)
+            firstLayer = lastLayer;
+
+        for (size_t i = firstLayer; i < layerOrder.size() && i <= lastLayer; ++i)
+        {
+            Layer &layer = layers.at(layerOrder[i]);
+            if (canInsert(layer, unit))
+            {
+                layer[unit.id] = &unit;
+                unit.layer = layerOrder[i];
+                return;
+            }
+        }
+
+        const vke_ds::id32_t layerID = layerAllocator.Alloc();
+        layers[layerID][unit.id] = &unit;
+        unit.layer = layerID;
+        layerOrder.insert(layerOrder.begin() + static_cast<std::ptrdiff_t>(firstLayer), layerID);
+    }
+
+    void removeFromLayer(vke_common::Spatial2DUnit &unit)
+    {
+        auto layerIt = layers.find(unit.layer);
+        layerIt->second.erase(unit.id);
+        if (layerIt->second.empty())
+        {
+            layerOrder.erase(std::remove(layerOrder.begin(), layerOrder.end(), unit.layer), layerOrder.end());
+            layers.erase(layerIt);
+        }
+        unit.layer = vke_common::Spatial2DUnit::INVALID_LAYER;
+    }
+};
+
+struct RectGenerator
+{
+    std::mt19937 rng;
+    float extent;
+    float minSize, maxSize;
+    uint32_t zLevels;
+
+    RectGenerator(uint32_t seed, float extent, float minSize, float maxSize, uint32_t zLevels)
+        : rng(seed), extent(extent), minSize(minSize), maxSize(maxSize), zLevels(zLevels) {}
+
+    vke_common::AABB2D Rect()
+    {
+        std::uniform_real_distribution<float> position(0.0f, extent);
+        std::uniform_real_distribution<float> size(minSize, maxSize);
+        // one rect in a hundred is a panel several times larger
+        const float scale = rng() % 100 == 0 ? 4.0f : 1.0f;
+        const glm::vec2 min(position(rng), position(rng));
+        return vke_common::AABB2D(min, min + glm::vec2(size(rng) * scale, size(rng) * scale));
+    }
+
+    float Z() { return static_cast<float>(rng() % zLevels); }
+};
+
+static std::vector<vke_ds::id32_t> Sorted(std::vector<vke_ds::id32_t> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+static void TestIndexAgainstBruteForce(uint32_t seed)
+{
+    RectGenerator generator(seed, 2048.0f, 0.0f, 300.0f, 1);
+    vke_common::Spatial2DIndex index(32.0f);
+    std::unordered_map<vke_ds::id32_t, vke_common::AABB2D> live;
+    std::mt19937 rng(seed * 7 + 1);
+    bool same = true;
+    for (vke_ds::id32_t id = 1; id <= 3000 && same; ++id)
+    {
+        vke_common::AABB2D bounds = generator.Rect();
+        if (rng() % 10 == 0)
+            bounds.max = bounds.min; // degenerate rects
+        index.Insert(id, bounds);
+        live[id] = bounds;
+        if (rng() % 3 == 0)
+        {
+            auto it = std::next(live.begin(), rng() % live.size());
+            index.Remove(it->first);
+            live.erase(it);
+        }
+
+        const vke_common::AABB2D query = generator.Rect();
+        std::vector<vke_ds::id32_t> expected, actual;
+        for (const auto &entry : live)
+            if (entry.second.Overlaps(query))
+                expected.push_back(entry.first);
+        index.Query(query, actual);
+        same = Sorted(expected) == Sorted(actual) && actual.size() == expected.size();
+
+        const glm::vec2 point = query.min;
+        expected.clear();
+        actual.clear();
+        for (const auto &entry : live)
+            if (entry.second.Contains(point))
+                expected.push_back(entry.first);
+        index.Query(point, actual);
+        same = same && Sorted(expected) == Sorted(actual);
+    }
+    Check("index queries match brute force, seed " + std::to_string(seed), same && index.Size() == live.size());
+}
+
+static void TestManagerAgainstLinear(uint32_t seed, float extent, uint32_t zLevels)
+{
+    RectGenerator generator(seed, extent, 4.0f, 160.0f, zLevels);
+    vke_common::Spatial2DLayerManager *manager = vke_common::Spatial2DLayerManager::Init();
+    LinearLayerManager linear;
+    std::vector<vke_ds::id32_t> live;
+    std::mt19937 rng(seed * 13 + 5);
+
+    bool sameLayers = true, sameQueries = true;
+    for (uint32_t step = 0; step < 4000 && sameLayers; ++step)
+    {
+        const uint32_t op = rng() % 10;
+        if (live.empty() || op < 6)
+        {
+            const vke_common::AABB2D bounds = generator.Rect();
+            const float z = generator.Z();
+            const vke_ds::id32_t id = manager->CreateUnit(bounds, z);
+            sameLayers = linear.CreateUnit(bounds, z) == id;
+            live.push_back(id);
+        }
+        else if (op < 8)
+        {
+            const vke_ds::id32_t id = live[rng() % live.size()];
+            const vke_common::AABB2D bounds = generator.Rect();
+            const float z = generator.Z();
+            manager->ReinsertUnit(id, bounds, z);
+            linear.ReinsertUnit(id, bounds, z);
+        }
+        else
+        {
+            const size_t i = rng() % live.size();
+            manager->RemoveUnit(live[i]);
+            linear.RemoveUnit(live[i]);
+            live[i] = live.back();
+            live.pop_back();
+        }
+
+        sameLayers = sameLayers && manager->GetLayerOrder() == linear.GetLayerOrder();
+        for (size_t i = 0; sameLayers && i < live.size(); i += 1 + live.size() / 64)
+            sameLayers = manager->GetUnit(live[i])->layer == linear.GetUnit(live[i]).layer;
+
+        const vke_common::AABB2D query = generator.Rect();
+        sameQueries = sameQueries && Sorted(manager->Query(query)) == Sorted(linear.Query(query));
+    }
+
+    const std::string scenario = "seed " + std::to_string(seed) + ", " + std::to_string(zLevels) + " z levels";
+    Check("layer assignment and order match the linear scans, " + scenario, sameLayers);
+    Check("queries match the linear scans, " + scenario, sameQueries);
+    vke_common::Spatial2DLayerManager::Dispose();
+}
+
+struct Timings
+{
+    double insertMs;
+    double pointQueryMs;
+    double rectQueryMs;
+    double removeMs;
+    size_t layerCnt;
+    size_t hitCnt;
+};
+
+template <typename Manager, typename Query>
+static Timings Measure(Manager &manager, Query &&query, uint32_t seed)
+{
+    RectGenerator generator(seed, BENCH_EXTENT, 8.0f, 128.0f, 8);
+    std::vector<vke_ds::id32_t> ids;
+    Timings timings{};
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < BENCH_UNIT_CNT; ++i)
+    {
+        const vke_common::AABB2D bounds = generator.Rect();
+        ids.push_back(manager.CreateUnit(bounds, generator.Z()));
+    }
+    timings.insertMs = ElapsedMs(start);
+    timings.layerCnt = manager.GetLayerOrder().size();
+
+    std::uniform_real_distribution<float> position(0.0f, BENCH_EXTENT);
+    start = Clock::now();
+    for (uint32_t i = 0; i < BENCH_QUERY_CNT; ++i)
+    {
+        const glm::vec2 point(position(generator.rng), position(generator.rng));
+        timings.hitCnt += query(manager, vke_common::AABB2D(point, point)).size();
+    }
+    timings.pointQueryMs = ElapsedMs(start);
+
+    start = Clock::now();
+    for (uint32_t i = 0; i < BENCH_QUERY_CNT; ++i)
+    {
+        const glm::vec2 min(position(generator.rng), position(generator.rng));
+        timings.hitCnt += query(manager, vke_common::AABB2D(min, min + glm::vec2(256.0f))).size();
+    }
+    timings.rectQueryMs = ElapsedMs(start);
+
+    start = Clock::now();
+    for (vke_ds::id32_t id : ids)
+        manager.RemoveUnit(id);
+    timings.removeMs = ElapsedMs(start);
+    return timings;
+}
+
+static void Print(const char *name, const Timings &timings)
+{
+    std::cout << name << ": insert " << timings.insertMs << " ms, " << BENCH_QUERY_CNT << " point queries " << timings.pointQueryMs
+              << " ms, " << BENCH_QUERY_CNT << " rect queries " << timings.rectQueryMs << " ms, remove " << timings.removeMs
+              << " ms, " << timings.layerCnt << " layers\n";
+}
+
+static void Benchmark()
+{
+    auto query = [](auto &manager, const vke_common::AABB2D &bounds)
+    { return manager.Query(bounds); };
+
+    LinearLayerManager linear;
+    const Timings linearTimings = Measure(linear, query, 99);
+    Print("linear scans ", linearTimings);
+
+    vke_common::Spatial2DLayerManager *manager = vke_common::Spatial2DLayerManager::Init();
+    const Timings indexTimings = Measure(*manager, query, 99);
+    Print("spatial index", indexTimings);
+    vke_common::Spatial2DLayerManager::Dispose();
+
+    Check("both find the same layers and hits", linearTimings.layerCnt == indexTimings.layerCnt && linearTimings.hitCnt == indexTimings.hitCnt);
+    std::cout << "insert speedup " << linearTimings.insertMs / indexTimings.insertMs << "x, rect query speedup "
+              << linearTimings.rectQueryMs / indexTimings.rectQueryMs << "x\n";
+}
+
+int main()
+{
+    for (uint32_t seed = 1; seed <= 4; ++seed)
+        TestIndexAgainstBruteForce(seed);
+    TestManagerAgainstLinear(1, 1024.0f, 1);
+    TestManagerAgainstLinear(2, 1024.0f, 4);
+    TestManagerAgainstLinear(3, 4096.0f, 16);
+    TestManagerAgainstLinear(4, 400.0f, 64);
+    Benchmark();
+    return CheckResult();
+}
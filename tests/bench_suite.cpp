@@ -0,0 +1,536 @@
+#include "bench_harness.hpp"
+#include "test_check.hpp"
+#include <job_system.hpp>
+#include <physics/physics.hpp>
+#include <component/transform.hpp>
+#include <spatial_2d.hpp>
+#include <text_layout.hpp>
+#include <font_atlas_baker.hpp>
+#include <scene_binary.hpp>
+#include <gameobject.hpp>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <entt/entity/registry.hpp>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <unordered_map>
+
+// Procedurally generated scenes for the systems that run without a window or render device: rigid
+// bodies, transform hierarchies, UI text layout, 2D layering, binary scene loading and the job
+// system. Lights and the frame graph need a Vulkan device and are not covered here. Run from the
+// repository root (the text scenario loads the builtin font):
+//
+//   bench_suite [--filter name] [--scale 1] [--seed n] [--warmup 3] [--iterations 20]
+//               [--out results.json] [--baseline baseline.json] [--threshold 0.1] [--list]
+//
+// With --baseline, medians slower than the threshold and changed checksums fail the run.
+
+using vke_bench::BenchOptions;
+using vke_bench::BenchRandom;
+using vke_bench::BenchScenario;
+using vke_bench::MixChecksum;
+using vke_bench::QuantizeForChecksum;
+
+// dynamic spheres and boxes dropped onto a floor, one physics step per iteration
+class PhysicsBodiesScenario : public BenchScenario
+{
+public:
+    explicit PhysicsBodiesScenario(const BenchOptions &options) : bodyCnt(options.Scaled(4000)) {}
+
+    std::string GetName() const override { return "physics_bodies"; }
+    nlohmann::json GetParams() const override
+    {
+        return {{"bodyCnt", bodyCnt}, {"workerCnt", vke_common::JobSystem::GetInstance()->GetWorkerCnt()}};
+    }
+
+    bool Setup(BenchRandom &random) override
+    {
+        vke_physics::PhysicsConfig config;
+        // its time budget would make the broad phase, and so the contact order, depend on timing
+        config.broadPhaseMaintenance.enabled = false;
+        vke_physics::PhysicsManager::Init(config);
+
+        const float extent = 4.0f * std::sqrt(static_cast<float>(bodyCnt));
+        JPH::BodyCreationSettings floorSettings(new JPH::BoxShape(JPH::Vec3(extent, 1.0f, extent)), JPH::RVec3(0.0, -1.0, 0.0),
+                                                JPH::Quat::sIdentity(), JPH::EMotionType::Static, vke_physics::DefaultObjectLayers::NON_MOVING);
+        bodies.push_back(vke_physics::PhysicsManager::CreateAndAddBody(floorSettings, JPH::EActivation::DontActivate));
+
+        JPH::RefConst<JPH::Shape> sphere = new JPH::SphereShape(0.5f);
+        JPH::RefConst<JPH::Shape> box = new JPH::BoxShape(JPH::Vec3(0.5f, 0.5f, 0.5f));
+        for (uint32_t i = 0; i < bodyCnt; ++i)
+        {
+            const JPH::RVec3 position(random.Uniform(-extent, extent), random.Uniform(1.0f, 40.0f), random.Uniform(-extent, extent));
+            JPH::BodyCreationSettings settings(i % 2 == 0 ? sphere : box, position, JPH::Quat::sIdentity(),
+                                               JPH::EMotionType::Dynamic, vke_physics::DefaultObjectLayers::MOVING);
+            bodies.push_back(vke_physics::PhysicsManager::CreateAndAddBody(settings, JPH::EActivation::Activate));
+        }
+        vke_physics::PhysicsManager::OptimizeBroadPhase();
+        return true;
+    }
+
+    uint64_t Run() override
+    {
+        vke_physics::PhysicsManager::FixedUpdate();
+        JPH::BodyInterface &bodyInterface = vke_physics::PhysicsManager::GetBodyInterface();
+        uint64_t checksum = 0;
+        for (size_t i = 1; i < bodies.size(); i += 97)
+            checksum = MixChecksum(checksum, QuantizeForChecksum(bodyInterface.GetCenterOfMassPosition(bodies[i]).GetY()));
+        return checksum;
+    }
+
+    void Teardown() override
+    {
+        for (JPH::BodyID body : bodies)
+            vke_physics::PhysicsManager::RemoveAndDestroyBody(body);
+        bodies.clear();
+        vke_physics::PhysicsManager::Dispose();
+    }
+
+private:
+    const uint32_t bodyCnt;
+    std::vector<JPH::BodyID> bodies;
+};
+
+// hierarchies of a root, 4 children and 16 grandchildren; every iteration rotates the roots and
+// propagates the model matrices down, as SceneTransformSystem does without the component hooks
+class TransformHierarchyScenario : public BenchScenario
+{
+public:
+    static constexpr uint32_t FANOUT = 4;
+
+    explicit TransformHierarchyScenario(const BenchOptions &options) : hierarchyCnt(options.Scaled(2000)) {}
+
+    std::string GetName() const override { return "transform_hierarchy"; }
+    nlohmann::json GetParams() const override
+    {
+        return {{"hierarchyCnt", hierarchyCnt}, {"nodeCnt", hierarchyCnt * (1 + FANOUT + FANOUT * FANOUT)}};
+    }
+
+    bool Setup(BenchRandom &random) override
+    {
+        auto randomTransform = [&random]()
+        {
+            return std::make_tuple(glm::vec3(random.Uniform(-2.0f, 2.0f), random.Uniform(-2.0f, 2.0f), random.Uniform(-2.0f, 2.0f)),
+                                   glm::vec3(1.0f),
+                                   glm::angleAxis(random.Uniform(0.0f, 6.28f), glm::vec3(0.0f, 1.0f, 0.0f)));
+        };
+        auto addChild = [this, &randomTransform](entt::entity parent)
+        {
+            const auto [position, scale, rotation] = randomTransform();
+            const entt::entity child = registry.create();
+            vke_common::Transform &transform = registry.emplace<vke_common::Transform>(
+                child, registry.get<vke_common::Transform>(parent), position, scale, rotation);
+            transform.parent = parent;
+            registry.get<vke_common::Transform>(parent).children.insert(child);
+            return child;
+        };
+
+        for (uint32_t i = 0; i < hierarchyCnt; ++i)
+        {
+            const auto [position, scale, rotation] = randomTransform();
+            const entt::entity root = registry.create();
+            registry.emplace<vke_common::Transform>(root, position * 100.0f, scale, rotation);
+            roots.push_back(root);
+            for (uint32_t c = 0; c < FANOUT; ++c)
+            {
+                const entt::entity child = addChild(root);
+                for (uint32_t g = 0; g < FANOUT; ++g)
+                    addChild(child);
+            }
+        }
+        return true;
+    }
+
+    uint64_t Run() override
+    {
+        for (entt::entity root : roots)
+        {
+            vke_common::Transform &transform = registry.get<vke_common::Transform>(root);
+            transform.RotateLocal(0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+            propagate(transform);
+        }
+        uint64_t checksum = 0;
+        for (size_t i = 0; i < roots.size(); i += 31)
+        {
+            const vke_common::Transform &root = registry.get<vke_common::Transform>(roots[i]);
+            const glm::vec3 position = registry.get<vke_common::Transform>(*root.children.begin()).GetGlobalPosition();
+            checksum = MixChecksum(checksum, QuantizeForChecksum(position.x + position.z));
+        }
+        return checksum;
+    }
+
+    void Teardown() override
+    {
+        registry.clear();
+        roots.clear();
+    }
+
+private:
+    const uint32_t hierarchyCnt;
+    entt::registry registry;
+    std::vector<entt::entity> roots;
+
+    void propagate(const vke_common::Transform &parent)
+    {
+        for (entt::entity child : parent.children)
+        {
+            vke_common::Transform &transform = registry.get<vke_common::Transform>(child);
+            transform.UpdateWithParent(parent);
+            propagate(transform);
+        }
+    }
+};
+
+// HUD labels through the TextLayoutCache: ticking timers, scores that change every few frames and
+// static captions; one iteration is one frame
+class TextLayoutScenario : public BenchScenario
+{
+public:
+    static constexpr const char *FONT_PATH = "./builtin_assets/fonts/arial.ttf";
+    static constexpr uint32_t PIXEL_SIZE = 32;
+
+    explicit TextLayoutScenario(const BenchOptions &options) : labelCnt(options.Scaled(4000)), frame(0) {}
+
+    ~TextLayoutScenario() override
+    {
+        if (face != nullptr)
+            FT_Done_Face(face);
+        if (library != nullptr)
+            FT_Done_FreeType(library);
+    }
+
+    std::string GetName() const override { return "text_layout"; }
+    nlohmann::json GetParams() const override { return {{"labelCnt", labelCnt}, {"pixelSize", PIXEL_SIZE}}; }
+
+    bool Setup(BenchRandom &random) override
+    {
+        if (FT_Init_FreeType(&library) != FT_Err_Ok || FT_New_Face(library, FONT_PATH, 0, &face) != FT_Err_Ok)
+        {
+            std::cout << "cannot open " << FONT_PATH << "\n";
+            return false;
+        }
+        if (face->charmap == nullptr)
+            FT_Select_Charmap(face, FT_ENCODING_UNICODE);
+        FT_Set_Pixel_Sizes(face, 0, PIXEL_SIZE);
+
+        std::vector<uint32_t> ascii;
+        for (uint32_t codepoint = 32; codepoint < 127; ++codepoint)
+            ascii.push_back(codepoint);
+        std::vector<vke_common::Glyph> bakedGlyphs;
+        std::vector<uint8_t> pixels;
+        vke_common::StaticAtlasBaker(face, FONT_PATH, PIXEL_SIZE).BakeUncached(ascii, nullptr, bakedGlyphs, pixels);
+        for (const vke_common::Glyph &glyph : bakedGlyphs)
+            glyphs[glyph.codepoint] = glyph;
+
+        font.handle = 1;
+        font.pixelSize = PIXEL_SIZE;
+        font.ascender = static_cast<int>(face->size->metrics.ascender >> 6);
+        font.lineHeight = static_cast<int>(face->size->metrics.height >> 6);
+
+        // no frame budget, so every label is laid out in the frame its text changed
+        cache = std::make_unique<vke_common::TextLayoutCache>(vke_common::TextLayoutCache::DEFAULT_CAPACITY,
+                                                              std::numeric_limits<uint32_t>::max());
+        labels.resize(labelCnt);
+        for (Label &label : labels)
+        {
+            label.kind = random.Below(3);
+            label.offset = random.Below(100000);
+        }
+        return true;
+    }
+
+    uint64_t Run() override
+    {
+        auto getGlyph = [this](uint32_t codepoint) -> const vke_common::Glyph *
+        {
+            auto it = glyphs.find(codepoint);
+            return it == glyphs.end() ? nullptr : &it->second;
+        };
+
+        cache->BeginFrame();
+        uint64_t checksum = 0;
+        char buffer[64];
+        for (Label &label : labels)
+        {
+            const uint32_t value = label.offset + frame * 16;
+            if (label.kind == 0)
+                std::snprintf(buffer, sizeof(buffer), "Time %02u:%02u.%03u", value / 60000 % 60, value / 1000 % 60, value % 1000);
+            else if (label.kind == 1)
+                std::snprintf(buffer, sizeof(buffer), "Score: %u", label.offset + frame / 10 * 50);
+            else
+                std::snprintf(buffer, sizeof(buffer), "Objective %u: reach the tower", label.offset % 16);
+            if (label.text != buffer)
+            {
+                label.text = buffer;
+                cache->Layout(font, label.text, 0.0f, label.layout, getGlyph);
+            }
+            checksum += label.layout.glyphs.size();
+        }
+        ++frame;
+        return checksum;
+    }
+
+    void Teardown() override
+    {
+        cache.reset();
+        labels.clear();
+    }
+
+private:
+    struct Label
+    {
+        uint32_t kind = 0;
+        uint32_t offset = 0;
+        std::string text;
+        vke_common::TextLayout layout;
+    };
+
+    const uint32_t labelCnt;
+    uint32_t frame;
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+    std::unordered_map<uint32_t, vke_common::Glyph> glyphs;
+    vke_common::TextLayoutFont font;
+    std::unique_ptr<vke_common::TextLayoutCache> cache;
+    std::vector<Label> labels;
+};
+
+// 2D units in the layer manager; every iteration moves a tenth of them and runs point and box queries
+class Spatial2DScenario : public BenchScenario
+{
+public:
+    static constexpr float EXTENT = 8192.0f;
+
+    explicit Spatial2DScenario(const BenchOptions &options)
+        : unitCnt(options.Scaled(20000)), queryCnt(options.Scaled(2000)), iteration(0) {}
+
+    std::string GetName() const override { return "spatial_2d"; }
+    nlohmann::json GetParams() const override { return {{"unitCnt", unitCnt}, {"queryCnt", queryCnt}}; }
+
+    bool Setup(BenchRandom &random) override
+    {
+        manager = vke_common::Spatial2DLayerManager::Init();
+        for (uint32_t i = 0; i < unitCnt; ++i)
+            units.push_back(manager->CreateUnit(randomRect(random), static_cast<float>(random.Below(8))));
+        // moves and queries are drawn up front, so iterations only time the manager
+        for (uint32_t i = 0; i < unitCnt; ++i)
+            moves.push_back(randomRect(random));
+        for (uint32_t i = 0; i < queryCnt; ++i)
+            queries.push_back(randomRect(random));
+        return true;
+    }
+
+    uint64_t Run() override
+    {
+        const uint32_t moveCnt = std::max(1u, unitCnt / 10);
+        for (uint32_t i = 0; i < moveCnt; ++i)
+        {
+            const uint32_t unit = (iteration * moveCnt + i) % unitCnt;
+            const vke_common::Spatial2DUnit *current = manager->GetUnit(units[unit]);
+            manager->ReinsertUnit(units[unit], moves[(unit + iteration) % unitCnt], current->zIndex);
+        }
+        uint64_t checksum = manager->GetLayerOrder().size();
+        for (const vke_common::AABB2D &query : queries)
+        {
+            checksum = MixChecksum(checksum, manager->Query(query).size());
+            checksum = MixChecksum(checksum, manager->Query(query.min).size());
+        }
+        ++iteration;
+        return checksum;
+    }
+
+    void Teardown() override
+    {
+        vke_common::Spatial2DLayerManager::Dispose();
+        units.clear();
+    }
+
+private:
+    const uint32_t unitCnt;
+    const uint32_t queryCnt;
+    uint32_t iteration;
+    vke_common::Spatial2DLayerManager *manager = nullptr;
+    std::vector<vke_ds::id32_t> units;
+    std::vector<vke_common::AABB2D> moves;
+    std::vector<vke_common::AABB2D> queries;
+
+    static vke_common::AABB2D randomRect(BenchRandom &random)
+    {
+        const glm::vec2 min(random.Uniform(0.0f, EXTENT), random.Uniform(0.0f, EXTENT));
+        return vke_common::AABB2D(min, min + glm::vec2(random.Uniform(8.0f, 256.0f), random.Uniform(8.0f, 256.0f)));
+    }
+};
+
+// decodes an in-memory binary scene into GameObject / Transform and resolves its hierarchy, the part
+// of scene loading that does not touch the render or physics device
+class SceneLoadScenario : public BenchScenario
+{
+public:
+    explicit SceneLoadScenario(const BenchOptions &options) : objectCnt(options.Scaled(50000)) {}
+
+    std::string GetName() const override { return "scene_load"; }
+    nlohmann::json GetParams() const override { return {{"objectCnt", objectCnt}}; }
+
+    bool Setup(BenchRandom &random) override
+    {
+        nlohmann::json objects = nlohmann::json::array();
+        for (uint32_t i = 0; i < objectCnt; ++i)
+        {
+            // groups of 8: a root and its 7 children
+            const uint32_t id = i + 1;
+            const bool root = i % 8 == 0;
+            nlohmann::json children = nlohmann::json::array();
+            if (root)
+                for (uint32_t c = 1; c < 8 && i + c < objectCnt; ++c)
+                    children.push_back(id + c);
+            nlohmann::json components = nlohmann::json::array();
+            if (random.Below(4) == 0)
+                components.push_back({{"type", "pointLight"}, {"color", {1.0f, 0.9f, 0.8f}}, {"radius", random.Uniform(1.0f, 10.0f)}, {"intensity", 2.0f}});
+            objects.push_back({{"id", id},
+                               {"static", false},
+                               {"name", "object" + std::to_string(id)},
+                               {"layer", 0},
+                               {"parent", root ? 0 : id - i % 8},
+                               {"transform", {{"pos", {random.Uniform(-500.0f, 500.0f), 0.0f, random.Uniform(-500.0f, 500.0f)}}, {"scl", {1.0f, 1.0f, 1.0f}}, {"rot", {0.0f, 0.0f, 0.0f, 1.0f}}}},
+                               {"children", std::move(children)},
+                               {"components", std::move(components)}});
+        }
+        const nlohmann::json scene = {{"maxid", objectCnt}, {"layers", nlohmann::json::array({"default"})}, {"objects", std::move(objects)}};
+        bytes = vke_common::SceneBinaryWriter::FromJSON(scene).Finish();
+        return true;
+    }
+
+    uint64_t Run() override
+    {
+        vke_common::SceneBinaryReader reader;
+        if (!reader.Open(std::span<const uint8_t>(bytes)))
+            return 0;
+        entt::registry registry;
+        std::unordered_map<vke_ds::id32_t, entt::entity> idToEntity;
+        const std::span<const vke_common::SceneBinaryObject> objects = reader.GetObjects();
+        std::vector<entt::entity> entities(objects.size());
+        registry.create(entities.begin(), entities.end());
+        idToEntity.reserve(objects.size());
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            const vke_common::SceneBinaryObject &object = objects[i];
+            idToEntity[object.id] = entities[i];
+            registry.emplace<vke_common::GameObject>(entities[i], object.id, object.layer, object.isStatic != 0, std::string(reader.GetString(object.name)));
+            registry.emplace<vke_common::Transform>(entities[i],
+                                                    glm::vec3(object.position[0], object.position[1], object.position[2]),
+                                                    glm::vec3(object.scale[0], object.scale[1], object.scale[2]),
+                                                    glm::normalize(glm::quat(object.rotation[3], object.rotation[0], object.rotation[1], object.rotation[2])));
+        }
+        uint64_t childCnt = 0;
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            vke_common::Transform &transform = registry.get<vke_common::Transform>(entities[i]);
+            transform.parent = objects[i].parent ? idToEntity.at(objects[i].parent) : entt::null;
+            for (vke_ds::id32_t child : reader.GetChildren(objects[i]))
+                transform.children.insert(idToEntity[child]);
+            childCnt += transform.children.size();
+        }
+        uint64_t lightCnt = 0;
+        for (size_t i = 0; i < reader.GetComponents(vke_common::ComponentType::PointLight).size(); ++i)
+            lightCnt += reader.GetComponentJSON(vke_common::ComponentType::PointLight, i).contains("radius") ? 1 : 0;
+        return MixChecksum(MixChecksum(objects.size(), childCnt), lightCnt);
+    }
+
+    void Teardown() override { bytes.clear(); }
+
+private:
+    const uint32_t objectCnt;
+    std::vector<uint8_t> bytes;
+};
+
+// an evenly split data parallel loop on the engine's job system
+class JobParallelForScenario : public BenchScenario
+{
+public:
+    static constexpr uint32_t GRAIN = 1024;
+
+    explicit JobParallelForScenario(const BenchOptions &options) : elementCnt(options.Scaled(1 << 20)) {}
+
+    std::string GetName() const override { return "job_parallel_for"; }
+    nlohmann::json GetParams() const override
+    {
+        return {{"elementCnt", elementCnt}, {"grain", GRAIN}, {"workerCnt", vke_common::JobSystem::GetInstance()->GetWorkerCnt()}};
+    }
+
+    bool Setup(BenchRandom &random) override
+    {
+        input.resize(elementCnt);
+        output.resize(elementCnt);
+        for (float &value : input)
+            value = random.Uniform(0.0f, 1.0f);
+        return true;
+    }
+
+    uint64_t Run() override
+    {
+        vke_common::JobSystem::GetInstance()->ParallelFor(elementCnt, GRAIN, [this](uint32_t begin, uint32_t end, uint32_t)
+                                                          {
+                                                              for (uint32_t i = begin; i < end; ++i)
+                                                              {
+                                                                  float x = input[i];
+                                                                  for (uint32_t k = 0; k < 8; ++k)
+                                                                      x = std::sin(x) * 0.5f + std::cos(x * 0.25f);
+                                                                  output[i] = x;
+                                                              } });
+        double sum = 0.0;
+        for (uint32_t i = 0; i < elementCnt; i += 257)
+            sum += output[i];
+        return QuantizeForChecksum(sum);
+    }
+
+    void Teardown() override
+    {
+        input.clear();
+        output.clear();
+    }
+
+private:
+    const uint32_t elementCnt;
+    std::vector<float> input;
+    std::vector<float> output;
+};
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!options.ParseArgs(argc, argv))
+    {
+        std::cout << "usage: bench_suite [--filter name] [--scale f] [--seed n] [--warmup n] [--iterations n]"
+                     " [--out path] [--baseline path] [--threshold f] [--list]\n";
+        return 1;
+    }
+
+    vke_common::JobSystem::Init();
+    vke_bench::BenchRunner runner(options);
+    runner.Add(std::make_unique<PhysicsBodiesScenario>(options));
+    runner.Add(std::make_unique<TransformHierarchyScenario>(options));
+    runner.Add(std::make_unique<TextLayoutScenario>(options));
+    runner.Add(std::make_unique<Spatial2DScenario>(options));
+    runner.Add(std::make_unique<SceneLoadScenario>(options));
+    runner.Add(std::make_unique<JobParallelForScenario>(options));
+    runner.RunAll();
+
+    if (!options.outPath.empty())
+        Check("write " + options.outPath, runner.WriteJSON(options.outPath));
+    if (!options.baselinePath.empty())
+    {
+        std::ifstream ifs(options.baselinePath);
+        const nlohmann::json baseline = nlohmann::json::parse(ifs, nullptr, false);
+        const bool readable = !baseline.is_discarded() && baseline.is_object();
+        Check("read baseline " + options.baselinePath, readable);
+        if (readable)
+            failCnt += static_cast<int>(runner.CompareBaseline(baseline));
+    }
+    vke_common::JobSystem::Dispose();
+
+    if (options.list)
+        return 0;
+    return CheckResult();
+}
@@ -0,0 +1,210 @@
+#include "test_check.hpp"
+#include <text_layout.hpp>
+#include <font_atlas_baker.hpp>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 5000 UI labels updated every frame the way a HUD does: timers whose last digits tick, scores
+// that change now and then, static captions set to the same string again, and wrapped debug
+// overlays. Laying every update out from scratch, as UIText::rebuild did, is compared with the
+// TextLayoutCache, whose layouts have to match the from scratch ones. Run from the repository root.
+
+static constexpr const char *FONT_PATH = "./builtin_assets/fonts/arial.ttf";
+static constexpr uint32_t PIXEL_SIZE = 48;
+static constexpr uint32_t TIMER_CNT = 2000;
+static constexpr uint32_t SCORE_CNT = 1000;
+static constexpr uint32_t CAPTION_CNT = 1500;
+static constexpr uint32_t OVERLAY_CNT = 500;
+static constexpr uint32_t LABEL_CNT = TIMER_CNT + SCORE_CNT + CAPTION_CNT + OVERLAY_CNT;
+static constexpr uint32_t FRAME_CNT = 120;
+static constexpr float OVERLAY_WRAP_WIDTH = 600.0f;
+
+using Clock = std::chrono::steady_clock;
+using vke_common::TextLayout;
+using vke_common::TextLayoutCache;
+
+struct Label
+{
+    std::string text;
+    float wrapWidth = 0.0f;
+    TextLayout layout;
+    bool deferred = false;
+};
+
+static const char *CAPTIONS[] = {"Health", "Ammo", "Shield", "Inventory", "Map", "Quests", "Options", "Back",
+                                 "Continue", "Objective: reach the tower", "Press E to interact", "Level 3"};
+
+static std::string LabelText(uint32_t label, uint32_t frame)
+{
+    char buffer[160];
+    if (label < TIMER_CNT)
+    {
+        const uint32_t ms = (label * 37 + frame * 16) % 3600000;
+        std::snprintf(buffer, sizeof(buffer), "Time %02u:%02u.%03u", ms / 60000, ms / 1000 % 60, ms % 1000);
+    }
+    else if (label < TIMER_CNT + SCORE_CNT)
+        std::snprintf(buffer, sizeof(buffer), "Score: %u", label * 10 + (frame + label) / 10 * 50);
+    else if (label < TIMER_CNT + SCORE_CNT + CAPTION_CNT)
+        return CAPTIONS[label % (sizeof(CAPTIONS) / sizeof(CAPTIONS[0]))];
+    else
+        std::snprintf(buffer, sizeof(buffer), "entity %u pos %.2f %.2f %.2f vel %.3f %.3f %.3f frame %u",
+                      label, label * 0.5f, frame * 0.1f, 3.0f, frame * 0.01f, -1.0f, 0.5f, frame);
+    return buffer;
+}
+
+static bool SameLayout(const TextLayout &a, const TextLayout &b)
+{
+    if (a.glyphs.size() != b.glyphs.size() || !(a.minimum == b.minimum) || !(a.maximum == b.maximum))
+        return false;
+    for (size_t i = 0; i < a.glyphs.size(); ++i)
+        if (!(a.glyphs[i].quadRect == b.glyphs[i].quadRect) || !(a.glyphs[i].uvRect == b.glyphs[i].uvRect) ||
+            a.glyphs[i].atlasType != b.glyphs[i].atlasType)
+            return false;
+    return true;
+}
+
+int main()
+{
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+    if (FT_Init_FreeType(&library) != FT_Err_Ok || FT_New_Face(library, FONT_PATH, 0, &face) != FT_Err_Ok)
+    {
+        std::cout << "cannot open " << FONT_PATH << "\n";
+        return 1;
+    }
+    if (face->charmap == nullptr)
+        FT_Select_Charmap(face, FT_ENCODING_UNICODE);
+    FT_Set_Pixel_Sizes(face, 0, PIXEL_SIZE);
+
+    // the builtin font's static atlas
+    std::vector<uint32_t> ascii;
+    for (uint32_t codepoint = 32; codepoint < 127; ++codepoint)
+        ascii.push_back(codepoint);
+    std::vector<vke_common::Glyph> bakedGlyphs;
+    std::vector<uint8_t> pixels;
+    vke_common::StaticAtlasBaker(face, FONT_PATH, PIXEL_SIZE).BakeUncached(ascii, nullptr, bakedGlyphs, pixels);
+    std::unordered_map<uint32_t, vke_common::Glyph> glyphs;
+    for (const vke_common::Glyph &glyph : bakedGlyphs)
+        glyphs[glyph.codepoint] = glyph;
+    auto getGlyph = [&glyphs](uint32_t codepoint) -> const vke_common::Glyph *
+    {
+        auto it = glyphs.find(codepoint);
+        return it == glyphs.end() ? nullptr : &it->second;
+    };
+
+    vke_common::TextLayoutFont font;
+    font.handle = 1;
+    font.pixelSize = PIXEL_SIZE;
+    font.ascender = static_cast<int>(face->size->metrics.ascender >> 6);
+    font.lineHeight = static_cast<int>(face->size->metrics.height >> 6);
+
+    // every frame's strings up front, so only layout is timed
+    std::vector<std::vector<std::string>> frameTexts(FRAME_CNT, std::vector<std::string>(LABEL_CNT));
+    for (uint32_t frame = 0; frame < FRAME_CNT; ++frame)
+        for (uint32_t label = 0; label < LABEL_CNT; ++label)
+            frameTexts[frame][label] = LabelText(label, frame);
+    auto wrapWidthOf = [](uint32_t label)
+    { return label >= TIMER_CNT + SCORE_CNT + CAPTION_CNT ? OVERLAY_WRAP_WIDTH : 0.0f; };
+
+    // from scratch into a new layout, every label every frame
+    double scratchMs = 0.0;
+    size_t scratchBytes = 0;
+    for (uint32_t frame = 0; frame < FRAME_CNT; ++frame)
+    {
+        const auto start = Clock::now();
+        for (uint32_t label = 0; label < LABEL_CNT; ++label)
+        {
+            TextLayout layout;
+            vke_common::LayoutText(font, frameTexts[frame][label], wrapWidthOf(label), getGlyph, layout);
+            scratchBytes += frameTexts[frame][label].size();
+        }
+        scratchMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // cached, with a budget high enough for every label and with a tight one
+    auto runCached = [&](const std::string &name, uint32_t frameBudget)
+    {
+        TextLayoutCache cache(TextLayoutCache::DEFAULT_CAPACITY, frameBudget);
+        std::vector<Label> labels(LABEL_CNT);
+        for (uint32_t label = 0; label < LABEL_CNT; ++label)
+            labels[label].wrapWidth = wrapWidthOf(label);
+        uint32_t frame = 0;
+        std::vector<uint32_t> laidOutFrame(LABEL_CNT, 0);
+        // what UIText::SetText and its deferred retries do
+        std::function<void(uint32_t)> update = [&](uint32_t label)
+        {
+            Label &state = labels[label];
+            state.deferred = !cache.Layout(font, state.text, state.wrapWidth, state.layout, getGlyph);
+            if (!state.deferred)
+                laidOutFrame[label] = frame;
+            else
+                cache.Defer(&state, [&update, label]()
+                            { update(label); });
+        };
+
+        double cachedMs = 0.0;
+        uint32_t peakFrameBytes = 0;
+        size_t maxLagFrames = 0;
+        bool matches = true;
+        for (; frame < FRAME_CNT; ++frame)
+        {
+            const uint64_t bytesBefore = cache.GetStats().laidOutByteCnt;
+            const auto start = Clock::now();
+            cache.BeginFrame();
+            for (uint32_t label = 0; label < LABEL_CNT; ++label)
+            {
+                Label &state = labels[label];
+                const std::string &text = frameTexts[frame][label];
+                if (text == state.text)
+                    continue;
+                state.text = text;
+                update(label);
+            }
+            cachedMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            peakFrameBytes = std::max(peakFrameBytes, static_cast<uint32_t>(cache.GetStats().laidOutByteCnt - bytesBefore));
+
+            for (uint32_t label = 0; label < LABEL_CNT; ++label)
+            {
+                const Label &state = labels[label];
+                // a deferred label still shows what it was last laid out with
+                if (state.deferred)
+                {
+                    maxLagFrames = std::max<size_t>(maxLagFrames, frame - laidOutFrame[label]);
+                    continue;
+                }
+                TextLayout expected;
+                vke_common::LayoutText(font, state.text, state.wrapWidth, getGlyph, expected);
+                matches = matches && state.layout.text == state.text && SameLayout(state.layout, expected);
+            }
+        }
+
+        const TextLayoutCache::Stats &stats = cache.GetStats();
+        std::cout << name << ", budget " << frameBudget / 1024 << " KiB per frame:\n"
+                  << "  " << cachedMs / FRAME_CNT << " ms per frame, " << scratchMs / cachedMs << "x faster\n"
+                  << "  " << stats.hitCnt << " hits, " << stats.missCnt << " misses of which " << stats.resumedCnt
+                  << " resumed a prefix, " << stats.deferredCnt << " deferred\n"
+                  << "  " << stats.laidOutByteCnt / FRAME_CNT << " bytes laid out per frame, peak " << peakFrameBytes
+                  << ", labels at most " << maxLagFrames << " frames behind\n";
+        Check(name + " layouts match the from scratch ones", matches);
+        return std::make_pair(peakFrameBytes, stats.deferredCnt);
+    };
+
+    std::cout << "5000 labels, " << FRAME_CNT << " frames\n"
+              << "from scratch: " << scratchMs / FRAME_CNT << " ms per frame, "
+              << scratchBytes / FRAME_CNT << " bytes laid out per frame\n";
+    runCached("cached", TextLayoutCache::DEFAULT_FRAME_BUDGET);
+    // the first frame lays every label out, more than a small budget allows; later frames need less
+    const auto [peakBytes, deferredCnt] = runCached("cached", 32 * 1024);
+    Check("a small budget defers layouts", deferredCnt > 0);
+    Check("a small budget bounds the bytes laid out per frame", peakBytes <= 32 * 1024 + 256);
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    return CheckResult();
+}
@@ -0,0 +1,123 @@
+#include "test_check.hpp"
+#include <atlas_dirty_slots.hpp>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// AtlasDirtySlots on the dynamic glyph atlas layout: 32x32 slots of 64 pixels, two frames in flight.
+
+static constexpr uint32_t SLOTS_PER_ROW = 32;
+static constexpr uint32_t SLOT_SIZE = 64;
+static constexpr uint32_t FRAME_CNT = 2;
+
+using vke_common::AtlasDirtySlots;
+using vke_common::AtlasRegion;
+
+static AtlasDirtySlots MakeTracker() { return AtlasDirtySlots(FRAME_CNT, SLOTS_PER_ROW, SLOTS_PER_ROW, SLOT_SIZE); }
+
+static AtlasRegion SlotRect(uint32_t column, uint32_t row, uint32_t width, uint32_t height)
+{
+    return AtlasRegion{column * SLOT_SIZE, row * SLOT_SIZE, width * SLOT_SIZE, height * SLOT_SIZE};
+}
+
+static std::vector<AtlasRegion> Take(AtlasDirtySlots &tracker, uint32_t frame)
+{
+    std::vector<AtlasRegion> regions;
+    tracker.TakeRegions(frame, regions);
+    return regions;
+}
+
+static void TestShapes()
+{
+    AtlasDirtySlots tracker = MakeTracker();
+    Check("nothing dirty gives no regions", !tracker.IsDirty(0) && Take(tracker, 0).empty());
+
+    tracker.MarkSlot(SLOTS_PER_ROW + 1);
+    Check("a single slot is one slot sized region", Take(tracker, 0) == std::vector<AtlasRegion>{SlotRect(1, 1, 1, 1)});
+
+    tracker = MakeTracker();
+    for (uint32_t slot = 0; slot < SLOTS_PER_ROW; ++slot)
+        tracker.MarkSlot(slot);
+    Check("a full slot row is one strip", Take(tracker, 0) == std::vector<AtlasRegion>{SlotRect(0, 0, SLOTS_PER_ROW, 1)});
+
+    tracker = MakeTracker();
+    for (uint32_t row = 3; row < 5; ++row)
+        for (uint32_t column = 2; column < 5; ++column)
+            tracker.MarkSlot(row * SLOTS_PER_ROW + column);
+    Check("a block of slots is one rectangle", Take(tracker, 0) == std::vector<AtlasRegion>{SlotRect(2, 3, 3, 2)});
+
+    tracker = MakeTracker();
+    for (uint32_t column = 0; column < 4; ++column)
+        tracker.MarkSlot(column);
+    tracker.MarkSlot(SLOTS_PER_ROW);
+    tracker.MarkSlot(SLOTS_PER_ROW + 1);
+    tracker.MarkSlot(SLOTS_PER_ROW + 6);
+    const std::vector<AtlasRegion> lShape = Take(tracker, 0);
+    Check("runs of different width are not merged",
+          lShape == std::vector<AtlasRegion>{SlotRect(0, 0, 4, 1), SlotRect(0, 1, 2, 1), SlotRect(6, 1, 1, 1)});
+
+    tracker = MakeTracker();
+    for (uint32_t slot = 0; slot < SLOTS_PER_ROW * SLOTS_PER_ROW; ++slot)
+        tracker.MarkSlot(slot);
+    Check("a fully dirty atlas is one region", Take(tracker, 0) == std::vector<AtlasRegion>{SlotRect(0, 0, SLOTS_PER_ROW, SLOTS_PER_ROW)});
+}
+
+static void TestPerFrameLists()
+{
+    AtlasDirtySlots tracker = MakeTracker();
+    tracker.MarkSlot(5);
+    tracker.MarkSlot(5);
+    Check("marking a slot twice counts it once", tracker.GetDirtySlotCnt(0) == 1 && tracker.GetDirtySlotCnt(1) == 1);
+
+    Take(tracker, 0);
+    Check("taking one frame's regions leaves the other frame pending", !tracker.IsDirty(0) && tracker.IsDirty(1));
+
+    tracker.MarkSlot(40);
+    Check("frame 0 only gets the slot written since its upload", Take(tracker, 0) == std::vector<AtlasRegion>{SlotRect(8, 1, 1, 1)});
+    Check("frame 1 gets both", Take(tracker, 1) == std::vector<AtlasRegion>{SlotRect(5, 0, 1, 1), SlotRect(8, 1, 1, 1)});
+
+    tracker.MarkSlot(7);
+    tracker.Clear();
+    Check("clear drops every pending list", !tracker.IsDirty(0) && !tracker.IsDirty(1));
+}
+
+// regions have to cover exactly the dirty slots, each of them once
+static void TestRandomCoverage()
+{
+    std::mt19937 rng(3);
+    bool exact = true;
+    size_t regionCnt = 0, dirtyCnt = 0;
+    for (uint32_t round = 0; round < 500 && exact; ++round)
+    {
+        AtlasDirtySlots tracker = MakeTracker();
+        std::vector<uint32_t> expected(SLOTS_PER_ROW * SLOTS_PER_ROW, 0);
+        const uint32_t density = 1 + rng() % 8;
+        for (uint32_t slot = 0; slot < expected.size(); ++slot)
+            if (rng() % 8 < density)
+            {
+                tracker.MarkSlot(slot);
+                expected[slot] = 1;
+                ++dirtyCnt;
+            }
+
+        std::vector<uint32_t> covered(expected.size(), 0);
+        const std::vector<AtlasRegion> regions = Take(tracker, round % FRAME_CNT);
+        regionCnt += regions.size();
+        for (const AtlasRegion &region : regions)
+            for (uint32_t y = region.y / SLOT_SIZE; y < (region.y + region.height) / SLOT_SIZE; ++y)
+                for (uint32_t x = region.x / SLOT_SIZE; x < (region.x + region.width) / SLOT_SIZE; ++x)
+                    ++covered[y * SLOTS_PER_ROW + x];
+        exact = covered == expected;
+    }
+    Check("random dirty sets are covered exactly once", exact);
+    std::cout << "  " << dirtyCnt << " dirty slots in " << regionCnt << " regions\n";
+}
+
+int main()
+{
+    TestShapes();
+    TestPerFrameLists();
+    TestRandomCoverage();
+    return CheckResult();
+}
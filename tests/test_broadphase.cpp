@@ -0,0 +1,88 @@
+#include <physics/physics.hpp>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+
+// Headless spawn/despawn stress test for the broad phase maintenance scheduler.
+// Runs the same deterministic churn twice (scheduler off / on) and prints the raycast query cost over time.
+
+static constexpr uint32_t FRAME_CNT = 1200;
+static constexpr uint32_t SPAWN_PER_FRAME = 64;
+static constexpr uint32_t LIVE_BODY_CAP = 20000;
+static constexpr uint32_t QUERY_CNT = 256;
+static constexpr uint32_t REPORT_INTERVAL = 120;
+static constexpr float WORLD_EXTENT = 500.0f;
+
+static float MeasureQueries(std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> dist(-WORLD_EXTENT, WORLD_EXTENT);
+    vke_physics::RaycastHit hit;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < QUERY_CNT; ++i)
+    {
+        const JPH::RVec3 origin(dist(rng), WORLD_EXTENT, dist(rng));
+        const JPH::Vec3 direction(dist(rng) * 0.1f, -1.0f, dist(rng) * 0.1f);
+        vke_physics::PhysicsManager::Raycast(origin, direction, WORLD_EXTENT * 4.0f, hit);
+    }
+    return std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count() / QUERY_CNT;
+}
+
+static void RunStress(bool enableScheduler)
+{
+    vke_physics::PhysicsConfig config;
+    config.broadPhaseMaintenance.enabled = enableScheduler;
+    vke_physics::PhysicsManager::Init(config);
+
+    JPH::RefConst<JPH::Shape> box = new JPH::BoxShape(JPH::Vec3(0.5f, 0.5f, 0.5f));
+    std::mt19937 spawnRng(12345);
+    std::mt19937 queryRng(54321);
+    std::uniform_real_distribution<float> dist(-WORLD_EXTENT, WORLD_EXTENT);
+    std::deque<JPH::BodyID> live;
+
+    std::cout << (enableScheduler ? "--- scheduler on ---\n" : "--- scheduler off ---\n");
+    std::cout << "frame, bodies, queryUs, fullOptimizes, incrementalUpdates, deferredFrames\n";
+    for (uint32_t frame = 1; frame <= FRAME_CNT; ++frame)
+    {
+        // spawn waves drift across the world so removed regions leave stale tree nodes behind
+        const float drift = WORLD_EXTENT * (static_cast<float>(frame % 400) / 200.0f - 1.0f);
+        for (uint32_t i = 0; i < SPAWN_PER_FRAME; ++i)
+        {
+            const JPH::RVec3 position(drift + dist(spawnRng) * 0.1f, dist(spawnRng) * 0.05f, dist(spawnRng));
+            JPH::BodyCreationSettings settings(box, position, JPH::Quat::sIdentity(), JPH::EMotionType::Static, vke_physics::DefaultObjectLayers::NON_MOVING);
+            live.push_back(vke_physics::PhysicsManager::CreateAndAddBody(settings, JPH::EActivation::DontActivate));
+        }
+        while (live.size() > LIVE_BODY_CAP)
+        {
+            vke_physics::PhysicsManager::RemoveAndDestroyBody(live.front());
+            live.pop_front();
+        }
+
+        vke_physics::PhysicsManager::FixedUpdate();
+        vke_physics::PhysicsManager::MaintainBroadPhase();
+
+        if (frame % REPORT_INTERVAL == 0)
+        {
+            const vke_physics::BroadPhaseMetrics &metrics = vke_physics::PhysicsManager::GetBroadPhaseMetrics();
+            std::cout << frame << ", " << live.size() << ", " << MeasureQueries(queryRng) << ", "
+                      << metrics.fullOptimizeCount << ", " << metrics.incrementalUpdateCount << ", "
+                      << metrics.deferredFrames << "\n";
+        }
+    }
+
+    while (!live.empty())
+    {
+        vke_physics::PhysicsManager::RemoveAndDestroyBody(live.front());
+        live.pop_front();
+    }
+    box = nullptr;
+    vke_physics::PhysicsManager::Dispose();
+}
+
+int main()
+{
+    RunStress(false);
+    RunStress(true);
+    return 0;
+}
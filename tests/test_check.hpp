@@ -0,0 +1,24 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <iostream>
+#include <string>
+
+// PASS/FAIL reporting shared by the tests and benches. Check prints one line per condition and
+// counts the failures, CheckResult prints the summary and gives main its exit code.
+
+inline int failCnt = 0;
+
+inline void Check(const std::string &what, bool ok)
+{
+    failCnt += ok ? 0 : 1;
+    std::cout << (ok ? "PASS " : "FAIL ") << what << "\n";
+}
+
+inline int CheckResult()
+{
+    std::cout << (failCnt == 0 ? "all passed\n" : "failures\n");
+    return failCnt == 0 ? 0 : 1;
+}
+
+#endif
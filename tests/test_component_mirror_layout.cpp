@@ -0,0 +1,149 @@
+#include "test_check.hpp"
+#include <interop/mirror.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Checks that the sequential C# layouts in csharp/EngineCore match the native interop structs.
+// Field sizes are taken from the C# declarations and laid out with the default sequential packing rules.
+
+struct CSharpField
+{
+    std::string name;
+    size_t size;
+};
+
+static std::string ReadText(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "failed to open " << path << "\n";
+        return "";
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+static size_t GetTypeSize(const std::string &type, const std::map<std::string, size_t> &structSizes)
+{
+    if (type.back() == '*')
+        return sizeof(void *);
+    static const std::map<std::string, size_t> primitiveSizes = {
+        {"float", 4}, {"UInt32", 4}, {"Int32", 4}, {"UInt64", 8}, {"Int64", 8}, {"double", 8}};
+    auto it = primitiveSizes.find(type);
+    if (it != primitiveSizes.end())
+        return it->second;
+    it = structSizes.find(type);
+    return it == structSizes.end() ? 0 : it->second;
+}
+
+static std::vector<CSharpField> ParseStruct(const std::string &source, const std::string &structName, const std::map<std::string, size_t> &structSizes)
+{
+    std::vector<CSharpField> fields;
+    const std::regex header("struct\\s+" + structName + "\\s*\\{");
+    std::smatch match;
+    if (!std::regex_search(source, match, header))
+        return fields;
+
+    // instance fields are the "public <type> a, b;" lines before the first constructor/property
+    std::istringstream body(source.substr(match.position() + match.length()));
+    const std::regex fieldLine("^\\s*public\\s+([A-Za-z0-9_]+\\*?)\\s+([A-Za-z0-9_,\\s]+);\\s*$");
+    std::string line;
+    while (std::getline(body, line))
+    {
+        if (line.find('}') != std::string::npos || line.find('(') != std::string::npos)
+            break;
+        std::smatch fieldMatch;
+        if (!std::regex_match(line, fieldMatch, fieldLine))
+            continue;
+        const size_t size = GetTypeSize(fieldMatch[1], structSizes);
+        std::stringstream names(fieldMatch[2]);
+        std::string name;
+        while (std::getline(names, name, ','))
+        {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            fields.push_back(CSharpField{name, size});
+        }
+    }
+    return fields;
+}
+
+static std::map<std::string, size_t> ComputeOffsets(const std::vector<CSharpField> &fields, size_t &structSize)
+{
+    std::map<std::string, size_t> offsets;
+    size_t offset = 0;
+    size_t maxAlign = 1;
+    for (const CSharpField &field : fields)
+    {
+        // primitives and pointers align to their size, nested float structs to 4
+        const size_t align = field.size == 8 ? 8 : 4;
+        maxAlign = std::max(maxAlign, align);
+        offset = (offset + align - 1) / align * align;
+        offsets[field.name] = offset;
+        offset += field.size;
+    }
+    structSize = (offset + maxAlign - 1) / maxAlign * maxAlign;
+    return offsets;
+}
+
+static void Check(const std::string &what, size_t expected, size_t actual)
+{
+    Check(what + ": native " + std::to_string(expected) + ", managed " + std::to_string(actual), expected == actual);
+}
+
+#define CHECK_FIELD(type, name, offsets) \
+    Check(#type "::" #name, offsetof(type, name), offsets.count(#name) ? offsets.at(#name) : SIZE_MAX)
+
+int main(int argc, char **argv)
+{
+    const std::string root = argc > 1 ? argv[1] : ".";
+    const std::string nmath = ReadText(root + "/csharp/EngineCore/NMath.cs");
+    const std::string mirror = ReadText(root + "/csharp/EngineCore/ComponentMirror.cs");
+
+    std::map<std::string, size_t> structSizes;
+    size_t size = 0;
+
+    using Vec3 = vke_interop::Vector3<float>;
+    using Quat = vke_interop::Quaternion<float>;
+    using View = vke_interop::ComponentMirrorView;
+
+    auto offsets = ComputeOffsets(ParseStruct(nmath, "NVec3", structSizes), size);
+    structSizes["NVec3"] = size;
+    Check("sizeof(NVec3)", sizeof(Vec3), size);
+    CHECK_FIELD(Vec3, x, offsets);
+    CHECK_FIELD(Vec3, y, offsets);
+    CHECK_FIELD(Vec3, z, offsets);
+
+    offsets = ComputeOffsets(ParseStruct(nmath, "NQuat", structSizes), size);
+    structSizes["NQuat"] = size;
+    Check("sizeof(NQuat)", sizeof(Quat), size);
+    CHECK_FIELD(Quat, x, offsets);
+    CHECK_FIELD(Quat, y, offsets);
+    CHECK_FIELD(Quat, z, offsets);
+    CHECK_FIELD(Quat, w, offsets);
+
+    offsets = ComputeOffsets(ParseStruct(mirror, "NativeComponentMirrorView", structSizes), size);
+    Check("sizeof(NativeComponentMirrorView)", sizeof(View), size);
+    CHECK_FIELD(View, generation, offsets);
+    CHECK_FIELD(View, capacity, offsets);
+    CHECK_FIELD(View, entityIndexMask, offsets);
+    CHECK_FIELD(View, entities, offsets);
+    CHECK_FIELD(View, flags, offsets);
+    CHECK_FIELD(View, worldPositions, offsets);
+    CHECK_FIELD(View, worldRotations, offsets);
+    CHECK_FIELD(View, linearVelocities, offsets);
+    CHECK_FIELD(View, angularVelocities, offsets);
+
+    std::cout << (failCnt == 0 ? "layout ok\n" : "layout mismatch\n");
+    return failCnt == 0 ? 0 : 1;
+}
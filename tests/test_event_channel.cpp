@@ -0,0 +1,160 @@
+#include "test_check.hpp"
+#include <event.hpp>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Listener handles under churn, listeners that add and remove listeners while being called,
+// immediate and queued dispatch, and queued events from several producers with a queue small
+// enough to overflow.
+
+using vke_common::EventChannel;
+using vke_common::EventSystem;
+
+struct TestEvent
+{
+    uint32_t producer = 0;
+    uint32_t sequence = 0;
+};
+
+// handles survive the removal of other listeners, stale handles remove nothing
+static void TestHandles()
+{
+    vke_common::ListenerList<std::function<void(int &)>> list;
+    std::vector<vke_ds::id32_t> handles;
+    for (int i = 0; i < 8; ++i)
+        handles.push_back(list.Add([i](int &sum)
+                                   { sum += 1 << i; }));
+    list.Remove(handles[0]);
+    list.Remove(handles[5]);
+    int sum = 0;
+    list.Invoke(sum);
+    Check("removing listeners keeps the others", sum == 0xff - 1 - 32);
+
+    const vke_ds::id32_t reused = list.Add([](int &sum)
+                                           { sum += 1000; });
+    Check("a stale handle does not remove the listener reusing its slot", !list.Remove(handles[5]) && !list.Remove(handles[0]));
+    sum = 0;
+    list.Invoke(sum);
+    Check("the reused slot's listener is called", sum == 0xff - 1 - 32 + 1000);
+    Check("removing twice fails", list.Remove(reused) && !list.Remove(reused) && list.GetCount() == 6);
+}
+
+// a listener that removes itself and another one and adds a new one while being called
+static void TestChangesWhileInvoking()
+{
+    vke_common::ListenerList<std::function<void(std::vector<int> &)>> list;
+    vke_ds::id32_t first, second, added = 0;
+    bool addedOnce = false;
+    first = list.Add([&](std::vector<int> &calls)
+                     {
+                         calls.push_back(1);
+                         list.Remove(first);
+                         list.Remove(second);
+                         if (!addedOnce)
+                         {
+                             addedOnce = true;
+                             added = list.Add([](std::vector<int> &calls)
+                                              { calls.push_back(3); });
+                         } });
+    second = list.Add([](std::vector<int> &calls)
+                      { calls.push_back(2); });
+    std::vector<int> calls;
+    list.Invoke(calls);
+    Check("listeners removed while invoking are skipped, added ones wait", calls == std::vector<int>{1});
+    calls.clear();
+    list.Invoke(calls);
+    Check("changes apply after the walk", calls == std::vector<int>{3} && list.GetCount() == 1 && list.Remove(added));
+}
+
+// queued events wait for DispatchQueued, immediate ones do not, events posted by listeners wait a round
+static void TestDispatch()
+{
+    EventChannel<TestEvent> channel(16);
+    std::vector<uint32_t> received;
+    channel.AddListener([&](const TestEvent &event)
+                        {
+                            received.push_back(event.sequence);
+                            if (event.sequence == 1)
+                                channel.Post(TestEvent{0, 100}); });
+    channel.Post(TestEvent{0, 1});
+    channel.Post(TestEvent{0, 2});
+    channel.Dispatch(TestEvent{0, 50});
+    Check("immediate dispatch does not wait", received == std::vector<uint32_t>{50});
+    Check("queued events arrive in order", channel.DispatchQueued() == 2 && received == std::vector<uint32_t>({50, 1, 2}));
+    Check("events posted while dispatching wait for the next round", channel.DispatchQueued() == 1 && received.back() == 100);
+}
+
+// several producers post more than the queue holds while the main thread dispatches
+static void TestProducers()
+{
+    constexpr uint32_t PRODUCER_CNT = 4;
+    constexpr uint32_t EVENTS_PER_PRODUCER = 50000;
+    EventChannel<TestEvent> channel(1024);
+    std::vector<uint32_t> lastSequence(PRODUCER_CNT, 0);
+    uint32_t receivedCnt = 0;
+    bool ordered = true;
+    channel.AddListener([&](const TestEvent &event)
+                        {
+                            ++receivedCnt;
+                            // overflowed events arrive late, so the order only holds without overflow
+                            ordered = ordered && event.sequence > lastSequence[event.producer];
+                            lastSequence[event.producer] = std::max(lastSequence[event.producer], event.sequence); });
+
+    std::atomic<uint32_t> doneCnt(0);
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCER_CNT; ++p)
+        producers.emplace_back([&, p]()
+                               {
+                                   for (uint32_t i = 1; i <= EVENTS_PER_PRODUCER; ++i)
+                                       channel.Post(TestEvent{p, i});
+                                   doneCnt.fetch_add(1); });
+    while (doneCnt.load() < PRODUCER_CNT)
+        channel.DispatchQueued();
+    for (std::thread &producer : producers)
+        producer.join();
+    channel.DispatchQueued();
+    channel.DispatchQueued();
+
+    Check("every posted event is dispatched once", receivedCnt == PRODUCER_CNT * EVENTS_PER_PRODUCER);
+    if (channel.GetOverflowCount() == 0)
+        Check("events of one producer arrive in order", ordered);
+    else
+        std::cout << channel.GetOverflowCount() << " events overflowed the queue\n";
+}
+
+// channels looked up by type through the event system, from a worker thread as well
+static void TestEventSystem()
+{
+    EventSystem::Init();
+    uint32_t sum = 0;
+    const vke_ds::id32_t handle = EventSystem::AddListener<TestEvent>([&](const TestEvent &event)
+                                                                      { sum += event.sequence; });
+    std::thread worker([]()
+                       { EventSystem::Post(TestEvent{0, 7}); });
+    worker.join();
+    EventSystem::Dispatch(TestEvent{0, 1});
+    Check("the event system dispatches queued events of every channel", EventSystem::DispatchQueued() == 1 && sum == 8);
+    EventSystem::RemoveListener<TestEvent>(handle);
+    Check("listeners are counted", !EventSystem::HasListeners<TestEvent>());
+
+    bool resized = false;
+    EventSystem::AddEventListener(vke_common::EVENT_WINDOW_RESIZE, &resized, [](void *listener, void *)
+                                  { *static_cast<bool *>(listener) = true; });
+    EventSystem::DispatchEvent(vke_common::EVENT_WINDOW_RESIZE, nullptr);
+    Check("global events still dispatch at once", resized);
+    EventSystem::Dispose();
+}
+
+int main()
+{
+    TestHandles();
+    TestChangesWhileInvoking();
+    TestDispatch();
+    TestProducers();
+    TestEventSystem();
+    return CheckResult();
+}
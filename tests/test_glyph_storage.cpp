@@ -0,0 +1,216 @@
+#include "test_check.hpp"
+#include <ds/dirty_spans.hpp>
+#include <ds/paged_range_storage.hpp>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// The CPU side of the glyph instance storage: paged range allocation and the dirty spans that are
+// batched into one upload per frame. Texts are modelled as ranges of glyphs, the way UIComponent
+// allocates them.
+
+static constexpr uint32_t PAGE_SIZE = 4096;
+static constexpr uint32_t FRAME_CNT = 2;
+static constexpr uint32_t MERGE_GAP = 16;
+
+// same size as GlyphInstanceGPU
+struct FakeGlyph
+{
+    uint32_t text;
+    uint32_t index;
+    uint32_t padding[14];
+};
+
+using Storage = vke_ds::PagedRangeStorage<FakeGlyph, PAGE_SIZE>;
+using vke_ds::DirtySpans;
+using vke_ds::Span;
+
+static std::vector<Span> Take(DirtySpans &dirty, uint32_t frame, uint32_t mergeGap = 0)
+{
+    std::vector<Span> spans;
+    dirty.Take(frame, spans, mergeGap);
+    return spans;
+}
+
+static void TestSpanMerging()
+{
+    DirtySpans dirty(FRAME_CNT);
+    Check("nothing marked gives no spans", !dirty.IsDirty(0) && Take(dirty, 0).empty());
+
+    dirty.Mark(10, 20);
+    dirty.Mark(20, 30);
+    dirty.Mark(15, 18);
+    Check("overlapping and adjacent spans become one", Take(dirty, 0) == std::vector<Span>{{10, 30}});
+
+    dirty = DirtySpans(FRAME_CNT);
+    dirty.Mark(100, 110);
+    dirty.Mark(0, 5);
+    dirty.Mark(50, 60);
+    dirty.Mark(5, 8);
+    Check("spans come out sorted", Take(dirty, 0) == std::vector<Span>{{0, 8}, {50, 60}, {100, 110}});
+
+    dirty.Mark(0, 4);
+    dirty.Mark(14, 20);
+    dirty.Mark(40, 41);
+    Check("small gaps are bridged when asked to", Take(dirty, 0, 10) == std::vector<Span>{{0, 20}, {40, 41}});
+
+    dirty.Mark(7, 7);
+    Check("empty spans are ignored", !dirty.IsDirty(0));
+}
+
+static void TestPerFrameSpans()
+{
+    DirtySpans dirty(FRAME_CNT);
+    dirty.Mark(0, 10);
+    Take(dirty, 0);
+    Check("taking one frame's spans leaves the other frame pending", !dirty.IsDirty(0) && dirty.IsDirty(1));
+
+    dirty.Mark(20, 30);
+    Check("frame 0 only gets the span written since its upload", Take(dirty, 0) == std::vector<Span>{{20, 30}});
+    Check("frame 1 gets both", Take(dirty, 1) == std::vector<Span>{{0, 10}, {20, 30}});
+
+    dirty.MarkFrame(1, 0, 64);
+    Check("marking a single frame leaves the others alone", !dirty.IsDirty(0) && Take(dirty, 1) == std::vector<Span>{{0, 64}});
+
+    dirty.Mark(1, 2);
+    dirty.Clear();
+    Check("clear drops every pending list", !dirty.IsDirty(0) && !dirty.IsDirty(1));
+}
+
+static void TestPagedStorage()
+{
+    Storage storage;
+    Check("empty storage has no pages", storage.GetCapacity() == 0 && storage.GetEnd() == 0);
+
+    const uint32_t first = storage.Alloc(100);
+    const uint32_t second = storage.Alloc(PAGE_SIZE);
+    Check("ranges are packed from the front", first == 0 && second == 100 && storage.GetEnd() == PAGE_SIZE + 100);
+    Check("pages are added as the end grows", storage.GetCapacity() == 2 * PAGE_SIZE);
+
+    storage[PAGE_SIZE - 1].index = 7;
+    const FakeGlyph *page0 = &storage[0];
+    storage.Alloc(3 * PAGE_SIZE);
+    Check("growing keeps elements in place", &storage[0] == page0 && storage[PAGE_SIZE - 1].index == 7);
+
+    for (uint32_t i = 0; i < PAGE_SIZE; ++i)
+        storage[second + i].index = i;
+    std::vector<FakeGlyph> copied(PAGE_SIZE);
+    storage.CopyOut(second, second + PAGE_SIZE, copied.data());
+    bool straddles = true;
+    for (uint32_t i = 0; i < PAGE_SIZE; ++i)
+        straddles = straddles && copied[i].index == i;
+    Check("a range across a page boundary copies out in order", straddles);
+
+    storage.Free(first, 100);
+    Check("a freed range is reused", storage.Alloc(60) == 0 && storage.Alloc(40) == 60);
+
+    storage.Clear();
+    Check("clear drops ranges and pages", storage.GetEnd() == 0 && storage.GetCapacity() == 0);
+}
+
+// texts of random length come and go and change colour, every frame's copy is checked against the CPU data
+static void TestRandomTexts()
+{
+    std::mt19937 rng(11);
+    Storage storage;
+    DirtySpans dirty(FRAME_CNT);
+    struct Text
+    {
+        uint32_t id;
+        uint32_t offset;
+        uint32_t count;
+    };
+    std::vector<Text> texts;
+    std::vector<std::vector<FakeGlyph>> gpuCopies(FRAME_CNT);
+    uint32_t nextTextID = 1, peakUsed = 0, peakEnd = 0;
+    size_t spanCnt = 0, uploadedCnt = 0, chunkCnt = 0;
+    bool disjoint = true, uploadsMatch = true;
+
+    for (uint32_t frameIndex = 0; frameIndex < 2000; ++frameIndex)
+    {
+        const uint32_t changeCnt = rng() % 24;
+        for (uint32_t change = 0; change < changeCnt; ++change)
+        {
+            const uint32_t action = rng() % 8;
+            if (action < 4 || texts.empty())
+            {
+                Text text{nextTextID++, 0, 1 + static_cast<uint32_t>(rng() % 200)};
+                text.offset = storage.Alloc(text.count);
+                for (uint32_t i = 0; i < text.count; ++i)
+                    storage[text.offset + i] = FakeGlyph{text.id, i, {}};
+                dirty.Mark(text.offset, text.offset + text.count);
+                texts.push_back(text);
+            }
+            else
+            {
+                const size_t victim = rng() % texts.size();
+                Text &text = texts[victim];
+                if (action < 6)
+                {
+                    storage.Free(text.offset, text.count);
+                    texts[victim] = texts.back();
+                    texts.pop_back();
+                }
+                else
+                {
+                    storage[text.offset + rng() % text.count].padding[0] = frameIndex;
+                    dirty.Mark(text.offset, text.offset + text.count);
+                }
+            }
+        }
+        peakUsed = std::max(peakUsed, storage.GetUsed());
+        peakEnd = std::max(peakEnd, storage.GetEnd());
+
+        // the previous storage uploaded every touched 512 glyph buffer on its own
+        std::vector<uint8_t> touched((storage.GetEnd() + 511) / 512, 0);
+
+        const uint32_t frame = frameIndex % FRAME_CNT;
+        std::vector<FakeGlyph> &gpu = gpuCopies[frame];
+        gpu.resize(storage.GetCapacity());
+        const std::vector<Span> spans = Take(dirty, frame, MERGE_GAP);
+        spanCnt += spans.size();
+        for (const Span &span : spans)
+        {
+            const uint32_t end = std::min(span.end, storage.GetEnd());
+            if (span.begin >= end)
+                continue;
+            storage.CopyOut(span.begin, end, gpu.data() + span.begin);
+            uploadedCnt += end - span.begin;
+            for (uint32_t chunk = span.begin / 512; chunk <= (end - 1) / 512; ++chunk)
+                touched[chunk] = 1;
+        }
+        chunkCnt += std::count(touched.begin(), touched.end(), uint8_t(1));
+
+        std::vector<uint8_t> owner(storage.GetEnd(), 0);
+        for (const Text &text : texts)
+            for (uint32_t i = 0; i < text.count; ++i)
+            {
+                disjoint = disjoint && owner[text.offset + i] == 0;
+                owner[text.offset + i] = 1;
+                const FakeGlyph &glyph = gpu[text.offset + i];
+                const FakeGlyph &cpu = storage[text.offset + i];
+                // a frame's copy is only read after its upload, and only for live texts
+                uploadsMatch = uploadsMatch && glyph.text == text.id && glyph.index == i &&
+                               glyph.padding[0] == cpu.padding[0];
+            }
+    }
+
+    Check("live texts never share glyphs", disjoint);
+    Check("each frame's copy matches the live glyphs after its upload", uploadsMatch);
+    Check("capacity is the peak end rounded up to pages", storage.GetCapacity() == (peakEnd + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE);
+    std::cout << "  peak " << peakUsed << " live glyphs, peak end " << peakEnd << ", capacity " << storage.GetCapacity() << ", "
+              << storage.GetFreeRangeCnt() << " free ranges left\n"
+              << "  " << spanCnt << " copy regions in 2000 single transfers, " << uploadedCnt << " glyphs uploaded\n"
+              << "  512 glyph buffers: " << chunkCnt << " blocking copies, " << chunkCnt * 512 << " glyphs\n";
+}
+
+int main()
+{
+    TestSpanMerging();
+    TestPerFrameSpans();
+    TestPagedStorage();
+    TestRandomTexts();
+    return CheckResult();
+}
@@ -0,0 +1,228 @@
+#include "test_check.hpp"
+#include <ds/handle_map.hpp>
+#include <ds/id_allocator.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The generational allocator and the maps built on it, fuzzed against std::map models: random
+// insert, erase and lookup churn, with handles kept past their erase to check they are refused
+// rather than aliasing the value that reused their slot.
+
+using vke_ds::GenerationalIDAllocator;
+using vke_ds::Handle;
+using vke_ds::HandleMap;
+using vke_ds::SharedGenerationalIDAllocator;
+using vke_ds::SparseHandleMap;
+
+static void TestAllocator()
+{
+    GenerationalIDAllocator allocator(4);
+    Handle a = allocator.Alloc();
+    Handle b = allocator.Alloc();
+    Check("handles are never the invalid id", a.ToID() != vke_ds::INVALID_HANDLE_ID && b.ToID() != vke_ds::INVALID_HANDLE_ID);
+    Check("a handle survives packing", Handle::FromID(b.ToID()) == b);
+
+    Check("freeing a live handle works", allocator.Free(a));
+    Check("a double free is refused", !allocator.Free(a));
+    Handle c = allocator.Alloc();
+    Check("the freed slot is reused", c.index == a.index);
+    Check("with a new generation", c.generation != a.generation && !allocator.IsValid(a) && allocator.IsValid(c));
+    Check("a stale handle cannot free the new owner", !allocator.Free(a) && allocator.IsValid(c));
+
+    allocator.Alloc();
+    allocator.Alloc();
+    Check("allocation stops at the slot limit", allocator.Alloc().generation == 0 && allocator.GetLiveCnt() == 4);
+
+    std::vector<Handle> batch;
+    allocator.Free(b);
+    allocator.Free(c);
+    allocator.AllocBatch(3, batch);
+    Check("a batch takes what is left", batch.size() == 2 && allocator.GetSlotCnt() == 4);
+    Check("a batch frees only live handles", allocator.FreeBatch(batch.data(), 2) == 2 && allocator.FreeBatch(batch.data(), 2) == 0);
+
+    // churn never grows the slots past the peak live count
+    GenerationalIDAllocator churn;
+    std::vector<Handle> live;
+    std::mt19937 rng(3);
+    uint32_t peak = 0;
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        if (live.empty() || rng() % 2 == 0)
+            live.push_back(churn.Alloc());
+        else
+        {
+            const size_t pick = rng() % live.size();
+            churn.Free(live[pick]);
+            live[pick] = live.back();
+            live.pop_back();
+        }
+        peak = std::max(peak, static_cast<uint32_t>(live.size()));
+    }
+    Check("slots are bounded by the peak live count", churn.GetSlotCnt() == peak);
+
+    vke_ds::DynamicIDAllocator<uint32_t> dynamic;
+    const uint32_t id = dynamic.Alloc();
+    dynamic.Free(id);
+    dynamic.Free(id);
+    Check("the dynamic allocator survives a double free", dynamic.top == 1);
+}
+
+static void TestHandleMapFuzz()
+{
+    std::mt19937 rng(11);
+    HandleMap<uint64_t> map;
+    std::map<uint64_t, uint64_t> model;
+    std::vector<Handle> everIssued;
+    uint64_t nextValue = 0;
+    bool matches = true;
+    bool staleRefused = true;
+
+    for (uint32_t step = 0; step < 200000; ++step)
+    {
+        const uint32_t kind = rng() % 10;
+        if (kind < 4 || model.empty())
+        {
+            const Handle handle = map.Insert(nextValue);
+            matches = matches && model.count(handle.ToID()) == 0;
+            model[handle.ToID()] = nextValue++;
+            everIssued.push_back(handle);
+        }
+        else if (kind < 7)
+        {
+            auto it = model.begin();
+            std::advance(it, rng() % model.size());
+            matches = matches && map.Erase(Handle::FromID(it->first));
+            model.erase(it);
+        }
+        else
+        {
+            const Handle handle = everIssued[rng() % everIssued.size()];
+            const uint64_t *value = map.Find(handle);
+            auto it = model.find(handle.ToID());
+            if (it == model.end())
+                staleRefused = staleRefused && value == nullptr && !map.Erase(handle);
+            else
+                matches = matches && value != nullptr && *value == it->second;
+        }
+    }
+
+    matches = matches && map.Size() == model.size();
+    for (uint32_t i = 0; i < map.Size(); ++i)
+    {
+        auto it = model.find(map.HandleAt(i).ToID());
+        matches = matches && it != model.end() && it->second == map.ValueAt(i);
+    }
+    Check("the handle map matches the model after churn", matches);
+    Check("stale handles find nothing", staleRefused);
+
+    uint64_t sum = 0, modelSum = 0;
+    for (uint64_t value : map)
+        sum += value;
+    for (auto &kv : model)
+        modelSum += kv.second;
+    Check("dense iteration visits every value once", sum == modelSum);
+}
+
+static void TestSparseMapFuzz()
+{
+    // keys come from an outside allocator, like entities from the registry
+    std::mt19937 rng(5);
+    GenerationalIDAllocator keys;
+    SparseHandleMap<uint32_t> map;
+    std::map<uint64_t, uint32_t> model;
+    std::vector<Handle> everIssued;
+    bool matches = true;
+
+    for (uint32_t step = 0; step < 200000; ++step)
+    {
+        const uint32_t kind = rng() % 10;
+        if (kind < 4 || model.empty())
+        {
+            const Handle key = keys.Alloc();
+            const uint32_t value = static_cast<uint32_t>(rng());
+            map.Set(key, value);
+            model[key.ToID()] = value;
+            everIssued.push_back(key);
+        }
+        else if (kind < 6)
+        {
+            auto it = model.begin();
+            std::advance(it, rng() % model.size());
+            const Handle key = Handle::FromID(it->first);
+            matches = matches && map.Erase(key);
+            keys.Free(key);
+            model.erase(it);
+        }
+        else if (kind < 7)
+        {
+            auto it = model.begin();
+            std::advance(it, rng() % model.size());
+            it->second = static_cast<uint32_t>(rng());
+            map.Set(Handle::FromID(it->first), it->second);
+        }
+        else
+        {
+            const Handle key = everIssued[rng() % everIssued.size()];
+            const uint32_t *value = map.Find(key);
+            auto it = model.find(key.ToID());
+            matches = matches && (it == model.end() ? value == nullptr : value != nullptr && *value == it->second);
+        }
+    }
+    Check("the sparse map matches the model after churn", matches && map.Size() == model.size());
+
+    map.Clear();
+    Check("a cleared sparse map finds nothing", map.Size() == 0 && map.Find(everIssued.back()) == nullptr);
+}
+
+static void TestSharedBatches()
+{
+    SharedGenerationalIDAllocator shared;
+    const uint32_t threadCnt = 4;
+    std::vector<std::vector<Handle>> taken(threadCnt);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCnt; ++t)
+        threads.emplace_back([&shared, &taken, t]()
+                             {
+                                 std::vector<Handle> batch;
+                                 for (uint32_t round = 0; round < 200; ++round)
+                                 {
+                                     batch.clear();
+                                     shared.AllocBatch(64, batch);
+                                     // keep every fourth, give the rest back
+                                     for (uint32_t i = 0; i < batch.size(); ++i)
+                                         if (i % 4 == 0)
+                                             taken[t].push_back(batch[i]);
+                                         else
+                                             shared.Free(batch[i]);
+                                 } });
+    for (std::thread &thread : threads)
+        thread.join();
+
+    std::set<uint64_t> ids;
+    size_t keptCnt = 0;
+    bool allValid = true;
+    for (const std::vector<Handle> &handles : taken)
+        for (const Handle &handle : handles)
+        {
+            ids.insert(handle.ToID());
+            allValid = allValid && shared.IsValid(handle);
+            ++keptCnt;
+        }
+    Check("handles taken by different threads are unique and live", ids.size() == keptCnt && allValid);
+    Check("the live count matches the handles kept", shared.GetLiveCnt() == keptCnt);
+}
+
+int main()
+{
+    TestAllocator();
+    TestHandleMapFuzz();
+    TestSparseMapFuzz();
+    TestSharedBatches();
+    return CheckResult();
+}
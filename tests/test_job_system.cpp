@@ -0,0 +1,314 @@
+#include "test_check.hpp"
+#include <job_system.hpp>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Stress tests for the work stealing deque and the job system built on it: steal races, counters,
+// dependency chains, nested parallel-for and main thread affinity. Every test runs with more
+// workers than cores so that the interleavings vary.
+
+static constexpr uint32_t THREAD_CNT = 3;
+
+using vke_common::JobCounter;
+using vke_common::JobSystem;
+
+// the owner pushes and pops while thieves steal, every element has to come out exactly once
+static void TestDequeRaces()
+{
+    constexpr uint32_t ELEMENT_CNT = 200000;
+    constexpr uint32_t THIEF_CNT = 3;
+    std::vector<uint32_t> elements(ELEMENT_CNT);
+    std::vector<std::atomic<uint32_t>> taken(ELEMENT_CNT);
+    for (uint32_t i = 0; i < ELEMENT_CNT; ++i)
+        elements[i] = i;
+
+    vke_ds::WorkStealingDeque<uint32_t> deque(256);
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> stolenCnt(0);
+    std::vector<std::thread> thieves;
+    for (uint32_t t = 0; t < THIEF_CNT; ++t)
+        thieves.emplace_back([&]()
+                             {
+                                 while (!done.load())
+                                     if (uint32_t *element = deque.Steal(); element != nullptr)
+                                     {
+                                         taken[*element].fetch_add(1);
+                                         stolenCnt.fetch_add(1);
+                                     }
+                                     else
+                                         std::this_thread::yield(); });
+
+    for (uint32_t i = 0; i < ELEMENT_CNT; ++i)
+    {
+        while (!deque.Push(&elements[i]))
+            if (uint32_t *element = deque.Pop(); element != nullptr)
+                taken[*element].fetch_add(1);
+        // pop now and then, racing the thieves for the last element
+        if (i % 3 == 0)
+            if (uint32_t *element = deque.Pop(); element != nullptr)
+                taken[*element].fetch_add(1);
+    }
+    while (uint32_t *element = deque.Pop())
+        taken[*element].fetch_add(1);
+    done.store(true);
+    for (std::thread &thief : thieves)
+        thief.join();
+
+    bool once = true;
+    for (uint32_t i = 0; i < ELEMENT_CNT; ++i)
+        once = once && taken[i].load() == 1;
+    Check("every pushed element is popped or stolen exactly once", once);
+    Check("a full deque refuses pushes", [&]()
+          {
+              vke_ds::WorkStealingDeque<uint32_t> small(4);
+              for (uint32_t i = 0; i < 4; ++i)
+                  if (!small.Push(&elements[i]))
+                      return false;
+              return !small.Push(&elements[4]) && small.Pop() == &elements[3] && small.Steal() == &elements[0];
+          }());
+    std::cout << "  " << stolenCnt.load() << " of " << ELEMENT_CNT << " stolen\n";
+}
+
+static void TestCounters()
+{
+    JobSystem jobSystem(THREAD_CNT);
+    constexpr uint32_t JOB_CNT = 100000;
+    std::atomic<uint64_t> sum(0);
+    JobCounter counter;
+    for (uint32_t i = 0; i < JOB_CNT; ++i)
+        jobSystem.Run([&sum, i]()
+                      { sum.fetch_add(i, std::memory_order_relaxed); },
+                      &counter);
+    jobSystem.Wait(counter);
+    Check("wait returns after every counted job ran", sum.load() == uint64_t(JOB_CNT) * (JOB_CNT - 1) / 2);
+    Check("a finished counter is done", counter.IsDone());
+
+    // jobs that queue more jobs on the same counter
+    std::atomic<uint32_t> leafCnt(0);
+    JobCounter tree;
+    std::function<void(uint32_t)> spawn = [&](uint32_t depth)
+    {
+        if (depth == 0)
+        {
+            leafCnt.fetch_add(1);
+            return;
+        }
+        for (uint32_t i = 0; i < 4; ++i)
+            jobSystem.Run([&spawn, depth]()
+                          { spawn(depth - 1); },
+                          &tree);
+    };
+    jobSystem.Run([&spawn]()
+                  { spawn(7); },
+                  &tree);
+    jobSystem.Wait(tree);
+    Check("jobs spawned from jobs are waited for", leafCnt.load() == 16384);
+
+    const JobSystem::Stats stats = jobSystem.GetStats();
+    Check("workers steal from each other", stats.stolenCnt > 0);
+    std::cout << "  " << stats.executedCnt << " jobs, " << stats.stolenCnt << " stolen\n";
+}
+
+static void TestDependencies()
+{
+    JobSystem jobSystem(THREAD_CNT);
+
+    // a chain of stages, each gated on the previous one
+    constexpr uint32_t STAGE_CNT = 200;
+    constexpr uint32_t JOBS_PER_STAGE = 16;
+    std::vector<JobCounter> stages(STAGE_CNT);
+    std::vector<std::atomic<uint32_t>> finished(STAGE_CNT);
+    std::atomic<bool> ordered(true);
+    for (uint32_t stage = 0; stage < STAGE_CNT; ++stage)
+        for (uint32_t i = 0; i < JOBS_PER_STAGE; ++i)
+        {
+            auto job = [&, stage]()
+            {
+                if (stage > 0 && finished[stage - 1].load() != JOBS_PER_STAGE)
+                    ordered.store(false);
+                finished[stage].fetch_add(1);
+            };
+            if (stage == 0)
+                jobSystem.Run(job, &stages[stage]);
+            else
+                jobSystem.RunAfter(stages[stage - 1], job, &stages[stage]);
+        }
+    jobSystem.Wait(stages.back());
+    Check("no job starts before the stage it depends on finished", ordered.load());
+    Check("the last stage finished", finished.back().load() == JOBS_PER_STAGE);
+
+    // gated on a counter that is already done
+    JobCounter done, after;
+    std::atomic<bool> ran(false);
+    jobSystem.RunAfter(done, [&ran]()
+                       { ran.store(true); },
+                       &after);
+    jobSystem.Wait(after);
+    Check("a job gated on a done counter runs at once", ran.load());
+
+    // many counters created, used and destroyed right after Wait
+    bool allRan = true;
+    for (uint32_t round = 0; round < 2000; ++round)
+    {
+        std::atomic<uint32_t> cnt(0);
+        JobCounter first, second;
+        for (uint32_t i = 0; i < 3; ++i)
+            jobSystem.Run([&cnt]()
+                          { cnt.fetch_add(1); },
+                          &first);
+        jobSystem.RunAfter(first, [&cnt]()
+                           { cnt.fetch_add(10); },
+                           &second);
+        jobSystem.Wait(second);
+        allRan = allRan && cnt.load() == 13;
+    }
+    Check("short lived counters release their dependents", allRan);
+}
+
+static void TestParallelFor()
+{
+    JobSystem jobSystem(THREAD_CNT);
+    constexpr uint32_t COUNT = 100003;
+    std::vector<std::atomic<uint32_t>> visits(COUNT);
+    std::atomic<bool> workerValid(true);
+    jobSystem.ParallelFor(COUNT, 97, [&](uint32_t begin, uint32_t end, uint32_t worker)
+                          {
+                              if (worker >= jobSystem.GetWorkerCnt())
+                                  workerValid.store(false);
+                              for (uint32_t i = begin; i < end; ++i)
+                                  visits[i].fetch_add(1); });
+    bool once = true;
+    for (uint32_t i = 0; i < COUNT; ++i)
+        once = once && visits[i].load() == 1;
+    Check("parallel-for visits every index once", once);
+    Check("parallel-for passes valid worker indices", workerValid.load());
+
+    // parallel-for inside jobs, the waiting callers run other jobs meanwhile
+    constexpr uint32_t OUTER_CNT = 64, INNER_CNT = 1000;
+    std::atomic<uint64_t> sum(0);
+    jobSystem.ParallelFor(OUTER_CNT, 1, [&](uint32_t begin, uint32_t end, uint32_t)
+                          {
+                              for (uint32_t outer = begin; outer < end; ++outer)
+                                  jobSystem.ParallelFor(INNER_CNT, 50, [&](uint32_t innerBegin, uint32_t innerEnd, uint32_t)
+                                                        {
+                                                            uint64_t local = 0;
+                                                            for (uint32_t i = innerBegin; i < innerEnd; ++i)
+                                                                local += i;
+                                                            sum.fetch_add(local); }); });
+    Check("nested parallel-for completes", sum.load() == uint64_t(OUTER_CNT) * INNER_CNT * (INNER_CNT - 1) / 2);
+
+    JobSystem serial(0);
+    uint32_t serialSum = 0;
+    serial.ParallelFor(10, 3, [&](uint32_t begin, uint32_t end, uint32_t worker)
+                       { serialSum += (end - begin) * (worker == 0 ? 1 : 1000); });
+    Check("without threads parallel-for runs on the caller", serialSum == 10);
+}
+
+static void TestMainThreadAffinity()
+{
+    JobSystem jobSystem(THREAD_CNT);
+    const std::thread::id mainThread = std::this_thread::get_id();
+    std::atomic<bool> onMain(true);
+    std::atomic<uint32_t> mainRunCnt(0);
+    auto mainJob = [&]()
+    {
+        if (std::this_thread::get_id() != mainThread)
+            onMain.store(false);
+        mainRunCnt.fetch_add(1);
+    };
+
+    // queued from workers, some of them only after other jobs finished
+    JobCounter workers, mainJobs;
+    for (uint32_t i = 0; i < 256; ++i)
+        jobSystem.Run([&]()
+                      { jobSystem.RunOnMainThread(mainJob, &mainJobs); },
+                      &workers);
+    for (uint32_t i = 0; i < 64; ++i)
+        jobSystem.RunAfter(workers, mainJob, &mainJobs, vke_common::JobAffinity::MAIN_THREAD);
+    jobSystem.Wait(workers);
+    jobSystem.Wait(mainJobs);
+    Check("main thread jobs run on the main thread only", onMain.load() && mainRunCnt.load() == 320);
+
+    // queued and left for the frame's RunMainThreadJobs
+    std::atomic<uint32_t> frameCnt(0);
+    jobSystem.RunOnMainThread([&frameCnt]()
+                              { frameCnt.fetch_add(1); });
+    std::thread([&]()
+                { jobSystem.RunMainThreadJobs(); })
+        .join();
+    const bool skippedOffMain = frameCnt.load() == 0;
+    jobSystem.RunMainThreadJobs();
+    Check("RunMainThreadJobs does nothing off the main thread", skippedOffMain);
+    Check("RunMainThreadJobs runs the queued main thread jobs", frameCnt.load() == 1);
+}
+
+// jobs queued by threads the system does not own go through the shared queue
+static void TestForeignThreads()
+{
+    JobSystem jobSystem(THREAD_CNT);
+    std::atomic<uint32_t> ranCnt(0);
+    std::atomic<bool> noIndex(true);
+    JobCounter counter;
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < 4; ++p)
+        producers.emplace_back([&]()
+                               {
+                                   if (jobSystem.GetWorkerIndex() != JobSystem::INVALID_WORKER)
+                                       noIndex.store(false);
+                                   for (uint32_t i = 0; i < 10000; ++i)
+                                       jobSystem.Run([&ranCnt]()
+                                                     { ranCnt.fetch_add(1); },
+                                                     &counter); });
+    for (std::thread &producer : producers)
+        producer.join();
+    jobSystem.Wait(counter);
+    Check("foreign threads have no worker index", noIndex.load());
+    Check("jobs from foreign threads run", ranCnt.load() == 40000);
+
+    // a foreign thread may wait, it just does not run jobs itself
+    JobCounter fromMain;
+    std::atomic<uint32_t> mainRan(0);
+    for (uint32_t i = 0; i < 1000; ++i)
+        jobSystem.Run([&mainRan]()
+                      { mainRan.fetch_add(1); },
+                      &fromMain);
+    std::thread([&]()
+                { jobSystem.Wait(fromMain); })
+        .join();
+    Check("a foreign thread can wait on a counter", mainRan.load() == 1000);
+}
+
+static void TestStartStop()
+{
+    bool ok = true;
+    for (uint32_t round = 0; round < 200; ++round)
+    {
+        JobSystem jobSystem(round % 4);
+        std::atomic<uint32_t> cnt(0);
+        JobCounter counter;
+        jobSystem.ParallelFor(64, 1, [&cnt](uint32_t, uint32_t, uint32_t)
+                              { cnt.fetch_add(1); });
+        for (uint32_t i = 0; i < 16; ++i)
+            jobSystem.Run([&cnt]()
+                          { cnt.fetch_add(1); },
+                          &counter);
+        jobSystem.Wait(counter);
+        ok = ok && cnt.load() == 80;
+    }
+    Check("systems start and stop cleanly", ok);
+}
+
+int main()
+{
+    TestDequeRaces();
+    TestCounters();
+    TestDependencies();
+    TestParallelFor();
+    TestMainThreadAffinity();
+    TestForeignThreads();
+    TestStartStop();
+    return CheckResult();
+}
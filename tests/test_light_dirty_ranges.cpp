@@ -0,0 +1,203 @@
+#include "test_check.hpp"
+#include <render/light_dirty_ranges.hpp>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// The dirty ranges behind the light uploads: lights live in a dense array with swap removal, the way
+// LightManager keeps them, and every frame in flight writes only the spans it has missed into its
+// own copy. Random add, remove and move churn is checked against the CPU array after every frame.
+
+static constexpr uint32_t FRAME_CNT = 2;
+static constexpr uint32_t MAX_LIGHT_CNT = 256;
+
+struct FakeLight
+{
+    uint32_t owner;
+    uint32_t version;
+
+    bool operator==(const FakeLight &) const = default;
+};
+
+using vke_ds::Span;
+using vke_render::LightDirtyRanges;
+
+static std::vector<Span> Take(LightDirtyRanges &dirty, uint32_t frame, uint32_t cnt)
+{
+    std::vector<Span> spans;
+    dirty.Take(frame, cnt, spans);
+    return spans;
+}
+
+// the dense array and its dirty ranges, updated the way LightManager does it
+struct Lights
+{
+    std::vector<FakeLight> cpu;
+    FakeLight gpu[FRAME_CNT][MAX_LIGHT_CNT] = {};
+    LightDirtyRanges dirty{FRAME_CNT};
+    uint64_t writtenCnt = 0;
+    uint64_t spanCnt = 0;
+
+    void Add(uint32_t owner)
+    {
+        cpu.push_back(FakeLight{owner, 0});
+        dirty.OnAdd(static_cast<uint32_t>(cpu.size() - 1));
+    }
+
+    void Remove(uint32_t id)
+    {
+        dirty.OnRemove(id, static_cast<uint32_t>(cpu.size()));
+        cpu[id] = cpu.back();
+        cpu.pop_back();
+    }
+
+    void Move(uint32_t id)
+    {
+        ++cpu[id].version;
+        dirty.OnChange(id);
+    }
+
+    void Upload(uint32_t frame)
+    {
+        std::vector<Span> spans;
+        dirty.Take(frame, static_cast<uint32_t>(cpu.size()), spans);
+        for (const Span &span : spans)
+        {
+            std::memcpy(gpu[frame] + span.begin, cpu.data() + span.begin, (span.end - span.begin) * sizeof(FakeLight));
+            writtenCnt += span.end - span.begin;
+        }
+        spanCnt += spans.size();
+    }
+
+    bool Matches(uint32_t frame) const
+    {
+        for (uint32_t i = 0; i < cpu.size(); ++i)
+            if (!(gpu[frame][i] == cpu[i]))
+                return false;
+        return true;
+    }
+};
+
+static void TestCoalescing()
+{
+    LightDirtyRanges dirty(FRAME_CNT);
+    for (uint32_t i = 0; i < 10; ++i)
+        dirty.OnAdd(i);
+    Check("consecutive adds are one span", Take(dirty, 0, 10) == std::vector<Span>{{0, 10}});
+
+    dirty.OnChange(7);
+    dirty.OnChange(2);
+    dirty.OnChange(4);
+    Check("nearby moves are joined across small gaps", Take(dirty, 0, 10) == std::vector<Span>{{2, 8}});
+
+    dirty.OnChange(1);
+    dirty.OnChange(30);
+    Check("far apart moves stay separate", Take(dirty, 0, 40) == std::vector<Span>{{1, 2}, {30, 31}});
+
+    dirty.OnRemove(9, 10);
+    Check("removing the last light writes nothing", !dirty.IsDirty(0));
+
+    dirty.OnRemove(3, 9);
+    Check("removing another light writes the hole it left", Take(dirty, 0, 8) == std::vector<Span>{{3, 4}});
+
+    dirty.OnChange(6);
+    dirty.OnChange(7);
+    dirty.OnRemove(7, 8);
+    Check("spans past the shrunk array are clipped", Take(dirty, 0, 7) == std::vector<Span>{{6, 7}});
+
+    dirty.OnChange(2);
+    dirty.OnRemove(2, 3);
+    dirty.OnRemove(1, 2);
+    Check("spans left entirely past the array are dropped", Take(dirty, 0, 1).empty());
+
+    Check("other frames keep everything they missed", Take(dirty, 1, 7) == std::vector<Span>{{0, 7}});
+
+    dirty.OnChange(3);
+    dirty.Reset(5);
+    Check("a reset leaves one span over the new lights",
+          Take(dirty, 0, 5) == std::vector<Span>{{0, 5}} && Take(dirty, 1, 5) == std::vector<Span>{{0, 5}});
+}
+
+// many frames of mixed churn, each frame uploads only its own copy as the frames in flight do
+static void TestChurn()
+{
+    std::mt19937 rng(7);
+    Lights lights;
+    uint32_t nextOwner = 0;
+    for (uint32_t i = 0; i < 128; ++i)
+        lights.Add(nextOwner++);
+
+    bool allMatch = true;
+    uint64_t fullCnt = 0;
+    const uint32_t frameCnt = 2000;
+    for (uint32_t frame = 0; frame < frameCnt; ++frame)
+    {
+        const uint32_t opCnt = rng() % 8;
+        for (uint32_t op = 0; op < opCnt; ++op)
+        {
+            const uint32_t kind = rng() % 10;
+            const uint32_t cnt = static_cast<uint32_t>(lights.cpu.size());
+            if (kind < 2 && cnt < MAX_LIGHT_CNT)
+                lights.Add(nextOwner++);
+            else if (kind < 4 && cnt > 0)
+                lights.Remove(rng() % cnt);
+            else if (cnt > 0)
+                lights.Move(rng() % cnt);
+        }
+
+        const uint32_t current = frame % FRAME_CNT;
+        lights.Upload(current);
+        allMatch = allMatch && lights.Matches(current);
+        fullCnt += lights.cpu.size();
+    }
+    Check("every frame's copy matches the lights after churn", allMatch);
+    Check("churn writes a fraction of the full buffer", lights.writtenCnt * 4 < fullCnt);
+    std::cout << "wrote " << lights.writtenCnt << " of " << fullCnt << " lights in " << lights.spanCnt << " spans\n";
+
+    // a frame that missed many moves writes a handful of spans, not one per light
+    const uint64_t spansBefore = lights.spanCnt;
+    for (uint32_t i = 0; i < lights.cpu.size(); i += 2)
+        lights.Move(i);
+    lights.Upload(0);
+    Check("every other light moving coalesces into one span", lights.spanCnt - spansBefore == 1 && lights.Matches(0));
+}
+
+// headless frames never upload, LightManager::SkipUpdate resets the ranges at the end of each instead
+static void TestSkippedFrames()
+{
+    std::mt19937 rng(11);
+    Lights lights;
+    uint32_t nextOwner = 0;
+    for (uint32_t i = 0; i < 64; ++i)
+        lights.Add(nextOwner++);
+    lights.Upload(0);
+    lights.Upload(1);
+
+    for (uint32_t frame = 0; frame < 5000; ++frame)
+    {
+        const uint32_t cnt = static_cast<uint32_t>(lights.cpu.size());
+        if (rng() % 4 == 0 && cnt > 1)
+            lights.Remove(rng() % cnt);
+        else if (rng() % 4 == 0 && cnt < MAX_LIGHT_CNT)
+            lights.Add(nextOwner++);
+        for (uint32_t i = rng() % 8; i > 0; --i)
+            lights.Move(rng() % lights.cpu.size());
+        lights.dirty.Reset(static_cast<uint32_t>(lights.cpu.size()));
+    }
+
+    const uint64_t spansBefore = lights.spanCnt;
+    lights.Upload(0);
+    lights.Upload(1);
+    Check("skipped frames leave one span per frame in flight", lights.spanCnt - spansBefore == FRAME_CNT);
+    Check("the first uploads after skipped frames catch up", lights.Matches(0) && lights.Matches(1));
+}
+
+int main()
+{
+    TestCoalescing();
+    TestChurn();
+    TestSkippedFrames();
+    return CheckResult();
+}
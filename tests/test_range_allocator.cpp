@@ -0,0 +1,148 @@
+#include "test_check.hpp"
+#include <ds/range_allocator.hpp>
+#include <animation_system.hpp>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Exercises the range allocator behind the bone palette, then compares palette memory for 1000
+// instances against the previous fixed 256 matrix slot per instance.
+
+struct Range
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+static bool Overlaps(const std::vector<Range> &ranges)
+{
+    std::vector<Range> sorted = ranges;
+    std::sort(sorted.begin(), sorted.end(), [](const Range &a, const Range &b)
+              { return a.offset < b.offset; });
+    for (size_t i = 1; i < sorted.size(); ++i)
+        if (sorted[i - 1].offset + sorted[i - 1].size > sorted[i].offset)
+            return true;
+    return false;
+}
+
+static void TestAlignment()
+{
+    vke_ds::RangeAllocator<uint32_t> allocator(4);
+    const uint32_t a = allocator.Alloc(65);
+    const uint32_t b = allocator.Alloc(1);
+    const uint32_t c = allocator.Alloc(24);
+    Check("offsets are aligned", a % 4 == 0 && b % 4 == 0 && c % 4 == 0);
+    Check("sizes are rounded up to the alignment", b == 68 && c == 72 && allocator.GetEnd() == 96);
+    Check("used counts padding", allocator.GetUsed() == 96);
+}
+
+static void TestReuseAndCoalesce()
+{
+    vke_ds::RangeAllocator<uint32_t> allocator(4);
+    const uint32_t a = allocator.Alloc(16);
+    const uint32_t b = allocator.Alloc(16);
+    const uint32_t c = allocator.Alloc(16);
+    allocator.Alloc(16);
+
+    allocator.Free(b, 16);
+    Check("freed range is reused by a fitting request", allocator.Alloc(8) == b);
+    Check("the remainder stays free", allocator.GetFreeRangeCnt() == 1);
+    allocator.Free(b, 8);
+
+    allocator.Free(a, 16);
+    allocator.Free(c, 16);
+    Check("neighbouring free ranges coalesce", allocator.GetFreeRangeCnt() == 1);
+    Check("coalesced range fits a larger request", allocator.Alloc(48) == a);
+}
+
+static void TestBestFit()
+{
+    vke_ds::RangeAllocator<uint32_t> allocator(1);
+    const uint32_t big = allocator.Alloc(100);
+    allocator.Alloc(1);
+    const uint32_t small = allocator.Alloc(20);
+    allocator.Alloc(1);
+    allocator.Free(big, 100);
+    allocator.Free(small, 20);
+    Check("the smallest fitting range is used", allocator.Alloc(20) == small);
+    Check("larger requests still go to the big range", allocator.Alloc(90) == big);
+}
+
+static void TestShrinkAtEnd()
+{
+    vke_ds::RangeAllocator<uint32_t> allocator(4);
+    allocator.Alloc(16);
+    const uint32_t b = allocator.Alloc(16);
+    const uint32_t c = allocator.Alloc(16);
+    allocator.Free(b, 16);
+    allocator.Free(c, 16);
+    Check("freeing the tail shrinks the end", allocator.GetEnd() == 16 && allocator.GetFreeRangeCnt() == 0);
+}
+
+static void TestRandomChurn()
+{
+    vke_ds::RangeAllocator<uint32_t> allocator(4);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> sizeDist(1, 256);
+    std::vector<Range> live;
+    uint32_t peakEnd = 0;
+    for (uint32_t step = 0; step < 20000; ++step)
+    {
+        if (live.size() < 200 && (live.empty() || rng() % 3 != 0))
+        {
+            const uint32_t size = sizeDist(rng);
+            live.push_back({allocator.Alloc(size), size});
+        }
+        else
+        {
+            const size_t i = rng() % live.size();
+            allocator.Free(live[i].offset, live[i].size);
+            live[i] = live.back();
+            live.pop_back();
+        }
+        peakEnd = std::max(peakEnd, allocator.GetEnd());
+    }
+    Check("live ranges never overlap", !Overlaps(live));
+
+    for (const Range &range : live)
+        allocator.Free(range.offset, range.size);
+    Check("freeing everything returns to empty", allocator.GetEnd() == 0 && allocator.GetUsed() == 0 && allocator.GetFreeRangeCnt() == 0);
+    std::cout << "churn peak end " << peakEnd << " matrices for at most 200 live ranges\n";
+}
+
+static void MeasurePaletteMemory()
+{
+    // a mix of typical rigs: simple props, game humanoids, humanoids with fingers, and faces
+    const uint32_t jointCnts[] = {24, 53, 65, 101};
+    const uint32_t instanceCnt = 1000;
+    const uint32_t matrixBytes = sizeof(float) * 16;
+
+    vke_ds::RangeAllocator<uint32_t> allocator(vke_common::ANIMATION_PALETTE_ALIGNMENT);
+    uint64_t jointTotal = 0;
+    for (uint32_t i = 0; i < instanceCnt; ++i)
+    {
+        jointTotal += jointCnts[i % 4];
+        allocator.Alloc(jointCnts[i % 4]);
+    }
+
+    const double fixedMiB = static_cast<double>(instanceCnt) * vke_common::ANIMATION_MAX_SKINNED_JOINTS * matrixBytes / (1024.0 * 1024.0);
+    const double pooledMiB = static_cast<double>(allocator.GetEnd()) * matrixBytes / (1024.0 * 1024.0);
+    std::cout << instanceCnt << " instances, " << jointTotal / instanceCnt << " joints on average\n"
+              << "fixed 256 joint slots: " << fixedMiB << " MiB per frame in flight, " << instanceCnt << " descriptor sets per frame\n"
+              << "pooled palette:        " << pooledMiB << " MiB per frame in flight, 1 descriptor set per frame\n";
+    Check("padding stays under one alignment unit per instance", allocator.GetEnd() - jointTotal < instanceCnt * vke_common::ANIMATION_PALETTE_ALIGNMENT);
+    Check("pooled palette is smaller than fixed slots", pooledMiB < fixedMiB);
+}
+
+int main()
+{
+    TestAlignment();
+    TestReuseAndCoalesce();
+    TestBestFit();
+    TestShrinkAtEnd();
+    TestRandomChurn();
+    MeasurePaletteMemory();
+    return CheckResult();
+}
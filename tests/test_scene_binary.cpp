@@ -0,0 +1,224 @@
+#include "test_check.hpp"
+#include <scene_binary.hpp>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// SceneBinaryReader::Open against corrupted files: every ref and index a loader follows is broken in
+// turn and the reader must refuse the file, then truncated and randomly flipped files must either be
+// refused or be safe to read all the way through.
+
+using namespace vke_common;
+
+static std::vector<uint8_t> MakeScene()
+{
+    SceneBinaryWriter writer;
+    writer.SetMaxID(4);
+    writer.AddLayer("default");
+    const double position[3] = {1.0, 2.0, 3.0};
+    const double scale[3] = {1.0, 1.0, 1.0};
+    const double rotation[4] = {1.0, 0.0, 0.0, 0.0};
+    const uint32_t rootChildren[] = {2, 3};
+    const uint32_t root = writer.AddObject(1, 0, false, "root", 0, rootChildren, position, scale, rotation);
+    const uint32_t child = writer.AddObject(2, 0, true, "child", 1, {}, position, scale, rotation);
+    writer.AddObject(3, 0, false, "other", 1, {}, position, scale, rotation);
+    writer.AddObjectExtra(root, {{"tag", "root"}});
+    writer.AddComponent(child, ComponentType::PointLight, {{"type", "pointLight"}, {"radius", 5.0f}});
+    writer.AddScript(root, "Spinner", {{"speed", 2.0f}});
+    return writer.Finish();
+}
+
+template <typename T>
+static T *Records(std::vector<uint8_t> &bytes, uint32_t section)
+{
+    const SceneBinaryHeader *header = reinterpret_cast<const SceneBinaryHeader *>(bytes.data());
+    return reinterpret_cast<T *>(bytes.data() + header->sections[section].offset);
+}
+
+// touches everything a loader reads, so ASan catches a file Open let through that is not safe
+static size_t ReadAll(const SceneBinaryReader &reader)
+{
+    size_t sink = 0;
+    for (const SceneBinaryStringRef &layer : reader.GetLayers())
+        sink += reader.GetString(layer).size();
+    const std::span<const SceneBinaryObject> objects = reader.GetObjects();
+    for (const SceneBinaryObject &object : objects)
+    {
+        sink += reader.GetString(object.name).size();
+        for (uint32_t child : reader.GetChildren(object))
+            sink += child;
+    }
+    const std::span<const SceneBinaryObjectExtra> extras = reader.GetObjectExtras();
+    for (size_t i = 0; i < extras.size(); ++i)
+        sink += objects[extras[i].objectIndex].id + reader.GetObjectExtra(i).size();
+    for (uint32_t i = 0; i < SCENE_BINARY_COMPONENT_TYPE_CNT; ++i)
+    {
+        const ComponentType type = static_cast<ComponentType>(i);
+        if (type == ComponentType::Script)
+            continue;
+        const std::span<const SceneBinaryComponent> components = reader.GetComponents(type);
+        for (size_t j = 0; j < components.size(); ++j)
+            sink += objects[components[j].objectIndex].id + reader.GetComponentJSON(type, j).size();
+    }
+    const std::span<const SceneBinaryScript> scripts = reader.GetScripts();
+    for (size_t i = 0; i < scripts.size(); ++i)
+        sink += objects[scripts[i].objectIndex].id + reader.GetString(scripts[i].className).size() + reader.GetScriptData(i).size();
+    sink += reader.ToJSON().size();
+    return sink;
+}
+
+static bool Refused(const std::function<void(std::vector<uint8_t> &)> &corrupt)
+{
+    std::vector<uint8_t> bytes = MakeScene();
+    corrupt(bytes);
+    SceneBinaryReader reader;
+    return !reader.Open(bytes);
+}
+
+static void TestValidScene()
+{
+    const std::vector<uint8_t> bytes = MakeScene();
+    SceneBinaryReader reader;
+    const bool opened = reader.Open(bytes);
+    Check("a written scene opens", opened);
+    Check("a written scene reads back", opened && ReadAll(reader) > 0);
+}
+
+static void TestBrokenRefs()
+{
+    const uint32_t lightSection = GetComponentSection(ComponentType::PointLight);
+    const uint32_t scriptSection = GetComponentSection(ComponentType::Script);
+
+    Check("a layer name past the string table is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                                   { Records<SceneBinaryStringRef>(bytes, SCENE_SECTION_LAYERS)[0].length = 1000; }));
+    Check("an object name past the string table is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                                     { Records<SceneBinaryObject>(bytes, SCENE_SECTION_OBJECTS)[1].name.offset = UINT32_MAX; }));
+    Check("a children range past the child table is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                                      { Records<SceneBinaryObject>(bytes, SCENE_SECTION_OBJECTS)[0].childCnt = 3; }));
+    Check("a children range that wraps is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                            { Records<SceneBinaryObject>(bytes, SCENE_SECTION_OBJECTS)[0].firstChild = UINT32_MAX; }));
+    Check("a missing parent id is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                    { Records<SceneBinaryObject>(bytes, SCENE_SECTION_OBJECTS)[1].parent = 3000; }));
+    Check("a missing child id is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                   { Records<uint32_t>(bytes, SCENE_SECTION_CHILDREN)[1] = 7; }));
+    Check("a duplicate object id is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                      { Records<SceneBinaryObject>(bytes, SCENE_SECTION_OBJECTS)[2].id = 2; }));
+    Check("an object id past maxid is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                        { Records<SceneBinaryObject>(bytes, SCENE_SECTION_OBJECTS)[2].id = 4; }));
+    Check("an extra of a missing object is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                             { Records<SceneBinaryObjectExtra>(bytes, SCENE_SECTION_OBJECT_EXTRAS)[0].objectIndex = 3; }));
+    Check("an extra payload past its section is refused", Refused([](std::vector<uint8_t> &bytes)
+                                                                  { Records<SceneBinaryObjectExtra>(bytes, SCENE_SECTION_OBJECT_EXTRAS)[0].data.size = 4096; }));
+    Check("a component of a missing object is refused", Refused([&](std::vector<uint8_t> &bytes)
+                                                                { Records<SceneBinaryComponent>(bytes, lightSection)[0].objectIndex = 100; }));
+    Check("a component payload past its section is refused", Refused([&](std::vector<uint8_t> &bytes)
+                                                                     { Records<SceneBinaryComponent>(bytes, lightSection)[0].data.offset = UINT32_MAX - 1; }));
+    Check("a component payload that is not MessagePack is refused", Refused([&](std::vector<uint8_t> &bytes)
+                                                                            {
+                                                                                SceneBinaryComponent &component = Records<SceneBinaryComponent>(bytes, lightSection)[0];
+                                                                                // 0xc1 is never used by MessagePack
+                                                                                Records<uint8_t>(bytes, lightSection)[component.data.offset] = 0xc1; }));
+    Check("a component payload that is not an object is refused", Refused([&](std::vector<uint8_t> &bytes)
+                                                                          {
+                                                                              SceneBinaryComponent &component = Records<SceneBinaryComponent>(bytes, lightSection)[0];
+                                                                              // positive fixint, a complete MessagePack value on its own
+                                                                              Records<uint8_t>(bytes, lightSection)[component.data.offset] = 0x01;
+                                                                              component.data.size = 1; }));
+    Check("a cut short component payload is refused", Refused([&](std::vector<uint8_t> &bytes)
+                                                              { --Records<SceneBinaryComponent>(bytes, lightSection)[0].data.size; }));
+    Check("a script of a missing object is refused", Refused([&](std::vector<uint8_t> &bytes)
+                                                             { Records<SceneBinaryScript>(bytes, scriptSection)[0].objectIndex = 3; }));
+    Check("a script class name past the string table is refused", Refused([&](std::vector<uint8_t> &bytes)
+                                                                          { Records<SceneBinaryScript>(bytes, scriptSection)[0].className.length = 1000; }));
+    Check("script data that is not JSON is refused", Refused([&](std::vector<uint8_t> &bytes)
+                                                             { --Records<SceneBinaryScript>(bytes, scriptSection)[0].data.length; }));
+}
+
+static bool ExtraRefused(const nlohmann::json &extra)
+{
+    SceneBinaryWriter writer;
+    writer.SetMaxID(2);
+    writer.AddLayer("default");
+    const double position[3] = {0.0, 0.0, 0.0};
+    const double scale[3] = {1.0, 1.0, 1.0};
+    const double rotation[4] = {1.0, 0.0, 0.0, 0.0};
+    const uint32_t object = writer.AddObject(1, 0, false, "object", 0, {}, position, scale, rotation);
+    writer.AddObjectExtra(object, extra);
+    const std::vector<uint8_t> bytes = writer.Finish();
+    SceneBinaryReader reader;
+    return !reader.Open(bytes);
+}
+
+static void TestUnknownComponents()
+{
+    const nlohmann::json custom = {{"type", "custom"}, {"value", 1}};
+    Check("unknown components with an order and component open",
+          !ExtraRefused({{"components", {{{"order", 0}, {"component", custom}}}}}));
+    Check("an extra that is not an object is refused", ExtraRefused(nlohmann::json::array({1, 2})));
+    Check("unknown components that are not an array are refused", ExtraRefused({{"components", 3}}));
+    Check("an unknown component that is not an object is refused", ExtraRefused({{"components", {7}}}));
+    Check("an unknown component without an order is refused", ExtraRefused({{"components", {{{"component", custom}}}}}));
+    Check("an unknown component with a negative order is refused",
+          ExtraRefused({{"components", {{{"order", -1}, {"component", custom}}}}}));
+    Check("an unknown component with a string order is refused",
+          ExtraRefused({{"components", {{{"order", "0"}, {"component", custom}}}}}));
+    Check("an unknown component with an order past 32 bits is refused",
+          ExtraRefused({{"components", {{{"order", 1ull << 32}, {"component", custom}}}}}));
+    Check("an unknown component without a component is refused", ExtraRefused({{"components", {{{"order", 0}}}}}));
+
+    // FromJSON stores the unknown component in the extra, ToJSON puts it back in its slot
+    const nlohmann::json scene = {
+        {"maxid", 2},
+        {"layers", {"default"}},
+        {"objects", {{{"id", 1}, {"static", false}, {"name", "object"}, {"layer", 0}, {"parent", 0}, {"children", nlohmann::json::array()}, {"transform", {{"pos", {0.0, 0.0, 0.0}}, {"scl", {1.0, 1.0, 1.0}}, {"rot", {1.0, 0.0, 0.0, 0.0}}}}, {"components", {{{"type", "pointLight"}, {"radius", 2.0}}, custom}}}}},
+    };
+    const std::vector<uint8_t> bytes = SceneBinaryWriter::FromJSON(scene).Finish();
+    SceneBinaryReader reader;
+    const bool opened = reader.Open(bytes);
+    Check("unknown components keep their slot", opened && reader.ToJSON()["objects"][0]["components"][1] == custom);
+}
+
+static void TestTruncatedAndFlipped()
+{
+    const std::vector<uint8_t> full = MakeScene();
+    bool truncatedRefused = true;
+    for (size_t size = 0; size < full.size(); ++size)
+    {
+        std::vector<uint8_t> bytes(full.begin(), full.begin() + size);
+        SceneBinaryReader reader;
+        truncatedRefused = truncatedRefused && !reader.Open(bytes);
+    }
+    Check("every truncation is refused", truncatedRefused);
+
+    // whatever gets through must be readable; ASan reports it otherwise
+    std::mt19937 rng(7);
+    uint32_t opened = 0;
+    size_t readBytes = 0;
+    for (uint32_t round = 0; round < 20000; ++round)
+    {
+        std::vector<uint8_t> bytes = full;
+        const uint32_t flipCnt = 1 + rng() % 4;
+        for (uint32_t i = 0; i < flipCnt; ++i)
+            bytes[sizeof(uint32_t) * 4 + rng() % (bytes.size() - sizeof(uint32_t) * 4)] ^= static_cast<uint8_t>(1u << (rng() % 8));
+        SceneBinaryReader reader;
+        if (reader.Open(bytes))
+        {
+            readBytes += ReadAll(reader);
+            ++opened;
+        }
+    }
+    std::cout << opened << " of 20000 flipped files opened, " << readBytes << " read\n";
+    Check("flipped files are refused or safe to read", true);
+}
+
+int main()
+{
+    TestValidScene();
+    TestBrokenRefs();
+    TestUnknownComponents();
+    TestTruncatedAndFlipped();
+    return CheckResult();
+}
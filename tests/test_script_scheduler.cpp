@@ -0,0 +1,191 @@
+#include "test_check.hpp"
+#include <script_scheduler.hpp>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Drives ScriptScheduler with a fake backend that reports a fixed cost per script instead of calling into C#.
+
+class FakeScriptBackend : public vke_common::ScriptDispatchBackend
+{
+public:
+    std::map<uint32_t, float> costMs;
+    std::map<uint32_t, uint32_t> dispatchCnt;
+    std::map<uint32_t, float> totalDeltaTime;
+    uint32_t lastDispatchCnt = 0;
+    // runs as the script would, before its cost is reported
+    std::function<void(uint32_t)> onDispatch;
+
+    void Dispatch(vke_common::ScriptPhase, const uint32_t *scripts, const float *deltaTimes, float *elapsedMs, uint32_t cnt) override
+    {
+        lastDispatchCnt = cnt;
+        for (uint32_t i = 0; i < cnt; ++i)
+        {
+            if (onDispatch)
+                onDispatch(scripts[i]);
+            ++dispatchCnt[scripts[i]];
+            totalDeltaTime[scripts[i]] += deltaTimes[i];
+            elapsedMs[i] = costMs[scripts[i]];
+        }
+    }
+};
+
+static vke_common::ScriptSchedule MakeSchedule(vke_common::ScriptUpdateMode mode, uint32_t interval = 1, float budgetMs = 0.0f)
+{
+    vke_common::ScriptSchedule schedule;
+    schedule.mode = mode;
+    schedule.interval = interval;
+    schedule.budgetMs = budgetMs;
+    return schedule;
+}
+
+static void TestEveryNFrames()
+{
+    vke_common::ScriptScheduler scheduler;
+    FakeScriptBackend backend;
+    const uint32_t everyFrame = scheduler.Register("EveryFrame", MakeSchedule(vke_common::SCRIPT_UPDATE_EVERY_FRAME));
+    std::vector<uint32_t> everyFourth;
+    for (uint32_t i = 0; i < 8; ++i)
+        everyFourth.push_back(scheduler.Register("EveryFourth", MakeSchedule(vke_common::SCRIPT_UPDATE_EVERY_N_FRAMES, 4)));
+
+    uint32_t maxPerFrame = 0;
+    for (uint32_t frame = 0; frame < 40; ++frame)
+    {
+        scheduler.Dispatch(vke_common::SCRIPT_PHASE_UPDATE, 0.01f, backend);
+        maxPerFrame = std::max(maxPerFrame, backend.lastDispatchCnt);
+    }
+
+    Check("every-frame script runs each frame", backend.dispatchCnt[everyFrame] == 40);
+    bool allTenTimes = true;
+    for (uint32_t id : everyFourth)
+        allTenTimes &= backend.dispatchCnt[id] == 10;
+    Check("every-4-frames scripts run 10 times in 40 frames", allTenTimes);
+    // 8 scripts with interval 4 are staggered: 2 per frame plus the every-frame script
+    Check("interval scripts are spread across frames", maxPerFrame == 3);
+    Check("skipped frames accumulate delta time", std::abs(backend.totalDeltaTime[everyFourth[0]] - 0.4f) < 1e-4f);
+}
+
+static void TestTimeSliced()
+{
+    vke_common::ScriptSchedulerConfig config;
+    config.timeSliceBudgetMs = 2.0f;
+    config.timingSmoothing = 1.0f;
+    vke_common::ScriptScheduler scheduler(config);
+    FakeScriptBackend backend;
+    std::vector<uint32_t> sliced;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        sliced.push_back(scheduler.Register("Sliced", MakeSchedule(vke_common::SCRIPT_UPDATE_TIME_SLICED, 1, 5.0f)));
+        backend.costMs[sliced.back()] = 0.5f;
+    }
+
+    // first frame has no cost estimates yet, so everything runs once
+    scheduler.Dispatch(vke_common::SCRIPT_PHASE_UPDATE, 0.01f, backend);
+    Check("unmeasured time-sliced scripts all run once", backend.lastDispatchCnt == 10);
+
+    uint32_t dispatched = 0;
+    for (uint32_t frame = 0; frame < 5; ++frame)
+    {
+        scheduler.Dispatch(vke_common::SCRIPT_PHASE_UPDATE, 0.01f, backend);
+        Check("time slice holds 4 scripts of 0.5 ms in 2 ms", backend.lastDispatchCnt == 4);
+        dispatched += backend.lastDispatchCnt;
+    }
+    bool roundRobin = true;
+    for (uint32_t id : sliced)
+        roundRobin &= backend.dispatchCnt[id] == 3;
+    Check("time-sliced scripts are served round robin", dispatched == 20 && roundRobin);
+
+    backend.costMs[sliced[0]] = 10.0f;
+    for (uint32_t frame = 0; frame < 10; ++frame)
+        scheduler.Dispatch(vke_common::SCRIPT_PHASE_UPDATE, 0.01f, backend);
+    Check("an over-slice script still makes progress", backend.dispatchCnt[sliced[0]] > 3);
+}
+
+static void TestBudgetReport()
+{
+    vke_common::ScriptSchedulerConfig config;
+    config.reportInterval = 0;
+    vke_common::ScriptScheduler scheduler(config);
+    FakeScriptBackend backend;
+    const uint32_t cheap = scheduler.Register("Cheap", MakeSchedule(vke_common::SCRIPT_UPDATE_EVERY_FRAME, 1, 1.0f));
+    const uint32_t expensive = scheduler.Register("Expensive", MakeSchedule(vke_common::SCRIPT_UPDATE_EVERY_FRAME, 1, 1.0f));
+    backend.costMs[cheap] = 0.2f;
+    backend.costMs[expensive] = 3.0f;
+
+    for (uint32_t frame = 0; frame < 10; ++frame)
+        scheduler.Dispatch(vke_common::SCRIPT_PHASE_UPDATE, 0.01f, backend);
+
+    const vke_common::ScriptTimingStats *stats = scheduler.GetStats(expensive, vke_common::SCRIPT_PHASE_UPDATE);
+    Check("timings are tracked per script", stats != nullptr && stats->dispatchCnt == 10 && stats->overBudgetCnt == 10);
+    const std::vector<uint32_t> &report = scheduler.ReportOverBudget();
+    Check("only the over-budget script is reported", report.size() == 1 && report[0] == expensive);
+    Check("report resets the window", scheduler.ReportOverBudget().empty());
+
+    scheduler.Unregister(expensive);
+    scheduler.Dispatch(vke_common::SCRIPT_PHASE_UPDATE, 0.01f, backend);
+    Check("unregistered scripts are no longer dispatched", backend.dispatchCnt[expensive] == 10 && scheduler.GetScriptCnt() == 1);
+}
+
+static void TestFixedUpdatePhase()
+{
+    vke_common::ScriptScheduler scheduler;
+    FakeScriptBackend backend;
+    vke_common::ScriptSchedule schedule = MakeSchedule(vke_common::SCRIPT_UPDATE_EVERY_N_FRAMES, 2);
+    schedule.phaseMask = vke_common::SCRIPT_PHASE_MASK_FIXED_UPDATE;
+    const uint32_t id = scheduler.Register("FixedOnly", schedule);
+
+    for (uint32_t frame = 0; frame < 4; ++frame)
+        scheduler.Dispatch(vke_common::SCRIPT_PHASE_UPDATE, 0.01f, backend);
+    Check("fixed-only script is not dispatched in Update", backend.dispatchCnt[id] == 0);
+    for (uint32_t step = 0; step < 4; ++step)
+        scheduler.Dispatch(vke_common::SCRIPT_PHASE_FIXED_UPDATE, 0.02f, backend);
+    Check("fixed-only script runs every 2 fixed steps", backend.dispatchCnt[id] == 2);
+}
+
+// a script that removes itself and adds another one from its Update hands its id over mid dispatch
+static void TestIDReuseDuringDispatch()
+{
+    vke_common::ScriptSchedulerConfig config;
+    config.reportInterval = 0;
+    vke_common::ScriptScheduler scheduler(config);
+    FakeScriptBackend backend;
+    const uint32_t spawner = scheduler.Register("Spawner", MakeSchedule(vke_common::SCRIPT_UPDATE_EVERY_FRAME, 1, 1.0f));
+    const uint32_t other = scheduler.Register("Other", MakeSchedule(vke_common::SCRIPT_UPDATE_EVERY_FRAME, 1, 1.0f));
+    backend.costMs[spawner] = 5.0f;
+    backend.costMs[other] = 0.5f;
+
+    uint32_t spawned = UINT32_MAX;
+    backend.onDispatch = [&](uint32_t id)
+    {
+        if (id != spawner || spawned != UINT32_MAX)
+            return;
+        scheduler.Unregister(spawner);
+        spawned = scheduler.Register("Spawned", MakeSchedule(vke_common::SCRIPT_UPDATE_EVERY_FRAME, 1, 1.0f));
+    };
+    scheduler.Dispatch(vke_common::SCRIPT_PHASE_UPDATE, 0.01f, backend);
+
+    const vke_common::ScriptTimingStats *spawnedStats = scheduler.GetStats(spawned, vke_common::SCRIPT_PHASE_UPDATE);
+    const vke_common::ScriptTimingStats *otherStats = scheduler.GetStats(other, vke_common::SCRIPT_PHASE_UPDATE);
+    Check("the new script reuses the freed id", spawned == spawner);
+    Check("the old owner's timing is not recorded against the new one",
+          spawnedStats != nullptr && spawnedStats->dispatchCnt == 0 && spawnedStats->overBudgetCnt == 0);
+    Check("the other scripts' timings are still recorded", otherStats != nullptr && otherStats->dispatchCnt == 1);
+
+    backend.costMs[spawned] = 0.25f;
+    scheduler.Dispatch(vke_common::SCRIPT_PHASE_UPDATE, 0.01f, backend);
+    Check("the new script is timed from its own dispatch on",
+          spawnedStats->dispatchCnt == 1 && spawnedStats->lastMs == 0.25f);
+}
+
+int main()
+{
+    TestEveryNFrames();
+    TestTimeSliced();
+    TestBudgetReport();
+    TestFixedUpdatePhase();
+    TestIDReuseDuringDispatch();
+    return CheckResult();
+}
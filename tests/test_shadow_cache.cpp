@@ -0,0 +1,158 @@
+#include "test_check.hpp"
+#include <render/shadow_cache.hpp>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// The invalidation behind the static shadow caches and the spot shadow schedule, without a GPU:
+// keys change with the light and the cascade snapping, static casters drop every cache, views whose
+// key keeps changing bypass the cache, and spot slots are redrawn within the per frame budget.
+
+using vke_render::ShadowCache;
+using vke_render::ShadowCacheAction;
+using vke_render::ShadowViewKey;
+using vke_render::SpotShadowSchedule;
+
+// a cascade's key the way ShadowManager builds it: the light direction, and the camera position
+// snapped to texels of the stable radius
+static ShadowViewKey CascadeKey(float lightAngle, float cameraX, float radius, float mapSize)
+{
+    const float texel = radius * 2.0f / mapSize;
+    ShadowViewKey key{};
+    key[0] = std::cos(lightAngle);
+    key[1] = std::sin(lightAngle);
+    key[5] = 1.0f / radius;
+    key[12] = std::round(cameraX / texel) * texel;
+    key[15] = 1.0f;
+    return key;
+}
+
+static void TestReuse()
+{
+    ShadowCache cache(2);
+    cache.SetKey(0, CascadeKey(0.5f, 0.0f, 16.0f, 1024.0f));
+    Check("a new view draws its static casters", cache.BeginDraw(0) == ShadowCacheAction::REDRAW);
+
+    bool reused = true;
+    for (uint32_t frame = 0; frame < 10; ++frame)
+    {
+        cache.SetKey(0, CascadeKey(0.5f, 0.0f, 16.0f, 1024.0f));
+        reused = reused && cache.BeginDraw(0) == ShadowCacheAction::REUSE;
+    }
+    Check("an unchanged key reuses the cache", reused);
+
+    // a camera moving less than a texel keeps the snapped center
+    cache.SetKey(0, CascadeKey(0.5f, 0.01f, 16.0f, 1024.0f));
+    Check("sub texel camera motion keeps the cache", cache.BeginDraw(0) == ShadowCacheAction::REUSE);
+
+    cache.SetKey(0, CascadeKey(0.5f, 0.05f, 16.0f, 1024.0f));
+    Check("crossing a texel redraws", cache.BeginDraw(0) == ShadowCacheAction::REDRAW);
+
+    cache.SetKey(0, CascadeKey(0.6f, 0.05f, 16.0f, 1024.0f));
+    cache.SetKey(0, CascadeKey(0.5f, 0.05f, 16.0f, 1024.0f));
+    Check("a key changed and changed back still redraws", cache.BeginDraw(0) != ShadowCacheAction::REUSE);
+
+    cache.SetKey(1, CascadeKey(0.5f, 0.05f, 32.0f, 1024.0f));
+    cache.BeginDraw(1);
+    cache.BeginDraw(0);
+    cache.InvalidateAll();
+    Check("a static caster change redraws every view",
+          cache.BeginDraw(0) == ShadowCacheAction::REDRAW && cache.BeginDraw(1) == ShadowCacheAction::REDRAW);
+    cache.Invalidate(1);
+    Check("invalidating a view leaves the others",
+          cache.BeginDraw(0) == ShadowCacheAction::REUSE && cache.BeginDraw(1) == ShadowCacheAction::REDRAW);
+}
+
+// a cascade following a moving camera gets a new key every frame, redrawing the cache would cost a
+// draw and a copy for nothing
+static void TestBypass()
+{
+    ShadowCache cache(1);
+    std::vector<ShadowCacheAction> actions;
+    float cameraX = 0.0f;
+    for (uint32_t frame = 0; frame < 6; ++frame)
+    {
+        cameraX += 1.0f;
+        cache.SetKey(0, CascadeKey(0.5f, cameraX, 16.0f, 1024.0f));
+        actions.push_back(cache.BeginDraw(0));
+    }
+    for (uint32_t frame = 0; frame < 3; ++frame)
+    {
+        cache.SetKey(0, CascadeKey(0.5f, cameraX, 16.0f, 1024.0f));
+        actions.push_back(cache.BeginDraw(0));
+    }
+
+    bool movingBypasses = actions[0] == ShadowCacheAction::REDRAW;
+    for (uint32_t i = 1; i < 6; ++i)
+        movingBypasses = movingBypasses && actions[i] == ShadowCacheAction::BYPASS;
+    Check("a key changing every frame bypasses the cache", movingBypasses);
+    Check("the cache comes back once the camera stops",
+          actions[6] == ShadowCacheAction::REDRAW && actions[7] == ShadowCacheAction::REUSE && actions[8] == ShadowCacheAction::REUSE);
+    Check("bypassed draws are counted", cache.GetStats().bypassCnt == 5 && cache.GetStats().redrawCnt == 2 &&
+                                            cache.GetStats().reuseCnt == 2);
+}
+
+static std::vector<uint32_t> Pick(SpotShadowSchedule &schedule, uint64_t frame, uint32_t budget, uint32_t interval, bool hasDynamic)
+{
+    std::vector<uint32_t> picked;
+    schedule.Pick(frame, budget, interval, hasDynamic, picked);
+    return picked;
+}
+
+static void TestSchedule()
+{
+    SpotShadowSchedule schedule(8);
+    for (uint32_t slot = 0; slot < 6; ++slot)
+        schedule.Activate(slot);
+    Check("new slots are drawn regardless of the budget", Pick(schedule, 1, 2, 2, true) == std::vector<uint32_t>{0, 1, 2, 3, 4, 5});
+    Check("nothing is due right after", Pick(schedule, 2, 2, 2, true).empty());
+
+    // without dynamic casters a slot keeps its map until something changes
+    bool idle = true;
+    for (uint64_t frame = 3; frame < 20; ++frame)
+        idle = idle && Pick(schedule, frame, 2, 2, false).empty();
+    Check("static only slots are never redrawn", idle);
+
+    schedule.MarkStale(4);
+    schedule.MarkStale(7);
+    Check("a moved light is redrawn, inactive slots are ignored", Pick(schedule, 20, 2, 2, false) == std::vector<uint32_t>{4});
+
+    // with dynamic casters the budget is shared out oldest first, stale slots ahead of the rest
+    schedule.MarkStale(5);
+    std::vector<uint32_t> picked = Pick(schedule, 21, 2, 2, true);
+    Check("stale slots go first, then the oldest", picked.size() == 2 && picked[1] == 5);
+
+    std::vector<uint64_t> lastDrawn(6, 21);
+    uint32_t maxPicked = 0;
+    uint64_t maxAge = 0;
+    for (uint64_t frame = 22; frame < 60; ++frame)
+    {
+        picked = Pick(schedule, frame, 2, 2, true);
+        maxPicked = std::max<uint32_t>(maxPicked, static_cast<uint32_t>(picked.size()));
+        for (uint32_t slot : picked)
+            lastDrawn[slot] = frame;
+        for (uint32_t slot = 0; slot < 6; ++slot)
+            maxAge = std::max(maxAge, frame - lastDrawn[slot]);
+    }
+    Check("the budget holds", maxPicked == 2);
+    Check("every slot is refreshed within slots / budget frames", maxAge <= 3);
+
+    schedule.Deactivate(2);
+    bool skipped = true;
+    for (uint64_t frame = 60; frame < 70; ++frame)
+        for (uint32_t slot : Pick(schedule, frame, 8, 1, true))
+            skipped = skipped && slot != 2;
+    Check("a deactivated slot is never picked", skipped);
+
+    schedule.MarkAllStale();
+    Check("a static caster change marks every active slot", Pick(schedule, 70, 8, 100, false) == std::vector<uint32_t>{0, 1, 3, 4, 5});
+}
+
+int main()
+{
+    TestReuse();
+    TestBypass();
+    TestSchedule();
+    return CheckResult();
+}
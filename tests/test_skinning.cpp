@@ -0,0 +1,368 @@
+#include "test_check.hpp"
+#include <render/skinning_kernel.hpp>
+#include <render/skinning_graph.hpp>
+#include <animation_system.hpp>
+#include <ozz/animation/offline/animation_builder.h>
+#include <ozz/animation/offline/raw_animation.h>
+#include <ozz/animation/offline/raw_skeleton.h>
+#include <ozz/animation/offline/skeleton_builder.h>
+#include <ozz/animation/runtime/local_to_model_job.h>
+#include <ozz/animation/runtime/sampling_job.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Checks the CPU reference of skinning.comp against skinning done with ozz's own math from an
+// independently sampled pose, and the frame graph wiring of the compute skinning task against a
+// graph that only records calls, so neither part needs a device.
+
+static constexpr uint32_t CHAIN_CNT = 2;
+static constexpr uint32_t CHAIN_LENGTH = 8;
+static constexpr uint32_t VERTEX_CNT = 2000;
+static constexpr float TOLERANCE = 1e-4f;
+
+struct Rig
+{
+    ozz::unique_ptr<ozz::animation::Skeleton> skeleton;
+    ozz::unique_ptr<ozz::animation::Animation> animation;
+    std::vector<int> joints;
+    std::vector<ozz::math::Float4x4> invBindMatrices;
+};
+
+static void ModelPose(const Rig &rig, const ozz::vector<ozz::math::SoaTransform> &locals, ozz::vector<ozz::math::Float4x4> &models)
+{
+    ozz::animation::LocalToModelJob ltmJob;
+    ltmJob.skeleton = rig.skeleton.get();
+    ltmJob.input = make_span(locals);
+    ltmJob.output = make_span(models);
+    ltmJob.Run();
+}
+
+static Rig BuildRig()
+{
+    ozz::animation::offline::RawSkeleton rawSkeleton;
+    rawSkeleton.roots.resize(1);
+    ozz::animation::offline::RawSkeleton::Joint &root = rawSkeleton.roots[0];
+    root.name = "root";
+    root.transform = ozz::math::Transform::identity();
+    root.children.resize(CHAIN_CNT);
+    for (uint32_t c = 0; c < CHAIN_CNT; ++c)
+    {
+        ozz::animation::offline::RawSkeleton::Joint *joint = &root.children[c];
+        for (uint32_t j = 0; j < CHAIN_LENGTH; ++j)
+        {
+            joint->name = "chain" + std::to_string(c) + "_" + std::to_string(j);
+            joint->transform = ozz::math::Transform::identity();
+            joint->transform.translation = ozz::math::Float3(j == 0 ? 0.3f * c : 0.0f, 0.25f, 0.0f);
+            if (j + 1 < CHAIN_LENGTH)
+            {
+                joint->children.resize(1);
+                joint = &joint->children[0];
+            }
+        }
+    }
+
+    Rig rig;
+    rig.skeleton = ozz::animation::offline::SkeletonBuilder()(rawSkeleton);
+
+    const int jointCnt = rig.skeleton->num_joints();
+    ozz::animation::offline::RawAnimation rawAnimation;
+    rawAnimation.duration = 1.5f;
+    rawAnimation.tracks.resize(jointCnt);
+    for (int i = 0; i < jointCnt; ++i)
+    {
+        ozz::animation::offline::RawAnimation::JointTrack &track = rawAnimation.tracks[i];
+        for (uint32_t k = 0; k <= 6; ++k)
+        {
+            const float time = rawAnimation.duration * k / 6.0f;
+            const float angle = 0.4f * std::sin(k * 1.05f + i * 0.3f);
+            track.rotations.push_back({time, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3(0.0f, 0.0f, 1.0f), angle)});
+            track.translations.push_back({time, ozz::math::Float3(0.0f, 0.25f, 0.05f * std::cos(k + i))});
+        }
+        track.scales.push_back({0.0f, ozz::math::Float3(1.0f + 0.05f * (i % 3), 1.0f, 1.0f)});
+    }
+    rig.animation = ozz::animation::offline::AnimationBuilder()(rawAnimation);
+
+    // bind at the rest pose, like an exported mesh would be
+    ozz::vector<ozz::math::SoaTransform> rest(rig.skeleton->joint_rest_poses().begin(), rig.skeleton->joint_rest_poses().end());
+    ozz::vector<ozz::math::Float4x4> bindModels(jointCnt);
+    ModelPose(rig, rest, bindModels);
+    for (int i = 0; i < jointCnt; ++i)
+    {
+        rig.joints.push_back(i);
+        rig.invBindMatrices.push_back(ozz::math::Invert(bindModels[i]));
+    }
+    return rig;
+}
+
+static std::vector<vke_render::SkinningVertexIn> BuildVertices(uint32_t jointCnt)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> coord(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> height(0.0f, 0.25f * CHAIN_LENGTH);
+    std::uniform_int_distribution<uint32_t> joint(0, jointCnt - 1);
+    std::vector<vke_render::SkinningVertexIn> vertices(VERTEX_CNT);
+    for (vke_render::SkinningVertexIn &v : vertices)
+    {
+        v.pos[0] = 0.2f * coord(rng);
+        v.pos[1] = height(rng);
+        v.pos[2] = 0.2f * coord(rng);
+        for (int i = 0; i < 3; ++i)
+        {
+            v.normal[i] = coord(rng);
+            v.tangent[i] = coord(rng);
+        }
+        v.normal[0] += 2.0f; // keep both away from zero length
+        v.tangent[2] += 2.0f;
+        v.tangent[3] = (rng() & 1) ? 1.0f : -1.0f;
+        v.texCoord[0] = 0.5f * (coord(rng) + 1.0f);
+        v.texCoord[1] = 0.5f * (coord(rng) + 1.0f);
+
+        // one to four influences, unused slots keep weight 0 on joint 0 like exported meshes
+        const uint32_t influenceCnt = 1 + rng() % 4;
+        float weightSum = 0.0f;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            v.jointIDs[i] = i < influenceCnt ? joint(rng) : 0;
+            v.weights[i] = i < influenceCnt ? 0.1f + 0.5f * (coord(rng) + 1.0f) : 0.0f;
+            weightSum += v.weights[i];
+        }
+        for (float &w : v.weights)
+            w /= weightSum;
+    }
+    return vertices;
+}
+
+// skinning matrices of one instance sampled separately from the AnimationSystem
+static std::vector<ozz::math::Float4x4> ReferenceSkinningMatrices(const Rig &rig, float ratio)
+{
+    ozz::animation::SamplingJob::Context context(rig.skeleton->num_joints());
+    ozz::vector<ozz::math::SoaTransform> locals(rig.skeleton->num_soa_joints());
+    ozz::vector<ozz::math::Float4x4> models(rig.skeleton->num_joints());
+
+    ozz::animation::SamplingJob samplingJob;
+    samplingJob.animation = rig.animation.get();
+    samplingJob.context = &context;
+    samplingJob.ratio = ratio;
+    samplingJob.output = make_span(locals);
+    samplingJob.Run();
+    ModelPose(rig, locals, models);
+
+    std::vector<ozz::math::Float4x4> skinning(rig.joints.size());
+    for (size_t i = 0; i < skinning.size(); ++i)
+        skinning[i] = models[rig.joints[i]] * rig.invBindMatrices[i];
+    return skinning;
+}
+
+static float MaxDifference(const float *expected, const float *actual, int cnt)
+{
+    float maxError = 0.0f;
+    for (int i = 0; i < cnt; ++i)
+        maxError = std::max(maxError, std::abs(expected[i] - actual[i]));
+    return maxError;
+}
+
+static void TestKernelAgainstOzz()
+{
+    const Rig rig = BuildRig();
+    const uint32_t jointCnt = rig.joints.size();
+    const std::vector<vke_render::SkinningVertexIn> vertices = BuildVertices(jointCnt);
+
+    vke_common::AnimationConfig config;
+    config.enableLOD = false;
+    vke_common::AnimationSystem system(config);
+    vke_common::AnimationInstanceDesc desc;
+    desc.skeleton = rig.skeleton.get();
+    desc.animation = rig.animation.get();
+    desc.joints = &rig.joints;
+    desc.invBindMatrices = &rig.invBindMatrices;
+    const uint32_t ids[2] = {system.AddInstance(desc), system.AddInstance(desc)};
+    system.GetPlayback(ids[1]).timeRatio = 0.37f;
+
+    std::vector<float> palette(static_cast<size_t>(system.GetPaletteSize()) * 16, 0.0f);
+    system.Update(1.0f / 60.0f, palette.data());
+
+    std::vector<vke_render::SkinningVertexOut> skinned(VERTEX_CNT);
+    for (uint32_t id : ids)
+    {
+        const uint32_t jointOffset = system.GetPaletteOffset(id);
+        vke_render::SkinVerticesReference(palette.data(), jointOffset, vertices.data(), skinned.data(), VERTEX_CNT);
+
+        const std::vector<ozz::math::Float4x4> skinningMatrices = ReferenceSkinningMatrices(rig, system.GetPlayback(id).timeRatio);
+        float posError = 0.0f, normalError = 0.0f, tangentError = 0.0f;
+        bool passthrough = true;
+        for (uint32_t v = 0; v < VERTEX_CNT; ++v)
+        {
+            const vke_render::SkinningVertexIn &in = vertices[v];
+            ozz::math::Float4x4 blended;
+            for (int c = 0; c < 4; ++c)
+                blended.cols[c] = ozz::math::simd_float4::zero();
+            for (int i = 0; i < 4; ++i)
+            {
+                const ozz::math::SimdFloat4 weight = ozz::math::simd_float4::Load1(in.weights[i]);
+                for (int c = 0; c < 4; ++c)
+                    blended.cols[c] = blended.cols[c] + skinningMatrices[in.jointIDs[i]].cols[c] * weight;
+            }
+
+            float expected[4];
+            ozz::math::StorePtrU(ozz::math::TransformPoint(blended, ozz::math::simd_float4::LoadPtrU(in.pos)), expected);
+            posError = std::max(posError, MaxDifference(expected, skinned[v].pos, 3));
+            ozz::math::StorePtrU(ozz::math::Normalize3(ozz::math::TransformVector(blended, ozz::math::simd_float4::Load(in.normal[0], in.normal[1], in.normal[2], 0.0f))), expected);
+            normalError = std::max(normalError, MaxDifference(expected, skinned[v].normal, 3));
+            ozz::math::StorePtrU(ozz::math::Normalize3(ozz::math::TransformVector(blended, ozz::math::simd_float4::Load(in.tangent[0], in.tangent[1], in.tangent[2], 0.0f))), expected);
+            tangentError = std::max(tangentError, MaxDifference(expected, skinned[v].tangent, 3));
+            passthrough = passthrough && skinned[v].tangent[3] == in.tangent[3] &&
+                          skinned[v].texCoord[0] == in.texCoord[0] && skinned[v].texCoord[1] == in.texCoord[1];
+        }
+
+        const std::string instance = "instance at palette offset " + std::to_string(jointOffset);
+        std::cout << instance << ": max error pos " << posError << ", normal " << normalError << ", tangent " << tangentError << "\n";
+        Check(instance + " positions match ozz", posError < TOLERANCE);
+        Check(instance + " normals match ozz", normalError < TOLERANCE);
+        Check(instance + " tangents match ozz", tangentError < TOLERANCE);
+        Check(instance + " keeps tangent sign and uv", passthrough);
+    }
+}
+
+static void TestRestPoseIsIdentity()
+{
+    // at the bind pose every skinning matrix is identity, so the kernel only renormalizes
+    const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    std::vector<float> palette;
+    for (int i = 0; i < 8; ++i)
+        palette.insert(palette.end(), identity, identity + 16);
+
+    std::vector<vke_render::SkinningVertexIn> vertices = BuildVertices(4);
+    for (vke_render::SkinningVertexIn &v : vertices)
+    {
+        const float normalLength = std::sqrt(v.normal[0] * v.normal[0] + v.normal[1] * v.normal[1] + v.normal[2] * v.normal[2]);
+        for (float &n : v.normal)
+            n /= normalLength;
+    }
+    std::vector<vke_render::SkinningVertexOut> skinned(VERTEX_CNT);
+    vke_render::SkinVerticesReference(palette.data(), 4, vertices.data(), skinned.data(), VERTEX_CNT);
+
+    float maxError = 0.0f;
+    for (uint32_t v = 0; v < VERTEX_CNT; ++v)
+    {
+        maxError = std::max(maxError, MaxDifference(vertices[v].pos, skinned[v].pos, 3));
+        maxError = std::max(maxError, MaxDifference(vertices[v].normal, skinned[v].normal, 3));
+    }
+    Check("identity palette leaves positions and unit normals unchanged", maxError < 1e-6f);
+}
+
+// records what the skinning wiring asks of a FrameGraph
+struct RecordingGraph
+{
+    struct BufferResource
+    {
+        std::string name;
+        bool framesInFlight;
+        VkBuffer buffers[vke_render::MAX_FRAMES_IN_FLIGHT];
+        VkDeviceSize size;
+    };
+
+    struct TaskNode
+    {
+        std::string name;
+        vke_render::TaskType taskType;
+    };
+
+    struct Ref
+    {
+        vke_ds::id32_t taskID;
+        vke_ds::id32_t inResourceNodeID;
+        vke_ds::id32_t outResourceNodeID;
+        VkAccessFlags2 accessMask;
+        VkPipelineStageFlags2 stageMask;
+    };
+
+    std::vector<BufferResource> resources;
+    std::vector<vke_ds::id32_t> resourceNodes;
+    std::vector<TaskNode> taskNodes;
+    std::vector<Ref> refs;
+
+    vke_ds::id32_t AddPermanentBufferResource(std::string &&name, const bool framesInFlight,
+                                              VkBuffer *buffers, const VkDeviceSize offset, const VkDeviceSize size,
+                                              const VkPipelineStageFlags2 stStage)
+    {
+        BufferResource resource{std::move(name), framesInFlight, {}, size};
+        std::copy(buffers, buffers + vke_render::MAX_FRAMES_IN_FLIGHT, resource.buffers);
+        resources.push_back(resource);
+        return resources.size();
+    }
+
+    vke_ds::id32_t AllocResourceNode(std::string &&name, const vke_ds::id32_t resourceID)
+    {
+        resourceNodes.push_back(resourceID);
+        return resourceNodes.size();
+    }
+
+    template <typename Callback>
+    vke_ds::id32_t AllocTaskNode(std::string &&name, const vke_render::TaskType taskType, Callback &&)
+    {
+        taskNodes.push_back({std::move(name), taskType});
+        return taskNodes.size();
+    }
+
+    void AddTaskNodeResourceRef(const vke_ds::id32_t taskID,
+                                const vke_ds::id32_t inResourceNodeID, const vke_ds::id32_t outResourceNodeID,
+                                const VkAccessFlags2 accessMask, const VkPipelineStageFlags2 stageMask,
+                                const VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                                const VkAttachmentStoreOp storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE)
+    {
+        refs.push_back({taskID, inResourceNodeID, outResourceNodeID, accessMask, stageMask});
+    }
+};
+
+static void TestFrameGraphWiring()
+{
+    RecordingGraph graph;
+    std::map<std::string, vke_ds::id32_t> blackboard;
+    vke_render::ResourceNodeIDMap currentResourceNodeID;
+
+    const vke_ds::id32_t gbufferTaskID = 100;
+    vke_render::ReadSkinnedVertices(graph, gbufferTaskID, blackboard, currentResourceNodeID);
+    Check("passes add no skinning dependency when compute skinning is off", graph.refs.empty());
+
+    VkBuffer buffers[vke_render::MAX_FRAMES_IN_FLIGHT];
+    for (uint32_t i = 0; i < vke_render::MAX_FRAMES_IN_FLIGHT; ++i)
+        buffers[i] = reinterpret_cast<VkBuffer>(static_cast<uintptr_t>(0x100 + i));
+    const vke_ds::id32_t skinningTaskID = vke_render::ConstructSkinningFrameGraph(graph, blackboard, currentResourceNodeID, buffers,
+                                                                                  [](vke_render::TaskNode &, vke_render::FrameGraph &, VkCommandBuffer, uint32_t, uint32_t) {});
+
+    Check("one compute task", graph.taskNodes.size() == 1 && graph.taskNodes[0].taskType == vke_render::COMPUTE_TASK);
+    const auto it = blackboard.find(vke_render::SKINNED_VERTEX_BUFFER);
+    Check("output buffer is on the blackboard", it != blackboard.end() && it->second == 1);
+    Check("output buffer is per frame in flight and whole",
+          graph.resources.size() == 1 && graph.resources[0].framesInFlight && graph.resources[0].size == VK_WHOLE_SIZE &&
+              std::equal(buffers, buffers + vke_render::MAX_FRAMES_IN_FLIGHT, graph.resources[0].buffers));
+
+    const bool writes = graph.refs.size() == 1 && graph.refs[0].taskID == skinningTaskID && graph.refs[0].inResourceNodeID == 0 &&
+                        graph.refs[0].accessMask == VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT &&
+                        graph.refs[0].stageMask == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    Check("compute task writes the output as storage", writes);
+    const vke_ds::id32_t outNodeID = writes ? graph.refs[0].outResourceNodeID : 0;
+    Check("output node becomes current", outNodeID != 0 && currentResourceNodeID[it->second] == outNodeID);
+
+    const vke_ds::id32_t shadowTaskID = 101;
+    vke_render::ReadSkinnedVertices(graph, shadowTaskID, blackboard, currentResourceNodeID);
+    vke_render::ReadSkinnedVertices(graph, gbufferTaskID, blackboard, currentResourceNodeID);
+    bool reads = graph.refs.size() == 3;
+    for (size_t i = 1; reads && i < graph.refs.size(); ++i)
+        reads = graph.refs[i].inResourceNodeID == outNodeID && graph.refs[i].outResourceNodeID == 0 &&
+                graph.refs[i].accessMask == VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT &&
+                graph.refs[i].stageMask == VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT;
+    Check("shadow and gbuffer passes read the skinned vertices as vertex input", reads);
+}
+
+int main()
+{
+    TestKernelAgainstOzz();
+    TestRestPoseIsIdentity();
+    TestFrameGraphWiring();
+    return CheckResult();
+}
@@ -0,0 +1,135 @@
+#include "test_check.hpp"
+#include <time.hpp>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// The time base with an injected clock: precision after days of uptime, fixed step counts and the
+// interpolation alpha, clamping after a hitch, the frame pacer's sleep, spin and cadence, and the
+// fixed clock of headless runs. Everything runs on ManualTimeSource, so results are exact.
+
+using vke_common::FixedStepper;
+using vke_common::FramePacer;
+using vke_common::ManualTimeSource;
+using vke_common::ticks_t;
+using vke_common::TimeConfig;
+using vke_common::TimeManager;
+
+static constexpr ticks_t MS = vke_common::TICKS_PER_SECOND / 1000;
+
+// a clock started days ago still resolves sub-millisecond frames
+static void TestLongUptime()
+{
+    auto source = std::make_unique<ManualTimeSource>(ticks_t(72) * 3600 * 1000 * MS);
+    ManualTimeSource *clock = source.get();
+    TimeManager::Init(TimeConfig(), 1.0f / 60.0f, 0.0f, std::move(source));
+    clock->Advance(ticks_t(72) * 3600 * 1000 * MS);
+    TimeManager::Update();
+    clock->Advance(MS / 4);
+    TimeManager::Update();
+    Check("delta stays exact after 72 hours", TimeManager::GetDeltaTicks() == MS / 4 &&
+                                                  std::abs(TimeManager::GetDeltaTimeSeconds() - 0.00025) < 1e-12);
+    Check("time is measured from Init", TimeManager::GetTimeSeconds() == 72.0 * 3600.0 + 0.00025);
+    TimeManager::Dispose();
+}
+
+// uneven frames give the same step count as their total, the alpha is the remainder
+static void TestFixedSteps()
+{
+    FixedStepper stepper(10 * MS, 8);
+    uint32_t stepCnt = 0;
+    const ticks_t frames[] = {3 * MS, 9 * MS, 4 * MS, 16 * MS, 1 * MS};
+    for (ticks_t frame : frames)
+        stepCnt += stepper.Advance(frame);
+    Check("steps add up to the elapsed time", stepCnt == 3 && stepper.GetStats().stepCnt == 3);
+    Check("alpha is the remainder in steps", std::abs(stepper.GetAlpha() - 0.3) < 1e-12);
+
+    // a 1 second hitch owes 100 steps, 8 run and the rest is dropped
+    const uint32_t hitchSteps = stepper.Advance(1000 * MS);
+    Check("a hitch runs at most maxStepsPerFrame", hitchSteps == 8 && stepper.GetStats().clampedFrameCnt == 1 &&
+                                                       stepper.GetStats().maxStepsInFrame == 8);
+    Check("dropped time is counted and the remainder kept",
+          stepper.GetStats().droppedTicks == 92 * 10 * MS && std::abs(stepper.GetAlpha() - 0.3) < 1e-12);
+}
+
+// the engine side: frames that do not ask for steps, e.g. paused ones, do not accumulate them
+static void TestTimeManagerSteps()
+{
+    auto source = std::make_unique<ManualTimeSource>();
+    ManualTimeSource *clock = source.get();
+    TimeConfig config;
+    config.maxFixedStepsPerFrame = 4;
+    TimeManager::Init(config, 0.01f, 0.0f, std::move(source));
+    clock->Advance(25 * MS);
+    TimeManager::Update();
+    const uint32_t first = TimeManager::AdvanceFixedSteps();
+    clock->Advance(25 * MS);
+    TimeManager::Update();
+    clock->Advance(25 * MS);
+    TimeManager::Update();
+    const uint32_t afterPause = TimeManager::AdvanceFixedSteps();
+    Check("steps follow the frame delta", first == 2 && afterPause == 3 && TimeManager::GetFixedStepCount() == 3);
+    Check("the alpha is exposed as a float", std::abs(TimeManager::GetFixedStepAlpha() - 0.0f) < 1e-4f);
+    TimeManager::Dispose();
+}
+
+// sleeps until spinTicks are left, spins the rest, and keeps the cadence of deadlines
+static void TestPacer()
+{
+    // every read of the clock takes 10 us, sleeps wake 300 us late
+    ManualTimeSource clock(0, MS / 100, MS * 3 / 10);
+    FramePacer pacer(&clock, 10 * MS, 2 * MS);
+    const ticks_t start = pacer.Pace();
+    clock.Advance(4 * MS);
+    const ticks_t second = pacer.Pace();
+    Check("the pacer waits for the deadline", second >= start + 10 * MS && second < start + 10 * MS + MS / 10);
+    Check("it sleeps most of the wait and spins the end", pacer.GetStats().sleptTicks >= 4 * MS &&
+                                                               pacer.GetStats().spunTicks > 0 &&
+                                                               pacer.GetStats().spunTicks <= 2 * MS);
+
+    // a 13 ms frame misses its deadline, the next one is shorter to keep the cadence
+    clock.Advance(13 * MS);
+    const ticks_t late = pacer.Pace();
+    clock.Advance(1 * MS);
+    const ticks_t caughtUp = pacer.Pace();
+    Check("a late frame is counted and the cadence kept", pacer.GetStats().missedFrameCnt == 1 &&
+                                                              caughtUp >= start + 30 * MS && caughtUp < start + 30 * MS + MS / 10 &&
+                                                              late > start + 20 * MS);
+
+    // a frame a whole period late starts a new cadence instead of rushing frames
+    clock.Advance(50 * MS);
+    const ticks_t restart = pacer.Pace();
+    const ticks_t afterRestart = pacer.Pace();
+    Check("a frame more than a period late restarts the cadence", afterRestart >= restart + 10 * MS &&
+                                                                      afterRestart < restart + 10 * MS + MS / 10);
+}
+
+// the fixed clock of headless runs is exact for any run length
+static void TestFixedClock()
+{
+    TimeManager::Init(TimeConfig(), 1.0f / 60.0f, 1.0f / 60.0f, std::make_unique<ManualTimeSource>());
+    for (uint32_t i = 0; i < 216000; ++i)
+        TimeManager::Update();
+    Check("an hour of fixed frames lands on the hour", TimeManager::IsFixedClock() &&
+                                                          std::abs(TimeManager::GetTimeSeconds() - 3600.0) < 1e-3 &&
+                                                          TimeManager::GetDeltaTicks() == vke_common::SecondsToTicks(1.0f / 60.0f));
+    uint32_t stepCnt = 0;
+    for (uint32_t i = 0; i < 60; ++i)
+    {
+        TimeManager::Update();
+        stepCnt += TimeManager::AdvanceFixedSteps();
+    }
+    Check("one fixed step per fixed frame", stepCnt == 60);
+    TimeManager::Dispose();
+}
+
+int main()
+{
+    TestLongUptime();
+    TestFixedSteps();
+    TestTimeManagerSteps();
+    TestPacer();
+    TestFixedClock();
+    return CheckResult();
+}